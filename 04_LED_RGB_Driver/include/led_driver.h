@@ -10,6 +10,10 @@
  * - Bits 15-8:  Red (0-255)
  * - Bits 7-0:   Blue (0-255)
  * - Bits 31-24: Unused (always 0x00)
+ *
+ * Each strip is an independent led_strip_t instance (led_strip_*()
+ * functions). The led_*() functions without a strip argument operate on
+ * a default instance created by led_init().
  */
 
 #ifndef LED_DRIVER_H
@@ -18,6 +22,57 @@
 #include <stdint.h>
 #include <stddef.h>
 
+/**
+ * @brief Maximum number of dirty spans tracked between two commits
+ *
+ * When more disjoint regions are modified, the two spans separated by the
+ * smallest gap are merged, so a frame never carries more than this many
+ * spans (at the cost of re-sending a few unchanged pixels).
+ */
+#define LED_MAX_DIRTY_SPANS 16
+
+/**
+ * @brief A contiguous run of modified pixels: [start, start + count)
+ */
+typedef struct {
+    size_t start;          // Index of the first modified pixel
+    size_t count;          // Number of pixels in the span
+} led_span_t;
+
+/**
+ * @brief Pixel storage format of a strip, see led_strip_create_format()
+ *
+ * All formats take and return colors as 0x00GGRRBB words (RGBW32 and
+ * RGBW64 also use bits 31-24 for white); only the memory layout differs.
+ */
+typedef enum {
+    LED_FORMAT_GRB32 = 0,  // 0x00GGRRBB words, SIMD bulk operations (default)
+    LED_FORMAT_GRB24,      // 3 bytes G, R, B in wire order
+    LED_FORMAT_RGBW32,     // 0xWWGGRRBB words, top byte drives the white LED
+    LED_FORMAT_RGB565,     // 16-bit 5-6-5, colors are quantized
+    LED_FORMAT_PAL8,       // 8-bit index into a palette of up to 256 colors
+    LED_FORMAT_RGBW64      // 16 bits per channel B, R, G, W, dithered to 8 at commit
+} led_pixel_format_t;
+
+/**
+ * @brief Incremental frame handed to the consumer by led_commit()
+ *
+ * Only the pixels covered by spans[] need to be pushed to the hardware;
+ * their colors are read from buffer[span.start .. span.start + span.count).
+ * Returned by led_commit() (single buffer) or led_acquire_frame().
+ */
+typedef struct {
+    uint32_t sequence;                         // Frame number, starts at 1
+    const uint32_t *buffer;                    // Same pointer as led_get_buffer(), or the
+                                               // corrected output (led_strip_set_correction())
+    const void *data;                          // Raw pixels in the strip's format, or the
+                                               // dithered output (RGBW64 strips)
+    led_pixel_format_t format;                 // Format of data
+    size_t num_spans;                          // Number of valid entries in spans[]
+    size_t dirty_pixels;                       // Sum of all span counts
+    led_span_t spans[LED_MAX_DIRTY_SPANS];     // Sorted, non-overlapping spans
+} led_frame_t;
+
 /**
  * @brief Initialize the LED strip buffer
  * 
@@ -101,6 +156,182 @@ size_t led_get_pixel_count(void);
  */
 uint32_t led_get_pixel(size_t index);
 
+/**
+ * @brief Collect the pixels changed since the previous commit
+ *
+ * Fills @p frame with the sorted list of dirty spans and the next frame
+ * sequence number, then clears the dirty state. The first commit after
+ * led_init() covers the whole strip, since the hardware state is unknown.
+ * Writes that store the value a pixel already holds do not mark it dirty.
+ *
+ * @param frame Output frame description
+ * @return Number of dirty spans (0 = nothing to send), or -1 if the driver
+ *         is not initialized or frame is NULL
+ *
+ * @note The sequence number increases on every successful call, even when
+ *       no pixel changed, so the consumer can detect skipped frames.
+ */
+int led_commit(led_frame_t *frame);
+
+/**
+ * @brief Mark the whole strip dirty so the next commit re-sends everything
+ *
+ * Useful after the output hardware was reset or lost a frame.
+ */
+void led_mark_all_dirty(void);
+
+/**
+ * @brief Get the number of pixels currently pending for the next commit
+ *
+ * @return Sum of all dirty span lengths, or 0 if not initialized
+ */
+size_t led_get_dirty_count(void);
+
+/* ======================== Frame Buffering ======================== */
+
+/*
+ * With double or triple buffering the application renders into a back
+ * buffer while an output thread reads the last presented frame:
+ *
+ *   render thread:  led_set_pixel_color() ... led_present();
+ *   output thread:  f = led_acquire_frame(); send f->spans; led_release_frame();
+ *
+ * The consumer never sees a half-rendered frame and pixels are never
+ * copied for it. led_present() replaces led_commit() in these modes.
+ */
+
+/**
+ * @brief Number of pixel buffers per strip
+ */
+typedef enum {
+    LED_BUFFER_SINGLE = 1,   // Render and read the same buffer (led_commit())
+    LED_BUFFER_DOUBLE = 2,   // present() waits while the consumer holds the front
+    LED_BUFFER_TRIPLE = 3    // present() never waits; unread frames are replaced
+} led_buffering_t;
+
+/**
+ * @brief Select single, double or triple buffering
+ *
+ * All buffers start with the current pixel content. Call from the render
+ * thread while the consumer holds no frame.
+ *
+ * @return 0 on success, -1 on invalid mode, allocation failure or held frame
+ */
+int led_set_buffering(led_buffering_t mode);
+
+/**
+ * @brief Publish the back buffer as the newest frame and swap buffers
+ *
+ * The frame carries the spans changed since the frame the consumer last
+ * acquired (frames it never saw are merged in), so sending only those spans
+ * always keeps the hardware in sync. Afterwards the render buffer already
+ * holds the presented frame, so incremental updates continue as usual.
+ *
+ * @return 0 on success, -1 if not initialized or in single-buffer mode
+ *
+ * @note Double buffering blocks until the consumer releases its frame;
+ *       triple buffering never blocks.
+ */
+int led_present(void);
+
+/**
+ * @brief Take the newest presented frame (consumer side, non-blocking)
+ *
+ * @return Frame to read until led_release_frame(), or NULL if no new frame
+ *         was presented since the last acquire (or a frame is still held)
+ */
+const led_frame_t *led_acquire_frame(void);
+
+/**
+ * @brief Return the frame taken by led_acquire_frame()
+ */
+void led_release_frame(void);
+
+/* ======================== Bulk Operations ======================== */
+
+/*
+ * Bulk operations work on the range [start, start + count). The range is
+ * clipped to the strip, so out-of-bounds parts are silently ignored like
+ * led_set_pixel_color(). Each call marks the range dirty once and runs a
+ * SIMD kernel (see led_simd_set_level()) instead of per-pixel calls.
+ */
+
+/**
+ * @brief Fill a range of pixels with one color
+ */
+void led_fill_range(size_t start, size_t count, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Copy pre-packed 0x00GGRRBB words into the strip
+ *
+ * @param start First destination pixel
+ * @param src Source words (may overlap the strip buffer)
+ * @param count Number of pixels to copy
+ */
+void led_copy_range(size_t start, const uint32_t *src, size_t count);
+
+/**
+ * @brief Scale each channel of a range by scale/255 (brightness)
+ *
+ * A scale of 255 keeps the channel unchanged, 0 turns it off.
+ */
+void led_scale_range(size_t start, size_t count,
+                     uint8_t scale_r, uint8_t scale_g, uint8_t scale_b);
+
+/**
+ * @brief Alpha-blend src over the strip: out = src * a + strip * (1 - a)
+ *
+ * @param start First destination pixel
+ * @param src Source words in 0x00GGRRBB format
+ * @param count Number of pixels to blend
+ * @param alpha Weight of src (0 = keep strip, 255 = copy src)
+ */
+void led_blend_range(size_t start, const uint32_t *src, size_t count, uint8_t alpha);
+
+/**
+ * @brief Replace every channel value v of a range by lut[v] (e.g. gamma)
+ */
+void led_apply_lut(size_t start, size_t count, const uint8_t lut[256]);
+
+/**
+ * @brief Pack planar R, G and B arrays into the strip in G-R-B order
+ *
+ * @param start First destination pixel
+ * @param r Red plane, count bytes
+ * @param g Green plane, count bytes
+ * @param b Blue plane, count bytes
+ * @param count Number of pixels
+ */
+void led_pack_planar(size_t start, const uint8_t *r, const uint8_t *g,
+                     const uint8_t *b, size_t count);
+
+/**
+ * @brief Instruction set used by the bulk operations
+ */
+typedef enum {
+    LED_SIMD_SCALAR = 0,   // Portable C loops
+    LED_SIMD_SSE2,         // 4 pixels per instruction (x86)
+    LED_SIMD_AVX2          // 8 pixels per instruction (x86)
+} led_simd_level_t;
+
+/**
+ * @brief Get the active SIMD level (the best supported one by default)
+ */
+led_simd_level_t led_simd_get_level(void);
+
+/**
+ * @brief Force a SIMD level, e.g. for benchmarks or to compare results
+ *
+ * @return 0 on success, -1 if the CPU does not support the level
+ */
+int led_simd_set_level(led_simd_level_t level);
+// Note: the level is process-wide; change it only while no strip is rendering
+
+/**
+ * @brief Get a printable name for a SIMD level ("scalar", "sse2", "avx2")
+ */
+const char *led_simd_level_name(led_simd_level_t level);
+
 /**
  * @brief Print the entire LED buffer in hexadecimal format
  * 
@@ -108,6 +339,306 @@ uint32_t led_get_pixel(size_t index);
  */
 void led_print_buffer(void);
 
+/* ======================== Multi-Strip API ======================== */
+
+/*
+ * Every led_strip_*() function behaves like its single-strip counterpart
+ * above, on the given strip. Strips share no state or locks, so different
+ * strips can be updated from different threads concurrently; a single strip
+ * must not be used from two threads at once. NULL strips are ignored.
+ */
+
+/**
+ * @brief Opaque handle to one LED strip
+ */
+typedef struct led_strip led_strip_t;
+
+/**
+ * @brief Create a strip with all pixels black and fully dirty
+ *
+ * @param num_pixels Number of LEDs in the strip
+ * @return New strip, or NULL on failure
+ *
+ * @note Must call led_strip_destroy() to free the strip
+ */
+led_strip_t *led_strip_create(size_t num_pixels);
+
+/**
+ * @brief Free a strip created by led_strip_create()
+ */
+void led_strip_destroy(led_strip_t *strip);
+
+/**
+ * @brief Get the strip behind the single-strip API (NULL before led_init())
+ */
+led_strip_t *led_get_default_strip(void);
+
+void led_strip_set_pixel_color(led_strip_t *strip, size_t index,
+                               uint8_t r, uint8_t g, uint8_t b);
+void led_strip_fill(led_strip_t *strip, uint8_t r, uint8_t g, uint8_t b);
+void led_strip_clear(led_strip_t *strip);
+const uint32_t* led_strip_get_buffer(const led_strip_t *strip);
+size_t led_strip_get_pixel_count(const led_strip_t *strip);
+uint32_t led_strip_get_pixel(const led_strip_t *strip, size_t index);
+
+void led_strip_fill_range(led_strip_t *strip, size_t start, size_t count,
+                          uint8_t r, uint8_t g, uint8_t b);
+void led_strip_copy_range(led_strip_t *strip, size_t start,
+                          const uint32_t *src, size_t count);
+void led_strip_scale_range(led_strip_t *strip, size_t start, size_t count,
+                           uint8_t scale_r, uint8_t scale_g, uint8_t scale_b);
+void led_strip_blend_range(led_strip_t *strip, size_t start,
+                           const uint32_t *src, size_t count, uint8_t alpha);
+void led_strip_apply_lut(led_strip_t *strip, size_t start, size_t count,
+                         const uint8_t lut[256]);
+void led_strip_pack_planar(led_strip_t *strip, size_t start, const uint8_t *r,
+                           const uint8_t *g, const uint8_t *b, size_t count);
+
+int led_strip_commit(led_strip_t *strip, led_frame_t *frame);
+void led_strip_mark_all_dirty(led_strip_t *strip);
+size_t led_strip_get_dirty_count(const led_strip_t *strip);
+void led_strip_print_buffer(const led_strip_t *strip);
+
+int led_strip_set_buffering(led_strip_t *strip, led_buffering_t mode);
+led_buffering_t led_strip_get_buffering(const led_strip_t *strip);
+int led_strip_present(led_strip_t *strip);
+const led_frame_t *led_strip_acquire_frame(led_strip_t *strip);
+void led_strip_release_frame(led_strip_t *strip);
+
+/* ======================== Pixel Formats ======================== */
+
+/*
+ * A strip created with led_strip_create_format() stores its pixels in a
+ * compact format. Every led_strip_*() call works on every format through
+ * a per-format function table chosen at creation, so bulk operations run
+ * a loop specialized for the format. Only LED_FORMAT_GRB32 uses the SIMD
+ * kernels; led_strip_get_buffer() and frame->buffer are NULL for formats
+ * that are not 32-bit words (use frame->data or led_strip_unpack_pixels()),
+ * except LED_FORMAT_RGBW64, whose frames carry their dithered 8-bit colors
+ * in frame->buffer and frame->data (see High Color Depth).
+ */
+
+/**
+ * @brief Create a strip that stores pixels in the given format
+ *
+ * LED_FORMAT_PAL8 strips start with a 3-3-2 palette (8 reds x 8 greens x
+ * 4 blues); led_strip_set_pixel_color() stores the closest palette color.
+ *
+ * @return Strip handle, or NULL on invalid arguments / allocation failure
+ */
+led_strip_t *led_strip_create_format(size_t num_pixels, led_pixel_format_t format);
+
+led_pixel_format_t led_strip_get_format(const led_strip_t *strip);
+
+/**
+ * @brief Bytes per pixel of a format (0 for unknown formats)
+ */
+size_t led_format_bytes_per_pixel(led_pixel_format_t format);
+
+const char *led_format_name(led_pixel_format_t format);
+
+/**
+ * @brief Heap bytes used by a strip (all pixel buffers and the palette)
+ */
+size_t led_strip_get_memory(const led_strip_t *strip);
+
+/**
+ * @brief Raw pixel storage of the render buffer
+ */
+const void *led_strip_get_data(const led_strip_t *strip);
+
+/**
+ * @brief Convert pixels to 0x00GGRRBB words (e.g. before led_encode())
+ *
+ * @param strip Strip that owns the data (format and palette)
+ * @param data Raw pixels (frame->data), or NULL for the render buffer
+ * @param start First pixel to convert
+ * @param out Destination, count words
+ * @param count Number of pixels (clipped to the strip)
+ */
+void led_strip_unpack_pixels(const led_strip_t *strip, const void *data, size_t start,
+                             uint32_t *out, size_t count);
+
+/**
+ * @brief Set a pixel including its white channel (ignored by non-RGBW formats)
+ */
+void led_strip_set_pixel_rgbw(led_strip_t *strip, size_t index,
+                              uint8_t r, uint8_t g, uint8_t b, uint8_t w);
+
+/**
+ * @brief Replace the palette of a LED_FORMAT_PAL8 strip
+ *
+ * Stored indices keep their value and now show the new colors, so the
+ * whole strip is marked dirty. Builds a 32K-entry nearest-color table
+ * used by led_strip_set_pixel_color() and the bulk operations.
+ *
+ * @param colors 0x00GGRRBB colors
+ * @param count 1 to 256
+ * @return 0 on success, -1 if the strip is not PAL8 or count is invalid
+ */
+int led_strip_set_palette(led_strip_t *strip, const uint32_t *colors, size_t count);
+
+/**
+ * @brief Store a palette index directly (PAL8 only, index < palette size)
+ */
+void led_strip_set_pixel_index(led_strip_t *strip, size_t index, uint8_t palette_index);
+
+/* ======================== Color Pipeline ======================== */
+
+/*
+ * Colors can be given as HSV or HSL instead of R, G, B. Gamma, white point,
+ * brightness and a power budget are applied by the driver when a frame is
+ * committed or presented, not on every set call: the dirty spans run
+ * through one per-channel lookup table (SIMD) into a separate output
+ * buffer, and frame->buffer / frame->data point at that output. The render
+ * buffer (led_get_buffer(), led_get_pixel()) keeps the colors as set, so
+ * corrections never accumulate and changing them needs no re-render.
+ * Only 32-bit formats (GRB32, RGBW32) support correction.
+ */
+
+/**
+ * @brief Convert HSV to a 0x00GGRRBB color
+ *
+ * @param hue Hue in degrees (0 red, 120 green, 240 blue; wraps at 360)
+ * @param sat Saturation (0 = gray, 255 = pure hue)
+ * @param val Value (0 = black, 255 = full)
+ */
+uint32_t led_color_hsv(uint16_t hue, uint8_t sat, uint8_t val);
+
+/**
+ * @brief Convert HSL to a 0x00GGRRBB color
+ *
+ * @param hue Hue in degrees (wraps at 360)
+ * @param sat Saturation (0 = gray, 255 = pure hue)
+ * @param light Lightness (0 = black, 128 = pure hue, 255 = white)
+ */
+uint32_t led_color_hsl(uint16_t hue, uint8_t sat, uint8_t light);
+
+void led_set_pixel_hsv(size_t index, uint16_t hue, uint8_t sat, uint8_t val);
+void led_strip_set_pixel_hsv(led_strip_t *strip, size_t index,
+                             uint16_t hue, uint8_t sat, uint8_t val);
+void led_strip_set_pixel_hsl(led_strip_t *strip, size_t index,
+                             uint16_t hue, uint8_t sat, uint8_t light);
+
+/**
+ * @brief Output correction of a strip
+ *
+ * Zero fields select the default, so { 0 } is a neutral correction.
+ */
+typedef struct {
+    float gamma[4];                // Exponent per channel R, G, B, W (0 = 1.0, linear)
+    uint32_t temperature;          // White point in kelvin, 1000-40000 (0 = off)
+    uint32_t max_milliamps;        // Power budget of the strip (0 = unlimited)
+    uint32_t channel_microamps;    // Current of one channel at 255 (0 = 20000, WS2812B)
+    uint32_t idle_microamps;       // Current of one dark LED
+} led_correction_config_t;
+
+/**
+ * @brief Current estimate of the last corrected frame
+ */
+typedef struct {
+    uint32_t requested_milliamps;  // Before the power limit (estimated from the output)
+    uint32_t output_milliamps;     // As sent
+    uint32_t scale;                // Power limit factor in 1/256 (256 = not limited)
+} led_power_info_t;
+
+/**
+ * @brief Set or change the output correction of a strip
+ *
+ * The next frame re-corrects and re-sends the whole strip. Call from the
+ * render thread.
+ *
+ * @param config Correction, or NULL to send uncorrected colors again
+ * @return int 0 on success, -1 on invalid settings, a format other than
+ *         GRB32 / RGBW32, allocation failure, or (NULL) a held frame
+ */
+int led_strip_set_correction(led_strip_t *strip, const led_correction_config_t *config);
+
+/**
+ * @brief Scale all output channels by brightness/255
+ *
+ * Enables a neutral correction if none is set. Applied with the rest of
+ * the correction at the next commit / present.
+ *
+ * @return int 0 on success, -1 if the strip cannot be corrected
+ */
+int led_strip_set_brightness(led_strip_t *strip, uint8_t brightness);
+uint8_t led_strip_get_brightness(const led_strip_t *strip);
+
+/**
+ * @brief Estimated current of the last committed / presented frame
+ *
+ * The frame's channel sum times channel_microamps / 255, plus
+ * idle_microamps per LED. When the estimate exceeds max_milliamps, every
+ * channel is scaled down (the whole strip is re-sent) until it fits;
+ * the scale recovers once frames draw less.
+ *
+ * @return int 0 on success, -1 if the strip has no correction
+ */
+int led_strip_get_power(const led_strip_t *strip, led_power_info_t *info);
+
+int led_set_correction(const led_correction_config_t *config);
+int led_set_brightness(uint8_t brightness);
+
+/* ======================== High Color Depth ======================== */
+
+/*
+ * LED_FORMAT_RGBW64 strips keep 16 bits per channel, so dim colors and
+ * slow fades do not collapse onto a few 8-bit levels. The LEDs still take
+ * 8 bits: commit / present quantizes the buffer into a 0xWWGGRRBB output
+ * with the strip's dither mode. frame->buffer and frame->data both point
+ * at that output and frame->format is LED_FORMAT_RGBW32; the render buffer
+ * keeps the 16-bit pixels. 16-bit colors are 0xWWWWGGGGRRRRBBBB words. The
+ * 8-bit setters and bulk operations work on these strips too (a byte v is
+ * stored as v * 257, and scale / blend / LUT keep 16 bits of precision).
+ */
+
+/**
+ * @brief How RGBW64 strips are quantized to 8 bits per channel
+ */
+typedef enum {
+    LED_DITHER_NONE = 0,   // Round to the nearest level (default)
+    LED_DITHER_ORDERED,    // Fixed threshold pattern over 16 neighbouring pixels
+    LED_DITHER_TEMPORAL    // Each pixel carries its rounding error to the next frame
+} led_dither_t;
+
+/**
+ * @brief Select the dither mode of an RGBW64 strip
+ *
+ * NONE and ORDERED output depends only on the pixel, so commits stay
+ * incremental. TEMPORAL averages to the exact 16-bit value over a few
+ * frames, but a pixel between two levels changes every frame: each commit
+ * quantizes the whole strip and reports the blocks whose output changed.
+ * Changing the mode re-sends the whole strip. Call from the render thread.
+ *
+ * @return int 0 on success, -1 for other formats, an invalid mode or
+ *         allocation failure
+ */
+int led_strip_set_dither(led_strip_t *strip, led_dither_t mode);
+led_dither_t led_strip_get_dither(const led_strip_t *strip);
+
+/**
+ * @brief Set a pixel with 16 bits per channel (0-65535)
+ *
+ * Other formats store the nearest 8-bit color.
+ */
+void led_strip_set_pixel_color16(led_strip_t *strip, size_t index,
+                                 uint16_t r, uint16_t g, uint16_t b);
+void led_strip_set_pixel_rgbw16(led_strip_t *strip, size_t index,
+                                uint16_t r, uint16_t g, uint16_t b, uint16_t w);
+void led_strip_fill16(led_strip_t *strip, uint16_t r, uint16_t g, uint16_t b);
+
+/**
+ * @brief Copy 0xWWWWGGGGRRRRBBBB colors into [start, start + count)
+ */
+void led_strip_copy_range16(led_strip_t *strip, size_t start,
+                            const uint64_t *src, size_t count);
+
+/**
+ * @brief Get a pixel as 0xWWWWGGGGRRRRBBBB (8-bit formats: each byte * 257)
+ */
+uint64_t led_strip_get_pixel16(const led_strip_t *strip, size_t index);
+
 /* Color Constants - Common colors in 32-bit format (0x00GGRRBB) */
 #define LED_COLOR_BLACK     0x00000000
 #define LED_COLOR_WHITE     0x00FFFFFF
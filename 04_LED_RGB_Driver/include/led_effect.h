@@ -0,0 +1,145 @@
+/**
+ * @file led_effect.h
+ * @brief Effect / animation engine: time-based effects composed in layers
+ *
+ * A scene holds up to LED_SCENE_MAX_LAYERS layers. Each layer runs one
+ * effect (rainbow, chase, fade, twinkle, fire or a user keyframe track)
+ * and is composited onto the layers below it with a blend mode and an
+ * opacity. led_scene_render() produces the frame for a timestamp in
+ * milliseconds, so playback speed does not depend on the frame rate.
+ *
+ * Rendering uses integer math only: time is turned into a 16-bit phase,
+ * hues, heat colors and twinkle curves come from 256-entry tables built
+ * once, and keyframe tracks are validated and stored as per-channel
+ * deltas when the layer is added. Colors are 0x00GGRRBB like led_driver.
+ */
+
+#ifndef LED_EFFECT_H
+#define LED_EFFECT_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+/**
+ * @brief Maximum number of layers in a scene
+ */
+#define LED_SCENE_MAX_LAYERS 8
+
+/**
+ * @brief Built-in effects
+ */
+typedef enum {
+    LED_EFFECT_RAINBOW = 0,    // Hue gradient scrolling along the strip
+    LED_EFFECT_CHASE,          // Lit segments moving over a background color
+    LED_EFFECT_FADE,           // Whole strip fading color -> color2 -> color
+    LED_EFFECT_TWINKLE,        // Random pixels fading in and out
+    LED_EFFECT_FIRE,           // Heat simulation rising from pixel 0
+    LED_EFFECT_KEYFRAMES       // Whole strip following a keyframe track
+} led_effect_type_t;
+
+/**
+ * @brief How a layer is combined with the layers below it
+ *
+ * The mode computes a result from the lower layers (dst) and the layer
+ * (src); the result is then mixed into dst with the layer opacity.
+ */
+typedef enum {
+    LED_BLEND_NORMAL = 0,      // src
+    LED_BLEND_ADD,             // dst + src, saturated
+    LED_BLEND_MULTIPLY,        // dst * src / 255
+    LED_BLEND_SCREEN,          // 255 - (255 - dst) * (255 - src) / 255
+    LED_BLEND_MAX              // max(dst, src) per channel
+} led_blend_mode_t;
+
+/**
+ * @brief One point of a keyframe track
+ */
+typedef struct {
+    uint32_t time_ms;          // Strictly increasing along the track
+    uint32_t color;            // 0x00GGRRBB
+} led_keyframe_t;
+
+/**
+ * @brief Effect settings (fields not used by an effect are ignored)
+ */
+typedef struct {
+    led_effect_type_t type;
+    uint32_t period_ms;        // One cycle; fire: one simulation step (0 = 1000, fire 16)
+    uint32_t color;            // Chase segments, fade start, twinkle color
+    uint32_t color2;           // Chase background, fade end
+    uint32_t length;           // Rainbow: pixels per hue cycle (0 = strip); chase: lit pixels (0 = 1)
+    uint32_t spacing;          // Chase: distance between segment starts (0 = 2 x length)
+    uint8_t density;           // Twinkle: share of lit pixels; fire: spark chance (0-255)
+    uint8_t cooling;           // Fire: how fast heat fades (0-255)
+    uint32_t seed;             // Twinkle / fire random seed
+    const led_keyframe_t *keyframes;   // Keyframe track (copied by led_scene_add_layer)
+    size_t num_keyframes;
+    bool loop;                 // Keyframes: restart after the last keyframe instead of holding it
+} led_effect_config_t;
+
+/**
+ * @brief Opaque scene type
+ */
+typedef struct led_scene led_scene_t;
+
+/**
+ * @brief Create an empty scene (renders black until a layer is added)
+ *
+ * @param num_pixels Number of pixels rendered per frame
+ * @return led_scene_t* New scene, or NULL on failure
+ */
+led_scene_t *led_scene_create(size_t num_pixels);
+
+/**
+ * @brief Free a scene and its layers
+ */
+void led_scene_destroy(led_scene_t *scene);
+
+/**
+ * @brief Add a layer on top of the existing ones
+ *
+ * @param scene Scene to extend
+ * @param effect Effect settings (keyframes are copied)
+ * @param mode Blend mode
+ * @param opacity 0 (invisible) to 255 (full)
+ * @return int Layer index, or -1 if the settings are invalid or the scene is full
+ */
+int led_scene_add_layer(led_scene_t *scene, const led_effect_config_t *effect,
+                        led_blend_mode_t mode, uint8_t opacity);
+
+/**
+ * @brief Change the opacity of a layer (e.g. to cross-fade two effects)
+ */
+void led_scene_set_opacity(led_scene_t *scene, int layer, uint8_t opacity);
+
+/**
+ * @brief Apply a gamma curve to every rendered frame
+ *
+ * @param scene Scene to configure
+ * @param gamma Exponent (2.2 suits WS2812B); 1.0 or less disables correction
+ */
+void led_scene_set_gamma(led_scene_t *scene, double gamma);
+
+/**
+ * @brief Render the frame at a timestamp
+ *
+ * Fire layers advance their simulation by the time elapsed since the
+ * previous render; all other effects depend only on time_ms.
+ *
+ * @param scene Scene to render
+ * @param time_ms Timestamp in milliseconds
+ * @return const uint32_t* Rendered pixels, valid until the next render
+ */
+const uint32_t *led_scene_render(led_scene_t *scene, uint32_t time_ms);
+
+/**
+ * @brief Render the frame at a timestamp into a strip
+ *
+ * Copies min(scene, strip) pixels starting at pixel 0; they are marked
+ * dirty for the next commit or present.
+ *
+ * @return int 0 on success, -1 on invalid arguments
+ */
+int led_scene_render_to(led_scene_t *scene, led_strip_t *strip, uint32_t time_ms);
+
+#endif // LED_EFFECT_H
@@ -0,0 +1,182 @@
+/**
+ * @file led_encoder.h
+ * @brief WS2812B waveform encoder: pixel buffer -> SPI / PWM DMA buffers
+ *
+ * WS2812B LEDs read a single-wire signal where every bit is a high pulse
+ * followed by a low pulse; a short high means 0, a long high means 1. The
+ * encoder turns 0x00GGRRBB pixels (as stored by led_driver) into buffers a
+ * peripheral can clock out unchanged:
+ *
+ * - LED_ENCODE_SPI_3BIT: 3 SPI bits per LED bit (100 / 110), 9 bytes/pixel
+ * - LED_ENCODE_SPI_4BIT: 4 SPI bits per LED bit (1000 / 1110), 12 bytes/pixel
+ * - LED_ENCODE_PWM: one 16-bit timer compare value per LED bit, 48 bytes/pixel
+ *
+ * Every buffer ends with a run of zero bytes (low line / 0% duty) that
+ * latches the frame. Bits are sent G, R, B, most significant bit first.
+ */
+
+#ifndef LED_ENCODER_H
+#define LED_ENCODER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Largest encoded pixel (PWM: 24 x 16-bit duties)
+ */
+#define LED_ENCODE_MAX_PIXEL_BYTES 48
+
+/**
+ * @brief Output format of the encoder
+ */
+typedef enum {
+    LED_ENCODE_SPI_3BIT = 0,   // SPI at ~2.4 MHz, LED bit = 100 / 110
+    LED_ENCODE_SPI_4BIT,       // SPI at ~3.2 MHz, LED bit = 1000 / 1110
+    LED_ENCODE_PWM             // Timer PWM + DMA, one compare value per LED bit
+} led_encoding_t;
+
+/**
+ * @brief Accepted pulse widths in nanoseconds
+ */
+typedef struct {
+    uint32_t t0h_min, t0h_max;     // High time of a 0 bit
+    uint32_t t0l_min, t0l_max;     // Low time of a 0 bit
+    uint32_t t1h_min, t1h_max;     // High time of a 1 bit
+    uint32_t t1l_min, t1l_max;     // Low time of a 1 bit
+    uint32_t reset_min;            // Low time that latches the data
+} led_timing_t;
+
+/**
+ * @brief WS2812B datasheet limits (+-150 ns around 400/850 and 800/450 ns)
+ *
+ * reset_min is 280 us, required by recent WS2812B revisions (older parts
+ * latch after 50 us).
+ */
+extern const led_timing_t LED_TIMING_WS2812B;
+
+/**
+ * @brief Encoder settings
+ */
+typedef struct {
+    led_encoding_t encoding;
+    uint32_t clock_hz;             // SPI bit clock, or PWM timer tick frequency
+    uint32_t reset_us;             // Latch time appended to each frame (0 = 300 us)
+    const led_timing_t *timing;    // Limits to validate against (NULL = WS2812B)
+} led_encoder_config_t;
+
+/**
+ * @brief Encoder state derived from the configuration (read-only)
+ */
+typedef struct {
+    led_encoding_t encoding;
+    uint32_t clock_hz;
+    size_t bytes_per_pixel;        // 9, 12 or 48
+    size_t reset_bytes;            // Zero bytes appended after the pixels
+    uint16_t pwm_period;           // Timer ticks per LED bit (program into the auto-reload)
+    uint16_t pwm_t0h;              // Compare value of a 0 bit
+    uint16_t pwm_t1h;              // Compare value of a 1 bit
+    uint32_t t0h_ns, t0l_ns;       // Resulting waveform
+    uint32_t t1h_ns, t1l_ns;
+} led_encoder_t;
+
+/**
+ * @brief Incremental encoding state, see led_encode_stream_next()
+ */
+typedef struct {
+    const led_encoder_t *encoder;
+    const uint32_t *pixels;
+    size_t num_pixels;
+    size_t next_pixel;             // First pixel not encoded yet
+    size_t reset_left;             // Latch bytes still to emit
+    uint16_t partial[LED_ENCODE_MAX_PIXEL_BYTES / 2];  // Pixel split across two chunks
+    size_t partial_len;
+    size_t partial_pos;
+} led_encode_stream_t;
+
+/**
+ * @brief Result of led_decode()
+ */
+typedef struct {
+    size_t bits;                   // LED bits decoded
+    size_t timing_errors;          // Bits with a high or low time out of limits
+    size_t first_error_bit;        // Index of the first bad bit (SIZE_MAX if none)
+    bool latched;                  // Data was followed by a valid reset
+} led_decode_report_t;
+
+/**
+ * @brief Set up an encoder
+ *
+ * Computes the pulse widths produced at config->clock_hz and rejects
+ * settings whose waveform falls outside the timing limits.
+ *
+ * @param encoder Encoder to initialize
+ * @param config Encoding, clock and latch time
+ * @return int 0 on success, -1 if the configuration is invalid
+ */
+int led_encoder_init(led_encoder_t *encoder, const led_encoder_config_t *config);
+
+/**
+ * @brief Size of a fully encoded frame
+ *
+ * @param encoder Initialized encoder
+ * @param num_pixels Number of pixels in the frame
+ * @return size_t Bytes including the latch padding
+ */
+size_t led_encoded_size(const led_encoder_t *encoder, size_t num_pixels);
+
+/**
+ * @brief Encode a whole frame in one call
+ *
+ * @param encoder Initialized encoder
+ * @param pixels Pixel buffer (e.g. led_get_buffer() or frame->buffer)
+ * @param num_pixels Number of pixels
+ * @param out Output buffer
+ * @param capacity Size of out in bytes
+ * @return size_t Bytes written, 0 if capacity < led_encoded_size()
+ */
+size_t led_encode(const led_encoder_t *encoder, const uint32_t *pixels,
+                  size_t num_pixels, void *out, size_t capacity);
+
+/**
+ * @brief Start encoding a frame in chunks
+ *
+ * Used to feed a small (e.g. double-buffered DMA) output buffer instead of
+ * holding the whole encoded frame in memory.
+ */
+void led_encode_stream_begin(led_encode_stream_t *stream, const led_encoder_t *encoder,
+                             const uint32_t *pixels, size_t num_pixels);
+
+/**
+ * @brief Encode the next chunk of the frame
+ *
+ * Fills out completely unless the frame ends; any capacity works (pixels
+ * are split across chunks when needed). For PWM use an even capacity so
+ * chunks hold whole 16-bit values.
+ *
+ * @return size_t Bytes written, 0 when the frame (including latch) is done
+ */
+size_t led_encode_stream_next(led_encode_stream_t *stream, void *out, size_t capacity);
+
+/**
+ * @brief Decode an encoded buffer and check its bit timing
+ *
+ * Reconstructs the line waveform from the buffer and the encoder clock,
+ * classifies every high/low pulse pair against the timing limits the way
+ * an LED would, and stops at the first reset. Used to validate encoder
+ * output without hardware.
+ *
+ * @param encoder Encoder that describes the buffer format and clock
+ * @param data Encoded buffer
+ * @param size Size of data in bytes
+ * @param timing Limits to check (NULL = WS2812B)
+ * @param pixels Decoded pixels (0x00GGRRBB), may be NULL
+ * @param max_pixels Capacity of pixels
+ * @param report Bit count, timing errors and latch status, may be NULL
+ * @return int Number of complete pixels decoded, -1 on invalid arguments
+ */
+int led_decode(const led_encoder_t *encoder, const void *data, size_t size,
+               const led_timing_t *timing, uint32_t *pixels, size_t max_pixels,
+               led_decode_report_t *report);
+
+#endif // LED_ENCODER_H
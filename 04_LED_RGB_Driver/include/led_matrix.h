@@ -0,0 +1,149 @@
+/**
+ * @file led_matrix.h
+ * @brief 2D LED matrices: coordinate mapping and parallel tiled rendering
+ *
+ * A matrix describes how a 2D panel (or a grid of chained panels) is wired
+ * as one strip: row or column order, serpentine wiring and the corner the
+ * data line starts in. The (x, y) -> strip index table is computed once at
+ * creation, so drawing never evaluates the wiring per pixel.
+ *
+ * led_matrix_render() runs a per-pixel shader over the whole matrix. The
+ * matrix is cut into LED_MATRIX_TILE x LED_MATRIX_TILE tiles that the
+ * threads of a render pool take one at a time, and every result is written
+ * straight to its wire position. (0, 0) is the top-left pixel.
+ */
+
+#ifndef LED_MATRIX_H
+#define LED_MATRIX_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+/**
+ * @brief Edge length of a render tile in pixels
+ */
+#define LED_MATRIX_TILE 32
+
+/**
+ * @brief Direction the data line runs through a panel
+ */
+typedef enum {
+    LED_MATRIX_ROWS = 0,       // Along a row, then the next row
+    LED_MATRIX_COLUMNS         // Down a column, then the next column
+} led_matrix_order_t;
+
+/**
+ * @brief Matrix geometry and wiring
+ *
+ * With panels, the panels are chained left to right, then top to bottom,
+ * and every panel is wired the same way.
+ */
+typedef struct {
+    uint32_t width;            // Pixels per row of the whole matrix
+    uint32_t height;           // Rows of the whole matrix
+    uint32_t panel_width;      // 0 = one panel as wide as the matrix
+    uint32_t panel_height;     // 0 = one panel as high as the matrix
+    led_matrix_order_t order;
+    bool serpentine;           // Every other row (column) runs backwards
+    bool flip_x;               // Data line starts on the right of each panel
+    bool flip_y;               // Data line starts at the bottom of each panel
+} led_matrix_config_t;
+
+/**
+ * @brief Per-pixel shader: color (0x00GGRRBB) of pixel (x, y) at time_ms
+ *
+ * Called concurrently from every thread of the render pool, so it must
+ * only read shared state.
+ */
+typedef uint32_t (*led_shader_fn)(uint32_t x, uint32_t y, uint32_t time_ms, void *user);
+
+/**
+ * @brief Opaque matrix and render pool types
+ */
+typedef struct led_matrix led_matrix_t;
+typedef struct led_render_pool led_render_pool_t;
+
+/**
+ * @brief Create a matrix mapping
+ *
+ * @param config Geometry; width and height must be multiples of the panel size
+ * @return led_matrix_t* New matrix, or NULL on invalid settings or allocation failure
+ */
+led_matrix_t *led_matrix_create(const led_matrix_config_t *config);
+
+/**
+ * @brief Free a matrix
+ */
+void led_matrix_destroy(led_matrix_t *matrix);
+
+/**
+ * @brief Number of pixels (width x height), the strip length to create
+ */
+size_t led_matrix_get_pixel_count(const led_matrix_t *matrix);
+
+/**
+ * @brief Strip index of pixel (x, y)
+ *
+ * @return size_t Index, or SIZE_MAX if (x, y) is outside the matrix
+ */
+size_t led_matrix_index(const led_matrix_t *matrix, uint32_t x, uint32_t y);
+
+/**
+ * @brief Precomputed strip indices, table[y * width + x]
+ */
+const uint32_t *led_matrix_get_index_table(const led_matrix_t *matrix);
+
+/**
+ * @brief Set pixel (x, y) of a strip wired as this matrix (ignored outside)
+ */
+void led_matrix_set_pixel(const led_matrix_t *matrix, led_strip_t *strip,
+                          uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b);
+
+/**
+ * @brief Create a pool of render threads
+ *
+ * The calling thread renders tiles too, so a pool of N threads starts
+ * N - 1 workers. A pool runs one render at a time.
+ *
+ * @param num_threads Threads per render (1 = render on the caller only)
+ * @return led_render_pool_t* New pool, or NULL on failure
+ */
+led_render_pool_t *led_render_pool_create(size_t num_threads);
+
+/**
+ * @brief Stop the worker threads and free the pool
+ */
+void led_render_pool_destroy(led_render_pool_t *pool);
+
+/**
+ * @brief Threads taking part in a render (workers + caller)
+ */
+size_t led_render_pool_get_threads(const led_render_pool_t *pool);
+
+/**
+ * @brief Run a shader over every pixel, in parallel tiles
+ *
+ * @param pool Render pool (NULL = render on the calling thread)
+ * @param matrix Matrix mapping
+ * @param shader Per-pixel shader
+ * @param user Passed to the shader
+ * @param time_ms Passed to the shader
+ * @param out Output in strip (wire) order, led_matrix_get_pixel_count() words
+ * @return int 0 on success, -1 on invalid arguments
+ */
+int led_matrix_render(led_render_pool_t *pool, const led_matrix_t *matrix,
+                      led_shader_fn shader, void *user, uint32_t time_ms, uint32_t *out);
+
+/**
+ * @brief Run a shader over every pixel and copy the frame into a strip
+ *
+ * Renders into a buffer owned by the matrix, then copies min(matrix,
+ * strip) pixels into the strip and marks them dirty.
+ *
+ * @return int 0 on success, -1 on invalid arguments
+ */
+int led_matrix_render_to(led_render_pool_t *pool, led_matrix_t *matrix,
+                         led_shader_fn shader, void *user, uint32_t time_ms,
+                         led_strip_t *strip);
+
+#endif // LED_MATRIX_H
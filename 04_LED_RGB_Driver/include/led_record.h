@@ -0,0 +1,183 @@
+/**
+ * @file led_record.h
+ * @brief Frame recording and replay (.ledrec files)
+ *
+ * A recording is a 16-byte file header followed by frames. Every frame is
+ * a 12-byte header (timestamp, type, payload size) and a payload of
+ * run-length operations against a reference: the previous frame for delta
+ * frames, all black for key frames (written every keyframe_interval frames
+ * so replay can seek). All integers are little-endian.
+ *
+ *   File header   "LREC" | u16 version | u8 format | u8 bytes/color |
+ *                 u32 num_pixels | u32 keyframe_interval
+ *   Frame header  u32 time_ms | u8 type (0 key, 1 delta) | 3 x u8 0 |
+ *                 u32 payload_bytes
+ *   Operation     u8 kind << 6 | (count - 1), count 64+ as 63 + varint
+ *                 kind 0 SKIP:    count pixels equal to the reference
+ *                 kind 1 RUN:     count pixels of one color, 1 color follows
+ *                 kind 2 LITERAL: count pixels, count colors follow
+ *
+ * Colors are the 0x00GGRRBB words of led_strip_get_pixel() stored as B, R,
+ * G (and W for RGBW32 strips) bytes. Pixels not covered at the end of a
+ * payload are SKIP. Frames carry no trailer, so a recording cut short by a
+ * crash still replays up to its last complete frame.
+ */
+
+#ifndef LED_RECORD_H
+#define LED_RECORD_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+/**
+ * @brief Key frame spacing used when 0 is passed to led_recorder_open()
+ */
+#define LED_RECORD_KEYFRAME_INTERVAL 60
+
+/**
+ * @brief Frame types
+ */
+typedef enum {
+    LED_RECORD_KEY = 0,        // Encoded against black, decodable on its own
+    LED_RECORD_DELTA           // Encoded against the previous frame
+} led_record_frame_type_t;
+
+/**
+ * @brief Recording properties (also the recorder's running totals)
+ */
+typedef struct {
+    size_t num_pixels;
+    led_pixel_format_t format;         // Format of the recorded strip
+    size_t keyframe_interval;
+    size_t frames;
+    size_t keyframes;
+    uint32_t duration_ms;              // Timestamp of the last frame
+    uint64_t raw_bytes;                // Frames stored uncompressed (bytes/color per pixel)
+    uint64_t file_bytes;               // Size of the recording
+} led_record_info_t;
+
+/**
+ * @brief One frame of a recording, see led_replay_get_frame_info()
+ */
+typedef struct {
+    uint32_t time_ms;
+    led_record_frame_type_t type;
+    size_t payload_bytes;
+    size_t changed_pixels;             // Pixels written by RUN / LITERAL operations
+} led_record_frame_info_t;
+
+/**
+ * @brief Opaque recorder and replay types
+ */
+typedef struct led_recorder led_recorder_t;
+typedef struct led_replay led_replay_t;
+
+/* ======================== Recording ======================== */
+
+/**
+ * @brief Create a recording file
+ *
+ * @param path File to create (truncated if it exists)
+ * @param num_pixels Pixels per frame
+ * @param format Format of the strip being recorded (RGBW32 keeps the W byte)
+ * @param keyframe_interval Frames between key frames (0 = LED_RECORD_KEYFRAME_INTERVAL)
+ * @return led_recorder_t* New recorder, or NULL on failure
+ */
+led_recorder_t *led_recorder_open(const char *path, size_t num_pixels,
+                                  led_pixel_format_t format, size_t keyframe_interval);
+
+/**
+ * @brief Append a frame
+ *
+ * @param recorder Recorder
+ * @param pixels num_pixels colors (0x00GGRRBB)
+ * @param time_ms Timestamp, not earlier than the previous frame
+ * @return int 0 on success, -1 on invalid arguments or write failure
+ */
+int led_recorder_add_frame(led_recorder_t *recorder, const uint32_t *pixels, uint32_t time_ms);
+
+/**
+ * @brief Append the current contents of a strip
+ */
+int led_recorder_capture(led_recorder_t *recorder, const led_strip_t *strip, uint32_t time_ms);
+
+/**
+ * @brief Running totals of a recorder
+ */
+void led_recorder_get_info(const led_recorder_t *recorder, led_record_info_t *info);
+
+/**
+ * @brief Flush and close the file, then free the recorder
+ *
+ * @return int 0 on success, -1 if writing failed at any point
+ */
+int led_recorder_close(led_recorder_t *recorder);
+
+/* ======================== Replay ======================== */
+
+/**
+ * @brief Map a recording and index its frames
+ *
+ * @return led_replay_t* Replay handle, or NULL if the file is not a valid recording
+ */
+led_replay_t *led_replay_open(const char *path);
+
+/**
+ * @brief Unmap the recording and free the handle
+ */
+void led_replay_close(led_replay_t *replay);
+
+/**
+ * @brief Recording properties
+ */
+void led_replay_get_info(const led_replay_t *replay, led_record_info_t *info);
+
+/**
+ * @brief Header of one frame (changed_pixels is counted by parsing the payload)
+ *
+ * @return int 0 on success, -1 if index is out of range or the payload is corrupt
+ */
+int led_replay_get_frame_info(const led_replay_t *replay, size_t index,
+                              led_record_frame_info_t *info);
+
+/**
+ * @brief Decode a frame
+ *
+ * Consecutive frames are decoded incrementally; other frames are decoded
+ * from the closest key frame before them.
+ *
+ * @return const uint32_t* num_pixels colors, valid until the next call on
+ *         this handle, or NULL if index is out of range or the data is corrupt
+ */
+const uint32_t *led_replay_frame(led_replay_t *replay, size_t index);
+
+/**
+ * @brief Write a frame into a strip
+ *
+ * When index follows the previously applied frame only the pixels that
+ * differ are written, so the strip's dirty spans match the recording.
+ * Otherwise the whole frame is written.
+ *
+ * @return int 0 on success, -1 on invalid arguments or corrupt data
+ */
+int led_replay_apply(led_replay_t *replay, size_t index, led_strip_t *strip);
+
+/**
+ * @brief Called after each frame of led_replay_play(); return non-zero to stop
+ */
+typedef int (*led_replay_fn)(led_strip_t *strip, size_t index, void *user);
+
+/**
+ * @brief Play the whole recording into a strip at its recorded timing
+ *
+ * @param replay Replay handle
+ * @param strip Strip receiving the frames
+ * @param speed Playback rate (1.0 = real time, 0 = as fast as possible)
+ * @param on_frame Called after each frame (e.g. to commit or present), may be NULL
+ * @param user Passed to on_frame
+ * @return long Frames played, or -1 on error
+ */
+long led_replay_play(led_replay_t *replay, led_strip_t *strip, double speed,
+                     led_replay_fn on_frame, void *user);
+
+#endif // LED_RECORD_H
@@ -0,0 +1,1297 @@
+/**
+ * @file bench.c
+ * @brief Benchmarks for the LED driver
+ *
+ * 1. Size sweep: per-pixel, fill, bulk and encode operations on strips of
+ *    10 to 10M pixels for each SIMD level the CPU supports, in ns/pixel
+ *    and the memory bandwidth that represents. The results can be saved as
+ *    a baseline (-s) and later runs checked against it (-c): the run fails
+ *    if any measurement on a strip of SWEEP_GATE_PIXELS or more is more
+ *    than the threshold (-t, percent) slower.
+ * 2. Multi-strip rendering: many independent strips rendered by 1 to 8
+ *    threads, each thread owning a disjoint set of strips (no locks).
+ * 3. Frame buffering: a render thread presenting at 60 to 1000 fps while a
+ *    slow output thread consumes frames, for double and triple buffering.
+ * 4. WS2812B encoding: pixels/s of each wire encoding per SIMD level, whole
+ *    frame and streamed through a 4 KB chunk buffer.
+ * 5. Pixel formats: memory use and fill / scale / blend throughput of a 1M
+ *    pixel strip in every storage format.
+ * 6. Effects: frames per second and CPU time per frame of each effect and
+ *    of layered scenes rendered into a 10k pixel strip.
+ * 7. Matrix rendering: a per-pixel shader over a 256x256 serpentine matrix
+ *    with render pools of 1 to 8 threads.
+ * 8. Recording: size per frame, compression ratio, and record / replay
+ *    speed of 10k pixel effect recordings.
+ * 9. Dithering: commit time of a full 16-bit (RGBW64) frame per dither
+ *    mode and SIMD level on 10k and 100k pixel strips.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "led_driver.h"
+#include "led_encoder.h"
+#include "led_effect.h"
+#include "led_matrix.h"
+#include "led_record.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MIN_TIME_NS   50000000ULL   // Repeat each operation for at least 50 ms
+
+#define SWEEP_ROUNDS        3             // Size sweep: best of 3 rounds per measurement
+#define SWEEP_BATCH_NS      1000000ULL    // One sample: enough calls to take at least 1 ms
+#define SWEEP_SAMPLES       7             // A round takes the median of at least 7 samples
+#define SWEEP_CASE_NS       10000000ULL   // and of at least 10 ms of calls
+#define SWEEP_MAX_SAMPLES   64
+#define SWEEP_RETRIES       5             // Extra rounds for measurements failing a check
+#define SWEEP_THRESHOLD_PCT 25.0          // Default slowdown allowed by -c
+#define SWEEP_GATE_PIXELS   10000         // Smaller strips are shown but never fail -c
+
+#define MULTI_NUM_STRIPS    64            // Strips rendered per frame
+#define MULTI_STRIP_PIXELS  4096          // Pixels per strip
+#define MULTI_FRAMES        200           // Frames rendered per strip
+#define MULTI_MAX_THREADS   8
+
+#define PRESENT_PIXELS      10000         // Strip size for the buffering benchmark
+#define PRESENT_RUN_NS      500000000ULL  // Duration of one fps / mode run
+#define PRESENT_OUTPUT_NS   2000000ULL    // Output path: 2 ms per frame (500 fps max)
+#define PRESENT_MAX_FRAMES  1024
+
+#define ENCODE_PIXELS       100000        // Strip size for the encoder benchmark
+#define ENCODE_CHUNK        4096          // Streaming output buffer (bytes)
+
+#define FORMAT_PIXELS       1000000       // Strip size for the pixel format benchmark
+
+#define EFFECT_PIXELS       10000         // Strip size for the effect benchmark
+#define EFFECT_RUN_NS       200000000ULL  // Duration of one effect run
+#define EFFECT_FRAME_MS     16            // Animation time advanced per frame (60 fps)
+
+#define MATRIX_SIZE         256           // Matrix edge for the tiled rendering benchmark
+#define MATRIX_RUN_NS       300000000ULL  // Duration of one thread count run
+#define MATRIX_MAX_THREADS  8
+
+#define RECORD_PIXELS       10000         // Strip size for the recording benchmark
+#define RECORD_FRAMES       600           // 10 s at 60 fps
+#define RECORD_PATH         "/tmp/led_bench.ledrec"
+
+#define DITHER_RUN_NS       100000000ULL  // Duration of one mode / level run
+#define DITHER_FRAME_NS     16666667.0    // 60 fps frame budget
+
+/**
+ * @brief Inputs shared by all operations of one strip size
+ */
+typedef struct {
+    size_t count;
+    uint32_t *words;       // Pre-packed source for copy/blend
+    uint8_t *r;            // Planar sources for pack_planar
+    uint8_t *g;
+    uint8_t *b;
+    uint8_t lut[256];      // Gamma-like curve
+    led_encoder_t encoder; // SPI 3-bit encoder of the size sweep
+    uint8_t *encoded;      // Its output (size sweep only)
+    size_t encoded_size;
+} bench_input_t;
+
+typedef void (*bench_op_fn)(const bench_input_t *in);
+
+typedef struct {
+    const char *name;
+    bench_op_fn run;
+    size_t bytes_per_pixel;    // Bytes read + written per pixel
+    bool simd;                 // Has scalar / SSE2 / AVX2 variants
+} bench_op_t;
+
+/**
+ * @brief One measurement of the size sweep, as stored in a baseline file
+ */
+typedef struct {
+    char op[32];
+    char level[16];
+    size_t pixels;
+    double ns_per_pixel;       // Fastest round
+    double slowest;            // Slowest round: how noisy the measurement was
+} bench_result_t;
+
+/**
+ * @brief Command-line options
+ */
+typedef struct {
+    bool sweep_only;           // -q: skip sections 2 to 8
+    const char *save_path;     // -s FILE: write the sweep results as a baseline
+    const char *check_path;    // -c FILE: compare the sweep with a baseline
+    double threshold_pct;      // -t PCT: allowed slowdown before a check fails
+} bench_options_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ======================== Size sweep ======================== */
+
+static void op_set_pixel(const bench_input_t *in) {
+    for (size_t i = 0; i < in->count; i++) {
+        led_set_pixel_color(i, in->r[i], in->g[i], in->b[i]);
+    }
+}
+
+static void op_fill(const bench_input_t *in) {
+    (void)in;
+    led_fill(12, 34, 56);
+}
+
+static void op_copy(const bench_input_t *in) {
+    led_copy_range(0, in->words, in->count);
+}
+
+static void op_scale(const bench_input_t *in) {
+    led_scale_range(0, in->count, 250, 200, 255);
+}
+
+static void op_blend(const bench_input_t *in) {
+    led_blend_range(0, in->words, in->count, 96);
+}
+
+static void op_lut(const bench_input_t *in) {
+    led_apply_lut(0, in->count, in->lut);
+}
+
+static void op_pack(const bench_input_t *in) {
+    led_pack_planar(0, in->r, in->g, in->b, in->count);
+}
+
+static void op_encode(const bench_input_t *in) {
+    led_encode(&in->encoder, led_get_buffer(), in->count, in->encoded, in->encoded_size);
+}
+
+static void op_correct(const bench_input_t *in) {
+    led_frame_t frame;
+
+    (void)in;
+    led_mark_all_dirty();
+    led_commit(&frame);
+}
+
+static const bench_op_t bench_ops[] = {
+    { "set_pixel",   op_set_pixel, 7,  false },
+    { "fill",        op_fill,      4,  true },
+    { "copy_range",  op_copy,      8,  true },
+    { "scale_range", op_scale,     8,  true },
+    { "blend_range", op_blend,     12, true },
+    { "apply_lut",   op_lut,       8,  true },
+    { "pack_planar", op_pack,      7,  true },
+    { "encode_spi3", op_encode,    13, true },  // 4 bytes in, 9 bytes out
+    { "correct",     op_correct,   8,  true },  // Gamma 2.2 at commit
+};
+
+#define NUM_BENCH_OPS (sizeof(bench_ops) / sizeof(bench_ops[0]))
+
+static const size_t sweep_sizes[] = { 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+#define NUM_SWEEP_SIZES (sizeof(sweep_sizes) / sizeof(sweep_sizes[0]))
+#define MAX_SWEEP_RESULTS (NUM_SWEEP_SIZES * NUM_BENCH_OPS * (LED_SIMD_AVX2 + 1))
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Run an operation batch times; returns the elapsed nanoseconds
+ */
+static uint64_t time_batch(const bench_op_t *op, const bench_input_t *in, uint64_t batch) {
+    uint64_t start = now_ns();
+    for (uint64_t i = 0; i < batch; i++) {
+        op->run(in);
+    }
+    return now_ns() - start;
+}
+
+/**
+ * @brief Time one operation; returns the median nanoseconds per call
+ *
+ * The clock is read once per batch of calls lasting SWEEP_BATCH_NS, so
+ * sub-microsecond operations are not dominated by clock_gettime(). The
+ * median of the batches ignores the ones hit by an interrupt or another
+ * process.
+ */
+static double time_op(const bench_op_t *op, const bench_input_t *in) {
+    double samples[SWEEP_MAX_SAMPLES];
+    uint64_t batch = 1;
+    uint64_t total = 0;
+    uint64_t elapsed;
+    size_t count = 0;
+
+    // Size the batch; this also warms up caches and page mappings
+    while (time_batch(op, in, batch) < SWEEP_BATCH_NS) {
+        batch *= 2;
+    }
+    while (count < SWEEP_MAX_SAMPLES && (count < SWEEP_SAMPLES || total < SWEEP_CASE_NS)) {
+        elapsed = time_batch(op, in, batch);
+        samples[count++] = (double)elapsed / (double)batch;
+        total += elapsed;
+    }
+
+    qsort(samples, count, sizeof(samples[0]), compare_double);
+    return samples[count / 2];
+}
+
+static int setup_input(bench_input_t *in, size_t count) {
+    memset(in, 0, sizeof(*in));
+    in->count = count;
+    in->words = malloc(count * sizeof(uint32_t));
+    in->r = malloc(count);
+    in->g = malloc(count);
+    in->b = malloc(count);
+    if (in->words == NULL || in->r == NULL || in->g == NULL || in->b == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        in->r[i] = (uint8_t)(i * 7);
+        in->g[i] = (uint8_t)(i * 13);
+        in->b[i] = (uint8_t)(i * 29);
+        in->words[i] = ((uint32_t)in->g[i] << 16) | ((uint32_t)in->r[i] << 8) | in->b[i];
+    }
+    for (int v = 0; v < 256; v++) {
+        in->lut[v] = (uint8_t)((v * v) / 255);
+    }
+    return 0;
+}
+
+static void free_input(bench_input_t *in) {
+    free(in->words);
+    free(in->r);
+    free(in->g);
+    free(in->b);
+    free(in->encoded);
+}
+
+static const bench_result_t *find_result(const bench_result_t *results, size_t count,
+                                         const bench_result_t *key) {
+    for (size_t i = 0; i < count; i++) {
+        if (results[i].pixels == key->pixels && strcmp(results[i].op, key->op) == 0 &&
+            strcmp(results[i].level, key->level) == 0) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Read a baseline written by save_baseline()
+ *
+ * @return long Entries read, or -1 if the file cannot be opened
+ */
+static long load_baseline(const char *path, bench_result_t *results, size_t max) {
+    FILE *file = fopen(path, "r");
+    char line[160];
+    size_t count = 0;
+
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot read baseline %s (record one with -s)\n", path);
+        return -1;
+    }
+    while (count < max && fgets(line, sizeof(line), file) != NULL) {
+        bench_result_t *r = &results[count];
+        int fields = sscanf(line, "%31s %15s %zu %lf %lf", r->op, r->level, &r->pixels,
+                            &r->ns_per_pixel, &r->slowest);
+        if (line[0] == '#' || fields < 4) {
+            continue;
+        }
+        if (fields == 4 || r->slowest < r->ns_per_pixel) {
+            r->slowest = r->ns_per_pixel;    // Baseline from before the slowest column
+        }
+        count++;
+    }
+    fclose(file);
+    return (long)count;
+}
+
+static int save_baseline(const char *path, const bench_result_t *results, size_t count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot write baseline %s\n", path);
+        return -1;
+    }
+    fprintf(file, "# led_bench baseline: operation simd pixels ns/pixel slowest-round\n");
+    for (size_t i = 0; i < count; i++) {
+        fprintf(file, "%s %s %zu %.6f %.6f\n", results[i].op, results[i].level,
+                results[i].pixels, results[i].ns_per_pixel, results[i].slowest);
+    }
+    if (fclose(file) != 0) {
+        fprintf(stderr, "Error: Cannot write baseline %s\n", path);
+        return -1;
+    }
+    printf("\nBaseline written to %s (%zu measurements)\n", path, count);
+    return 0;
+}
+
+/**
+ * @brief Measurements per strip size: one per SIMD level of each operation
+ */
+static size_t sweep_per_size(led_simd_level_t best) {
+    size_t count = 0;
+    for (size_t o = 0; o < NUM_BENCH_OPS; o++) {
+        count += bench_ops[o].simd ? (size_t)best + 1 : 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Measure every operation once, keeping the fastest and slowest times seen
+ *
+ * results holds sweep_per_size() entries per size in sweep order. With
+ * retry set, only the entries it flags are measured again.
+ */
+static int sweep_round(bench_result_t *results, const bool *retry) {
+    static const led_encoder_config_t spi3 = { LED_ENCODE_SPI_3BIT, 2400000, 0, NULL };
+    static const led_correction_config_t gamma = { .gamma = { 2.2f, 2.2f, 2.2f, 2.2f } };
+    led_simd_level_t best = led_simd_get_level();
+    size_t per_size = sweep_per_size(best);
+
+    for (size_t s = 0; s < NUM_SWEEP_SIZES; s++) {
+        bench_result_t *row = results + s * per_size;
+        const bool *row_retry = retry ? retry + s * per_size : NULL;
+        bench_input_t in;
+
+        if (row_retry != NULL && memchr(row_retry, true, per_size) == NULL) {
+            continue;
+        }
+        if (setup_input(&in, sweep_sizes[s]) == 0 && led_encoder_init(&in.encoder, &spi3) == 0) {
+            in.encoded_size = led_encoded_size(&in.encoder, in.count);
+            in.encoded = malloc(in.encoded_size);
+        }
+        if (in.encoded == NULL || led_init(sweep_sizes[s]) != 0 ||
+            led_set_correction(&gamma) != 0) {
+            fprintf(stderr, "Error: cannot allocate %zu pixels\n", sweep_sizes[s]);
+            free_input(&in);
+            led_shutdown();
+            return -1;
+        }
+
+        size_t k = 0;
+        for (size_t o = 0; o < NUM_BENCH_OPS; o++) {
+            const bench_op_t *op = &bench_ops[o];
+            int first = op->simd ? LED_SIMD_SCALAR : (int)best;
+
+            for (int level = first; level <= (int)best; level++, k++) {
+                bench_result_t *r = &row[k];
+                snprintf(r->op, sizeof(r->op), "%s", op->name);
+                snprintf(r->level, sizeof(r->level), "%s",
+                         op->simd ? led_simd_level_name((led_simd_level_t)level) : "-");
+                r->pixels = in.count;
+                if ((row_retry != NULL && !row_retry[k]) ||
+                    led_simd_set_level((led_simd_level_t)level) != 0) {
+                    continue;
+                }
+                double ns = time_op(op, &in) / (double)in.count;
+                if (r->ns_per_pixel == 0.0 || ns < r->ns_per_pixel) {
+                    r->ns_per_pixel = ns;
+                }
+                if (ns > r->slowest) {
+                    r->slowest = ns;
+                }
+            }
+        }
+
+        led_simd_set_level(best);
+        led_shutdown();
+        free_input(&in);
+    }
+    return 0;
+}
+
+/**
+ * @brief Flag measurements more than the threshold slower than the baseline
+ *
+ * The fastest round of this run is compared with the slowest round of the
+ * baseline, so the noise both runs saw widens the threshold instead of
+ * failing the check: a real slowdown shows in every round.
+ *
+ * Strips below SWEEP_GATE_PIXELS are never flagged: a call takes a few
+ * microseconds at most, and cache and frequency effects move it by more
+ * than any useful threshold between two runs of the same binary.
+ *
+ * @return size_t Number of flagged measurements
+ */
+static size_t find_regressions(const bench_result_t *results, size_t count,
+                               const bench_result_t *baseline, size_t num_baseline,
+                               double threshold_pct, bool *slow) {
+    size_t regressions = 0;
+    for (size_t i = 0; i < count; i++) {
+        const bench_result_t *base = find_result(baseline, num_baseline, &results[i]);
+        slow[i] = base != NULL && results[i].pixels >= SWEEP_GATE_PIXELS &&
+                  results[i].ns_per_pixel > 0.0 &&
+                  results[i].ns_per_pixel > base->slowest * (1.0 + threshold_pct / 100.0);
+        regressions += slow[i];
+    }
+    return regressions;
+}
+
+/**
+ * @brief Run every operation at every strip size and SIMD level
+ *
+ * The whole sweep runs SWEEP_ROUNDS times and each measurement keeps its
+ * fastest round (each round is already a median, see time_op()). Interleaving the rounds spreads every measurement over
+ * the run, so a few seconds of interference from other processes cannot
+ * slow down all samples of one operation. When checking, measurements
+ * that look slower than the baseline are re-run up to SWEEP_RETRIES more
+ * times before they count as regressions.
+ *
+ * @return int 0 on success, 1 if a check found a regression, -1 on error
+ */
+static int bench_sweep(const bench_options_t *options) {
+    static bench_result_t results[MAX_SWEEP_RESULTS];
+    static bench_result_t baseline[MAX_SWEEP_RESULTS];
+    static bool slow[MAX_SWEEP_RESULTS];
+    led_simd_level_t best = led_simd_get_level();
+    size_t per_size = sweep_per_size(best);
+    size_t num_results = NUM_SWEEP_SIZES * per_size;
+    long num_baseline = 0;
+    size_t regressions = 0;
+    size_t gated = 0;
+
+    if (options->check_path != NULL) {
+        num_baseline = load_baseline(options->check_path, baseline, MAX_SWEEP_RESULTS);
+        if (num_baseline < 0) {
+            return -1;
+        }
+    }
+
+    printf("LED driver size sweep (best SIMD level: %s, best of %d rounds of medians)\n",
+           led_simd_level_name(best), SWEEP_ROUNDS);
+    for (int round = 0; round < SWEEP_ROUNDS; round++) {
+        if (sweep_round(results, NULL) != 0) {
+            return -1;
+        }
+    }
+    if (options->check_path != NULL) {
+        regressions = find_regressions(results, num_results, baseline, (size_t)num_baseline,
+                                       options->threshold_pct, slow);
+        for (int retry = 0; retry < SWEEP_RETRIES && regressions > 0; retry++) {
+            if (sweep_round(results, slow) != 0) {
+                return -1;
+            }
+            regressions = find_regressions(results, num_results, baseline,
+                                           (size_t)num_baseline, options->threshold_pct, slow);
+        }
+    }
+
+    for (size_t s = 0; s < NUM_SWEEP_SIZES; s++) {
+        const bench_result_t *row = results + s * per_size;
+        double reference = 0.0;
+
+        printf("\n%zu pixels\n", sweep_sizes[s]);
+        printf("%-12s %-7s %10s %10s %9s %8s", "operation", "simd", "ns/pixel", "Mpix/s",
+               "GB/s", "speedup");
+        printf(options->check_path ? " %9s\n" : "\n", "vs base");
+
+        size_t k = 0;
+        for (size_t o = 0; o < NUM_BENCH_OPS; o++) {
+            size_t levels = bench_ops[o].simd ? (size_t)best + 1 : 1;
+            for (size_t l = 0; l < levels; l++, k++) {
+                const bench_result_t *r = &row[k];
+                double ns = r->ns_per_pixel;
+                if (ns == 0.0) {
+                    continue;
+                }
+                if (l == 0) {
+                    reference = ns;
+                }
+                printf("%-12s %-7s %10.3f %10.1f %9.2f %7.2fx", r->op, r->level, ns, 1e3 / ns,
+                       (double)bench_ops[o].bytes_per_pixel / ns, reference / ns);
+                if (options->check_path == NULL) {
+                    printf("\n");
+                    continue;
+                }
+                const bench_result_t *base = find_result(baseline, (size_t)num_baseline, r);
+                if (base == NULL) {
+                    printf(" %9s\n", "new");
+                } else {
+                    printf(" %+8.1f%%%s\n", (ns / base->ns_per_pixel - 1.0) * 100.0,
+                           slow[s * per_size + k] ? "  REGRESSION" : "");
+                }
+            }
+        }
+    }
+
+    if (options->save_path != NULL &&
+        save_baseline(options->save_path, results, num_results) != 0) {
+        return -1;
+    }
+    if (options->check_path != NULL) {
+        for (size_t i = 0; i < num_results; i++) {
+            gated += results[i].pixels >= SWEEP_GATE_PIXELS;
+        }
+        printf("\nBaseline check: %zu of %zu measurements (strips of %d+ pixels) more than "
+               "%.0f%% slower than %s\n", regressions, gated, SWEEP_GATE_PIXELS,
+               options->threshold_pct, options->check_path);
+        return regressions > 0 ? 1 : 0;
+    }
+    return 0;
+}
+
+/* ======================== Multi-strip rendering ======================== */
+
+/**
+ * @brief Work of one render thread: strips first, first + step, ...
+ */
+typedef struct {
+    led_strip_t **strips;
+    size_t first;
+    size_t step;
+    const bench_input_t *in;     // Shared read-only planes and LUT
+} render_job_t;
+
+/**
+ * @brief Render MULTI_FRAMES frames on every strip owned by the job
+ *
+ * Each frame packs planar input shifted by the frame number, scales the
+ * brightness, applies the LUT and commits - a typical effect output stage.
+ */
+static void *render_thread(void *arg) {
+    const render_job_t *job = (const render_job_t *)arg;
+    const bench_input_t *in = job->in;
+    led_frame_t frame;
+
+    for (size_t f = 0; f < MULTI_FRAMES; f++) {
+        size_t shift = f % (in->count - MULTI_STRIP_PIXELS);
+        for (size_t s = job->first; s < MULTI_NUM_STRIPS; s += job->step) {
+            led_strip_t *strip = job->strips[s];
+            led_strip_pack_planar(strip, 0, in->r + shift, in->g + shift,
+                                  in->b + shift, MULTI_STRIP_PIXELS);
+            led_strip_scale_range(strip, 0, MULTI_STRIP_PIXELS, 200, 200, 200);
+            led_strip_apply_lut(strip, 0, MULTI_STRIP_PIXELS, in->lut);
+            led_strip_commit(strip, &frame);
+        }
+    }
+    return NULL;
+}
+
+static int bench_multi_strip(void) {
+    led_strip_t *strips[MULTI_NUM_STRIPS];
+    pthread_t threads[MULTI_MAX_THREADS];
+    render_job_t jobs[MULTI_MAX_THREADS];
+    bench_input_t in;
+    double baseline = 0.0;
+    int result = 0;
+
+    if (setup_input(&in, MULTI_STRIP_PIXELS + MULTI_FRAMES) != 0) {
+        free_input(&in);
+        return -1;
+    }
+    for (size_t s = 0; s < MULTI_NUM_STRIPS; s++) {
+        strips[s] = led_strip_create(MULTI_STRIP_PIXELS);
+        if (strips[s] == NULL) {
+            result = -1;
+        }
+    }
+
+    printf("\nMulti-strip render: %d strips x %d pixels, %d frames each\n",
+           MULTI_NUM_STRIPS, MULTI_STRIP_PIXELS, MULTI_FRAMES);
+    printf("%-8s %10s %14s %12s %8s\n",
+           "threads", "time(ms)", "strip-frames/s", "Mpix/s", "speedup");
+
+    for (size_t t = 1; result == 0 && t <= MULTI_MAX_THREADS; t *= 2) {
+        uint64_t start = now_ns();
+        for (size_t i = 0; i < t; i++) {
+            jobs[i].strips = strips;
+            jobs[i].first = i;
+            jobs[i].step = t;
+            jobs[i].in = &in;
+            pthread_create(&threads[i], NULL, render_thread, &jobs[i]);
+        }
+        for (size_t i = 0; i < t; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        double seconds = (double)(now_ns() - start) / 1e9;
+        double strip_frames = (double)MULTI_NUM_STRIPS * MULTI_FRAMES / seconds;
+
+        if (t == 1) {
+            baseline = seconds;
+        }
+        printf("%-8zu %10.1f %14.0f %12.1f %7.2fx\n", t, seconds * 1e3, strip_frames,
+               strip_frames * MULTI_STRIP_PIXELS / 1e6, baseline / seconds);
+    }
+
+    for (size_t s = 0; s < MULTI_NUM_STRIPS; s++) {
+        led_strip_destroy(strips[s]);
+    }
+    free_input(&in);
+    return result;
+}
+
+/* ======================== Frame buffering ======================== */
+
+/**
+ * @brief Shared state of one producer/consumer run
+ */
+typedef struct {
+    led_strip_t *strip;
+    const bench_input_t *in;
+    uint64_t frame_ns;                              // Target frame interval
+    uint64_t present_ns[PRESENT_MAX_FRAMES];        // Time spent in present()
+    uint64_t presented_at[PRESENT_MAX_FRAMES + 1];  // Indexed by frame sequence
+    uint64_t display_ns[PRESENT_MAX_FRAMES];        // present() -> acquire latency
+    size_t presented;
+    size_t shown;
+    volatile int done;
+} present_run_t;
+
+static void sleep_until_ns(uint64_t deadline) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(deadline / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        // Interrupted by a signal - sleep again
+    }
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t percentile(uint64_t *values, size_t count, double pct) {
+    if (count == 0) {
+        return 0;
+    }
+    qsort(values, count, sizeof(uint64_t), compare_u64);
+    return values[(size_t)((double)(count - 1) * pct / 100.0)];
+}
+
+/**
+ * @brief Render thread: one frame every frame_ns, then present()
+ */
+static void *present_producer(void *arg) {
+    present_run_t *run = (present_run_t *)arg;
+    const bench_input_t *in = run->in;
+    uint64_t start = now_ns();
+    uint64_t next = start;
+
+    while (now_ns() - start < PRESENT_RUN_NS && run->presented < PRESENT_MAX_FRAMES) {
+        size_t shift = run->presented % (in->count - PRESENT_PIXELS);
+        led_strip_pack_planar(run->strip, 0, in->r + shift, in->g + shift,
+                              in->b + shift, PRESENT_PIXELS);
+        led_strip_scale_range(run->strip, 0, PRESENT_PIXELS, 180, 180, 180);
+
+        uint64_t before = now_ns();
+        run->presented_at[run->presented + 1] = before;
+        led_strip_present(run->strip);
+        run->present_ns[run->presented] = now_ns() - before;
+        run->presented++;
+
+        next += run->frame_ns;
+        sleep_until_ns(next);
+    }
+    run->done = 1;
+    return NULL;
+}
+
+/**
+ * @brief Output thread: takes the newest frame and "sends" it for 2 ms
+ */
+static void *present_consumer(void *arg) {
+    present_run_t *run = (present_run_t *)arg;
+
+    while (!run->done) {
+        const led_frame_t *frame = led_strip_acquire_frame(run->strip);
+        if (frame == NULL) {
+            sleep_until_ns(now_ns() + 100000ULL);
+            continue;
+        }
+        run->display_ns[run->shown++] = now_ns() - run->presented_at[frame->sequence];
+        sleep_until_ns(now_ns() + PRESENT_OUTPUT_NS);
+        led_strip_release_frame(run->strip);
+    }
+    return NULL;
+}
+
+static int bench_frame_buffering(void) {
+    static const unsigned int rates[] = { 60, 240, 1000 };
+    static const led_buffering_t modes[] = { LED_BUFFER_DOUBLE, LED_BUFFER_TRIPLE };
+    bench_input_t in;
+
+    if (setup_input(&in, PRESENT_PIXELS + PRESENT_MAX_FRAMES) != 0) {
+        free_input(&in);
+        return -1;
+    }
+
+    printf("\nFrame buffering: %d pixels, output path %.1f ms per frame\n",
+           PRESENT_PIXELS, (double)PRESENT_OUTPUT_NS / 1e6);
+    printf("%-7s %6s %9s %11s %11s %11s %7s %8s %13s\n", "mode", "fps", "achieved",
+           "present p50", "present p99", "present max", "shown", "skipped", "latency p50");
+
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+            present_run_t *run = calloc(1, sizeof(present_run_t));
+            pthread_t producer;
+            pthread_t consumer;
+
+            if (run == NULL) {
+                free_input(&in);
+                return -1;
+            }
+            run->strip = led_strip_create(PRESENT_PIXELS);
+            if (run->strip == NULL || led_strip_set_buffering(run->strip, modes[m]) != 0) {
+                led_strip_destroy(run->strip);
+                free(run);
+                free_input(&in);
+                return -1;
+            }
+            run->in = &in;
+            run->frame_ns = 1000000000ULL / rates[r];
+
+            uint64_t start = now_ns();
+            pthread_create(&consumer, NULL, present_consumer, run);
+            pthread_create(&producer, NULL, present_producer, run);
+            pthread_join(producer, NULL);
+            pthread_join(consumer, NULL);
+            double seconds = (double)(now_ns() - start) / 1e9;
+
+            printf("%-7s %6u %9.0f %9.1fus %9.1fus %9.1fus %7zu %8zu %11.2fms\n",
+                   modes[m] == LED_BUFFER_DOUBLE ? "double" : "triple", rates[r],
+                   (double)run->presented / seconds,
+                   (double)percentile(run->present_ns, run->presented, 50.0) / 1e3,
+                   (double)percentile(run->present_ns, run->presented, 99.0) / 1e3,
+                   (double)percentile(run->present_ns, run->presented, 100.0) / 1e3,
+                   run->shown, run->presented - run->shown,
+                   (double)percentile(run->display_ns, run->shown, 50.0) / 1e6);
+
+            led_strip_destroy(run->strip);
+            free(run);
+        }
+    }
+
+    free_input(&in);
+    return 0;
+}
+
+/* ======================== WS2812B encoding ======================== */
+
+/**
+ * @brief Time one full-frame encode (chunk == 0) or streamed encode; ns per frame
+ */
+static double time_encode(const led_encoder_t *enc, const uint32_t *pixels,
+                          uint8_t *out, size_t size, size_t chunk) {
+    uint64_t iterations = 0;
+    uint64_t start;
+    uint64_t elapsed;
+
+    led_encode(enc, pixels, ENCODE_PIXELS, out, size);    // Fault in the output pages
+    start = now_ns();
+    do {
+        if (chunk == 0) {
+            led_encode(enc, pixels, ENCODE_PIXELS, out, size);
+        } else {
+            led_encode_stream_t stream;
+            led_encode_stream_begin(&stream, enc, pixels, ENCODE_PIXELS);
+            while (led_encode_stream_next(&stream, out, chunk) > 0) {
+                // The same chunk buffer is reused, as a DMA half-buffer would be
+            }
+        }
+        iterations++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_MIN_TIME_NS);
+
+    return (double)elapsed / (double)iterations;
+}
+
+static int bench_encoder(void) {
+    static const led_encoder_config_t configs[] = {
+        { LED_ENCODE_SPI_3BIT, 2400000, 0, NULL },
+        { LED_ENCODE_SPI_4BIT, 3200000, 0, NULL },
+        { LED_ENCODE_PWM, 72000000, 0, NULL }
+    };
+    static const char *names[] = { "spi_3bit", "spi_4bit", "pwm" };
+    led_simd_level_t best = led_simd_get_level();
+    bench_input_t in;
+
+    if (setup_input(&in, ENCODE_PIXELS) != 0) {
+        free_input(&in);
+        return -1;
+    }
+
+    printf("\nWS2812B encoding: %d pixels\n", ENCODE_PIXELS);
+    printf("%-9s %-7s %10s %10s %10s %9s\n",
+           "encoding", "level", "ns/pixel", "Mpix/s", "out MB/s", "speedup");
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        led_encoder_t enc;
+        if (led_encoder_init(&enc, &configs[c]) != 0) {
+            free_input(&in);
+            return -1;
+        }
+        size_t size = led_encoded_size(&enc, ENCODE_PIXELS);
+        uint8_t *out = malloc(size);
+        double scalar_ns = 0.0;
+
+        if (out == NULL) {
+            free_input(&in);
+            return -1;
+        }
+        for (int level = LED_SIMD_SCALAR; level <= (int)best; level++) {
+            if (led_simd_set_level((led_simd_level_t)level) != 0) {
+                continue;
+            }
+            double ns = time_encode(&enc, in.words, out, size, 0);
+            if (level == LED_SIMD_SCALAR) {
+                scalar_ns = ns;
+            }
+            printf("%-9s %-7s %10.2f %10.1f %10.0f %8.2fx\n", names[c],
+                   led_simd_level_name((led_simd_level_t)level), ns / ENCODE_PIXELS,
+                   ENCODE_PIXELS * 1e3 / ns, (double)size * 1e3 / ns, scalar_ns / ns);
+        }
+        double ns = time_encode(&enc, in.words, out, size, ENCODE_CHUNK);
+        printf("%-9s %-7s %10.2f %10.1f %10.0f %8.2fx\n", names[c], "stream",
+               ns / ENCODE_PIXELS, ENCODE_PIXELS * 1e3 / ns, (double)size * 1e3 / ns,
+               scalar_ns / ns);
+        free(out);
+    }
+
+    led_simd_set_level(best);
+    free_input(&in);
+    return 0;
+}
+
+/* ======================== Pixel formats ======================== */
+
+typedef enum { FORMAT_OP_FILL, FORMAT_OP_SCALE, FORMAT_OP_BLEND } format_op_t;
+
+/**
+ * @brief Time one bulk operation on a whole strip; ns per call
+ */
+static double time_format_op(led_strip_t *strip, format_op_t op, const uint32_t *src) {
+    led_frame_t frame;
+    uint64_t iterations = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+
+    do {
+        switch (op) {
+            case FORMAT_OP_FILL:
+                led_strip_fill_range(strip, 0, FORMAT_PIXELS, 12, 34, (uint8_t)iterations);
+                break;
+            case FORMAT_OP_SCALE:
+                led_strip_scale_range(strip, 0, FORMAT_PIXELS, 250, 200, 255);
+                break;
+            case FORMAT_OP_BLEND:
+                led_strip_blend_range(strip, 0, src, FORMAT_PIXELS, 96);
+                break;
+        }
+        led_strip_commit(strip, &frame);
+        iterations++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_MIN_TIME_NS);
+
+    return (double)elapsed / (double)iterations;
+}
+
+static int bench_formats(void) {
+    bench_input_t in;
+
+    if (setup_input(&in, FORMAT_PIXELS) != 0) {
+        free_input(&in);
+        return -1;
+    }
+
+    printf("\nPixel formats: %d pixels (Mpix/s)\n", FORMAT_PIXELS);
+    printf("%-8s %6s %10s %10s %10s %10s\n",
+           "format", "bytes", "memory MB", "fill", "scale", "blend");
+
+    for (int f = LED_FORMAT_GRB32; f <= LED_FORMAT_RGBW64; f++) {
+        led_strip_t *strip = led_strip_create_format(FORMAT_PIXELS, (led_pixel_format_t)f);
+        if (strip == NULL) {
+            free_input(&in);
+            return -1;
+        }
+        led_strip_pack_planar(strip, 0, in.r, in.g, in.b, FORMAT_PIXELS);
+
+        double fill = time_format_op(strip, FORMAT_OP_FILL, in.words);
+        double scale = time_format_op(strip, FORMAT_OP_SCALE, in.words);
+        double blend = time_format_op(strip, FORMAT_OP_BLEND, in.words);
+        printf("%-8s %6zu %10.2f %10.0f %10.0f %10.0f\n",
+               led_format_name((led_pixel_format_t)f),
+               led_format_bytes_per_pixel((led_pixel_format_t)f),
+               (double)led_strip_get_memory(strip) / 1e6,
+               FORMAT_PIXELS * 1e3 / fill, FORMAT_PIXELS * 1e3 / scale,
+               FORMAT_PIXELS * 1e3 / blend);
+        led_strip_destroy(strip);
+    }
+
+    free_input(&in);
+    return 0;
+}
+
+/* ======================== Effects ======================== */
+
+/**
+ * @brief Render frames as fast as possible and report fps and CPU per frame
+ */
+static void time_scene(const char *name, led_scene_t *scene, led_strip_t *strip) {
+    led_frame_t frame;
+    uint32_t frames = 0;
+
+    led_scene_render_to(scene, strip, 0);     // Warm up caches and page mappings
+    led_strip_commit(strip, &frame);
+
+    uint64_t start = now_ns();
+    uint64_t cpu_start = cpu_ns();
+    uint64_t elapsed;
+    do {
+        frames++;
+        led_scene_render_to(scene, strip, frames * EFFECT_FRAME_MS);
+        led_strip_commit(strip, &frame);
+        elapsed = now_ns() - start;
+    } while (elapsed < EFFECT_RUN_NS);
+    uint64_t cpu = cpu_ns() - cpu_start;
+
+    double frame_us = (double)elapsed / frames / 1e3;
+    double cpu_us = (double)cpu / frames / 1e3;
+    printf("%-16s %10.0f %10.1f %10.1f %11.2f%%\n", name, 1e6 / frame_us, frame_us, cpu_us,
+           cpu_us / (1e6 / 60.0) * 100.0);
+}
+
+static int bench_effects(void) {
+    static const led_keyframe_t track[] = {
+        { 0, 0x00000000 }, { 400, 0x0000FF00 }, { 900, 0x00FF8000 }, { 1500, 0x000000FF }
+    };
+    const led_effect_config_t effects[] = {
+        { .type = LED_EFFECT_RAINBOW, .period_ms = 2000, .length = 300 },
+        { .type = LED_EFFECT_CHASE, .period_ms = 500, .color = 0x00FFFFFF, .length = 4, .spacing = 12 },
+        { .type = LED_EFFECT_FADE, .period_ms = 1000, .color = 0x0000FF00, .color2 = 0x000000FF },
+        { .type = LED_EFFECT_TWINKLE, .period_ms = 1200, .color = 0x00FFFFFF, .density = 80, .seed = 1 },
+        { .type = LED_EFFECT_FIRE, .period_ms = 16, .density = 120, .cooling = 55, .seed = 1 },
+        { .type = LED_EFFECT_KEYFRAMES, .keyframes = track, .num_keyframes = 4, .loop = true }
+    };
+    static const char *names[] = { "rainbow", "chase", "fade", "twinkle", "fire", "keyframes" };
+
+    led_strip_t *strip = led_strip_create(EFFECT_PIXELS);
+    if (strip == NULL) {
+        return -1;
+    }
+
+    printf("\nEffects: %d pixels, rendered into a strip and committed\n", EFFECT_PIXELS);
+    printf("%-16s %10s %10s %10s %12s\n", "effect", "fps", "us/frame", "cpu us", "60fps budget");
+
+    for (size_t i = 0; i < sizeof(effects) / sizeof(effects[0]); i++) {
+        led_scene_t *scene = led_scene_create(EFFECT_PIXELS);
+        if (scene == NULL || led_scene_add_layer(scene, &effects[i], LED_BLEND_NORMAL, 255) < 0) {
+            led_scene_destroy(scene);
+            led_strip_destroy(strip);
+            return -1;
+        }
+        time_scene(names[i], scene, strip);
+        led_scene_destroy(scene);
+    }
+
+    // Rainbow, twinkle sparkles added on top, a chase mask multiplied at half opacity
+    led_scene_t *scene = led_scene_create(EFFECT_PIXELS);
+    if (scene == NULL) {
+        led_strip_destroy(strip);
+        return -1;
+    }
+    led_scene_add_layer(scene, &effects[0], LED_BLEND_NORMAL, 255);
+    led_scene_add_layer(scene, &effects[3], LED_BLEND_ADD, 255);
+    led_scene_add_layer(scene, &effects[1], LED_BLEND_MULTIPLY, 128);
+    time_scene("3 layers", scene, strip);
+    led_scene_set_gamma(scene, 2.2);
+    time_scene("3 layers + gamma", scene, strip);
+    led_scene_destroy(scene);
+
+    led_strip_destroy(strip);
+    return 0;
+}
+
+/* ======================== Matrix rendering ======================== */
+
+/**
+ * @brief Plasma shader: two moving interference patterns, integer math only
+ */
+static uint32_t plasma_shader(uint32_t x, uint32_t y, uint32_t time_ms, void *user) {
+    (void)user;
+    int32_t dx = (int32_t)x - 128 + (int32_t)((time_ms >> 4) & 63);
+    int32_t dy = (int32_t)y - 128;
+    uint32_t ring = (uint32_t)(dx * dx + dy * dy) >> 7;
+    uint32_t wave = (x * 3 + y * 5 + (time_ms >> 2)) & 0x1FF;
+    uint32_t v = (ring + wave) & 0x1FF;
+    uint32_t tri = v < 256 ? v : 511 - v;                  // 0..255..0
+
+    return ((255 - tri) << 16) | (tri << 8) | ((tri * ring) & 0xFF);
+}
+
+static int bench_matrix(void) {
+    led_matrix_config_t config = { .width = MATRIX_SIZE, .height = MATRIX_SIZE,
+                                   .serpentine = true };
+    led_matrix_t *matrix = led_matrix_create(&config);
+    size_t pixels = led_matrix_get_pixel_count(matrix);
+    led_strip_t *strip = led_strip_create(pixels);
+    double base = 0;
+
+    if (matrix == NULL || strip == NULL) {
+        led_matrix_destroy(matrix);
+        led_strip_destroy(strip);
+        return -1;
+    }
+
+    printf("\nMatrix rendering: %dx%d serpentine, %dx%d tiles, %ld CPUs online\n",
+           MATRIX_SIZE, MATRIX_SIZE, LED_MATRIX_TILE, LED_MATRIX_TILE,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %10s %10s %10s %10s\n", "threads", "fps", "ms/frame", "Mpix/s", "speedup");
+
+    for (size_t threads = 1; threads <= MATRIX_MAX_THREADS; threads *= 2) {
+        led_render_pool_t *pool = led_render_pool_create(threads);
+        led_frame_t frame;
+        uint32_t frames = 0;
+        if (pool == NULL) {
+            led_strip_destroy(strip);
+            led_matrix_destroy(matrix);
+            return -1;
+        }
+
+        led_matrix_render_to(pool, matrix, plasma_shader, NULL, 0, strip);
+        uint64_t start = now_ns();
+        uint64_t elapsed;
+        do {
+            frames++;
+            led_matrix_render_to(pool, matrix, plasma_shader, NULL, frames * EFFECT_FRAME_MS, strip);
+            led_strip_commit(strip, &frame);
+            elapsed = now_ns() - start;
+        } while (elapsed < MATRIX_RUN_NS);
+
+        double frame_ns = (double)elapsed / frames;
+        if (threads == 1) {
+            base = frame_ns;
+        }
+        printf("%-8zu %10.0f %10.3f %10.0f %9.2fx\n", threads, 1e9 / frame_ns, frame_ns / 1e6,
+               pixels * 1e3 / frame_ns, base / frame_ns);
+        led_render_pool_destroy(pool);
+    }
+
+    led_strip_destroy(strip);
+    led_matrix_destroy(matrix);
+    return 0;
+}
+
+/* ======================== Recording ======================== */
+
+static int bench_record_effect(const char *name, const led_effect_config_t *effect) {
+    led_scene_t *scene = led_scene_create(RECORD_PIXELS);
+    led_strip_t *strip = led_strip_create(RECORD_PIXELS);
+    led_recorder_t *rec = led_recorder_open(RECORD_PATH, RECORD_PIXELS, LED_FORMAT_GRB32, 0);
+    led_replay_t *replay = NULL;
+    led_record_info_t info;
+    led_frame_t frame;
+    int result = -1;
+
+    if (scene == NULL || strip == NULL || rec == NULL ||
+        led_scene_add_layer(scene, effect, LED_BLEND_NORMAL, 255) < 0) {
+        goto out;
+    }
+
+    // Render all frames first so only encoding and writing are timed
+    uint32_t *frames = malloc((size_t)RECORD_FRAMES * RECORD_PIXELS * sizeof(uint32_t));
+    if (frames == NULL) {
+        goto out;
+    }
+    for (uint32_t f = 0; f < RECORD_FRAMES; f++) {
+        memcpy(frames + (size_t)f * RECORD_PIXELS, led_scene_render(scene, f * EFFECT_FRAME_MS),
+               RECORD_PIXELS * sizeof(uint32_t));
+    }
+    uint64_t start = now_ns();
+    for (uint32_t f = 0; f < RECORD_FRAMES; f++) {
+        led_recorder_add_frame(rec, frames + (size_t)f * RECORD_PIXELS, f * EFFECT_FRAME_MS);
+    }
+    led_recorder_get_info(rec, &info);
+    int closed = led_recorder_close(rec);
+    uint64_t record_ns = now_ns() - start;
+    rec = NULL;
+    free(frames);
+    if (closed != 0 || (replay = led_replay_open(RECORD_PATH)) == NULL) {
+        goto out;
+    }
+
+    start = now_ns();
+    for (size_t f = 0; f < info.frames; f++) {
+        led_replay_apply(replay, f, strip);
+        led_strip_commit(strip, &frame);
+    }
+    uint64_t replay_ns = now_ns() - start;
+
+    printf("%-10s %12.0f %10.1f:1 %12.0f %12.0f\n", name,
+           (double)info.file_bytes / info.frames, (double)info.raw_bytes / info.file_bytes,
+           info.frames * 1e9 / record_ns, info.frames * 1e9 / replay_ns);
+    result = 0;
+
+out:
+    led_replay_close(replay);
+    if (rec != NULL) {
+        led_recorder_close(rec);
+    }
+    led_strip_destroy(strip);
+    led_scene_destroy(scene);
+    remove(RECORD_PATH);
+    return result;
+}
+
+static int bench_recording(void) {
+    const led_effect_config_t chase = { .type = LED_EFFECT_CHASE, .period_ms = 2000,
+                                        .color = 0x00FFFFFF, .length = 4, .spacing = 12 };
+    const led_effect_config_t fade = { .type = LED_EFFECT_FADE, .period_ms = 3000,
+                                       .color = 0x0000FF00, .color2 = 0x000000FF };
+    const led_effect_config_t rainbow = { .type = LED_EFFECT_RAINBOW, .period_ms = 5000,
+                                          .length = 300 };
+    const led_effect_config_t twinkle = { .type = LED_EFFECT_TWINKLE, .period_ms = 1200,
+                                          .color = 0x00FFFFFF, .density = 80, .seed = 1 };
+    const led_effect_config_t fire = { .type = LED_EFFECT_FIRE, .period_ms = 16,
+                                       .density = 120, .cooling = 55, .seed = 1 };
+
+    printf("\nRecording: %d pixels x %d frames (raw frame = %d bytes)\n",
+           RECORD_PIXELS, RECORD_FRAMES, RECORD_PIXELS * 3);
+    printf("%-10s %12s %12s %12s %12s\n", "effect", "bytes/frame", "ratio",
+           "record fps", "replay fps");
+
+    if (bench_record_effect("chase", &chase) != 0 || bench_record_effect("fade", &fade) != 0 ||
+        bench_record_effect("rainbow", &rainbow) != 0 ||
+        bench_record_effect("twinkle", &twinkle) != 0 || bench_record_effect("fire", &fire) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* ======================== Dithering ======================== */
+
+/**
+ * @brief Commit full frames of a 16-bit strip; ns per frame
+ */
+static double time_dither(led_strip_t *strip) {
+    led_frame_t frame;
+    uint64_t frames = 0;
+    uint64_t elapsed;
+
+    led_strip_mark_all_dirty(strip);    // Warm up
+    led_strip_commit(strip, &frame);
+    uint64_t start = now_ns();
+    do {
+        led_strip_mark_all_dirty(strip);
+        led_strip_commit(strip, &frame);
+        frames++;
+        elapsed = now_ns() - start;
+    } while (elapsed < DITHER_RUN_NS);
+
+    return (double)elapsed / (double)frames;
+}
+
+static int bench_dither(void) {
+    static const size_t sizes[] = { 10000, 100000 };
+    static const char *modes[] = { "round", "ordered", "temporal" };
+    led_simd_level_t best = led_simd_get_level();
+
+    printf("\nDithering: full RGBW64 frame quantized to 8 bits at commit\n");
+    printf("%-8s %-9s %-7s %10s %10s %9s %13s\n",
+           "pixels", "mode", "level", "us/frame", "ns/pixel", "speedup", "60fps budget");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        led_strip_t *strip = led_strip_create_format(sizes[s], LED_FORMAT_RGBW64);
+        if (strip == NULL) {
+            return -1;
+        }
+        // A dim gradient: low levels with fractions, where dithering matters
+        for (size_t i = 0; i < sizes[s]; i++) {
+            uint16_t v = (uint16_t)(i * 7 % 4096);
+            led_strip_set_pixel_rgbw16(strip, i, v, (uint16_t)(4095 - v), (uint16_t)(v / 2), 0);
+        }
+
+        for (int mode = LED_DITHER_NONE; mode <= LED_DITHER_TEMPORAL; mode++) {
+            double scalar_ns = 0.0;
+            if (led_strip_set_dither(strip, (led_dither_t)mode) != 0) {
+                led_strip_destroy(strip);
+                return -1;
+            }
+            for (int level = LED_SIMD_SCALAR; level <= (int)best; level++) {
+                if (led_simd_set_level((led_simd_level_t)level) != 0) {
+                    continue;
+                }
+                double ns = time_dither(strip);
+                if (level == LED_SIMD_SCALAR) {
+                    scalar_ns = ns;
+                }
+                printf("%-8zu %-9s %-7s %10.1f %10.2f %8.2fx %12.2f%%\n", sizes[s], modes[mode],
+                       led_simd_level_name((led_simd_level_t)level), ns / 1e3,
+                       ns / (double)sizes[s], scalar_ns / ns, 100.0 * ns / DITHER_FRAME_NS);
+            }
+        }
+        led_simd_set_level(best);
+        led_strip_destroy(strip);
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-q] [-s BASELINE] [-c BASELINE] [-t PCT]\n", prog);
+    fprintf(stderr, "  -q           run the size sweep only\n");
+    fprintf(stderr, "  -s BASELINE  save the size sweep results\n");
+    fprintf(stderr, "  -c BASELINE  fail if the size sweep is slower than a saved baseline\n");
+    fprintf(stderr, "  -t PCT       slowdown allowed by -c (default %.0f)\n",
+            SWEEP_THRESHOLD_PCT);
+}
+
+int main(int argc, char *argv[]) {
+    bench_options_t options = { .threshold_pct = SWEEP_THRESHOLD_PCT };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "qs:c:t:h")) != -1) {
+        switch (opt) {
+            case 'q':
+                options.sweep_only = true;
+                break;
+            case 's':
+                options.save_path = optarg;
+                break;
+            case 'c':
+                options.check_path = optarg;
+                break;
+            case 't': {
+                char *end;
+                options.threshold_pct = strtod(optarg, &end);
+                if (*end != '\0' || options.threshold_pct < 0.0) {
+                    fprintf(stderr, "Error: Invalid threshold '%s'\n", optarg);
+                    return 2;
+                }
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : 2;
+        }
+    }
+    if (optind != argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    int check = bench_sweep(&options);
+    if (check < 0 ||
+        (!options.sweep_only &&
+         (bench_multi_strip() != 0 || bench_frame_buffering() != 0 || bench_encoder() != 0 ||
+          bench_formats() != 0 || bench_effects() != 0 || bench_matrix() != 0 ||
+          bench_recording() != 0 || bench_dither() != 0))) {
+        fprintf(stderr, "Error: benchmark setup failed\n");
+        return 2;
+    }
+    return check == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
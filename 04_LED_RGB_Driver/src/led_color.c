@@ -0,0 +1,247 @@
+/**
+ * @file led_color.c
+ * @brief HSV / HSL conversion and the output correction tables
+ *
+ * Conversions use integer math only. The correction tables are built in
+ * floating point, but only when a setting changes: 1024 entries, however
+ * long the strip is.
+ */
+
+#include "led_color.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CHANNEL_MICROAMPS_DEFAULT 20000    // One WS2812B channel at full brightness
+#define WHITE_POINT_REFERENCE     6500     // Kelvin that maps to unchanged colors
+
+/* ======================== HSV / HSL ======================== */
+
+static inline uint32_t pack_rgb(uint32_t r, uint32_t g, uint32_t b) {
+    return (g << 16) | (r << 8) | b;
+}
+
+/**
+ * @brief Place the largest, rising, falling and smallest channel by hue region
+ */
+static uint32_t hue_color(uint32_t region, uint32_t max, uint32_t rising, uint32_t falling,
+                          uint32_t min) {
+    switch (region) {
+        case 0:
+            return pack_rgb(max, rising, min);     // Red -> yellow
+        case 1:
+            return pack_rgb(falling, max, min);    // Yellow -> green
+        case 2:
+            return pack_rgb(min, max, rising);     // Green -> cyan
+        case 3:
+            return pack_rgb(min, falling, max);    // Cyan -> blue
+        case 4:
+            return pack_rgb(rising, min, max);     // Blue -> magenta
+        default:
+            return pack_rgb(max, min, falling);    // Magenta -> red
+    }
+}
+
+uint32_t led_color_hsv(uint16_t hue, uint8_t sat, uint8_t val) {
+    uint32_t h = hue % 360;
+    uint32_t f = h % 60;                           // Position inside the region, 0-59
+    uint32_t v = val;
+    uint32_t s = sat;
+
+    // min = v (1 - s), falling = v (1 - s f), rising = v (1 - s (1 - f)), in 1/(255*60)
+    uint32_t min = (v * (255 - s) + 127) / 255;
+    uint32_t falling = (v * (255 * 60 - s * f) + 7650) / (255 * 60);
+    uint32_t rising = (v * (255 * 60 - s * (60 - f)) + 7650) / (255 * 60);
+    return hue_color(h / 60, v, rising, falling, min);
+}
+
+uint32_t led_color_hsl(uint16_t hue, uint8_t sat, uint8_t light) {
+    uint32_t h = hue % 360;
+    uint32_t f = h % 60;
+    uint32_t l2 = 2 * (uint32_t)light;
+
+    // Chroma C = (1 - |2L - 1|) S; channels are m + (C, X, 0) with m = L - C/2.
+    // Work in half units so m stays an integer.
+    uint32_t chroma = ((255 - (l2 > 255 ? l2 - 255 : 255 - l2)) * sat + 127) / 255;
+    uint32_t m2 = l2 - chroma;
+    uint32_t rising = (chroma * f + 30) / 60;
+    uint32_t falling = chroma - rising;
+    return hue_color(h / 60, (2 * chroma + m2 + 1) / 2, (2 * rising + m2 + 1) / 2,
+                     (2 * falling + m2 + 1) / 2, (m2 + 1) / 2);
+}
+
+void led_strip_set_pixel_hsv(led_strip_t *strip, size_t index,
+                             uint16_t hue, uint8_t sat, uint8_t val) {
+    uint32_t c = led_color_hsv(hue, sat, val);
+    led_strip_set_pixel_color(strip, index, (c >> 8) & 0xFF, (c >> 16) & 0xFF, c & 0xFF);
+}
+
+void led_strip_set_pixel_hsl(led_strip_t *strip, size_t index,
+                             uint16_t hue, uint8_t sat, uint8_t light) {
+    uint32_t c = led_color_hsl(hue, sat, light);
+    led_strip_set_pixel_color(strip, index, (c >> 8) & 0xFF, (c >> 16) & 0xFF, c & 0xFF);
+}
+
+/* ======================== Correction tables ======================== */
+
+/**
+ * @brief Black-body color of a temperature, 0-255 per channel (R, G, B)
+ *
+ * Curve fit by Tanner Helland, good to a few percent from 1000 to 40000 K.
+ */
+static void black_body(uint32_t kelvin, double rgb[3]) {
+    double t = kelvin / 100.0;
+
+    rgb[0] = t <= 66.0 ? 255.0 : 329.698727446 * pow(t - 60.0, -0.1332047592);
+    rgb[1] = t <= 66.0 ? 99.4708025861 * log(t) - 161.1195681661
+                       : 288.1221695283 * pow(t - 60.0, -0.0755148492);
+    rgb[2] = t >= 66.0 ? 255.0 : t <= 19.0 ? 0.0 : 138.5177312231 * log(t - 10.0) - 305.0447927307;
+    for (int c = 0; c < 3; c++) {
+        rgb[c] = rgb[c] < 0.0 ? 0.0 : rgb[c] > 255.0 ? 255.0 : rgb[c];
+    }
+}
+
+/**
+ * @brief Channel factors (R, G, B) that shift the white point to kelvin
+ *
+ * Relative to WHITE_POINT_REFERENCE and normalized so the strongest
+ * channel keeps its full range.
+ */
+static void white_point(uint32_t kelvin, double factor[3]) {
+    double target[3];
+    double reference[3];
+    double max = 0.0;
+
+    black_body(kelvin, target);
+    black_body(WHITE_POINT_REFERENCE, reference);
+    for (int c = 0; c < 3; c++) {
+        factor[c] = target[c] / reference[c];
+        if (factor[c] > max) {
+            max = factor[c];
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        factor[c] /= max;
+    }
+}
+
+static void build_table(led_correction_t *cc) {
+    for (uint32_t c = 0; c < 4; c++) {
+        for (uint32_t v = 0; v < 256; v++) {
+            cc->table[c * 256 + v] = ((cc->base[c][v] * cc->scale) >> 8) << (8 * c);
+        }
+    }
+    if (++cc->generation == 0) {
+        cc->generation = 1;
+    }
+}
+
+static void build_base(led_correction_t *cc) {
+    static const int byte_of[4] = { 1, 2, 0, 3 };    // R, G, B, W -> byte in 0xWWGGRRBB
+    double factor[4] = { 1.0, 1.0, 1.0, 1.0 };
+
+    if (cc->config.temperature != 0) {
+        white_point(cc->config.temperature, factor);
+    }
+    for (int k = 0; k < 4; k++) {
+        double gamma = cc->config.gamma[k] > 0.0f ? cc->config.gamma[k] : 1.0;
+        double gain = factor[k] * cc->brightness;
+        uint8_t *base = cc->base[byte_of[k]];
+
+        for (int v = 0; v < 256; v++) {
+            double out = pow(v / 255.0, gamma) * gain + 0.5;
+            base[v] = (uint8_t)(out > 255.0 ? 255.0 : out);
+        }
+    }
+    if (!cc->white) {
+        memset(cc->base[3], 0, sizeof(cc->base[3]));
+    }
+    build_table(cc);
+}
+
+void led_correction_init(led_correction_t *cc, bool white) {
+    memset(cc, 0, sizeof(*cc));
+    cc->brightness = 255;
+    cc->white = white;
+    cc->scale = 256;
+    build_base(cc);
+}
+
+int led_correction_configure(led_correction_t *cc, const led_correction_config_t *config) {
+    for (int k = 0; k < 4; k++) {
+        if (!(config->gamma[k] >= 0.0f && config->gamma[k] <= 10.0f)) {
+            fprintf(stderr, "Error: Gamma %g is outside 0-10\n", config->gamma[k]);
+            return -1;
+        }
+    }
+    if (config->temperature != 0 &&
+        (config->temperature < 1000 || config->temperature > 40000)) {
+        fprintf(stderr, "Error: Temperature %u K is outside 1000-40000 K\n",
+                config->temperature);
+        return -1;
+    }
+    cc->config = *config;
+    cc->scale = 256;    // The limiter settles again from full power
+    build_base(cc);
+    return 0;
+}
+
+void led_correction_set_brightness(led_correction_t *cc, uint8_t brightness) {
+    if (cc->brightness != brightness) {
+        cc->brightness = brightness;
+        build_base(cc);
+    }
+}
+
+void led_correction_set_scale(led_correction_t *cc, uint32_t scale) {
+    cc->scale = scale;
+    build_table(cc);
+}
+
+/* ======================== Power limiting ======================== */
+
+static uint64_t channel_microamps(const led_correction_t *cc) {
+    return cc->config.channel_microamps ? cc->config.channel_microamps
+                                        : CHANNEL_MICROAMPS_DEFAULT;
+}
+
+uint32_t led_correction_limit(const led_correction_t *cc, uint64_t byte_sum,
+                              size_t num_pixels, bool allow_raise) {
+    if (cc->config.max_milliamps == 0) {
+        return 256;
+    }
+
+    uint64_t budget = (uint64_t)cc->config.max_milliamps * 1000;
+    uint64_t idle = (uint64_t)num_pixels * cc->config.idle_microamps;
+    if (idle >= budget) {
+        return 0;
+    }
+    budget -= idle;
+
+    // Channel current is linear in the channel value, so the frame scales
+    // with the factor: the right factor is scale * budget / current
+    uint64_t color = byte_sum * channel_microamps(cc) / 255;
+    uint64_t target = color > 0 ? cc->scale * budget / color : 256;
+    if (target > 256) {
+        target = 256;
+    }
+    if (color > budget) {
+        return (uint32_t)target;
+    }
+    if (!allow_raise || (target < cc->scale + LED_POWER_HYSTERESIS && target != 256)) {
+        return cc->scale;
+    }
+    return (uint32_t)target;
+}
+
+void led_correction_power(const led_correction_t *cc, uint64_t byte_sum, size_t num_pixels,
+                          led_power_info_t *info) {
+    uint64_t idle = (uint64_t)num_pixels * cc->config.idle_microamps;
+    uint64_t color = byte_sum * channel_microamps(cc) / 255;
+
+    info->output_milliamps = (uint32_t)((idle + color + 500) / 1000);
+    info->requested_milliamps = cc->scale > 0
+        ? (uint32_t)((idle + color * 256 / cc->scale + 500) / 1000)
+        : info->output_milliamps;
+    info->scale = cc->scale;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file led_color.h
+ * @brief Internal output correction tables and power limiting
+ *
+ * Private to the driver. Gamma, white point and brightness of a channel
+ * are folded into one 256-entry table (base), and the power limit scales
+ * all of them at once. The active tables are stored as 32-bit words
+ * already shifted to the byte of their channel, so correcting a 0xWWGGRRBB
+ * word is four lookups ORed together (the correct kernel in led_simd.h).
+ */
+
+#ifndef LED_COLOR_H
+#define LED_COLOR_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+/**
+ * @brief Smallest power scale increase (1/256 units) worth a full re-send
+ */
+#define LED_POWER_HYSTERESIS 4
+
+/**
+ * @brief Correction state of one strip
+ */
+typedef struct {
+    led_correction_config_t config;
+    uint8_t brightness;
+    bool white;                    // RGBW32: the W byte is corrected too
+    uint32_t scale;                // Power limit factor, 256 = full
+    uint8_t base[4][256];          // B, R, G, W: gamma x white point x brightness
+    uint32_t table[1024];          // base x scale, shifted into place
+    uint32_t generation;           // Changes with every table update, never 0
+} led_correction_t;
+
+/**
+ * @brief Initialize to a neutral correction at full brightness
+ */
+void led_correction_init(led_correction_t *cc, bool white);
+
+/**
+ * @brief Apply a configuration (rebuilds the tables)
+ *
+ * @return int 0 on success, -1 on out-of-range gamma or temperature
+ */
+int led_correction_configure(led_correction_t *cc, const led_correction_config_t *config);
+
+void led_correction_set_brightness(led_correction_t *cc, uint8_t brightness);
+
+void led_correction_set_scale(led_correction_t *cc, uint32_t scale);
+
+/**
+ * @brief Power scale a frame should use
+ *
+ * @param byte_sum Sum of all output bytes of the frame at the current scale
+ * @param num_pixels LEDs in the strip (idle current)
+ * @param allow_raise false: only ever return a lower scale
+ * @return uint32_t New scale, or cc->scale if it should not change
+ */
+uint32_t led_correction_limit(const led_correction_t *cc, uint64_t byte_sum,
+                              size_t num_pixels, bool allow_raise);
+
+/**
+ * @brief Current estimate of a frame
+ */
+void led_correction_power(const led_correction_t *cc, uint64_t byte_sum, size_t num_pixels,
+                          led_power_info_t *info);
+
+#endif // LED_COLOR_H
@@ -1,35 +1,97 @@
 /**
  * @file led_driver.c
  * @brief Implementation of the LED RGB driver
+ *
+ * All state lives in a led_strip_t instance, so independent strips never
+ * share data or locks. The original single-strip API (led_init(),
+ * led_set_pixel_color(), ...) forwards to one default instance.
+ *
+ * With double/triple buffering, buffers[back] is the render target and
+ * the consumer reads buffers[front]. Only the index swap in present() and
+ * acquire() takes the per-strip swap_lock; pixels are never copied for the
+ * consumer. After a swap the new back buffer is brought up to date by
+ * copying just the spans that changed since it was last rendered into.
+ *
+ * Pixels are stored in the strip's format (led_format.h); every access
+ * goes through the format's function table, chosen once at creation.
+ *
+ * With a color correction (led_color.h), every buffer has a corrected copy
+ * in outputs[] that frames point to instead. A commit / present corrects
+ * only the spans that changed in its buffer since that output was last
+ * corrected, unless the tables changed, which redoes the whole output.
+ * RGBW64 strips always have outputs[]: their 16-bit buffers are dithered
+ * into 8-bit words the same way (led_strip_set_dither()).
  */
 
 #include "led_driver.h"
+#include "led_format.h"
+#include "led_color.h"
+#include "led_simd.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 
+/* Maximum number of pixel buffers per strip (triple buffering) */
+#define LED_MAX_BUFFERS 3
+
+/* Pixels per change check of temporal dithering (one span per changed block) */
+#define LED_DITHER_BLOCK 256
+
 /**
- * @brief LED driver state structure (private)
+ * @brief LED strip state structure (private)
  */
-static struct {
-    uint32_t *buffer;      // Buffer storing color data for each pixel
+struct led_strip {
+    uint8_t *buffer;       // Buffer storing color data for each pixel (render target)
     size_t num_pixels;     // Number of pixels in the strip
-    bool initialized;      // Initialization status
-} led_state = {
-    .buffer = NULL,
-    .num_pixels = 0,
-    .initialized = false
+    const led_format_ops_t *ops;   // Storage format of every buffer
+    led_palette_t *palette;        // PAL8 only, NULL otherwise
+    led_span_t dirty[LED_MAX_DIRTY_SPANS];  // Sorted, non-adjacent dirty spans
+    size_t num_dirty;      // Number of valid entries in dirty[]
+    uint32_t sequence;     // Sequence number of the last committed frame
+
+    // Frame buffering, see led_strip_set_buffering()
+    led_buffering_t buffering;
+    uint8_t *buffers[LED_MAX_BUFFERS];     // buffers[back] == buffer
+    led_frame_t slots[LED_MAX_BUFFERS];    // Published frame description per buffer
+    led_span_t stale[LED_MAX_BUFFERS][LED_MAX_DIRTY_SPANS];  // Older than newest frame
+    size_t num_stale[LED_MAX_BUFFERS];
+    int back;              // Render target (producer only)
+    int front;             // Frame the consumer reads
+    int ready;             // Newest frame waiting for the consumer (triple only)
+    bool fresh;            // A presented frame has not been acquired yet
+    bool front_held;       // Consumer holds buffers[front]
+    pthread_mutex_t swap_lock;             // Guards the indices and flags above
+    pthread_cond_t front_released;         // Double buffering: present waits on it
+
+    // Color correction, see led_strip_set_correction() (NULL = frames show buffers[])
+    led_correction_t *correction;
+    uint32_t *outputs[LED_MAX_BUFFERS];    // Corrected copy of buffers[i]
+    uint32_t output_generation[LED_MAX_BUFFERS];   // Tables outputs[i] was made with (0 = none)
+    uint64_t output_sum[LED_MAX_BUFFERS];  // Sum of all bytes of outputs[i] (power estimate)
+    led_span_t pending[LED_MAX_BUFFERS][LED_MAX_DIRTY_SPANS];  // Changed in buffers[i] since
+    size_t num_pending[LED_MAX_BUFFERS];                        // outputs[i] was corrected
+    int last_output;                       // Output of the newest frame
+
+    // RGBW64 only: outputs[] hold buffers[] dithered to 8 bits (no correction)
+    led_dither_t dither;
+    uint32_t *dither_error;                // Temporal: remainder per channel, 1/256 level
 };
 
+/**
+ * @brief Strip used by the single-strip API (NULL until led_init())
+ */
+static led_strip_t *default_strip = NULL;
+
 /**
  * @brief Pack RGB components into a 32-bit color value
- * 
+ *
  * Format: 0x00GGRRBB (G-R-B order for WS2812B)
  * - Bits 23-16: Green
  * - Bits 15-8:  Red
  * - Bits 7-0:   Blue
- * 
+ *
  * @param r Red component (0-255)
  * @param g Green component (0-255)
  * @param b Blue component (0-255)
@@ -41,126 +103,1163 @@ static inline uint32_t pack_color(uint8_t r, uint8_t g, uint8_t b) {
 
 /**
  * @brief Check if a pixel index is valid
- * 
+ *
+ * @param strip Strip to check against (may be NULL)
  * @param index Pixel index to check
  * @return true if valid, false otherwise
  */
-static inline bool is_valid_index(size_t index) {
-    return led_state.initialized && (index < led_state.num_pixels);
+static inline bool is_valid_index(const led_strip_t *strip, size_t index) {
+    return strip != NULL && (index < strip->num_pixels);
 }
 
-int led_init(size_t num_pixels) {
+/**
+ * @brief View a buffer as 0x00GGRRBB words, or NULL if the format is not 32-bit
+ */
+static inline const uint32_t *as_words(const led_strip_t *strip, const uint8_t *buffer) {
+    return strip->ops->bytes_per_pixel == sizeof(uint32_t) ? (const uint32_t *)buffer : NULL;
+}
+
+/**
+ * @brief Frames show outputs[] (corrected or dithered) instead of buffers[]
+ */
+static inline bool has_outputs(const led_strip_t *strip) {
+    return strip->correction != NULL || strip->ops->format == LED_FORMAT_RGBW64;
+}
+
+/**
+ * @brief Merge the two neighbouring spans separated by the smallest gap
+ *
+ * Called when a span list is full. Merging the closest pair adds the
+ * fewest clean pixels to the next frame.
+ */
+static void merge_closest_spans(led_span_t *spans, size_t *num_spans) {
+    size_t best = 0;
+    size_t best_gap = (size_t)-1;
+
+    for (size_t i = 0; i + 1 < *num_spans; i++) {
+        size_t gap = spans[i + 1].start - (spans[i].start + spans[i].count);
+        if (gap < best_gap) {
+            best_gap = gap;
+            best = i;
+        }
+    }
+
+    led_span_t *left = &spans[best];
+    const led_span_t *right = &spans[best + 1];
+    left->count = right->start + right->count - left->start;
+
+    memmove(&spans[best + 1], &spans[best + 2],
+            (*num_spans - best - 2) * sizeof(led_span_t));
+    (*num_spans)--;
+}
+
+/**
+ * @brief Add [start, start + count) to a sorted span list
+ *
+ * Spans that overlap or touch the new range are coalesced into it, so the
+ * list always stays sorted and non-adjacent. O(LED_MAX_DIRTY_SPANS).
+ */
+static void span_list_add(led_span_t *spans, size_t *num_spans,
+                          size_t start, size_t count) {
+    size_t end = start + count;
+    size_t first = 0;
+
+    // Skip spans that end strictly before the new range (not even touching)
+    while (first < *num_spans && spans[first].start + spans[first].count < start) {
+        first++;
+    }
+
+    // Fast path: already fully covered by an existing span
+    if (first < *num_spans && spans[first].start <= start &&
+        spans[first].start + spans[first].count >= end) {
+        return;
+    }
+
+    // Absorb every span that overlaps or touches [start, end)
+    size_t last = first;
+    while (last < *num_spans && spans[last].start <= end) {
+        size_t span_end = spans[last].start + spans[last].count;
+        if (spans[last].start < start) {
+            start = spans[last].start;
+        }
+        if (span_end > end) {
+            end = span_end;
+        }
+        last++;
+    }
+
+    if (last > first) {
+        // Replace spans[first..last) by the merged span
+        spans[first].start = start;
+        spans[first].count = end - start;
+        memmove(&spans[first + 1], &spans[last],
+                (*num_spans - last) * sizeof(led_span_t));
+        *num_spans -= last - first - 1;
+        return;
+    }
+
+    // Disjoint range: make room first if the list is full
+    if (*num_spans == LED_MAX_DIRTY_SPANS) {
+        merge_closest_spans(spans, num_spans);
+        span_list_add(spans, num_spans, start, end - start);
+        return;
+    }
+
+    memmove(&spans[first + 1], &spans[first], (*num_spans - first) * sizeof(led_span_t));
+    spans[first].start = start;
+    spans[first].count = end - start;
+    (*num_spans)++;
+}
+
+/**
+ * @brief Mark pixels of the render buffer as changed since the last commit
+ */
+static inline void mark_dirty(led_strip_t *strip, size_t start, size_t count) {
+    span_list_add(strip->dirty, &strip->num_dirty, start, count);
+}
+
+/**
+ * @brief Clip [start, start + count) to the strip
+ *
+ * @return Number of pixels left in range (0 if nothing to do)
+ */
+static size_t clip_range(const led_strip_t *strip, size_t start, size_t count) {
+    if (strip == NULL || start >= strip->num_pixels) {
+        return 0;
+    }
+    if (count > strip->num_pixels - start) {
+        count = strip->num_pixels - start;
+    }
+    return count;
+}
+
+/* ======================== Strip instances ======================== */
+
+led_strip_t *led_strip_create(size_t num_pixels) {
+    return led_strip_create_format(num_pixels, LED_FORMAT_GRB32);
+}
+
+led_strip_t *led_strip_create_format(size_t num_pixels, led_pixel_format_t format) {
+    const led_format_ops_t *ops = led_format_ops(format);
+
     // Validate input
     if (num_pixels == 0) {
         fprintf(stderr, "Error: num_pixels must be greater than 0\n");
-        return -1;
+        return NULL;
     }
-    
-    // Check if already initialized
-    if (led_state.initialized) {
-        fprintf(stderr, "Warning: LED driver already initialized. "
-                       "Call led_shutdown() first.\n");
-        return -1;
+    if (ops == NULL) {
+        fprintf(stderr, "Error: Unknown pixel format %d\n", (int)format);
+        return NULL;
+    }
+
+    led_strip_t *strip = (led_strip_t*)calloc(1, sizeof(led_strip_t));
+    if (strip == NULL) {
+        fprintf(stderr, "Error: Failed to allocate LED strip\n");
+        return NULL;
     }
-    
+
     // Allocate memory for the buffer
-    led_state.buffer = (uint32_t*)calloc(num_pixels, sizeof(uint32_t));
-    if (led_state.buffer == NULL) {
-        fprintf(stderr, "Error: Failed to allocate memory for %zu pixels\n", 
+    strip->ops = ops;
+    strip->buffer = (uint8_t*)calloc(num_pixels, ops->bytes_per_pixel);
+    if (strip->buffer == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory for %zu pixels\n",
                 num_pixels);
-        return -1;
+        free(strip);
+        return NULL;
     }
-    
-    // Initialize state
-    led_state.num_pixels = num_pixels;
-    led_state.initialized = true;
-    
-    printf("LED driver initialized: %zu pixels\n", num_pixels);
-    return 0;
+
+    // Index 0 of the default palette is black, matching the zeroed buffer
+    if (format == LED_FORMAT_PAL8) {
+        strip->palette = (led_palette_t*)malloc(sizeof(led_palette_t));
+        if (strip->palette == NULL) {
+            fprintf(stderr, "Error: Failed to allocate palette\n");
+            free(strip->buffer);
+            free(strip);
+            return NULL;
+        }
+        led_palette_default(strip->palette);
+    }
+
+    // 16-bit pixels are never sent as stored: frames show their dithered output
+    if (format == LED_FORMAT_RGBW64) {
+        strip->outputs[0] = (uint32_t*)calloc(num_pixels, sizeof(uint32_t));
+        if (strip->outputs[0] == NULL) {
+            fprintf(stderr, "Error: Failed to allocate dithered output\n");
+            free(strip->buffer);
+            free(strip);
+            return NULL;
+        }
+    }
+
+    // The first commit must send the whole strip
+    strip->num_pixels = num_pixels;
+    mark_dirty(strip, 0, num_pixels);
+
+    // Single buffering until led_strip_set_buffering() says otherwise
+    strip->buffering = LED_BUFFER_SINGLE;
+    strip->buffers[0] = strip->buffer;
+    pthread_mutex_init(&strip->swap_lock, NULL);
+    pthread_cond_init(&strip->front_released, NULL);
+    return strip;
 }
 
-void led_shutdown(void) {
-    if (!led_state.initialized) {
+void led_strip_destroy(led_strip_t *strip) {
+    if (strip == NULL) {
         return;
     }
-    
-    // Free allocated memory
-    if (led_state.buffer != NULL) {
-        free(led_state.buffer);
-        led_state.buffer = NULL;
+    for (int i = 0; i < LED_MAX_BUFFERS; i++) {
+        free(strip->buffers[i]);
+        free(strip->outputs[i]);
     }
-    
-    // Reset state
-    led_state.num_pixels = 0;
-    led_state.initialized = false;
-    
-    printf("LED driver shut down\n");
+    free(strip->correction);
+    free(strip->dither_error);
+    free(strip->palette);
+    pthread_mutex_destroy(&strip->swap_lock);
+    pthread_cond_destroy(&strip->front_released);
+    free(strip);
 }
 
-void led_set_pixel_color(size_t index, uint8_t r, uint8_t g, uint8_t b) {
+void led_strip_set_pixel_color(led_strip_t *strip, size_t index,
+                               uint8_t r, uint8_t g, uint8_t b) {
     // Bounds checking
-    if (!is_valid_index(index)) {
+    if (!is_valid_index(strip, index)) {
         return;  // Silently ignore out-of-bounds access
     }
-    
-    // Pack color and store in buffer
-    led_state.buffer[index] = pack_color(r, g, b);
+
+    // Pack color and store in buffer; unchanged pixels stay clean
+    if (strip->ops->store(strip->buffer, index, pack_color(r, g, b), strip->palette)) {
+        mark_dirty(strip, index, 1);
+    }
 }
 
-void led_fill(uint8_t r, uint8_t g, uint8_t b) {
-    if (!led_state.initialized) {
+void led_strip_fill(led_strip_t *strip, uint8_t r, uint8_t g, uint8_t b) {
+    if (strip == NULL) {
         return;
     }
-    
-    // Pack color once
+
+    // Pack color once, then let the format's fill loop (SIMD for GRB32) run
     uint32_t color = pack_color(r, g, b);
-    
-    // Fill entire buffer with this color
-    for (size_t i = 0; i < led_state.num_pixels; i++) {
-        led_state.buffer[i] = color;
-    }
+    strip->ops->fill(strip->buffer, 0, strip->num_pixels, color, strip->palette);
+    mark_dirty(strip, 0, strip->num_pixels);
 }
 
-void led_clear(void) {
+void led_strip_clear(led_strip_t *strip) {
     // Clear is just fill with black (0, 0, 0)
-    led_fill(0, 0, 0);
+    led_strip_fill(strip, 0, 0, 0);
 }
 
-const uint32_t* led_get_buffer(void) {
-    if (!led_state.initialized) {
-        return NULL;
+const uint32_t* led_strip_get_buffer(const led_strip_t *strip) {
+    return strip != NULL ? as_words(strip, strip->buffer) : NULL;
+}
+
+size_t led_strip_get_pixel_count(const led_strip_t *strip) {
+    return strip != NULL ? strip->num_pixels : 0;
+}
+
+uint32_t led_strip_get_pixel(const led_strip_t *strip, size_t index) {
+    if (!is_valid_index(strip, index)) {
+        return 0;
     }
-    return led_state.buffer;
+    return strip->ops->load(strip->buffer, index, strip->palette);
 }
 
-size_t led_get_pixel_count(void) {
-    return led_state.initialized ? led_state.num_pixels : 0;
+void led_strip_fill_range(led_strip_t *strip, size_t start, size_t count,
+                          uint8_t r, uint8_t g, uint8_t b) {
+    count = clip_range(strip, start, count);
+    if (count == 0) {
+        return;
+    }
+    strip->ops->fill(strip->buffer, start, count, pack_color(r, g, b), strip->palette);
+    mark_dirty(strip, start, count);
 }
 
-uint32_t led_get_pixel(size_t index) {
-    if (!is_valid_index(index)) {
+void led_strip_copy_range(led_strip_t *strip, size_t start,
+                          const uint32_t *src, size_t count) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || src == NULL) {
+        return;
+    }
+    strip->ops->copy(strip->buffer, start, src, count, strip->palette);
+    mark_dirty(strip, start, count);
+}
+
+void led_strip_scale_range(led_strip_t *strip, size_t start, size_t count,
+                           uint8_t scale_r, uint8_t scale_g, uint8_t scale_b) {
+    count = clip_range(strip, start, count);
+    if (count == 0) {
+        return;
+    }
+    strip->ops->scale(strip->buffer, start, count, scale_r, scale_g, scale_b, strip->palette);
+    mark_dirty(strip, start, count);
+}
+
+void led_strip_blend_range(led_strip_t *strip, size_t start,
+                           const uint32_t *src, size_t count, uint8_t alpha) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || src == NULL) {
+        return;
+    }
+    strip->ops->blend(strip->buffer, start, src, count, alpha, strip->palette);
+    mark_dirty(strip, start, count);
+}
+
+void led_strip_apply_lut(led_strip_t *strip, size_t start, size_t count,
+                         const uint8_t lut[256]) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || lut == NULL) {
+        return;
+    }
+    strip->ops->apply_lut(strip->buffer, start, count, lut, strip->palette);
+    mark_dirty(strip, start, count);
+}
+
+void led_strip_pack_planar(led_strip_t *strip, size_t start, const uint8_t *r,
+                           const uint8_t *g, const uint8_t *b, size_t count) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || r == NULL || g == NULL || b == NULL) {
+        return;
+    }
+    strip->ops->pack_planar(strip->buffer, start, r, g, b, count, strip->palette);
+    mark_dirty(strip, start, count);
+}
+
+/* ======================== Color correction ======================== */
+
+/**
+ * @brief Allocate an output for each of the first count buffers, free the rest
+ *
+ * Outputs that are kept or new are marked for a full correction.
+ *
+ * @return int 0 on success, -1 on allocation failure (nothing freed)
+ */
+static int resize_outputs(led_strip_t *strip, int count) {
+    for (int i = 0; i < count; i++) {
+        if (strip->outputs[i] == NULL) {
+            strip->outputs[i] = (uint32_t*)calloc(strip->num_pixels, sizeof(uint32_t));
+            strip->output_sum[i] = 0;
+            if (strip->outputs[i] == NULL) {
+                fprintf(stderr, "Error: Failed to allocate output buffer\n");
+                return -1;
+            }
+        }
+    }
+    for (int i = 0; i < LED_MAX_BUFFERS; i++) {
+        if (i >= count) {
+            free(strip->outputs[i]);
+            strip->outputs[i] = NULL;
+        }
+        strip->output_generation[i] = 0;
+        strip->num_pending[i] = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Correct buffers[index] into outputs[index] and point the frame at it
+ *
+ * The frame's spans and those changed in the buffer since its last
+ * correction go through the tables. A new power scale changes the tables,
+ * so the output is then redone in full and the frame covers the strip.
+ */
+static void correct_frame(led_strip_t *strip, int index, led_frame_t *frame) {
+    led_correction_t *cc = strip->correction;
+    const led_kernels_t *kernels = led_simd_kernels();
+    const uint32_t *src = (const uint32_t*)strip->buffers[index];
+    uint32_t *out = strip->outputs[index];
+    uint64_t *sum = &strip->output_sum[index];
+    bool full = strip->output_generation[index] != cc->generation;
+    bool allow_raise = true;
+
+    if (!full) {
+        for (size_t k = 0; k < frame->num_spans; k++) {
+            span_list_add(strip->pending[index], &strip->num_pending[index],
+                          frame->spans[k].start, frame->spans[k].count);
+        }
+        for (size_t k = 0; k < strip->num_pending[index]; k++) {
+            const led_span_t *span = &strip->pending[index][k];
+            *sum += kernels->correct(out + span->start, src + span->start, span->count,
+                                     cc->table, cc->white);
+        }
+    }
+    strip->num_pending[index] = 0;
+
+    for (;;) {
+        if (full) {
+            *sum += kernels->correct(out, src, strip->num_pixels, cc->table, cc->white);
+            strip->output_generation[index] = cc->generation;
+        }
+        uint32_t scale = led_correction_limit(cc, *sum, strip->num_pixels, allow_raise);
+        if (scale == cc->scale) {
+            break;
+        }
+        // After the first change only lower the scale, so this always ends
+        led_correction_set_scale(cc, scale);
+        allow_raise = false;
+        full = true;
+    }
+
+    if (full) {
+        frame->num_spans = 1;
+        frame->spans[0].start = 0;
+        frame->spans[0].count = strip->num_pixels;
+    }
+    frame->buffer = out;
+    frame->data = out;
+    strip->last_output = index;
+}
+
+int led_strip_set_correction(led_strip_t *strip, const led_correction_config_t *config) {
+    if (strip == NULL) {
+        return -1;
+    }
+
+    if (config == NULL) {
+        if (strip->correction == NULL) {
+            return 0;
+        }
+        // Published frames point at the outputs: only drop them while none is read
+        pthread_mutex_lock(&strip->swap_lock);
+        if (strip->front_held) {
+            pthread_mutex_unlock(&strip->swap_lock);
+            return -1;
+        }
+        for (int i = 0; i < LED_MAX_BUFFERS; i++) {
+            strip->slots[i].buffer = as_words(strip, strip->buffers[i]);
+            strip->slots[i].data = strip->buffers[i];
+        }
+        pthread_mutex_unlock(&strip->swap_lock);
+
+        resize_outputs(strip, 0);
+        free(strip->correction);
+        strip->correction = NULL;
+        mark_dirty(strip, 0, strip->num_pixels);
+        return 0;
+    }
+
+    if (strip->ops->bytes_per_pixel != sizeof(uint32_t)) {
+        fprintf(stderr, "Error: Color correction needs a 32-bit pixel format, not %s\n",
+                led_format_name(strip->ops->format));
+        return -1;
+    }
+    if (strip->correction == NULL) {
+        led_correction_t *cc = (led_correction_t*)malloc(sizeof(led_correction_t));
+        if (cc == NULL) {
+            fprintf(stderr, "Error: Failed to allocate color correction\n");
+            return -1;
+        }
+        led_correction_init(cc, strip->ops->format == LED_FORMAT_RGBW32);
+        if (led_correction_configure(cc, config) != 0 ||
+            resize_outputs(strip, (int)strip->buffering) != 0) {
+            resize_outputs(strip, 0);
+            free(cc);
+            return -1;
+        }
+        strip->correction = cc;
         return 0;
     }
-    return led_state.buffer[index];
+    return led_correction_configure(strip->correction, config);
 }
 
-void led_print_buffer(void) {
-    if (!led_state.initialized) {
+int led_strip_set_brightness(led_strip_t *strip, uint8_t brightness) {
+    if (strip == NULL) {
+        return -1;
+    }
+    if (strip->correction == NULL) {
+        static const led_correction_config_t neutral;    // All defaults
+        if (brightness == 255) {
+            return 0;
+        }
+        if (led_strip_set_correction(strip, &neutral) != 0) {
+            return -1;
+        }
+    }
+    led_correction_set_brightness(strip->correction, brightness);
+    return 0;
+}
+
+uint8_t led_strip_get_brightness(const led_strip_t *strip) {
+    return strip != NULL && strip->correction != NULL ? strip->correction->brightness : 255;
+}
+
+int led_strip_get_power(const led_strip_t *strip, led_power_info_t *info) {
+    if (strip == NULL || strip->correction == NULL || info == NULL) {
+        return -1;
+    }
+    led_correction_power(strip->correction, strip->output_sum[strip->last_output],
+                         strip->num_pixels, info);
+    return 0;
+}
+
+/* ======================== High color depth ======================== */
+
+/*
+ * Ordered thresholds in 1/256 level: the 4-bit bit-reversal sequence
+ * (0, 8, 4, 12, ...) spreads each fraction evenly over 16 pixels. All
+ * channels share the threshold so grays stay gray. Stored twice (32
+ * pixels x 4 lanes) so the kernels can read 16 pixels from any phase.
+ */
+#define DITHER_PX(k) (k) * 16 + 8, (k) * 16 + 8, (k) * 16 + 8, (k) * 16 + 8
+#define DITHER_16PX DITHER_PX(0), DITHER_PX(8), DITHER_PX(4), DITHER_PX(12),  \
+                    DITHER_PX(2), DITHER_PX(10), DITHER_PX(6), DITHER_PX(14), \
+                    DITHER_PX(1), DITHER_PX(9), DITHER_PX(5), DITHER_PX(13),  \
+                    DITHER_PX(3), DITHER_PX(11), DITHER_PX(7), DITHER_PX(15)
+#define ROUND_4PX 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128
+
+static const uint16_t dither_pattern[128] = { DITHER_16PX, DITHER_16PX };
+static const uint16_t round_pattern[128] = {
+    ROUND_4PX, ROUND_4PX, ROUND_4PX, ROUND_4PX, ROUND_4PX, ROUND_4PX, ROUND_4PX, ROUND_4PX
+};
+
+/**
+ * @brief Dither buffers[index] into outputs[index] and point the frame at it
+ *
+ * Rounding and ordered output depend only on the pixel, so like a
+ * correction only the changed spans are redone. Temporal output changes
+ * with every frame: the whole buffer is redone and the frame's spans are
+ * the blocks that differ from the previous frame's output.
+ */
+static void dither_frame(led_strip_t *strip, int index, led_frame_t *frame) {
+    const led_kernels_t *kernels = led_simd_kernels();
+    const uint64_t *src = (const uint64_t*)strip->buffers[index];
+    uint32_t *out = strip->outputs[index];
+    uint32_t generation = (uint32_t)strip->dither + 1;    // Never 0
+    bool full = strip->output_generation[index] != generation;
+
+    if (strip->dither == LED_DITHER_TEMPORAL) {
+        const uint32_t *prev = strip->outputs[strip->last_output];
+        frame->num_spans = 0;
+        for (size_t start = 0; start < strip->num_pixels; start += LED_DITHER_BLOCK) {
+            size_t count = strip->num_pixels - start;
+            if (count > LED_DITHER_BLOCK) {
+                count = LED_DITHER_BLOCK;
+            }
+            if (kernels->dither_temporal(out + start, src + start, prev + start,
+                                         strip->dither_error + start, count)) {
+                span_list_add(frame->spans, &frame->num_spans, start, count);
+            }
+        }
+    } else {
+        const uint16_t *pattern =
+            strip->dither == LED_DITHER_ORDERED ? dither_pattern : round_pattern;
+        if (full) {
+            kernels->dither_ordered(out, src, strip->num_pixels, pattern, 0);
+        } else {
+            for (size_t k = 0; k < frame->num_spans; k++) {
+                span_list_add(strip->pending[index], &strip->num_pending[index],
+                              frame->spans[k].start, frame->spans[k].count);
+            }
+            for (size_t k = 0; k < strip->num_pending[index]; k++) {
+                const led_span_t *span = &strip->pending[index][k];
+                kernels->dither_ordered(out + span->start, src + span->start, span->count,
+                                        pattern, span->start);
+            }
+        }
+    }
+    strip->num_pending[index] = 0;
+
+    if (full) {
+        strip->output_generation[index] = generation;
+        frame->num_spans = 1;
+        frame->spans[0].start = 0;
+        frame->spans[0].count = strip->num_pixels;
+    }
+    frame->buffer = out;
+    frame->data = out;
+    frame->format = LED_FORMAT_RGBW32;              // Output words are 0xWWGGRRBB
+    strip->last_output = index;
+}
+
+int led_strip_set_dither(led_strip_t *strip, led_dither_t mode) {
+    if (strip == NULL || mode < LED_DITHER_NONE || mode > LED_DITHER_TEMPORAL) {
+        return -1;
+    }
+    if (strip->ops->format != LED_FORMAT_RGBW64) {
+        fprintf(stderr, "Error: Dithering needs the rgbw64 pixel format, not %s\n",
+                led_format_name(strip->ops->format));
+        return -1;
+    }
+    if (mode == LED_DITHER_TEMPORAL && strip->dither_error == NULL) {
+        strip->dither_error = (uint32_t*)calloc(strip->num_pixels, sizeof(uint32_t));
+        if (strip->dither_error == NULL) {
+            fprintf(stderr, "Error: Failed to allocate dither state\n");
+            return -1;
+        }
+    }
+    strip->dither = mode;    // Outputs no longer match their generation: redone in full
+    return 0;
+}
+
+led_dither_t led_strip_get_dither(const led_strip_t *strip) {
+    return strip != NULL ? strip->dither : LED_DITHER_NONE;
+}
+
+static inline uint64_t pack_color16(uint16_t r, uint16_t g, uint16_t b, uint16_t w) {
+    return ((uint64_t)w << 48) | ((uint64_t)g << 32) | ((uint64_t)r << 16) | b;
+}
+
+/**
+ * @brief Nearest 8-bit level of a 16-bit channel
+ */
+static inline uint8_t to_8bit(uint32_t v) {
+    return (uint8_t)((v * 255 + 32767) / 65535);
+}
+
+static inline uint32_t to_8bit_color(uint64_t c) {
+    return ((uint32_t)to_8bit((c >> 48) & 0xFFFF) << 24) |
+           pack_color(to_8bit((c >> 16) & 0xFFFF), to_8bit((c >> 32) & 0xFFFF),
+                      to_8bit(c & 0xFFFF));
+}
+
+void led_strip_set_pixel_rgbw16(led_strip_t *strip, size_t index,
+                                uint16_t r, uint16_t g, uint16_t b, uint16_t w) {
+    if (!is_valid_index(strip, index)) {
+        return;
+    }
+    uint64_t color = pack_color16(r, g, b, w);
+    if (strip->ops->format != LED_FORMAT_RGBW64) {
+        if (strip->ops->store(strip->buffer, index, to_8bit_color(color), strip->palette)) {
+            mark_dirty(strip, index, 1);
+        }
+        return;
+    }
+    uint64_t *px = (uint64_t*)strip->buffer + index;
+    if (*px != color) {
+        *px = color;
+        mark_dirty(strip, index, 1);
+    }
+}
+
+void led_strip_set_pixel_color16(led_strip_t *strip, size_t index,
+                                 uint16_t r, uint16_t g, uint16_t b) {
+    led_strip_set_pixel_rgbw16(strip, index, r, g, b, 0);
+}
+
+void led_strip_fill16(led_strip_t *strip, uint16_t r, uint16_t g, uint16_t b) {
+    if (strip == NULL) {
+        return;
+    }
+    uint64_t color = pack_color16(r, g, b, 0);
+    if (strip->ops->format != LED_FORMAT_RGBW64) {
+        strip->ops->fill(strip->buffer, 0, strip->num_pixels, to_8bit_color(color),
+                         strip->palette);
+    } else {
+        uint64_t *px = (uint64_t*)strip->buffer;
+        for (size_t i = 0; i < strip->num_pixels; i++) {
+            px[i] = color;
+        }
+    }
+    mark_dirty(strip, 0, strip->num_pixels);
+}
+
+void led_strip_copy_range16(led_strip_t *strip, size_t start,
+                            const uint64_t *src, size_t count) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || src == NULL) {
+        return;
+    }
+    if (strip->ops->format == LED_FORMAT_RGBW64) {
+        memcpy((uint64_t*)strip->buffer + start, src, count * sizeof(uint64_t));
+    } else {
+        // Convert in small batches for the format's copy loop
+        uint32_t words[64];
+        for (size_t done = 0; done < count; done += 64) {
+            size_t n = count - done < 64 ? count - done : 64;
+            for (size_t i = 0; i < n; i++) {
+                words[i] = to_8bit_color(src[done + i]);
+            }
+            strip->ops->copy(strip->buffer, start + done, words, n, strip->palette);
+        }
+    }
+    mark_dirty(strip, start, count);
+}
+
+uint64_t led_strip_get_pixel16(const led_strip_t *strip, size_t index) {
+    if (!is_valid_index(strip, index)) {
+        return 0;
+    }
+    if (strip->ops->format == LED_FORMAT_RGBW64) {
+        return ((const uint64_t*)strip->buffer)[index];
+    }
+    uint32_t c = strip->ops->load(strip->buffer, index, strip->palette);
+    return pack_color16((uint16_t)(((c >> 8) & 0xFF) * 257), (uint16_t)(((c >> 16) & 0xFF) * 257),
+                        (uint16_t)((c & 0xFF) * 257), (uint16_t)((c >> 24) * 257));
+}
+
+/* ======================== Commit ======================== */
+
+int led_strip_commit(led_strip_t *strip, led_frame_t *frame) {
+    if (strip == NULL || frame == NULL) {
+        return -1;
+    }
+
+    frame->sequence = ++strip->sequence;
+    frame->buffer = as_words(strip, strip->buffer);
+    frame->data = strip->buffer;
+    frame->format = strip->ops->format;
+    frame->num_spans = strip->num_dirty;
+    memcpy(frame->spans, strip->dirty, strip->num_dirty * sizeof(led_span_t));
+    if (strip->correction != NULL) {
+        correct_frame(strip, 0, frame);
+    } else if (strip->ops->format == LED_FORMAT_RGBW64) {
+        dither_frame(strip, 0, frame);
+    }
+    frame->dirty_pixels = 0;
+    for (size_t i = 0; i < frame->num_spans; i++) {
+        frame->dirty_pixels += frame->spans[i].count;
+    }
+
+    strip->num_dirty = 0;
+    return (int)frame->num_spans;
+}
+
+void led_strip_mark_all_dirty(led_strip_t *strip) {
+    if (strip == NULL) {
+        return;
+    }
+    mark_dirty(strip, 0, strip->num_pixels);
+}
+
+size_t led_strip_get_dirty_count(const led_strip_t *strip) {
+    size_t total = 0;
+
+    if (strip == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < strip->num_dirty; i++) {
+        total += strip->dirty[i].count;
+    }
+    return total;
+}
+
+/* ======================== Frame buffering ======================== */
+
+int led_strip_set_buffering(led_strip_t *strip, led_buffering_t mode) {
+    uint8_t *extra[LED_MAX_BUFFERS] = { NULL, NULL, NULL };
+    size_t bytes;
+
+    if (strip == NULL || mode < LED_BUFFER_SINGLE || mode > LED_BUFFER_TRIPLE) {
+        return -1;
+    }
+    bytes = strip->num_pixels * strip->ops->bytes_per_pixel;
+
+    // Allocate the new buffers first so a failure leaves the strip unchanged
+    for (int i = 1; i < (int)mode; i++) {
+        extra[i] = (uint8_t*)malloc(bytes);
+        if (extra[i] == NULL) {
+            for (int j = 1; j < i; j++) {
+                free(extra[j]);
+            }
+            return -1;
+        }
+        memcpy(extra[i], strip->buffer, bytes);
+    }
+
+    pthread_mutex_lock(&strip->swap_lock);
+    if (strip->front_held ||
+        (has_outputs(strip) && resize_outputs(strip, (int)mode) != 0)) {
+        pthread_mutex_unlock(&strip->swap_lock);
+        for (int i = 1; i < (int)mode; i++) {
+            free(extra[i]);
+        }
+        return -1;
+    }
+
+    // Keep the render buffer as buffers[0] and replace all others
+    for (int i = 0; i < LED_MAX_BUFFERS; i++) {
+        if (strip->buffers[i] != strip->buffer) {
+            free(strip->buffers[i]);
+        }
+        strip->buffers[i] = extra[i];
+        strip->num_stale[i] = 0;
+    }
+    strip->buffers[0] = strip->buffer;
+    strip->buffering = mode;
+    strip->back = 0;
+    strip->front = 1;
+    strip->ready = 2;
+    strip->fresh = false;
+    pthread_mutex_unlock(&strip->swap_lock);
+    return 0;
+}
+
+led_buffering_t led_strip_get_buffering(const led_strip_t *strip) {
+    return strip != NULL ? strip->buffering : LED_BUFFER_SINGLE;
+}
+
+/**
+ * @brief Add every span of src to the span list of dst
+ */
+static void merge_frame_spans(led_frame_t *dst, const led_frame_t *src) {
+    for (size_t i = 0; i < src->num_spans; i++) {
+        span_list_add(dst->spans, &dst->num_spans, src->spans[i].start, src->spans[i].count);
+    }
+}
+
+int led_strip_present(led_strip_t *strip) {
+    led_span_t changed[LED_MAX_DIRTY_SPANS];
+    size_t num_changed;
+
+    if (strip == NULL || strip->buffering == LED_BUFFER_SINGLE) {
+        return -1;
+    }
+
+    // Take the spans rendered since the previous present
+    num_changed = strip->num_dirty;
+    memcpy(changed, strip->dirty, num_changed * sizeof(led_span_t));
+    strip->num_dirty = 0;
+
+    // Describe the frame; buffers[back] is not visible to the consumer yet
+    int published = strip->back;
+    led_frame_t *frame = &strip->slots[published];
+    frame->sequence = ++strip->sequence;
+    frame->buffer = as_words(strip, strip->buffers[published]);
+    frame->data = strip->buffers[published];
+    frame->format = strip->ops->format;
+    frame->num_spans = num_changed;
+    memcpy(frame->spans, changed, num_changed * sizeof(led_span_t));
+    if (strip->correction != NULL) {
+        correct_frame(strip, published, frame);
+    } else if (strip->ops->format == LED_FORMAT_RGBW64) {
+        dither_frame(strip, published, frame);
+    }
+
+    pthread_mutex_lock(&strip->swap_lock);
+    if (strip->buffering == LED_BUFFER_DOUBLE) {
+        // Never render into the buffer the consumer is reading
+        while (strip->front_held) {
+            pthread_cond_wait(&strip->front_released, &strip->swap_lock);
+        }
+        if (strip->fresh) {
+            merge_frame_spans(frame, &strip->slots[strip->front]);
+        }
+        strip->back = strip->front;
+        strip->front = published;
+    } else {
+        // Triple: replace the waiting frame, the consumer keeps its front
+        if (strip->fresh) {
+            merge_frame_spans(frame, &strip->slots[strip->ready]);
+        }
+        strip->back = strip->ready;
+        strip->ready = published;
+    }
+    frame->dirty_pixels = 0;
+    for (size_t k = 0; k < frame->num_spans; k++) {
+        frame->dirty_pixels += frame->spans[k].count;
+    }
+    strip->fresh = true;
+    pthread_mutex_unlock(&strip->swap_lock);
+
+    // The frame's pixels are now stale in every other buffer
+    for (int i = 0; i < (int)strip->buffering; i++) {
+        if (i == published) {
+            continue;
+        }
+        for (size_t k = 0; k < num_changed; k++) {
+            span_list_add(strip->stale[i], &strip->num_stale[i],
+                          changed[k].start, changed[k].count);
+        }
+    }
+
+    // Bring the new render target up to date with the frame just presented
+    int back = strip->back;
+    size_t bpp = strip->ops->bytes_per_pixel;
+    for (size_t k = 0; k < strip->num_stale[back]; k++) {
+        const led_span_t *span = &strip->stale[back][k];
+        memcpy(strip->buffers[back] + span->start * bpp,
+               strip->buffers[published] + span->start * bpp, span->count * bpp);
+        if (has_outputs(strip)) {
+            span_list_add(strip->pending[back], &strip->num_pending[back],
+                          span->start, span->count);
+        }
+    }
+    strip->num_stale[back] = 0;
+    strip->buffer = strip->buffers[back];
+    return 0;
+}
+
+const led_frame_t *led_strip_acquire_frame(led_strip_t *strip) {
+    const led_frame_t *frame = NULL;
+
+    if (strip == NULL || strip->buffering == LED_BUFFER_SINGLE) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&strip->swap_lock);
+    if (strip->fresh && !strip->front_held) {
+        if (strip->buffering == LED_BUFFER_TRIPLE) {
+            int previous = strip->front;
+            strip->front = strip->ready;
+            strip->ready = previous;
+        }
+        strip->fresh = false;
+        strip->front_held = true;
+        frame = &strip->slots[strip->front];
+    }
+    pthread_mutex_unlock(&strip->swap_lock);
+    return frame;
+}
+
+void led_strip_release_frame(led_strip_t *strip) {
+    if (strip == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&strip->swap_lock);
+    strip->front_held = false;
+    pthread_cond_signal(&strip->front_released);
+    pthread_mutex_unlock(&strip->swap_lock);
+}
+
+void led_strip_print_buffer(const led_strip_t *strip) {
+    if (strip == NULL) {
         printf("LED buffer not initialized\n");
         return;
     }
-    
-    printf("\n=== LED Buffer (%zu pixels) ===\n", led_state.num_pixels);
-    for (size_t i = 0; i < led_state.num_pixels; i++) {
-        uint32_t color = led_state.buffer[i];
-        
+
+    printf("\n=== LED Buffer (%zu pixels) ===\n", strip->num_pixels);
+    for (size_t i = 0; i < strip->num_pixels; i++) {
+        uint32_t color = strip->ops->load(strip->buffer, i, strip->palette);
+
         // Extract RGB components
         uint8_t g = (color >> 16) & 0xFF;
         uint8_t r = (color >> 8) & 0xFF;
         uint8_t b = color & 0xFF;
-        
-        printf("Pixel[%2zu]: 0x%08X  (R:%3d, G:%3d, B:%3d)\n", 
+
+        printf("Pixel[%2zu]: 0x%08X  (R:%3d, G:%3d, B:%3d)\n",
                i, color, r, g, b);
     }
     printf("================================\n\n");
 }
+
+/* ======================== Pixel formats ======================== */
+
+led_pixel_format_t led_strip_get_format(const led_strip_t *strip) {
+    return strip != NULL ? strip->ops->format : LED_FORMAT_GRB32;
+}
+
+size_t led_format_bytes_per_pixel(led_pixel_format_t format) {
+    const led_format_ops_t *ops = led_format_ops(format);
+    return ops != NULL ? ops->bytes_per_pixel : 0;
+}
+
+const char *led_format_name(led_pixel_format_t format) {
+    switch (format) {
+        case LED_FORMAT_GRB32:
+            return "grb32";
+        case LED_FORMAT_GRB24:
+            return "grb24";
+        case LED_FORMAT_RGBW32:
+            return "rgbw32";
+        case LED_FORMAT_RGB565:
+            return "rgb565";
+        case LED_FORMAT_PAL8:
+            return "pal8";
+        case LED_FORMAT_RGBW64:
+            return "rgbw64";
+        default:
+            return "unknown";
+    }
+}
+
+size_t led_strip_get_memory(const led_strip_t *strip) {
+    size_t total;
+
+    if (strip == NULL) {
+        return 0;
+    }
+    total = sizeof(led_strip_t) + (strip->palette != NULL ? sizeof(led_palette_t) : 0);
+    for (int i = 0; i < LED_MAX_BUFFERS; i++) {
+        if (strip->buffers[i] != NULL) {
+            total += strip->num_pixels * strip->ops->bytes_per_pixel;
+        }
+        if (strip->outputs[i] != NULL) {
+            total += strip->num_pixels * sizeof(uint32_t);
+        }
+    }
+    if (strip->correction != NULL) {
+        total += sizeof(led_correction_t);
+    }
+    if (strip->dither_error != NULL) {
+        total += strip->num_pixels * sizeof(uint32_t);
+    }
+    return total;
+}
+
+const void *led_strip_get_data(const led_strip_t *strip) {
+    return strip != NULL ? strip->buffer : NULL;
+}
+
+void led_strip_unpack_pixels(const led_strip_t *strip, const void *data, size_t start,
+                             uint32_t *out, size_t count) {
+    count = clip_range(strip, start, count);
+    if (count == 0 || out == NULL) {
+        return;
+    }
+    // frame->data of a dithered frame is an 8-bit output, not the strip's format
+    for (int i = 0; data != NULL && i < LED_MAX_BUFFERS; i++) {
+        if (data == strip->outputs[i]) {
+            memcpy(out, strip->outputs[i] + start, count * sizeof(uint32_t));
+            return;
+        }
+    }
+    strip->ops->unpack(data != NULL ? data : strip->buffer, start, out, count, strip->palette);
+}
+
+void led_strip_set_pixel_rgbw(led_strip_t *strip, size_t index,
+                              uint8_t r, uint8_t g, uint8_t b, uint8_t w) {
+    if (!is_valid_index(strip, index)) {
+        return;
+    }
+    uint32_t color = ((uint32_t)w << 24) | pack_color(r, g, b);
+    if (strip->ops->store(strip->buffer, index, color, strip->palette)) {
+        mark_dirty(strip, index, 1);
+    }
+}
+
+int led_strip_set_palette(led_strip_t *strip, const uint32_t *colors, size_t count) {
+    if (strip == NULL || strip->palette == NULL || colors == NULL ||
+        count == 0 || count > LED_PALETTE_SIZE) {
+        return -1;
+    }
+    led_palette_build(strip->palette, colors, count);
+    mark_dirty(strip, 0, strip->num_pixels);
+    return 0;
+}
+
+void led_strip_set_pixel_index(led_strip_t *strip, size_t index, uint8_t palette_index) {
+    if (!is_valid_index(strip, index) || strip->palette == NULL ||
+        palette_index >= strip->palette->count) {
+        return;
+    }
+    if (strip->buffer[index] != palette_index) {
+        strip->buffer[index] = palette_index;
+        mark_dirty(strip, index, 1);
+    }
+}
+
+/* ======================== Default instance ======================== */
+
+int led_init(size_t num_pixels) {
+    // Check if already initialized
+    if (default_strip != NULL) {
+        fprintf(stderr, "Warning: LED driver already initialized. "
+                       "Call led_shutdown() first.\n");
+        return -1;
+    }
+
+    default_strip = led_strip_create(num_pixels);
+    if (default_strip == NULL) {
+        return -1;
+    }
+
+    printf("LED driver initialized: %zu pixels\n", num_pixels);
+    return 0;
+}
+
+void led_shutdown(void) {
+    if (default_strip == NULL) {
+        return;
+    }
+
+    led_strip_destroy(default_strip);
+    default_strip = NULL;
+
+    printf("LED driver shut down\n");
+}
+
+led_strip_t *led_get_default_strip(void) {
+    return default_strip;
+}
+
+void led_set_pixel_color(size_t index, uint8_t r, uint8_t g, uint8_t b) {
+    led_strip_set_pixel_color(default_strip, index, r, g, b);
+}
+
+void led_fill(uint8_t r, uint8_t g, uint8_t b) {
+    led_strip_fill(default_strip, r, g, b);
+}
+
+void led_clear(void) {
+    led_strip_clear(default_strip);
+}
+
+const uint32_t* led_get_buffer(void) {
+    return led_strip_get_buffer(default_strip);
+}
+
+size_t led_get_pixel_count(void) {
+    return led_strip_get_pixel_count(default_strip);
+}
+
+uint32_t led_get_pixel(size_t index) {
+    return led_strip_get_pixel(default_strip, index);
+}
+
+void led_fill_range(size_t start, size_t count, uint8_t r, uint8_t g, uint8_t b) {
+    led_strip_fill_range(default_strip, start, count, r, g, b);
+}
+
+void led_copy_range(size_t start, const uint32_t *src, size_t count) {
+    led_strip_copy_range(default_strip, start, src, count);
+}
+
+void led_scale_range(size_t start, size_t count,
+                     uint8_t scale_r, uint8_t scale_g, uint8_t scale_b) {
+    led_strip_scale_range(default_strip, start, count, scale_r, scale_g, scale_b);
+}
+
+void led_blend_range(size_t start, const uint32_t *src, size_t count, uint8_t alpha) {
+    led_strip_blend_range(default_strip, start, src, count, alpha);
+}
+
+void led_apply_lut(size_t start, size_t count, const uint8_t lut[256]) {
+    led_strip_apply_lut(default_strip, start, count, lut);
+}
+
+void led_pack_planar(size_t start, const uint8_t *r, const uint8_t *g,
+                     const uint8_t *b, size_t count) {
+    led_strip_pack_planar(default_strip, start, r, g, b, count);
+}
+
+int led_commit(led_frame_t *frame) {
+    return led_strip_commit(default_strip, frame);
+}
+
+void led_mark_all_dirty(void) {
+    led_strip_mark_all_dirty(default_strip);
+}
+
+size_t led_get_dirty_count(void) {
+    return led_strip_get_dirty_count(default_strip);
+}
+
+int led_set_buffering(led_buffering_t mode) {
+    return led_strip_set_buffering(default_strip, mode);
+}
+
+int led_present(void) {
+    return led_strip_present(default_strip);
+}
+
+const led_frame_t *led_acquire_frame(void) {
+    return led_strip_acquire_frame(default_strip);
+}
+
+void led_release_frame(void) {
+    led_strip_release_frame(default_strip);
+}
+
+void led_set_pixel_hsv(size_t index, uint16_t hue, uint8_t sat, uint8_t val) {
+    led_strip_set_pixel_hsv(default_strip, index, hue, sat, val);
+}
+
+int led_set_correction(const led_correction_config_t *config) {
+    return led_strip_set_correction(default_strip, config);
+}
+
+int led_set_brightness(uint8_t brightness) {
+    return led_strip_set_brightness(default_strip, brightness);
+}
+
+void led_print_buffer(void) {
+    led_strip_print_buffer(default_strip);
+}
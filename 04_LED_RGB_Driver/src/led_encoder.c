@@ -0,0 +1,376 @@
+/**
+ * @file led_encoder.c
+ * @brief WS2812B waveform encoder and reference decoder
+ *
+ * The bit-level work is done by the encode kernels in led_simd.c (table
+ * driven scalar code, pshufb lookups on AVX2); this file derives the
+ * waveform from the configuration, adds the latch padding, splits frames
+ * into chunks and decodes buffers back for validation.
+ */
+
+#include "led_encoder.h"
+#include "led_simd.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LED_BIT_NS          1250    // Nominal LED bit period (800 kHz)
+#define LED_T0H_NS          400     // Nominal high time of a 0 bit
+#define LED_T1H_NS          800     // Nominal high time of a 1 bit
+#define LED_DEFAULT_RESET_US 300
+
+const led_timing_t LED_TIMING_WS2812B = {
+    .t0h_min = 250, .t0h_max = 550,
+    .t0l_min = 700, .t0l_max = 1000,
+    .t1h_min = 650, .t1h_max = 950,
+    .t1l_min = 300, .t1l_max = 600,
+    .reset_min = 280000
+};
+
+static uint32_t ticks_to_ns(uint64_t ticks, uint32_t clock_hz) {
+    return (uint32_t)((ticks * 1000000000ULL + clock_hz / 2) / clock_hz);
+}
+
+static uint64_t ns_to_ticks(uint64_t ns, uint32_t clock_hz) {
+    return (ns * clock_hz + 500000000ULL) / 1000000000ULL;
+}
+
+static int in_range(uint32_t value, uint32_t min, uint32_t max) {
+    return value >= min && value <= max;
+}
+
+/* ======================== Configuration ======================== */
+
+int led_encoder_init(led_encoder_t *encoder, const led_encoder_config_t *config) {
+    if (encoder == NULL || config == NULL || config->clock_hz == 0) {
+        fprintf(stderr, "Error: Invalid encoder configuration\n");
+        return -1;
+    }
+
+    const led_timing_t *timing = config->timing ? config->timing : &LED_TIMING_WS2812B;
+    uint32_t reset_us = config->reset_us ? config->reset_us : LED_DEFAULT_RESET_US;
+    uint64_t t0h, t0l, t1h, t1l;       // Pulse widths in clock ticks
+
+    memset(encoder, 0, sizeof(led_encoder_t));
+    encoder->encoding = config->encoding;
+    encoder->clock_hz = config->clock_hz;
+
+    switch (config->encoding) {
+        case LED_ENCODE_SPI_3BIT:
+            t0h = 1; t0l = 2; t1h = 2; t1l = 1;
+            encoder->bytes_per_pixel = 9;
+            break;
+        case LED_ENCODE_SPI_4BIT:
+            t0h = 1; t0l = 3; t1h = 3; t1l = 1;
+            encoder->bytes_per_pixel = 12;
+            break;
+        case LED_ENCODE_PWM: {
+            uint64_t period = ns_to_ticks(LED_BIT_NS, config->clock_hz);
+            if (period < 3 || period > UINT16_MAX) {
+                fprintf(stderr, "Error: %u Hz timer gives a PWM period of %llu ticks\n",
+                        config->clock_hz, (unsigned long long)period);
+                return -1;
+            }
+            t0h = ns_to_ticks(LED_T0H_NS, config->clock_hz);
+            t1h = ns_to_ticks(LED_T1H_NS, config->clock_hz);
+            t0l = period - t0h;
+            t1l = period - t1h;
+            encoder->pwm_period = (uint16_t)period;
+            encoder->pwm_t0h = (uint16_t)t0h;
+            encoder->pwm_t1h = (uint16_t)t1h;
+            encoder->bytes_per_pixel = 24 * sizeof(uint16_t);
+            break;
+        }
+        default:
+            fprintf(stderr, "Error: Unknown encoding %d\n", (int)config->encoding);
+            return -1;
+    }
+
+    encoder->t0h_ns = ticks_to_ns(t0h, config->clock_hz);
+    encoder->t0l_ns = ticks_to_ns(t0l, config->clock_hz);
+    encoder->t1h_ns = ticks_to_ns(t1h, config->clock_hz);
+    encoder->t1l_ns = ticks_to_ns(t1l, config->clock_hz);
+
+    if (!in_range(encoder->t0h_ns, timing->t0h_min, timing->t0h_max) ||
+        !in_range(encoder->t0l_ns, timing->t0l_min, timing->t0l_max) ||
+        !in_range(encoder->t1h_ns, timing->t1h_min, timing->t1h_max) ||
+        !in_range(encoder->t1l_ns, timing->t1l_min, timing->t1l_max)) {
+        fprintf(stderr, "Error: %u Hz gives T0H/T0L/T1H/T1L = %u/%u/%u/%u ns, "
+                "outside the timing limits\n", config->clock_hz,
+                encoder->t0h_ns, encoder->t0l_ns, encoder->t1h_ns, encoder->t1l_ns);
+        return -1;
+    }
+    if ((uint64_t)reset_us * 1000 < timing->reset_min) {
+        fprintf(stderr, "Error: Reset of %u us is shorter than %u us\n",
+                reset_us, (timing->reset_min + 999) / 1000);
+        return -1;
+    }
+
+    // Latch: whole zero bytes (SPI) or whole 0% duty slots (PWM) covering reset_us
+    uint64_t reset_ticks = ((uint64_t)reset_us * config->clock_hz + 999999) / 1000000;
+    if (config->encoding == LED_ENCODE_PWM) {
+        uint64_t slots = (reset_ticks + encoder->pwm_period - 1) / encoder->pwm_period;
+        encoder->reset_bytes = (size_t)slots * sizeof(uint16_t);
+    } else {
+        encoder->reset_bytes = (size_t)((reset_ticks + 7) / 8);
+    }
+    return 0;
+}
+
+size_t led_encoded_size(const led_encoder_t *encoder, size_t num_pixels) {
+    if (encoder == NULL) {
+        return 0;
+    }
+    return num_pixels * encoder->bytes_per_pixel + encoder->reset_bytes;
+}
+
+/* ======================== Encoding ======================== */
+
+/**
+ * @brief Encode pixels with the active SIMD kernels (no latch padding)
+ */
+static void encode_pixels(const led_encoder_t *encoder, uint8_t *out,
+                          const uint32_t *pixels, size_t count) {
+    const led_kernels_t *kernels = led_simd_kernels();
+
+    switch (encoder->encoding) {
+        case LED_ENCODE_SPI_3BIT:
+            kernels->encode_spi3(out, pixels, count);
+            break;
+        case LED_ENCODE_SPI_4BIT:
+            kernels->encode_spi4(out, pixels, count);
+            break;
+        case LED_ENCODE_PWM:
+            if ((uintptr_t)out % _Alignof(uint16_t) == 0) {
+                kernels->encode_pwm((uint16_t *)out, pixels, count,
+                                    encoder->pwm_t0h, encoder->pwm_t1h);
+                break;
+            }
+            // Odd chunk boundary: encode through an aligned bounce buffer
+            for (size_t done = 0; done < count; ) {
+                uint16_t bounce[24 * 64];
+                size_t n = count - done < 64 ? count - done : 64;
+                kernels->encode_pwm(bounce, pixels + done, n,
+                                    encoder->pwm_t0h, encoder->pwm_t1h);
+                memcpy(out + done * encoder->bytes_per_pixel, bounce, n * encoder->bytes_per_pixel);
+                done += n;
+            }
+            break;
+    }
+}
+
+size_t led_encode(const led_encoder_t *encoder, const uint32_t *pixels,
+                  size_t num_pixels, void *out, size_t capacity) {
+    size_t total = led_encoded_size(encoder, num_pixels);
+
+    if (encoder == NULL || out == NULL || (pixels == NULL && num_pixels > 0) ||
+        capacity < total) {
+        return 0;
+    }
+
+    uint8_t *dst = (uint8_t *)out;
+    encode_pixels(encoder, dst, pixels, num_pixels);
+    memset(dst + num_pixels * encoder->bytes_per_pixel, 0, encoder->reset_bytes);
+    return total;
+}
+
+void led_encode_stream_begin(led_encode_stream_t *stream, const led_encoder_t *encoder,
+                             const uint32_t *pixels, size_t num_pixels) {
+    if (stream == NULL) {
+        return;
+    }
+    memset(stream, 0, sizeof(led_encode_stream_t));
+    stream->encoder = encoder;
+    stream->pixels = pixels;
+    stream->num_pixels = pixels ? num_pixels : 0;
+    stream->reset_left = encoder ? encoder->reset_bytes : 0;
+}
+
+size_t led_encode_stream_next(led_encode_stream_t *stream, void *out, size_t capacity) {
+    if (stream == NULL || stream->encoder == NULL || out == NULL) {
+        return 0;
+    }
+
+    const led_encoder_t *encoder = stream->encoder;
+    size_t bpp = encoder->bytes_per_pixel;
+    uint8_t *dst = (uint8_t *)out;
+    uint8_t *partial = (uint8_t *)stream->partial;
+    size_t written = 0;
+
+    // 1. Rest of the pixel split by the previous chunk
+    if (stream->partial_pos < stream->partial_len) {
+        size_t n = stream->partial_len - stream->partial_pos;
+        if (n > capacity) {
+            n = capacity;
+        }
+        memcpy(dst, partial + stream->partial_pos, n);
+        stream->partial_pos += n;
+        written += n;
+    }
+
+    // 2. Whole pixels straight into the output
+    size_t whole = (capacity - written) / bpp;
+    if (whole > stream->num_pixels - stream->next_pixel) {
+        whole = stream->num_pixels - stream->next_pixel;
+    }
+    if (whole > 0) {
+        encode_pixels(encoder, dst + written, stream->pixels + stream->next_pixel, whole);
+        stream->next_pixel += whole;
+        written += whole * bpp;
+    }
+
+    // 3. The chunk ends inside the next pixel: keep the remainder for later
+    if (written < capacity && stream->next_pixel < stream->num_pixels) {
+        size_t n = capacity - written;
+        encode_pixels(encoder, partial, stream->pixels + stream->next_pixel, 1);
+        stream->next_pixel++;
+        memcpy(dst + written, partial, n);
+        stream->partial_len = bpp;
+        stream->partial_pos = n;
+        written += n;
+    }
+
+    // 4. Latch padding after the last pixel
+    if (written < capacity && stream->next_pixel == stream->num_pixels &&
+        stream->partial_pos == stream->partial_len) {
+        size_t n = capacity - written;
+        if (n > stream->reset_left) {
+            n = stream->reset_left;
+        }
+        memset(dst + written, 0, n);
+        stream->reset_left -= n;
+        written += n;
+    }
+
+    return written;
+}
+
+/* ======================== Reference decoder ======================== */
+
+/**
+ * @brief Waveform decoder state: the line is fed as runs of clock ticks
+ */
+typedef struct {
+    const led_timing_t *timing;
+    uint32_t clock_hz;
+    int level;                     // Level of the current run
+    uint64_t run;                  // Length of the current run in ticks
+    uint32_t high_ns;              // High time of the bit being decoded
+    bool have_high;
+    bool done;                     // Reset seen after data
+    uint32_t value;                // Bits of the pixel being decoded
+    uint32_t *pixels;
+    size_t max_pixels;
+    size_t num_pixels;
+    led_decode_report_t report;
+} decoder_t;
+
+static void decode_bit(decoder_t *d, uint32_t high_ns, uint32_t low_ns, bool latch) {
+    const led_timing_t *t = d->timing;
+    int bit;
+
+    // The low time of the last bit runs into the reset, so only its high time counts
+    if (in_range(high_ns, t->t0h_min, t->t0h_max) &&
+        (latch || in_range(low_ns, t->t0l_min, t->t0l_max))) {
+        bit = 0;
+    } else if (in_range(high_ns, t->t1h_min, t->t1h_max) &&
+               (latch || in_range(low_ns, t->t1l_min, t->t1l_max))) {
+        bit = 1;
+    } else {
+        // Out of spec: decide like the LED would, by the high time alone
+        bit = high_ns > (t->t0h_max + t->t1h_min) / 2;
+        if (d->report.timing_errors == 0) {
+            d->report.first_error_bit = d->report.bits;
+        }
+        d->report.timing_errors++;
+    }
+
+    d->value = (d->value << 1) | (uint32_t)bit;
+    d->report.bits++;
+    if (d->report.bits % 24 == 0) {
+        if (d->pixels != NULL && d->num_pixels < d->max_pixels) {
+            d->pixels[d->num_pixels] = d->value & 0x00FFFFFF;
+        }
+        d->num_pixels++;
+        d->value = 0;
+    }
+}
+
+static void end_run(decoder_t *d) {
+    if (d->run == 0 || d->done) {
+        return;
+    }
+
+    uint32_t ns = ticks_to_ns(d->run, d->clock_hz);
+    if (d->level) {
+        d->high_ns = ns;
+        d->have_high = true;
+    } else if (d->have_high) {
+        bool latch = ns >= d->timing->reset_min;
+        decode_bit(d, d->high_ns, ns, latch);
+        d->have_high = false;
+        if (latch) {
+            d->report.latched = true;
+            d->done = true;
+        }
+    }
+    // A low run before the first high pulse is the idle line
+}
+
+static void feed(decoder_t *d, int level, uint64_t ticks) {
+    if (d->done || ticks == 0) {
+        return;
+    }
+    if (level != d->level) {
+        end_run(d);
+        d->level = level;
+        d->run = 0;
+    }
+    d->run += ticks;
+}
+
+int led_decode(const led_encoder_t *encoder, const void *data, size_t size,
+               const led_timing_t *timing, uint32_t *pixels, size_t max_pixels,
+               led_decode_report_t *report) {
+    if (encoder == NULL || encoder->clock_hz == 0 || (data == NULL && size > 0)) {
+        return -1;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    decoder_t d;
+
+    memset(&d, 0, sizeof(d));
+    d.timing = timing ? timing : &LED_TIMING_WS2812B;
+    d.clock_hz = encoder->clock_hz;
+    d.pixels = pixels;
+    d.max_pixels = max_pixels;
+    d.report.first_error_bit = SIZE_MAX;
+
+    if (encoder->encoding == LED_ENCODE_PWM) {
+        for (size_t i = 0; i + 1 < size && !d.done; i += 2) {
+            uint16_t duty;
+            memcpy(&duty, bytes + i, sizeof(duty));
+            if (duty > encoder->pwm_period) {
+                duty = encoder->pwm_period;
+            }
+            feed(&d, 1, duty);
+            feed(&d, 0, (uint64_t)encoder->pwm_period - duty);
+        }
+    } else {
+        for (size_t i = 0; i < size && !d.done; i++) {
+            for (int b = 7; b >= 0; b--) {
+                feed(&d, (bytes[i] >> b) & 1, 1);
+            }
+        }
+    }
+
+    // Buffer ended before a full reset: flush the last pulse
+    end_run(&d);
+    if (d.have_high && !d.done) {
+        decode_bit(&d, d.high_ns, 0, false);
+    }
+
+    if (report != NULL) {
+        *report = d.report;
+    }
+    return (int)d.num_pixels;
+}
@@ -0,0 +1,499 @@
+/**
+ * @file led_format.c
+ * @brief Per-format pixel access and bulk operations
+ *
+ * GRB32 forwards to the SIMD kernels. The compact formats are built from a
+ * pair of codec functions (<name>_encode / <name>_decode) expanded into
+ * specialized loops by LED_FORMAT_ACCESS and LED_FORMAT_TRANSFORM: each
+ * loop decodes to 0xWWGGRRBB, applies the same channel math as the scalar
+ * kernels and encodes back, with the codec inlined.
+ *
+ * RGBW64 has hand-written loops instead: its scale, blend and LUT work on
+ * the 16-bit channels rather than a decoded 8-bit copy.
+ */
+
+#include "led_format.h"
+#include "led_simd.h"
+#include <string.h>
+
+/* ======================== Channel math on 0xWWGGRRBB ======================== */
+
+static inline uint32_t channel(uint32_t color, int shift) {
+    return (color >> shift) & 0xFF;
+}
+
+static inline uint32_t pack_wgrb(uint32_t w, uint32_t g, uint32_t r, uint32_t b) {
+    return (w << 24) | (g << 16) | (r << 8) | b;
+}
+
+/**
+ * @brief c * (s + 1) >> 8 per channel; white follows the smallest factor
+ */
+static inline uint32_t scale_color(uint32_t c, uint8_t sr, uint8_t sg, uint8_t sb) {
+    uint8_t sw = sr < sg ? sr : sg;
+    sw = sw < sb ? sw : sb;
+    return pack_wgrb((channel(c, 24) * (sw + 1u)) >> 8, (channel(c, 16) * (sg + 1u)) >> 8,
+                     (channel(c, 8) * (sr + 1u)) >> 8, (channel(c, 0) * (sb + 1u)) >> 8);
+}
+
+static inline uint32_t blend_color(uint32_t d, uint32_t s, uint32_t w) {
+    uint32_t iw = 256 - w;
+    return pack_wgrb((channel(s, 24) * w + channel(d, 24) * iw) >> 8,
+                     (channel(s, 16) * w + channel(d, 16) * iw) >> 8,
+                     (channel(s, 8) * w + channel(d, 8) * iw) >> 8,
+                     (channel(s, 0) * w + channel(d, 0) * iw) >> 8);
+}
+
+static inline uint32_t lut_color(uint32_t c, const uint8_t lut[256]) {
+    return pack_wgrb(lut[channel(c, 24)], lut[channel(c, 16)],
+                     lut[channel(c, 8)], lut[channel(c, 0)]);
+}
+
+/* ======================== GRB32: SIMD kernels ======================== */
+
+static bool grb32_store(void *data, size_t index, uint32_t color, const led_palette_t *pal) {
+    uint32_t *px = (uint32_t *)data + index;
+    (void)pal;
+    color &= 0x00FFFFFF;
+    if (*px == color) {
+        return false;
+    }
+    *px = color;
+    return true;
+}
+
+static uint32_t grb32_load(const void *data, size_t index, const led_palette_t *pal) {
+    (void)pal;
+    return ((const uint32_t *)data)[index];
+}
+
+static void grb32_fill(void *data, size_t start, size_t count, uint32_t color,
+                       const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->fill((uint32_t *)data + start, color & 0x00FFFFFF, count);
+}
+
+static void grb32_copy(void *data, size_t start, const uint32_t *src, size_t count,
+                       const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->copy((uint32_t *)data + start, src, count);
+}
+
+static void grb32_scale(void *data, size_t start, size_t count,
+                        uint8_t sr, uint8_t sg, uint8_t sb, const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->scale((uint32_t *)data + start, count, sr, sg, sb);
+}
+
+static void grb32_blend(void *data, size_t start, const uint32_t *src, size_t count,
+                        uint8_t alpha, const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->blend((uint32_t *)data + start, src, count, alpha);
+}
+
+static void grb32_apply_lut(void *data, size_t start, size_t count, const uint8_t lut[256],
+                            const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->apply_lut((uint32_t *)data + start, count, lut);
+}
+
+static void grb32_pack_planar(void *data, size_t start, const uint8_t *r, const uint8_t *g,
+                              const uint8_t *b, size_t count, const led_palette_t *pal) {
+    (void)pal;
+    led_simd_kernels()->pack_planar((uint32_t *)data + start, r, g, b, count);
+}
+
+static void grb32_unpack(const void *data, size_t start, uint32_t *out, size_t count,
+                         const led_palette_t *pal) {
+    (void)pal;
+    memcpy(out, (const uint32_t *)data + start, count * sizeof(uint32_t));
+}
+
+/* ======================== Codecs ======================== */
+
+typedef struct {
+    uint8_t g, r, b;
+} grb24_t;
+
+static inline grb24_t grb24_encode(uint32_t c, const led_palette_t *pal) {
+    grb24_t v = { (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c };
+    (void)pal;
+    return v;
+}
+
+static inline uint32_t grb24_decode(grb24_t v, const led_palette_t *pal) {
+    (void)pal;
+    return pack_wgrb(0, v.g, v.r, v.b);
+}
+
+static inline uint32_t rgbw32_encode(uint32_t c, const led_palette_t *pal) {
+    (void)pal;
+    return c;
+}
+
+static inline uint32_t rgbw32_decode(uint32_t v, const led_palette_t *pal) {
+    (void)pal;
+    return v;
+}
+
+static inline uint16_t rgb565_encode(uint32_t c, const led_palette_t *pal) {
+    (void)pal;
+    return (uint16_t)(((channel(c, 8) >> 3) << 11) | ((channel(c, 16) >> 2) << 5) |
+                      (channel(c, 0) >> 3));
+}
+
+static inline uint32_t rgb565_decode(uint16_t v, const led_palette_t *pal) {
+    // Replicate the top bits so 0x1F / 0x3F expand to 0xFF
+    uint32_t r = v >> 11;
+    uint32_t g = (v >> 5) & 0x3F;
+    uint32_t b = v & 0x1F;
+    (void)pal;
+    return pack_wgrb(0, (g << 2) | (g >> 4), (r << 3) | (r >> 2), (b << 3) | (b >> 2));
+}
+
+static inline uint32_t rgb555_key(uint32_t c) {
+    return ((channel(c, 8) >> 3) << 10) | ((channel(c, 16) >> 3) << 5) | (channel(c, 0) >> 3);
+}
+
+static inline uint8_t pal8_encode(uint32_t c, const led_palette_t *pal) {
+    return pal->nearest[rgb555_key(c)];
+}
+
+static inline uint32_t pal8_decode(uint8_t v, const led_palette_t *pal) {
+    return pal->colors[v];
+}
+
+/* ======================== Specialized loops ======================== */
+
+/**
+ * @brief Access, fill, copy, blend, pack and unpack loops for one codec
+ */
+#define LED_FORMAT_ACCESS(name, type)                                                   \
+    static bool name##_store(void *data, size_t index, uint32_t color,                 \
+                             const led_palette_t *pal) {                               \
+        type *px = (type *)data + index;                                               \
+        type value = name##_encode(color, pal);                                        \
+        if (memcmp(px, &value, sizeof(type)) == 0) {                                   \
+            return false;                                                              \
+        }                                                                              \
+        *px = value;                                                                   \
+        return true;                                                                   \
+    }                                                                                  \
+                                                                                       \
+    static uint32_t name##_load(const void *data, size_t index,                        \
+                                const led_palette_t *pal) {                            \
+        return name##_decode(((const type *)data)[index], pal);                        \
+    }                                                                                  \
+                                                                                       \
+    static void name##_fill(void *data, size_t start, size_t count, uint32_t color,    \
+                            const led_palette_t *pal) {                                \
+        type *px = (type *)data + start;                                               \
+        type value = name##_encode(color, pal);                                        \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = value;                                                             \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_copy(void *data, size_t start, const uint32_t *src,             \
+                            size_t count, const led_palette_t *pal) {                  \
+        type *px = (type *)data + start;                                               \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = name##_encode(src[i], pal);                                        \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_blend(void *data, size_t start, const uint32_t *src,            \
+                             size_t count, uint8_t alpha, const led_palette_t *pal) {  \
+        type *px = (type *)data + start;                                               \
+        uint32_t w = led_blend_weight(alpha);                                          \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = name##_encode(blend_color(name##_decode(px[i], pal), src[i], w),   \
+                                  pal);                                                \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_pack_planar(void *data, size_t start, const uint8_t *r,         \
+                                   const uint8_t *g, const uint8_t *b, size_t count,   \
+                                   const led_palette_t *pal) {                         \
+        type *px = (type *)data + start;                                               \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = name##_encode(pack_wgrb(0, g[i], r[i], b[i]), pal);                \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_unpack(const void *data, size_t start, uint32_t *out,           \
+                              size_t count, const led_palette_t *pal) {                \
+        const type *px = (const type *)data + start;                                   \
+        for (size_t i = 0; i < count; i++) {                                           \
+            out[i] = name##_decode(px[i], pal);                                        \
+        }                                                                              \
+    }
+
+/**
+ * @brief Per-pixel scale and LUT loops for one codec
+ */
+#define LED_FORMAT_TRANSFORM(name, type)                                                \
+    static void name##_scale(void *data, size_t start, size_t count,                   \
+                             uint8_t sr, uint8_t sg, uint8_t sb,                       \
+                             const led_palette_t *pal) {                               \
+        type *px = (type *)data + start;                                               \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = name##_encode(scale_color(name##_decode(px[i], pal), sr, sg, sb),  \
+                                  pal);                                                \
+        }                                                                              \
+    }                                                                                  \
+                                                                                       \
+    static void name##_apply_lut(void *data, size_t start, size_t count,               \
+                                 const uint8_t lut[256], const led_palette_t *pal) {   \
+        type *px = (type *)data + start;                                               \
+        for (size_t i = 0; i < count; i++) {                                           \
+            px[i] = name##_encode(lut_color(name##_decode(px[i], pal), lut), pal);     \
+        }                                                                              \
+    }
+
+LED_FORMAT_ACCESS(grb24, grb24_t)
+LED_FORMAT_TRANSFORM(grb24, grb24_t)
+LED_FORMAT_ACCESS(rgbw32, uint32_t)
+LED_FORMAT_TRANSFORM(rgbw32, uint32_t)
+LED_FORMAT_ACCESS(rgb565, uint16_t)
+LED_FORMAT_TRANSFORM(rgb565, uint16_t)
+LED_FORMAT_ACCESS(pal8, uint8_t)
+
+/*
+ * PAL8 scale / LUT depend only on the palette entry, so they are computed
+ * once per entry and applied as a 256-byte index remap.
+ */
+static void pal8_scale(void *data, size_t start, size_t count,
+                       uint8_t sr, uint8_t sg, uint8_t sb, const led_palette_t *pal) {
+    uint8_t remap[LED_PALETTE_SIZE];
+    uint8_t *px = (uint8_t *)data + start;
+
+    for (size_t k = 0; k < LED_PALETTE_SIZE; k++) {
+        remap[k] = pal8_encode(scale_color(pal->colors[k], sr, sg, sb), pal);
+    }
+    for (size_t i = 0; i < count; i++) {
+        px[i] = remap[px[i]];
+    }
+}
+
+static void pal8_apply_lut(void *data, size_t start, size_t count, const uint8_t lut[256],
+                           const led_palette_t *pal) {
+    uint8_t remap[LED_PALETTE_SIZE];
+    uint8_t *px = (uint8_t *)data + start;
+
+    for (size_t k = 0; k < LED_PALETTE_SIZE; k++) {
+        remap[k] = pal8_encode(lut_color(pal->colors[k], lut), pal);
+    }
+    for (size_t i = 0; i < count; i++) {
+        px[i] = remap[px[i]];
+    }
+}
+
+/* ======================== RGBW64: 16 bits per channel ======================== */
+
+/*
+ * A 16-bit channel v is v / 257 of an 8-bit level. In 8.8 fixed point of
+ * levels that is v - (v >> 8) (0-65280, exact for v = byte * 257), and
+ * t + (t >> 8) converts back.
+ */
+static inline uint32_t channel16(uint64_t px, int lane) {
+    return (uint32_t)(px >> (16 * lane)) & 0xFFFF;
+}
+
+static inline uint32_t level_of(uint32_t v) {
+    return v - (v >> 8);
+}
+
+static inline uint32_t value_of(uint32_t t) {
+    return t + (t >> 8);
+}
+
+static inline uint64_t rgbw64_encode(uint32_t c) {
+    uint64_t px = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        px |= (uint64_t)(channel(c, 8 * lane) * 257) << (16 * lane);
+    }
+    return px;
+}
+
+static inline uint32_t rgbw64_decode(uint64_t px) {
+    return pack_wgrb(channel16(px, 3) >> 8, channel16(px, 2) >> 8,
+                     channel16(px, 1) >> 8, channel16(px, 0) >> 8);
+}
+
+static bool rgbw64_store(void *data, size_t index, uint32_t color, const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + index;
+    uint64_t value = rgbw64_encode(color);
+    (void)pal;
+    if (*px == value) {
+        return false;
+    }
+    *px = value;
+    return true;
+}
+
+static uint32_t rgbw64_load(const void *data, size_t index, const led_palette_t *pal) {
+    (void)pal;
+    return rgbw64_decode(((const uint64_t *)data)[index]);
+}
+
+static void rgbw64_fill(void *data, size_t start, size_t count, uint32_t color,
+                        const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    uint64_t value = rgbw64_encode(color);
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        px[i] = value;
+    }
+}
+
+static void rgbw64_copy(void *data, size_t start, const uint32_t *src, size_t count,
+                        const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        px[i] = rgbw64_encode(src[i]);
+    }
+}
+
+static void rgbw64_scale(void *data, size_t start, size_t count,
+                         uint8_t sr, uint8_t sg, uint8_t sb, const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    uint8_t sw = sr < sg ? sr : sg;
+    const uint32_t mul[4] = { sb + 1u, sr + 1u, sg + 1u, (sw < sb ? sw : sb) + 1u };
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t out = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            out |= (uint64_t)((channel16(px[i], lane) * mul[lane]) >> 8) << (16 * lane);
+        }
+        px[i] = out;
+    }
+}
+
+static void rgbw64_blend(void *data, size_t start, const uint32_t *src, size_t count,
+                         uint8_t alpha, const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    uint32_t w = led_blend_weight(alpha);
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        uint64_t out = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            uint32_t s = channel(src[i], 8 * lane) * 257;
+            uint32_t d = channel16(px[i], lane);
+            out |= (uint64_t)((s * w + d * (256 - w)) >> 8) << (16 * lane);
+        }
+        px[i] = out;
+    }
+}
+
+static void rgbw64_apply_lut(void *data, size_t start, size_t count, const uint8_t lut[256],
+                             const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    (void)pal;
+    // Interpolate between the entries around the 8.8 level, so the curve
+    // stays smooth between the 256 points it is defined at
+    for (size_t i = 0; i < count; i++) {
+        uint64_t out = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            uint32_t t = level_of(channel16(px[i], lane));
+            uint32_t k = t >> 8;
+            int32_t lo = lut[k];
+            int32_t hi = lut[k < 255 ? k + 1 : 255];
+            uint32_t r = (uint32_t)(lo * 256 + (hi - lo) * (int32_t)(t & 0xFF));
+            out |= (uint64_t)value_of(r) << (16 * lane);
+        }
+        px[i] = out;
+    }
+}
+
+static void rgbw64_pack_planar(void *data, size_t start, const uint8_t *r, const uint8_t *g,
+                               const uint8_t *b, size_t count, const led_palette_t *pal) {
+    uint64_t *px = (uint64_t *)data + start;
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        px[i] = rgbw64_encode(pack_wgrb(0, g[i], r[i], b[i]));
+    }
+}
+
+static void rgbw64_unpack(const void *data, size_t start, uint32_t *out, size_t count,
+                          const led_palette_t *pal) {
+    const uint64_t *px = (const uint64_t *)data + start;
+    (void)pal;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = rgbw64_decode(px[i]);
+    }
+}
+
+#define LED_FORMAT_TABLE(name, fmt, bpp) {                                              \
+    .format = fmt,                                                                     \
+    .bytes_per_pixel = bpp,                                                            \
+    .store = name##_store,                                                             \
+    .load = name##_load,                                                               \
+    .fill = name##_fill,                                                               \
+    .copy = name##_copy,                                                               \
+    .scale = name##_scale,                                                             \
+    .blend = name##_blend,                                                             \
+    .apply_lut = name##_apply_lut,                                                     \
+    .pack_planar = name##_pack_planar,                                                 \
+    .unpack = name##_unpack                                                            \
+}
+
+static const led_format_ops_t format_ops[] = {
+    LED_FORMAT_TABLE(grb32, LED_FORMAT_GRB32, sizeof(uint32_t)),
+    LED_FORMAT_TABLE(grb24, LED_FORMAT_GRB24, sizeof(grb24_t)),
+    LED_FORMAT_TABLE(rgbw32, LED_FORMAT_RGBW32, sizeof(uint32_t)),
+    LED_FORMAT_TABLE(rgb565, LED_FORMAT_RGB565, sizeof(uint16_t)),
+    LED_FORMAT_TABLE(pal8, LED_FORMAT_PAL8, sizeof(uint8_t)),
+    LED_FORMAT_TABLE(rgbw64, LED_FORMAT_RGBW64, sizeof(uint64_t))
+};
+
+const led_format_ops_t *led_format_ops(led_pixel_format_t format) {
+    if (format < LED_FORMAT_GRB32 || format > LED_FORMAT_RGBW64) {
+        return NULL;
+    }
+    return &format_ops[format];
+}
+
+/* ======================== Palettes ======================== */
+
+void led_palette_build(led_palette_t *pal, const uint32_t *colors, size_t count) {
+    memset(pal->colors, 0, sizeof(pal->colors));
+    for (size_t k = 0; k < count; k++) {
+        pal->colors[k] = colors[k] & 0x00FFFFFF;
+    }
+    pal->count = count;
+
+    // Brute force over the 32K RGB555 cells: 8M distance checks, done once per palette
+    for (uint32_t key = 0; key < (1u << 15); key++) {
+        int r = (int)(((key >> 10) << 3) | (key >> 12));
+        int g = (int)((((key >> 5) & 0x1F) << 3) | ((key >> 7) & 7));
+        int b = (int)(((key & 0x1F) << 3) | ((key >> 2) & 7));
+        uint32_t best_dist = UINT32_MAX;
+        uint8_t best = 0;
+
+        for (size_t k = 0; k < count; k++) {
+            int dr = r - (int)channel(pal->colors[k], 8);
+            int dg = g - (int)channel(pal->colors[k], 16);
+            int db = b - (int)channel(pal->colors[k], 0);
+            uint32_t dist = (uint32_t)(dr * dr + dg * dg + db * db);
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = (uint8_t)k;
+            }
+        }
+        pal->nearest[key] = best;
+    }
+}
+
+void led_palette_default(led_palette_t *pal) {
+    uint32_t colors[LED_PALETTE_SIZE];
+
+    for (uint32_t i = 0; i < LED_PALETTE_SIZE; i++) {
+        uint32_t r = (i >> 5) * 255 / 7;
+        uint32_t g = ((i >> 2) & 7) * 255 / 7;
+        uint32_t b = (i & 3) * 255 / 3;
+        colors[i] = pack_wgrb(0, g, r, b);
+    }
+    led_palette_build(pal, colors, LED_PALETTE_SIZE);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file led_format.h
+ * @brief Internal per-format pixel access (GRB32, GRB24, RGBW32, RGB565, PAL8, RGBW64)
+ *
+ * Private to the driver. Each storage format has one table of functions;
+ * a strip picks its table at creation, so the loops below never branch on
+ * the format per pixel. Colors cross this interface as 0xWWGGRRBB words
+ * (W is 0 for every format except RGBW32 and RGBW64). No bounds checking is
+ * done here.
+ */
+
+#ifndef LED_FORMAT_H
+#define LED_FORMAT_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+#define LED_PALETTE_SIZE 256
+
+/**
+ * @brief Palette of a PAL8 strip
+ */
+typedef struct {
+    uint32_t colors[LED_PALETTE_SIZE];  // 0x00GGRRBB
+    size_t count;                       // Valid entries in colors[]
+    uint8_t nearest[1 << 15];           // RGB555 -> index of the closest color
+} led_palette_t;
+
+/**
+ * @brief Pixel operations for one storage format
+ *
+ * data points at pixel 0 of a buffer; start / index are pixel indices.
+ * pal is only used by PAL8 and may be NULL for the other formats.
+ */
+typedef struct {
+    led_pixel_format_t format;
+    size_t bytes_per_pixel;
+    bool (*store)(void *data, size_t index, uint32_t color,
+                  const led_palette_t *pal);                 // true if the pixel changed
+    uint32_t (*load)(const void *data, size_t index, const led_palette_t *pal);
+    void (*fill)(void *data, size_t start, size_t count, uint32_t color,
+                 const led_palette_t *pal);
+    void (*copy)(void *data, size_t start, const uint32_t *src, size_t count,
+                 const led_palette_t *pal);
+    void (*scale)(void *data, size_t start, size_t count,
+                  uint8_t sr, uint8_t sg, uint8_t sb, const led_palette_t *pal);
+    void (*blend)(void *data, size_t start, const uint32_t *src, size_t count,
+                  uint8_t alpha, const led_palette_t *pal);
+    void (*apply_lut)(void *data, size_t start, size_t count, const uint8_t lut[256],
+                      const led_palette_t *pal);
+    void (*pack_planar)(void *data, size_t start, const uint8_t *r, const uint8_t *g,
+                        const uint8_t *b, size_t count, const led_palette_t *pal);
+    void (*unpack)(const void *data, size_t start, uint32_t *out, size_t count,
+                   const led_palette_t *pal);
+} led_format_ops_t;
+
+/**
+ * @brief Get the operations of a format (NULL for unknown formats)
+ */
+const led_format_ops_t *led_format_ops(led_pixel_format_t format);
+
+/**
+ * @brief Load colors into a palette and rebuild its nearest-color table
+ *
+ * @param pal Palette to fill
+ * @param colors 0x00GGRRBB colors
+ * @param count 1 to LED_PALETTE_SIZE
+ */
+void led_palette_build(led_palette_t *pal, const uint32_t *colors, size_t count);
+
+/**
+ * @brief Load the default 3-3-2 palette (8 reds x 8 greens x 4 blues)
+ */
+void led_palette_default(led_palette_t *pal);
+
+#endif // LED_FORMAT_H
@@ -0,0 +1,177 @@
+/**
+ * @file led_inspect.c
+ * @brief Command-line viewer for .ledrec recordings
+ *
+ * led_inspect FILE              Summary: size, frames, duration, compression
+ * led_inspect -l FILE           One line per frame: time, type, bytes, changed pixels
+ * led_inspect -d N FILE         Pixels of frame N
+ * led_inspect -c OTHER FILE     Compare two recordings frame by frame (exit 1 if they differ)
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "led_record.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-l] [-d FRAME] [-c OTHER] FILE\n", prog);
+    fprintf(stderr, "  -l        list every frame\n");
+    fprintf(stderr, "  -d FRAME  print the pixels of one frame\n");
+    fprintf(stderr, "  -c OTHER  compare with another recording (exit 1 on difference)\n");
+}
+
+static void print_summary(const char *path, const led_record_info_t *info) {
+    printf("File:          %s\n", path);
+    printf("Pixels:        %zu (%s)\n", info->num_pixels, led_format_name(info->format));
+    printf("Frames:        %zu (%zu key, every %zu)\n", info->frames, info->keyframes,
+           info->keyframe_interval);
+    printf("Duration:      %.3f s", info->duration_ms / 1000.0);
+    if (info->frames > 1 && info->duration_ms > 0) {
+        printf(" (%.1f fps)", (info->frames - 1) * 1000.0 / info->duration_ms);
+    }
+    printf("\n");
+    printf("Size:          %llu bytes (%.1f bytes/frame)\n", (unsigned long long)info->file_bytes,
+           info->frames ? (double)info->file_bytes / info->frames : 0.0);
+    printf("Uncompressed:  %llu bytes (ratio %.1f:1)\n", (unsigned long long)info->raw_bytes,
+           info->file_bytes ? (double)info->raw_bytes / info->file_bytes : 0.0);
+}
+
+static int list_frames(led_replay_t *replay, const led_record_info_t *info) {
+    led_record_frame_info_t frame;
+
+    printf("%8s %10s %6s %10s %10s\n", "frame", "time ms", "type", "bytes", "changed");
+    for (size_t i = 0; i < info->frames; i++) {
+        if (led_replay_get_frame_info(replay, i, &frame) != 0) {
+            fprintf(stderr, "Error: Frame %zu is corrupt\n", i);
+            return -1;
+        }
+        printf("%8zu %10u %6s %10zu %10zu\n", i, frame.time_ms,
+               frame.type == LED_RECORD_KEY ? "key" : "delta", frame.payload_bytes,
+               frame.changed_pixels);
+    }
+    return 0;
+}
+
+static int dump_frame(led_replay_t *replay, const led_record_info_t *info, size_t index) {
+    const uint32_t *pixels = led_replay_frame(replay, index);
+    if (pixels == NULL) {
+        fprintf(stderr, "Error: Frame %zu not available (%zu frames)\n", index, info->frames);
+        return -1;
+    }
+    for (size_t i = 0; i < info->num_pixels; i++) {
+        uint32_t c = pixels[i];
+        printf("[%zu] 0x%08X (R:%3u G:%3u B:%3u)\n", i, c, (c >> 8) & 0xFF, (c >> 16) & 0xFF,
+               c & 0xFF);
+    }
+    return 0;
+}
+
+/**
+ * @brief Report the first difference between two recordings
+ *
+ * @return int 0 if identical, 1 if they differ, -1 on error
+ */
+static int compare(led_replay_t *a, led_replay_t *b) {
+    led_record_info_t ia, ib;
+    led_replay_get_info(a, &ia);
+    led_replay_get_info(b, &ib);
+
+    if (ia.num_pixels != ib.num_pixels) {
+        printf("Pixel counts differ: %zu vs %zu\n", ia.num_pixels, ib.num_pixels);
+        return 1;
+    }
+    size_t frames = ia.frames < ib.frames ? ia.frames : ib.frames;
+    for (size_t f = 0; f < frames; f++) {
+        led_record_frame_info_t fa, fb;
+        led_replay_get_frame_info(a, f, &fa);
+        led_replay_get_frame_info(b, f, &fb);
+        if (fa.time_ms != fb.time_ms) {
+            printf("Frame %zu: time %u ms vs %u ms\n", f, fa.time_ms, fb.time_ms);
+            return 1;
+        }
+
+        const uint32_t *pa = led_replay_frame(a, f);
+        const uint32_t *pb = led_replay_frame(b, f);
+        if (pa == NULL || pb == NULL) {
+            fprintf(stderr, "Error: Frame %zu is corrupt\n", f);
+            return -1;
+        }
+        for (size_t i = 0; i < ia.num_pixels; i++) {
+            if (pa[i] != pb[i]) {
+                printf("Frame %zu (%u ms), pixel %zu: 0x%08X vs 0x%08X\n", f, fa.time_ms, i,
+                       pa[i], pb[i]);
+                return 1;
+            }
+        }
+    }
+    if (ia.frames != ib.frames) {
+        printf("Frame counts differ: %zu vs %zu (first %zu identical)\n", ia.frames, ib.frames,
+               frames);
+        return 1;
+    }
+    printf("Identical: %zu frames\n", frames);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool list = false;
+    long dump = -1;
+    const char *other = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ld:c:h")) != -1) {
+        switch (opt) {
+            case 'l':
+                list = true;
+                break;
+            case 'd': {
+                char *end;
+                dump = strtol(optarg, &end, 10);
+                if (*end != '\0' || dump < 0) {
+                    fprintf(stderr, "Error: Invalid frame number '%s'\n", optarg);
+                    return 2;
+                }
+                break;
+            }
+            case 'c':
+                other = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : 2;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const char *path = argv[optind];
+    led_replay_t *replay = led_replay_open(path);
+    if (replay == NULL) {
+        return 2;
+    }
+    led_record_info_t info;
+    led_replay_get_info(replay, &info);
+
+    int result = 0;
+    if (other != NULL) {
+        led_replay_t *second = led_replay_open(other);
+        result = second ? compare(replay, second) : -1;
+        led_replay_close(second);
+    } else if (dump >= 0) {
+        result = dump_frame(replay, &info, (size_t)dump);
+    } else {
+        print_summary(path, &info);
+        if (list) {
+            printf("\n");
+            result = list_frames(replay, &info);
+        }
+    }
+
+    led_replay_close(replay);
+    return result < 0 ? 2 : result;
+}
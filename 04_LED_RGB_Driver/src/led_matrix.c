@@ -0,0 +1,310 @@
+/**
+ * @file led_matrix.c
+ * @brief Matrix index tables and the tiled render pool
+ *
+ * The pool keeps its workers parked on a condition variable between
+ * frames. A render publishes the job under the pool mutex and bumps a
+ * generation counter; workers (and the caller) then claim tiles with an
+ * atomic counter, so faster threads simply take more tiles. The last
+ * worker to run out of tiles wakes the caller.
+ */
+
+#include "led_matrix.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+struct led_matrix {
+    uint32_t width;
+    uint32_t height;
+    uint32_t *table;                   // Strip index of (x, y) at [y * width + x]
+    uint32_t *frame;                   // Render target of led_matrix_render_to()
+};
+
+/**
+ * @brief One frame of work shared by all threads of a render
+ */
+typedef struct {
+    const led_matrix_t *matrix;
+    led_shader_fn shader;
+    void *user;
+    uint32_t time_ms;
+    uint32_t *out;
+    uint32_t tiles_x;
+    size_t num_tiles;
+    atomic_size_t next_tile;
+} render_job_t;
+
+struct led_render_pool {
+    pthread_t *workers;
+    size_t num_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t start;              // Workers: a new generation was published
+    pthread_cond_t done;               // Caller: the last worker finished
+    uint64_t generation;
+    size_t running;                    // Workers still busy with the current job
+    render_job_t *job;
+    bool shutdown;
+};
+
+/* ======================== Mapping ======================== */
+
+/**
+ * @brief Wire position of a pixel inside one panel
+ */
+static uint32_t panel_offset(const led_matrix_config_t *config, uint32_t pw, uint32_t ph,
+                             uint32_t px, uint32_t py) {
+    if (config->flip_x) {
+        px = pw - 1 - px;
+    }
+    if (config->flip_y) {
+        py = ph - 1 - py;
+    }
+    if (config->order == LED_MATRIX_ROWS) {
+        if (config->serpentine && (py & 1)) {
+            px = pw - 1 - px;
+        }
+        return py * pw + px;
+    }
+    if (config->serpentine && (px & 1)) {
+        py = ph - 1 - py;
+    }
+    return px * ph + py;
+}
+
+led_matrix_t *led_matrix_create(const led_matrix_config_t *config) {
+    if (config == NULL || config->width == 0 || config->height == 0 ||
+        (uint64_t)config->width * config->height > UINT32_MAX) {
+        fprintf(stderr, "Error: Invalid matrix size\n");
+        return NULL;
+    }
+
+    uint32_t pw = config->panel_width ? config->panel_width : config->width;
+    uint32_t ph = config->panel_height ? config->panel_height : config->height;
+    if (config->width % pw != 0 || config->height % ph != 0) {
+        fprintf(stderr, "Error: %ux%u matrix is not a whole number of %ux%u panels\n",
+                config->width, config->height, pw, ph);
+        return NULL;
+    }
+
+    led_matrix_t *matrix = calloc(1, sizeof(led_matrix_t));
+    if (matrix == NULL) {
+        fprintf(stderr, "Error: Failed to allocate matrix\n");
+        return NULL;
+    }
+    size_t count = (size_t)config->width * config->height;
+    matrix->width = config->width;
+    matrix->height = config->height;
+    matrix->table = malloc(count * sizeof(uint32_t));
+    matrix->frame = calloc(count, sizeof(uint32_t));
+    if (matrix->table == NULL || matrix->frame == NULL) {
+        fprintf(stderr, "Error: Failed to allocate matrix tables for %zu pixels\n", count);
+        led_matrix_destroy(matrix);
+        return NULL;
+    }
+
+    uint32_t panels_x = config->width / pw;
+    for (uint32_t y = 0; y < config->height; y++) {
+        for (uint32_t x = 0; x < config->width; x++) {
+            uint32_t panel = (y / ph) * panels_x + x / pw;
+            matrix->table[(size_t)y * config->width + x] =
+                panel * pw * ph + panel_offset(config, pw, ph, x % pw, y % ph);
+        }
+    }
+    return matrix;
+}
+
+void led_matrix_destroy(led_matrix_t *matrix) {
+    if (matrix == NULL) {
+        return;
+    }
+    free(matrix->table);
+    free(matrix->frame);
+    free(matrix);
+}
+
+size_t led_matrix_get_pixel_count(const led_matrix_t *matrix) {
+    return matrix ? (size_t)matrix->width * matrix->height : 0;
+}
+
+size_t led_matrix_index(const led_matrix_t *matrix, uint32_t x, uint32_t y) {
+    if (matrix == NULL || x >= matrix->width || y >= matrix->height) {
+        return SIZE_MAX;
+    }
+    return matrix->table[(size_t)y * matrix->width + x];
+}
+
+const uint32_t *led_matrix_get_index_table(const led_matrix_t *matrix) {
+    return matrix ? matrix->table : NULL;
+}
+
+void led_matrix_set_pixel(const led_matrix_t *matrix, led_strip_t *strip,
+                          uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b) {
+    size_t index = led_matrix_index(matrix, x, y);
+    if (index != SIZE_MAX) {
+        led_strip_set_pixel_color(strip, index, r, g, b);
+    }
+}
+
+/* ======================== Tiled rendering ======================== */
+
+static void render_tile(const render_job_t *job, size_t tile) {
+    const led_matrix_t *matrix = job->matrix;
+    uint32_t x0 = (uint32_t)(tile % job->tiles_x) * LED_MATRIX_TILE;
+    uint32_t y0 = (uint32_t)(tile / job->tiles_x) * LED_MATRIX_TILE;
+    uint32_t x1 = x0 + LED_MATRIX_TILE < matrix->width ? x0 + LED_MATRIX_TILE : matrix->width;
+    uint32_t y1 = y0 + LED_MATRIX_TILE < matrix->height ? y0 + LED_MATRIX_TILE : matrix->height;
+
+    for (uint32_t y = y0; y < y1; y++) {
+        const uint32_t *row = matrix->table + (size_t)y * matrix->width;
+        for (uint32_t x = x0; x < x1; x++) {
+            job->out[row[x]] = job->shader(x, y, job->time_ms, job->user);
+        }
+    }
+}
+
+static void run_tiles(render_job_t *job) {
+    size_t tile;
+    while ((tile = atomic_fetch_add_explicit(&job->next_tile, 1, memory_order_relaxed))
+           < job->num_tiles) {
+        render_tile(job, tile);
+    }
+}
+
+static void *pool_worker(void *arg) {
+    led_render_pool_t *pool = arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        render_job_t *job = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tiles(job);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+led_render_pool_t *led_render_pool_create(size_t num_threads) {
+    if (num_threads == 0) {
+        fprintf(stderr, "Error: num_threads must be greater than 0\n");
+        return NULL;
+    }
+
+    led_render_pool_t *pool = calloc(1, sizeof(led_render_pool_t));
+    if (pool == NULL) {
+        fprintf(stderr, "Error: Failed to allocate render pool\n");
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    if (num_threads > 1) {
+        pool->workers = calloc(num_threads - 1, sizeof(pthread_t));
+        if (pool->workers == NULL) {
+            fprintf(stderr, "Error: Failed to allocate render pool\n");
+            led_render_pool_destroy(pool);
+            return NULL;
+        }
+        for (size_t i = 0; i < num_threads - 1; i++) {
+            if (pthread_create(&pool->workers[i], NULL, pool_worker, pool) != 0) {
+                fprintf(stderr, "Error: Failed to start render thread %zu\n", i);
+                led_render_pool_destroy(pool);
+                return NULL;
+            }
+            pool->num_workers++;
+        }
+    }
+    return pool;
+}
+
+void led_render_pool_destroy(led_render_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t led_render_pool_get_threads(const led_render_pool_t *pool) {
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+int led_matrix_render(led_render_pool_t *pool, const led_matrix_t *matrix,
+                      led_shader_fn shader, void *user, uint32_t time_ms, uint32_t *out) {
+    if (matrix == NULL || shader == NULL || out == NULL) {
+        return -1;
+    }
+
+    render_job_t job = {
+        .matrix = matrix, .shader = shader, .user = user, .time_ms = time_ms, .out = out,
+        .tiles_x = (matrix->width + LED_MATRIX_TILE - 1) / LED_MATRIX_TILE
+    };
+    job.num_tiles = (size_t)job.tiles_x *
+                    ((matrix->height + LED_MATRIX_TILE - 1) / LED_MATRIX_TILE);
+    atomic_init(&job.next_tile, 0);
+
+    if (pool == NULL || pool->num_workers == 0 || job.num_tiles == 1) {
+        run_tiles(&job);
+        return 0;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->job = &job;
+    pool->running = pool->num_workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_tiles(&job);
+
+    // The job lives on this stack frame: wait until no worker can touch it
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pool->job = NULL;
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+int led_matrix_render_to(led_render_pool_t *pool, led_matrix_t *matrix,
+                         led_shader_fn shader, void *user, uint32_t time_ms,
+                         led_strip_t *strip) {
+    if (matrix == NULL || strip == NULL ||
+        led_matrix_render(pool, matrix, shader, user, time_ms, matrix->frame) != 0) {
+        return -1;
+    }
+
+    size_t count = led_strip_get_pixel_count(strip);
+    size_t pixels = led_matrix_get_pixel_count(matrix);
+    led_strip_copy_range(strip, 0, matrix->frame, count < pixels ? count : pixels);
+    return 0;
+}
@@ -0,0 +1,627 @@
+/**
+ * @file led_record.c
+ * @brief .ledrec writer, mmap-based reader and timed playback
+ *
+ * The recorder keeps the previous frame and emits SKIP / RUN / LITERAL
+ * operations against it (or against black for key frames). The reader
+ * maps the file read-only, indexes the frame headers once, and decodes
+ * payloads in place; playing consecutive frames costs one delta each.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "led_record.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORD_MAGIC        "LREC"
+#define RECORD_VERSION      1
+#define FILE_HEADER_BYTES   16
+#define FRAME_HEADER_BYTES  12
+
+#define OP_SKIP             0
+#define OP_RUN              1
+#define OP_LITERAL          2
+#define OP_SHORT_MAX        63      // Longest count stored in the op byte itself
+#define MIN_RUN             3       // Shorter runs are cheaper as literals
+#define APPLY_MAX_GAP       16      // Unchanged pixels copied to keep a strip span whole
+
+struct led_recorder {
+    FILE *file;
+    size_t bytes_per_color;
+    uint32_t *previous;                // Last frame written
+    uint32_t *capture;                 // Unpacked strip for led_recorder_capture()
+    uint8_t *payload;                  // Encoded frame
+    bool failed;
+    led_record_info_t info;
+};
+
+struct led_replay {
+    uint8_t *map;
+    size_t map_size;
+    size_t bytes_per_color;
+    led_record_info_t info;
+    size_t *offsets;                   // Payload offset of each frame
+    uint32_t *times;
+    uint8_t *types;
+    uint32_t *pixels;                  // Decoded frame `current`
+    uint32_t *scratch;                 // Key frame decoded while pixels holds the previous one
+    size_t current;                    // Frame in pixels (SIZE_MAX = none)
+    size_t applied;                    // Last frame written by led_replay_apply()
+};
+
+/* ======================== Byte helpers ======================== */
+
+static void put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (uint8_t)(v >> (8 * i));
+    }
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+static uint8_t *put_op(uint8_t *p, unsigned kind, size_t count) {
+    if (count <= OP_SHORT_MAX) {
+        *p++ = (uint8_t)((kind << 6) | (count - 1));
+        return p;
+    }
+    *p++ = (uint8_t)((kind << 6) | 63);
+    size_t extra = count - (OP_SHORT_MAX + 1);
+    do {
+        uint8_t byte = extra & 0x7F;
+        extra >>= 7;
+        *p++ = byte | (extra ? 0x80 : 0);
+    } while (extra);
+    return p;
+}
+
+static uint8_t *put_color(uint8_t *p, uint32_t color, size_t bytes_per_color) {
+    p[0] = (uint8_t)color;
+    p[1] = (uint8_t)(color >> 8);
+    p[2] = (uint8_t)(color >> 16);
+    if (bytes_per_color == 4) {
+        p[3] = (uint8_t)(color >> 24);
+    }
+    return p + bytes_per_color;
+}
+
+static uint32_t get_color(const uint8_t *p, size_t bytes_per_color) {
+    uint32_t color = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    if (bytes_per_color == 4) {
+        color |= (uint32_t)p[3] << 24;
+    }
+    return color;
+}
+
+/* ======================== Recording ======================== */
+
+/**
+ * @brief Encode cur against ref (NULL = black); returns the payload size
+ */
+static size_t encode_frame(const uint32_t *cur, const uint32_t *ref, size_t count,
+                           size_t bytes_per_color, uint8_t *out) {
+    uint8_t *p = out;
+    size_t i = 0;
+
+#define REF(k) (ref ? ref[k] : 0)
+    while (i < count) {
+        if (cur[i] == REF(i)) {
+            size_t j = i + 1;
+            while (j < count && cur[j] == REF(j)) {
+                j++;
+            }
+            if (j == count) {
+                break;                 // Trailing SKIP is implicit
+            }
+            p = put_op(p, OP_SKIP, j - i);
+            i = j;
+            continue;
+        }
+
+        size_t j = i + 1;
+        while (j < count && cur[j] == cur[i]) {
+            j++;
+        }
+        if (j - i >= MIN_RUN) {
+            p = put_op(p, OP_RUN, j - i);
+            p = put_color(p, cur[i], bytes_per_color);
+            i = j;
+            continue;
+        }
+
+        // Literal: changed pixels up to the next unchanged pixel or run
+        size_t start = i++;
+        while (i < count && cur[i] != REF(i) &&
+               !(i + 2 < count && cur[i] == cur[i + 1] && cur[i] == cur[i + 2])) {
+            i++;
+        }
+        p = put_op(p, OP_LITERAL, i - start);
+        for (size_t k = start; k < i; k++) {
+            p = put_color(p, cur[k], bytes_per_color);
+        }
+    }
+#undef REF
+
+    return (size_t)(p - out);
+}
+
+led_recorder_t *led_recorder_open(const char *path, size_t num_pixels,
+                                  led_pixel_format_t format, size_t keyframe_interval) {
+    if (path == NULL || num_pixels == 0 || num_pixels > UINT32_MAX ||
+        led_format_bytes_per_pixel(format) == 0) {
+        fprintf(stderr, "Error: Invalid recording parameters\n");
+        return NULL;
+    }
+
+    led_recorder_t *rec = calloc(1, sizeof(led_recorder_t));
+    if (rec == NULL) {
+        fprintf(stderr, "Error: Failed to allocate recorder\n");
+        return NULL;
+    }
+    rec->bytes_per_color = format == LED_FORMAT_RGBW32 || format == LED_FORMAT_RGBW64 ? 4 : 3;
+    rec->info.num_pixels = num_pixels;
+    rec->info.format = format;
+    rec->info.keyframe_interval = keyframe_interval ? keyframe_interval
+                                                    : LED_RECORD_KEYFRAME_INTERVAL;
+    rec->previous = calloc(num_pixels, sizeof(uint32_t));
+    rec->capture = malloc(num_pixels * sizeof(uint32_t));
+    // Worst case: one op byte between every changed pixel and the next
+    rec->payload = malloc(num_pixels * (rec->bytes_per_color + 2) + 16);
+    if (rec->previous == NULL || rec->capture == NULL || rec->payload == NULL) {
+        fprintf(stderr, "Error: Failed to allocate recording buffers\n");
+        led_recorder_close(rec);
+        return NULL;
+    }
+
+    rec->file = fopen(path, "wb");
+    if (rec->file == NULL) {
+        perror("Error: Cannot create recording");
+        led_recorder_close(rec);
+        return NULL;
+    }
+    setvbuf(rec->file, NULL, _IOFBF, 1 << 16);
+
+    uint8_t header[FILE_HEADER_BYTES];
+    memcpy(header, RECORD_MAGIC, 4);
+    put_u16(header + 4, RECORD_VERSION);
+    header[6] = (uint8_t)format;
+    header[7] = (uint8_t)rec->bytes_per_color;
+    put_u32(header + 8, (uint32_t)num_pixels);
+    put_u32(header + 12, (uint32_t)rec->info.keyframe_interval);
+    if (fwrite(header, 1, sizeof(header), rec->file) != sizeof(header)) {
+        perror("Error: Cannot write recording header");
+        led_recorder_close(rec);
+        return NULL;
+    }
+    rec->info.file_bytes = FILE_HEADER_BYTES;
+    return rec;
+}
+
+int led_recorder_add_frame(led_recorder_t *recorder, const uint32_t *pixels, uint32_t time_ms) {
+    if (recorder == NULL || pixels == NULL || recorder->failed) {
+        return -1;
+    }
+    led_record_info_t *info = &recorder->info;
+    if (info->frames > 0 && time_ms < info->duration_ms) {
+        fprintf(stderr, "Error: Frame at %u ms is earlier than the previous frame (%u ms)\n",
+                time_ms, info->duration_ms);
+        return -1;
+    }
+
+    bool key = info->frames % info->keyframe_interval == 0;
+    size_t size = encode_frame(pixels, key ? NULL : recorder->previous, info->num_pixels,
+                               recorder->bytes_per_color, recorder->payload);
+
+    uint8_t header[FRAME_HEADER_BYTES] = { 0 };
+    put_u32(header, time_ms);
+    header[4] = key ? LED_RECORD_KEY : LED_RECORD_DELTA;
+    put_u32(header + 8, (uint32_t)size);
+    if (fwrite(header, 1, sizeof(header), recorder->file) != sizeof(header) ||
+        fwrite(recorder->payload, 1, size, recorder->file) != size) {
+        perror("Error: Cannot write frame");
+        recorder->failed = true;
+        return -1;
+    }
+
+    memcpy(recorder->previous, pixels, info->num_pixels * sizeof(uint32_t));
+    info->frames++;
+    info->keyframes += key;
+    info->duration_ms = time_ms;
+    info->raw_bytes += info->num_pixels * recorder->bytes_per_color;
+    info->file_bytes += FRAME_HEADER_BYTES + size;
+    return 0;
+}
+
+int led_recorder_capture(led_recorder_t *recorder, const led_strip_t *strip, uint32_t time_ms) {
+    if (recorder == NULL || strip == NULL ||
+        led_strip_get_pixel_count(strip) != recorder->info.num_pixels) {
+        fprintf(stderr, "Error: Strip does not match the recording size\n");
+        return -1;
+    }
+    led_strip_unpack_pixels(strip, NULL, 0, recorder->capture, recorder->info.num_pixels);
+    return led_recorder_add_frame(recorder, recorder->capture, time_ms);
+}
+
+void led_recorder_get_info(const led_recorder_t *recorder, led_record_info_t *info) {
+    if (recorder != NULL && info != NULL) {
+        *info = recorder->info;
+    }
+}
+
+int led_recorder_close(led_recorder_t *recorder) {
+    if (recorder == NULL) {
+        return -1;
+    }
+    int result = recorder->failed ? -1 : 0;
+    if (recorder->file != NULL && fclose(recorder->file) != 0) {
+        perror("Error: Cannot close recording");
+        result = -1;
+    }
+    free(recorder->previous);
+    free(recorder->capture);
+    free(recorder->payload);
+    free(recorder);
+    return result;
+}
+
+/* ======================== Replay ======================== */
+
+/**
+ * @brief Apply the operations of one frame to out (which holds the reference)
+ *
+ * With out == NULL the payload is only validated. Written spans are also
+ * copied into strip when it is not NULL.
+ */
+static int decode_ops(const led_replay_t *replay, size_t index, uint32_t *out,
+                      led_strip_t *strip, size_t *changed) {
+    const uint8_t *p = replay->map + replay->offsets[index];
+    const uint8_t *end = p + get_u32(p - FRAME_HEADER_BYTES + 8);
+    size_t bpc = replay->bytes_per_color;
+    size_t count = replay->info.num_pixels;
+    size_t i = 0;
+    size_t written = 0;
+    size_t span_start = 0;             // Written pixels not yet copied to the strip
+    size_t span_end = 0;
+
+    while (p < end) {
+        unsigned kind = *p >> 6;
+        size_t n = (size_t)(*p++ & 0x3F) + 1;
+
+        if (n == OP_SHORT_MAX + 1) {
+            size_t extra = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (p >= end || shift > 28) {
+                    return -1;
+                }
+                extra |= (size_t)(*p & 0x7F) << shift;
+                if (!(*p++ & 0x80)) {
+                    break;
+                }
+            }
+            n += extra;
+        }
+        if (n > count - i) {
+            return -1;
+        }
+
+        if (kind == OP_RUN) {
+            if ((size_t)(end - p) < bpc) {
+                return -1;
+            }
+            uint32_t color = get_color(p, bpc);
+            p += bpc;
+            if (out != NULL) {
+                for (size_t k = 0; k < n; k++) {
+                    out[i + k] = color;
+                }
+            }
+        } else if (kind == OP_LITERAL) {
+            if ((size_t)(end - p) < n * bpc) {
+                return -1;
+            }
+            if (out != NULL) {
+                for (size_t k = 0; k < n; k++, p += bpc) {
+                    out[i + k] = get_color(p, bpc);
+                }
+            } else {
+                p += n * bpc;
+            }
+        } else if (kind != OP_SKIP) {
+            return -1;
+        }
+
+        if (kind != OP_SKIP) {
+            if (span_end == span_start) {
+                span_start = i;
+            }
+            span_end = i + n;
+            written += n;
+        } else if (n > APPLY_MAX_GAP && span_end > span_start) {
+            // Short gaps stay inside the span: out already holds those pixels,
+            // and a few long spans are far cheaper to track than many short ones
+            if (strip != NULL) {
+                led_strip_copy_range(strip, span_start, out + span_start, span_end - span_start);
+            }
+            span_start = span_end;
+        }
+        i += n;
+    }
+    if (strip != NULL && span_end > span_start) {
+        led_strip_copy_range(strip, span_start, out + span_start, span_end - span_start);
+    }
+
+    if (changed != NULL) {
+        *changed = written;
+    }
+    return 0;
+}
+
+led_replay_t *led_replay_open(const char *path) {
+    if (path == NULL) {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Error: Cannot open recording");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < FILE_HEADER_BYTES) {
+        fprintf(stderr, "Error: %s is not a recording\n", path);
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("Error: Cannot map recording");
+        return NULL;
+    }
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    led_replay_t *replay = calloc(1, sizeof(led_replay_t));
+    if (replay == NULL) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    replay->map = map;
+    replay->map_size = (size_t)st.st_size;
+    replay->current = SIZE_MAX;
+    replay->applied = SIZE_MAX;
+
+    const uint8_t *h = replay->map;
+    replay->bytes_per_color = h[7];
+    replay->info.format = (led_pixel_format_t)h[6];
+    replay->info.num_pixels = get_u32(h + 8);
+    replay->info.keyframe_interval = get_u32(h + 12);
+    if (memcmp(h, RECORD_MAGIC, 4) != 0 || get_u16(h + 4) != RECORD_VERSION ||
+        (replay->bytes_per_color != 3 && replay->bytes_per_color != 4) ||
+        led_format_bytes_per_pixel(replay->info.format) == 0 || replay->info.num_pixels == 0) {
+        fprintf(stderr, "Error: %s is not a version %d recording\n", path, RECORD_VERSION);
+        led_replay_close(replay);
+        return NULL;
+    }
+
+    // Index every complete frame; a torn last frame is ignored
+    size_t capacity = 0;
+    size_t pos = FILE_HEADER_BYTES;
+    while (pos + FRAME_HEADER_BYTES <= replay->map_size) {
+        const uint8_t *fh = replay->map + pos;
+        size_t payload = get_u32(fh + 8);
+        if (payload > replay->map_size - pos - FRAME_HEADER_BYTES || fh[4] > LED_RECORD_DELTA ||
+            (replay->info.frames == 0 && fh[4] != LED_RECORD_KEY)) {
+            break;
+        }
+        if (replay->info.frames == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            size_t *offsets = realloc(replay->offsets, capacity * sizeof(size_t));
+            if (offsets != NULL) {
+                replay->offsets = offsets;
+            }
+            uint32_t *times = realloc(replay->times, capacity * sizeof(uint32_t));
+            if (times != NULL) {
+                replay->times = times;
+            }
+            uint8_t *types = realloc(replay->types, capacity);
+            if (types != NULL) {
+                replay->types = types;
+            }
+            if (offsets == NULL || times == NULL || types == NULL) {
+                fprintf(stderr, "Error: Failed to allocate frame index\n");
+                led_replay_close(replay);
+                return NULL;
+            }
+        }
+        size_t f = replay->info.frames++;
+        replay->offsets[f] = pos + FRAME_HEADER_BYTES;
+        replay->times[f] = get_u32(fh);
+        replay->types[f] = fh[4];
+        replay->info.keyframes += fh[4] == LED_RECORD_KEY;
+        replay->info.duration_ms = replay->times[f];
+        pos += FRAME_HEADER_BYTES + payload;
+    }
+    replay->info.raw_bytes = (uint64_t)replay->info.frames * replay->info.num_pixels *
+                             replay->bytes_per_color;
+    replay->info.file_bytes = replay->map_size;
+
+    replay->pixels = calloc(replay->info.num_pixels, sizeof(uint32_t));
+    replay->scratch = calloc(replay->info.num_pixels, sizeof(uint32_t));
+    if (replay->pixels == NULL || replay->scratch == NULL) {
+        fprintf(stderr, "Error: Failed to allocate replay buffers\n");
+        led_replay_close(replay);
+        return NULL;
+    }
+    return replay;
+}
+
+void led_replay_close(led_replay_t *replay) {
+    if (replay == NULL) {
+        return;
+    }
+    munmap(replay->map, replay->map_size);
+    free(replay->offsets);
+    free(replay->times);
+    free(replay->types);
+    free(replay->pixels);
+    free(replay->scratch);
+    free(replay);
+}
+
+void led_replay_get_info(const led_replay_t *replay, led_record_info_t *info) {
+    if (replay != NULL && info != NULL) {
+        *info = replay->info;
+    }
+}
+
+int led_replay_get_frame_info(const led_replay_t *replay, size_t index,
+                              led_record_frame_info_t *info) {
+    if (replay == NULL || info == NULL || index >= replay->info.frames) {
+        return -1;
+    }
+    info->time_ms = replay->times[index];
+    info->type = (led_record_frame_type_t)replay->types[index];
+    info->payload_bytes = get_u32(replay->map + replay->offsets[index] - FRAME_HEADER_BYTES + 8);
+    return decode_ops(replay, index, NULL, NULL, &info->changed_pixels);
+}
+
+const uint32_t *led_replay_frame(led_replay_t *replay, size_t index) {
+    if (replay == NULL || index >= replay->info.frames) {
+        return NULL;
+    }
+    if (index == replay->current) {
+        return replay->pixels;
+    }
+
+    size_t start = index;
+    while (replay->types[start] != LED_RECORD_KEY) {
+        start--;                       // Frame 0 is always a key frame
+    }
+    if (replay->current != SIZE_MAX && replay->current >= start && replay->current < index) {
+        start = replay->current + 1;   // Continue from the decoded frame
+    }
+
+    for (size_t f = start; f <= index; f++) {
+        if (replay->types[f] == LED_RECORD_KEY) {
+            memset(replay->pixels, 0, replay->info.num_pixels * sizeof(uint32_t));
+        }
+        if (decode_ops(replay, f, replay->pixels, NULL, NULL) != 0) {
+            fprintf(stderr, "Error: Frame %zu of the recording is corrupt\n", f);
+            replay->current = SIZE_MAX;
+            return NULL;
+        }
+    }
+    replay->current = index;
+    return replay->pixels;
+}
+
+/**
+ * @brief Copy the spans where next differs from prev into the strip
+ */
+static void copy_changed(led_strip_t *strip, const uint32_t *prev, const uint32_t *next,
+                         size_t count) {
+    size_t i = 0;
+    while (i < count) {
+        if (prev[i] == next[i]) {
+            i++;
+            continue;
+        }
+        // Extend the span over changes separated by at most APPLY_MAX_GAP equal pixels
+        size_t end = i + 1;
+        for (size_t j = end; j < count && j - end <= APPLY_MAX_GAP; j++) {
+            if (prev[j] != next[j]) {
+                end = j + 1;
+            }
+        }
+        led_strip_copy_range(strip, i, next + i, end - i);
+        i = end;
+    }
+}
+
+int led_replay_apply(led_replay_t *replay, size_t index, led_strip_t *strip) {
+    if (replay == NULL || strip == NULL || index >= replay->info.frames) {
+        return -1;
+    }
+
+    size_t count = replay->info.num_pixels;
+    bool follows = replay->applied != SIZE_MAX && index == replay->applied + 1 &&
+                   replay->current == replay->applied;
+
+    if (follows && replay->types[index] == LED_RECORD_DELTA) {
+        if (decode_ops(replay, index, replay->pixels, strip, NULL) != 0) {
+            replay->current = replay->applied = SIZE_MAX;
+            return -1;
+        }
+    } else if (follows) {
+        // Key frames are coded against black: diff against the previous frame
+        memset(replay->scratch, 0, count * sizeof(uint32_t));
+        if (decode_ops(replay, index, replay->scratch, NULL, NULL) != 0) {
+            replay->current = replay->applied = SIZE_MAX;
+            return -1;
+        }
+        copy_changed(strip, replay->pixels, replay->scratch, count);
+        uint32_t *tmp = replay->pixels;
+        replay->pixels = replay->scratch;
+        replay->scratch = tmp;
+    } else {
+        if (led_replay_frame(replay, index) == NULL) {
+            replay->applied = SIZE_MAX;
+            return -1;
+        }
+        led_strip_copy_range(strip, 0, replay->pixels, count);
+    }
+
+    replay->current = replay->applied = index;
+    return 0;
+}
+
+long led_replay_play(led_replay_t *replay, led_strip_t *strip, double speed,
+                     led_replay_fn on_frame, void *user) {
+    if (replay == NULL || strip == NULL || speed < 0) {
+        return -1;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    replay->applied = SIZE_MAX;
+
+    for (size_t f = 0; f < replay->info.frames; f++) {
+        if (speed > 0) {
+            double offset_ns = (double)(replay->times[f] - replay->times[0]) * 1e6 / speed;
+            uint64_t target = (uint64_t)start.tv_sec * 1000000000ULL + (uint64_t)start.tv_nsec +
+                              (uint64_t)offset_ns;
+            struct timespec ts = {
+                .tv_sec = (time_t)(target / 1000000000ULL),
+                .tv_nsec = (long)(target % 1000000000ULL)
+            };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+                // Interrupted by a signal: sleep the rest
+            }
+        }
+        if (led_replay_apply(replay, f, strip) != 0) {
+            return -1;
+        }
+        if (on_frame != NULL && on_frame(strip, f, user) != 0) {
+            return (long)f + 1;
+        }
+    }
+    return (long)replay->info.frames;
+}
@@ -0,0 +1,802 @@
+/**
+ * @file led_simd.c
+ * @brief Bulk pixel kernels with runtime SIMD dispatch
+ *
+ * Pixels are 0x00GGRRBB words, i.e. bytes B, R, G, 0 in memory on a
+ * little-endian CPU. The SIMD kernels widen those bytes to 16-bit lanes,
+ * do the arithmetic and pack them back; the unused top byte stays 0.
+ *
+ * The x86 kernels are compiled with GCC target attributes, so the rest of
+ * the project keeps its default flags and only the selected table is ever
+ * executed on CPUs that lack AVX2.
+ */
+
+#include "led_simd.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LED_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define LED_SIMD_X86 0
+#endif
+
+/* ======================== Scalar kernels ======================== */
+
+static void fill_scalar(uint32_t *dst, uint32_t color, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = color;
+    }
+}
+
+static void copy_any(uint32_t *dst, const uint32_t *src, size_t count) {
+    // libc memmove is already vectorized and handles overlapping ranges
+    memmove(dst, src, count * sizeof(uint32_t));
+}
+
+static void scale_scalar(uint32_t *dst, size_t count,
+                         uint8_t sr, uint8_t sg, uint8_t sb) {
+    // c * (s + 1) >> 8 keeps c for s = 255 and gives 0 for s = 0
+    uint32_t mr = (uint32_t)sr + 1;
+    uint32_t mg = (uint32_t)sg + 1;
+    uint32_t mb = (uint32_t)sb + 1;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t c = dst[i];
+        uint32_t g = (((c >> 16) & 0xFF) * mg) >> 8;
+        uint32_t r = (((c >> 8) & 0xFF) * mr) >> 8;
+        uint32_t b = ((c & 0xFF) * mb) >> 8;
+        dst[i] = (g << 16) | (r << 8) | b;
+    }
+}
+
+static void blend_scalar(uint32_t *dst, const uint32_t *src, size_t count,
+                         uint8_t alpha) {
+    uint32_t w = led_blend_weight(alpha);
+    uint32_t iw = 256 - w;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t d = dst[i];
+        uint32_t s = src[i];
+        uint32_t g = (((s >> 16) & 0xFF) * w + ((d >> 16) & 0xFF) * iw) >> 8;
+        uint32_t r = (((s >> 8) & 0xFF) * w + ((d >> 8) & 0xFF) * iw) >> 8;
+        uint32_t b = ((s & 0xFF) * w + (d & 0xFF) * iw) >> 8;
+        dst[i] = (g << 16) | (r << 8) | b;
+    }
+}
+
+static void lut_scalar(uint32_t *dst, size_t count, const uint8_t lut[256]) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t c = dst[i];
+        dst[i] = ((uint32_t)lut[(c >> 16) & 0xFF] << 16) |
+                 ((uint32_t)lut[(c >> 8) & 0xFF] << 8) |
+                 (uint32_t)lut[c & 0xFF];
+    }
+}
+
+static void pack_planar_scalar(uint32_t *dst, const uint8_t *r, const uint8_t *g,
+                               const uint8_t *b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = ((uint32_t)g[i] << 16) | ((uint32_t)r[i] << 8) | (uint32_t)b[i];
+    }
+}
+
+/**
+ * @brief Sum of the four bytes of a word
+ */
+static inline uint32_t byte_sum(uint32_t c) {
+    uint32_t pairs = (c & 0x00FF00FF) + ((c >> 8) & 0x00FF00FF);
+    return (pairs & 0xFFFF) + (pairs >> 16);
+}
+
+static int64_t correct_scalar(uint32_t *dst, const uint32_t *src, size_t count,
+                              const uint32_t table[1024], bool white) {
+    int64_t delta = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t c = src[i];
+        uint32_t out = table[c & 0xFF] | table[256 + ((c >> 8) & 0xFF)] |
+                       table[512 + ((c >> 16) & 0xFF)];
+        if (white) {
+            out |= table[768 + (c >> 24)];
+        }
+        delta += (int64_t)byte_sum(out) - (int64_t)byte_sum(dst[i]);
+        dst[i] = out;
+    }
+    return delta;
+}
+
+static void dither_ordered_scalar(uint32_t *dst, const uint64_t *src, size_t count,
+                                  const uint16_t pattern[128], size_t phase) {
+    for (size_t i = 0; i < count; i++) {
+        const uint16_t *d = pattern + ((phase + i) & 15) * 4;
+        uint32_t out = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            uint32_t v = (uint32_t)(src[i] >> (16 * lane)) & 0xFFFF;
+            out |= ((v - (v >> 8) + d[lane]) >> 8) << (8 * lane);
+        }
+        dst[i] = out;
+    }
+}
+
+static bool dither_temporal_scalar(uint32_t *dst, const uint64_t *src, const uint32_t *prev,
+                                   uint32_t *error, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t out = 0;
+        uint32_t rest = 0;
+        for (int lane = 0; lane < 4; lane++) {
+            uint32_t v = (uint32_t)(src[i] >> (16 * lane)) & 0xFFFF;
+            uint32_t sum = v - (v >> 8) + ((error[i] >> (8 * lane)) & 0xFF);
+            out |= (sum >> 8) << (8 * lane);
+            rest |= (sum & 0xFF) << (8 * lane);
+        }
+        changed |= out != prev[i];
+        dst[i] = out;
+        error[i] = rest;
+    }
+    return changed;
+}
+
+/* ======================== WS2812B wire encoders ======================== */
+
+// SPI 4-bit: an LED bit is 1000 (0) or 1110 (1), so one SPI byte carries 2 LED bits
+static const uint8_t spi4_pair[4] = { 0x88, 0x8E, 0xE8, 0xEE };
+
+// SPI 3-bit: 100 (0) or 110 (1); a data byte b7..b0 becomes
+// 1b70 1b60 1b5 | 0 1b40 1b30 1 | b20 1b10 1b00 -> bytes indexed by b7-5, b4-3, b2-0
+static const uint8_t spi3_first[8] = { 0x92, 0x93, 0x9A, 0x9B, 0xD2, 0xD3, 0xDA, 0xDB };
+static const uint8_t spi3_middle[4] = { 0x49, 0x4D, 0x69, 0x6D };
+static const uint8_t spi3_last[8] = { 0x24, 0x26, 0x34, 0x36, 0xA4, 0xA6, 0xB4, 0xB6 };
+
+static void encode_spi3_scalar(uint8_t *out, const uint32_t *pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        for (int shift = 16; shift >= 0; shift -= 8) {
+            uint32_t v = (p >> shift) & 0xFF;
+            out[0] = spi3_first[v >> 5];
+            out[1] = spi3_middle[(v >> 3) & 3];
+            out[2] = spi3_last[v & 7];
+            out += 3;
+        }
+    }
+}
+
+static void encode_spi4_scalar(uint8_t *out, const uint32_t *pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        for (int shift = 16; shift >= 0; shift -= 8) {
+            uint32_t v = (p >> shift) & 0xFF;
+            out[0] = spi4_pair[v >> 6];
+            out[1] = spi4_pair[(v >> 4) & 3];
+            out[2] = spi4_pair[(v >> 2) & 3];
+            out[3] = spi4_pair[v & 3];
+            out += 4;
+        }
+    }
+}
+
+static void encode_pwm_scalar(uint16_t *out, const uint32_t *pixels, size_t count,
+                              uint16_t t0h, uint16_t t1h) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        for (int bit = 23; bit >= 0; bit--) {
+            *out++ = ((p >> bit) & 1) ? t1h : t0h;
+        }
+    }
+}
+
+static const led_kernels_t kernels_scalar = {
+    .level = LED_SIMD_SCALAR,
+    .fill = fill_scalar,
+    .copy = copy_any,
+    .scale = scale_scalar,
+    .blend = blend_scalar,
+    .apply_lut = lut_scalar,
+    .pack_planar = pack_planar_scalar,
+    .correct = correct_scalar,
+    .dither_ordered = dither_ordered_scalar,
+    .dither_temporal = dither_temporal_scalar,
+    .encode_spi3 = encode_spi3_scalar,
+    .encode_spi4 = encode_spi4_scalar,
+    .encode_pwm = encode_pwm_scalar
+};
+
+#if LED_SIMD_X86
+
+/* ======================== SSE2 kernels (4 pixels / vector) ======================== */
+
+#define SSE2 __attribute__((target("sse2")))
+
+SSE2 static void fill_sse2(uint32_t *dst, uint32_t color, size_t count) {
+    __m128i v = _mm_set1_epi32((int)color);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+    fill_scalar(dst + i, color, count - i);
+}
+
+SSE2 static void scale_sse2(uint32_t *dst, size_t count,
+                            uint8_t sr, uint8_t sg, uint8_t sb) {
+    // 16-bit lanes per pixel: B, R, G, unused (multiplied by 0)
+    __m128i mul = _mm_setr_epi16((short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0,
+                                 (short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0);
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i px = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), mul), 8);
+        __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), mul), 8);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    scale_scalar(dst + i, count - i, sr, sg, sb);
+}
+
+SSE2 static void blend_sse2(uint32_t *dst, const uint32_t *src, size_t count,
+                            uint8_t alpha) {
+    __m128i w = _mm_set1_epi16((short)led_blend_weight(alpha));
+    __m128i iw = _mm_set1_epi16((short)(256 - led_blend_weight(alpha)));
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    // s * w + d * (256 - w) <= 255 * 256, so 16-bit lanes never overflow
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), w),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), iw));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), w),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), iw));
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+    blend_scalar(dst + i, src + i, count - i, alpha);
+}
+
+SSE2 static void pack_planar_sse2(uint32_t *dst, const uint8_t *r, const uint8_t *g,
+                                  const uint8_t *b, size_t count) {
+    __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    // 16 pixels per iteration: (B | R << 8) and (G | 0 << 8) interleaved as 16-bit pairs
+    for (; i + 16 <= count; i += 16) {
+        __m128i vr = _mm_loadu_si128((const __m128i *)(r + i));
+        __m128i vg = _mm_loadu_si128((const __m128i *)(g + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i br_lo = _mm_unpacklo_epi8(vb, vr);
+        __m128i br_hi = _mm_unpackhi_epi8(vb, vr);
+        __m128i g0_lo = _mm_unpacklo_epi8(vg, zero);
+        __m128i g0_hi = _mm_unpackhi_epi8(vg, zero);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(br_lo, g0_lo));
+        _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(br_lo, g0_lo));
+        _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(br_hi, g0_hi));
+        _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(br_hi, g0_hi));
+    }
+    pack_planar_scalar(dst + i, r + i, g + i, b + i, count - i);
+}
+
+/**
+ * @brief 16-bit lanes to 1/256 levels: v - (v >> 8)
+ */
+SSE2 static inline __m128i level_sse2(__m128i v) {
+    return _mm_sub_epi16(v, _mm_srli_epi16(v, 8));
+}
+
+SSE2 static void dither_ordered_sse2(uint32_t *dst, const uint64_t *src, size_t count,
+                                     const uint16_t pattern[128], size_t phase) {
+    size_t i = 0;
+
+    // 2 pixels per vector; sums stay below 65536, so the adds never wrap
+    for (; i + 4 <= count; i += 4) {
+        const uint16_t *d = pattern + ((phase + i) & 15) * 4;
+        __m128i a = _mm_add_epi16(level_sse2(_mm_loadu_si128((const __m128i *)(src + i))),
+                                  _mm_loadu_si128((const __m128i *)d));
+        __m128i b = _mm_add_epi16(level_sse2(_mm_loadu_si128((const __m128i *)(src + i + 2))),
+                                  _mm_loadu_si128((const __m128i *)(d + 8)));
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+    dither_ordered_scalar(dst + i, src + i, count - i, pattern, phase + i);
+}
+
+SSE2 static bool dither_temporal_sse2(uint32_t *dst, const uint64_t *src, const uint32_t *prev,
+                                      uint32_t *error, size_t count) {
+    __m128i low = _mm_set1_epi16(0xFF);
+    __m128i zero = _mm_setzero_si128();
+    __m128i diff = zero;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i e = _mm_loadu_si128((const __m128i *)(error + i));
+        __m128i a = _mm_add_epi16(level_sse2(_mm_loadu_si128((const __m128i *)(src + i))),
+                                  _mm_unpacklo_epi8(e, zero));
+        __m128i b = _mm_add_epi16(level_sse2(_mm_loadu_si128((const __m128i *)(src + i + 2))),
+                                  _mm_unpackhi_epi8(e, zero));
+        __m128i out = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        diff = _mm_or_si128(diff, _mm_xor_si128(out, _mm_loadu_si128((const __m128i *)(prev + i))));
+        _mm_storeu_si128((__m128i *)(dst + i), out);
+        _mm_storeu_si128((__m128i *)(error + i),
+                         _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low)));
+    }
+    bool changed = _mm_movemask_epi8(_mm_cmpeq_epi8(diff, zero)) != 0xFFFF;
+    return dither_temporal_scalar(dst + i, src + i, prev + i, error + i, count - i) || changed;
+}
+
+SSE2 static void encode_pwm_sse2(uint16_t *out, const uint32_t *pixels, size_t count,
+                                 uint16_t t0h, uint16_t t1h) {
+    // One data byte per vector: lane k tests bit 7 - k and selects t1h or t0h
+    __m128i bits = _mm_setr_epi16(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    __m128i v0 = _mm_set1_epi16((short)t0h);
+    __m128i diff = _mm_set1_epi16((short)(t0h ^ t1h));
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = pixels[i];
+        for (int shift = 16; shift >= 0; shift -= 8) {
+            __m128i v = _mm_set1_epi16((short)((p >> shift) & 0xFF));
+            __m128i set = _mm_cmpeq_epi16(_mm_and_si128(v, bits), bits);
+            _mm_storeu_si128((__m128i *)out, _mm_xor_si128(v0, _mm_and_si128(set, diff)));
+            out += 8;
+        }
+    }
+}
+
+static const led_kernels_t kernels_sse2 = {
+    .level = LED_SIMD_SSE2,
+    .fill = fill_sse2,
+    .copy = copy_any,
+    .scale = scale_sse2,
+    .blend = blend_sse2,
+    .apply_lut = lut_scalar,    // No byte gather before AVX2
+    .pack_planar = pack_planar_sse2,
+    .correct = correct_scalar,  // No gather before AVX2
+    .dither_ordered = dither_ordered_sse2,
+    .dither_temporal = dither_temporal_sse2,
+    .encode_spi3 = encode_spi3_scalar,  // Table lookups need pshufb (SSSE3)
+    .encode_spi4 = encode_spi4_scalar,
+    .encode_pwm = encode_pwm_sse2
+};
+
+/* ======================== AVX2 kernels (8 pixels / vector) ======================== */
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static void fill_avx2(uint32_t *dst, uint32_t color, size_t count) {
+    __m256i v = _mm256_set1_epi32((int)color);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), v);
+    }
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+    }
+    fill_scalar(dst + i, color, count - i);
+}
+
+AVX2 static void scale_avx2(uint32_t *dst, size_t count,
+                            uint8_t sr, uint8_t sg, uint8_t sb) {
+    // unpack/pack stay within 128-bit lanes, so the round trip keeps pixel order
+    __m256i mul = _mm256_setr_epi16((short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0,
+                                    (short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0,
+                                    (short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0,
+                                    (short)(sb + 1), (short)(sr + 1), (short)(sg + 1), 0);
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(px, zero), mul), 8);
+        __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(px, zero), mul), 8);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    scale_scalar(dst + i, count - i, sr, sg, sb);
+}
+
+AVX2 static void blend_avx2(uint32_t *dst, const uint32_t *src, size_t count,
+                            uint8_t alpha) {
+    __m256i w = _mm256_set1_epi16((short)led_blend_weight(alpha));
+    __m256i iw = _mm256_set1_epi16((short)(256 - led_blend_weight(alpha)));
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(s, zero), w),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), iw));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(s, zero), w),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), iw));
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_packus_epi16(_mm256_srli_epi16(lo, 8),
+                                                _mm256_srli_epi16(hi, 8)));
+    }
+    blend_scalar(dst + i, src + i, count - i, alpha);
+}
+
+AVX2 static void lut_avx2(uint32_t *dst, size_t count, const uint8_t lut[256]) {
+    // Widen the table so each channel is one 32-bit gather
+    int lut32[256];
+    __m256i mask = _mm256_set1_epi32(0xFF);
+    size_t i = 0;
+
+    for (int k = 0; k < 256; k++) {
+        lut32[k] = lut[k];
+    }
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_i32gather_epi32(lut32, _mm256_and_si256(px, mask), 4);
+        __m256i r = _mm256_i32gather_epi32(lut32,
+                        _mm256_and_si256(_mm256_srli_epi32(px, 8), mask), 4);
+        __m256i g = _mm256_i32gather_epi32(lut32,
+                        _mm256_and_si256(_mm256_srli_epi32(px, 16), mask), 4);
+        __m256i out = _mm256_or_si256(b, _mm256_or_si256(_mm256_slli_epi32(r, 8),
+                                                         _mm256_slli_epi32(g, 16)));
+        _mm256_storeu_si256((__m256i *)(dst + i), out);
+    }
+    lut_scalar(dst + i, count - i, lut);
+}
+
+AVX2 static int64_t correct_avx2(uint32_t *dst, const uint32_t *src, size_t count,
+                                 const uint32_t table[1024], bool white) {
+    const int *t = (const int *)table;
+    __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i added = zero;
+    __m256i removed = zero;
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i px = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i old = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i out = _mm256_or_si256(
+            _mm256_i32gather_epi32(t, _mm256_and_si256(px, mask), 4),
+            _mm256_or_si256(
+                _mm256_i32gather_epi32(t + 256, _mm256_and_si256(_mm256_srli_epi32(px, 8), mask), 4),
+                _mm256_i32gather_epi32(t + 512, _mm256_and_si256(_mm256_srli_epi32(px, 16), mask), 4)));
+        if (white) {
+            out = _mm256_or_si256(out, _mm256_i32gather_epi32(t + 768, _mm256_srli_epi32(px, 24), 4));
+        }
+        // psadbw against zero adds up 8 bytes per 64-bit lane
+        added = _mm256_add_epi64(added, _mm256_sad_epu8(out, zero));
+        removed = _mm256_add_epi64(removed, _mm256_sad_epu8(old, zero));
+        _mm256_storeu_si256((__m256i *)(dst + i), out);
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_sub_epi64(added, removed));
+    return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           correct_scalar(dst + i, src + i, count - i, table, white);
+}
+
+AVX2 static inline __m256i level_avx2(__m256i v) {
+    return _mm256_sub_epi16(v, _mm256_srli_epi16(v, 8));
+}
+
+/**
+ * @brief Pack two vectors of 4 pixels' 16-bit lanes into 8 pixels of bytes
+ *
+ * packus works per 128-bit lane and leaves pixels in the order 0-1, 4-5,
+ * 2-3, 6-7; the permute restores 0-7.
+ */
+AVX2 static inline __m256i pack_pixels_avx2(__m256i a, __m256i b) {
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+}
+
+AVX2 static void dither_ordered_avx2(uint32_t *dst, const uint64_t *src, size_t count,
+                                     const uint16_t pattern[128], size_t phase) {
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        const uint16_t *d = pattern + ((phase + i) & 15) * 4;
+        __m256i a = _mm256_add_epi16(level_avx2(_mm256_loadu_si256((const __m256i *)(src + i))),
+                                     _mm256_loadu_si256((const __m256i *)d));
+        __m256i b = _mm256_add_epi16(level_avx2(_mm256_loadu_si256((const __m256i *)(src + i + 4))),
+                                     _mm256_loadu_si256((const __m256i *)(d + 16)));
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            pack_pixels_avx2(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8)));
+    }
+    dither_ordered_scalar(dst + i, src + i, count - i, pattern, phase + i);
+}
+
+AVX2 static bool dither_temporal_avx2(uint32_t *dst, const uint64_t *src, const uint32_t *prev,
+                                      uint32_t *error, size_t count) {
+    __m256i low = _mm256_set1_epi16(0xFF);
+    __m256i diff = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i e = _mm256_loadu_si256((const __m256i *)(error + i));
+        __m256i a = _mm256_add_epi16(level_avx2(_mm256_loadu_si256((const __m256i *)(src + i))),
+                                     _mm256_cvtepu8_epi16(_mm256_castsi256_si128(e)));
+        __m256i b = _mm256_add_epi16(level_avx2(_mm256_loadu_si256((const __m256i *)(src + i + 4))),
+                                     _mm256_cvtepu8_epi16(_mm256_extracti128_si256(e, 1)));
+        __m256i out = pack_pixels_avx2(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(out, _mm256_loadu_si256((const __m256i *)(prev + i))));
+        _mm256_storeu_si256((__m256i *)(dst + i), out);
+        _mm256_storeu_si256((__m256i *)(error + i),
+                            pack_pixels_avx2(_mm256_and_si256(a, low), _mm256_and_si256(b, low)));
+    }
+    bool changed = !_mm256_testz_si256(diff, diff);
+    return dither_temporal_scalar(dst + i, src + i, prev + i, error + i, count - i) || changed;
+}
+
+AVX2 static void pack_planar_avx2(uint32_t *dst, const uint8_t *r, const uint8_t *g,
+                                  const uint8_t *b, size_t count) {
+    __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    // Same interleave as SSE2 on 32 pixels; unpack works per 128-bit lane,
+    // so o0..o3 hold pixels {0-3,16-19}, {4-7,20-23}, {8-11,24-27}, {12-15,28-31}
+    for (; i + 32 <= count; i += 32) {
+        __m256i vr = _mm256_loadu_si256((const __m256i *)(r + i));
+        __m256i vg = _mm256_loadu_si256((const __m256i *)(g + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i br_lo = _mm256_unpacklo_epi8(vb, vr);
+        __m256i br_hi = _mm256_unpackhi_epi8(vb, vr);
+        __m256i g0_lo = _mm256_unpacklo_epi8(vg, zero);
+        __m256i g0_hi = _mm256_unpackhi_epi8(vg, zero);
+        __m256i o0 = _mm256_unpacklo_epi16(br_lo, g0_lo);
+        __m256i o1 = _mm256_unpackhi_epi16(br_lo, g0_lo);
+        __m256i o2 = _mm256_unpacklo_epi16(br_hi, g0_hi);
+        __m256i o3 = _mm256_unpackhi_epi16(br_hi, g0_hi);
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute2x128_si256(o0, o1, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_permute2x128_si256(o2, o3, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_permute2x128_si256(o0, o1, 0x31));
+        _mm256_storeu_si256((__m256i *)(dst + i + 24), _mm256_permute2x128_si256(o2, o3, 0x31));
+    }
+    pack_planar_sse2(dst + i, r + i, g + i, b + i, count - i);
+}
+
+/**
+ * @brief Reorder 4 pixels per 128-bit lane into 12 wire bytes G, R, B (4 zero bytes)
+ */
+AVX2 static inline __m256i wire_order_avx2(__m256i px) {
+    const __m256i order = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                           2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    return _mm256_shuffle_epi8(px, order);
+}
+
+/**
+ * @brief Load the last count (< 8) pixels zero-padded to a full vector
+ */
+AVX2 static inline __m256i load_tail_avx2(const uint32_t *pixels, size_t count) {
+    uint32_t tail[8] = {0};
+    memcpy(tail, pixels, count * sizeof(uint32_t));
+    return _mm256_loadu_si256((const __m256i *)tail);
+}
+
+/**
+ * @brief Encode 8 pixels to 96 SPI bytes (4-bit encoding)
+ */
+AVX2 static inline void spi4_block_avx2(uint8_t *out, __m256i px) {
+    // A nibble maps to 2 SPI bytes; the pair tables are looked up with pshufb
+    const __m256i first = _mm256_setr_epi8(
+        0x88, 0x88, 0x88, 0x88, 0x8E, 0x8E, 0x8E, 0x8E, 0xE8, 0xE8, 0xE8, 0xE8, 0xEE, 0xEE, 0xEE, 0xEE,
+        0x88, 0x88, 0x88, 0x88, 0x8E, 0x8E, 0x8E, 0x8E, 0xE8, 0xE8, 0xE8, 0xE8, 0xEE, 0xEE, 0xEE, 0xEE);
+    const __m256i second = _mm256_setr_epi8(
+        0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE,
+        0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE, 0x88, 0x8E, 0xE8, 0xEE);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    __m256i grb = wire_order_avx2(px);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(grb, 4), nibble);
+    __m256i lo = _mm256_and_si256(grb, nibble);
+    __m256i hi_a = _mm256_shuffle_epi8(first, hi);
+    __m256i hi_b = _mm256_shuffle_epi8(second, hi);
+    __m256i lo_a = _mm256_shuffle_epi8(first, lo);
+    __m256i lo_b = _mm256_shuffle_epi8(second, lo);
+    __m256i hi_lo8 = _mm256_unpacklo_epi8(hi_a, hi_b);
+    __m256i hi_hi8 = _mm256_unpackhi_epi8(hi_a, hi_b);
+    __m256i lo_lo8 = _mm256_unpacklo_epi8(lo_a, lo_b);
+    __m256i lo_hi8 = _mm256_unpackhi_epi8(lo_a, lo_b);
+    // 4 SPI bytes per data byte; per lane d0..d2 cover data bytes 0-3, 4-7, 8-11
+    __m256i d0 = _mm256_unpacklo_epi16(hi_lo8, lo_lo8);
+    __m256i d1 = _mm256_unpackhi_epi16(hi_lo8, lo_lo8);
+    __m256i d2 = _mm256_unpacklo_epi16(hi_hi8, lo_hi8);
+    _mm256_storeu_si256((__m256i *)out, _mm256_permute2x128_si256(d0, d1, 0x20));
+    _mm_storeu_si128((__m128i *)(out + 32), _mm256_castsi256_si128(d2));
+    _mm256_storeu_si256((__m256i *)(out + 48), _mm256_permute2x128_si256(d0, d1, 0x31));
+    _mm_storeu_si128((__m128i *)(out + 80), _mm256_extracti128_si256(d2, 1));
+}
+
+AVX2 static void encode_spi4_avx2(uint8_t *out, const uint32_t *pixels, size_t count) {
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        spi4_block_avx2(out, _mm256_loadu_si256((const __m256i *)(pixels + i)));
+        out += 96;
+    }
+    // Short tails are frequent when streaming in chunks: pad instead of going scalar
+    if (i < count) {
+        uint8_t block[96];
+        spi4_block_avx2(block, load_tail_avx2(pixels + i, count - i));
+        memcpy(out, block, (count - i) * 12);
+    }
+}
+
+/**
+ * @brief Encode 8 pixels to 72 SPI bytes (3-bit encoding), writing 76 bytes
+ *
+ * Each 16-byte store carries 12 valid bytes and is overwritten by the next
+ * one, so the last store spills 4 bytes past the block.
+ */
+AVX2 static inline void spi3_block_avx2(uint8_t *out, __m256i px) {
+    const __m256i first = _mm256_setr_epi8(
+        0x92, 0x93, 0x9A, 0x9B, 0xD2, 0xD3, 0xDA, 0xDB, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x92, 0x93, 0x9A, 0x9B, 0xD2, 0xD3, 0xDA, 0xDB, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i middle = _mm256_setr_epi8(
+        0x49, 0x4D, 0x69, 0x6D, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x49, 0x4D, 0x69, 0x6D, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i last = _mm256_setr_epi8(
+        0x24, 0x26, 0x34, 0x36, 0xA4, 0xA6, 0xB4, 0xB6, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x24, 0x26, 0x34, 0x36, 0xA4, 0xA6, 0xB4, 0xB6, 0, 0, 0, 0, 0, 0, 0, 0);
+    // Drop the padding byte of every [first, middle, last, 0] group
+    const __m256i squeeze = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                             0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i three = _mm256_set1_epi8(3);
+    const __m256i seven = _mm256_set1_epi8(7);
+    const __m256i zero = _mm256_setzero_si256();
+
+    __m256i grb = wire_order_avx2(px);
+    __m256i a = _mm256_shuffle_epi8(first, _mm256_and_si256(_mm256_srli_epi16(grb, 5), seven));
+    __m256i b = _mm256_shuffle_epi8(middle, _mm256_and_si256(_mm256_srli_epi16(grb, 3), three));
+    __m256i c = _mm256_shuffle_epi8(last, _mm256_and_si256(grb, seven));
+    __m256i ab_lo = _mm256_unpacklo_epi8(a, b);
+    __m256i ab_hi = _mm256_unpackhi_epi8(a, b);
+    __m256i c_lo = _mm256_unpacklo_epi8(c, zero);
+    __m256i c_hi = _mm256_unpackhi_epi8(c, zero);
+    __m256i d0 = _mm256_shuffle_epi8(_mm256_unpacklo_epi16(ab_lo, c_lo), squeeze);
+    __m256i d1 = _mm256_shuffle_epi8(_mm256_unpackhi_epi16(ab_lo, c_lo), squeeze);
+    __m256i d2 = _mm256_shuffle_epi8(_mm256_unpacklo_epi16(ab_hi, c_hi), squeeze);
+    _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(d0));
+    _mm_storeu_si128((__m128i *)(out + 12), _mm256_castsi256_si128(d1));
+    _mm_storeu_si128((__m128i *)(out + 24), _mm256_castsi256_si128(d2));
+    _mm_storeu_si128((__m128i *)(out + 36), _mm256_extracti128_si256(d0, 1));
+    _mm_storeu_si128((__m128i *)(out + 48), _mm256_extracti128_si256(d1, 1));
+    _mm_storeu_si128((__m128i *)(out + 60), _mm256_extracti128_si256(d2, 1));
+}
+
+AVX2 static void encode_spi3_avx2(uint8_t *out, const uint32_t *pixels, size_t count) {
+    size_t i = 0;
+
+    // Keep at least one more pixel after a block to absorb its 4-byte spill
+    for (; i + 9 <= count; i += 8) {
+        spi3_block_avx2(out, _mm256_loadu_si256((const __m256i *)(pixels + i)));
+        out += 72;
+    }
+    if (i < count) {
+        uint8_t block[76];
+        spi3_block_avx2(block, load_tail_avx2(pixels + i, count - i));
+        memcpy(out, block, (count - i) * 9);
+    }
+}
+
+AVX2 static void encode_pwm_avx2(uint16_t *out, const uint32_t *pixels, size_t count,
+                                 uint16_t t0h, uint16_t t1h) {
+    // 2 pixels = 6 data bytes = 3 vectors of 16 duties; bytes B0 R0 G0 - B1 R1 G1 -
+    const __m256i sel0 = _mm256_setr_epi8(2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+                                          1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m256i sel1 = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                          6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6);
+    const __m256i sel2 = _mm256_setr_epi8(5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+                                          4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4);
+    const __m256i bits = _mm256_setr_epi16(0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01,
+                                           0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01);
+    const __m256i v0 = _mm256_set1_epi16((short)t0h);
+    const __m256i diff = _mm256_set1_epi16((short)(t0h ^ t1h));
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m256i px = _mm256_broadcastsi128_si256(_mm_loadl_epi64((const __m128i *)(pixels + i)));
+        __m256i s0 = _mm256_shuffle_epi8(px, sel0);
+        __m256i s1 = _mm256_shuffle_epi8(px, sel1);
+        __m256i s2 = _mm256_shuffle_epi8(px, sel2);
+        __m256i m0 = _mm256_cmpeq_epi16(_mm256_and_si256(s0, bits), bits);
+        __m256i m1 = _mm256_cmpeq_epi16(_mm256_and_si256(s1, bits), bits);
+        __m256i m2 = _mm256_cmpeq_epi16(_mm256_and_si256(s2, bits), bits);
+        _mm256_storeu_si256((__m256i *)out, _mm256_xor_si256(v0, _mm256_and_si256(m0, diff)));
+        _mm256_storeu_si256((__m256i *)(out + 16), _mm256_xor_si256(v0, _mm256_and_si256(m1, diff)));
+        _mm256_storeu_si256((__m256i *)(out + 32), _mm256_xor_si256(v0, _mm256_and_si256(m2, diff)));
+        out += 48;
+    }
+    encode_pwm_scalar(out, pixels + i, count - i, t0h, t1h);
+}
+
+static const led_kernels_t kernels_avx2 = {
+    .level = LED_SIMD_AVX2,
+    .fill = fill_avx2,
+    .copy = copy_any,
+    .scale = scale_avx2,
+    .blend = blend_avx2,
+    .apply_lut = lut_avx2,
+    .pack_planar = pack_planar_avx2,
+    .correct = correct_avx2,
+    .dither_ordered = dither_ordered_avx2,
+    .dither_temporal = dither_temporal_avx2,
+    .encode_spi3 = encode_spi3_avx2,
+    .encode_spi4 = encode_spi4_avx2,
+    .encode_pwm = encode_pwm_avx2
+};
+
+#endif // LED_SIMD_X86
+
+/* ======================== Runtime dispatch ======================== */
+
+// Strips render from many threads; the table pointer is read and published atomically
+static _Atomic(const led_kernels_t *) active_kernels = NULL;
+
+/**
+ * @brief Check whether the CPU can run kernels of the given level
+ */
+static int level_supported(led_simd_level_t level) {
+    switch (level) {
+        case LED_SIMD_SCALAR:
+            return 1;
+#if LED_SIMD_X86
+        case LED_SIMD_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case LED_SIMD_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return 0;
+    }
+}
+
+static const led_kernels_t *kernels_for(led_simd_level_t level) {
+    switch (level) {
+#if LED_SIMD_X86
+        case LED_SIMD_SSE2:
+            return &kernels_sse2;
+        case LED_SIMD_AVX2:
+            return &kernels_avx2;
+#endif
+        default:
+            return &kernels_scalar;
+    }
+}
+
+const led_kernels_t *led_simd_kernels(void) {
+    const led_kernels_t *kernels = atomic_load_explicit(&active_kernels,
+                                                        memory_order_acquire);
+    if (kernels == NULL) {
+        // Every thread computes the same answer, so a lost race is harmless
+        led_simd_level_t level = LED_SIMD_AVX2;
+        while (!level_supported(level)) {
+            level--;
+        }
+        kernels = kernels_for(level);
+        atomic_store_explicit(&active_kernels, kernels, memory_order_release);
+    }
+    return kernels;
+}
+
+led_simd_level_t led_simd_get_level(void) {
+    return led_simd_kernels()->level;
+}
+
+int led_simd_set_level(led_simd_level_t level) {
+    if (level < LED_SIMD_SCALAR || level > LED_SIMD_AVX2 || !level_supported(level)) {
+        return -1;
+    }
+    atomic_store_explicit(&active_kernels, kernels_for(level), memory_order_release);
+    return 0;
+}
+
+const char *led_simd_level_name(led_simd_level_t level) {
+    switch (level) {
+        case LED_SIMD_SCALAR:
+            return "scalar";
+        case LED_SIMD_SSE2:
+            return "sse2";
+        case LED_SIMD_AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file led_simd.h
+ * @brief Internal bulk pixel kernels (scalar, SSE2, AVX2)
+ *
+ * Private to the driver. Each kernel works on a raw 0x00GGRRBB word array
+ * and performs no bounds checking; led_driver.c validates ranges first.
+ */
+
+#ifndef LED_SIMD_H
+#define LED_SIMD_H
+
+#include "led_driver.h"
+#include <stdbool.h>
+
+/**
+ * @brief Table of bulk kernels for one instruction set level
+ */
+typedef struct {
+    led_simd_level_t level;
+    void (*fill)(uint32_t *dst, uint32_t color, size_t count);
+    void (*copy)(uint32_t *dst, const uint32_t *src, size_t count);
+    void (*scale)(uint32_t *dst, size_t count, uint8_t sr, uint8_t sg, uint8_t sb);
+    void (*blend)(uint32_t *dst, const uint32_t *src, size_t count, uint8_t alpha);
+    void (*apply_lut)(uint32_t *dst, size_t count, const uint8_t lut[256]);
+    void (*pack_planar)(uint32_t *dst, const uint8_t *r, const uint8_t *g,
+                        const uint8_t *b, size_t count);
+
+    // Color correction (led_color.h): dst = per-channel lookup of src in a table of
+    // 4 x 256 words pre-shifted to their byte (B, R, G, W); white = 0 skips the W
+    // byte. Returns the change of the sum of all dst bytes, for power estimation.
+    int64_t (*correct)(uint32_t *dst, const uint32_t *src, size_t count,
+                       const uint32_t table[1024], bool white);
+
+    // 16 to 8 bits per channel (RGBW64 strips): src lanes B, R, G, W become the
+    // bytes of dst. A lane v is v - (v >> 8) in 1/256 levels; ordered adds
+    // pattern[((phase + i) % 16) * 4 + lane] (128 entries, the 16-pixel pattern
+    // twice) and truncates. Temporal adds the remainder bytes kept in error[]
+    // instead, stores the new remainder and returns whether any dst word
+    // differs from prev (which may be dst).
+    void (*dither_ordered)(uint32_t *dst, const uint64_t *src, size_t count,
+                           const uint16_t pattern[128], size_t phase);
+    bool (*dither_temporal)(uint32_t *dst, const uint64_t *src, const uint32_t *prev,
+                            uint32_t *error, size_t count);
+
+    // WS2812B wire encoders (see led_encoder.h); output is G, R, B, MSB first
+    void (*encode_spi3)(uint8_t *out, const uint32_t *pixels, size_t count);   // 9 bytes / pixel
+    void (*encode_spi4)(uint8_t *out, const uint32_t *pixels, size_t count);   // 12 bytes / pixel
+    void (*encode_pwm)(uint16_t *out, const uint32_t *pixels, size_t count,
+                       uint16_t t0h, uint16_t t1h);                            // 24 duties / pixel
+} led_kernels_t;
+
+/**
+ * @brief Blend weight in 1/256 units: 0 -> 0, 255 -> 256 (exact endpoints)
+ */
+static inline uint32_t led_blend_weight(uint8_t alpha) {
+    return (uint32_t)alpha + (alpha >> 7);
+}
+
+/**
+ * @brief Get the kernels for the active SIMD level
+ *
+ * The first call selects the best level supported by the CPU. Safe to
+ * call from several threads.
+ */
+const led_kernels_t *led_simd_kernels(void);
+
+#endif // LED_SIMD_H
@@ -4,6 +4,10 @@
  */
 
 #include "led_driver.h"
+#include "led_encoder.h"
+#include "led_effect.h"
+#include "led_matrix.h"
+#include "led_record.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -215,22 +219,1307 @@ void test_color_constants(void) {
 void test_rainbow_pattern(void) {
     print_test_header("Rainbow Pattern Demo");
     
-    // Create a simple rainbow pattern
-    led_set_pixel_color(0, 255, 0, 0);     // Red
-    led_set_pixel_color(1, 255, 127, 0);   // Orange
-    led_set_pixel_color(2, 255, 255, 0);   // Yellow
-    led_set_pixel_color(3, 0, 255, 0);     // Green
-    led_set_pixel_color(4, 0, 255, 127);   // Cyan-ish
-    led_set_pixel_color(5, 0, 255, 255);   // Cyan
-    led_set_pixel_color(6, 0, 127, 255);   // Sky blue
-    led_set_pixel_color(7, 0, 0, 255);     // Blue
-    led_set_pixel_color(8, 127, 0, 255);   // Purple
-    led_set_pixel_color(9, 255, 0, 255);   // Magenta
+    // One hue cycle across the strip, rendered by the effect engine at t = 0
+    led_scene_t *scene = led_scene_create(led_get_pixel_count());
+    led_effect_config_t rainbow = { .type = LED_EFFECT_RAINBOW };
+    led_scene_add_layer(scene, &rainbow, LED_BLEND_NORMAL, 255);
+    led_scene_render_to(scene, led_get_default_strip(), 0);
+    led_scene_destroy(scene);
+    
+    assert_equal_uint32("Pixel 0 is red", LED_COLOR_RED, led_get_pixel(0));
+    assert_equal_uint32("Pixel 5 is cyan", LED_COLOR_CYAN, led_get_pixel(5));
     
     printf("\nRainbow pattern created:\n");
     led_print_buffer();
 }
 
+/**
+ * @brief Test 8: Dirty-region tracking and incremental commit
+ */
+void test_dirty_tracking(void) {
+    print_test_header("Dirty Tracking & Incremental Commit");
+    
+    led_frame_t frame;
+    
+    // Flush everything written by the previous tests
+    led_commit(&frame);
+    uint32_t first_sequence = frame.sequence;
+    assert_equal_uint32("Nothing dirty after commit", 0, (uint32_t)led_get_dirty_count());
+    
+    // Pixels 2-3 become one span, pixel 7 another
+    led_set_pixel_color(2, 10, 20, 30);
+    led_set_pixel_color(3, 10, 20, 30);
+    led_set_pixel_color(7, 40, 50, 60);
+    int spans = led_commit(&frame);
+    assert_equal_uint32("Two dirty spans", 2, (uint32_t)spans);
+    assert_equal_uint32("Span[0] start", 2, (uint32_t)frame.spans[0].start);
+    assert_equal_uint32("Span[0] count", 2, (uint32_t)frame.spans[0].count);
+    assert_equal_uint32("Span[1] start", 7, (uint32_t)frame.spans[1].start);
+    assert_equal_uint32("Span[1] count", 1, (uint32_t)frame.spans[1].count);
+    assert_equal_uint32("Dirty pixel total", 3, (uint32_t)frame.dirty_pixels);
+    assert_equal_uint32("Sequence incremented", first_sequence + 1, frame.sequence);
+    assert_equal_uint32("Span data readable", led_get_pixel(7),
+                        frame.buffer[frame.spans[1].start]);
+    
+    // Rewriting the same color does not mark the pixel dirty
+    led_set_pixel_color(7, 40, 50, 60);
+    spans = led_commit(&frame);
+    assert_equal_uint32("Unchanged write stays clean", 0, (uint32_t)spans);
+    assert_equal_uint32("Empty commit still sequenced", first_sequence + 2, frame.sequence);
+    
+    // Touching spans are coalesced: 5, then 4 and 6 join into [4, 7)
+    led_set_pixel_color(5, 1, 1, 1);
+    led_set_pixel_color(4, 1, 1, 1);
+    led_set_pixel_color(6, 1, 1, 1);
+    spans = led_commit(&frame);
+    assert_equal_uint32("Adjacent pixels coalesced", 1, (uint32_t)spans);
+    assert_equal_uint32("Coalesced span start", 4, (uint32_t)frame.spans[0].start);
+    assert_equal_uint32("Coalesced span count", 3, (uint32_t)frame.spans[0].count);
+    
+    // Fill marks the whole strip
+    led_fill(0, 0, 1);
+    spans = led_commit(&frame);
+    assert_equal_uint32("Fill marks full strip", 10, (uint32_t)frame.dirty_pixels);
+    
+    led_mark_all_dirty();
+    assert_equal_uint32("Mark all dirty", 10, (uint32_t)led_get_dirty_count());
+    led_commit(&frame);
+}
+
+/**
+ * @brief Test 9: Span list overflow on a long, sparsely updated strip
+ */
+void test_dirty_span_limit(void) {
+    print_test_header("Dirty Span Limit (1000 pixels)");
+    
+    led_frame_t frame;
+    
+    led_shutdown();
+    led_init(1000);
+    int spans = led_commit(&frame);
+    assert_equal_uint32("First commit covers strip", 1, (uint32_t)spans);
+    assert_equal_uint32("First commit pixels", 1000, (uint32_t)frame.dirty_pixels);
+    assert_equal_uint32("First sequence is 1", 1, frame.sequence);
+    
+    // 20 isolated pixels, every 50th, with one closer pair at 500/502
+    for (size_t i = 0; i < 20; i++) {
+        led_set_pixel_color(i * 50, 255, 255, 255);
+    }
+    led_set_pixel_color(502, 255, 255, 255);
+    spans = led_commit(&frame);
+    assert_equal_uint32("Spans capped at limit", LED_MAX_DIRTY_SPANS, (uint32_t)spans);
+    
+    // Every modified pixel must still be covered, in sorted order
+    bool covered = true;
+    bool sorted = true;
+    for (size_t i = 0; i < 20; i++) {
+        size_t index = i * 50;
+        bool found = false;
+        for (size_t s = 0; s < frame.num_spans; s++) {
+            if (index >= frame.spans[s].start &&
+                index < frame.spans[s].start + frame.spans[s].count) {
+                found = true;
+            }
+        }
+        covered = covered && found;
+    }
+    for (size_t s = 1; s < frame.num_spans; s++) {
+        if (frame.spans[s].start <= frame.spans[s - 1].start + frame.spans[s - 1].count) {
+            sorted = false;
+        }
+    }
+    assert_equal_uint32("All changes covered", 1, covered);
+    assert_equal_uint32("Spans sorted and disjoint", 1, sorted);
+    printf("  Sent %zu of 1000 pixels in %zu spans\n",
+           frame.dirty_pixels, frame.num_spans);
+}
+
+/**
+ * @brief Run a fixed sequence of bulk operations and hash the result
+ *
+ * Offsets and lengths are odd on purpose so every SIMD kernel also
+ * exercises its scalar tail.
+ */
+static uint32_t run_bulk_sequence(size_t count) {
+    uint8_t r[1003], g[1003], b[1003], lut[256];
+    uint32_t src[1003];
+    
+    for (size_t i = 0; i < count; i++) {
+        r[i] = (uint8_t)(i * 7);
+        g[i] = (uint8_t)(i * 13 + 5);
+        b[i] = (uint8_t)(i * 29 + 1);
+        src[i] = ((uint32_t)b[i] << 16) | ((uint32_t)g[i] << 8) | r[i];
+    }
+    for (int v = 0; v < 256; v++) {
+        lut[v] = (uint8_t)((v * v) / 255);
+    }
+    
+    led_pack_planar(0, r, g, b, count);
+    led_scale_range(3, count - 5, 200, 100, 37);
+    led_blend_range(1, src, count - 2, 77);
+    led_apply_lut(2, count - 3, lut);
+    led_fill_range(count - 20, 13, 9, 8, 7);
+    led_copy_range(11, src + 100, 101);
+    
+    // FNV-1a over the whole buffer
+    const uint32_t *buffer = led_get_buffer();
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; i++) {
+        hash = (hash ^ buffer[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Test 10: Bulk operations, exact values and SIMD vs scalar
+ */
+void test_bulk_operations(void) {
+    print_test_header("Bulk Operations & SIMD Dispatch");
+    
+    led_shutdown();
+    led_init(1003);
+    led_simd_level_t best = led_simd_get_level();
+    printf("  Best SIMD level: %s\n", led_simd_level_name(best));
+    
+    // Exact values on the scalar path
+    led_simd_set_level(LED_SIMD_SCALAR);
+    uint8_t r = 255, g = 128, b = 64;
+    led_pack_planar(0, &r, &g, &b, 1);
+    assert_equal_uint32("Pack planar -> GRB", 0x0080FF40, led_get_pixel(0));
+    led_scale_range(0, 1, 255, 255, 255);
+    assert_equal_uint32("Scale 255 keeps color", 0x0080FF40, led_get_pixel(0));
+    led_scale_range(0, 1, 0, 255, 128);
+    assert_equal_uint32("Scale per channel", 0x00800020, led_get_pixel(0));
+    
+    uint32_t white = LED_COLOR_WHITE;
+    led_fill_range(0, 1, 0, 0, 0);
+    led_blend_range(0, &white, 1, 0);
+    assert_equal_uint32("Blend alpha 0 keeps strip", 0x00000000, led_get_pixel(0));
+    led_blend_range(0, &white, 1, 255);
+    assert_equal_uint32("Blend alpha 255 copies src", 0x00FFFFFF, led_get_pixel(0));
+    
+    // Clipping: a range running past the end only touches the last pixel
+    led_fill_range(1002, 50, 255, 0, 0);
+    assert_equal_uint32("Range clipped to strip", LED_COLOR_RED, led_get_pixel(1002));
+    
+    // Every SIMD level must produce exactly the scalar result
+    led_simd_set_level(LED_SIMD_SCALAR);
+    uint32_t reference = run_bulk_sequence(1003);
+    for (int level = LED_SIMD_SSE2; level <= LED_SIMD_AVX2; level++) {
+        char name[48];
+        if (led_simd_set_level((led_simd_level_t)level) != 0) {
+            printf("  - %s not supported, skipped\n",
+                   led_simd_level_name((led_simd_level_t)level));
+            continue;
+        }
+        snprintf(name, sizeof(name), "%s matches scalar",
+                 led_simd_level_name((led_simd_level_t)level));
+        assert_equal_uint32(name, reference, run_bulk_sequence(1003));
+    }
+    led_simd_set_level(best);
+}
+
+/**
+ * @brief Test 11: Independent strip instances next to the default strip
+ */
+void test_multi_strip(void) {
+    print_test_header("Multi-Strip Instances");
+    
+    led_strip_t *a = led_strip_create(8);
+    led_strip_t *b = led_strip_create(300);
+    led_frame_t frame;
+    
+    assert_equal_uint32("Strip A created", 1, a != NULL);
+    assert_equal_uint32("Strip B created", 1, b != NULL);
+    assert_equal_uint32("Zero-pixel strip rejected", 1, led_strip_create(0) == NULL);
+    
+    uint32_t default_before = led_get_pixel(0);
+    led_strip_fill(a, 255, 0, 0);
+    led_strip_set_pixel_color(b, 299, 0, 0, 255);
+    
+    assert_equal_uint32("Strip A filled", LED_COLOR_RED, led_strip_get_pixel(a, 7));
+    assert_equal_uint32("Strip B untouched by A", LED_COLOR_BLACK, led_strip_get_pixel(b, 7));
+    assert_equal_uint32("Strip B pixel", LED_COLOR_BLUE, led_strip_get_pixel(b, 299));
+    assert_equal_uint32("Default strip untouched", default_before, led_get_pixel(0));
+    assert_equal_uint32("Strip A bounds", 0, led_strip_get_pixel(a, 8));
+    
+    // Sequence numbers are per strip
+    led_strip_commit(a, &frame);
+    led_strip_commit(a, &frame);
+    assert_equal_uint32("Strip A sequence", 2, frame.sequence);
+    led_strip_commit(b, &frame);
+    assert_equal_uint32("Strip B sequence", 1, frame.sequence);
+    
+    // The default instance is a strip like any other
+    assert_equal_uint32("Default strip handle", 1,
+                        led_strip_get_buffer(led_get_default_strip()) == led_get_buffer());
+    
+    led_strip_destroy(a);
+    led_strip_destroy(b);
+}
+
+/**
+ * @brief Apply the spans of a frame to a consumer-side copy of the strip
+ */
+static void mirror_frame(uint32_t *mirror, const led_frame_t *frame) {
+    for (size_t i = 0; i < frame->num_spans; i++) {
+        memcpy(mirror + frame->spans[i].start, frame->buffer + frame->spans[i].start,
+               frame->spans[i].count * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Test 12: Double/triple buffering, present and acquire
+ */
+void test_frame_buffering(void) {
+    print_test_header("Double & Triple Buffering");
+    
+    led_strip_t *strip = led_strip_create(64);
+    uint32_t mirror[64] = {0};
+    const led_frame_t *frame;
+    
+    assert_equal_uint32("Present needs buffering", (uint32_t)-1,
+                        (uint32_t)led_strip_present(strip));
+    assert_equal_uint32("Triple buffering enabled", 0,
+                        (uint32_t)led_strip_set_buffering(strip, LED_BUFFER_TRIPLE));
+    
+    led_strip_set_pixel_color(strip, 3, 255, 0, 0);
+    led_strip_present(strip);
+    frame = led_strip_acquire_frame(strip);
+    assert_equal_uint32("First frame acquired", 1, frame != NULL);
+    assert_equal_uint32("First frame sequence", 1, frame->sequence);
+    assert_equal_uint32("First frame covers strip", 64, (uint32_t)frame->dirty_pixels);
+    mirror_frame(mirror, frame);
+    
+    // Keep rendering while the consumer holds frame 1: no blocking, no tearing
+    led_strip_fill(strip, 0, 0, 255);
+    led_strip_present(strip);
+    led_strip_set_pixel_color(strip, 0, 0, 255, 0);
+    led_strip_present(strip);
+    assert_equal_uint32("Held frame not torn", LED_COLOR_RED, frame->buffer[3]);
+    assert_equal_uint32("Render buffer keeps latest", LED_COLOR_BLUE,
+                        led_strip_get_pixel(strip, 3));
+    assert_equal_uint32("Second acquire while held", 1,
+                        led_strip_acquire_frame(strip) == NULL);
+    led_strip_release_frame(strip);
+    
+    frame = led_strip_acquire_frame(strip);
+    assert_equal_uint32("Skipped to newest frame", 3, frame->sequence);
+    assert_equal_uint32("Newest frame content", LED_COLOR_GREEN, frame->buffer[0]);
+    assert_equal_uint32("Skipped frame spans merged", 64, (uint32_t)frame->dirty_pixels);
+    mirror_frame(mirror, frame);
+    led_strip_release_frame(strip);
+    assert_equal_uint32("No new frame", 1, led_strip_acquire_frame(strip) == NULL);
+    
+    // Sparse updates, consumer only sees every third frame: spans must
+    // still bring its copy in sync with the strip
+    for (uint32_t f = 0; f < 30; f++) {
+        led_strip_set_pixel_color(strip, (f * 7) % 64, (uint8_t)f, 1, 2);
+        led_strip_present(strip);
+        if (f % 3 == 2) {
+            frame = led_strip_acquire_frame(strip);
+            mirror_frame(mirror, frame);
+            led_strip_release_frame(strip);
+        }
+    }
+    assert_equal_uint32("Triple: consumer copy in sync", 0,
+                        (uint32_t)memcmp(mirror, led_strip_get_buffer(strip), sizeof(mirror)));
+    
+    // Double buffering: same protocol, present alternates two buffers
+    assert_equal_uint32("Double buffering enabled", 0,
+                        (uint32_t)led_strip_set_buffering(strip, LED_BUFFER_DOUBLE));
+    for (uint32_t f = 0; f < 10; f++) {
+        led_strip_set_pixel_color(strip, (f * 11) % 64, 9, (uint8_t)f, 9);
+        led_strip_present(strip);
+        if (f % 2 == 1) {
+            frame = led_strip_acquire_frame(strip);
+            mirror_frame(mirror, frame);
+            led_strip_release_frame(strip);
+        }
+    }
+    assert_equal_uint32("Double: consumer copy in sync", 0,
+                        (uint32_t)memcmp(mirror, led_strip_get_buffer(strip), sizeof(mirror)));
+    
+    led_strip_destroy(strip);
+}
+
+/**
+ * @brief First 4 bytes of an encoded buffer, big-endian
+ */
+static uint32_t wire_word(const uint8_t *bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+           ((uint32_t)bytes[2] << 8) | bytes[3];
+}
+
+/**
+ * @brief Encode a frame through the streaming API in chunks of chunk bytes
+ */
+static size_t encode_in_chunks(const led_encoder_t *enc, const uint32_t *pixels,
+                               size_t count, uint8_t *out, size_t chunk) {
+    led_encode_stream_t stream;
+    size_t total = 0;
+    size_t n;
+    
+    led_encode_stream_begin(&stream, enc, pixels, count);
+    while ((n = led_encode_stream_next(&stream, out + total, chunk)) > 0) {
+        total += n;
+    }
+    return total;
+}
+
+/**
+ * @brief Test 13: WS2812B waveform encoder against the timing decoder
+ */
+void test_waveform_encoder(void) {
+    print_test_header("WS2812B Waveform Encoder");
+    
+    static const led_encoder_config_t configs[] = {
+        { LED_ENCODE_SPI_3BIT, 2400000, 0, NULL },
+        { LED_ENCODE_SPI_4BIT, 3200000, 0, NULL },
+        { LED_ENCODE_PWM, 72000000, 0, NULL }
+    };
+    static const char *names[] = { "SPI 3-bit", "SPI 4-bit", "PWM" };
+    led_simd_level_t best = led_simd_get_level();
+    uint32_t pixels[1003];
+    uint32_t decoded[1003];
+    uint32_t seed = 12345;
+    led_encoder_t enc;
+    uint8_t one[LED_ENCODE_MAX_PIXEL_BYTES + 1024];
+    
+    for (size_t i = 0; i < 1003; i++) {
+        seed = seed * 1103515245u + 12345u;
+        pixels[i] = (seed >> 8) & 0x00FFFFFF;
+    }
+    
+    // Known bit patterns: G = 0xFF, R = 0x00, B = 0x81
+    uint32_t pixel = 0x00FF0081;
+    led_encoder_init(&enc, &configs[1]);
+    led_encode(&enc, &pixel, 1, one, sizeof(one));
+    assert_equal_uint32("SPI 4-bit green 0xFF", 0xEEEEEEEE, wire_word(one));
+    assert_equal_uint32("SPI 4-bit red 0x00", 0x88888888, wire_word(one + 4));
+    assert_equal_uint32("SPI 4-bit blue 0x81", 0xE888888E, wire_word(one + 8));
+    assert_equal_uint32("SPI 4-bit latch bytes", 120, (uint32_t)enc.reset_bytes);
+    
+    led_encoder_init(&enc, &configs[0]);
+    led_encode(&enc, &pixel, 1, one, sizeof(one));
+    assert_equal_uint32("SPI 3-bit green 0xFF", 0xDB6DB6, wire_word(one) >> 8);
+    assert_equal_uint32("SPI 3-bit red 0x00", 0x924924, wire_word(one + 3) >> 8);
+    assert_equal_uint32("SPI 3-bit blue 0x81", 0xD24926, wire_word(one + 6) >> 8);
+    
+    led_encoder_init(&enc, &configs[2]);
+    assert_equal_uint32("PWM period/T0H/T1H at 72 MHz", (90u << 16) | (29u << 8) | 58u,
+                        ((uint32_t)enc.pwm_period << 16) | ((uint32_t)enc.pwm_t0h << 8) |
+                        enc.pwm_t1h);
+    
+    // Every encoding, every SIMD level, whole frame and streamed
+    for (size_t c = 0; c < 3; c++) {
+        char name[64];
+        led_decode_report_t report;
+        
+        led_encoder_init(&enc, &configs[c]);
+        size_t size = led_encoded_size(&enc, 1003);
+        uint8_t *ref = malloc(size);
+        uint8_t *out = malloc(size);
+        
+        led_simd_set_level(LED_SIMD_SCALAR);
+        led_encode(&enc, pixels, 1003, ref, size);
+        for (int level = LED_SIMD_SSE2; level <= LED_SIMD_AVX2; level++) {
+            if (led_simd_set_level((led_simd_level_t)level) != 0) {
+                continue;
+            }
+            memset(out, 0xA5, size);
+            led_encode(&enc, pixels, 1003, out, size);
+            snprintf(name, sizeof(name), "%s %s matches scalar", names[c],
+                     led_simd_level_name((led_simd_level_t)level));
+            assert_equal_uint32(name, 0, (uint32_t)memcmp(ref, out, size));
+        }
+        led_simd_set_level(best);
+        
+        int count = led_decode(&enc, ref, size, NULL, decoded, 1003, &report);
+        snprintf(name, sizeof(name), "%s decoded pixels", names[c]);
+        assert_equal_uint32(name, 1003, (uint32_t)count);
+        snprintf(name, sizeof(name), "%s timing errors", names[c]);
+        assert_equal_uint32(name, 0, (uint32_t)report.timing_errors);
+        snprintf(name, sizeof(name), "%s latched, pixels intact", names[c]);
+        assert_equal_uint32(name, 1, report.latched &&
+                            memcmp(decoded, pixels, sizeof(pixels)) == 0);
+        
+        snprintf(name, sizeof(name), "%s streamed in 7-byte chunks", names[c]);
+        memset(out, 0xA5, size);
+        assert_equal_uint32(name, 1, encode_in_chunks(&enc, pixels, 1003, out, 7) == size &&
+                            memcmp(ref, out, size) == 0);
+        snprintf(name, sizeof(name), "%s streamed in 4 KB chunks", names[c]);
+        memset(out, 0xA5, size);
+        assert_equal_uint32(name, 1, encode_in_chunks(&enc, pixels, 1003, out, 4096) == size &&
+                            memcmp(ref, out, size) == 0);
+        
+        free(ref);
+        free(out);
+    }
+    
+    // The decoder must catch broken waveforms
+    led_decode_report_t report;
+    led_encoder_init(&enc, &configs[1]);
+    size_t size = led_encoded_size(&enc, 1003);
+    uint8_t *buf = malloc(size);
+    led_encode(&enc, pixels, 1003, buf, size);
+    buf[10 * 12 + 5] = 0xFF;    // Merges two LED bits of pixel 10 into one long pulse
+    led_decode(&enc, buf, size, NULL, NULL, 0, &report);
+    assert_equal_uint32("Corrupted pulse detected", 1, report.timing_errors > 0);
+    assert_equal_uint32("Error located in pixel 10", 10, (uint32_t)(report.first_error_bit / 24));
+    led_encode(&enc, pixels, 1003, buf, size);
+    led_decode(&enc, buf, size - enc.reset_bytes + 4, NULL, NULL, 0, &report);
+    assert_equal_uint32("Truncated latch detected", 0, report.latched);
+    free(buf);
+    
+    // Clocks giving out-of-spec pulses are rejected
+    led_encoder_config_t bad = { LED_ENCODE_SPI_3BIT, 4000000, 0, NULL };
+    assert_equal_uint32("SPI 3-bit at 4 MHz rejected", (uint32_t)-1,
+                        (uint32_t)led_encoder_init(&enc, &bad));
+    bad.encoding = LED_ENCODE_SPI_4BIT;
+    bad.clock_hz = 2000000;
+    assert_equal_uint32("SPI 4-bit at 2 MHz rejected", (uint32_t)-1,
+                        (uint32_t)led_encoder_init(&enc, &bad));
+    bad.clock_hz = 3200000;
+    bad.reset_us = 50;
+    assert_equal_uint32("50 us latch rejected", (uint32_t)-1,
+                        (uint32_t)led_encoder_init(&enc, &bad));
+}
+
+/**
+ * @brief Run the same bulk operations on a strip; returns the unpacked pixels
+ */
+static void run_format_sequence(led_strip_t *strip, uint32_t *out, size_t count) {
+    uint8_t r[200], g[200], b[200], lut[256];
+    uint32_t src[200];
+    
+    for (size_t i = 0; i < count; i++) {
+        r[i] = (uint8_t)(i * 7);
+        g[i] = (uint8_t)(i * 13 + 5);
+        b[i] = (uint8_t)(i * 29 + 1);
+        src[i] = ((uint32_t)b[i] << 16) | ((uint32_t)g[i] << 8) | r[i];
+    }
+    for (int v = 0; v < 256; v++) {
+        lut[v] = (uint8_t)((v * v) / 255);
+    }
+    
+    led_strip_pack_planar(strip, 0, r, g, b, count);
+    led_strip_scale_range(strip, 3, count - 5, 200, 100, 37);
+    led_strip_blend_range(strip, 1, src, count - 2, 77);
+    led_strip_apply_lut(strip, 2, count - 3, lut);
+    led_strip_fill_range(strip, count - 20, 13, 9, 8, 7);
+    led_strip_copy_range(strip, 11, src + 100, 50);
+    led_strip_set_pixel_color(strip, 7, 1, 2, 3);
+    led_strip_unpack_pixels(strip, NULL, 0, out, count);
+}
+
+/**
+ * @brief Test 14: Compact pixel formats
+ */
+void test_pixel_formats(void) {
+    print_test_header("Pixel Formats");
+    
+    static const uint32_t expected_orange[] = {
+        0x0080FF00,     // GRB32
+        0x0080FF00,     // GRB24
+        0x0080FF00,     // RGBW32
+        0x0082FF00,     // RGB565: G 128 -> 32/63 -> 130
+        0x0091FF00,     // PAL8 default 3-3-2 palette: G -> 145
+        0x0080FF00      // RGBW64
+    };
+    uint32_t reference[200];
+    uint32_t result[200];
+    char name[64];
+    
+    led_strip_t *ref = led_strip_create(200);
+    run_format_sequence(ref, reference, 200);
+    
+    for (int f = LED_FORMAT_GRB32; f <= LED_FORMAT_RGBW64; f++) {
+        led_pixel_format_t format = (led_pixel_format_t)f;
+        led_strip_t *strip = led_strip_create_format(200, format);
+        
+        snprintf(name, sizeof(name), "%s bytes per pixel", led_format_name(format));
+        assert_equal_uint32(name, f == LED_FORMAT_GRB24 ? 3 : f == LED_FORMAT_RGB565 ? 2 :
+                            f == LED_FORMAT_PAL8 ? 1 : f == LED_FORMAT_RGBW64 ? 8 : 4,
+                            (uint32_t)led_format_bytes_per_pixel(format));
+        
+        led_strip_set_pixel_color(strip, 5, 255, 128, 0);
+        snprintf(name, sizeof(name), "%s stores orange", led_format_name(format));
+        assert_equal_uint32(name, expected_orange[f], led_strip_get_pixel(strip, 5));
+        
+        // Lossless formats must match the GRB32 SIMD kernels bit for bit
+        if (f == LED_FORMAT_GRB24 || f == LED_FORMAT_RGBW32) {
+            run_format_sequence(strip, result, 200);
+            snprintf(name, sizeof(name), "%s bulk ops match grb32", led_format_name(format));
+            assert_equal_uint32(name, 0, (uint32_t)memcmp(reference, result, sizeof(result)));
+        }
+        led_strip_destroy(strip);
+    }
+    led_strip_destroy(ref);
+    
+    // Word access only for 32-bit formats; memory follows the format
+    led_strip_t *grb24 = led_strip_create_format(1000, LED_FORMAT_GRB24);
+    led_strip_t *grb32 = led_strip_create(1000);
+    assert_equal_uint32("GRB24 has no word buffer", 1, led_strip_get_buffer(grb24) == NULL);
+    assert_equal_uint32("GRB24 saves 1000 bytes", 1000,
+                        (uint32_t)(led_strip_get_memory(grb32) - led_strip_get_memory(grb24)));
+    
+    // Buffered frames of compact formats are read through frame->data
+    const led_frame_t *frame;
+    uint32_t pixel;
+    led_strip_set_buffering(grb24, LED_BUFFER_TRIPLE);
+    led_strip_set_pixel_color(grb24, 999, 1, 2, 3);
+    led_strip_present(grb24);
+    frame = led_strip_acquire_frame(grb24);
+    led_strip_unpack_pixels(grb24, frame->data, 999, &pixel, 1);
+    assert_equal_uint32("GRB24 frame data", 0x00020103, pixel);
+    assert_equal_uint32("GRB24 frame format", LED_FORMAT_GRB24, frame->format);
+    led_strip_release_frame(grb24);
+    led_strip_destroy(grb24);
+    led_strip_destroy(grb32);
+    
+    // RGBW: white channel is stored and scaled with the smallest factor
+    led_strip_t *rgbw = led_strip_create_format(8, LED_FORMAT_RGBW32);
+    led_strip_set_pixel_rgbw(rgbw, 1, 10, 20, 30, 200);
+    assert_equal_uint32("RGBW pixel", 0xC8140A1E, led_strip_get_pixel(rgbw, 1));
+    led_strip_scale_range(rgbw, 0, 8, 255, 255, 128);
+    assert_equal_uint32("RGBW scaled white", 0x64140A0F, led_strip_get_pixel(rgbw, 1));
+    led_strip_destroy(rgbw);
+    
+    // PAL8: nearest palette color, direct indices, scale through the palette
+    static const uint32_t palette[] = {
+        LED_COLOR_BLACK, LED_COLOR_RED, LED_COLOR_GREEN, LED_COLOR_BLUE
+    };
+    led_strip_t *pal = led_strip_create_format(16, LED_FORMAT_PAL8);
+    assert_equal_uint32("Palette accepted", 0, (uint32_t)led_strip_set_palette(pal, palette, 4));
+    led_strip_set_pixel_color(pal, 0, 250, 10, 0);
+    led_strip_set_pixel_index(pal, 1, 3);
+    led_strip_set_pixel_index(pal, 2, 9);
+    assert_equal_uint32("Nearest palette color", LED_COLOR_RED, led_strip_get_pixel(pal, 0));
+    assert_equal_uint32("Palette index", LED_COLOR_BLUE, led_strip_get_pixel(pal, 1));
+    assert_equal_uint32("Index past palette ignored", LED_COLOR_BLACK,
+                        led_strip_get_pixel(pal, 2));
+    led_strip_scale_range(pal, 0, 16, 0, 0, 0);
+    assert_equal_uint32("Scaled to black", LED_COLOR_BLACK, led_strip_get_pixel(pal, 1));
+    led_strip_t *words = led_strip_create(16);
+    assert_equal_uint32("Palette rejected on GRB32", (uint32_t)-1,
+                        (uint32_t)led_strip_set_palette(words, palette, 4));
+    led_strip_destroy(words);
+    led_strip_destroy(pal);
+}
+
+/**
+ * @brief Count the non-black pixels of a rendered frame
+ */
+static size_t count_lit(const uint32_t *pixels, size_t count) {
+    size_t lit = 0;
+    for (size_t i = 0; i < count; i++) {
+        lit += pixels[i] != 0;
+    }
+    return lit;
+}
+
+/**
+ * @brief Build a one-layer scene with a solid color (fade between equal colors)
+ */
+static led_scene_t *solid_scene(size_t count, uint32_t color) {
+    led_scene_t *scene = led_scene_create(count);
+    led_effect_config_t solid = { .type = LED_EFFECT_FADE, .color = color, .color2 = color };
+    led_scene_add_layer(scene, &solid, LED_BLEND_NORMAL, 255);
+    return scene;
+}
+
+/**
+ * @brief Blend a solid layer onto a solid scene and return pixel 0
+ */
+static uint32_t blend_solid(uint32_t base, uint32_t top, led_blend_mode_t mode,
+                            uint8_t opacity) {
+    led_scene_t *scene = solid_scene(4, base);
+    led_effect_config_t solid = { .type = LED_EFFECT_FADE, .color = top, .color2 = top };
+    led_scene_add_layer(scene, &solid, mode, opacity);
+    uint32_t result = led_scene_render(scene, 0)[0];
+    led_scene_destroy(scene);
+    return result;
+}
+
+/**
+ * @brief Test 15: Effect engine, keyframe tracks and layer blending
+ */
+void test_effects(void) {
+    print_test_header("Effect Engine");
+    
+    // Rainbow scrolls half a hue cycle in half a period
+    led_scene_t *scene = led_scene_create(12);
+    led_effect_config_t rainbow = { .type = LED_EFFECT_RAINBOW, .period_ms = 1000, .length = 12 };
+    led_scene_add_layer(scene, &rainbow, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Rainbow pixel 6 at 0 ms", LED_COLOR_CYAN, led_scene_render(scene, 0)[6]);
+    assert_equal_uint32("Rainbow pixel 0 at 500 ms", LED_COLOR_CYAN, led_scene_render(scene, 500)[0]);
+    assert_equal_uint32("Rainbow wraps after a period", LED_COLOR_RED,
+                        led_scene_render(scene, 3000)[0]);
+    led_scene_destroy(scene);
+    
+    // Chase: 2 lit pixels every 5, one pixel forward per fifth of the period
+    scene = led_scene_create(12);
+    led_effect_config_t chase = { .type = LED_EFFECT_CHASE, .period_ms = 500,
+                                  .color = LED_COLOR_RED, .color2 = LED_COLOR_BLUE,
+                                  .length = 2, .spacing = 5 };
+    led_scene_add_layer(scene, &chase, LED_BLEND_NORMAL, 255);
+    const uint32_t *px = led_scene_render(scene, 0);
+    uint32_t lit_mask = 0;
+    for (int i = 0; i < 12; i++) {
+        lit_mask |= (uint32_t)(px[i] == LED_COLOR_RED) << i;
+    }
+    assert_equal_uint32("Chase at 0 ms lights pixels 0,1,5,6,10,11", 0xC63, lit_mask);
+    px = led_scene_render(scene, 100);
+    assert_equal_uint32("Chase at 100 ms: pixel 0 background", LED_COLOR_BLUE, px[0]);
+    assert_equal_uint32("Chase at 100 ms: pixel 2 lit", LED_COLOR_RED, px[2]);
+    px = led_scene_render(scene, 400);
+    assert_equal_uint32("Chase at 400 ms: segment wraps onto pixel 0", LED_COLOR_RED, px[0]);
+    led_scene_destroy(scene);
+    
+    // Fade: triangle between the two colors
+    scene = led_scene_create(4);
+    led_effect_config_t fade = { .type = LED_EFFECT_FADE, .period_ms = 1000,
+                                 .color = LED_COLOR_RED, .color2 = LED_COLOR_BLUE };
+    led_scene_add_layer(scene, &fade, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Fade at 0 ms", LED_COLOR_RED, led_scene_render(scene, 0)[3]);
+    assert_equal_uint32("Fade at 250 ms", 0x0000807F, led_scene_render(scene, 250)[3]);
+    assert_equal_uint32("Fade at 500 ms", LED_COLOR_BLUE, led_scene_render(scene, 500)[3]);
+    led_scene_destroy(scene);
+    
+    // Keyframes: linear between points, hold or loop after the last one
+    led_keyframe_t track[] = {
+        { 0, LED_COLOR_BLACK }, { 1000, 0x0000C800 }, { 2000, 0x00640000 }
+    };
+    led_effect_config_t keys = { .type = LED_EFFECT_KEYFRAMES, .keyframes = track,
+                                 .num_keyframes = 3 };
+    scene = led_scene_create(4);
+    led_scene_add_layer(scene, &keys, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Keyframes at 500 ms", 0x00006400, led_scene_render(scene, 500)[0]);
+    assert_equal_uint32("Keyframes at 1500 ms", 0x00326400, led_scene_render(scene, 1500)[0]);
+    assert_equal_uint32("Keyframes hold after the end", 0x00640000,
+                        led_scene_render(scene, 3000)[0]);
+    led_scene_destroy(scene);
+    keys.loop = true;
+    scene = led_scene_create(4);
+    led_scene_add_layer(scene, &keys, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Looping keyframes at 2500 ms", 0x00006400,
+                        led_scene_render(scene, 2500)[0]);
+    track[2].time_ms = 1000;
+    assert_equal_uint32("Unordered keyframes rejected", (uint32_t)-1,
+                        (uint32_t)led_scene_add_layer(scene, &keys, LED_BLEND_NORMAL, 255));
+    led_scene_destroy(scene);
+    
+    // Twinkle is stateless: same time, same frame
+    scene = led_scene_create(1000);
+    led_effect_config_t twinkle = { .type = LED_EFFECT_TWINKLE, .period_ms = 800,
+                                    .color = LED_COLOR_WHITE, .density = 0, .seed = 7 };
+    led_scene_add_layer(scene, &twinkle, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Twinkle density 0 is dark", 0,
+                        (uint32_t)count_lit(led_scene_render(scene, 1234), 1000));
+    led_scene_destroy(scene);
+    twinkle.density = 128;
+    scene = led_scene_create(1000);
+    led_scene_add_layer(scene, &twinkle, LED_BLEND_NORMAL, 255);
+    uint32_t *first = malloc(1000 * sizeof(uint32_t));
+    memcpy(first, led_scene_render(scene, 1234), 1000 * sizeof(uint32_t));
+    led_scene_render(scene, 99);
+    size_t lit = count_lit(led_scene_render(scene, 1234), 1000);
+    assert_equal_uint32("Twinkle repeatable", 0,
+                        (uint32_t)memcmp(first, led_scene_render(scene, 1234),
+                                         1000 * sizeof(uint32_t)));
+    assert_equal_uint32("Twinkle lights about half the pixels", 1, lit > 400 && lit < 600);
+    led_scene_destroy(scene);
+    
+    // Fire starts cold, heats up with time and restarts when time goes back
+    led_effect_config_t fire = { .type = LED_EFFECT_FIRE, .period_ms = 16,
+                                 .density = 255, .cooling = 55, .seed = 42 };
+    scene = led_scene_create(100);
+    led_scene_t *twin = led_scene_create(100);
+    led_scene_add_layer(scene, &fire, LED_BLEND_NORMAL, 255);
+    led_scene_add_layer(twin, &fire, LED_BLEND_NORMAL, 255);
+    assert_equal_uint32("Fire dark at start", 0, (uint32_t)count_lit(led_scene_render(scene, 0), 100));
+    led_scene_render(twin, 0);
+    for (uint32_t t = 16; t <= 480; t += 16) {
+        led_scene_render(scene, t);
+        led_scene_render(twin, t);
+    }
+    memcpy(first, led_scene_render(scene, 496), 100 * sizeof(uint32_t));
+    assert_equal_uint32("Fire burning after 0.5 s", 1, count_lit(first, 100) > 0);
+    assert_equal_uint32("Fire deterministic for a seed", 0,
+                        (uint32_t)memcmp(first, led_scene_render(twin, 496),
+                                         100 * sizeof(uint32_t)));
+    assert_equal_uint32("Fire restarts when time goes back", 0,
+                        (uint32_t)count_lit(led_scene_render(scene, 0), 100));
+    led_scene_destroy(twin);
+    led_scene_destroy(scene);
+    free(first);
+    
+    // Blend modes and opacity
+    assert_equal_uint32("ADD red + blue", LED_COLOR_MAGENTA,
+                        blend_solid(LED_COLOR_RED, LED_COLOR_BLUE, LED_BLEND_ADD, 255));
+    assert_equal_uint32("ADD at half opacity", 0x0000FF80,
+                        blend_solid(LED_COLOR_RED, LED_COLOR_BLUE, LED_BLEND_ADD, 128));
+    assert_equal_uint32("MULTIPLY by white", LED_COLOR_ORANGE,
+                        blend_solid(LED_COLOR_WHITE, LED_COLOR_ORANGE, LED_BLEND_MULTIPLY, 255));
+    assert_equal_uint32("SCREEN", 0x000000C0,
+                        blend_solid(0x00000080, 0x00000080, LED_BLEND_SCREEN, 255));
+    assert_equal_uint32("MAX", LED_COLOR_MAGENTA,
+                        blend_solid(LED_COLOR_RED, LED_COLOR_BLUE, LED_BLEND_MAX, 255));
+    assert_equal_uint32("NORMAL at opacity 0", LED_COLOR_RED,
+                        blend_solid(LED_COLOR_RED, LED_COLOR_BLUE, LED_BLEND_NORMAL, 0));
+    
+    // Gamma, layer limit and rendering into a compact strip
+    scene = solid_scene(4, 0x00FF8000);
+    led_scene_set_gamma(scene, 2.2);
+    assert_equal_uint32("Gamma 2.2", 0x00FF3800, led_scene_render(scene, 0)[0]);
+    for (int i = 1; i < LED_SCENE_MAX_LAYERS; i++) {
+        led_scene_add_layer(scene, &fade, LED_BLEND_ADD, 0);
+    }
+    assert_equal_uint32("Layer limit", (uint32_t)-1,
+                        (uint32_t)led_scene_add_layer(scene, &fade, LED_BLEND_ADD, 0));
+    led_scene_destroy(scene);
+    
+    scene = led_scene_create(10);
+    led_scene_add_layer(scene, &rainbow, LED_BLEND_NORMAL, 255);
+    led_strip_t *strip = led_strip_create_format(8, LED_FORMAT_GRB24);
+    led_scene_render_to(scene, strip, 0);
+    assert_equal_uint32("Rendered into GRB24 strip", LED_COLOR_RED, led_strip_get_pixel(strip, 0));
+    assert_equal_uint32("Whole strip dirty", 8, (uint32_t)led_strip_get_dirty_count(strip));
+    led_strip_destroy(strip);
+    led_scene_destroy(scene);
+    
+    scene = led_scene_create(4);
+    assert_equal_uint32("Empty scene is black", 0, (uint32_t)count_lit(led_scene_render(scene, 5), 4));
+    led_scene_destroy(scene);
+}
+
+/**
+ * @brief Shader for the matrix test: encodes the coordinates in the color
+ */
+static uint32_t coord_shader(uint32_t x, uint32_t y, uint32_t time_ms, void *user) {
+    (void)user;
+    return (y << 12) | (x << 1) | (time_ms & 1);
+}
+
+/**
+ * @brief Test 16: Matrix mapping and parallel tiled rendering
+ */
+void test_matrix(void) {
+    print_test_header("2D Matrix & Tiled Rendering");
+    
+    led_matrix_config_t config = { .width = 4, .height = 3 };
+    led_matrix_t *m = led_matrix_create(&config);
+    assert_equal_uint32("Row-major (3,2)", 11, (uint32_t)led_matrix_index(m, 3, 2));
+    assert_equal_uint32("Outside the matrix", 1,
+                        led_matrix_index(m, 4, 0) == SIZE_MAX && led_matrix_index(m, 0, 3) == SIZE_MAX);
+    led_matrix_destroy(m);
+    
+    config.serpentine = true;
+    m = led_matrix_create(&config);
+    assert_equal_uint32("Serpentine (0,1)", 7, (uint32_t)led_matrix_index(m, 0, 1));
+    assert_equal_uint32("Serpentine (3,1)", 4, (uint32_t)led_matrix_index(m, 3, 1));
+    led_matrix_destroy(m);
+    
+    config.order = LED_MATRIX_COLUMNS;
+    m = led_matrix_create(&config);
+    assert_equal_uint32("Column serpentine (1,0)", 5, (uint32_t)led_matrix_index(m, 1, 0));
+    led_matrix_destroy(m);
+    
+    config = (led_matrix_config_t){ .width = 4, .height = 3, .flip_x = true };
+    m = led_matrix_create(&config);
+    assert_equal_uint32("Flipped X (0,0)", 3, (uint32_t)led_matrix_index(m, 0, 0));
+    led_matrix_destroy(m);
+    
+    // 2x2 grid of 2x2 serpentine panels
+    config = (led_matrix_config_t){ .width = 4, .height = 4, .panel_width = 2,
+                                    .panel_height = 2, .serpentine = true };
+    m = led_matrix_create(&config);
+    assert_equal_uint32("Panel 1 starts at (2,0)", 4, (uint32_t)led_matrix_index(m, 2, 0));
+    assert_equal_uint32("Panel 2 starts at (0,2)", 8, (uint32_t)led_matrix_index(m, 0, 2));
+    assert_equal_uint32("Panel 0 serpentine (1,1)", 2, (uint32_t)led_matrix_index(m, 1, 1));
+    led_matrix_destroy(m);
+    config.panel_width = 3;
+    assert_equal_uint32("Partial panels rejected", 1, led_matrix_create(&config) == NULL);
+    
+    // Every strip index is used exactly once
+    config = (led_matrix_config_t){ .width = 64, .height = 48, .panel_width = 16,
+                                    .panel_height = 16, .order = LED_MATRIX_COLUMNS,
+                                    .serpentine = true, .flip_y = true };
+    m = led_matrix_create(&config);
+    size_t count = led_matrix_get_pixel_count(m);
+    const uint32_t *table = led_matrix_get_index_table(m);
+    uint8_t *used = calloc(count, 1);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (table[i] < count && !used[table[i]]) {
+            used[table[i]] = 1;
+            unique++;
+        }
+    }
+    assert_equal_uint32("Index table is a permutation", (uint32_t)count, (uint32_t)unique);
+    free(used);
+    led_matrix_destroy(m);
+    
+    // 4 threads over partial tiles give the same frame as the caller alone
+    config = (led_matrix_config_t){ .width = 100, .height = 70, .serpentine = true };
+    m = led_matrix_create(&config);
+    count = led_matrix_get_pixel_count(m);
+    uint32_t *serial = malloc(count * sizeof(uint32_t));
+    uint32_t *parallel = malloc(count * sizeof(uint32_t));
+    led_render_pool_t *pool = led_render_pool_create(4);
+    assert_equal_uint32("Pool threads", 4, (uint32_t)led_render_pool_get_threads(pool));
+    led_matrix_render(NULL, m, coord_shader, NULL, 1, serial);
+    size_t mismatches = 0;
+    for (uint32_t frame = 0; frame < 20; frame++) {
+        memset(parallel, 0, count * sizeof(uint32_t));
+        led_matrix_render(pool, m, coord_shader, NULL, 1, parallel);
+        mismatches += memcmp(serial, parallel, count * sizeof(uint32_t)) != 0;
+    }
+    assert_equal_uint32("Parallel frames match serial", 0, (uint32_t)mismatches);
+    assert_equal_uint32("Shader output at wire position", coord_shader(0, 1, 1, NULL),
+                        parallel[led_matrix_index(m, 0, 1)]);
+    assert_equal_uint32("Last pixel rendered", coord_shader(99, 69, 1, NULL),
+                        parallel[led_matrix_index(m, 99, 69)]);
+    free(serial);
+    free(parallel);
+    
+    led_strip_t *strip = led_strip_create(count);
+    led_matrix_render_to(pool, m, coord_shader, NULL, 0, strip);
+    assert_equal_uint32("Rendered into strip", coord_shader(5, 3, 0, NULL),
+                        led_strip_get_pixel(strip, led_matrix_index(m, 5, 3)));
+    led_matrix_set_pixel(m, strip, 0, 1, 255, 0, 0);
+    assert_equal_uint32("Set pixel by coordinates", LED_COLOR_RED, led_strip_get_pixel(strip, 199));
+    led_strip_destroy(strip);
+    led_render_pool_destroy(pool);
+    led_matrix_destroy(m);
+}
+
+#define REC_PIXELS  300
+#define REC_FRAMES  130
+#define REC_PATH    "led_test_recording.ledrec"
+
+/**
+ * @brief Frame k of the test recording: a chase, with a solid, a static
+ *        and a rainbow frame mixed in
+ */
+static uint32_t render_recording_frame(led_scene_t *chase, led_scene_t *rainbow,
+                                       size_t k, uint32_t *out) {
+    uint32_t time_ms = (uint32_t)(k == 11 ? 10 : k) * 16;     // Frame 11 repeats frame 10
+    if (k == 5) {
+        for (size_t i = 0; i < REC_PIXELS; i++) {
+            out[i] = LED_COLOR_RED;
+        }
+    } else {
+        memcpy(out, led_scene_render(k == 20 ? rainbow : chase, time_ms),
+               REC_PIXELS * sizeof(uint32_t));
+    }
+    return (uint32_t)k * 16;
+}
+
+/**
+ * @brief Cut a file to its first size bytes (rewritten with stdio only)
+ */
+static int truncate_file(const char *path, long size) {
+    FILE *f = fopen(path, "rb");
+    char *data = malloc((size_t)size);
+    size_t got = (f && data) ? fread(data, 1, (size_t)size, f) : 0;
+    if (f) {
+        fclose(f);
+    }
+    f = got == (size_t)size ? fopen(path, "wb") : NULL;
+    int result = (f && fwrite(data, 1, got, f) == got) ? 0 : -1;
+    if (f) {
+        fclose(f);
+    }
+    free(data);
+    return result;
+}
+
+static int stop_at_50(led_strip_t *strip, size_t index, void *user) {
+    (void)strip;
+    *(size_t *)user = index + 1;
+    return index + 1 == 50;
+}
+
+/**
+ * @brief Test 17: Recording and replay
+ */
+void test_recording(void) {
+    print_test_header("Frame Recording & Replay");
+    
+    led_scene_t *chase = led_scene_create(REC_PIXELS);
+    led_scene_t *rainbow = led_scene_create(REC_PIXELS);
+    led_effect_config_t chase_fx = { .type = LED_EFFECT_CHASE, .period_ms = 960,
+                                     .color = LED_COLOR_CYAN, .color2 = 0x00010203,
+                                     .length = 4, .spacing = 12 };
+    led_effect_config_t rainbow_fx = { .type = LED_EFFECT_RAINBOW };
+    led_scene_add_layer(chase, &chase_fx, LED_BLEND_NORMAL, 255);
+    led_scene_add_layer(rainbow, &rainbow_fx, LED_BLEND_NORMAL, 255);
+    
+    uint32_t *frames = malloc(REC_FRAMES * REC_PIXELS * sizeof(uint32_t));
+    led_recorder_t *rec = led_recorder_open(REC_PATH, REC_PIXELS, LED_FORMAT_GRB32, 60);
+    int failures = 0;
+    for (size_t k = 0; k < REC_FRAMES; k++) {
+        uint32_t t = render_recording_frame(chase, rainbow, k, frames + k * REC_PIXELS);
+        failures += led_recorder_add_frame(rec, frames + k * REC_PIXELS, t) != 0;
+    }
+    assert_equal_uint32("Frames recorded", 0, (uint32_t)failures);
+    assert_equal_uint32("Earlier timestamp rejected", (uint32_t)-1,
+                        (uint32_t)led_recorder_add_frame(rec, frames, 0));
+    led_record_info_t info;
+    led_recorder_get_info(rec, &info);
+    assert_equal_uint32("Recorder closed", 0, (uint32_t)led_recorder_close(rec));
+    assert_equal_uint32("Compressed below 1/4 of raw", 1, info.file_bytes * 4 < info.raw_bytes);
+    
+    led_replay_t *replay = led_replay_open(REC_PATH);
+    led_record_info_t rinfo;
+    led_replay_get_info(replay, &rinfo);
+    assert_equal_uint32("Replay frames", REC_FRAMES, (uint32_t)rinfo.frames);
+    assert_equal_uint32("Replay key frames (0, 60, 120)", 3, (uint32_t)rinfo.keyframes);
+    assert_equal_uint32("Replay duration", (REC_FRAMES - 1) * 16, rinfo.duration_ms);
+    assert_equal_uint32("File size matches recorder", (uint32_t)info.file_bytes,
+                        (uint32_t)rinfo.file_bytes);
+    
+    size_t mismatches = 0;
+    for (size_t k = 0; k < REC_FRAMES; k++) {
+        const uint32_t *px = led_replay_frame(replay, k);
+        mismatches += px == NULL || memcmp(px, frames + k * REC_PIXELS,
+                                           REC_PIXELS * sizeof(uint32_t)) != 0;
+    }
+    assert_equal_uint32("Sequential decode is exact", 0, (uint32_t)mismatches);
+    const size_t seeks[] = { 125, 3, 64, 64, 0, 20, 119 };
+    for (size_t i = 0; i < sizeof(seeks) / sizeof(seeks[0]); i++) {
+        const uint32_t *px = led_replay_frame(replay, seeks[i]);
+        mismatches += px == NULL || memcmp(px, frames + seeks[i] * REC_PIXELS,
+                                           REC_PIXELS * sizeof(uint32_t)) != 0;
+    }
+    assert_equal_uint32("Random seeks are exact", 0, (uint32_t)mismatches);
+    led_record_frame_info_t finfo;
+    led_replay_get_frame_info(replay, 11, &finfo);
+    assert_equal_uint32("Repeated frame changes nothing", 0, (uint32_t)finfo.changed_pixels);
+    
+    // Applying frames into a strip: contents exact, unchanged frames not dirty
+    led_strip_t *strip = led_strip_create(REC_PIXELS);
+    led_frame_t frame;
+    size_t dirty_on_repeat = 1;
+    for (size_t k = 0; k < REC_FRAMES; k++) {
+        led_replay_apply(replay, k, strip);
+        for (size_t i = 0; i < REC_PIXELS; i++) {
+            mismatches += led_strip_get_pixel(strip, i) != frames[k * REC_PIXELS + i];
+        }
+        if (k == 11) {
+            dirty_on_repeat = led_strip_get_dirty_count(strip);
+        }
+        led_strip_commit(strip, &frame);
+    }
+    assert_equal_uint32("Applied frames match", 0, (uint32_t)mismatches);
+    assert_equal_uint32("Repeated frame leaves strip clean", 0, (uint32_t)dirty_on_repeat);
+    size_t played = 0;
+    assert_equal_uint32("Play stops when the callback asks", 50,
+                        (uint32_t)led_replay_play(replay, strip, 0, stop_at_50, &played));
+    assert_equal_uint32("Callback saw every frame", 50, (uint32_t)played);
+    assert_equal_uint32("Strip holds frame 49", frames[49 * REC_PIXELS + 7],
+                        led_strip_get_pixel(strip, 7));
+    led_strip_destroy(strip);
+    led_replay_close(replay);
+    
+    // A recording cut mid-frame replays up to its last complete frame
+    FILE *f = fopen(REC_PATH, "r+b");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    assert_equal_uint32("Truncate recording", 0, (uint32_t)truncate_file(REC_PATH, size - 5));
+    replay = led_replay_open(REC_PATH);
+    led_replay_get_info(replay, &rinfo);
+    assert_equal_uint32("Truncated recording keeps complete frames", REC_FRAMES - 1,
+                        (uint32_t)rinfo.frames);
+    led_replay_close(replay);
+    
+    // RGBW recordings keep the white byte
+    uint32_t rgbw[4] = { 0xC8140A1E, 0, 0xFF000000, 0xC8140A1E };
+    rec = led_recorder_open(REC_PATH, 4, LED_FORMAT_RGBW32, 0);
+    led_recorder_add_frame(rec, rgbw, 0);
+    led_recorder_close(rec);
+    replay = led_replay_open(REC_PATH);
+    const uint32_t *px = led_replay_frame(replay, 0);
+    assert_equal_uint32("RGBW white preserved", 0xFF000000, px ? px[2] : 0);
+    led_replay_close(replay);
+    
+    f = fopen(REC_PATH, "wb");
+    fputs("not a recording at all", f);
+    fclose(f);
+    assert_equal_uint32("Invalid file rejected", 1, led_replay_open(REC_PATH) == NULL);
+    remove(REC_PATH);
+    
+    free(frames);
+    led_scene_destroy(chase);
+    led_scene_destroy(rainbow);
+}
+
+/**
+ * @brief Test 18: HSV / HSL input, output correction and power limiting
+ */
+void test_color_pipeline(void) {
+    print_test_header("Color Pipeline");
+    
+    assert_equal_uint32("HSV red", LED_COLOR_RED, led_color_hsv(0, 255, 255));
+    assert_equal_uint32("HSV green", LED_COLOR_GREEN, led_color_hsv(120, 255, 255));
+    assert_equal_uint32("HSV blue", LED_COLOR_BLUE, led_color_hsv(240, 255, 255));
+    assert_equal_uint32("HSV yellow", LED_COLOR_YELLOW, led_color_hsv(60, 255, 255));
+    assert_equal_uint32("HSV hue wraps", LED_COLOR_RED, led_color_hsv(360, 255, 255));
+    assert_equal_uint32("HSV gray", 0x00808080, led_color_hsv(200, 0, 128));
+    assert_equal_uint32("HSL white", LED_COLOR_WHITE, led_color_hsl(90, 255, 255));
+    assert_equal_uint32("HSL black", LED_COLOR_BLACK, led_color_hsl(90, 255, 0));
+    assert_equal_uint32("HSL gray", 0x00404040, led_color_hsl(300, 0, 64));
+    assert_equal_uint32("HSL pure red", 0x0000FE00, led_color_hsl(0, 255, 127));
+    
+    led_strip_t *strip = led_strip_create(64);
+    led_frame_t frame;
+    led_strip_set_pixel_hsv(strip, 0, 240, 255, 255);
+    assert_equal_uint32("Strip HSV pixel", LED_COLOR_BLUE, led_strip_get_pixel(strip, 0));
+    
+    // Gamma changes the frame, not the render buffer
+    led_correction_config_t cc = { .gamma = { 2.2f, 2.2f, 2.2f, 2.2f } };
+    assert_equal_uint32("Correction set", 0, (uint32_t)led_strip_set_correction(strip, &cc));
+    led_strip_fill(strip, 128, 128, 128);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Gamma 2.2 applied", 0x00383838, frame.buffer[5]);
+    assert_equal_uint32("Render buffer unchanged", 0x00808080, led_strip_get_pixel(strip, 5));
+    
+    led_strip_set_pixel_color(strip, 9, 255, 0, 0);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Sparse change, one span", 1, (uint32_t)frame.num_spans);
+    assert_equal_uint32("Sparse change, one pixel", 1, (uint32_t)frame.dirty_pixels);
+    assert_equal_uint32("Sparse change corrected", LED_COLOR_RED, frame.buffer[9]);
+    
+    // Brightness re-sends the whole strip through the new table
+    led_strip_set_brightness(strip, 128);
+    assert_equal_uint32("Brightness stored", 128, led_strip_get_brightness(strip));
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Brightness re-sends strip", 64, (uint32_t)frame.dirty_pixels);
+    assert_equal_uint32("Brightness halves output", 0x00008000, frame.buffer[9]);
+    
+    // Scalar and SIMD kernels produce the same frame
+    led_simd_level_t level = led_simd_get_level();
+    uint32_t simd_out[64];
+    for (size_t i = 0; i < 64; i++) {
+        led_strip_set_pixel_hsv(strip, i, (uint16_t)(i * 37), (uint8_t)(255 - i), 200);
+    }
+    led_strip_commit(strip, &frame);
+    memcpy(simd_out, frame.buffer, sizeof(simd_out));
+    led_simd_set_level(LED_SIMD_SCALAR);
+    led_strip_mark_all_dirty(strip);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Scalar matches SIMD", 0,
+                        (uint32_t)memcmp(simd_out, frame.buffer, sizeof(simd_out)));
+    led_simd_set_level(level);
+    
+    // Power budget: 64 white LEDs draw 3840 mA, the limit is 1000 mA
+    led_power_info_t power;
+    led_correction_config_t limited = { .max_milliamps = 1000 };
+    led_strip_set_correction(strip, &limited);
+    led_strip_set_brightness(strip, 255);
+    led_strip_fill(strip, 255, 255, 255);
+    led_strip_commit(strip, &frame);
+    led_strip_get_power(strip, &power);
+    assert_equal_uint32("Power within budget", 1, power.output_milliamps <= 1000);
+    assert_equal_uint32("Power requested ~3840 mA", 1,
+                        power.requested_milliamps > 3760 && power.requested_milliamps <= 3840);
+    assert_equal_uint32("Power scaled down", 1, power.scale < 256);
+    assert_equal_uint32("Power limit re-sends strip", 64, (uint32_t)frame.dirty_pixels);
+    led_strip_clear(strip);
+    led_strip_set_pixel_color(strip, 0, 255, 0, 0);
+    led_strip_commit(strip, &frame);
+    led_strip_get_power(strip, &power);
+    assert_equal_uint32("Power scale recovers", 256, power.scale);
+    assert_equal_uint32("Recovered output", LED_COLOR_RED, frame.buffer[0]);
+    
+    // Double buffering: the published frame is corrected, the source is not
+    const led_frame_t *held;
+    led_strip_set_correction(strip, &cc);
+    led_strip_set_buffering(strip, LED_BUFFER_DOUBLE);
+    led_strip_fill(strip, 128, 128, 128);
+    led_strip_present(strip);
+    held = led_strip_acquire_frame(strip);
+    assert_equal_uint32("Presented frame corrected", 0x00383838, held ? held->buffer[63] : 0);
+    assert_equal_uint32("Drop correction while held", (uint32_t)-1,
+                        (uint32_t)led_strip_set_correction(strip, NULL));
+    led_strip_release_frame(strip);
+    assert_equal_uint32("Correction removed", 0,
+                        (uint32_t)led_strip_set_correction(strip, NULL));
+    led_strip_present(strip);
+    held = led_strip_acquire_frame(strip);
+    assert_equal_uint32("Raw frame again", 0x00808080, held ? held->buffer[63] : 0);
+    assert_equal_uint32("Raw frame re-sent", 64, held ? (uint32_t)held->dirty_pixels : 0);
+    led_strip_release_frame(strip);
+    led_strip_destroy(strip);
+    
+    // RGBW32 corrects the white byte, other formats are rejected
+    strip = led_strip_create_format(4, LED_FORMAT_RGBW32);
+    led_strip_set_brightness(strip, 128);
+    led_strip_set_pixel_rgbw(strip, 0, 0, 0, 0, 255);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("RGBW white corrected", 0x80000000, frame.buffer[0]);
+    led_strip_destroy(strip);
+    strip = led_strip_create_format(4, LED_FORMAT_GRB24);
+    assert_equal_uint32("GRB24 rejected", (uint32_t)-1,
+                        (uint32_t)led_strip_set_correction(strip, &cc));
+    led_strip_destroy(strip);
+}
+
+/**
+ * @brief Sum of the red bytes of count output words
+ */
+static uint32_t red_sum(const uint32_t *words, size_t count) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += (words[i] >> 8) & 0xFF;
+    }
+    return sum;
+}
+
+#define DEPTH_PIXELS 203    // Not a multiple of the SIMD width: tails are covered
+
+/**
+ * @brief Dithered output of a fixed sequence: ordered with a sparse commit, then temporal
+ */
+static void run_dither_sequence(uint32_t *ordered, uint32_t *temporal) {
+    led_strip_t *strip = led_strip_create_format(DEPTH_PIXELS, LED_FORMAT_RGBW64);
+    uint64_t src[DEPTH_PIXELS];
+    led_frame_t frame;
+    
+    for (size_t i = 0; i < DEPTH_PIXELS; i++) {
+        src[i] = ((uint64_t)(i * 4099 % 65536) << 48) | ((uint64_t)(i * 977 % 65536) << 32) |
+                 ((uint64_t)(i * 31 % 4000) << 16) | (uint64_t)(65535 - i * 13);
+    }
+    led_strip_set_dither(strip, LED_DITHER_ORDERED);
+    led_strip_copy_range16(strip, 0, src, DEPTH_PIXELS);
+    led_strip_commit(strip, &frame);
+    led_strip_set_pixel_color16(strip, 37, 1000, 2000, 3000);    // Span at an odd phase
+    led_strip_commit(strip, &frame);
+    memcpy(ordered, frame.buffer, DEPTH_PIXELS * sizeof(uint32_t));
+    
+    led_strip_set_dither(strip, LED_DITHER_TEMPORAL);
+    for (int f = 0; f < 3; f++) {
+        led_strip_commit(strip, &frame);
+    }
+    memcpy(temporal, frame.buffer, DEPTH_PIXELS * sizeof(uint32_t));
+    led_strip_destroy(strip);
+}
+
+/**
+ * @brief Test 19: 16-bit channels and dithering
+ */
+void test_color_depth(void) {
+    print_test_header("High Color Depth & Dithering");
+    
+    led_strip_t *strip = led_strip_create_format(64, LED_FORMAT_RGBW64);
+    led_frame_t frame;
+    
+    led_strip_set_pixel_color16(strip, 0, 0x1234, 0x5678, 0x9ABC);
+    assert_equal_uint32("16-bit pixel, low half", 0x12349ABC,
+                        (uint32_t)led_strip_get_pixel16(strip, 0));
+    assert_equal_uint32("16-bit pixel, high half", 0x00005678,
+                        (uint32_t)(led_strip_get_pixel16(strip, 0) >> 32));
+    assert_equal_uint32("8-bit view of 16-bit pixel", 0x0056129A, led_strip_get_pixel(strip, 0));
+    led_strip_set_pixel_color(strip, 1, 255, 128, 1);
+    assert_equal_uint32("8-bit setter stores v * 257", 0xFFFF0101,
+                        (uint32_t)led_strip_get_pixel16(strip, 1));
+    led_strip_scale_range(strip, 0, 1, 127, 127, 127);
+    assert_equal_uint32("Scale keeps 16 bits", 0x091A4D5E,
+                        (uint32_t)led_strip_get_pixel16(strip, 0));
+    
+    // Rounding: 10.19 and 10.78 levels
+    led_strip_set_pixel_color16(strip, 0, 257 * 10 + 50, 0, 0);
+    led_strip_set_pixel_color16(strip, 1, 257 * 10 + 200, 0, 0);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Dithered frame format is rgbw32", LED_FORMAT_RGBW32, frame.format);
+    assert_equal_uint32("Round down", 0x00000A00, frame.buffer[0]);
+    assert_equal_uint32("Round up", 0x00000B00, frame.buffer[1]);
+    assert_equal_uint32("Frame data is the dithered output", 0x00000B00,
+                        ((const uint32_t*)frame.data)[1]);
+    
+    // Ordered: 10.25 levels averages out over every 16 pixels
+    assert_equal_uint32("Ordered dither set", 0,
+                        (uint32_t)led_strip_set_dither(strip, LED_DITHER_ORDERED));
+    led_strip_fill16(strip, 2634, 0, 0);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Ordered: 16 pixels sum to 164", 164, red_sum(frame.buffer, 16));
+    assert_equal_uint32("Ordered: strip sums to 656", 656, red_sum(frame.buffer, 64));
+    led_strip_set_pixel_color16(strip, 20, 0, 65535, 0);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Ordered: sparse change stays sparse", 1, (uint32_t)frame.dirty_pixels);
+    assert_equal_uint32("Ordered: full 16-bit green", 0x00FF0000, frame.buffer[20]);
+    
+    // Temporal: 10.25 levels shows 10, 10, 10, 11 on every pixel
+    assert_equal_uint32("Temporal dither set", 0,
+                        (uint32_t)led_strip_set_dither(strip, LED_DITHER_TEMPORAL));
+    led_strip_fill16(strip, 2634, 0, 0);
+    uint32_t total = 0;
+    size_t spans[4];
+    for (int f = 0; f < 4; f++) {
+        led_strip_commit(strip, &frame);
+        total += red_sum(frame.buffer, 1);
+        spans[f] = frame.num_spans;
+    }
+    assert_equal_uint32("Temporal: 4 frames sum to 41", 41, total);
+    assert_equal_uint32("Temporal: unchanged output sends nothing", 0, (uint32_t)spans[1]);
+    assert_equal_uint32("Temporal: changed output sent", 64, (uint32_t)frame.dirty_pixels);
+    led_strip_fill(strip, 10, 20, 30);
+    led_strip_commit(strip, &frame);
+    led_strip_commit(strip, &frame);
+    assert_equal_uint32("Temporal: exact levels settle", 0, (uint32_t)frame.num_spans);
+    assert_equal_uint32("Temporal: exact level output", 0x00140A1E, frame.buffer[63]);
+    uint32_t pixel = 0;
+    led_strip_unpack_pixels(strip, frame.data, 63, &pixel, 1);
+    assert_equal_uint32("Temporal: frame data unpacks as rgbw32", 0x00140A1E, pixel);
+    
+    // Double buffering: spans compare with the previous frame, not the old buffer
+    uint32_t mirror[64] = {0};
+    const led_frame_t *held;
+    int synced = 1;
+    led_strip_set_buffering(strip, LED_BUFFER_DOUBLE);
+    led_strip_fill16(strip, 2634, 5000, 300);
+    for (int f = 0; f < 8; f++) {
+        led_strip_set_pixel_color16(strip, (size_t)f * 5, (uint16_t)(f * 999), 0, 65535);
+        led_strip_present(strip);
+        held = led_strip_acquire_frame(strip);
+        mirror_frame(mirror, held);
+        synced &= memcmp(mirror, held->buffer, sizeof(mirror)) == 0;
+        led_strip_release_frame(strip);
+    }
+    assert_equal_uint32("Temporal double buffered: consumer in sync", 1, (uint32_t)synced);
+    led_strip_destroy(strip);
+    
+    // Every SIMD level produces the same output
+    led_simd_level_t level = led_simd_get_level();
+    uint32_t ref_ordered[DEPTH_PIXELS], ref_temporal[DEPTH_PIXELS];
+    uint32_t ordered[DEPTH_PIXELS], temporal[DEPTH_PIXELS];
+    led_simd_set_level(LED_SIMD_SCALAR);
+    run_dither_sequence(ref_ordered, ref_temporal);
+    for (int l = LED_SIMD_SSE2; l <= (int)level; l++) {
+        char name[64];
+        led_simd_set_level((led_simd_level_t)l);
+        run_dither_sequence(ordered, temporal);
+        snprintf(name, sizeof(name), "%s ordered matches scalar",
+                 led_simd_level_name((led_simd_level_t)l));
+        assert_equal_uint32(name, 0, (uint32_t)memcmp(ref_ordered, ordered, sizeof(ordered)));
+        snprintf(name, sizeof(name), "%s temporal matches scalar",
+                 led_simd_level_name((led_simd_level_t)l));
+        assert_equal_uint32(name, 0, (uint32_t)memcmp(ref_temporal, temporal, sizeof(temporal)));
+    }
+    led_simd_set_level(level);
+    
+    // 8-bit strips store the nearest level and cannot dither
+    strip = led_strip_create(4);
+    led_strip_set_pixel_color16(strip, 0, 0x8080, 0x017F, 0xFFFF);
+    assert_equal_uint32("GRB32 rounds 16-bit input", 0x000180FF, led_strip_get_pixel(strip, 0));
+    assert_equal_uint32("GRB32 dither rejected", (uint32_t)-1,
+                        (uint32_t)led_strip_set_dither(strip, LED_DITHER_ORDERED));
+    led_strip_destroy(strip);
+}
+
 /**
  * @brief Print test summary
  */
@@ -269,6 +1558,18 @@ int main(void) {
     test_bounds_checking();
     test_color_constants();
     test_rainbow_pattern();
+    test_dirty_tracking();
+    test_dirty_span_limit();
+    test_bulk_operations();
+    test_multi_strip();
+    test_frame_buffering();
+    test_waveform_encoder();
+    test_pixel_formats();
+    test_effects();
+    test_matrix();
+    test_recording();
+    test_color_pipeline();
+    test_color_depth();
     
     // Print summary
     print_test_summary();
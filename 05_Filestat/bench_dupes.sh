@@ -0,0 +1,97 @@
+#!/usr/bin/env bash
+#
+# Benchmark tìm file trùng (--dupes) so với băm mọi file bằng md5sum và
+# b2sum (find | xargs | sort | uniq), trên một tập dữ liệu tổng hợp:
+#
+#   - BENCH_BIG file ngẫu nhiên 4 MB, mỗi file có một bản sao
+#   - BENCH_BIG file 4 MB cùng đầu và cuối với một file trên nhưng khác ở
+#     giữa (chỉ giai đoạn băm toàn bộ phân biệt được)
+#   - BENCH_SMALL file nhỏ (1-16 KB), một nửa là bản sao
+#
+# Kết quả của filestat được so với md5sum: cùng danh sách file trùng.
+#
+# Cách dùng: ./bench_dupes.sh     hoặc  make bench
+
+set -euo pipefail
+
+BIG=${BENCH_BIG:-64}
+SMALL=${BENCH_SMALL:-4000}
+DATA=${BENCH_DIR:-/tmp/filestat_dupes_bench}
+RUNS=${BENCH_RUNS:-3}
+JOBS=${BENCH_JOBS:-$(nproc)}
+FILESTAT=${FILESTAT:-./filestat}
+
+if [ ! -f "$DATA/.complete" ]; then
+    rm -rf "$DATA"
+    mkdir -p "$DATA/big" "$DATA/copies" "$DATA/near" "$DATA/small"
+    for (( i = 0; i < BIG; i++ )); do
+        head -c 4194304 /dev/urandom > "$DATA/big/$i.bin"
+        cp "$DATA/big/$i.bin" "$DATA/copies/$i.bin"
+        cp "$DATA/big/$i.bin" "$DATA/near/$i.bin"
+        # Đổi 1 byte ở giữa: cùng kích thước, cùng 4 KB đầu và cuối
+        printf 'x' | dd of="$DATA/near/$i.bin" bs=1 seek=2097152 conv=notrunc status=none
+    done
+    python3 - "$DATA/small" "$SMALL" <<'EOF'
+import os, random, sys
+root, count = sys.argv[1], int(sys.argv[2])
+random.seed(1)
+for i in range(count):
+    if i % 2 and i > 1:
+        src = os.path.join(root, "%d" % (i - 1))
+        data = open(src, "rb").read()
+    else:
+        data = os.urandom(random.randint(1024, 16384))
+    with open(os.path.join(root, "%d" % i), "wb") as f:
+        f.write(data)
+EOF
+    touch "$DATA/.complete"
+fi
+BYTES=$(du -sb --exclude=.complete "$DATA" | cut -f1)
+FILES=$(find "$DATA" -type f ! -name .complete | wc -l)
+
+# best_ms <lệnh>: thời gian tốt nhất (ms) của RUNS lần chạy (page cache đã ấm)
+best_ms() {
+    local best=0 start end ms r
+    for (( r = 0; r < RUNS; r++ )); do
+        start=$(date +%s%N)
+        bash -c "$1" > /dev/null 2>&1
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo $(( best > 0 ? best : 1 ))
+}
+
+report() {
+    awk -v name="$1" -v ms="$2" -v bytes="$BYTES" \
+        'BEGIN { printf "%-44s %8d ms %8.2f GB/s of data\n", name, ms, bytes / ms / 1e6 }'
+}
+
+hashall() {
+    echo "find $DATA -type f ! -name .complete -print0 | xargs -0 -P $JOBS -n 64 $1 |
+          sort | uniq -w$2 -D"
+}
+
+cat "$DATA"/*/* > /dev/null
+echo "Data: $FILES files, $BYTES bytes in $DATA, $JOBS thread(s), best of $RUNS"
+echo
+
+report "filestat --dupes" $(best_ms "$FILESTAT --dupes -j $JOBS $DATA")
+report "md5sum | sort | uniq -D" $(best_ms "$(hashall md5sum 32)")
+report "b2sum | sort | uniq -D" $(best_ms "$(hashall b2sum 128)")
+echo
+
+# Cùng một tập file trùng
+"$FILESTAT" --dupes -j "$JOBS" "$DATA" | grep "^/" | sort > /tmp/filestat_dupes_a
+bash -c "$(hashall md5sum 32)" | cut -c35- | sort > /tmp/filestat_dupes_b
+if cmp -s /tmp/filestat_dupes_a /tmp/filestat_dupes_b; then
+    echo "Same $(wc -l < /tmp/filestat_dupes_a) duplicate files as md5sum"
+else
+    echo "MISMATCH with md5sum"
+    diff /tmp/filestat_dupes_a /tmp/filestat_dupes_b | head
+fi
+rm -f /tmp/filestat_dupes_a /tmp/filestat_dupes_b
+echo
+"$FILESTAT" --dupes -j "$JOBS" "$DATA" | sed -n '/^=/,$p'
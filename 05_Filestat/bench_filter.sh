@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+#
+# Benchmark lọc khi duyệt (--where, --prune) trên cây của bench_walk.sh:
+# in mọi thứ rồi lọc bằng grep/awk, so với lọc trong filestat, và với
+# find dùng cùng điều kiện
+#
+# Cây có 1000 file f0001..f1000 trong mỗi thư mục lá a*/b*/c*, nên
+# name==f000* giữ 1% số file, và a0 là 1/10 cây.
+#
+# Cách dùng: ./bench_filter.sh     hoặc  make bench
+
+set -euo pipefail
+
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+RUNS=${BENCH_RUNS:-3}
+JOBS=${BENCH_JOBS:-1}
+FILESTAT=${FILESTAT:-./filestat}
+
+if [ ! -f "$TREE/.complete" ]; then
+    BENCH_FILES=$FILES BENCH_DIR=$TREE BENCH_RUNS=0 ./bench_walk.sh > /dev/null
+fi
+TREE_COUNT=$(find "$TREE" | wc -l)
+
+# best_ms <lệnh>: thời gian tốt nhất (ms) của RUNS lần chạy
+best_ms() {
+    local best=0 start end ms r
+    for (( r = 0; r < RUNS; r++ )); do
+        start=$(date +%s%N)
+        bash -c "$1" > /dev/null 2>&1
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo $(( best > 0 ? best : 1 ))
+}
+
+report() {
+    printf "%-72s %8d ms\n" "$1" "$2"
+}
+
+run() {
+    report "$1" $(best_ms "$1")
+}
+
+echo "Tree: $TREE_COUNT entries in $TREE, $JOBS thread(s), best of $RUNS"
+echo
+
+echo "# 1% of the files, decided by name"
+run "$FILESTAT -r -j $JOBS $TREE | grep '/f000[^/]*\$'"
+run "$FILESTAT -r -j $JOBS --where='name==f000*' $TREE"
+run "find $TREE -name 'f000*' -printf '%y %s %T@ %p\\n'"
+echo
+
+echo "# Only directories"
+run "$FILESTAT -r -j $JOBS $TREE | awk '\$1 == \"d\"'"
+run "$FILESTAT -r -j $JOBS --where=type==dir $TREE"
+run "find $TREE -type d -printf '%y %s %T@ %p\\n'"
+echo
+
+echo "# Needs statx: regular files of at least 1 byte (none in this tree)"
+run "$FILESTAT -r -j $JOBS $TREE | awk '\$1 == \"f\" && \$2 > 0'"
+run "$FILESTAT -r -j $JOBS --where='type==reg && size>0' $TREE"
+run "find $TREE -type f -size +0c -printf '%y %s %T@ %p\\n'"
+echo
+
+echo "# Skip 9 of the 10 top-level directories"
+run "$FILESTAT -r -j $JOBS $TREE | grep -v '^. [0-9]* [0-9]* $TREE/a[1-9]'"
+run "$FILESTAT -r -j $JOBS --prune='name==a[1-9]' $TREE"
+run "find $TREE -name 'a[1-9]' -prune -o -printf '%y %s %T@ %p\\n'"
+echo
+
+"$FILESTAT" -r -s -j "$JOBS" --where='name==f000*' "$TREE" | grep -E "Files|Filtered"
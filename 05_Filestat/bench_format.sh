@@ -0,0 +1,75 @@
+#!/usr/bin/env bash
+#
+# Benchmark các định dạng output (--format): số bản ghi mỗi giây cho
+# danh sách BENCH_PATHS path (--stdin) và cho cả cây (-r, 1 luồng), kèm
+# cách cũ là in khung text rồi tách trường bằng awk
+#
+# Dùng cây của bench_walk.sh (tạo cây trước nếu chưa có). Output bin được
+# ghi vào một file tạm (bin không được ghi ra terminal); các định dạng khác
+# ghi vào /dev/null.
+#
+# Cách dùng: ./bench_format.sh     hoặc  make bench
+
+set -euo pipefail
+
+PATHS=${BENCH_PATHS:-100000}
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+RUNS=${BENCH_RUNS:-3}
+FILESTAT=${FILESTAT:-./filestat}
+LIST=$(mktemp)
+BIN=$(mktemp)
+trap 'rm -f "$LIST" "$BIN"' EXIT
+
+if [ ! -f "$TREE/.complete" ]; then
+    BENCH_FILES=$FILES BENCH_DIR=$TREE BENCH_RUNS=0 ./bench_walk.sh > /dev/null
+fi
+(find "$TREE" -type f || true) | head -n "$PATHS" > "$LIST"
+LIST_COUNT=$(wc -l < "$LIST")
+TREE_COUNT=$(find "$TREE" | wc -l)
+
+# best_ms <output> <lệnh...>: thời gian tốt nhất (ms) của RUNS lần chạy,
+# stdin là danh sách path
+best_ms() {
+    local output=$1 best=0 start end ms
+    shift
+    for (( r = 0; r < RUNS; r++ )); do
+        start=$(date +%s%N)
+        "$@" < "$LIST" > "$output"
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo $(( best > 0 ? best : 1 ))
+}
+
+# text_awk <tham số filestat...>: khung text được tách thành "path size" bằng awk
+text_awk() {
+    "$FILESTAT" "$@" | awk '/^File Path:/ { p = $3 } /^Size:/ { print p, $2 }'
+}
+
+report() {
+    printf "%-40s %8d ms %12d records/s\n" "$1" "$2" $(( $3 * 1000 / $2 ))
+}
+
+echo "List: $LIST_COUNT paths, tree: $TREE_COUNT entries in $TREE, best of $RUNS"
+echo
+
+for fmt in text json csv tsv; do
+    report "--stdin --format=$fmt" $(best_ms /dev/null "$FILESTAT" --stdin --format=$fmt) "$LIST_COUNT"
+done
+report "--stdin --format=bin" $(best_ms "$BIN" "$FILESTAT" --stdin --format=bin) "$LIST_COUNT"
+report "--stdin --format=csv --fields=all" \
+       $(best_ms /dev/null "$FILESTAT" --stdin --format=csv --fields=all) "$LIST_COUNT"
+report "--stdin (text) | awk" $(best_ms /dev/null text_awk --stdin) "$LIST_COUNT"
+echo
+
+for fmt in text json csv tsv; do
+    report "-r -j 1 --format=$fmt" $(best_ms /dev/null "$FILESTAT" -r -j 1 --format=$fmt "$TREE") \
+           "$TREE_COUNT"
+done
+report "-r -j 1 --format=bin" $(best_ms "$BIN" "$FILESTAT" -r -j 1 --format=bin "$TREE") "$TREE_COUNT"
+report "-r -j 1 --format=json --fields=all" \
+       $(best_ms /dev/null "$FILESTAT" -r -j 1 --format=json --fields=all "$TREE") "$TREE_COUNT"
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+#
+# Benchmark chế độ nhiều path: một tiến trình mỗi file so với một tiến
+# trình cho cả danh sách (--stdin), có và không có --jobs / --io=uring
+#
+# Danh sách gồm BENCH_PATHS path (mặc định 100 000) lấy từ cây của
+# bench_walk.sh (tạo cây trước nếu chưa có). Cách một-tiến-trình-mỗi-file
+# chỉ chạy trên BENCH_SPAWN path đầu (mặc định 5000) rồi quy ra cả danh sách.
+#
+# Cách dùng: ./bench_paths.sh     hoặc  make bench
+
+set -euo pipefail
+
+PATHS=${BENCH_PATHS:-100000}
+SPAWN=${BENCH_SPAWN:-5000}
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+RUNS=${BENCH_RUNS:-3}
+FILESTAT=${FILESTAT:-./filestat}
+LIST=$(mktemp)
+trap 'rm -f "$LIST" "$LIST.spawn"' EXIT
+
+if [ ! -f "$TREE/.complete" ]; then
+    BENCH_FILES=$FILES BENCH_DIR=$TREE BENCH_RUNS=0 ./bench_walk.sh > /dev/null
+fi
+(find "$TREE" -type f || true) | head -n "$PATHS" > "$LIST"
+head -n "$SPAWN" "$LIST" > "$LIST.spawn"
+COUNT=$(wc -l < "$LIST")
+
+# best_ms <stdin> <lệnh...>: thời gian tốt nhất (ms) của RUNS lần chạy
+best_ms() {
+    local input=$1 best=0 start end ms
+    shift
+    for (( r = 0; r < RUNS; r++ )); do
+        start=$(date +%s%N)
+        "$@" < "$input" > /dev/null
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo $(( best > 0 ? best : 1 ))
+}
+
+report() {
+    printf "%-36s %8d ms %12d paths/s\n" "$1" "$2" $(( COUNT * 1000 / $2 ))
+}
+
+echo "Paths: $COUNT from $TREE, best of $RUNS"
+echo
+
+ms=$(best_ms "$LIST.spawn" xargs -n 1 "$FILESTAT")
+report "xargs -n 1 filestat (extrapolated)" $(( ms * COUNT / SPAWN ))
+report "filestat --stdin"                $(best_ms "$LIST" "$FILESTAT" --stdin)
+report "filestat --stdin --jobs 4"       $(best_ms "$LIST" "$FILESTAT" --stdin --jobs 4)
+report "filestat --stdin --io=uring"     $(best_ms "$LIST" "$FILESTAT" --stdin --io=uring)
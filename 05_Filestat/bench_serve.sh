@@ -0,0 +1,130 @@
+#!/usr/bin/env bash
+#
+# Benchmark daemon metadata (--serve): cùng một danh sách path được hỏi
+# bằng statx() trực tiếp trong một tiến trình (--stdin), qua daemon với
+# cache lạnh (mọi câu hỏi là miss), và qua daemon với cache ấm (mọi câu
+# hỏi là hit). Output của hai cách được so sánh byte với byte.
+#
+# Danh sách là BENCH_PATHS path đầu tiên của cây bench_walk.sh, không quá
+# 90% fs.inotify.max_user_watches (cache cần khoảng một watch mỗi path).
+#
+# Cách dùng: ./bench_serve.sh     hoặc  make bench
+
+set -euo pipefail
+
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+PATHS=${BENCH_PATHS:-100000}
+RUNS=${BENCH_RUNS:-3}
+FILESTAT=${FILESTAT:-./filestat}
+SOCK=/tmp/filestat_bench_$$.sock
+LIST=/tmp/filestat_bench_serve_$$.list
+LOG=/tmp/filestat_bench_serve_$$.log
+WATCHES=$(cat /proc/sys/fs/inotify/max_user_watches)
+if [ "$PATHS" -gt $(( WATCHES * 9 / 10 )) ]; then
+    PATHS=$(( WATCHES * 9 / 10 ))
+fi
+
+if [ ! -f "$TREE/.complete" ]; then
+    BENCH_FILES=$FILES BENCH_DIR=$TREE BENCH_RUNS=0 ./bench_walk.sh > /dev/null
+fi
+# find bị SIGPIPE khi head đã đủ
+find "$TREE" | head -n "$PATHS" > "$LIST" || true
+COUNT=$(wc -l < "$LIST")
+
+SERVER=
+cleanup() {
+    if [ -n "$SERVER" ]; then
+        kill "$SERVER" 2> /dev/null || true
+        wait "$SERVER" 2> /dev/null || true
+    fi
+    rm -f "$LIST" "$LOG" /tmp/filestat_serve_a /tmp/filestat_serve_b
+}
+trap cleanup EXIT
+
+start_server() {
+    "$FILESTAT" --serve="$SOCK" --cache-size $(( COUNT * 2 )) 2> "$LOG" &
+    SERVER=$!
+    while [ ! -S "$SOCK" ]; do
+        sleep 0.05
+    done
+}
+
+stop_server() {
+    kill "$SERVER"
+    wait "$SERVER" || true
+    SERVER=
+}
+
+# time_ms <lệnh>: thời gian (ms) của một lần chạy
+time_ms() {
+    local start end ms
+    start=$(date +%s%N)
+    bash -c "$1" > /dev/null 2>&1
+    end=$(date +%s%N)
+    ms=$(( (end - start) / 1000000 ))
+    echo $(( ms > 0 ? ms : 1 ))
+}
+
+# best_ms <lệnh>: thời gian tốt nhất (ms) của RUNS lần chạy
+best_ms() {
+    local best=0 ms r
+    for (( r = 0; r < RUNS; r++ )); do
+        ms=$(time_ms "$1")
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+report() {
+    awk -v name="$1" -v ms="$2" -v n="$COUNT" \
+        'BEGIN { printf "%-44s %8d ms %10.0f paths/s %7.0f ns/path\n",
+                 name, ms, n / ms * 1000, ms * 1e6 / n }'
+}
+
+DIRECT="$FILESTAT --stdin --format=bin --fields=all < $LIST"
+CACHED="$FILESTAT --server=$SOCK --stdin --format=bin --fields=all < $LIST"
+
+echo "Paths: $COUNT from $TREE (max_user_watches $WATCHES), best of $RUNS (cold cache: one run)"
+echo
+
+report "statx() in the client (--stdin)" $(best_ms "$DIRECT")
+start_server
+report "--server, cold cache (all misses)" $(time_ms "$CACHED")
+report "--server, warm cache (all hits)" $(best_ms "$CACHED")
+echo
+
+# Cùng output
+bash -c "$DIRECT" > /tmp/filestat_serve_a
+bash -c "$CACHED" > /tmp/filestat_serve_b
+if cmp -s /tmp/filestat_serve_a /tmp/filestat_serve_b; then
+    echo "Same output as statx() for $COUNT paths"
+else
+    echo "MISMATCH with statx()"
+fi
+
+# Tươi: đổi một file đã có trong cache rồi hỏi lại ngay, cả qua một hard
+# link ở thư mục khác (chỉ báo trên inode của file)
+DIR=/tmp/filestat_bench_serve_$$.dir
+mkdir -p "$DIR/o3" "$DIR/o4"
+echo a > "$DIR/o3/g"
+fresh() {
+    if [ "$("$FILESTAT" --server="$SOCK" -a "$DIR/o3/g")" = "$("$FILESTAT" -a "$DIR/o3/g")" ]; then
+        echo "Change seen by the next query ($1)"
+    else
+        echo "STALE answer for $DIR/o3/g ($1)"
+    fi
+}
+"$FILESTAT" --server="$SOCK" "$DIR/o3/g" > /dev/null
+echo abc > "$DIR/o3/g"
+fresh "same name"
+ln "$DIR/o3/g" "$DIR/o4/h"
+head -c 5000 /dev/zero >> "$DIR/o4/h"
+fresh "hard link in another directory"
+rm -rf "$DIR"
+echo
+
+stop_server
+sed -n '/^=/,$p' "$LOG"
@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+#
+# Benchmark snapshot (--snapshot) và so sánh (--diff) trên cây của
+# bench_walk.sh: quét đầy đủ (-r -s) so với quét lại một cây hầu như
+# không đổi, có và không có --verify-files
+#
+# Để có thay đổi cần tìm, BENCH_CHANGES file mới được tạo trong một thư
+# mục của cây sau khi ghi snapshot (và được xóa khi kết thúc).
+#
+# Cách dùng: ./bench_snapshot.sh     hoặc  make bench
+
+set -euo pipefail
+
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+RUNS=${BENCH_RUNS:-3}
+CHANGES=${BENCH_CHANGES:-10}
+JOBS=${BENCH_JOBS:-1}
+FILESTAT=${FILESTAT:-./filestat}
+SNAP=$(mktemp)
+NEXT=$(mktemp)
+trap 'rm -f "$SNAP" "$NEXT" "$NEXT.tmp" "$TREE"/a0/b0/c0/snapbench_*' EXIT
+
+if [ ! -f "$TREE/.complete" ]; then
+    BENCH_FILES=$FILES BENCH_DIR=$TREE BENCH_RUNS=0 ./bench_walk.sh > /dev/null
+fi
+rm -f "$TREE"/a0/b0/c0/snapbench_*
+TREE_COUNT=$(find "$TREE" | wc -l)
+
+# best_ms <lệnh...>: thời gian tốt nhất (ms) của RUNS lần chạy
+best_ms() {
+    local best=0 start end ms r
+    for (( r = 0; r < RUNS; r++ )); do
+        start=$(date +%s%N)
+        "$@" > /dev/null 2>&1
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo $(( best > 0 ? best : 1 ))
+}
+
+report() {
+    printf "%-44s %8d ms\n" "$1" "$2"
+}
+
+echo "Tree: $TREE_COUNT entries in $TREE, $JOBS thread(s), best of $RUNS"
+echo
+
+report "filestat -r -s (full scan)" $(best_ms "$FILESTAT" -r -s -j "$JOBS" "$TREE")
+report "filestat --snapshot" $(best_ms "$FILESTAT" --snapshot="$SNAP" -j "$JOBS" "$TREE")
+echo "  snapshot size: $(stat -c %s "$SNAP") bytes"
+report "filestat --diff (unchanged)" $(best_ms "$FILESTAT" --diff="$SNAP" -j "$JOBS" "$TREE")
+
+for (( i = 0; i < CHANGES; i++ )); do
+    echo "$i" > "$TREE/a0/b0/c0/snapbench_$i"
+done
+report "filestat --diff ($CHANGES files added)" $(best_ms "$FILESTAT" --diff="$SNAP" -j "$JOBS" "$TREE")
+report "filestat --diff --snapshot (update)" \
+       $(best_ms "$FILESTAT" --diff="$SNAP" --snapshot="$NEXT" -j "$JOBS" "$TREE")
+report "filestat --diff --verify-files" \
+       $(best_ms "$FILESTAT" --diff="$SNAP" --verify-files -j "$JOBS" "$TREE")
+echo
+"$FILESTAT" --diff="$SNAP" -j "$JOBS" "$TREE" 2>&1 > /dev/null
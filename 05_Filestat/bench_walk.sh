@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+#
+# Benchmark chế độ -r của filestat so với find -printf và du, backend
+# statx() đồng bộ so với io_uring (--io=uring), và --du so với
+# du | sort | head
+#
+# Tạo (một lần) cây tổng hợp BENCH_FILES file (mặc định 1 000 000) chia
+# đều vào các thư mục lá 1000 file, lồng 3 cấp. Mỗi lệnh chạy BENCH_RUNS
+# lần, lấy thời gian tốt nhất. BENCH_COLD=1 xóa page cache trước mỗi lần
+# chạy (cần quyền root) để đo trên cache lạnh.
+#
+# Cách dùng: ./bench_walk.sh            hoặc  make bench
+#            BENCH_FILES=100000 BENCH_DIR=/mnt/nvme/tree ./bench_walk.sh
+
+set -euo pipefail
+
+FILES=${BENCH_FILES:-1000000}
+TREE=${BENCH_DIR:-/tmp/filestat_bench_$FILES}
+RUNS=${BENCH_RUNS:-3}
+COLD=${BENCH_COLD:-0}
+FILESTAT=${FILESTAT:-./filestat}
+PER_DIR=1000
+
+# Tạo cây nếu chưa có (file đánh dấu .complete cho biết lần tạo trước đã xong)
+make_tree() {
+    local dirs=$(( (FILES + PER_DIR - 1) / PER_DIR ))
+    local i d count
+
+    if [ -f "$TREE/.complete" ]; then
+        return
+    fi
+    echo "Creating $FILES files in $dirs directories under $TREE ..."
+    rm -rf "$TREE"
+    for (( i = 0; i < dirs; i++ )); do
+        d="$TREE/a$(( i / 100 ))/b$(( i / 10 % 10 ))/c$(( i % 10 ))"
+        count=$(( FILES - i * PER_DIR < PER_DIR ? FILES - i * PER_DIR : PER_DIR ))
+        mkdir -p "$d"
+        (cd "$d" && seq -f 'f%04g' "$count" | xargs touch)
+    done
+    touch "$TREE/.complete"
+}
+
+drop_caches() {
+    if [ "$COLD" = 1 ]; then
+        sync
+        echo 3 > /proc/sys/vm/drop_caches
+    fi
+}
+
+# run <tên> <lệnh...>: in thời gian tốt nhất (ms) và số entry/giây
+run() {
+    local name=$1 best=0 start end ms
+    shift
+    for (( r = 0; r < RUNS; r++ )); do
+        drop_caches
+        start=$(date +%s%N)
+        "$@" > /dev/null
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        if [ "$best" = 0 ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    printf "%-34s %8d ms %12d entries/s\n" "$name" "$best" \
+        $(( ENTRIES * 1000 / (best > 0 ? best : 1) ))
+}
+
+make_tree
+ENTRIES=$(find "$TREE" | wc -l)
+CPUS=$(getconf _NPROCESSORS_ONLN)
+
+echo "Tree: $TREE ($ENTRIES entries), $CPUS CPUs, best of $RUNS, cold cache: $COLD"
+echo
+run "find -printf '%y %s %T@ %p'"    find "$TREE" -printf '%y %s %T@ %p\n'
+run "filestat -r -j 1"              "$FILESTAT" -r -j 1 "$TREE"
+run "filestat -r"                   "$FILESTAT" -r "$TREE"
+run "du -s"                         du -s "$TREE"
+run "filestat -r -s -j 1"           "$FILESTAT" -r -s -j 1 "$TREE"
+run "filestat -r -s"                "$FILESTAT" -r -s "$TREE"
+run "filestat -r -s -j 16"           "$FILESTAT" -r -s -j 16 "$TREE"
+run "filestat -r -s -j 1 --io=uring" "$FILESTAT" -r -s -j 1 --io=uring "$TREE"
+run "filestat -r -s --io=uring"      "$FILESTAT" -r -s --io=uring "$TREE"
+
+# Top-N theo dung lượng: pipeline du | sort | head so với --du
+echo
+run "du | sort -rn | head"          bash -c "du '$TREE' | sort -rn | head"
+run "du -a | sort -rn | head"       bash -c "du -a '$TREE' | sort -rn | head"
+run "filestat --du -j 1"            "$FILESTAT" --du -j 1 "$TREE"
+run "filestat --du"                 "$FILESTAT" --du "$TREE"
@@ -2,16 +2,34 @@
  * @file filestat.c
  * @brief Chương trình chính filestat - Trình kiểm tra siêu dữ liệu file
  * 
- * Chương trình này sử dụng system call lstat() để đọc và hiển thị
+ * Chương trình này sử dụng system call statx() để đọc và hiển thị
  * các thông tin metadata của file/thư mục trên hệ thống Linux
  * 
- * Cách sử dụng: ./filestat <file_path>
+ * Cách sử dụng: ./filestat [-a] [--jobs N] [--format=json] [--fields=...] <file_path>...
+ *               find ... | ./filestat --stdin        (-0: danh sách ngăn bởi NUL)
+ *               ./filestat -r [-s] [-j N] [--io=uring] <directory>...
+ *               ./filestat --du [--top N] [-j N] <directory>...
+ *               ./filestat [--diff=OLD] [--snapshot=NEW] <directory>
+ *               ./filestat --dupes [--min-size N] [-j N] <directory>...
+ *               ./filestat -r [--where=EXPR] [--prune=EXPR] <directory>...
+ *               ./filestat --serve=SOCKET [--cache-size N]
+ *               ./filestat --server=SOCKET [options] <file_path>...
  * 
  * @author Student
  * @date 2026
  */
 
 #include "filestat.h"
+#include "filestat_format.h"
+#include "filestat_du.h"
+#include "filestat_dupes.h"
+#include "filestat_filter.h"
+#include "filestat_list.h"
+#include "filestat_serve.h"
+#include "filestat_snapshot.h"
+#include "filestat_walk.h"
+#include <errno.h>
+#include <getopt.h>
 
 /* ======================== HELPER FUNCTIONS ======================== */
 
@@ -21,17 +39,374 @@
  */
 static void print_usage(const char *program_name)
 {
-    fprintf(stderr, "Usage: %s <file_path>\n", program_name);
+    fprintf(stderr, "Usage: %s [options] <file_path>...\n", program_name);
+    fprintf(stderr, "       %s [options] --stdin [-0]\n", program_name);
+    fprintf(stderr, "       %s -r [-s] [options] <directory>...\n", program_name);
+    fprintf(stderr, "       %s --du [--top N] [-j N] <directory>...\n", program_name);
+    fprintf(stderr, "       %s [--diff=OLD [--verify-files]] [--snapshot=NEW] <directory>\n",
+            program_name);
+    fprintf(stderr, "       %s --dupes [--min-size N] [-j N] <directory>...\n", program_name);
+    fprintf(stderr, "       %s --serve=SOCKET [--cache-size N]\n", program_name);
     fprintf(stderr, "\n");
     fprintf(stderr, "Description:\n");
-    fprintf(stderr, "  Display metadata information of a file or directory.\n");
+    fprintf(stderr, "  Display metadata information of files or directories.\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Arguments:\n");
-    fprintf(stderr, "  file_path    Path to the file or directory to inspect\n");
+    fprintf(stderr, "  file_path    Paths to the files or directories to inspect\n");
+    fprintf(stderr, "\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -a           Show all fields: permissions, links, owner, inode,\n");
+    fprintf(stderr, "               blocks, access/change/birth time, mount ID, attributes\n");
+    fprintf(stderr, "  --stdin      Also read paths from standard input, one per line\n");
+    fprintf(stderr, "  -0           Paths on standard input are NUL-separated (implies --stdin)\n");
+    fprintf(stderr, "  -j, --jobs N Use N threads (default: 1 for file lists, CPUs for -r);\n");
+    fprintf(stderr, "               output keeps the input order\n");
+    fprintf(stderr, "  --io=MODE    'sync' statx() calls (default) or 'uring' to batch\n");
+    fprintf(stderr, "               them through io_uring\n");
+    fprintf(stderr, "  -r           Walk the directory tree recursively, one line per entry:\n");
+    fprintf(stderr, "               <type> <size> <mtime> <path>\n");
+    fprintf(stderr, "  -s           With -r: print only the totals\n");
+    fprintf(stderr, "  --du         Walk recursively and report the disk usage of each tree,\n");
+    fprintf(stderr, "               counting hard-linked files once, with the largest\n");
+    fprintf(stderr, "               directories and files\n");
+    fprintf(stderr, "  --top N      With --du: how many directories and files to list (default %d)\n",
+            DU_TOP_DEFAULT);
+    fprintf(stderr, "  --snapshot=FILE  Write a sorted, mmap-able index of every entry\n");
+    fprintf(stderr, "               (path hash, inode, size, mode, mtime, ctime) to FILE\n");
+    fprintf(stderr, "  --diff=FILE  Rescan and print changes since snapshot FILE, one per line:\n");
+    fprintf(stderr, "               A (added), D (removed) or M (modified) <path>; directories\n");
+    fprintf(stderr, "               whose mtime and ctime are unchanged are not read again\n");
+    fprintf(stderr, "  --verify-files  With --diff: also stat the files of unchanged\n");
+    fprintf(stderr, "               directories (finds in-place edits, costs a full scan)\n");
+    fprintf(stderr, "  --dupes      Find files with identical content: compare sizes, then\n");
+    fprintf(stderr, "               hash the first and last %d KB, then whole files (XXH3);\n",
+            DUPES_EDGE_SIZE / 1024);
+    fprintf(stderr, "               hard links of one file count once\n");
+    fprintf(stderr, "  --min-size N With --dupes: ignore files smaller than N bytes\n");
+    fprintf(stderr, "               (N >= 1, default 1: empty files are never duplicates)\n");
+    fprintf(stderr, "  --where=EXPR With -r or --dupes: only entries matching EXPR, e.g.\n");
+    fprintf(stderr, "               'type==reg && size>1M && mtime<30d'; fields: name, path,\n");
+    fprintf(stderr, "               type, size, blocks, nlink, ino, uid, gid, mode, mtime,\n");
+    fprintf(stderr, "               atime, ctime, btime; && || ! ( ); names are globs.\n");
+    fprintf(stderr, "               Entries ruled out by name and type are never stat'ed\n");
+    fprintf(stderr, "  --prune=EXPR With -r, --du or --dupes: do not enter directories\n");
+    fprintf(stderr, "               matching EXPR, e.g. 'name==.git' (repeatable)\n");
+    fprintf(stderr, "  --serve=SOCK Run a daemon answering metadata queries on Unix socket SOCK\n");
+    fprintf(stderr, "               from an in-memory LRU cache kept fresh with inotify;\n");
+    fprintf(stderr, "               SIGUSR1 prints cache statistics, SIGINT/SIGTERM stop it\n");
+    fprintf(stderr, "  --cache-size N  With --serve: paths kept in the cache (default %d)\n",
+            CACHE_SIZE_DEFAULT);
+    fprintf(stderr, "  --server=SOCK  For file lists: ask the daemon on SOCK instead of\n");
+    fprintf(stderr, "               calling statx() (same output, except atime and changes\n");
+    fprintf(stderr, "               inotify does not report, such as writes through mmap)\n");
+    fprintf(stderr, "  --format=FMT 'text' (default), 'json' (JSON Lines), 'csv', 'tsv', or\n");
+    fprintf(stderr, "               'bin' (fixed 128-byte records, see filestat_format.h)\n");
+    fprintf(stderr, "  --fields=F,. Fields to fetch and print, in this order: type, size,\n");
+    fprintf(stderr, "               mtime, mode, nlink, uid, gid, ino, blocks, atime, ctime,\n");
+    fprintf(stderr, "               btime, mnt_id, attrs, or 'all' (default: type,size,mtime)\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Example:\n");
     fprintf(stderr, "  %s /home/user/document.txt\n", program_name);
-    fprintf(stderr, "  %s /etc\n", program_name);
+    fprintf(stderr, "  %s /etc /etc/passwd /etc/hosts\n", program_name);
+    fprintf(stderr, "  find /srv -name '*.log' -print0 | %s -0 --jobs 8\n", program_name);
+    fprintf(stderr, "  %s -r -s /usr\n", program_name);
+    fprintf(stderr, "  %s --du --top 20 /home\n", program_name);
+    fprintf(stderr, "  %s -r --format=csv --fields=size,mtime /srv > srv.csv\n", program_name);
+    fprintf(stderr, "  %s --snapshot=srv.snap /srv\n", program_name);
+    fprintf(stderr, "  %s --diff=srv.snap --snapshot=srv.snap /srv\n", program_name);
+    fprintf(stderr, "  %s --dupes --min-size 1048576 /home /mnt/backup\n", program_name);
+    fprintf(stderr, "  %s -r --where='name==*.log && mtime>7d' --prune=name==.git /srv\n",
+            program_name);
+    fprintf(stderr, "  %s --serve=/tmp/filestat.sock &\n", program_name);
+    fprintf(stderr, "  find /srv | %s --server=/tmp/filestat.sock --stdin --format=json\n",
+            program_name);
+}
+
+/**
+ * @brief Nối một biểu thức --where/--prune lặp lại: "(cũ) op (mới)"
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int append_expr(char **expr, const char *add, const char *op)
+{
+    char *joined;
+    size_t len;
+
+    if (*expr == NULL) {
+        *expr = strdup(add);
+        return *expr != NULL ? 0 : -1;
+    }
+    len = strlen(*expr) + strlen(add) + strlen(op) + 5;
+    joined = malloc(len);
+    if (joined == NULL) {
+        return -1;
+    }
+    snprintf(joined, len, "(%s)%s(%s)", *expr, op, add);
+    free(*expr);
+    *expr = joined;
+    return 0;
+}
+
+/**
+ * @brief Dịch các biểu thức --where/--prune vào options (rồi giải phóng văn bản)
+ * @return 0 nếu thành công, -1 nếu sai cú pháp (đã báo trên stderr)
+ */
+static int compile_filters(walk_options_t *options, char *where, char *prune)
+{
+    int result = 0;
+
+    if (where != NULL && (options->where = filter_compile(where)) == NULL) {
+        result = -1;
+    }
+    if (result == 0 && prune != NULL && (options->prune = filter_compile(prune)) == NULL) {
+        result = -1;
+    }
+    free(where);
+    free(prune);
+    return result;
+}
+
+/**
+ * @brief Giải phóng các biểu thức sau một chế độ duyệt
+ * @return status
+ */
+static int release_filters(walk_options_t *options, int status)
+{
+    filter_free(options->where);
+    filter_free(options->prune);
+    options->where = NULL;
+    options->prune = NULL;
+    return status;
+}
+
+/**
+ * @brief Chế độ -r: duyệt đệ quy một cây thư mục
+ * @param root Thư mục gốc
+ * @param options Tùy chọn duyệt
+ * @return EXIT_SUCCESS nếu đọc được toàn bộ cây, EXIT_FAILURE nếu có lỗi
+ */
+static int run_recursive(const char *root, const walk_options_t *options)
+{
+    walk_stats_t stats;
+    int result = walk_tree(root, options, &stats);
+    bool found = stats.dirs + stats.files + stats.symlinks + stats.others + stats.filtered > 0;
+
+    /* Không in bảng tổng kết nếu ngay cả thư mục gốc cũng không đọc được */
+    if (options->du != NULL) {
+        if (found) {
+            print_du_report(options->du);
+        }
+        fflush(stdout);
+    } else if (options->summary_only && found) {
+        print_walk_stats(root, &stats);
+        fflush(stdout);
+    }
+    return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Chế độ --du: tổng dung lượng và top-N của từng cây
+ * @param roots Các thư mục gốc
+ * @param count Số thư mục gốc
+ * @param options Tùy chọn duyệt (du được gán cho mỗi cây)
+ * @param top Số thư mục/file lớn nhất cần liệt kê
+ * @return EXIT_SUCCESS nếu đọc được mọi cây, EXIT_FAILURE nếu có lỗi
+ */
+static int run_du(char *const *roots, size_t count, walk_options_t *options, size_t top)
+{
+    du_report_t report;
+    int status = EXIT_SUCCESS;
+
+    for (size_t i = 0; i < count; i++) {
+        if (du_report_init(&report, top) != 0) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        options->du = &report;
+        if (run_recursive(roots[i], options) != EXIT_SUCCESS) {
+            status = EXIT_FAILURE;
+        }
+        du_report_free(&report);
+    }
+    options->du = NULL;
+    return status;
+}
+
+/**
+ * @brief Chế độ --snapshot/--diff: so một cây với snapshot cũ và/hoặc ghi snapshot mới
+ *
+ * Các thay đổi được in lên stdout, dòng tổng kết lên stderr. Snapshot
+ * mới vẫn được ghi khi một phần cây không đọc được (phần đó vắng mặt),
+ * nhưng không được ghi nếu ngay cả gốc cũng không đọc được.
+ *
+ * @param root Thư mục gốc
+ * @param options Tùy chọn duyệt (old, build và out được gán ở đây)
+ * @param snapshot_path Snapshot cần ghi, NULL nếu không ghi
+ * @param diff_path Snapshot cũ để so sánh, NULL nếu không so sánh
+ * @return EXIT_SUCCESS nếu thành công, EXIT_FAILURE nếu có lỗi
+ */
+static int run_snapshot(const char *root, walk_options_t *options, const char *snapshot_path,
+                        const char *diff_path)
+{
+    walk_stats_t stats;
+    writer_t out;
+    int status = EXIT_SUCCESS;
+    bool found;
+
+    if (writer_init(&out, STDOUT_FILENO, WRITER_BUFFER_SIZE) != 0) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    if (diff_path != NULL && (options->old = snapshot_open(diff_path)) == NULL) {
+        writer_close(&out);
+        return EXIT_FAILURE;
+    }
+    if (snapshot_path != NULL && (options->build = snap_builder_create(MAX_THREADS)) == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        snapshot_close(options->old);
+        writer_close(&out);
+        return EXIT_FAILURE;
+    }
+    options->out = &out;
+
+    if (walk_tree(root, options, &stats) != 0) {
+        status = EXIT_FAILURE;
+    }
+    found = stats.dirs + stats.files + stats.symlinks + stats.others > 0;
+    if (found && options->old != NULL) {
+        uint64_t removed = snapshot_report_removed(options->old, root, &out);
+        fprintf(stderr, "%llu added, %llu removed, %llu modified "
+                "(%llu directories checked, %llu unchanged)\n",
+                (unsigned long long)stats.added, (unsigned long long)removed,
+                (unsigned long long)stats.modified, (unsigned long long)stats.dirs,
+                (unsigned long long)stats.unchanged_dirs);
+    }
+    if (writer_close(&out) != 0) {
+        fprintf(stderr, "Error: Cannot write output: %s\n", strerror(out.error));
+        status = EXIT_FAILURE;
+    }
+    /* Snapshot cũ vẫn được map tới đây: có thể ghi đè chính nó (qua rename()) */
+    if (found && options->build != NULL && snap_builder_write(options->build, snapshot_path) != 0) {
+        status = EXIT_FAILURE;
+    }
+
+    snap_builder_destroy(options->build);
+    snapshot_close(options->old);
+    options->build = NULL;
+    options->old = NULL;
+    options->out = NULL;
+    return status;
+}
+
+/**
+ * @brief Chế độ --dupes: tìm file trùng nội dung trong mọi cây
+ *
+ * Mọi cây được duyệt trước (chỉ statx()), rồi các ứng viên được băm và
+ * so sánh cùng nhau, nên bản sao ở hai cây khác nhau cũng được tìm thấy.
+ *
+ * @param roots Các thư mục (hoặc file) gốc
+ * @param count Số gốc
+ * @param options Tùy chọn duyệt (dupes được gán ở đây)
+ * @param min_size Bỏ qua file nhỏ hơn
+ * @return EXIT_SUCCESS nếu đọc được mọi file, EXIT_FAILURE nếu có lỗi
+ */
+static int run_dupes(char *const *roots, size_t count, walk_options_t *options,
+                     uint64_t min_size)
+{
+    dupes_stats_t stats;
+    walk_stats_t walk_stats;
+    writer_t out;
+    int status = EXIT_SUCCESS;
+
+    options->dupes = dupe_set_create(MAX_THREADS, min_size);
+    if (options->dupes == NULL || writer_init(&out, STDOUT_FILENO, WRITER_BUFFER_SIZE) != 0) {
+        fprintf(stderr, "Error: Out of memory\n");
+        dupe_set_destroy(options->dupes);
+        options->dupes = NULL;
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (walk_tree(roots[i], options, &walk_stats) != 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (find_dupes(options->dupes, options->threads, &out, &stats) != 0) {
+        fprintf(stderr, "Error: Out of memory\n");
+        status = EXIT_FAILURE;
+    } else {
+        print_dupes_stats(&out, &stats);
+        if (stats.errors > 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+    if (writer_close(&out) != 0) {
+        fprintf(stderr, "Error: Cannot write output: %s\n", strerror(out.error));
+        status = EXIT_FAILURE;
+    }
+    dupe_set_destroy(options->dupes);
+    options->dupes = NULL;
+    return status;
+}
+
+/**
+ * @brief Mở output: dòng tiêu đề CSV/TSV hoặc header bin
+ * @return 0 nếu thành công, -1 nếu lỗi (đã báo trên stderr)
+ */
+static int begin_output(writer_t *out, output_format_t format, unsigned int fields,
+                        bin_sink_t **bin)
+{
+    *bin = NULL;
+    if (writer_init(out, STDOUT_FILENO, WRITER_BUFFER_SIZE) != 0) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return -1;
+    }
+    if (format == FORMAT_BIN) {
+        *bin = bin_sink_open(out, fields);
+        if (*bin == NULL) {
+            writer_close(out);
+            return -1;
+        }
+    }
+    format_header(out, format, fields);
+    return 0;
+}
+
+/**
+ * @brief Đóng output: path blob và trailer bin, rồi flush
+ * @return 0 nếu thành công, -1 nếu lỗi ghi
+ */
+static int end_output(writer_t *out, bin_sink_t *bin)
+{
+    int result = bin_sink_close(bin);
+
+    if (writer_close(out) != 0) {
+        fprintf(stderr, "Error: Cannot write output: %s\n", strerror(out->error));
+        result = -1;
+    }
+    return result;
+}
+
+/**
+ * @brief Chế độ thường: metadata của từng path, theo thứ tự input
+ * @param paths Các path từ dòng lệnh
+ * @param count Số path
+ * @param options Tùy chọn
+ * @return EXIT_SUCCESS nếu mọi path đều đọc được, EXIT_FAILURE nếu có lỗi
+ */
+static int run_list(char *const *paths, size_t count, list_options_t *options)
+{
+    writer_t out;
+    int result;
+
+    /* Toàn bộ output đi qua một writer_t duy nhất */
+    if (begin_output(&out, options->format, options->fields, &options->bin) != 0) {
+        return EXIT_FAILURE;
+    }
+    result = list_paths(paths, count, options, &out);
+    if (end_output(&out, options->bin) != 0) {
+        result = -1;
+    }
+    return result == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /* ======================== MAIN FUNCTION ======================== */
@@ -40,9 +415,10 @@ static void print_usage(const char *program_name)
  * @brief Điểm vào chính của chương trình
  * 
  * Workflow:
- * 1. Kiểm tra số lượng tham số dòng lệnh
- * 2. Gọi lstat() để lấy metadata của file
- * 3. In thông tin metadata ra console
+ * 1. Đọc các tùy chọn và kiểm tra số lượng tham số dòng lệnh
+ * 2. Với -r: duyệt đệ quy từng thư mục (xem filestat_walk.h)
+ * 3. Ngược lại: statx() từng path (dòng lệnh rồi stdin) theo lô và in
+ *    metadata ra console theo thứ tự input (xem filestat_list.h)
  * 
  * @param argc Số lượng tham số dòng lệnh
  * @param argv Mảng các tham số dòng lệnh
@@ -50,50 +426,313 @@ static void print_usage(const char *program_name)
  */
 int main(int argc, char *argv[])
 {
-    const char *filepath;   /* Đường dẫn file cần kiểm tra */
-    struct stat file_stat;  /* Struct để lưu thông tin metadata */
-    int result;             /* Kết quả trả về từ lstat() */
+    bool recursive = false; /* -r: duyệt đệ quy */
+    bool use_stdin = false; /* --stdin / -0: đọc thêm path từ stdin */
+    bool du = false;        /* --du: tổng dung lượng theo thư mục */
+    bool dupes = false;     /* --dupes: tìm file trùng nội dung */
+    const char *snapshot_path = NULL;       /* --snapshot */
+    const char *diff_path = NULL;           /* --diff */
+    unsigned int top = DU_TOP_DEFAULT;      /* --top */
+    uint64_t min_size = 1;                  /* --min-size */
+    bool min_size_set = false;              /* --min-size có trên dòng lệnh */
+    char *where = NULL;                     /* --where, các lần lặp nối bằng && */
+    char *prune = NULL;                     /* --prune, các lần lặp nối bằng || */
+    const char *serve_path = NULL;          /* --serve */
+    size_t cache_size = 0;                  /* --cache-size, 0 = mặc định */
+    unsigned int fields = FIELDS_DEFAULT;   /* Các trường cần in */
+    unsigned int jobs = 0;                  /* -j/--jobs, 0 = mặc định */
+    io_mode_t io = IO_SYNC;
+    output_format_t format = FORMAT_TEXT;   /* --format */
+    walk_options_t walk_options = { 0, false, IO_SYNC, FORMAT_TEXT, 0, NULL, NULL, NULL,
+                                    NULL, NULL, false, NULL, NULL, NULL };
+    list_options_t list_options = { FORMAT_TEXT, 0, 0, IO_SYNC, -1, '\n', NULL, NULL };
+    int opt;
+    
+    /* Các tùy chọn dài */
+    static const struct option long_options[] = {
+        { "io",     required_argument, NULL, 'I' },
+        { "format", required_argument, NULL, 'F' },
+        { "fields", required_argument, NULL, 'f' },
+        { "du",     no_argument,       NULL, 'D' },
+        { "top",    required_argument, NULL, 'T' },
+        { "snapshot",     required_argument, NULL, 'P' },
+        { "diff",         required_argument, NULL, 'd' },
+        { "verify-files", no_argument,       NULL, 'v' },
+        { "dupes",        no_argument,       NULL, 'U' },
+        { "min-size",     required_argument, NULL, 'M' },
+        { "where",        required_argument, NULL, 'W' },
+        { "prune",        required_argument, NULL, 'X' },
+        { "serve",        required_argument, NULL, 'E' },
+        { "server",       required_argument, NULL, 'K' },
+        { "cache-size",   required_argument, NULL, 'Z' },
+        { "jobs",   required_argument, NULL, 'j' },
+        { "stdin",  no_argument,       NULL, 'S' },
+        { "help",   no_argument,       NULL, 'h' },
+        { NULL,     0,                 NULL, 0   }
+    };
+    
+    /* Bước 1: Đọc các tùy chọn */
+    while ((opt = getopt_long(argc, argv, "arsj:0h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'a':
+                fields = FIELDS_ALL;
+                break;
+            case 'I':
+                if (strcmp(optarg, "uring") == 0) {
+                    io = IO_URING;
+                } else if (strcmp(optarg, "sync") == 0) {
+                    io = IO_SYNC;
+                } else {
+                    fprintf(stderr, "Error: Invalid I/O mode '%s' (uring, sync)\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'F':
+                if (parse_format(optarg, &format) != 0) {
+                    fprintf(stderr, "Error: Invalid format '%s' (text, json, csv, tsv, bin)\n",
+                            optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'f':
+                if (parse_fields(optarg, &fields) != 0) {
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'D':
+                du = true;
+                break;
+            case 'T': {
+                char *end;
+                long n = strtol(optarg, &end, 10);
+                if (*end != '\0' || n < 0 || n > DU_TOP_MAX) {
+                    fprintf(stderr, "Error: Invalid --top count '%s' (0-%d)\n", optarg, DU_TOP_MAX);
+                    return EXIT_FAILURE;
+                }
+                top = (unsigned)n;
+                break;
+            }
+            case 'P':
+                snapshot_path = optarg;
+                break;
+            case 'd':
+                diff_path = optarg;
+                break;
+            case 'v':
+                walk_options.verify_files = true;
+                break;
+            case 'U':
+                dupes = true;
+                break;
+            case 'M': {
+                char *end;
+                unsigned long long n;
+                errno = 0;
+                n = strtoull(optarg, &end, 10);
+                if (end == optarg || *end != '\0' || optarg[0] == '-' || errno != 0) {
+                    fprintf(stderr, "Error: Invalid --min-size '%s'\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                if (n == 0) {
+                    fprintf(stderr, "Error: --min-size must be at least 1 "
+                            "(empty files are never reported as duplicates)\n");
+                    return EXIT_FAILURE;
+                }
+                min_size = n;
+                min_size_set = true;
+                break;
+            }
+            case 'W':
+            case 'X':
+                if (append_expr(opt == 'W' ? &where : &prune, optarg,
+                                opt == 'W' ? " && " : " || ") != 0) {
+                    fprintf(stderr, "Error: Out of memory\n");
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'E':
+                serve_path = optarg;
+                break;
+            case 'K':
+                list_options.server = optarg;
+                break;
+            case 'Z': {
+                char *end;
+                long n = strtol(optarg, &end, 10);
+                if (*end != '\0' || n < 1 || n > (long)CACHE_SIZE_MAX) {
+                    fprintf(stderr, "Error: Invalid --cache-size '%s' (1-%u)\n", optarg,
+                            CACHE_SIZE_MAX);
+                    return EXIT_FAILURE;
+                }
+                cache_size = (size_t)n;
+                break;
+            }
+            case 'r':
+                recursive = true;
+                break;
+            case 's':
+                walk_options.summary_only = true;
+                break;
+            case 'S':
+                use_stdin = true;
+                break;
+            case '0':
+                use_stdin = true;
+                list_options.delimiter = '\0';
+                break;
+            case 'j': {
+                char *end;
+                long threads = strtol(optarg, &end, 10);
+                if (*end != '\0' || threads < 1 || threads > MAX_THREADS) {
+                    fprintf(stderr, "Error: Invalid thread count '%s' (1-%d)\n",
+                            optarg, MAX_THREADS);
+                    return EXIT_FAILURE;
+                }
+                jobs = (unsigned)threads;
+                break;
+            }
+            default:
+                print_usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
     
+    /* Chế độ daemon: không có path, chạy tới khi nhận SIGINT/SIGTERM */
+    if (cache_size != 0 && serve_path == NULL) {
+        fprintf(stderr, "Error: --cache-size requires --serve\n");
+        return EXIT_FAILURE;
+    }
+    if (serve_path != NULL) {
+        if (optind != argc || use_stdin || recursive || du || dupes || snapshot_path != NULL ||
+            diff_path != NULL || where != NULL || prune != NULL || list_options.server != NULL) {
+            fprintf(stderr, "Error: --serve takes no paths and no options other than "
+                    "--cache-size\n");
+            return EXIT_FAILURE;
+        }
+        return serve_run(serve_path, cache_size ? cache_size : CACHE_SIZE_DEFAULT) == 0 ?
+               EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     /* 
-     * Bước 1: Kiểm tra số lượng tham số
-     * Chương trình cần chính xác 2 tham số: tên chương trình và đường dẫn file
+     * Kiểm tra số lượng tham số
+     * Cần ít nhất một path trên dòng lệnh, trừ khi đọc path từ stdin
      */
-    if (argc != 2) {
+    if (optind == argc && !use_stdin) {
         print_usage(argv[0]);
         return EXIT_FAILURE;
     }
     
-    /* Lấy đường dẫn file từ tham số dòng lệnh */
-    filepath = argv[1];
-    
-    /* 
-     * Bước 2: Gọi lstat() để lấy thông tin file
-     * 
-     * lstat() vs stat():
-     * - stat(): Nếu file là symbolic link, sẽ theo dõi link và 
-     *           trả về thông tin của file đích
-     * - lstat(): Trả về thông tin của chính symbolic link
-     * 
-     * Sử dụng lstat() để có thể nhận diện được symbolic links
-     */
-    result = lstat(filepath, &file_stat);
-    
-    /* Kiểm tra kết quả của lstat() */
-    if (result == -1) {
-        /* 
-         * Nếu lstat() trả về -1, có lỗi xảy ra
-         * perror() sẽ in ra thông báo lỗi tương ứng với errno
-         */
-        perror("Error");
-        fprintf(stderr, "Cannot get information for: %s\n", filepath);
+    /* Bước 2: Duyệt đệ quy từng thư mục gốc */
+    if (walk_options.verify_files && diff_path == NULL) {
+        fprintf(stderr, "Error: --verify-files requires --diff\n");
         return EXIT_FAILURE;
     }
+    if (list_options.server != NULL &&
+        (recursive || du || dupes || snapshot_path != NULL || diff_path != NULL ||
+         jobs > 1 || io == IO_URING)) {
+        fprintf(stderr, "Error: --server only applies to file lists and cannot be combined "
+                "with -r, --du, --dupes, --snapshot, --diff, --jobs or --io=uring\n");
+        return EXIT_FAILURE;
+    }
+    if (min_size_set && !dupes) {
+        fprintf(stderr, "Error: --min-size requires --dupes\n");
+        return EXIT_FAILURE;
+    }
+    if ((where != NULL || prune != NULL) && !recursive && !du && !dupes) {
+        fprintf(stderr, "Error: --where and --prune require -r, --du or --dupes\n");
+        return EXIT_FAILURE;
+    }
+    if (where != NULL && du) {
+        fprintf(stderr, "Error: --where cannot be combined with --du (use --prune)\n");
+        return EXIT_FAILURE;
+    }
+    if (dupes) {
+        if (use_stdin || recursive || du || snapshot_path != NULL || diff_path != NULL ||
+            format != FORMAT_TEXT) {
+            fprintf(stderr, "Error: --dupes cannot be combined with -r, --du, --snapshot, "
+                    "--diff, --stdin or --format\n");
+            return EXIT_FAILURE;
+        }
+        walk_options.threads = jobs;
+        walk_options.io = io;
+        if (compile_filters(&walk_options, where, prune) != 0) {
+            return EXIT_FAILURE;
+        }
+        return release_filters(&walk_options,
+                               run_dupes(argv + optind, (size_t)(argc - optind), &walk_options,
+                                         min_size));
+    }
+    if (snapshot_path != NULL || diff_path != NULL) {
+        if (use_stdin || recursive || du || format != FORMAT_TEXT || argc - optind != 1 ||
+            where != NULL || prune != NULL) {
+            fprintf(stderr, "Error: --snapshot and --diff take exactly one directory and "
+                    "cannot be combined with -r, --du, --stdin, --format, --where or --prune\n");
+            return EXIT_FAILURE;
+        }
+        walk_options.threads = jobs;
+        walk_options.io = io;
+        return run_snapshot(argv[optind], &walk_options, snapshot_path, diff_path);
+    }
+    if (du) {
+        if (use_stdin || format != FORMAT_TEXT) {
+            fprintf(stderr, "Error: --du cannot be combined with --stdin or --format\n");
+            return EXIT_FAILURE;
+        }
+        walk_options.threads = jobs;
+        walk_options.io = io;
+        if (compile_filters(&walk_options, NULL, prune) != 0) {
+            return EXIT_FAILURE;
+        }
+        return release_filters(&walk_options,
+                               run_du(argv + optind, (size_t)(argc - optind), &walk_options, top));
+    }
+    if (recursive) {
+        writer_t out;
+        int status = EXIT_SUCCESS;
+        
+        if (use_stdin) {
+            fprintf(stderr, "Error: --stdin cannot be combined with -r\n");
+            return EXIT_FAILURE;
+        }
+        if (walk_options.summary_only && format != FORMAT_TEXT) {
+            fprintf(stderr, "Error: -s cannot be combined with --format\n");
+            return EXIT_FAILURE;
+        }
+        walk_options.threads = jobs;
+        walk_options.io = io;
+        walk_options.format = format;
+        walk_options.fields = fields;
+        if (compile_filters(&walk_options, where, prune) != 0) {
+            return EXIT_FAILURE;
+        }
+        if (begin_output(&out, format, fields, &walk_options.bin) != 0) {
+            return release_filters(&walk_options, EXIT_FAILURE);
+        }
+        walk_options.out = &out;
+        for (int i = optind; i < argc; i++) {
+            if (run_recursive(argv[i], &walk_options) != EXIT_SUCCESS) {
+                status = EXIT_FAILURE;
+            }
+        }
+        if (end_output(&out, walk_options.bin) != 0) {
+            status = EXIT_FAILURE;
+        }
+        return release_filters(&walk_options, status);
+    }
     
     /* 
-     * Bước 3: In thông tin metadata
-     * Gọi hàm utility để định dạng và in thông tin
+     * Bước 3: Gọi statx() cho từng path và in metadata
+     * 
+     * AT_SYMLINK_NOFOLLOW: giống lstat(), trả về thông tin của chính
+     * symbolic link thay vì file đích, để nhận diện được symbolic links
+     * 
+     * Mask chỉ chứa các trường sẽ in: filesystem có thể bỏ qua các
+     * trường đắt (birth time, mount ID) khi không được yêu cầu
      */
-    print_file_info(filepath, &file_stat);
-    
-    return EXIT_SUCCESS;
+    list_options.format = format;
+    list_options.fields = fields;
+    list_options.jobs = jobs;
+    list_options.io = io;
+    list_options.input_fd = use_stdin ? STDIN_FILENO : -1;
+    return run_list(argv + optind, (size_t)(argc - optind), &list_options);
 }
@@ -3,26 +3,102 @@
  * @brief Header file cho chương trình filestat
  * 
  * Chứa các khai báo cần thiết cho việc đọc và hiển thị
- * siêu dữ liệu (metadata) của file sử dụng lstat()
+ * siêu dữ liệu (metadata) của file sử dụng statx()
  */
 
 #ifndef FILESTAT_H
 #define FILESTAT_H
 
-/* Feature test macro - bật các hàm POSIX như lstat(), S_ISSOCK() */
-#define _XOPEN_SOURCE 700
+/*
+ * Feature test macro - bật các hàm POSIX như lstat(), S_ISSOCK() và các
+ * hàm riêng của Linux (openat/fstatat, syscall()) dùng trong chế độ -r
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 
 /* ======================== SYSTEM HEADERS ======================== */
 #include <stdio.h>      /* printf, fprintf, perror */
 #include <stdlib.h>     /* exit, EXIT_SUCCESS, EXIT_FAILURE */
 #include <sys/types.h>  /* Các kiểu dữ liệu hệ thống */
-#include <sys/stat.h>   /* struct stat, lstat(), S_ISREG, S_ISDIR, S_ISLNK */
+#include <sys/stat.h>   /* struct stat, statx(), S_ISREG, S_ISDIR, S_ISLNK */
+#include <fcntl.h>      /* AT_FDCWD, AT_SYMLINK_NOFOLLOW */
+#include <stdint.h>     /* uint64_t */
+#include <stdbool.h>    /* bool */
+#include <pthread.h>    /* pthread_mutex_t (writer_t dùng chung giữa các luồng) */
 #include <unistd.h>     /* Hằng số POSIX */
 #include <time.h>       /* ctime(), strftime(), localtime() */
 #include <string.h>     /* strlen() */
 
 /* ======================== CONSTANTS ======================== */
 #define TIME_BUFFER_SIZE 64   /* Kích thước buffer cho chuỗi thời gian */
+#define ATTR_BUFFER_SIZE 128  /* Kích thước buffer cho danh sách thuộc tính */
+#define WRITER_BUFFER_SIZE (1 << 20)   /* Buffer output của writer_t (1 MB) */
+#define MAX_THREADS      64   /* Số luồng tối đa (-j/--jobs) */
+
+/*
+ * Các trường metadata có thể yêu cầu (bitmask)
+ *
+ * statx() chỉ được yêu cầu các trường thật sự cần in (xem
+ * fields_to_statx_mask()), nên filesystem không phải tính những trường
+ * đắt như birth time khi không ai dùng tới.
+ */
+#define FIELD_TYPE    (1u << 0)   /* Loại file */
+#define FIELD_SIZE    (1u << 1)   /* Kích thước (bytes) */
+#define FIELD_MTIME   (1u << 2)   /* Thời gian sửa đổi */
+#define FIELD_MODE    (1u << 3)   /* Quyền truy cập */
+#define FIELD_NLINK   (1u << 4)   /* Số hard link */
+#define FIELD_UID     (1u << 5)   /* Chủ sở hữu */
+#define FIELD_GID     (1u << 6)   /* Nhóm */
+#define FIELD_INO     (1u << 7)   /* Số inode */
+#define FIELD_BLOCKS  (1u << 8)   /* Số block 512 byte trên đĩa */
+#define FIELD_ATIME   (1u << 9)   /* Thời gian truy cập */
+#define FIELD_CTIME   (1u << 10)  /* Thời gian đổi inode */
+#define FIELD_BTIME   (1u << 11)  /* Thời gian tạo (birth time) */
+#define FIELD_MNT_ID  (1u << 12)  /* ID của mount chứa file */
+#define FIELD_ATTRS   (1u << 13)  /* Thuộc tính (immutable, append, ...) */
+
+#define FIELDS_DEFAULT (FIELD_TYPE | FIELD_SIZE | FIELD_MTIME)
+#define FIELDS_ALL     ((FIELD_ATTRS << 1) - 1)
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Cách lấy metadata khi có nhiều entry (-r, nhiều path)
+ */
+typedef enum {
+    IO_SYNC = 0,             /* statx() đồng bộ (trên thread pool nếu có -j) */
+    IO_URING                 /* Cả lô qua io_uring, quay về IO_SYNC nếu không có */
+} io_mode_t;
+
+/**
+ * @brief Writer có buffer lớn cho stdout
+ *
+ * Output của mọi file được ghép vào một buffer và ghi bằng một lần
+ * write() khi đầy, thay vì nhiều lần printf() (mỗi lần một khóa stdio
+ * và một lần phân tích format) cho mỗi file.
+ */
+typedef struct {
+    int fd;                  /* File descriptor đích */
+    char *data;
+    size_t len;
+    size_t cap;
+    int error;               /* errno của lần ghi lỗi đầu tiên, 0 nếu chưa lỗi */
+    pthread_mutex_t *lock;   /* != NULL: mỗi lần flush giữ khóa này (nhiều writer chung fd) */
+} writer_t;
+
+/**
+ * @brief Tên của một thuộc tính statx (STATX_ATTR_*)
+ */
+typedef struct {
+    uint64_t bit;
+    const char *name;
+} attribute_name_t;
+
+#define NUM_ATTRIBUTE_NAMES 9
+
+/* Bảng tên thuộc tính, theo thứ tự in (filestat_utils.c) */
+extern const attribute_name_t attribute_names[NUM_ATTRIBUTE_NAMES];
 
 /* ======================== FUNCTION PROTOTYPES ======================== */
 
@@ -33,6 +109,13 @@
  */
 const char* get_file_type(mode_t mode);
 
+/**
+ * @brief Chuyển tập trường cần in thành mask cho statx()
+ * @param fields Tổ hợp các FIELD_*
+ * @return Mask STATX_* tương ứng
+ */
+unsigned int fields_to_statx_mask(unsigned int fields);
+
 /**
  * @brief Định dạng timestamp thành chuỗi readable
  * @param mtime Giá trị time_t cần chuyển đổi
@@ -41,11 +124,84 @@ const char* get_file_type(mode_t mode);
  */
 void format_time(time_t mtime, char *buffer, size_t buffer_size);
 
+/**
+ * @brief Định dạng kích thước dạng ngắn giống du -h ("512", "4.0K", "1.5G")
+ * @param bytes Số byte
+ * @param buffer Buffer để lưu chuỗi kết quả
+ * @param buffer_size Kích thước của buffer
+ */
+void format_human(uint64_t bytes, char *buffer, size_t buffer_size);
+
+/**
+ * @brief Liệt kê các thuộc tính statx (immutable, append, ...) của file
+ * @param attributes stx_attributes
+ * @param supported stx_attributes_mask (thuộc tính filesystem hỗ trợ)
+ * @param buffer Buffer để lưu chuỗi kết quả
+ * @param buffer_size Kích thước của buffer
+ */
+void format_attributes(uint64_t attributes, uint64_t supported,
+                       char *buffer, size_t buffer_size);
+
 /**
  * @brief In thông tin metadata của file
+ * @param out Writer nhận output
  * @param filepath Đường dẫn file
- * @param file_stat Con trỏ đến struct stat chứa thông tin file
+ * @param file_stat Con trỏ đến struct statx chứa thông tin file
+ * @param fields Các trường cần in (FIELD_*)
+ */
+void print_file_info(writer_t *out, const char *filepath, const struct statx *file_stat,
+                     unsigned int fields);
+
+/* ---- Buffered output (filestat_output.c) ---- */
+
+/**
+ * @brief Khởi tạo writer
+ * @param w Writer
+ * @param fd File descriptor đích (thường là STDOUT_FILENO)
+ * @param cap Kích thước buffer
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+int writer_init(writer_t *w, int fd, size_t cap);
+
+/**
+ * @brief Ghi phần còn lại trong buffer rồi giải phóng writer
+ * @return 0 nếu mọi lần ghi thành công, -1 nếu có lỗi
+ */
+int writer_close(writer_t *w);
+
+/**
+ * @brief Ghi buffer ra fd
+ * @return 0 nếu thành công, -1 nếu lỗi (lỗi đầu tiên lưu trong w->error)
+ */
+int writer_flush(writer_t *w);
+
+/**
+ * @brief Thêm len byte vào buffer (flush khi đầy)
+ */
+void writer_write(writer_t *w, const void *data, size_t len);
+
+/**
+ * @brief Lấy chỗ trống liên tục trong buffer (flush trước nếu thiếu)
+ * @param w Writer
+ * @param len Số byte cần, không quá w->cap
+ * @return Con trỏ tới chỗ trống; ghi xong gọi writer_commit()
+ */
+char *writer_reserve(writer_t *w, size_t len);
+
+/**
+ * @brief Xác nhận đã ghi tới end trong chỗ trống của writer_reserve()
+ */
+void writer_commit(writer_t *w, const char *end);
+
+/**
+ * @brief Thêm một chuỗi kết thúc bằng '\0'
+ */
+void writer_puts(writer_t *w, const char *text);
+
+/**
+ * @brief Thêm chuỗi định dạng kiểu printf
  */
-void print_file_info(const char *filepath, const struct stat *file_stat);
+void writer_printf(writer_t *w, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
 
 #endif /* FILESTAT_H */
@@ -0,0 +1,781 @@
+/**
+ * @file filestat_cache.c
+ * @brief Cache metadata theo path: bảng băm, LRU và invalidation bằng inotify
+ */
+
+#include "filestat_cache.h"
+#include "filestat_hash.h"
+#include <errno.h>
+#include <limits.h>
+#include <sys/inotify.h>
+
+/* ======================== CONSTANTS ======================== */
+
+/*
+ * IN_DONT_FOLLOW | IN_ONLYDIR: chỉ watch thư mục thật, nên mỗi watch
+ * nằm đúng trên path của nó và sự kiện của thư mục cha (đổi tên, xóa,
+ * chmod) luôn tới được. Path đi qua symlink bị từ chối (ENOTDIR).
+ */
+#define WATCH_MASK   (IN_ATTRIB | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | \
+                      IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW)
+/*
+ * Watch trên inode của một entry không phải thư mục (file, symlink, ...):
+ * ghi và đổi nlink qua một hard link ở thư mục khác chỉ báo ở đây, không
+ * báo ở thư mục cha của path đã cache.
+ */
+#define FILE_WATCH_MASK (IN_ATTRIB | IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF | IN_DONT_FOLLOW)
+#define DIR_CHANGED  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+#define SELF_CHANGED (IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_IGNORED)
+
+#define WATCH_BUCKETS_INIT  1024
+#define VECTOR_INIT         64
+#define EVENT_BUFFER_SIZE   (64 * 1024)
+
+/* ======================== TYPES ======================== */
+
+typedef struct watch watch_t;
+typedef struct cache_entry cache_entry_t;
+
+/**
+ * @brief Một path đã hỏi và kết quả của nó
+ */
+struct cache_entry {
+    cache_entry_t *hash_next;
+    cache_entry_t *lru_prev;      /* Mới dùng hơn */
+    cache_entry_t *lru_next;      /* Cũ hơn */
+    cache_entry_t *dir_prev;      /* Danh sách entry của thư mục cha */
+    cache_entry_t *dir_next;
+    watch_t *dir;                 /* Watch của thư mục cha, NULL với "/" */
+    watch_t *self;                /* Watch trên inode của chính entry (NULL nếu lỗi) */
+    uint64_t hash;
+    meta_value_t value;
+    size_t path_len;
+    char path[];
+};
+
+/**
+ * @brief Một path đang được watch: thư mục, hoặc inode của một entry khác
+ *
+ * refs đếm các entry có dir hoặc self là watch này, các watch con và
+ * các lần ghim tạm khi xử lý sự kiện; watch được gỡ khi refs về 0.
+ * Chỉ watch thư mục được dùng làm thư mục cha.
+ */
+struct watch {
+    watch_t *hash_next;           /* Bảng theo path */
+    watch_t *wd_next;             /* Bảng theo wd */
+    watch_t *parent;              /* NULL với "/" */
+    watch_t *children;
+    watch_t *sibling_prev;
+    watch_t *sibling_next;
+    cache_entry_t *entries;       /* Entry có thư mục cha là watch này */
+    size_t refs;
+    int wd;                       /* -1 sau IN_IGNORED */
+    bool dir;                     /* WATCH_MASK, hoặc FILE_WATCH_MASK */
+    uint64_t hash;
+    size_t path_len;
+    char path[];                  /* Kết thúc bằng '\0' cho inotify_add_watch() */
+};
+
+/**
+ * @brief Mảng con trỏ tự lớn dần
+ */
+typedef struct {
+    void **items;
+    size_t len;
+    size_t cap;
+} vector_t;
+
+struct meta_cache {
+    int fd;                       /* inotify */
+    size_t capacity;
+    cache_entry_t **buckets;
+    size_t bucket_mask;
+    cache_entry_t *lru_head;
+    cache_entry_t *lru_tail;
+    size_t count;
+    watch_t **watch_paths;
+    watch_t **watch_wds;          /* Các watch cùng inode có cùng wd */
+    size_t watch_mask;
+    size_t watch_count;
+    vector_t victims;             /* Entry cần xóa của một lần invalidation */
+    vector_t stack;               /* Watch còn phải duyệt */
+    vector_t pinned;              /* Watch của sự kiện đang xử lý */
+    meta_cache_stats_t stats;
+    char path[PATH_MAX];                  /* Path đang hỏi, kết thúc bằng '\0' */
+    char event_path[PATH_MAX + NAME_MAX + 2];
+    uint64_t events[EVENT_BUFFER_SIZE / sizeof(uint64_t)];   /* Căn lề cho inotify_event */
+};
+
+/* ======================== HELPERS ======================== */
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Thêm một con trỏ vào vector
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int vector_push(vector_t *v, void *item)
+{
+    if (v->len == v->cap) {
+        size_t cap = v->cap ? v->cap * 2 : VECTOR_INIT;
+        void **items = realloc(v->items, cap * sizeof(*items));
+        if (items == NULL) {
+            return -1;
+        }
+        v->items = items;
+        v->cap = cap;
+    }
+    v->items[v->len++] = item;
+    return 0;
+}
+
+/**
+ * @brief Độ dài path của thư mục cha ("/a/b" -> 2, "/a" -> 1)
+ */
+static size_t parent_len(const char *path, size_t len)
+{
+    while (len > 1 && path[len - 1] != '/') {
+        len--;
+    }
+    return len > 1 ? len - 1 : 1;
+}
+
+/**
+ * @brief Path có được cache không: tuyệt đối, không có thành phần rỗng, "." hay ".."
+ */
+static bool cacheable(const char *path, size_t len)
+{
+    if (len == 0 || len >= PATH_MAX || path[0] != '/' || memchr(path, '\0', len) != NULL) {
+        return false;
+    }
+    if (len == 1) {
+        return true;
+    }
+    for (size_t i = 0; i < len; ) {
+        size_t start = ++i;       /* Sau '/' */
+        while (i < len && path[i] != '/') {
+            i++;
+        }
+        size_t n = i - start;
+        if (n == 0 || (n == 1 && path[start] == '.') ||
+            (n == 2 && path[start] == '.' && path[start + 1] == '.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief statx() path trong cache->path vào value
+ */
+static void fetch(meta_cache_t *cache, meta_value_t *value)
+{
+    struct statx stx;
+
+    memset(value, 0, sizeof(*value));
+    if (statx(AT_FDCWD, cache->path, AT_SYMLINK_NOFOLLOW,
+              fields_to_statx_mask(FIELDS_ALL), &stx) != 0) {
+        value->error = errno;
+        return;
+    }
+    bin_fill_record(&value->record, FIELDS_ALL, &stx);
+    value->attributes_mask = stx.stx_attributes_mask;
+}
+
+/* ======================== WATCHES ======================== */
+
+static watch_t *find_watch(const meta_cache_t *cache, const char *path, size_t len,
+                           uint64_t hash, bool dir)
+{
+    for (watch_t *w = cache->watch_paths[hash & cache->watch_mask]; w != NULL; w = w->hash_next) {
+        if (w->hash == hash && w->dir == dir && w->path_len == len &&
+            memcmp(w->path, path, len) == 0) {
+            return w;
+        }
+    }
+    return NULL;
+}
+
+static size_t wd_bucket(const meta_cache_t *cache, int wd)
+{
+    return (size_t)wd & cache->watch_mask;
+}
+
+/**
+ * @brief Gấp đôi hai bảng watch khi số watch vượt số bucket (bỏ qua nếu hết bộ nhớ)
+ */
+static void grow_watch_tables(meta_cache_t *cache)
+{
+    size_t buckets = (cache->watch_mask + 1) * 2;
+    watch_t **paths = calloc(buckets, sizeof(*paths));
+    watch_t **wds = calloc(buckets, sizeof(*wds));
+
+    if (paths == NULL || wds == NULL) {
+        free(paths);
+        free(wds);
+        return;
+    }
+    for (size_t i = 0; i <= cache->watch_mask; i++) {
+        watch_t *w = cache->watch_paths[i];
+        while (w != NULL) {
+            watch_t *next = w->hash_next;
+            w->hash_next = paths[w->hash & (buckets - 1)];
+            paths[w->hash & (buckets - 1)] = w;
+            w = next;
+        }
+        w = cache->watch_wds[i];
+        while (w != NULL) {
+            watch_t *next = w->wd_next;
+            w->wd_next = wds[(size_t)w->wd & (buckets - 1)];
+            wds[(size_t)w->wd & (buckets - 1)] = w;
+            w = next;
+        }
+    }
+    free(cache->watch_paths);
+    free(cache->watch_wds);
+    cache->watch_paths = paths;
+    cache->watch_wds = wds;
+    cache->watch_mask = buckets - 1;
+}
+
+/**
+ * @brief Bỏ watch khỏi bảng theo wd; gỡ watch trong kernel nếu không còn watch nào cùng wd
+ */
+static void forget_wd(meta_cache_t *cache, watch_t *w, bool remove)
+{
+    watch_t **link = &cache->watch_wds[wd_bucket(cache, w->wd)];
+    bool shared = false;
+
+    while (*link != NULL) {
+        if (*link == w) {
+            *link = w->wd_next;
+        } else {
+            shared |= (*link)->wd == w->wd;
+            link = &(*link)->wd_next;
+        }
+    }
+    if (remove && !shared) {
+        inotify_rm_watch(cache->fd, w->wd);
+    }
+    w->wd = -1;
+}
+
+/**
+ * @brief Trả một tham chiếu; watch không còn ai dùng được gỡ, rồi tới cha của nó
+ */
+static void release_watch(meta_cache_t *cache, watch_t *w)
+{
+    while (w != NULL && --w->refs == 0) {
+        watch_t *parent = w->parent;
+        watch_t **link = &cache->watch_paths[w->hash & cache->watch_mask];
+
+        while (*link != w) {
+            link = &(*link)->hash_next;
+        }
+        *link = w->hash_next;
+        if (w->wd >= 0) {
+            forget_wd(cache, w, true);
+        }
+        if (parent != NULL) {
+            if (w->sibling_prev != NULL) {
+                w->sibling_prev->sibling_next = w->sibling_next;
+            } else {
+                parent->children = w->sibling_next;
+            }
+            if (w->sibling_next != NULL) {
+                w->sibling_next->sibling_prev = w->sibling_prev;
+            }
+        }
+        free(w);
+        cache->watch_count--;
+        w = parent;
+    }
+}
+
+/**
+ * @brief Lấy watch của một path (thêm watch cho nó và mọi thư mục tổ tiên nếu chưa có)
+ * @param dir true: path phải là thư mục thật; false: watch inode của entry khác
+ * @return Watch đã tăng refs, hoặc NULL nếu không watch được (errno được set)
+ */
+static watch_t *acquire_watch(meta_cache_t *cache, const char *path, size_t len, bool dir)
+{
+    uint64_t hash = xxh3_64(path, len);
+    watch_t *w = find_watch(cache, path, len, hash, dir);
+    watch_t *parent = NULL;
+    size_t bucket;
+
+    if (w != NULL) {
+        w->refs++;
+        return w;
+    }
+    /* Tổ tiên trước: sự kiện đổi tên/xóa path này tới qua watch của cha */
+    if (len > 1 && (parent = acquire_watch(cache, path, parent_len(path, len), true)) == NULL) {
+        return NULL;
+    }
+    w = malloc(sizeof(*w) + len + 1);
+    if (w == NULL) {
+        release_watch(cache, parent);
+        errno = ENOMEM;
+        return NULL;
+    }
+    memcpy(w->path, path, len);
+    w->path[len] = '\0';
+    w->wd = inotify_add_watch(cache->fd, w->path, dir ? WATCH_MASK : FILE_WATCH_MASK);
+    if (w->wd < 0) {
+        int error = errno;
+        free(w);
+        release_watch(cache, parent);
+        errno = error;
+        return NULL;
+    }
+    w->path_len = len;
+    w->hash = hash;
+    w->dir = dir;
+    w->refs = 1;
+    w->parent = parent;
+    w->children = NULL;
+    w->entries = NULL;
+    w->sibling_prev = NULL;
+    w->sibling_next = NULL;
+    if (parent != NULL) {
+        w->sibling_next = parent->children;
+        if (parent->children != NULL) {
+            parent->children->sibling_prev = w;
+        }
+        parent->children = w;
+    }
+
+    if (cache->watch_count >= cache->watch_mask + 1) {
+        grow_watch_tables(cache);
+    }
+    bucket = hash & cache->watch_mask;
+    w->hash_next = cache->watch_paths[bucket];
+    cache->watch_paths[bucket] = w;
+    bucket = wd_bucket(cache, w->wd);
+    w->wd_next = cache->watch_wds[bucket];
+    cache->watch_wds[bucket] = w;
+    cache->watch_count++;
+    return w;
+}
+
+/* ======================== ENTRIES ======================== */
+
+static cache_entry_t *find_entry(const meta_cache_t *cache, const char *path, size_t len,
+                                 uint64_t hash)
+{
+    for (cache_entry_t *e = cache->buckets[hash & cache->bucket_mask]; e != NULL; e = e->hash_next) {
+        if (e->hash == hash && e->path_len == len && memcmp(e->path, path, len) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink(meta_cache_t *cache, cache_entry_t *e)
+{
+    if (e->lru_prev != NULL) {
+        e->lru_prev->lru_next = e->lru_next;
+    } else {
+        cache->lru_head = e->lru_next;
+    }
+    if (e->lru_next != NULL) {
+        e->lru_next->lru_prev = e->lru_prev;
+    } else {
+        cache->lru_tail = e->lru_prev;
+    }
+}
+
+static void lru_push_front(meta_cache_t *cache, cache_entry_t *e)
+{
+    e->lru_prev = NULL;
+    e->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL) {
+        cache->lru_head->lru_prev = e;
+    } else {
+        cache->lru_tail = e;
+    }
+    cache->lru_head = e;
+}
+
+/**
+ * @brief Xóa một entry khỏi mọi danh sách và trả các watch của nó
+ */
+static void remove_entry(meta_cache_t *cache, cache_entry_t *e)
+{
+    cache_entry_t **link = &cache->buckets[e->hash & cache->bucket_mask];
+
+    while (*link != e) {
+        link = &(*link)->hash_next;
+    }
+    *link = e->hash_next;
+    lru_unlink(cache, e);
+    if (e->dir != NULL) {
+        if (e->dir_prev != NULL) {
+            e->dir_prev->dir_next = e->dir_next;
+        } else {
+            e->dir->entries = e->dir_next;
+        }
+        if (e->dir_next != NULL) {
+            e->dir_next->dir_prev = e->dir_prev;
+        }
+    }
+    release_watch(cache, e->self);
+    release_watch(cache, e->dir);
+    free(e);
+    cache->count--;
+}
+
+/**
+ * @brief Xóa mọi entry (và do đó mọi watch)
+ */
+static void clear_entries(meta_cache_t *cache)
+{
+    while (cache->lru_tail != NULL) {
+        remove_entry(cache, cache->lru_tail);
+    }
+}
+
+/**
+ * @brief Đưa entry mới vào cache, đẩy entry cũ nhất ra nếu đầy
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int insert_entry(meta_cache_t *cache, const char *path, size_t len, uint64_t hash,
+                        watch_t *dir, watch_t *self, const meta_value_t *value)
+{
+    cache_entry_t *e;
+
+    /* dir và self đang được giữ nên không bị gỡ theo entry bị đẩy ra */
+    if (cache->count >= cache->capacity) {
+        remove_entry(cache, cache->lru_tail);
+        cache->stats.evictions++;
+    }
+    e = malloc(sizeof(*e) + len);
+    if (e == NULL) {
+        return -1;
+    }
+    memcpy(e->path, path, len);
+    e->path_len = len;
+    e->hash = hash;
+    e->value = *value;
+    e->dir = dir;
+    e->self = self;
+
+    e->hash_next = cache->buckets[hash & cache->bucket_mask];
+    cache->buckets[hash & cache->bucket_mask] = e;
+    lru_push_front(cache, e);
+    e->dir_prev = NULL;
+    e->dir_next = NULL;
+    if (dir != NULL) {
+        e->dir_next = dir->entries;
+        if (dir->entries != NULL) {
+            dir->entries->dir_prev = e;
+        }
+        dir->entries = e;
+    }
+    cache->count++;
+    return 0;
+}
+
+/* ======================== INVALIDATION ======================== */
+
+/**
+ * @brief Gom mọi entry nằm dưới một watch (kể cả các watch con)
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int collect_subtree(meta_cache_t *cache, watch_t *root)
+{
+    cache->stack.len = 0;
+    if (vector_push(&cache->stack, root) != 0) {
+        return -1;
+    }
+    while (cache->stack.len > 0) {
+        watch_t *w = cache->stack.items[--cache->stack.len];
+
+        for (cache_entry_t *e = w->entries; e != NULL; e = e->dir_next) {
+            if (vector_push(&cache->victims, e) != 0) {
+                return -1;
+            }
+        }
+        for (watch_t *child = w->children; child != NULL; child = child->sibling_next) {
+            if (vector_push(&cache->stack, child) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Xóa entry của path, và nếu subtree, mọi entry bên dưới path
+ */
+static void invalidate(meta_cache_t *cache, const char *path, size_t len, bool subtree)
+{
+    uint64_t hash = xxh3_64(path, len);
+    cache_entry_t *e = find_entry(cache, path, len, hash);
+    watch_t *w = subtree ? find_watch(cache, path, len, hash, true) : NULL;
+
+    /* Gom trước rồi mới xóa: xóa entry có thể gỡ các watch đang duyệt */
+    cache->victims.len = 0;
+    if ((e != NULL && vector_push(&cache->victims, e) != 0) ||
+        (w != NULL && collect_subtree(cache, w) != 0)) {
+        cache->stats.invalidations += cache->count;
+        clear_entries(cache);
+        return;
+    }
+    for (size_t i = 0; i < cache->victims.len; i++) {
+        remove_entry(cache, cache->victims.items[i]);
+    }
+    cache->stats.invalidations += cache->victims.len;
+}
+
+/**
+ * @brief Áp dụng một sự kiện lên một watch (đã được ghim)
+ */
+static void apply_event(meta_cache_t *cache, watch_t *w, const struct inotify_event *event)
+{
+    size_t name_len = event->len > 0 ? strlen(event->name) : 0;
+
+    if (name_len > 0) {
+        /* <dir>/<name> và mọi thứ bên dưới nó */
+        size_t len = w->path_len == 1 ? 0 : w->path_len;
+        memcpy(cache->event_path, w->path, len);
+        cache->event_path[len] = '/';
+        memcpy(cache->event_path + len + 1, event->name, name_len);
+        invalidate(cache, cache->event_path, len + 1 + name_len, true);
+        if (event->mask & DIR_CHANGED) {
+            /* mtime, nlink của chính thư mục */
+            invalidate(cache, w->path, w->path_len, false);
+        }
+        return;
+    }
+    if (event->mask & IN_IGNORED) {
+        /* Kernel đã gỡ watch (thư mục bị xóa, umount) */
+        forget_wd(cache, w, false);
+    }
+    if (event->mask & SELF_CHANGED) {
+        /* Quyền hoặc vị trí của thư mục đổi: mọi path bên dưới có thể đổi theo */
+        invalidate(cache, w->path, w->path_len, true);
+    } else {
+        invalidate(cache, w->path, w->path_len, false);
+    }
+}
+
+/**
+ * @brief Xử lý một sự kiện cho mọi watch có cùng wd
+ */
+static void handle_event(meta_cache_t *cache, const struct inotify_event *event)
+{
+    cache->stats.events++;
+    if (event->mask & IN_Q_OVERFLOW) {
+        /* Đã mất sự kiện: không còn biết entry nào đúng */
+        cache->stats.overflows++;
+        cache->stats.invalidations += cache->count;
+        clear_entries(cache);
+        return;
+    }
+
+    /* Ghim trước: xử lý watch này có thể gỡ watch kia */
+    cache->pinned.len = 0;
+    for (watch_t *w = cache->watch_wds[wd_bucket(cache, event->wd)]; w != NULL; w = w->wd_next) {
+        if (w->wd != event->wd) {
+            continue;
+        }
+        if (vector_push(&cache->pinned, w) != 0) {
+            for (size_t i = 0; i < cache->pinned.len; i++) {
+                release_watch(cache, cache->pinned.items[i]);
+            }
+            cache->stats.invalidations += cache->count;
+            clear_entries(cache);
+            return;
+        }
+        w->refs++;
+    }
+    for (size_t i = 0; i < cache->pinned.len; i++) {
+        apply_event(cache, cache->pinned.items[i], event);
+    }
+    for (size_t i = 0; i < cache->pinned.len; i++) {
+        release_watch(cache, cache->pinned.items[i]);
+    }
+}
+
+/* ======================== PUBLIC API ======================== */
+
+meta_cache_t *meta_cache_create(size_t capacity)
+{
+    meta_cache_t *cache = calloc(1, sizeof(*cache));
+    size_t buckets = 16;
+
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->fd = -1;
+    while (buckets < capacity) {
+        buckets *= 2;
+    }
+    cache->capacity = capacity > 0 ? capacity : 1;
+    cache->bucket_mask = buckets - 1;
+    cache->watch_mask = WATCH_BUCKETS_INIT - 1;
+    cache->buckets = calloc(buckets, sizeof(*cache->buckets));
+    cache->watch_paths = calloc(WATCH_BUCKETS_INIT, sizeof(*cache->watch_paths));
+    cache->watch_wds = calloc(WATCH_BUCKETS_INIT, sizeof(*cache->watch_wds));
+    if (cache->buckets == NULL || cache->watch_paths == NULL || cache->watch_wds == NULL) {
+        meta_cache_destroy(cache);
+        errno = ENOMEM;
+        return NULL;
+    }
+    cache->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (cache->fd < 0) {
+        int error = errno;
+        meta_cache_destroy(cache);
+        errno = error;
+        return NULL;
+    }
+    return cache;
+}
+
+void meta_cache_destroy(meta_cache_t *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->buckets != NULL && cache->watch_paths != NULL && cache->watch_wds != NULL) {
+        clear_entries(cache);
+    }
+    if (cache->fd >= 0) {
+        close(cache->fd);
+    }
+    free(cache->buckets);
+    free(cache->watch_paths);
+    free(cache->watch_wds);
+    free(cache->victims.items);
+    free(cache->stack.items);
+    free(cache->pinned.items);
+    free(cache);
+}
+
+int meta_cache_fd(const meta_cache_t *cache)
+{
+    return cache->fd;
+}
+
+int meta_cache_process_events(meta_cache_t *cache)
+{
+    for (;;) {
+        ssize_t n = read(cache->fd, cache->events, sizeof(cache->events));
+        const char *p = (const char *)cache->events;
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN ? 0 : -1;
+        }
+        while (p < (const char *)cache->events + n) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            handle_event(cache, event);
+            p += sizeof(*event) + event->len;
+        }
+    }
+}
+
+void meta_cache_lookup(meta_cache_t *cache, const char *path, size_t len, meta_value_t *value)
+{
+    uint64_t start = now_ns();
+    uint64_t hash;
+    cache_entry_t *e;
+    watch_t *dir = NULL;
+    watch_t *self = NULL;
+
+    if (!cacheable(path, len)) {
+        memset(value, 0, sizeof(*value));
+        if (len >= PATH_MAX) {
+            value->error = ENAMETOOLONG;
+        } else if (len == 0 || memchr(path, '\0', len) != NULL) {
+            value->error = ENOENT;
+        } else {
+            memcpy(cache->path, path, len);
+            cache->path[len] = '\0';
+            fetch(cache, value);
+        }
+        goto direct;
+    }
+
+    hash = xxh3_64(path, len);
+    e = find_entry(cache, path, len, hash);
+    if (e != NULL) {
+        if (e != cache->lru_head) {
+            lru_unlink(cache, e);
+            lru_push_front(cache, e);
+        }
+        *value = e->value;
+        value->flags = META_CACHED;
+        cache->stats.hits++;
+        cache->stats.hit_ns += now_ns() - start;
+        return;
+    }
+
+    /* Miss: watch thư mục cha trước, statx() sau, để không lỡ thay đổi nào */
+    memcpy(cache->path, path, len);
+    cache->path[len] = '\0';
+    if (len > 1 && (dir = acquire_watch(cache, path, parent_len(path, len), true)) == NULL) {
+        fetch(cache, value);
+        goto direct;
+    }
+    fetch(cache, value);
+    if (value->error == 0) {
+        /*
+         * Thư mục: tạo/xóa bên trong chỉ báo trên watch của chính nó.
+         * Entry khác: ghi hay link/unlink qua tên ở thư mục khác chỉ báo
+         * trên watch của inode. statx() lại sau khi watch đã có.
+         */
+        if ((self = acquire_watch(cache, path, len, S_ISDIR(value->record.mode))) == NULL) {
+            release_watch(cache, dir);
+            fetch(cache, value);
+            goto direct;
+        }
+        fetch(cache, value);
+    }
+    if (insert_entry(cache, path, len, hash, dir, self, value) != 0) {
+        release_watch(cache, self);
+        release_watch(cache, dir);
+        goto direct;
+    }
+    cache->stats.misses++;
+    cache->stats.miss_ns += now_ns() - start;
+    return;
+
+direct:
+    value->flags = META_DIRECT;
+    cache->stats.direct++;
+}
+
+void meta_cache_get_stats(const meta_cache_t *cache, meta_cache_stats_t *stats)
+{
+    *stats = cache->stats;
+    stats->entries = cache->count;
+    stats->watches = cache->watch_count;
+}
+
+void print_cache_stats(FILE *stream, const meta_cache_stats_t *stats)
+{
+    fprintf(stream, "========================================\n");
+    fprintf(stream, "             METADATA CACHE             \n");
+    fprintf(stream, "========================================\n");
+    fprintf(stream, "Entries:       %zu (%zu inotify watches)\n", stats->entries, stats->watches);
+    fprintf(stream, "Hits:          %llu (%.0f ns per lookup)\n", (unsigned long long)stats->hits,
+            stats->hits ? (double)stats->hit_ns / (double)stats->hits : 0.0);
+    fprintf(stream, "Misses:        %llu (%.0f ns per lookup, with statx)\n",
+            (unsigned long long)stats->misses,
+            stats->misses ? (double)stats->miss_ns / (double)stats->misses : 0.0);
+    fprintf(stream, "Uncached:      %llu\n", (unsigned long long)stats->direct);
+    fprintf(stream, "Evictions:     %llu\n", (unsigned long long)stats->evictions);
+    fprintf(stream, "Invalidated:   %llu (%llu events, %llu queue overflows)\n",
+            (unsigned long long)stats->invalidations, (unsigned long long)stats->events,
+            (unsigned long long)stats->overflows);
+    fprintf(stream, "========================================\n");
+}
@@ -0,0 +1,126 @@
+/**
+ * @file filestat_cache.h
+ * @brief Cache metadata trong bộ nhớ cho chế độ daemon (--serve)
+ *
+ * Mỗi path tuyệt đối đã hỏi được giữ cùng kết quả statx() (kể cả lỗi như
+ * ENOENT) trong bảng băm theo path, với danh sách LRU giới hạn số entry.
+ *
+ * Cache được giữ đúng bằng inotify: trước khi statx() một path, mọi thư
+ * mục tổ tiên của nó (từ "/") được watch, và path được hỏi cũng được
+ * watch chính nó (thư mục, hoặc inode của file/symlink: ghi và link/unlink
+ * qua một hard link ở thư mục khác chỉ báo trên inode). Một sự kiện trên
+ * thư mục D với tên N xóa entry D/N và mọi entry bên dưới D/N (đổi tên,
+ * xóa, chmod một thư mục tổ tiên đều làm path con đổi kết quả). Tạo, xóa,
+ * đổi tên trong D xóa cả entry D (mtime, nlink). Sự kiện trên inode của
+ * một entry xóa entry đó. Watch có bộ đếm tham chiếu và được gỡ khi entry
+ * cuối cùng dùng nó bị xóa, nên cache cần khoảng một watch mỗi entry.
+ *
+ * Được phục vụ trực tiếp bằng statx(), không qua cache:
+ *   - path không chuẩn: tương đối, có "//", "/./", "/../", "/" ở cuối
+ *   - path đi qua symlink tới thư mục (watch dùng IN_DONT_FOLLOW)
+ *   - path có thư mục cha không tồn tại hoặc không đọc được
+ *   - khi không thêm được watch (hết max_user_watches)
+ *
+ * Giới hạn: atime không được theo dõi (IN_ACCESS), mount/umount không
+ * sinh sự kiện inotify, và ghi qua mmap() không sinh IN_MODIFY nên size
+ * và mtime chỉ đúng lại sau một sự kiện khác trên file.
+ */
+
+#ifndef FILESTAT_CACHE_H
+#define FILESTAT_CACHE_H
+
+#include "filestat.h"
+#include "filestat_format.h"
+
+/* ======================== CONSTANTS ======================== */
+#define CACHE_SIZE_DEFAULT  65536     /* --cache-size mặc định */
+#define CACHE_SIZE_MAX      (1u << 26)
+
+/* meta_value_t.flags */
+#define META_CACHED  (1u << 0)   /* Trả lời từ cache */
+#define META_DIRECT  (1u << 1)   /* Path không được cache, statx() trực tiếp */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Kết quả cho một path (144 byte, cũng là bản tin trả lời của --serve)
+ *
+ * record chứa mọi trường (FIELDS_ALL) mà filesystem trả về; path_offset
+ * và path_len bằng 0.
+ */
+typedef struct {
+    int32_t error;           /* 0, hoặc errno của statx() */
+    uint32_t flags;          /* META_* */
+    uint64_t attributes_mask;/* stx_attributes_mask */
+    bin_record_t record;     /* Hợp lệ khi error == 0 */
+} meta_value_t;
+
+/**
+ * @brief Thống kê của cache
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;         /* statx() rồi đưa vào cache */
+    uint64_t direct;         /* statx() không qua cache */
+    uint64_t evictions;      /* Bị đẩy ra theo LRU */
+    uint64_t invalidations;  /* Bị xóa do sự kiện inotify */
+    uint64_t events;         /* Sự kiện inotify đã đọc */
+    uint64_t overflows;      /* IN_Q_OVERFLOW: cả cache bị xóa */
+    uint64_t hit_ns;         /* Tổng thời gian tra cứu của các lần hit */
+    uint64_t miss_ns;        /* Tổng thời gian của các lần miss (gồm statx, watch) */
+    size_t entries;          /* Entry đang giữ */
+    size_t watches;          /* Watch inotify đang giữ */
+} meta_cache_stats_t;
+
+/* Cache (opaque), chỉ dùng từ một luồng */
+typedef struct meta_cache meta_cache_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo cache và instance inotify của nó
+ * @param capacity Số entry tối đa
+ * @return Cache mới, hoặc NULL nếu lỗi (errno được set)
+ */
+meta_cache_t *meta_cache_create(size_t capacity);
+
+/**
+ * @brief Gỡ mọi watch và giải phóng cache (NULL được chấp nhận)
+ */
+void meta_cache_destroy(meta_cache_t *cache);
+
+/**
+ * @brief File descriptor inotify (non-blocking) để chờ bằng poll/epoll
+ */
+int meta_cache_fd(const meta_cache_t *cache);
+
+/**
+ * @brief Đọc và áp dụng mọi sự kiện inotify đang chờ (không chặn)
+ *
+ * Phải gọi trước khi trả lời một lô câu hỏi: sự kiện được kernel xếp
+ * hàng ngay lúc thay đổi, nên câu trả lời sau đó thấy mọi thay đổi đã
+ * hoàn tất trước khi câu hỏi được gửi.
+ *
+ * @return 0 nếu thành công, -1 nếu đọc lỗi
+ */
+int meta_cache_process_events(meta_cache_t *cache);
+
+/**
+ * @brief Metadata của một path (giống statx() với AT_SYMLINK_NOFOLLOW)
+ * @param path Path, không cần kết thúc bằng '\0'
+ * @param len Độ dài path
+ * @param value Nhận kết quả
+ */
+void meta_cache_lookup(meta_cache_t *cache, const char *path, size_t len, meta_value_t *value);
+
+/**
+ * @brief Lấy thống kê hiện tại
+ */
+void meta_cache_get_stats(const meta_cache_t *cache, meta_cache_stats_t *stats);
+
+/**
+ * @brief In thống kê (khung "METADATA CACHE") lên stream
+ */
+void print_cache_stats(FILE *stream, const meta_cache_stats_t *stats);
+
+#endif /* FILESTAT_CACHE_H */
@@ -0,0 +1,324 @@
+/**
+ * @file filestat_du.c
+ * @brief Min-heap top-N, tập inode cho hard link và in báo cáo --du
+ */
+
+#include "filestat_du.h"
+
+/* ======================== CONSTANTS ======================== */
+#define INODE_SHARDS      64     /* Số phần của tập inode, mỗi phần một khóa */
+#define INODE_SHARD_INIT  64     /* Slot ban đầu mỗi phần (lũy thừa 2) */
+
+/* ======================== TOP-N HEAP ======================== */
+
+int topn_init(topn_t *heap, size_t n)
+{
+    heap->count = 0;
+    heap->cap = n;
+    heap->items = n > 0 ? malloc(n * sizeof(*heap->items)) : NULL;
+    return (n == 0 || heap->items != NULL) ? 0 : -1;
+}
+
+void topn_free(topn_t *heap)
+{
+    for (size_t i = 0; i < heap->count; i++) {
+        free(heap->items[i].path);
+    }
+    free(heap->items);
+    heap->items = NULL;
+    heap->count = 0;
+    heap->cap = 0;
+}
+
+/**
+ * @brief a nhỏ hơn b: disk_bytes, rồi bytes
+ */
+static bool entry_less(const du_entry_t *a, const du_entry_t *b)
+{
+    if (a->disk_bytes != b->disk_bytes) {
+        return a->disk_bytes < b->disk_bytes;
+    }
+    return a->bytes < b->bytes;
+}
+
+static void swap_entries(du_entry_t *a, du_entry_t *b)
+{
+    du_entry_t tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * @brief Đẩy phần tử i xuống cho tới khi nhỏ hơn các con (trong count phần tử đầu)
+ */
+static void sift_down(du_entry_t *items, size_t count, size_t i)
+{
+    for (;;) {
+        size_t left = 2 * i + 1;
+        size_t smallest = i;
+
+        if (left < count && entry_less(&items[left], &items[smallest])) {
+            smallest = left;
+        }
+        if (left + 1 < count && entry_less(&items[left + 1], &items[smallest])) {
+            smallest = left + 1;
+        }
+        if (smallest == i) {
+            return;
+        }
+        swap_entries(&items[i], &items[smallest]);
+        i = smallest;
+    }
+}
+
+static void sift_up(du_entry_t *items, size_t i)
+{
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!entry_less(&items[i], &items[parent])) {
+            return;
+        }
+        swap_entries(&items[i], &items[parent]);
+        i = parent;
+    }
+}
+
+/**
+ * @brief Nhận một entry đã có path riêng (heap sở hữu path từ đây)
+ */
+static void topn_take(topn_t *heap, du_entry_t *entry)
+{
+    if (heap->count < heap->cap) {
+        heap->items[heap->count] = *entry;
+        sift_up(heap->items, heap->count++);
+    } else if (heap->cap > 0 && entry_less(&heap->items[0], entry)) {
+        /* Thay entry nhỏ nhất */
+        free(heap->items[0].path);
+        heap->items[0] = *entry;
+        sift_down(heap->items, heap->count, 0);
+    } else {
+        free(entry->path);
+    }
+}
+
+int topn_offer(topn_t *heap, const du_entry_t *entry, const record_path_t *path)
+{
+    du_entry_t copy = *entry;
+    size_t sep = 0;
+    size_t len;
+
+    if (!topn_wants(heap, entry->disk_bytes)) {
+        return 0;
+    }
+    if (path->dir != NULL && (path->dir_len == 0 || path->dir[path->dir_len - 1] != '/')) {
+        sep = 1;
+    }
+    len = path->dir_len + sep + path->name_len;
+    copy.path = malloc(len + 1);
+    if (copy.path == NULL) {
+        return -1;
+    }
+    if (path->dir != NULL) {
+        memcpy(copy.path, path->dir, path->dir_len);
+        if (sep) {
+            copy.path[path->dir_len] = '/';
+        }
+    }
+    memcpy(copy.path + path->dir_len + sep, path->name, path->name_len);
+    copy.path[len] = '\0';
+
+    topn_take(heap, &copy);
+    return 0;
+}
+
+void topn_merge(topn_t *into, topn_t *from)
+{
+    for (size_t i = 0; i < from->count; i++) {
+        topn_take(into, &from->items[i]);
+    }
+    from->count = 0;
+}
+
+void topn_sort(topn_t *heap)
+{
+    /* Heap sort với min-heap: lấy dần phần tử nhỏ nhất ra cuối mảng */
+    for (size_t n = heap->count; n > 1; n--) {
+        swap_entries(&heap->items[0], &heap->items[n - 1]);
+        sift_down(heap->items, n - 1, 0);
+    }
+}
+
+/* ======================== INODE SET ======================== */
+
+/**
+ * @brief Một phần của tập: bảng băm địa chỉ mở, key == 0 là slot trống
+ */
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;
+    uint64_t *keys;          /* keys[2*i] = dev + 1, keys[2*i+1] = ino */
+    size_t cap;              /* Số slot (lũy thừa 2) */
+    size_t count;
+} inode_shard_t;
+
+struct inode_set {
+    inode_shard_t shards[INODE_SHARDS];
+};
+
+/**
+ * @brief Trộn bit của (dev, ino) (bước cuối của splitmix64)
+ */
+static uint64_t inode_hash(uint64_t dev, uint64_t ino)
+{
+    uint64_t h = ino ^ (dev * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+inode_set_t *inode_set_create(void)
+{
+    inode_set_t *set = aligned_alloc(64, sizeof(*set));
+
+    if (set == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < INODE_SHARDS; i++) {
+        pthread_mutex_init(&set->shards[i].lock, NULL);
+        set->shards[i].keys = NULL;
+        set->shards[i].cap = 0;
+        set->shards[i].count = 0;
+    }
+    return set;
+}
+
+/**
+ * @brief Đặt key vào bảng (đã chắc chắn còn chỗ)
+ * @return true nếu key chưa có
+ */
+static bool shard_put(uint64_t *keys, size_t cap, uint64_t hash, uint64_t dev1, uint64_t ino)
+{
+    for (size_t i = (size_t)hash & (cap - 1); ; i = (i + 1) & (cap - 1)) {
+        if (keys[2 * i] == 0) {
+            keys[2 * i] = dev1;
+            keys[2 * i + 1] = ino;
+            return true;
+        }
+        if (keys[2 * i] == dev1 && keys[2 * i + 1] == ino) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Gấp đôi bảng khi đầy quá 1/2
+ * @return false nếu hết bộ nhớ
+ */
+static bool shard_grow(inode_shard_t *shard)
+{
+    size_t cap = shard->cap ? shard->cap * 2 : INODE_SHARD_INIT;
+    uint64_t *keys = calloc(cap * 2, sizeof(*keys));
+
+    if (keys == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < shard->cap; i++) {
+        uint64_t dev1 = shard->keys[2 * i];
+        uint64_t ino = shard->keys[2 * i + 1];
+        if (dev1 != 0) {
+            shard_put(keys, cap, inode_hash(dev1 - 1, ino) / INODE_SHARDS, dev1, ino);
+        }
+    }
+    free(shard->keys);
+    shard->keys = keys;
+    shard->cap = cap;
+    return true;
+}
+
+bool inode_set_insert(inode_set_t *set, uint64_t dev, uint64_t ino)
+{
+    uint64_t hash = inode_hash(dev, ino);
+    inode_shard_t *shard = &set->shards[hash % INODE_SHARDS];
+    bool inserted = true;
+
+    pthread_mutex_lock(&shard->lock);
+    if ((shard->count + 1) * 2 > shard->cap && !shard_grow(shard)) {
+        /* Hết bộ nhớ: tính như inode mới (có thể đếm trùng, không sai lệch âm) */
+        pthread_mutex_unlock(&shard->lock);
+        return true;
+    }
+    inserted = shard_put(shard->keys, shard->cap, hash / INODE_SHARDS, dev + 1, ino);
+    if (inserted) {
+        shard->count++;
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return inserted;
+}
+
+void inode_set_destroy(inode_set_t *set)
+{
+    if (set == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < INODE_SHARDS; i++) {
+        free(set->shards[i].keys);
+        pthread_mutex_destroy(&set->shards[i].lock);
+    }
+    free(set);
+}
+
+/* ======================== REPORT ======================== */
+
+int du_report_init(du_report_t *report, size_t top)
+{
+    memset(report, 0, sizeof(*report));
+    if (topn_init(&report->dirs, top) != 0 || topn_init(&report->files, top) != 0) {
+        topn_free(&report->dirs);
+        return -1;
+    }
+    return 0;
+}
+
+void du_report_free(du_report_t *report)
+{
+    topn_free(&report->dirs);
+    topn_free(&report->files);
+}
+
+void print_du_report(const du_report_t *report)
+{
+    char human[16];
+
+    printf("========================================\n");
+    printf("         DIRECTORY SIZE SUMMARY         \n");
+    printf("========================================\n");
+    printf("Root:          %s\n", report->total.path);
+    format_human(report->total.disk_bytes, human, sizeof(human));
+    printf("Disk Usage:    %llu bytes (%s)\n",
+           (unsigned long long)report->total.disk_bytes, human);
+    printf("Total Size:    %llu bytes\n", (unsigned long long)report->total.bytes);
+    printf("Files:         %llu\n", (unsigned long long)report->total.files);
+    printf("Hard Links:    %llu (counted once)\n", (unsigned long long)report->hardlinks);
+
+    if (report->dirs.count > 0) {
+        printf("----------------------------------------\n");
+        printf("Largest directories (with subdirectories):\n");
+        for (size_t i = 0; i < report->dirs.count; i++) {
+            const du_entry_t *e = &report->dirs.items[i];
+            format_human(e->disk_bytes, human, sizeof(human));
+            printf("%7s %10llu files  %s\n", human, (unsigned long long)e->files, e->path);
+        }
+    }
+    if (report->files.count > 0) {
+        printf("----------------------------------------\n");
+        printf("Largest files:\n");
+        for (size_t i = 0; i < report->files.count; i++) {
+            const du_entry_t *e = &report->files.items[i];
+            format_human(e->disk_bytes, human, sizeof(human));
+            printf("%7s  %s\n", human, e->path);
+        }
+    }
+    printf("========================================\n");
+}
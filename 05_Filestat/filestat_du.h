@@ -0,0 +1,128 @@
+/**
+ * @file filestat_du.h
+ * @brief Tổng dung lượng theo thư mục và báo cáo top-N (chế độ --du)
+ *
+ * Trong lúc duyệt song song, mỗi thư mục cộng dung lượng các file của nó
+ * rồi, khi cả cây con đã xong, cộng tổng của mình vào thư mục cha bằng
+ * phép cộng atomic (xem filestat_walk.c). File có nhiều hard link chỉ
+ * được tính một lần nhờ tập (thiết bị, inode) dùng chung giữa các luồng.
+ *
+ * Các file và thư mục lớn nhất được giữ trong min-heap giới hạn N phần
+ * tử (một heap mỗi luồng, gộp lại ở cuối), nên bộ nhớ là O(N) bất kể
+ * kích thước cây, thay vì giữ mọi dòng như `du | sort | head`.
+ */
+
+#ifndef FILESTAT_DU_H
+#define FILESTAT_DU_H
+
+#include "filestat.h"
+#include "filestat_format.h"
+
+/* ======================== CONSTANTS ======================== */
+#define DU_TOP_DEFAULT  10     /* --top mặc định */
+#define DU_TOP_MAX      10000  /* --top tối đa */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Một file hoặc thư mục trong báo cáo
+ */
+typedef struct {
+    uint64_t disk_bytes;     /* st_blocks * 512 (thư mục: cả cây con) */
+    uint64_t bytes;          /* st_size (thư mục: cả cây con) */
+    uint64_t files;          /* Số entry không phải thư mục (thư mục: cả cây con) */
+    char *path;              /* Thuộc về heap / báo cáo */
+} du_entry_t;
+
+/**
+ * @brief Min-heap giữ N entry có disk_bytes lớn nhất
+ *
+ * Gốc heap là entry nhỏ nhất đang giữ: entry mới chỉ được nhận (và path
+ * chỉ được copy) khi lớn hơn gốc.
+ */
+typedef struct {
+    du_entry_t *items;
+    size_t count;
+    size_t cap;              /* N */
+} topn_t;
+
+/* Tập (thiết bị, inode) của các file có nhiều hard link (opaque, an toàn đa luồng) */
+typedef struct inode_set inode_set_t;
+
+/**
+ * @brief Kết quả --du của một cây
+ */
+typedef struct {
+    du_entry_t total;        /* Thư mục gốc (path trỏ tới tham số root) */
+    topn_t dirs;             /* Thư mục con lớn nhất, lớn nhất trước */
+    topn_t files;            /* File lớn nhất, lớn nhất trước */
+    uint64_t hardlinks;      /* Số link trùng đã bỏ qua */
+} du_report_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo heap rỗng giữ tối đa n entry
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+int topn_init(topn_t *heap, size_t n);
+
+/**
+ * @brief Giải phóng heap và các path của nó
+ */
+void topn_free(topn_t *heap);
+
+/**
+ * @brief Entry có kích thước disk_bytes có được nhận vào heap không
+ *
+ * Cho phép bỏ qua việc ghép path của hầu hết entry.
+ */
+static inline bool topn_wants(const topn_t *heap, uint64_t disk_bytes)
+{
+    return heap->count < heap->cap || disk_bytes > heap->items[0].disk_bytes;
+}
+
+/**
+ * @brief Thêm một entry (copy path) nếu nó thuộc N entry lớn nhất
+ * @return 0 nếu thành công hoặc bị bỏ qua, -1 nếu hết bộ nhớ
+ */
+int topn_offer(topn_t *heap, const du_entry_t *entry, const record_path_t *path);
+
+/**
+ * @brief Chuyển mọi entry của from vào into (from trở thành rỗng)
+ */
+void topn_merge(topn_t *into, topn_t *from);
+
+/**
+ * @brief Sắp xếp lớn nhất trước (heap không còn dùng được để thêm)
+ */
+void topn_sort(topn_t *heap);
+
+/**
+ * @brief Tạo tập inode rỗng
+ * @return Tập mới, hoặc NULL nếu hết bộ nhớ
+ */
+inode_set_t *inode_set_create(void);
+
+/**
+ * @brief Thêm (dev, ino) vào tập
+ * @return true nếu chưa có (lần đầu gặp inode này), false nếu đã có
+ */
+bool inode_set_insert(inode_set_t *set, uint64_t dev, uint64_t ino);
+
+void inode_set_destroy(inode_set_t *set);
+
+/**
+ * @brief Khởi tạo báo cáo rỗng với top-N
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+int du_report_init(du_report_t *report, size_t top);
+
+void du_report_free(du_report_t *report);
+
+/**
+ * @brief In báo cáo theo khung giống print_walk_stats()
+ */
+void print_du_report(const du_report_t *report);
+
+#endif /* FILESTAT_DU_H */
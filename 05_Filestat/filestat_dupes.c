@@ -0,0 +1,634 @@
+/**
+ * @file filestat_dupes.c
+ * @brief Thu thập file khi duyệt, lọc theo kích thước, đầu/cuối và toàn bộ nội dung
+ *
+ * Path của các file được ghép vào arena theo khối 1 MB của từng luồng
+ * (không realloc, nên con trỏ path không đổi). Mỗi giai đoạn là một lần
+ * sắp xếp mảng ứng viên rồi giữ lại các đoạn liên tiếp có cùng khóa và
+ * ít nhất hai phần tử.
+ */
+
+#include "filestat_dupes.h"
+#include "filestat_hash.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+
+/* ======================== CONSTANTS ======================== */
+#define DUPES_PART_INIT   1024         /* Số file ban đầu mỗi phần */
+#define DUPES_ARENA_CHUNK (1 << 20)    /* Khối arena chứa path */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Một file ứng viên
+ */
+typedef struct {
+    uint64_t size;
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t hash;           /* Giai đoạn 2: đầu và cuối; giai đoạn 3: toàn bộ */
+    const char *path;        /* Trong arena */
+    bool failed;             /* Không đọc được: bị loại */
+} dupe_file_t;
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t used;
+    size_t cap;
+    char data[];
+} arena_chunk_t;
+
+/**
+ * @brief Phần của một luồng duyệt (căn theo cache line, chỉ luồng đó ghi)
+ */
+typedef struct {
+    _Alignas(64) dupe_file_t *files;
+    size_t count;
+    size_t cap;
+    arena_chunk_t *arena;    /* Khối đang dùng đứng đầu danh sách */
+} dupe_part_t;
+
+struct dupe_set {
+    dupe_part_t *parts;
+    unsigned num_parts;
+    uint64_t min_size;
+};
+
+/**
+ * @brief Một lần băm song song (giai đoạn 2 hoặc 3)
+ */
+typedef struct {
+    dupe_file_t *files;
+    size_t count;
+    bool full;               /* Giai đoạn 3: cả file */
+    atomic_size_t next;      /* File tiếp theo chưa có luồng nhận */
+    atomic_uint_least64_t bytes;
+    atomic_uint_least64_t errors;
+} hash_job_t;
+
+typedef struct {
+    hash_job_t *job;
+    char *buffer;            /* DUPES_READ_SIZE byte, căn theo trang */
+    pthread_t thread;
+} hash_worker_t;
+
+/**
+ * @brief Một nhóm file trùng: files[start .. start + count)
+ */
+typedef struct {
+    size_t start;
+    size_t count;
+    uint64_t wasted;
+} dupe_group_t;
+
+/* ======================== COLLECTING ======================== */
+
+dupe_set_t *dupe_set_create(unsigned parts, uint64_t min_size)
+{
+    dupe_set_t *set = malloc(sizeof(*set));
+
+    if (set == NULL) {
+        return NULL;
+    }
+    set->parts = aligned_alloc(64, parts * sizeof(*set->parts));
+    if (set->parts == NULL) {
+        free(set);
+        return NULL;
+    }
+    memset(set->parts, 0, parts * sizeof(*set->parts));
+    set->num_parts = parts;
+    set->min_size = min_size > 0 ? min_size : 1;
+    return set;
+}
+
+void dupe_set_destroy(dupe_set_t *set)
+{
+    if (set == NULL) {
+        return;
+    }
+    for (unsigned i = 0; i < set->num_parts; i++) {
+        arena_chunk_t *chunk = set->parts[i].arena;
+        while (chunk != NULL) {
+            arena_chunk_t *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        free(set->parts[i].files);
+    }
+    free(set->parts);
+    free(set);
+}
+
+/**
+ * @brief Cấp len byte trong arena của phần p
+ */
+static char *arena_alloc(dupe_part_t *p, size_t len)
+{
+    arena_chunk_t *chunk = p->arena;
+
+    if (chunk == NULL || chunk->used + len > chunk->cap) {
+        size_t cap = len > DUPES_ARENA_CHUNK ? len : DUPES_ARENA_CHUNK;
+        chunk = malloc(sizeof(*chunk) + cap);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = p->arena;
+        chunk->used = 0;
+        chunk->cap = cap;
+        p->arena = chunk;
+    }
+    chunk->used += len;
+    return chunk->data + chunk->used - len;
+}
+
+int dupe_set_add(dupe_set_t *set, unsigned part, const char *dir, size_t dir_len,
+                 const char *name, size_t name_len, const struct statx *stx)
+{
+    dupe_part_t *p = &set->parts[part];
+    size_t sep = (dir != NULL && dir_len > 0 && dir[dir_len - 1] != '/') ? 1 : 0;
+    dupe_file_t *f;
+    char *path;
+
+    if (stx->stx_size < set->min_size) {
+        return 0;
+    }
+    if (dir == NULL) {
+        dir_len = 0;
+    }
+    if (p->count == p->cap) {
+        size_t cap = p->cap ? p->cap * 2 : DUPES_PART_INIT;
+        dupe_file_t *files = realloc(p->files, cap * sizeof(*files));
+        if (files == NULL) {
+            return -1;
+        }
+        p->files = files;
+        p->cap = cap;
+    }
+    path = arena_alloc(p, dir_len + sep + name_len + 1);
+    if (path == NULL) {
+        return -1;
+    }
+    if (dir_len > 0) {
+        memcpy(path, dir, dir_len);
+    }
+    if (sep) {
+        path[dir_len] = '/';
+    }
+    memcpy(path + dir_len + sep, name, name_len);
+    path[dir_len + sep + name_len] = '\0';
+
+    f = &p->files[p->count++];
+    f->size = stx->stx_size;
+    f->dev = ((uint64_t)stx->stx_dev_major << 32) | stx->stx_dev_minor;
+    f->ino = stx->stx_ino;
+    f->hash = 0;
+    f->path = path;
+    f->failed = false;
+    return 0;
+}
+
+/* ======================== SORTING ======================== */
+
+/**
+ * @brief Lớn nhất trước (băm file lớn trước giúp chia việc đều), rồi theo
+ *        inode; các link của một inode theo path, link đầu tiên được giữ
+ */
+static int compare_inode(const void *a, const void *b)
+{
+    const dupe_file_t *x = a;
+    const dupe_file_t *y = b;
+
+    if (x->size != y->size) {
+        return x->size > y->size ? -1 : 1;
+    }
+    if (x->dev != y->dev) {
+        return x->dev < y->dev ? -1 : 1;
+    }
+    if (x->ino != y->ino) {
+        return x->ino < y->ino ? -1 : 1;
+    }
+    return strcmp(x->path, y->path);
+}
+
+/**
+ * @brief Lớn nhất trước, rồi theo hash; path làm thứ tự trong một nhóm
+ */
+static int compare_hash(const void *a, const void *b)
+{
+    const dupe_file_t *x = a;
+    const dupe_file_t *y = b;
+
+    if (x->size != y->size) {
+        return x->size > y->size ? -1 : 1;
+    }
+    if (x->hash != y->hash) {
+        return x->hash < y->hash ? -1 : 1;
+    }
+    return strcmp(x->path, y->path);
+}
+
+static int compare_group(const void *a, const void *b)
+{
+    const dupe_group_t *x = a;
+    const dupe_group_t *y = b;
+
+    if (x->wasted != y->wasted) {
+        return x->wasted > y->wasted ? -1 : 1;
+    }
+    return x->start < y->start ? -1 : (x->start > y->start);
+}
+
+/**
+ * @brief Giữ các đoạn (cùng kích thước và hash, không lỗi) có ít nhất hai file
+ * @return Số file còn lại, dồn về đầu mảng
+ */
+static size_t keep_matches(dupe_file_t *files, size_t count)
+{
+    size_t kept = 0;
+
+    for (size_t i = 0; i < count; ) {
+        size_t j = i + 1;
+
+        while (j < count && files[j].size == files[i].size && files[j].hash == files[i].hash) {
+            j++;
+        }
+        /* Các file lỗi bị bỏ, phần còn lại của đoạn vẫn có thể trùng nhau */
+        size_t ok = 0;
+        for (size_t k = i; k < j; k++) {
+            ok += !files[k].failed;
+        }
+        if (ok >= 2) {
+            for (size_t k = i; k < j; k++) {
+                if (!files[k].failed) {
+                    files[kept++] = files[k];
+                }
+            }
+        }
+        i = j;
+    }
+    return kept;
+}
+
+/* ======================== HASHING ======================== */
+
+/**
+ * @brief Đọc đúng len byte tại offset (xử lý đọc thiếu và EINTR)
+ * @return 0 nếu đủ, -1 nếu lỗi (errno) hoặc file ngắn đi (errno = 0)
+ */
+static int read_at(int fd, char *buffer, size_t len, uint64_t offset)
+{
+    while (len > 0) {
+        ssize_t n = pread(fd, buffer, len, (off_t)offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            errno = 0;
+            return -1;
+        }
+        buffer += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Băm 4 KB đầu và 4 KB cuối (cả file nếu không quá 8 KB)
+ */
+static int hash_edges(int fd, dupe_file_t *f, char *buffer, uint64_t *bytes)
+{
+    if (f->size <= 2 * DUPES_EDGE_SIZE) {
+        if (read_at(fd, buffer, f->size, 0) != 0) {
+            return -1;
+        }
+        f->hash = xxh3_64(buffer, f->size);
+        *bytes = f->size;
+        return 0;
+    }
+    if (read_at(fd, buffer, DUPES_EDGE_SIZE, 0) != 0 ||
+        read_at(fd, buffer + DUPES_EDGE_SIZE, DUPES_EDGE_SIZE, f->size - DUPES_EDGE_SIZE) != 0) {
+        return -1;
+    }
+    f->hash = xxh3_64(buffer, 2 * DUPES_EDGE_SIZE);
+    *bytes = 2 * DUPES_EDGE_SIZE;
+    return 0;
+}
+
+/**
+ * @brief Băm cả file theo từng đoạn DUPES_READ_SIZE byte
+ *
+ * Độ dài đã biết từ statx(), nên thân file đi qua xxh3_stream_blocks()
+ * ngay khi đọc, chỉ phần cuối được đọc riêng cho xxh3_stream_final().
+ */
+static int hash_full(int fd, dupe_file_t *f, char *buffer, uint64_t *bytes)
+{
+    xxh3_stream_t stream;
+    uint64_t body;
+    uint64_t tail;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    *bytes = f->size;
+    if (f->size <= DUPES_READ_SIZE) {
+        if (read_at(fd, buffer, f->size, 0) != 0) {
+            return -1;
+        }
+        f->hash = xxh3_64(buffer, f->size);
+        return 0;
+    }
+
+    body = xxh3_stream_body(f->size);
+    tail = xxh3_stream_tail(f->size);
+    xxh3_stream_init(&stream, f->size);
+    for (uint64_t offset = 0; offset < body; ) {
+        size_t n = body - offset < DUPES_READ_SIZE ? (size_t)(body - offset) : DUPES_READ_SIZE;
+        if (read_at(fd, buffer, n, offset) != 0) {
+            return -1;
+        }
+        xxh3_stream_blocks(&stream, buffer, n);
+        offset += n;
+    }
+    if (read_at(fd, buffer, tail, f->size - tail) != 0) {
+        return -1;
+    }
+    f->hash = xxh3_stream_final(&stream, buffer, tail);
+    return 0;
+}
+
+static void *hash_worker_main(void *arg)
+{
+    hash_worker_t *worker = arg;
+    hash_job_t *job = worker->job;
+
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        dupe_file_t *f;
+        uint64_t bytes = 0;
+        int fd;
+        int result;
+
+        if (i >= job->count) {
+            break;
+        }
+        f = &job->files[i];
+        if (job->full && f->size <= 2 * DUPES_EDGE_SIZE) {
+            continue;   /* Đã băm trọn ở giai đoạn 2 */
+        }
+
+        /* O_NOFOLLOW: file bị thay bằng symlink sau khi duyệt thì không đi theo */
+        fd = open(f->path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            result = -1;
+        } else {
+            result = job->full ? hash_full(fd, f, worker->buffer, &bytes)
+                               : hash_edges(fd, f, worker->buffer, &bytes);
+        }
+        if (result != 0) {
+            fprintf(stderr, "Error: Cannot read %s: %s\n", f->path,
+                    errno != 0 ? strerror(errno) : "File changed while reading");
+            f->failed = true;
+            atomic_fetch_add_explicit(&job->errors, 1, memory_order_relaxed);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        atomic_fetch_add_explicit(&job->bytes, bytes, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Băm files[0 .. count) trên jobs luồng (luồng gọi cũng tham gia)
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int hash_files(dupe_file_t *files, size_t count, bool full, unsigned jobs,
+                      dupes_stats_t *stats)
+{
+    hash_job_t job;
+    hash_worker_t *workers;
+    unsigned started = 1;
+
+    if (count == 0) {
+        return 0;
+    }
+    if (jobs > count) {
+        jobs = (unsigned)count;
+    }
+    workers = calloc(jobs, sizeof(*workers));
+    if (workers == NULL) {
+        return -1;
+    }
+    for (unsigned i = 0; i < jobs; i++) {
+        workers[i].job = &job;
+        workers[i].buffer = aligned_alloc(4096, DUPES_READ_SIZE);
+        if (workers[i].buffer == NULL) {
+            for (unsigned j = 0; j < i; j++) {
+                free(workers[j].buffer);
+            }
+            free(workers);
+            return -1;
+        }
+    }
+
+    job.files = files;
+    job.count = count;
+    job.full = full;
+    atomic_init(&job.next, 0);
+    atomic_init(&job.bytes, 0);
+    atomic_init(&job.errors, 0);
+    for (; started < jobs; started++) {
+        if (pthread_create(&workers[started].thread, NULL, hash_worker_main, &workers[started]) != 0) {
+            break;
+        }
+    }
+    hash_worker_main(&workers[0]);
+    for (unsigned i = 1; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    stats->bytes_hashed += atomic_load(&job.bytes);
+    stats->errors += atomic_load(&job.errors);
+    for (unsigned i = 0; i < jobs; i++) {
+        free(workers[i].buffer);
+    }
+    free(workers);
+    return 0;
+}
+
+/* ======================== STAGES ======================== */
+
+/**
+ * @brief Gộp các phần thành một mảng, bỏ hard link trùng và file không
+ *        cùng kích thước với file nào khác (giai đoạn 1)
+ * @return Mảng ứng viên (NULL nếu hết bộ nhớ hoặc không có ứng viên), *count nhận số phần tử
+ */
+static dupe_file_t *same_size_candidates(dupe_set_t *set, size_t *count, dupes_stats_t *stats)
+{
+    size_t n = 0;
+    size_t kept = 0;
+    dupe_file_t *files;
+
+    for (unsigned i = 0; i < set->num_parts; i++) {
+        n += set->parts[i].count;
+    }
+    stats->files = n;
+    *count = 0;
+    if (n == 0) {
+        return NULL;
+    }
+    files = malloc(n * sizeof(*files));
+    if (files == NULL) {
+        return NULL;
+    }
+    n = 0;
+    for (unsigned i = 0; i < set->num_parts; i++) {
+        if (set->parts[i].count > 0) {
+            memcpy(files + n, set->parts[i].files, set->parts[i].count * sizeof(*files));
+            n += set->parts[i].count;
+        }
+    }
+    qsort(files, n, sizeof(*files), compare_inode);
+
+    for (size_t i = 0; i < n; ) {
+        size_t j = i + 1;
+        size_t start = kept;
+
+        while (j < n && files[j].size == files[i].size) {
+            j++;
+        }
+        /* Đoạn cùng kích thước: giữ một file mỗi inode */
+        for (size_t k = i; k < j; k++) {
+            if (k > i && files[k].dev == files[k - 1].dev && files[k].ino == files[k - 1].ino) {
+                stats->hardlinks++;
+                continue;
+            }
+            files[kept++] = files[k];
+        }
+        if (kept - start < 2) {
+            kept = start;
+        }
+        i = j;
+    }
+    *count = kept;
+    return files;
+}
+
+/**
+ * @brief In các nhóm trong files[0 .. count) (đã sắp xếp theo compare_hash)
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int print_groups(const dupe_file_t *files, size_t count, writer_t *out,
+                        dupes_stats_t *stats)
+{
+    dupe_group_t *groups = malloc((count / 2 + 1) * sizeof(*groups));
+    size_t num_groups = 0;
+
+    if (groups == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < count; ) {
+        size_t j = i + 1;
+        while (j < count && files[j].size == files[i].size && files[j].hash == files[i].hash) {
+            j++;
+        }
+        groups[num_groups].start = i;
+        groups[num_groups].count = j - i;
+        groups[num_groups].wasted = files[i].size * (j - i - 1);
+        stats->duplicates += j - i - 1;
+        stats->reclaimable += groups[num_groups].wasted;
+        num_groups++;
+        i = j;
+    }
+    stats->groups = num_groups;
+    qsort(groups, num_groups, sizeof(*groups), compare_group);
+
+    for (size_t g = 0; g < num_groups; g++) {
+        const dupe_file_t *first = &files[groups[g].start];
+
+        writer_printf(out, "%llu bytes x %zu\n", (unsigned long long)first->size,
+                      groups[g].count);
+        for (size_t k = 0; k < groups[g].count; k++) {
+            writer_puts(out, first[k].path);
+            writer_write(out, "\n", 1);
+        }
+        writer_write(out, "\n", 1);
+    }
+    free(groups);
+    return 0;
+}
+
+int find_dupes(dupe_set_t *set, unsigned jobs, writer_t *out, dupes_stats_t *stats)
+{
+    struct timespec start;
+    struct timespec end;
+    dupe_file_t *files;
+    size_t count;
+    int result = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (jobs == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (unsigned)cpus : 1;
+    }
+
+    files = same_size_candidates(set, &count, stats);
+    if (files == NULL && stats->files > 0) {
+        return -1;
+    }
+    stats->same_size = count;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (hash_files(files, count, false, jobs, stats) != 0) {
+        result = -1;
+        goto done;
+    }
+    qsort(files, count, sizeof(*files), compare_hash);
+    count = keep_matches(files, count);
+    stats->same_edges = count;
+
+    if (hash_files(files, count, true, jobs, stats) != 0) {
+        result = -1;
+        goto done;
+    }
+    qsort(files, count, sizeof(*files), compare_hash);
+    count = keep_matches(files, count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stats->hash_ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL +
+                     (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+
+    result = print_groups(files, count, out, stats);
+
+done:
+    free(files);
+    return result;
+}
+
+void print_dupes_stats(writer_t *out, const dupes_stats_t *stats)
+{
+    char human[16];
+    double seconds = (double)stats->hash_ns / 1e9;
+
+    format_human(stats->reclaimable, human, sizeof(human));
+    writer_printf(out, "========================================\n");
+    writer_printf(out, "            DUPLICATE FILES             \n");
+    writer_printf(out, "========================================\n");
+    writer_printf(out, "Files:         %llu (%llu hard links counted once)\n",
+                  (unsigned long long)stats->files, (unsigned long long)stats->hardlinks);
+    writer_printf(out, "Same Size:     %llu\n", (unsigned long long)stats->same_size);
+    writer_printf(out, "Same Edges:    %llu (first and last %d KB)\n",
+                  (unsigned long long)stats->same_edges, DUPES_EDGE_SIZE / 1024);
+    writer_printf(out, "Groups:        %llu\n", (unsigned long long)stats->groups);
+    writer_printf(out, "Duplicates:    %llu\n", (unsigned long long)stats->duplicates);
+    writer_printf(out, "Reclaimable:   %llu bytes (%s)\n",
+                  (unsigned long long)stats->reclaimable, human);
+    writer_printf(out, "Hashed:        %llu bytes in %.0f ms (%.2f GB/s, xxh3 %s)\n",
+                  (unsigned long long)stats->bytes_hashed, seconds * 1000,
+                  seconds > 0 ? (double)stats->bytes_hashed / seconds / 1e9 : 0.0,
+                  xxh3_impl_name());
+    writer_printf(out, "Errors:        %llu\n", (unsigned long long)stats->errors);
+    writer_printf(out, "========================================\n");
+}
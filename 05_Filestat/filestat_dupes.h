@@ -0,0 +1,87 @@
+/**
+ * @file filestat_dupes.h
+ * @brief Tìm file trùng nội dung theo ba giai đoạn (chế độ --dupes)
+ *
+ * 1. Kích thước: trong lúc duyệt (statx() chỉ hỏi loại, kích thước và
+ *    inode), mỗi luồng ghi lại các regular file của nó. Chỉ các file có
+ *    cùng kích thước với ít nhất một file khác mới đi tiếp. Các hard link
+ *    của cùng một inode chỉ được tính một lần.
+ * 2. Đầu và cuối: băm 4 KB đầu và 4 KB cuối của mỗi ứng viên. File không
+ *    quá 8 KB được băm trọn ở bước này.
+ * 3. Toàn bộ: băm cả file (XXH3, xem filestat_hash.h) các ứng viên còn
+ *    lại, đọc theo đoạn 1 MB bằng pread().
+ *
+ * Bước 2 và 3 chạy trên một thread pool (--jobs), file lớn nhất trước.
+ * Hai file trùng khi có cùng kích thước và cùng hash 64 bit của toàn bộ
+ * nội dung.
+ */
+
+#ifndef FILESTAT_DUPES_H
+#define FILESTAT_DUPES_H
+
+#include "filestat.h"
+
+/* ======================== CONSTANTS ======================== */
+#define DUPES_EDGE_SIZE   4096          /* Giai đoạn 2: số byte đầu và cuối được băm */
+#define DUPES_READ_SIZE   (1 << 20)     /* Giai đoạn 3: buffer đọc của mỗi luồng */
+
+/* ======================== TYPES ======================== */
+
+/* Các file thu thập được trong lúc duyệt (opaque, mỗi luồng một phần) */
+typedef struct dupe_set dupe_set_t;
+
+/**
+ * @brief Kết quả của find_dupes()
+ */
+typedef struct {
+    uint64_t files;          /* Regular file không nhỏ hơn min_size */
+    uint64_t hardlinks;      /* Link trùng inode đã bỏ qua */
+    uint64_t same_size;      /* Ứng viên sau giai đoạn 1 */
+    uint64_t same_edges;     /* Ứng viên sau giai đoạn 2 */
+    uint64_t groups;         /* Nhóm file trùng */
+    uint64_t duplicates;     /* File trùng (không kể file đầu của mỗi nhóm) */
+    uint64_t reclaimable;    /* Byte giải phóng được nếu chỉ giữ một bản mỗi nhóm */
+    uint64_t bytes_hashed;   /* Byte đã đọc ở giai đoạn 2 và 3 */
+    uint64_t hash_ns;        /* Thời gian giai đoạn 2 và 3 */
+    uint64_t errors;         /* File không đọc được (bị loại) */
+} dupes_stats_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo tập rỗng với parts phần (một phần mỗi luồng duyệt)
+ * @param min_size Bỏ qua file nhỏ hơn (file rỗng luôn bị bỏ qua)
+ * @return Tập mới, hoặc NULL nếu hết bộ nhớ
+ */
+dupe_set_t *dupe_set_create(unsigned parts, uint64_t min_size);
+
+/**
+ * @brief Ghi lại một regular file <dir>/<name> (dir == NULL: name là path)
+ * @return 0 nếu thành công hoặc bị bỏ qua, -1 nếu hết bộ nhớ
+ */
+int dupe_set_add(dupe_set_t *set, unsigned part, const char *dir, size_t dir_len,
+                 const char *name, size_t name_len, const struct statx *stx);
+
+void dupe_set_destroy(dupe_set_t *set);
+
+/**
+ * @brief Chạy giai đoạn 2 và 3 rồi in các nhóm trùng
+ *
+ * Mỗi nhóm là một dòng "<kích thước> bytes x <số file>" rồi các path
+ * (theo thứ tự từ điển) và một dòng trống; nhóm lãng phí nhiều nhất in
+ * trước.
+ *
+ * @param set Các file đã thu thập
+ * @param jobs Số luồng băm, 0 = số CPU đang online
+ * @param out Writer nhận các nhóm
+ * @param stats Nhận kết quả tổng hợp
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+int find_dupes(dupe_set_t *set, unsigned jobs, writer_t *out, dupes_stats_t *stats);
+
+/**
+ * @brief In kết quả tổng hợp theo khung giống print_walk_stats()
+ */
+void print_dupes_stats(writer_t *out, const dupes_stats_t *stats);
+
+#endif /* FILESTAT_DUPES_H */
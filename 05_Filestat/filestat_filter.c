@@ -0,0 +1,717 @@
+/**
+ * @file filestat_filter.c
+ * @brief Dịch và đánh giá biểu thức --where/--prune
+ *
+ * Parser đệ quy (||, rồi &&, rồi !, ngoặc và phép so sánh) thêm node vào
+ * một mảng; node AND/OR/NOT trỏ tới node con bằng chỉ số. Mọi giá trị
+ * được chuyển sang dạng so sánh trực tiếp khi dịch: kích thước ra byte,
+ * tuổi ra mốc thời gian (đảo chiều toán tử), tên người dùng ra uid, mẫu
+ * glob không có ký tự đặc biệt ra so sánh chuỗi.
+ */
+
+#include "filestat_filter.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <grp.h>
+#include <limits.h>
+#include <pwd.h>
+
+/* ======================== CONSTANTS ======================== */
+#define FILTER_NONE     UINT32_MAX   /* Lỗi cú pháp (đã báo) */
+#define FILTER_PATH_MAX 4096         /* Path dài hơn được ghép trên heap */
+
+/* ======================== TYPES ======================== */
+
+typedef enum { NODE_AND, NODE_OR, NODE_NOT, NODE_TEST } node_kind_t;
+
+typedef enum {
+    KEY_NAME, KEY_PATH, KEY_TYPE, KEY_SIZE, KEY_BLOCKS, KEY_NLINK, KEY_INO,
+    KEY_UID, KEY_GID, KEY_MODE, KEY_MTIME, KEY_ATIME, KEY_CTIME, KEY_BTIME
+} filter_key_t;
+
+typedef enum { OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE } op_t;
+
+/* Cách đọc giá trị của một trường */
+typedef enum { VALUE_GLOB, VALUE_TYPE, VALUE_SIZE, VALUE_NUMBER, VALUE_USER, VALUE_GROUP,
+               VALUE_MODE, VALUE_TIME } value_kind_t;
+
+typedef struct {
+    uint8_t kind;            /* node_kind_t */
+    uint8_t key;             /* filter_key_t (NODE_TEST) */
+    uint8_t op;              /* op_t (NODE_TEST) */
+    bool literal;            /* Mẫu không có ký tự glob: so sánh bằng memcmp() */
+    uint32_t left;           /* AND/OR/NOT */
+    uint32_t right;          /* AND/OR */
+    int64_t value;           /* Số, mốc thời gian (giây), S_IFMT, quyền; độ dài mẫu literal */
+    char *pattern;           /* name, path */
+} filter_node_t;
+
+struct filter {
+    filter_node_t *nodes;
+    size_t count;
+    size_t cap;
+    uint32_t root;
+    unsigned int mask;
+};
+
+typedef struct {
+    const char *name;
+    filter_key_t key;
+    value_kind_t value;
+    unsigned int mask;       /* Trường statx() cần, 0: có sẵn từ getdents64() */
+} key_info_t;
+
+static const key_info_t keys[] = {
+    { "name",   KEY_NAME,   VALUE_GLOB,   0 },
+    { "path",   KEY_PATH,   VALUE_GLOB,   0 },
+    { "type",   KEY_TYPE,   VALUE_TYPE,   0 },
+    { "size",   KEY_SIZE,   VALUE_SIZE,   STATX_SIZE },
+    { "blocks", KEY_BLOCKS, VALUE_NUMBER, STATX_BLOCKS },
+    { "nlink",  KEY_NLINK,  VALUE_NUMBER, STATX_NLINK },
+    { "ino",    KEY_INO,    VALUE_NUMBER, STATX_INO },
+    { "uid",    KEY_UID,    VALUE_USER,   STATX_UID },
+    { "gid",    KEY_GID,    VALUE_GROUP,  STATX_GID },
+    { "mode",   KEY_MODE,   VALUE_MODE,   STATX_MODE },
+    { "mtime",  KEY_MTIME,  VALUE_TIME,   STATX_MTIME },
+    { "atime",  KEY_ATIME,  VALUE_TIME,   STATX_ATIME },
+    { "ctime",  KEY_CTIME,  VALUE_TIME,   STATX_CTIME },
+    { "btime",  KEY_BTIME,  VALUE_TIME,   STATX_BTIME },
+};
+#define NUM_KEYS (sizeof(keys) / sizeof(keys[0]))
+
+static const struct {
+    const char *name;
+    mode_t type;
+} type_names[] = {
+    { "reg", S_IFREG }, { "file", S_IFREG }, { "f", S_IFREG },
+    { "dir", S_IFDIR }, { "d", S_IFDIR },
+    { "lnk", S_IFLNK }, { "link", S_IFLNK }, { "l", S_IFLNK },
+    { "chr", S_IFCHR }, { "c", S_IFCHR },
+    { "blk", S_IFBLK }, { "b", S_IFBLK },
+    { "fifo", S_IFIFO }, { "p", S_IFIFO },
+    { "sock", S_IFSOCK }, { "s", S_IFSOCK },
+};
+#define NUM_TYPE_NAMES (sizeof(type_names) / sizeof(type_names[0]))
+
+typedef struct {
+    const char *text;        /* Cả biểu thức, cho thông báo lỗi */
+    const char *p;           /* Vị trí đang đọc */
+    filter_t *filter;
+    time_t now;
+} parser_t;
+
+/* ======================== PARSING ======================== */
+
+static void parse_error(const parser_t *ps, const char *what)
+{
+    if (*ps->p == '\0') {
+        fprintf(stderr, "Error: Invalid expression '%s': %s at end\n", ps->text, what);
+    } else {
+        fprintf(stderr, "Error: Invalid expression '%s': %s at '%s'\n", ps->text, what, ps->p);
+    }
+}
+
+static void skip_space(parser_t *ps)
+{
+    while (isspace((unsigned char)*ps->p)) {
+        ps->p++;
+    }
+}
+
+/**
+ * @brief Thêm một node
+ * @return Chỉ số, hoặc FILTER_NONE nếu hết bộ nhớ
+ */
+static uint32_t add_node(parser_t *ps, const filter_node_t *node)
+{
+    filter_t *f = ps->filter;
+
+    if (f->count == f->cap) {
+        size_t cap = f->cap ? f->cap * 2 : 16;
+        filter_node_t *nodes = realloc(f->nodes, cap * sizeof(*nodes));
+        if (nodes == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return FILTER_NONE;
+        }
+        f->nodes = nodes;
+        f->cap = cap;
+    }
+    f->nodes[f->count] = *node;
+    return (uint32_t)f->count++;
+}
+
+static uint32_t add_branch(parser_t *ps, node_kind_t kind, uint32_t left, uint32_t right)
+{
+    filter_node_t node = { (uint8_t)kind, 0, 0, false, left, right, 0, NULL };
+    return add_node(ps, &node);
+}
+
+/**
+ * @brief Đọc một giá trị: trong nháy đơn/kép, hoặc tới khoảng trắng, ')', && hay ||
+ * @return Bản sao (phải free), hoặc NULL nếu rỗng hay thiếu nháy đóng
+ */
+static char *read_value(parser_t *ps)
+{
+    const char *start = ps->p;
+    size_t len;
+    char *value;
+
+    if (*ps->p == '\'' || *ps->p == '"') {
+        char quote = *ps->p++;
+        start = ps->p;
+        while (*ps->p != '\0' && *ps->p != quote) {
+            ps->p++;
+        }
+        if (*ps->p != quote) {
+            parse_error(ps, "missing closing quote");
+            return NULL;
+        }
+        len = (size_t)(ps->p - start);
+        ps->p++;
+    } else {
+        while (*ps->p != '\0' && !isspace((unsigned char)*ps->p) && *ps->p != ')' &&
+               strncmp(ps->p, "&&", 2) != 0 && strncmp(ps->p, "||", 2) != 0) {
+            ps->p++;
+        }
+        len = (size_t)(ps->p - start);
+        if (len == 0) {
+            parse_error(ps, "expected a value");
+            return NULL;
+        }
+    }
+    value = malloc(len + 1);
+    if (value == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return NULL;
+    }
+    memcpy(value, start, len);
+    value[len] = '\0';
+    return value;
+}
+
+/**
+ * @brief Số nguyên không dấu với hậu tố tùy chọn; *end nhận phần còn lại
+ */
+static int parse_number(const char *text, int base, uint64_t *number, const char **end)
+{
+    char *stop;
+
+    if (!isdigit((unsigned char)text[0])) {
+        return -1;
+    }
+    errno = 0;
+    *number = strtoull(text, &stop, base);
+    if (errno != 0) {
+        return -1;
+    }
+    *end = stop;
+    return 0;
+}
+
+/**
+ * @brief "1M", "512k", "10GB" -> byte (lũy thừa 1024)
+ */
+static int parse_size(const char *text, int64_t *bytes)
+{
+    static const char units[] = "KMGTP";
+    uint64_t n;
+    const char *end;
+    unsigned shift = 0;
+
+    if (parse_number(text, 10, &n, &end) != 0) {
+        return -1;
+    }
+    if (*end != '\0') {
+        const char *unit = strchr(units, toupper((unsigned char)*end));
+        if (unit == NULL) {
+            return -1;
+        }
+        shift = 10 * (unsigned)(unit - units + 1);
+        end++;
+        if (*end == 'B' || *end == 'b') {
+            end++;
+        }
+    }
+    if (*end != '\0' || n > (UINT64_C(1) << (63 - shift))) {
+        return -1;
+    }
+    *bytes = (int64_t)(n << shift);
+    return 0;
+}
+
+/**
+ * @brief "30d" (tuổi, *age = true) hoặc "2026-01-01[T12:00[:00]]" (mốc, giờ địa phương)
+ * @return Số giây của tuổi, hoặc mốc thời gian
+ */
+static int parse_time(const char *text, int64_t *value, bool *age)
+{
+    static const struct { char unit; int64_t seconds; } units[] = {
+        { 's', 1 }, { 'm', 60 }, { 'h', 3600 }, { 'd', 86400 }, { 'w', 7 * 86400 },
+    };
+    struct tm tm;
+    const char *end;
+    uint64_t n;
+
+    memset(&tm, 0, sizeof(tm));
+    end = strptime(text, "%Y-%m-%d", &tm);
+    if (end != NULL) {
+        if (*end == 'T' || *end == ' ') {
+            const char *rest = strptime(end + 1, "%H:%M:%S", &tm);
+            end = rest != NULL ? rest : strptime(end + 1, "%H:%M", &tm);
+        }
+        if (end == NULL || *end != '\0') {
+            return -1;
+        }
+        tm.tm_isdst = -1;
+        *value = (int64_t)mktime(&tm);
+        *age = false;
+        return 0;
+    }
+
+    if (parse_number(text, 10, &n, &end) != 0 || end[0] == '\0' || end[1] != '\0') {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        if (*end == units[i].unit && n <= (uint64_t)(INT64_MAX / units[i].seconds)) {
+            *value = (int64_t)n * units[i].seconds;
+            *age = true;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Đổi giá trị chữ sang dạng so sánh của node (có thể đổi op)
+ */
+static int convert_value(parser_t *ps, const key_info_t *key, filter_node_t *node, char *text)
+{
+    uint64_t n;
+    const char *end;
+    bool age;
+
+    switch (key->value) {
+        case VALUE_GLOB:
+            if (node->op != OP_EQ && node->op != OP_NE) {
+                break;
+            }
+            node->pattern = text;
+            node->literal = strpbrk(text, "*?[\\") == NULL;
+            node->value = (int64_t)strlen(text);
+            return 0;
+        case VALUE_TYPE:
+            if (node->op != OP_EQ && node->op != OP_NE) {
+                break;
+            }
+            for (size_t i = 0; i < NUM_TYPE_NAMES; i++) {
+                if (strcmp(text, type_names[i].name) == 0) {
+                    node->value = type_names[i].type;
+                    free(text);
+                    return 0;
+                }
+            }
+            break;
+        case VALUE_SIZE:
+            if (parse_size(text, &node->value) == 0) {
+                free(text);
+                return 0;
+            }
+            break;
+        case VALUE_USER:
+        case VALUE_GROUP:
+            if (parse_number(text, 10, &n, &end) == 0 && *end == '\0') {
+                node->value = (int64_t)n;
+                free(text);
+                return 0;
+            }
+            /* Chỉ gọi một lần khi dịch, trước khi có luồng nào */
+            if (key->value == VALUE_USER) {
+                struct passwd *pw = getpwnam(text);
+                if (pw != NULL) {
+                    node->value = pw->pw_uid;
+                    free(text);
+                    return 0;
+                }
+            } else {
+                struct group *gr = getgrnam(text);
+                if (gr != NULL) {
+                    node->value = gr->gr_gid;
+                    free(text);
+                    return 0;
+                }
+            }
+            break;
+        case VALUE_NUMBER:
+        case VALUE_MODE:
+            if (parse_number(text, key->value == VALUE_MODE ? 8 : 10, &n, &end) == 0 &&
+                *end == '\0' && n <= (key->value == VALUE_MODE ? 07777 : INT64_MAX)) {
+                node->value = (int64_t)n;
+                free(text);
+                return 0;
+            }
+            break;
+        case VALUE_TIME:
+            if (parse_time(text, &node->value, &age) != 0) {
+                break;
+            }
+            if (age) {
+                /* Tuổi nhỏ hơn <=> mốc lớn hơn: mtime<30d <=> mtime > now - 30d */
+                static const op_t mirror[] = { OP_EQ, OP_NE, OP_GT, OP_GE, OP_LT, OP_LE };
+                node->value = (int64_t)ps->now - node->value;
+                node->op = mirror[node->op];
+            }
+            free(text);
+            return 0;
+    }
+    free(text);
+    return -1;
+}
+
+/**
+ * @brief <trường><toán tử><giá trị>
+ */
+static uint32_t parse_test(parser_t *ps)
+{
+    static const struct { const char *text; op_t op; } ops[] = {
+        { "==", OP_EQ }, { "!=", OP_NE }, { "<=", OP_LE }, { ">=", OP_GE },
+        { "<", OP_LT }, { ">", OP_GT }, { "=", OP_EQ },
+    };
+    filter_node_t node = { NODE_TEST, 0, 0, false, 0, 0, 0, NULL };
+    const key_info_t *key = NULL;
+    const char *start = ps->p;
+    const char *value_start;
+    size_t len = 0;
+    bool found = false;
+    char *text;
+    uint32_t index;
+
+    while (isalpha((unsigned char)start[len])) {
+        len++;
+    }
+    for (size_t i = 0; i < NUM_KEYS; i++) {
+        if (strlen(keys[i].name) == len && strncmp(start, keys[i].name, len) == 0) {
+            key = &keys[i];
+        }
+    }
+    if (key == NULL) {
+        parse_error(ps, "expected a field (name, path, type, size, blocks, nlink, ino, "
+                        "uid, gid, mode, mtime, atime, ctime, btime)");
+        return FILTER_NONE;
+    }
+    ps->p += len;
+    skip_space(ps);
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        size_t op_len = strlen(ops[i].text);
+        if (strncmp(ps->p, ops[i].text, op_len) == 0) {
+            node.op = (uint8_t)ops[i].op;
+            ps->p += op_len;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        parse_error(ps, "expected ==, !=, <, <=, > or >=");
+        return FILTER_NONE;
+    }
+    skip_space(ps);
+
+    value_start = ps->p;
+    text = read_value(ps);
+    if (text == NULL) {
+        return FILTER_NONE;
+    }
+    node.key = (uint8_t)key->key;
+    if (convert_value(ps, key, &node, text) != 0) {
+        ps->p = value_start;
+        parse_error(ps, key->value == VALUE_GLOB || key->value == VALUE_TYPE
+                        ? "invalid value or operator (only == and != for name, path, type)"
+                        : "invalid value");
+        return FILTER_NONE;
+    }
+    ps->filter->mask |= key->mask;
+    index = add_node(ps, &node);
+    if (index == FILTER_NONE) {
+        free(node.pattern);
+    }
+    return index;
+}
+
+static uint32_t parse_or(parser_t *ps);
+
+/**
+ * @brief ! <unary> | ( <or> ) | <test>
+ */
+static uint32_t parse_unary(parser_t *ps)
+{
+    uint32_t index;
+
+    skip_space(ps);
+    if (*ps->p == '!') {
+        ps->p++;
+        index = parse_unary(ps);
+        return index == FILTER_NONE ? FILTER_NONE : add_branch(ps, NODE_NOT, index, 0);
+    }
+    if (*ps->p == '(') {
+        ps->p++;
+        index = parse_or(ps);
+        if (index == FILTER_NONE) {
+            return FILTER_NONE;
+        }
+        skip_space(ps);
+        if (*ps->p != ')') {
+            parse_error(ps, "expected ')'");
+            return FILTER_NONE;
+        }
+        ps->p++;
+        return index;
+    }
+    return parse_test(ps);
+}
+
+static uint32_t parse_and(parser_t *ps)
+{
+    uint32_t left = parse_unary(ps);
+
+    skip_space(ps);
+    while (left != FILTER_NONE && strncmp(ps->p, "&&", 2) == 0) {
+        uint32_t right;
+        ps->p += 2;
+        right = parse_unary(ps);
+        left = right == FILTER_NONE ? FILTER_NONE : add_branch(ps, NODE_AND, left, right);
+        skip_space(ps);
+    }
+    return left;
+}
+
+static uint32_t parse_or(parser_t *ps)
+{
+    uint32_t left = parse_and(ps);
+
+    while (left != FILTER_NONE && strncmp(ps->p, "||", 2) == 0) {
+        uint32_t right;
+        ps->p += 2;
+        right = parse_and(ps);
+        left = right == FILTER_NONE ? FILTER_NONE : add_branch(ps, NODE_OR, left, right);
+    }
+    return left;
+}
+
+filter_t *filter_compile(const char *text)
+{
+    parser_t ps = { text, text, NULL, time(NULL) };
+
+    ps.filter = calloc(1, sizeof(*ps.filter));
+    if (ps.filter == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return NULL;
+    }
+    ps.filter->root = parse_or(&ps);
+    if (ps.filter->root != FILTER_NONE) {
+        skip_space(&ps);
+        if (*ps.p != '\0') {
+            parse_error(&ps, "expected && or ||");
+            ps.filter->root = FILTER_NONE;
+        }
+    }
+    if (ps.filter->root == FILTER_NONE) {
+        filter_free(ps.filter);
+        return NULL;
+    }
+    return ps.filter;
+}
+
+void filter_free(filter_t *filter)
+{
+    if (filter == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < filter->count; i++) {
+        free(filter->nodes[i].pattern);
+    }
+    free(filter->nodes);
+    free(filter);
+}
+
+unsigned int filter_statx_mask(const filter_t *filter)
+{
+    return filter->mask;
+}
+
+/* ======================== EVALUATION ======================== */
+
+static bool compare(op_t op, int64_t a, int64_t b)
+{
+    switch (op) {
+        case OP_EQ: return a == b;
+        case OP_NE: return a != b;
+        case OP_LT: return a < b;
+        case OP_LE: return a <= b;
+        case OP_GT: return a > b;
+        case OP_GE: return a >= b;
+    }
+    return false;
+}
+
+static bool match_pattern(const filter_node_t *node, const char *text, size_t len)
+{
+    if (node->literal) {
+        return (size_t)node->value == len && memcmp(node->pattern, text, len) == 0;
+    }
+    return fnmatch(node->pattern, text, 0) == 0;
+}
+
+/**
+ * @brief name== với gốc: so với thành phần cuối của path ("a/b/" -> "b", "/" -> "/")
+ */
+static bool match_root_name(const filter_node_t *node, const char *path, size_t len)
+{
+    char name[NAME_MAX + 1];
+    size_t start;
+
+    while (len > 1 && path[len - 1] == '/') {
+        len--;
+    }
+    start = len;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+    if (start == len) {
+        start = len - (len > 0);
+    }
+    if (len - start > NAME_MAX) {
+        return false;
+    }
+    memcpy(name, path + start, len - start);
+    name[len - start] = '\0';
+    return match_pattern(node, name, len - start);
+}
+
+/**
+ * @brief So khớp mẫu với <dir>/<name>, ghép path như walker
+ */
+static bool match_path(const filter_node_t *node, const filter_entry_t *e)
+{
+    char stack[FILTER_PATH_MAX];
+    char *path = stack;
+    size_t sep;
+    size_t len;
+    bool result;
+
+    if (e->dir == NULL) {
+        return match_pattern(node, e->name, e->name_len);
+    }
+    sep = (e->dir_len > 0 && e->dir[e->dir_len - 1] != '/') ? 1 : 0;
+    len = e->dir_len + sep + e->name_len;
+    if (len >= sizeof(stack) && (path = malloc(len + 1)) == NULL) {
+        return false;
+    }
+    memcpy(path, e->dir, e->dir_len);
+    path[e->dir_len] = '/';
+    memcpy(path + e->dir_len + sep, e->name, e->name_len);
+    path[len] = '\0';
+    result = match_pattern(node, path, len);
+    if (path != stack) {
+        free(path);
+    }
+    return result;
+}
+
+static filter_result_t eval_test(const filter_node_t *node, const filter_entry_t *e)
+{
+    const struct statx *st = e->stx;
+    bool equal;
+    int64_t value;
+
+    switch ((filter_key_t)node->key) {
+        case KEY_NAME:
+            equal = e->dir != NULL ? match_pattern(node, e->name, e->name_len)
+                                   : match_root_name(node, e->name, e->name_len);
+            return (filter_result_t)(equal == (node->op == OP_EQ));
+        case KEY_PATH:
+            equal = match_path(node, e);
+            return (filter_result_t)(equal == (node->op == OP_EQ));
+        case KEY_TYPE:
+            if (st != NULL) {
+                equal = (st->stx_mode & S_IFMT) == (mode_t)node->value;
+            } else if (e->type != 0) {
+                equal = e->type == (mode_t)node->value;
+            } else {
+                return FILTER_UNKNOWN;
+            }
+            return (filter_result_t)(equal == (node->op == OP_EQ));
+        default:
+            break;
+    }
+
+    if (st == NULL) {
+        return FILTER_UNKNOWN;
+    }
+    switch ((filter_key_t)node->key) {
+        case KEY_SIZE:   value = (int64_t)st->stx_size; break;
+        case KEY_BLOCKS: value = (int64_t)st->stx_blocks; break;
+        case KEY_NLINK:  value = st->stx_nlink; break;
+        case KEY_INO:    value = (int64_t)st->stx_ino; break;
+        case KEY_UID:    value = st->stx_uid; break;
+        case KEY_GID:    value = st->stx_gid; break;
+        case KEY_MODE:   value = st->stx_mode & 07777; break;
+        case KEY_MTIME:  value = st->stx_mtime.tv_sec; break;
+        case KEY_ATIME:  value = st->stx_atime.tv_sec; break;
+        case KEY_CTIME:  value = st->stx_ctime.tv_sec; break;
+        case KEY_BTIME:
+            /* Hệ thống file không lưu birth time: không entry nào khớp */
+            if (!(st->stx_mask & STATX_BTIME)) {
+                return FILTER_FALSE;
+            }
+            value = st->stx_btime.tv_sec;
+            break;
+        default:
+            return FILTER_FALSE;
+    }
+    return (filter_result_t)compare((op_t)node->op, value, node->value);
+}
+
+/**
+ * @brief Logic ba giá trị (Kleene): FALSE && x = FALSE, TRUE || x = TRUE
+ */
+static filter_result_t eval_node(const filter_t *filter, uint32_t index, const filter_entry_t *e)
+{
+    const filter_node_t *node = &filter->nodes[index];
+    filter_result_t left;
+    filter_result_t right;
+
+    switch ((node_kind_t)node->kind) {
+        case NODE_AND:
+            left = eval_node(filter, node->left, e);
+            if (left == FILTER_FALSE) {
+                return FILTER_FALSE;
+            }
+            right = eval_node(filter, node->right, e);
+            if (right == FILTER_FALSE) {
+                return FILTER_FALSE;
+            }
+            return left == FILTER_TRUE && right == FILTER_TRUE ? FILTER_TRUE : FILTER_UNKNOWN;
+        case NODE_OR:
+            left = eval_node(filter, node->left, e);
+            if (left == FILTER_TRUE) {
+                return FILTER_TRUE;
+            }
+            right = eval_node(filter, node->right, e);
+            if (right == FILTER_TRUE) {
+                return FILTER_TRUE;
+            }
+            return left == FILTER_FALSE && right == FILTER_FALSE ? FILTER_FALSE : FILTER_UNKNOWN;
+        case NODE_NOT:
+            left = eval_node(filter, node->left, e);
+            return left == FILTER_UNKNOWN ? FILTER_UNKNOWN
+                                          : (filter_result_t)(left == FILTER_FALSE);
+        case NODE_TEST:
+            return eval_test(node, e);
+    }
+    return FILTER_FALSE;
+}
+
+filter_result_t filter_eval(const filter_t *filter, const filter_entry_t *entry)
+{
+    return eval_node(filter, filter->root, entry);
+}
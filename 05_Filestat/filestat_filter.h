@@ -0,0 +1,74 @@
+/**
+ * @file filestat_filter.h
+ * @brief Biểu thức lọc entry khi duyệt (--where) và cắt tỉa thư mục (--prune)
+ *
+ * Cú pháp: các phép so sánh <trường><toán tử><giá trị> ghép bằng &&, ||,
+ * ! và ngoặc, ví dụ 'type==reg && size>1M && mtime<30d'.
+ *
+ *   name, path    == hoặc != với mẫu glob (fnmatch(), '*' khớp cả '/' trong path)
+ *   type          == hoặc != với reg, dir, lnk, chr, blk, fifo, sock
+ *   size          byte, hậu tố K, M, G, T (lũy thừa 1024)
+ *   blocks, nlink, ino
+ *   uid, gid      số hoặc tên
+ *   mode          quyền, bát phân (mode==0644)
+ *   mtime, atime, ctime, btime
+ *                 tuổi với hậu tố s, m, h, d, w (mtime<30d: sửa trong 30
+ *                 ngày qua) hoặc ngày YYYY-MM-DD[THH:MM[:SS]] giờ địa phương
+ *                 (mtime<2026-01-01: sửa trước ngày đó)
+ *
+ * Biểu thức được dịch một lần thành mảng node và đánh giá với logic ba
+ * giá trị: khi chỉ có tên và d_type của getdents64(), các phép so sánh
+ * cần statx() cho kết quả "chưa biết", và một entry có kết quả FALSE ngay
+ * từ lúc đó không cần statx().
+ */
+
+#ifndef FILESTAT_FILTER_H
+#define FILESTAT_FILTER_H
+
+#include "filestat.h"
+
+/* ======================== TYPES ======================== */
+
+/* Biểu thức đã dịch (opaque, chỉ đọc khi đánh giá nên dùng chung giữa các luồng) */
+typedef struct filter filter_t;
+
+typedef enum {
+    FILTER_FALSE = 0,
+    FILTER_TRUE = 1,
+    FILTER_UNKNOWN = 2       /* Cần statx() để quyết định */
+} filter_result_t;
+
+/**
+ * @brief Những gì đã biết về một entry <dir>/<name>
+ */
+typedef struct {
+    const char *dir;         /* Thư mục chứa, NULL với gốc */
+    size_t dir_len;
+    const char *name;        /* Tên; với gốc là cả path (name== so với thành phần cuối) */
+    size_t name_len;
+    mode_t type;             /* S_IFMT từ d_type, 0 nếu chưa biết */
+    const struct statx *stx; /* NULL: chưa statx() */
+} filter_entry_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Dịch một biểu thức
+ * @return Biểu thức đã dịch, hoặc NULL nếu sai cú pháp (đã báo trên stderr)
+ */
+filter_t *filter_compile(const char *text);
+
+void filter_free(filter_t *filter);
+
+/**
+ * @brief Các trường statx() mà biểu thức cần (0 nếu chỉ dùng name, path, type)
+ */
+unsigned int filter_statx_mask(const filter_t *filter);
+
+/**
+ * @brief Đánh giá biểu thức cho một entry
+ * @return FILTER_UNKNOWN chỉ khi entry->stx == NULL và kết quả phụ thuộc statx()
+ */
+filter_result_t filter_eval(const filter_t *filter, const filter_entry_t *entry);
+
+#endif /* FILESTAT_FILTER_H */
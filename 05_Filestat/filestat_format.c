@@ -0,0 +1,800 @@
+/**
+ * @file filestat_format.c
+ * @brief JSON Lines, CSV, TSV, dòng -r và bản ghi bin
+ *
+ * Mọi bản ghi được định dạng thẳng vào buffer của writer_t qua
+ * writer_reserve(): số nguyên và thời gian được chuyển thành chữ số bằng
+ * tay, không có printf(), strftime() hay localtime() (khóa múi giờ) nào
+ * trên đường nóng.
+ */
+
+#include "filestat_format.h"
+#include <errno.h>
+
+/* ======================== CONSTANTS ======================== */
+#define ESCAPE_CHUNK   4096   /* Byte path escape mỗi lần writer_reserve() */
+#define BIN_COPY_SIZE  (64 * 1024)
+
+_Static_assert(sizeof(bin_header_t) == 64, "bin_header_t must be 64 bytes");
+_Static_assert(sizeof(bin_record_t) == 128, "bin_record_t must be 128 bytes");
+_Static_assert(sizeof(bin_trailer_t) == 32, "bin_trailer_t must be 32 bytes");
+
+/* ======================== TYPES ======================== */
+
+struct bin_sink {
+    writer_t *out;               /* Nhận header, path blob và trailer */
+    FILE *paths;                 /* File tạm chứa path blob tới bin_sink_close() */
+    uint64_t records;
+    uint64_t paths_size;
+    unsigned int fields;
+    bool failed;
+    pthread_mutex_t lock;        /* Bảo vệ paths, records, paths_size */
+};
+
+/**
+ * @brief Tên và bit statx() của các trường, theo thứ tự bit FIELD_* (thứ tự in)
+ */
+static const struct {
+    unsigned int field;
+    unsigned int statx_bit;      /* 0: luôn có (attrs) */
+    const char *name;
+} field_names[] = {
+    { FIELD_TYPE,   STATX_TYPE,   "type"   },
+    { FIELD_SIZE,   STATX_SIZE,   "size"   },
+    { FIELD_MTIME,  STATX_MTIME,  "mtime"  },
+    { FIELD_MODE,   STATX_MODE,   "mode"   },
+    { FIELD_NLINK,  STATX_NLINK,  "nlink"  },
+    { FIELD_UID,    STATX_UID,    "uid"    },
+    { FIELD_GID,    STATX_GID,    "gid"    },
+    { FIELD_INO,    STATX_INO,    "ino"    },
+    { FIELD_BLOCKS, STATX_BLOCKS, "blocks" },
+    { FIELD_ATIME,  STATX_ATIME,  "atime"  },
+    { FIELD_CTIME,  STATX_CTIME,  "ctime"  },
+    { FIELD_BTIME,  STATX_BTIME,  "btime"  },
+    { FIELD_MNT_ID, STATX_MNT_ID, "mnt_id" },
+    { FIELD_ATTRS,  0,            "attrs"  },
+};
+
+#define NUM_FIELDS (sizeof(field_names) / sizeof(field_names[0]))
+
+/* ======================== PARSING ======================== */
+
+int parse_format(const char *name, output_format_t *format)
+{
+    static const struct {
+        const char *name;
+        output_format_t format;
+    } formats[] = {
+        { "text", FORMAT_TEXT },
+        { "json", FORMAT_JSON },
+        { "csv",  FORMAT_CSV  },
+        { "tsv",  FORMAT_TSV  },
+        { "bin",  FORMAT_BIN  },
+    };
+
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        if (strcmp(name, formats[i].name) == 0) {
+            *format = formats[i].format;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int parse_fields(const char *list, unsigned int *fields)
+{
+    unsigned int result = 0;
+    const char *p = list;
+
+    while (*p != '\0') {
+        size_t len = strcspn(p, ",");
+        bool found = false;
+
+        if (len == 3 && strncmp(p, "all", 3) == 0) {
+            result |= FIELDS_ALL;
+            found = true;
+        }
+        for (size_t i = 0; !found && i < NUM_FIELDS; i++) {
+            if (strlen(field_names[i].name) == len && strncmp(p, field_names[i].name, len) == 0) {
+                result |= field_names[i].field;
+                found = true;
+            }
+        }
+        if (!found && len > 0) {
+            fprintf(stderr, "Error: Unknown field '%.*s'\n", (int)len, p);
+            return -1;
+        }
+        p += len;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    *fields = result;
+    return 0;
+}
+
+/* ======================== NUMBER FORMATTING ======================== */
+
+/* "00" "01" ... "99": mỗi phép chia cho 100 cho ra hai chữ số */
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * @brief Ghi số nguyên không dấu dạng thập phân
+ *
+ * Đếm số chữ số trước rồi ghi từ cuối về, hai chữ số mỗi lần.
+ *
+ * @return Con trỏ ngay sau chữ số cuối
+ */
+static char *put_u64(char *p, uint64_t value)
+{
+    size_t n = 1;
+    char *end;
+
+    for (uint64_t v = value; v >= 10; v /= 10) {
+        n++;
+    }
+    end = p + n;
+    p = end;
+    while (value >= 100) {
+        unsigned int pair = (unsigned int)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = digit_pairs[value * 2 + 1];
+        *--p = digit_pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return end;
+}
+
+static char *put_i64(char *p, int64_t value)
+{
+    if (value < 0) {
+        *p++ = '-';
+        return put_u64(p, (uint64_t)0 - (uint64_t)value);
+    }
+    return put_u64(p, (uint64_t)value);
+}
+
+/**
+ * @brief Ghi số 0-99 thành đúng hai chữ số
+ */
+static char *put_2(char *p, unsigned int value)
+{
+    *p++ = (char)('0' + value / 10);
+    *p++ = (char)('0' + value % 10);
+    return p;
+}
+
+/**
+ * @brief Ghi quyền truy cập thành 4 chữ số bát phân ("0644")
+ */
+static char *put_octal(char *p, unsigned int mode)
+{
+    *p++ = (char)('0' + ((mode >> 9) & 7));
+    *p++ = (char)('0' + ((mode >> 6) & 7));
+    *p++ = (char)('0' + ((mode >> 3) & 7));
+    *p++ = (char)('0' + (mode & 7));
+    return p;
+}
+
+/**
+ * @brief Ghi thời điểm Unix thành ISO 8601 UTC, ví dụ "2026-01-20T15:30:45Z"
+ *
+ * Ngày được tính bằng thuật toán civil_from_days của Howard Hinnant:
+ * chỉ vài phép chia số nguyên, đúng cho cả thời điểm trước 1970.
+ */
+static char *put_time(char *p, int64_t seconds)
+{
+    int64_t days = seconds / 86400;
+    int64_t rem = seconds % 86400;
+
+    if (rem < 0) {
+        rem += 86400;
+        days--;
+    }
+
+    /* Chuyển về kỷ nguyên 400 năm bắt đầu từ 0000-03-01 */
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned int doe = (unsigned int)(z - era * 146097);                       /* [0, 146096] */
+    unsigned int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  /* [0, 399] */
+    int64_t year = (int64_t)yoe + era * 400;
+    unsigned int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                /* [0, 365] */
+    unsigned int mp = (5 * doy + 2) / 153;                                     /* [0, 11] */
+    unsigned int day = doy - (153 * mp + 2) / 5 + 1;
+    unsigned int month = mp < 10 ? mp + 3 : mp - 9;
+
+    if (month <= 2) {
+        year++;
+    }
+
+    if (year >= 0 && year <= 9999) {
+        unsigned int y = (unsigned int)year;
+        p = put_2(p, y / 100);
+        p = put_2(p, y % 100);
+    } else {
+        p = put_i64(p, year);
+    }
+    *p++ = '-';
+    p = put_2(p, month);
+    *p++ = '-';
+    p = put_2(p, day);
+    *p++ = 'T';
+    p = put_2(p, (unsigned int)(rem / 3600));
+    *p++ = ':';
+    p = put_2(p, (unsigned int)(rem / 60 % 60));
+    *p++ = ':';
+    p = put_2(p, (unsigned int)(rem % 60));
+    *p++ = 'Z';
+    return p;
+}
+
+static char *put_str(char *p, const char *text)
+{
+    size_t len = strlen(text);
+    memcpy(p, text, len);
+    return p + len;
+}
+
+/* ======================== FIELD VALUES ======================== */
+
+/**
+ * @brief Ký tự loại file giống %y của find
+ */
+static char type_char(mode_t mode)
+{
+    if (S_ISREG(mode))  return 'f';
+    if (S_ISDIR(mode))  return 'd';
+    if (S_ISLNK(mode))  return 'l';
+    if (S_ISCHR(mode))  return 'c';
+    if (S_ISBLK(mode))  return 'b';
+    if (S_ISFIFO(mode)) return 'p';
+    if (S_ISSOCK(mode)) return 's';
+    return '?';
+}
+
+/**
+ * @brief Tên loại file trong JSON/CSV/TSV
+ */
+static const char *type_name(mode_t mode)
+{
+    if (S_ISREG(mode))  return "file";
+    if (S_ISDIR(mode))  return "dir";
+    if (S_ISLNK(mode))  return "symlink";
+    if (S_ISCHR(mode))  return "chardev";
+    if (S_ISBLK(mode))  return "blockdev";
+    if (S_ISFIFO(mode)) return "fifo";
+    if (S_ISSOCK(mode)) return "socket";
+    return "unknown";
+}
+
+/**
+ * @brief Filesystem có trả về trường thứ i của field_names không
+ */
+static bool field_available(size_t i, const struct statx *stx)
+{
+    return field_names[i].statx_bit == 0 || (stx->stx_mask & field_names[i].statx_bit) != 0;
+}
+
+/**
+ * @brief Các thuộc tính đang bật, ngăn cách bởi sep (JSON: mỗi tên trong ngoặc kép)
+ */
+static char *put_attrs(char *p, const struct statx *stx, output_format_t format)
+{
+    uint64_t attrs = stx->stx_attributes & stx->stx_attributes_mask;
+    bool first = true;
+
+    for (size_t i = 0; i < NUM_ATTRIBUTE_NAMES; i++) {
+        if (!(attrs & attribute_names[i].bit)) {
+            continue;
+        }
+        if (!first) {
+            *p++ = format == FORMAT_JSON ? ',' : '|';
+        }
+        first = false;
+        if (format == FORMAT_JSON) {
+            *p++ = '"';
+            p = put_str(p, attribute_names[i].name);
+            *p++ = '"';
+        } else {
+            p = put_str(p, attribute_names[i].name);
+        }
+    }
+    return p;
+}
+
+static const struct statx_timestamp *field_time(unsigned int field, const struct statx *stx)
+{
+    switch (field) {
+        case FIELD_ATIME: return &stx->stx_atime;
+        case FIELD_CTIME: return &stx->stx_ctime;
+        case FIELD_BTIME: return &stx->stx_btime;
+        default:          return &stx->stx_mtime;
+    }
+}
+
+/**
+ * @brief Giá trị của một trường (đã biết là có)
+ */
+static char *put_value(char *p, unsigned int field, const struct statx *stx,
+                       output_format_t format)
+{
+    bool quote = format == FORMAT_JSON;   /* Chuỗi trong JSON cần ngoặc kép */
+
+    switch (field) {
+        case FIELD_TYPE:
+            if (format == FORMAT_TEXT) {
+                *p++ = type_char(stx->stx_mode);
+                return p;
+            }
+            if (quote) *p++ = '"';
+            p = put_str(p, type_name(stx->stx_mode));
+            if (quote) *p++ = '"';
+            return p;
+        case FIELD_SIZE:   return put_u64(p, stx->stx_size);
+        case FIELD_NLINK:  return put_u64(p, stx->stx_nlink);
+        case FIELD_UID:    return put_u64(p, stx->stx_uid);
+        case FIELD_GID:    return put_u64(p, stx->stx_gid);
+        case FIELD_INO:    return put_u64(p, stx->stx_ino);
+        case FIELD_BLOCKS: return put_u64(p, stx->stx_blocks);
+        case FIELD_MNT_ID: return put_u64(p, stx->stx_mnt_id);
+        case FIELD_MODE:
+            if (quote) *p++ = '"';
+            p = put_octal(p, stx->stx_mode & 07777);
+            if (quote) *p++ = '"';
+            return p;
+        case FIELD_MTIME:
+        case FIELD_ATIME:
+        case FIELD_CTIME:
+        case FIELD_BTIME:
+            if (format == FORMAT_TEXT) {
+                return put_i64(p, field_time(field, stx)->tv_sec);
+            }
+            if (quote) *p++ = '"';
+            p = put_time(p, field_time(field, stx)->tv_sec);
+            if (quote) *p++ = '"';
+            return p;
+        case FIELD_ATTRS:
+            if (format == FORMAT_JSON) {
+                *p++ = '[';
+                p = put_attrs(p, stx, format);
+                *p++ = ']';
+                return p;
+            }
+            if (format == FORMAT_TEXT && (stx->stx_attributes & stx->stx_attributes_mask) == 0) {
+                /* Dòng -r ngăn trường bằng dấu cách: không để trường rỗng */
+                *p++ = '-';
+                return p;
+            }
+            return put_attrs(p, stx, format);
+        default:
+            return p;
+    }
+}
+
+/**
+ * @brief Các trường đã chọn, mỗi trường kèm dấu phân cách của định dạng
+ *
+ * JSON: ,"name":value   CSV: ,value   TSV: \tvalue   TEXT: value + dấu cách
+ */
+static char *put_fields(char *p, output_format_t format, unsigned int fields,
+                        const struct statx *stx)
+{
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        unsigned int field = field_names[i].field;
+        bool available;
+
+        if (!(fields & field)) {
+            continue;
+        }
+        available = field_available(i, stx);
+
+        switch (format) {
+            case FORMAT_JSON:
+                *p++ = ',';
+                *p++ = '"';
+                p = put_str(p, field_names[i].name);
+                *p++ = '"';
+                *p++ = ':';
+                p = available ? put_value(p, field, stx, format) : put_str(p, "null");
+                break;
+            case FORMAT_CSV:
+            case FORMAT_TSV:
+                *p++ = format == FORMAT_CSV ? ',' : '\t';
+                if (available) {
+                    p = put_value(p, field, stx, format);
+                }
+                break;
+            default:
+                p = available ? put_value(p, field, stx, format) : put_str(p, "-");
+                *p++ = ' ';
+                break;
+        }
+    }
+    return p;
+}
+
+/* ======================== PATH ESCAPING ======================== */
+
+/**
+ * @brief Độ dài chuỗi UTF-8 hợp lệ bắt đầu tại s[0] (byte đầu >= 0x80)
+ *
+ * Theo bảng 3-7 của Unicode: không chấp nhận dạng dài hơn cần thiết,
+ * surrogate (U+D800..U+DFFF) và giá trị lớn hơn U+10FFFF.
+ *
+ * @return 2..4, hoặc 0 nếu không hợp lệ (kể cả bị cắt ở cuối đoạn)
+ */
+static size_t utf8_sequence(const unsigned char *s, size_t len)
+{
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xbf;
+    size_t n;
+
+    if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+        n = 2;
+    } else if (s[0] >= 0xe0 && s[0] <= 0xef) {
+        n = 3;
+        lo = s[0] == 0xe0 ? 0xa0 : 0x80;
+        hi = s[0] == 0xed ? 0x9f : 0xbf;
+    } else if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+        n = 4;
+        lo = s[0] == 0xf0 ? 0x90 : 0x80;
+        hi = s[0] == 0xf4 ? 0x8f : 0xbf;
+    } else {
+        return 0;
+    }
+    if (len < n || s[1] < lo || s[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; i++) {
+        if (s[i] < 0x80 || s[i] > 0xbf) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Escape một đoạn path vào p (chỗ trống >= FORMAT_ESCAPE_MAX * len)
+ */
+static char *escape_chunk(char *p, output_format_t format, const char *s, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+
+        switch (format) {
+            case FORMAT_JSON:
+                if (c >= 0x80) {
+                    /* UTF-8 hợp lệ giữ nguyên, mỗi byte không hợp lệ thành U+FFFD */
+                    size_t n = utf8_sequence((const unsigned char *)s + i, len - i);
+
+                    if (n == 0) {
+                        p = put_str(p, "\\ufffd");
+                    } else {
+                        memcpy(p, s + i, n);
+                        p += n;
+                        i += n - 1;
+                    }
+                } else if (c == '"' || c == '\\') {
+                    *p++ = '\\';
+                    *p++ = (char)c;
+                } else if (c == '\n') {
+                    *p++ = '\\';
+                    *p++ = 'n';
+                } else if (c == '\t') {
+                    *p++ = '\\';
+                    *p++ = 't';
+                } else if (c == '\r') {
+                    *p++ = '\\';
+                    *p++ = 'r';
+                } else if (c < 0x20) {
+                    p = put_str(p, "\\u00");
+                    *p++ = hex[c >> 4];
+                    *p++ = hex[c & 15];
+                } else {
+                    *p++ = (char)c;
+                }
+                break;
+            case FORMAT_CSV:
+                /* Path luôn nằm trong ngoặc kép: chỉ cần nhân đôi dấu " */
+                if (c == '"') {
+                    *p++ = '"';
+                }
+                *p++ = (char)c;
+                break;
+            case FORMAT_TSV:
+                if (c == '\t' || c == '\n' || c == '\r' || c == '\\') {
+                    *p++ = '\\';
+                    *p++ = c == '\t' ? 't' : c == '\n' ? 'n' : c == '\r' ? 'r' : '\\';
+                } else {
+                    *p++ = (char)c;
+                }
+                break;
+            default:
+                *p++ = (char)c;
+                break;
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief Ghi một phần path vào writer, escape theo định dạng
+ *
+ * Chỉ flush khi writer không còn đủ chỗ cho một đoạn ESCAPE_CHUNK byte;
+ * người gọi muốn bản ghi không bị chia thì để sẵn đủ chỗ trước.
+ */
+static void write_escaped(writer_t *out, output_format_t format, const char *s, size_t len)
+{
+    if (format == FORMAT_TEXT) {
+        writer_write(out, s, len);
+        return;
+    }
+    while (len > 0) {
+        size_t n = len < ESCAPE_CHUNK ? len : ESCAPE_CHUNK;
+
+        /* Không cắt một ký tự UTF-8 giữa hai đoạn (JSON kiểm tra từng ký tự) */
+        for (size_t back = 0; n < len && back < 3 && ((unsigned char)s[n] & 0xc0) == 0x80; back++) {
+            n--;
+        }
+        char *p = writer_reserve(out, n * FORMAT_ESCAPE_MAX);
+        writer_commit(out, escape_chunk(p, format, s, n));
+        s += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Ghi path đầy đủ (dir + "/" + name)
+ */
+static void write_path(writer_t *out, output_format_t format, const record_path_t *path)
+{
+    if (path->dir != NULL) {
+        write_escaped(out, format, path->dir, path->dir_len);
+        if (path->dir_len == 0 || path->dir[path->dir_len - 1] != '/') {
+            writer_write(out, "/", 1);
+        }
+    }
+    write_escaped(out, format, path->name, path->name_len);
+}
+
+/* ======================== RECORDS ======================== */
+
+void format_header(writer_t *out, output_format_t format, unsigned int fields)
+{
+    char sep;
+
+    if (format != FORMAT_CSV && format != FORMAT_TSV) {
+        return;
+    }
+    sep = format == FORMAT_CSV ? ',' : '\t';
+
+    writer_puts(out, "path");
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        if (fields & field_names[i].field) {
+            writer_write(out, &sep, 1);
+            writer_puts(out, field_names[i].name);
+        }
+    }
+    writer_write(out, "\n", 1);
+}
+
+void format_record(writer_t *out, output_format_t format, unsigned int fields,
+                   const record_path_t *path, const struct statx *stx)
+{
+    char *p;
+
+    switch (format) {
+        case FORMAT_JSON:
+            writer_write(out, "{\"path\":\"", 9);
+            write_path(out, format, path);
+            p = writer_reserve(out, FORMAT_RECORD_MAX);
+            *p++ = '"';
+            p = put_fields(p, format, fields, stx);
+            *p++ = '}';
+            *p++ = '\n';
+            writer_commit(out, p);
+            break;
+        case FORMAT_CSV:
+        case FORMAT_TSV:
+            if (format == FORMAT_CSV) {
+                writer_write(out, "\"", 1);
+            }
+            write_path(out, format, path);
+            p = writer_reserve(out, FORMAT_RECORD_MAX);
+            if (format == FORMAT_CSV) {
+                *p++ = '"';
+            }
+            p = put_fields(p, format, fields, stx);
+            *p++ = '\n';
+            writer_commit(out, p);
+            break;
+        default:
+            /* Dòng -r: các trường trước, path ở cuối như find -printf */
+            p = writer_reserve(out, FORMAT_RECORD_MAX);
+            writer_commit(out, put_fields(p, format, fields, stx));
+            write_path(out, format, path);
+            writer_write(out, "\n", 1);
+            break;
+    }
+}
+
+/* ======================== BINARY OUTPUT ======================== */
+
+bin_sink_t *bin_sink_open(writer_t *out, unsigned int fields)
+{
+    bin_header_t header;
+    bin_sink_t *sink;
+
+    if (isatty(out->fd)) {
+        fprintf(stderr, "Error: Refusing to write binary output to a terminal\n");
+        return NULL;
+    }
+    sink = calloc(1, sizeof(*sink));
+    if (sink == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return NULL;
+    }
+    sink->paths = tmpfile();
+    if (sink->paths == NULL) {
+        fprintf(stderr, "Error: Cannot create temporary file: %s\n", strerror(errno));
+        free(sink);
+        return NULL;
+    }
+    sink->out = out;
+    sink->fields = fields;
+    pthread_mutex_init(&sink->lock, NULL);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BIN_MAGIC, sizeof(header.magic));
+    header.version = BIN_VERSION;
+    header.header_size = sizeof(bin_header_t);
+    header.record_size = sizeof(bin_record_t);
+    header.fields = fields;
+    writer_write(out, &header, sizeof(header));
+    return sink;
+}
+
+static void set_time(const struct statx_timestamp *ts, int64_t *sec, uint32_t *nsec)
+{
+    *sec = ts->tv_sec;
+    *nsec = ts->tv_nsec;
+}
+
+void bin_fill_record(bin_record_t *rec, unsigned int fields, const struct statx *stx)
+{
+    unsigned int valid = 0;
+
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        unsigned int field = field_names[i].field;
+        if ((fields & field) && field_available(i, stx)) {
+            valid |= field;
+        }
+    }
+
+    memset(rec, 0, sizeof(*rec));
+    rec->valid = valid;
+    if (valid & (FIELD_TYPE | FIELD_MODE)) {
+        rec->mode = stx->stx_mode;
+    }
+    if (valid & FIELD_SIZE)   rec->size = stx->stx_size;
+    if (valid & FIELD_BLOCKS) rec->blocks = stx->stx_blocks;
+    if (valid & FIELD_INO)    rec->ino = stx->stx_ino;
+    if (valid & FIELD_MNT_ID) rec->mnt_id = stx->stx_mnt_id;
+    if (valid & FIELD_NLINK)  rec->nlink = stx->stx_nlink;
+    if (valid & FIELD_UID)    rec->uid = stx->stx_uid;
+    if (valid & FIELD_GID)    rec->gid = stx->stx_gid;
+    if (valid & FIELD_ATTRS)  rec->attributes = stx->stx_attributes & stx->stx_attributes_mask;
+    if (valid & FIELD_ATIME)  set_time(&stx->stx_atime, &rec->atime_sec, &rec->atime_nsec);
+    if (valid & FIELD_MTIME)  set_time(&stx->stx_mtime, &rec->mtime_sec, &rec->mtime_nsec);
+    if (valid & FIELD_CTIME)  set_time(&stx->stx_ctime, &rec->ctime_sec, &rec->ctime_nsec);
+    if (valid & FIELD_BTIME)  set_time(&stx->stx_btime, &rec->btime_sec, &rec->btime_nsec);
+}
+
+static void get_time(int64_t sec, uint32_t nsec, struct statx_timestamp *ts)
+{
+    ts->tv_sec = sec;
+    ts->tv_nsec = nsec;
+}
+
+void bin_record_to_statx(const bin_record_t *rec, uint64_t attributes_mask, struct statx *stx)
+{
+    memset(stx, 0, sizeof(*stx));
+    stx->stx_mask = fields_to_statx_mask(rec->valid);
+    stx->stx_mode = (uint16_t)rec->mode;
+    stx->stx_size = rec->size;
+    stx->stx_blocks = rec->blocks;
+    stx->stx_ino = rec->ino;
+    stx->stx_mnt_id = rec->mnt_id;
+    stx->stx_nlink = rec->nlink;
+    stx->stx_uid = rec->uid;
+    stx->stx_gid = rec->gid;
+    stx->stx_attributes = rec->attributes;
+    stx->stx_attributes_mask = attributes_mask;
+    get_time(rec->atime_sec, rec->atime_nsec, &stx->stx_atime);
+    get_time(rec->mtime_sec, rec->mtime_nsec, &stx->stx_mtime);
+    get_time(rec->ctime_sec, rec->ctime_nsec, &stx->stx_ctime);
+    get_time(rec->btime_sec, rec->btime_nsec, &stx->stx_btime);
+}
+
+void bin_sink_add(bin_sink_t *sink, writer_t *out, const record_path_t *path,
+                  const struct statx *stx)
+{
+    bin_record_t record;
+    bin_record_t *rec = &record;
+    size_t sep = 0;
+
+    if (path->dir != NULL && (path->dir_len == 0 || path->dir[path->dir_len - 1] != '/')) {
+        sep = 1;
+    }
+
+    bin_fill_record(rec, sink->fields, stx);
+    rec->path_len = (uint32_t)(path->dir_len + sep + path->name_len);
+
+    /* Path vào blob chung: vị trí phải được lấy cùng lúc với lần ghi */
+    pthread_mutex_lock(&sink->lock);
+    rec->path_offset = sink->paths_size;
+    if (path->dir != NULL) {
+        fwrite(path->dir, 1, path->dir_len, sink->paths);
+        fwrite("/", 1, sep, sink->paths);
+    }
+    if (fwrite(path->name, 1, path->name_len, sink->paths) != path->name_len) {
+        sink->failed = true;
+    }
+    sink->paths_size += rec->path_len;
+    sink->records++;
+    pthread_mutex_unlock(&sink->lock);
+
+    writer_write(out, rec, sizeof(*rec));
+}
+
+int bin_sink_close(bin_sink_t *sink)
+{
+    bin_trailer_t trailer;
+    char *buffer;
+    size_t n;
+    int result = 0;
+
+    if (sink == NULL) {
+        return 0;
+    }
+
+    /* Path blob nằm ngay sau bản ghi cuối cùng */
+    buffer = malloc(BIN_COPY_SIZE);
+    if (buffer == NULL || fflush(sink->paths) != 0 || fseek(sink->paths, 0, SEEK_SET) != 0) {
+        sink->failed = true;
+    } else {
+        while ((n = fread(buffer, 1, BIN_COPY_SIZE, sink->paths)) > 0) {
+            writer_write(sink->out, buffer, n);
+        }
+        if (ferror(sink->paths)) {
+            sink->failed = true;
+        }
+    }
+    free(buffer);
+
+    memset(&trailer, 0, sizeof(trailer));
+    memcpy(trailer.magic, BIN_TRAILER_MAGIC, sizeof(trailer.magic));
+    trailer.record_count = sink->records;
+    trailer.paths_offset = sizeof(bin_header_t) + sink->records * sizeof(bin_record_t);
+    trailer.paths_size = sink->paths_size;
+    writer_write(sink->out, &trailer, sizeof(trailer));
+
+    if (sink->failed) {
+        fprintf(stderr, "Error: Cannot write the path table of the binary output\n");
+        result = -1;
+    }
+    fclose(sink->paths);
+    pthread_mutex_destroy(&sink->lock);
+    free(sink);
+    return result;
+}
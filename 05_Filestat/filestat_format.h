@@ -0,0 +1,200 @@
+/**
+ * @file filestat_format.h
+ * @brief Các định dạng output máy đọc được: JSON Lines, CSV, TSV, bin
+ *
+ * Mỗi file là một bản ghi gồm path và các trường được chọn bằng
+ * --fields (theo thứ tự cố định của FIELD_*). Số và thời gian được định
+ * dạng bằng tay thẳng vào buffer của writer_t, không qua printf() hay
+ * strftime(). Thời gian trong JSON/CSV/TSV là ISO 8601 UTC
+ * ("2026-01-20T15:30:45Z"); trường filesystem không trả về là null
+ * (JSON) hoặc rỗng (CSV/TSV).
+ *
+ * Path trong JSON: ký tự UTF-8 hợp lệ được giữ nguyên, ký tự điều khiển
+ * được escape, và mỗi byte không thuộc một ký tự UTF-8 hợp lệ (tên file
+ * Linux là byte tùy ý) được thay bằng "\ufffd" (U+FFFD). Output luôn là
+ * JSON hợp lệ, nhưng path có byte như vậy không khôi phục được từ JSON;
+ * CSV, TSV và bin giữ nguyên mọi byte.
+ *
+ * Định dạng bin dành cho công cụ mmap() file kết quả:
+ *
+ *   bin_header_t                 64 byte, ở offset 0
+ *   bin_record_t x record_count  128 byte mỗi bản ghi, từ offset 64
+ *   path blob                    các path nối liền, không có '\0'
+ *   bin_trailer_t                32 byte cuối file
+ *
+ * Trailer nằm ở cuối nên output có thể ghi một lượt qua pipe: đọc
+ * trailer trước để biết số bản ghi và vị trí path blob. Mọi số nguyên
+ * theo byte order của máy ghi (little-endian trên x86/ARM).
+ */
+
+#ifndef FILESTAT_FORMAT_H
+#define FILESTAT_FORMAT_H
+
+#include "filestat.h"
+
+/* ======================== CONSTANTS ======================== */
+#define BIN_MAGIC          "FSTB"   /* bin_header_t.magic */
+#define BIN_TRAILER_MAGIC  "FSTE"   /* bin_trailer_t.magic */
+#define BIN_VERSION        1
+
+/*
+ * Chỗ trống writer cần để một bản ghi không bị chia giữa hai lần flush:
+ * FORMAT_RECORD_MAX + FORMAT_ESCAPE_MAX * (độ dài path + 1)
+ */
+#define FORMAT_RECORD_MAX  1024
+#define FORMAT_ESCAPE_MAX  6      /* Một byte path escape dài nhất: "\u00XX", "\ufffd" */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Định dạng output (--format)
+ */
+typedef enum {
+    FORMAT_TEXT = 0,   /* Khung "FILE METADATA", hoặc một dòng mỗi entry với -r */
+    FORMAT_JSON,       /* JSON Lines: một object mỗi dòng */
+    FORMAT_CSV,        /* RFC 4180, có dòng tiêu đề */
+    FORMAT_TSV,        /* Tab-separated, có dòng tiêu đề, escape \t \n \\ */
+    FORMAT_BIN         /* Bản ghi nhị phân kích thước cố định */
+} output_format_t;
+
+/**
+ * @brief Path của một bản ghi: dir + "/" + name, hoặc chỉ name nếu dir == NULL
+ *
+ * Cho phép chế độ -r in path mà không phải ghép chuỗi cho mỗi entry.
+ */
+typedef struct {
+    const char *dir;
+    size_t dir_len;
+    const char *name;
+    size_t name_len;
+} record_path_t;
+
+/**
+ * @brief Header của file bin (64 byte)
+ */
+typedef struct {
+    char magic[4];           /* "FSTB" */
+    uint32_t version;        /* BIN_VERSION */
+    uint32_t header_size;    /* sizeof(bin_header_t) */
+    uint32_t record_size;    /* sizeof(bin_record_t) */
+    uint32_t fields;         /* FIELD_* đã yêu cầu */
+    uint8_t reserved[44];
+} bin_header_t;
+
+/**
+ * @brief Một bản ghi bin (128 byte)
+ *
+ * Trường không được yêu cầu hoặc filesystem không trả về bằng 0 và
+ * không có bit trong valid.
+ */
+typedef struct {
+    uint64_t path_offset;    /* Vị trí path trong path blob */
+    uint32_t path_len;
+    uint32_t valid;          /* FIELD_* có giá trị trong bản ghi này */
+    uint64_t size;
+    uint64_t blocks;
+    uint64_t ino;
+    uint64_t mnt_id;
+    uint64_t attributes;     /* STATX_ATTR_* (đã lọc theo attributes_mask) */
+    uint32_t mode;           /* Loại file và quyền, như st_mode */
+    uint32_t nlink;
+    uint32_t uid;
+    uint32_t gid;
+    int64_t atime_sec;
+    int64_t mtime_sec;
+    int64_t ctime_sec;
+    int64_t btime_sec;
+    uint32_t atime_nsec;
+    uint32_t mtime_nsec;
+    uint32_t ctime_nsec;
+    uint32_t btime_nsec;
+    uint64_t reserved;
+} bin_record_t;
+
+/**
+ * @brief Trailer của file bin (32 byte, luôn ở cuối file)
+ */
+typedef struct {
+    char magic[4];           /* "FSTE" */
+    uint32_t reserved;
+    uint64_t record_count;
+    uint64_t paths_offset;   /* Offset của path blob tính từ đầu file */
+    uint64_t paths_size;
+} bin_trailer_t;
+
+/* Bộ ghi bin (opaque), dùng chung được giữa các luồng */
+typedef struct bin_sink bin_sink_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Đọc tên định dạng ("text", "json", "csv", "tsv", "bin")
+ * @return 0 nếu hợp lệ, -1 nếu không
+ */
+int parse_format(const char *name, output_format_t *format);
+
+/**
+ * @brief Đọc danh sách trường ngăn cách bởi dấu phẩy, ví dụ "size,mtime,btime"
+ *
+ * Tên hợp lệ: type, size, mtime, mode, nlink, uid, gid, ino, blocks, atime,
+ * ctime, btime, mnt_id, attrs, và "all". Path luôn được in.
+ *
+ * @return 0 nếu hợp lệ, -1 nếu có tên lạ (đã báo trên stderr)
+ */
+int parse_fields(const char *list, unsigned int *fields);
+
+/**
+ * @brief Dòng tiêu đề của CSV/TSV (không in gì với các định dạng khác)
+ */
+void format_header(writer_t *out, output_format_t format, unsigned int fields);
+
+/**
+ * @brief Ghi một bản ghi JSON/CSV/TSV, hoặc dòng "-r" với FORMAT_TEXT
+ *
+ * Dòng FORMAT_TEXT: các trường cách nhau bởi dấu cách (loại là một ký tự
+ * như %y của find, thời gian là giây Unix, trường thiếu là "-"), path ở
+ * cuối. Không dùng cho FORMAT_BIN (xem bin_sink_add()).
+ */
+void format_record(writer_t *out, output_format_t format, unsigned int fields,
+                   const record_path_t *path, const struct statx *stx);
+
+/**
+ * @brief Bắt đầu output bin: ghi header vào out
+ *
+ * Từ chối ghi ra terminal.
+ *
+ * @return Bộ ghi mới, hoặc NULL nếu lỗi (đã báo trên stderr)
+ */
+bin_sink_t *bin_sink_open(writer_t *out, unsigned int fields);
+
+/**
+ * @brief Thêm một bản ghi
+ *
+ * Bản ghi được ghi vào out, path vào path blob chung. An toàn khi nhiều
+ * luồng gọi cùng lúc, mỗi luồng với writer riêng (cùng fd với writer đã
+ * truyền cho bin_sink_open(), header đã được flush).
+ */
+void bin_sink_add(bin_sink_t *sink, writer_t *out, const record_path_t *path,
+                  const struct statx *stx);
+
+/**
+ * @brief Nối path blob và trailer vào writer của bin_sink_open(), rồi giải phóng bộ ghi
+ * @return 0 nếu thành công, -1 nếu lỗi
+ */
+int bin_sink_close(bin_sink_t *sink);
+
+/**
+ * @brief Điền các trường metadata của một bản ghi (path_offset, path_len = 0)
+ * @param fields Các trường cần điền (FIELD_*); valid nhận các trường có giá trị
+ */
+void bin_fill_record(bin_record_t *rec, unsigned int fields, const struct statx *stx);
+
+/**
+ * @brief Dựng lại struct statx từ một bản ghi (ngược với bin_fill_record())
+ *
+ * stx_mask tương ứng với rec->valid; bản ghi chỉ giữ các thuộc tính đang
+ * bật nên attributes_mask (các thuộc tính filesystem hỗ trợ) được truyền riêng.
+ */
+void bin_record_to_statx(const bin_record_t *rec, uint64_t attributes_mask, struct statx *stx);
+
+#endif /* FILESTAT_FORMAT_H */
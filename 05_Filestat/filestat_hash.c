@@ -0,0 +1,406 @@
+/**
+ * @file filestat_hash.c
+ * @brief XXH3 64 bit: input ngắn, input trung bình và vòng lặp block SIMD
+ *
+ * Với input dài, 8 bộ tích lũy 64 bit được cập nhật mỗi stripe 64 byte
+ * bằng phép nhân 32x32->64 (vpmuludq), 8 stripe byte khóa dịch dần trên
+ * secret 192 byte; sau mỗi block 1024 byte các bộ tích lũy được xáo trộn.
+ * Bản AVX2 giữ 8 bộ tích lũy trong 2 thanh ghi 256 bit suốt vòng lặp.
+ */
+
+#include "filestat_hash.h"
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define XXH3_X86 1
+#endif
+
+/* ======================== CONSTANTS ======================== */
+#define PRIME32_1  0x9E3779B1U
+#define PRIME32_2  0x85EBCA77U
+#define PRIME32_3  0xC2B2AE3DU
+#define PRIME64_1  0x9E3779B185EBCA87ULL
+#define PRIME64_2  0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3  0x165667B19E3779F9ULL
+#define PRIME64_4  0x85EBCA77C2B2AE63ULL
+#define PRIME64_5  0x27D4EB2F165667C5ULL
+#define PRIME_MX1  0x165667919E3779F9ULL
+#define PRIME_MX2  0x9FB21C651E98DF25ULL
+
+#define SECRET_SIZE        192
+#define STRIPE_LEN         64
+#define STRIPES_PER_BLOCK  ((SECRET_SIZE - STRIPE_LEN) / 8)   /* 16 */
+#define MIDSIZE_LASTOFFSET 17
+#define LASTACC_START      7
+#define MERGEACCS_START    11
+
+/* Secret mặc định của XXH3 */
+static const uint8_t secret[SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/* ======================== PRIMITIVES ======================== */
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;   /* x86 và hầu hết ARM là little-endian như đặc tả */
+}
+
+static inline uint64_t read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t rotl64(uint64_t x, unsigned r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * @brief Tích 128 bit của a và b, gập lại: nửa thấp XOR nửa cao
+ */
+static inline uint64_t mul128_fold64(uint64_t a, uint64_t b)
+{
+    __extension__ typedef unsigned __int128 u128;
+    u128 product = (u128)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static uint64_t xxh64_avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t xxh3_avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t rrmxmx(uint64_t h, uint64_t len)
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= PRIME_MX2;
+    return h ^ (h >> 28);
+}
+
+static inline uint64_t mix16(const uint8_t *input, const uint8_t *key)
+{
+    return mul128_fold64(read64(input) ^ read64(key), read64(input + 8) ^ read64(key + 8));
+}
+
+/* ======================== SHORT INPUTS (0-240 byte) ======================== */
+
+static uint64_t hash_0to16(const uint8_t *input, size_t len)
+{
+    if (len > 8) {
+        uint64_t lo = read64(input) ^ (read64(secret + 24) ^ read64(secret + 32));
+        uint64_t hi = read64(input + len - 8) ^ (read64(secret + 40) ^ read64(secret + 48));
+        uint64_t acc = len + __builtin_bswap64(lo) + hi + mul128_fold64(lo, hi);
+        return xxh3_avalanche(acc);
+    }
+    if (len >= 4) {
+        uint64_t input64 = read32(input + len - 4) + ((uint64_t)read32(input) << 32);
+        return rrmxmx(input64 ^ (read64(secret + 8) ^ read64(secret + 16)), len);
+    }
+    if (len > 0) {
+        uint32_t combined = ((uint32_t)input[0] << 16) | ((uint32_t)input[len >> 1] << 24) |
+                            (uint32_t)input[len - 1] | ((uint32_t)len << 8);
+        return xxh64_avalanche(combined ^ (uint64_t)(read32(secret) ^ read32(secret + 4)));
+    }
+    return xxh64_avalanche(read64(secret + 56) ^ read64(secret + 64));
+}
+
+static uint64_t hash_17to128(const uint8_t *input, size_t len)
+{
+    uint64_t acc = len * PRIME64_1;
+
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += mix16(input + 48, secret + 96);
+                acc += mix16(input + len - 64, secret + 112);
+            }
+            acc += mix16(input + 32, secret + 64);
+            acc += mix16(input + len - 48, secret + 80);
+        }
+        acc += mix16(input + 16, secret + 32);
+        acc += mix16(input + len - 32, secret + 48);
+    }
+    acc += mix16(input, secret);
+    acc += mix16(input + len - 16, secret + 16);
+    return xxh3_avalanche(acc);
+}
+
+static uint64_t hash_129to240(const uint8_t *input, size_t len)
+{
+    uint64_t acc = len * PRIME64_1;
+    uint64_t acc_end;
+    size_t rounds = len / 16;
+
+    for (size_t i = 0; i < 8; i++) {
+        acc += mix16(input + 16 * i, secret + 16 * i);
+    }
+    acc_end = mix16(input + len - 16, secret + 136 - MIDSIZE_LASTOFFSET);
+    acc = xxh3_avalanche(acc);
+    for (size_t i = 8; i < rounds; i++) {
+        acc_end += mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+    }
+    return xxh3_avalanche(acc + acc_end);
+}
+
+/* ======================== LONG INPUTS: SCALAR ======================== */
+
+/**
+ * @brief Một stripe 64 byte vào 8 bộ tích lũy
+ */
+static inline void accumulate_scalar(uint64_t *acc, const uint8_t *input, const uint8_t *key)
+{
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t data = read64(input + 8 * i);
+        uint64_t data_key = data ^ read64(key + 8 * i);
+        acc[i ^ 1] += data;
+        acc[i] += (uint32_t)data_key * (data_key >> 32);
+    }
+}
+
+static inline void scramble_scalar(uint64_t *acc, const uint8_t *key)
+{
+    for (size_t i = 0; i < 8; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= read64(key + 8 * i);
+        acc[i] = a * PRIME32_1;
+    }
+}
+
+static void blocks_scalar(uint64_t *acc, const uint8_t *input, size_t blocks)
+{
+    for (size_t b = 0; b < blocks; b++, input += XXH3_BLOCK_LEN) {
+        for (size_t s = 0; s < STRIPES_PER_BLOCK; s++) {
+            accumulate_scalar(acc, input + s * STRIPE_LEN, secret + s * 8);
+        }
+        scramble_scalar(acc, secret + SECRET_SIZE - STRIPE_LEN);
+    }
+}
+
+static void stripes_scalar(uint64_t *acc, const uint8_t *input, size_t stripes,
+                           const uint8_t *key)
+{
+    for (size_t s = 0; s < stripes; s++) {
+        accumulate_scalar(acc, input + s * STRIPE_LEN, key + s * 8);
+    }
+}
+
+/* ======================== LONG INPUTS: SSE2 / AVX2 ======================== */
+
+#ifdef XXH3_X86
+
+__attribute__((target("sse2")))
+static inline void accumulate_sse2(__m128i *acc, const uint8_t *input, const uint8_t *key)
+{
+    for (size_t i = 0; i < 4; i++) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(const void *)(input + 16 * i));
+        __m128i data_key = _mm_xor_si128(data, _mm_loadu_si128((const __m128i *)(const void *)(key + 16 * i)));
+        __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i product = _mm_mul_epu32(data_key, data_key_hi);
+        __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+    }
+}
+
+__attribute__((target("sse2")))
+static inline void scramble_sse2(__m128i *acc, const uint8_t *key)
+{
+    const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+
+    for (size_t i = 0; i < 4; i++) {
+        __m128i a = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+        __m128i data_key = _mm_xor_si128(a, _mm_loadu_si128((const __m128i *)(const void *)(key + 16 * i)));
+        __m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m128i lo = _mm_mul_epu32(data_key, prime);
+        __m128i hi = _mm_mul_epu32(data_key_hi, prime);
+        acc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    }
+}
+
+__attribute__((target("sse2")))
+static void blocks_sse2(uint64_t *acc64, const uint8_t *input, size_t blocks)
+{
+    __m128i acc[4];
+
+    for (size_t i = 0; i < 4; i++) {
+        acc[i] = _mm_load_si128((const __m128i *)(const void *)(acc64 + 2 * i));
+    }
+    for (size_t b = 0; b < blocks; b++, input += XXH3_BLOCK_LEN) {
+        for (size_t s = 0; s < STRIPES_PER_BLOCK; s++) {
+            accumulate_sse2(acc, input + s * STRIPE_LEN, secret + s * 8);
+        }
+        scramble_sse2(acc, secret + SECRET_SIZE - STRIPE_LEN);
+    }
+    for (size_t i = 0; i < 4; i++) {
+        _mm_store_si128((__m128i *)(void *)(acc64 + 2 * i), acc[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+static inline void accumulate_avx2(__m256i *acc, const uint8_t *input, const uint8_t *key)
+{
+    for (size_t i = 0; i < 2; i++) {
+        __m256i data = _mm256_loadu_si256((const __m256i *)(const void *)(input + 32 * i));
+        __m256i data_key = _mm256_xor_si256(data, _mm256_loadu_si256((const __m256i *)(const void *)(key + 32 * i)));
+        __m256i data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m256i product = _mm256_mul_epu32(data_key, data_key_hi);
+        __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+        acc[i] = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, swapped));
+    }
+}
+
+__attribute__((target("avx2")))
+static inline void scramble_avx2(__m256i *acc, const uint8_t *key)
+{
+    const __m256i prime = _mm256_set1_epi32((int)PRIME32_1);
+
+    for (size_t i = 0; i < 2; i++) {
+        __m256i a = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+        __m256i data_key = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i *)(const void *)(key + 32 * i)));
+        __m256i data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+        __m256i lo = _mm256_mul_epu32(data_key, prime);
+        __m256i hi = _mm256_mul_epu32(data_key_hi, prime);
+        acc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+    }
+}
+
+__attribute__((target("avx2")))
+static void blocks_avx2(uint64_t *acc64, const uint8_t *input, size_t blocks)
+{
+    __m256i acc[2];
+
+    for (size_t i = 0; i < 2; i++) {
+        acc[i] = _mm256_load_si256((const __m256i *)(const void *)(acc64 + 4 * i));
+    }
+    for (size_t b = 0; b < blocks; b++, input += XXH3_BLOCK_LEN) {
+        for (size_t s = 0; s < STRIPES_PER_BLOCK; s++) {
+            accumulate_avx2(acc, input + s * STRIPE_LEN, secret + s * 8);
+        }
+        scramble_avx2(acc, secret + SECRET_SIZE - STRIPE_LEN);
+    }
+    for (size_t i = 0; i < 2; i++) {
+        _mm256_store_si256((__m256i *)(void *)(acc64 + 4 * i), acc[i]);
+    }
+}
+
+#endif /* XXH3_X86 */
+
+/* ======================== DISPATCH ======================== */
+
+typedef void (*blocks_fn)(uint64_t *acc, const uint8_t *input, size_t blocks);
+
+static blocks_fn hash_blocks = blocks_scalar;
+static const char *impl_name = "scalar";
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Chọn phiên bản nhanh nhất CPU hỗ trợ (một lần)
+ */
+static void select_impl(void)
+{
+#ifdef XXH3_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        hash_blocks = blocks_avx2;
+        impl_name = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        hash_blocks = blocks_sse2;
+        impl_name = "sse2";
+    }
+#endif
+}
+
+const char *xxh3_impl_name(void)
+{
+    pthread_once(&dispatch_once, select_impl);
+    return impl_name;
+}
+
+/* ======================== LONG INPUTS ======================== */
+
+void xxh3_stream_init(xxh3_stream_t *s, uint64_t len)
+{
+    static const uint64_t init[8] = {
+        PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1
+    };
+
+    pthread_once(&dispatch_once, select_impl);
+    memcpy(s->acc, init, sizeof(init));
+    s->len = len;
+}
+
+void xxh3_stream_blocks(xxh3_stream_t *s, const void *data, size_t len)
+{
+    hash_blocks(s->acc, data, len / XXH3_BLOCK_LEN);
+}
+
+uint64_t xxh3_stream_final(xxh3_stream_t *s, const void *tail, size_t tail_len)
+{
+    const uint8_t *end = (const uint8_t *)tail + tail_len;
+    size_t rest = (size_t)(s->len - xxh3_stream_body(s->len));   /* 1..1024 byte */
+    uint64_t result = s->len * PRIME64_1;
+
+    /* Block cuối chưa đầy (không xáo trộn), rồi 64 byte cuối với khóa riêng */
+    stripes_scalar(s->acc, end - rest, (rest - 1) / STRIPE_LEN, secret);
+    accumulate_scalar(s->acc, end - STRIPE_LEN, secret + SECRET_SIZE - STRIPE_LEN - LASTACC_START);
+
+    for (size_t i = 0; i < 4; i++) {
+        result += mul128_fold64(s->acc[2 * i] ^ read64(secret + MERGEACCS_START + 16 * i),
+                                s->acc[2 * i + 1] ^ read64(secret + MERGEACCS_START + 16 * i + 8));
+    }
+    return xxh3_avalanche(result);
+}
+
+uint64_t xxh3_64(const void *data, size_t len)
+{
+    const uint8_t *input = data;
+    xxh3_stream_t s;
+    uint64_t body;
+
+    if (len <= 16) {
+        return hash_0to16(input, len);
+    }
+    if (len <= 128) {
+        return hash_17to128(input, len);
+    }
+    if (len <= XXH3_MIDSIZE_MAX) {
+        return hash_129to240(input, len);
+    }
+    body = xxh3_stream_body(len);
+    xxh3_stream_init(&s, len);
+    xxh3_stream_blocks(&s, input, body);
+    return xxh3_stream_final(&s, input + len - xxh3_stream_tail(len), xxh3_stream_tail(len));
+}
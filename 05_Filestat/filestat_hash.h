@@ -0,0 +1,84 @@
+/**
+ * @file filestat_hash.h
+ * @brief XXH3 64 bit (seed 0) cho so sánh nội dung file (--dupes)
+ *
+ * Cài đặt theo đặc tả XXH3 của xxHash 0.8: cho cùng kết quả với
+ * XXH3_64bits() của thư viện gốc. Phần xử lý input dài (> 240 byte) có
+ * ba phiên bản: AVX2, SSE2 và C thuần, chọn một lần khi chạy theo CPU.
+ *
+ * File lớn không cần nằm trọn trong bộ nhớ: vì độ dài đã biết trước (từ
+ * statx()), thân file được băm theo từng đoạn đọc bằng pread() với
+ * xxh3_stream_blocks(), rồi phần cuối với xxh3_stream_final().
+ */
+
+#ifndef FILESTAT_HASH_H
+#define FILESTAT_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ======================== CONSTANTS ======================== */
+#define XXH3_BLOCK_LEN   1024   /* Một block: 16 stripe 64 byte, xáo trộn acc sau mỗi block */
+#define XXH3_MIDSIZE_MAX 240    /* Input dài hơn dùng vòng lặp block (SIMD) */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Trạng thái băm theo đoạn một input dài len byte (len > XXH3_MIDSIZE_MAX)
+ */
+typedef struct {
+    _Alignas(64) uint64_t acc[8];
+    uint64_t len;            /* Tổng độ dài, biết trước */
+} xxh3_stream_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief XXH3 64 bit của một vùng nhớ
+ */
+uint64_t xxh3_64(const void *data, size_t len);
+
+/**
+ * @brief Số byte đầu tiên của input dài len được đưa qua xxh3_stream_blocks()
+ *
+ * Là bội của XXH3_BLOCK_LEN; phần còn lại (1..1024 byte) thuộc về
+ * xxh3_stream_final().
+ */
+static inline uint64_t xxh3_stream_body(uint64_t len)
+{
+    return (len - 1) / XXH3_BLOCK_LEN * XXH3_BLOCK_LEN;
+}
+
+/**
+ * @brief Số byte cuối cần cho xxh3_stream_final(): phần sau thân và
+ *        64 byte trước đó (stripe cuối có thể bắt đầu trong thân)
+ */
+static inline uint64_t xxh3_stream_tail(uint64_t len)
+{
+    uint64_t body = xxh3_stream_body(len);
+    return body >= 64 ? len - body + 64 : len;
+}
+
+/**
+ * @brief Bắt đầu băm một input dài len byte (len > XXH3_MIDSIZE_MAX)
+ */
+void xxh3_stream_init(xxh3_stream_t *s, uint64_t len);
+
+/**
+ * @brief Băm các block tiếp theo của thân
+ * @param len Bội của XXH3_BLOCK_LEN; tổng mọi lần gọi = xxh3_stream_body()
+ */
+void xxh3_stream_blocks(xxh3_stream_t *s, const void *data, size_t len);
+
+/**
+ * @brief Kết thúc với xxh3_stream_tail() byte cuối của input
+ * @return Cùng giá trị với xxh3_64() của cả input
+ */
+uint64_t xxh3_stream_final(xxh3_stream_t *s, const void *tail, size_t tail_len);
+
+/**
+ * @brief Tên phiên bản đang dùng ("avx2", "sse2" hoặc "scalar")
+ */
+const char *xxh3_impl_name(void);
+
+#endif /* FILESTAT_HASH_H */
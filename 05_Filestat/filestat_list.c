@@ -0,0 +1,270 @@
+/**
+ * @file filestat_list.c
+ * @brief Chế độ nhiều path: đọc danh sách, statx() theo lô, in theo thứ tự
+ */
+
+#include "filestat_list.h"
+#include "filestat_pool.h"
+#include "filestat_serve.h"
+#include <errno.h>
+
+/* ======================== CONSTANTS ======================== */
+#define LIST_READ_SIZE   (256 * 1024)   /* Buffer đọc stdin ban đầu */
+#define LIST_ARENA_INIT  (64 * 1024)    /* Vùng chứa path của một lô */
+#define LIST_FROM_ARGV   SIZE_MAX       /* offsets[i]: path nằm trong argv */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Trạng thái của một lần chạy
+ *
+ * Path đọc từ stdin được copy vào arena; vì arena có thể được realloc
+ * khi lớn lên, chỉ vị trí (offset) được lưu cho tới lúc chạy lô.
+ */
+typedef struct {
+    const list_options_t *options;
+    writer_t *out;
+    stat_request_t requests[LIST_BATCH];
+    struct statx stx[LIST_BATCH];
+    size_t offsets[LIST_BATCH];
+    size_t count;
+    char *arena;
+    size_t arena_len;
+    size_t arena_cap;
+    unsigned int mask;            /* Mask statx() từ options->fields */
+    uring_t *ring;                /* IO_URING */
+    stat_pool_t *pool;            /* jobs > 1 */
+    serve_client_t *client;       /* --server */
+    bool failed;
+} list_state_t;
+
+/* ======================== BATCHES ======================== */
+
+/**
+ * @brief In một path đã statx() thành công theo định dạng đã chọn
+ */
+static void output_record(list_state_t *st, const stat_request_t *req)
+{
+    const list_options_t *options = st->options;
+    record_path_t path = { NULL, 0, req->path, strlen(req->path) };
+
+    switch (options->format) {
+        case FORMAT_TEXT:
+            print_file_info(st->out, req->path, req->stx, options->fields);
+            break;
+        case FORMAT_BIN:
+            bin_sink_add(options->bin, st->out, &path, req->stx);
+            break;
+        default:
+            format_record(st->out, options->format, options->fields, &path, req->stx);
+            break;
+    }
+}
+
+/**
+ * @brief statx() cả lô rồi in kết quả theo thứ tự input
+ */
+static void run_batch(list_state_t *st)
+{
+    for (size_t i = 0; i < st->count; i++) {
+        stat_request_t *req = &st->requests[i];
+
+        if (st->offsets[i] != LIST_FROM_ARGV) {
+            req->path = st->arena + st->offsets[i];
+        }
+        req->dirfd = AT_FDCWD;
+        req->flags = AT_SYMLINK_NOFOLLOW;
+        req->mask = st->mask;
+        req->stx = &st->stx[i];
+    }
+
+    if (st->client != NULL) {
+        serve_statx_batch(st->client, st->requests, st->count);
+    } else if (st->ring != NULL) {
+        uring_statx_batch(st->ring, st->requests, st->count);
+    } else if (st->pool != NULL) {
+        stat_pool_run(st->pool, st->requests, st->count);
+    } else {
+        sync_statx_batch(st->requests, st->count);
+    }
+
+    for (size_t i = 0; i < st->count; i++) {
+        const stat_request_t *req = &st->requests[i];
+
+        if (req->result < 0) {
+            /* Đẩy output trước đó ra để thông báo lỗi đứng đúng chỗ */
+            writer_flush(st->out);
+            fprintf(stderr, "Error: %s\n", strerror(-req->result));
+            fprintf(stderr, "Cannot get information for: %s\n", req->path);
+            st->failed = true;
+            continue;
+        }
+        output_record(st, req);
+    }
+
+    st->count = 0;
+    st->arena_len = 0;
+}
+
+/**
+ * @brief Thêm path từ argv (không copy)
+ */
+static void add_argv_path(list_state_t *st, const char *path)
+{
+    st->requests[st->count].path = path;
+    st->offsets[st->count] = LIST_FROM_ARGV;
+    if (++st->count == LIST_BATCH) {
+        run_batch(st);
+    }
+}
+
+/**
+ * @brief Thêm path đọc từ input (copy vào arena)
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int add_input_path(list_state_t *st, const char *path, size_t len)
+{
+    if (st->arena_len + len + 1 > st->arena_cap) {
+        size_t cap = st->arena_cap ? st->arena_cap : LIST_ARENA_INIT;
+        while (cap < st->arena_len + len + 1) {
+            cap *= 2;
+        }
+        char *arena = realloc(st->arena, cap);
+        if (arena == NULL) {
+            return -1;
+        }
+        st->arena = arena;
+        st->arena_cap = cap;
+    }
+    memcpy(st->arena + st->arena_len, path, len);
+    st->arena[st->arena_len + len] = '\0';
+    st->offsets[st->count] = st->arena_len;
+    st->arena_len += len + 1;
+
+    if (++st->count == LIST_BATCH) {
+        run_batch(st);
+    }
+    return 0;
+}
+
+/* ======================== INPUT ======================== */
+
+/**
+ * @brief Đọc danh sách path ngăn cách bởi delimiter cho tới EOF
+ *
+ * Dòng rỗng bị bỏ qua. Path cuối cùng không cần delimiter ở sau.
+ *
+ * @return 0 nếu thành công, -1 nếu lỗi đọc hoặc hết bộ nhớ
+ */
+static int read_input(list_state_t *st, int fd, char delimiter)
+{
+    size_t cap = LIST_READ_SIZE;
+    size_t len = 0;              /* Byte chưa xử lý ở đầu buffer */
+    char *buffer = malloc(cap);
+    int result = 0;
+
+    if (buffer == NULL) {
+        return -1;
+    }
+
+    for (;;) {
+        if (len == cap) {
+            /* Một path dài hơn cả buffer: nới buffer */
+            char *bigger = realloc(buffer, cap * 2);
+            if (bigger == NULL) {
+                result = -1;
+                break;
+            }
+            buffer = bigger;
+            cap *= 2;
+        }
+
+        ssize_t n = read(fd, buffer + len, cap - len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Error");
+            result = -1;
+            break;
+        }
+        if (n == 0) {
+            /* EOF: path cuối không có delimiter */
+            if (len > 0 && add_input_path(st, buffer, len) != 0) {
+                result = -1;
+            }
+            break;
+        }
+
+        /* Tách các path hoàn chỉnh trong phần vừa đọc */
+        char *start = buffer;
+        char *end = buffer + len + n;
+        char *sep;
+        while ((sep = memchr(start, delimiter, (size_t)(end - start))) != NULL) {
+            if (sep > start && add_input_path(st, start, (size_t)(sep - start)) != 0) {
+                result = -1;
+                break;
+            }
+            start = sep + 1;
+        }
+        if (result != 0) {
+            break;
+        }
+        len = (size_t)(end - start);
+        memmove(buffer, start, len);
+    }
+
+    free(buffer);
+    return result;
+}
+
+/* ======================== PUBLIC API ======================== */
+
+int list_paths(char *const *paths, size_t count, const list_options_t *options,
+               writer_t *out)
+{
+    list_state_t *st = calloc(1, sizeof(*st));
+    int result = 0;
+
+    if (st == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return -1;
+    }
+    st->options = options;
+    st->out = out;
+    st->mask = fields_to_statx_mask(options->fields);
+
+    if (options->server != NULL && (st->client = serve_connect(options->server)) == NULL) {
+        free(st);
+        return -1;
+    }
+    if (options->io == IO_URING) {
+        st->ring = uring_open(URING_DEPTH);
+        if (st->ring == NULL) {
+            fprintf(stderr, "Warning: io_uring unavailable (%s), using synchronous statx()\n",
+                    strerror(errno));
+        }
+    }
+    if (st->ring == NULL && options->jobs > 1) {
+        st->pool = stat_pool_create(options->jobs);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        add_argv_path(st, paths[i]);
+    }
+    if (options->input_fd >= 0 && read_input(st, options->input_fd, options->delimiter) != 0) {
+        fprintf(stderr, "Error: Cannot read the path list\n");
+        result = -1;
+    }
+    run_batch(st);
+
+    if (st->failed) {
+        result = -1;
+    }
+    serve_close(st->client);
+    uring_close(st->ring);
+    stat_pool_destroy(st->pool);
+    free(st->arena);
+    free(st);
+    return result;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file filestat_list.h
+ * @brief Kiểm tra nhiều path trong một tiến trình (nhiều tham số, --stdin, -0)
+ *
+ * Các path được xử lý theo lô LIST_BATCH path: cả lô được statx() (tuần
+ * tự, song song với --jobs, qua io_uring, hoặc hỏi daemon --serve qua
+ * --server) rồi in theo đúng thứ tự
+ * input vào một writer_t duy nhất. Path từ stdin được đọc dần từng lô,
+ * nên bộ nhớ không phụ thuộc độ dài danh sách.
+ */
+
+#ifndef FILESTAT_LIST_H
+#define FILESTAT_LIST_H
+
+#include "filestat.h"
+#include "filestat_format.h"
+#include <stdbool.h>
+
+/* ======================== CONSTANTS ======================== */
+#define LIST_BATCH 4096   /* Số path mỗi lô */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Tùy chọn cho chế độ nhiều path
+ */
+typedef struct {
+    output_format_t format;  /* Định dạng output (--format) */
+    unsigned int fields;     /* Các trường cần in (FIELD_*) */
+    unsigned int jobs;       /* Số luồng statx(), 0 hoặc 1 = tuần tự */
+    io_mode_t io;            /* IO_URING: bỏ qua jobs, dùng một ring */
+    int input_fd;            /* Đọc thêm path từ fd này, -1 = không */
+    char delimiter;          /* '\n' hoặc '\0' (-0) */
+    bin_sink_t *bin;         /* FORMAT_BIN: bộ ghi đã mở trên out */
+    const char *server;      /* Socket của daemon (--server), NULL = statx() */
+} list_options_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief In metadata của các path trong argv rồi các path đọc từ input_fd
+ *
+ * Path không đọc được được báo trên stderr và bỏ qua; các path còn lại
+ * vẫn được xử lý. Dòng tiêu đề CSV/TSV và header bin do người gọi ghi.
+ *
+ * @param paths Các path từ dòng lệnh
+ * @param count Số path trong paths
+ * @param options Tùy chọn
+ * @param out Writer nhận output
+ * @return 0 nếu mọi path đều đọc được, -1 nếu có lỗi
+ */
+int list_paths(char *const *paths, size_t count, const list_options_t *options,
+               writer_t *out);
+
+#endif /* FILESTAT_LIST_H */
@@ -0,0 +1,147 @@
+/**
+ * @file filestat_output.c
+ * @brief Writer có buffer lớn cho stdout
+ *
+ * Toàn bộ output được ghép trong một buffer (mặc định 1 MB) và ghi ra
+ * bằng write() khi đầy, nên kiểm tra 100k file tốn khoảng vài chục lần
+ * write() thay vì hàng trăm nghìn lần printf().
+ */
+
+#include "filestat.h"
+#include <errno.h>
+#include <stdarg.h>
+
+/* ======================== LIFECYCLE ======================== */
+
+int writer_init(writer_t *w, int fd, size_t cap)
+{
+    w->fd = fd;
+    w->len = 0;
+    w->cap = cap;
+    w->error = 0;
+    w->lock = NULL;
+    w->data = malloc(cap);
+    return w->data != NULL ? 0 : -1;
+}
+
+int writer_close(writer_t *w)
+{
+    int result = writer_flush(w);
+
+    free(w->data);
+    w->data = NULL;
+    w->cap = 0;
+    return result;
+}
+
+/* ======================== WRITING ======================== */
+
+/**
+ * @brief Ghi trọn một vùng nhớ, xử lý ghi thiếu và EINTR
+ */
+static void write_fd(writer_t *w, const char *data, size_t len)
+{
+    while (len > 0 && w->error == 0) {
+        ssize_t n = write(w->fd, data, len);
+        if (n < 0) {
+            if (errno != EINTR) {
+                w->error = errno;
+            }
+            continue;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+}
+
+/**
+ * @brief Ghi thẳng ra fd, giữ w->lock nếu có
+ */
+static void write_direct(writer_t *w, const char *data, size_t len)
+{
+    if (w->lock != NULL) {
+        pthread_mutex_lock(w->lock);
+    }
+    write_fd(w, data, len);
+    if (w->lock != NULL) {
+        pthread_mutex_unlock(w->lock);
+    }
+}
+
+int writer_flush(writer_t *w)
+{
+    if (w->len > 0) {
+        write_direct(w, w->data, w->len);
+    }
+    w->len = 0;
+    return w->error == 0 ? 0 : -1;
+}
+
+void writer_write(writer_t *w, const void *data, size_t len)
+{
+    if (w->len + len > w->cap) {
+        writer_flush(w);
+        if (len > w->cap) {
+            /* Lớn hơn cả buffer: ghi thẳng, không copy */
+            write_direct(w, data, len);
+            return;
+        }
+    }
+    memcpy(w->data + w->len, data, len);
+    w->len += len;
+}
+
+char *writer_reserve(writer_t *w, size_t len)
+{
+    if (w->len + len > w->cap) {
+        writer_flush(w);
+    }
+    return w->data + w->len;
+}
+
+void writer_commit(writer_t *w, const char *end)
+{
+    w->len = (size_t)(end - w->data);
+}
+
+void writer_puts(writer_t *w, const char *text)
+{
+    writer_write(w, text, strlen(text));
+}
+
+void writer_printf(writer_t *w, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    /* Thử định dạng thẳng vào chỗ trống của buffer */
+    va_start(args, format);
+    n = vsnprintf(w->data + w->len, w->cap - w->len, format, args);
+    va_end(args);
+    if (n < 0) {
+        return;
+    }
+    if ((size_t)n < w->cap - w->len) {
+        w->len += (size_t)n;
+        return;
+    }
+
+    /* Không đủ chỗ: flush rồi định dạng lại (vào buffer tạm nếu quá lớn) */
+    writer_flush(w);
+    if ((size_t)n < w->cap) {
+        va_start(args, format);
+        vsnprintf(w->data, w->cap, format, args);
+        va_end(args);
+        w->len = (size_t)n;
+        return;
+    }
+
+    char *tmp = malloc((size_t)n + 1);
+    if (tmp != NULL) {
+        va_start(args, format);
+        vsnprintf(tmp, (size_t)n + 1, format, args);
+        va_end(args);
+        write_direct(w, tmp, (size_t)n);
+        free(tmp);
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * @file filestat_pool.c
+ * @brief Thread pool statx() dùng lại giữa các lô
+ */
+
+#include "filestat_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+/* ======================== CONSTANTS ======================== */
+#define POOL_STEP 16   /* Số yêu cầu một luồng lấy mỗi lần */
+
+/* ======================== TYPES ======================== */
+
+struct stat_pool {
+    pthread_t *threads;          /* Các luồng phụ (threads - 1) */
+    unsigned int num_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t start;        /* Báo có lô mới (hoặc dừng) */
+    pthread_cond_t done;         /* Báo luồng phụ cuối cùng đã xong lô */
+    stat_request_t *requests;    /* Lô hiện tại */
+    size_t count;
+    atomic_size_t next;          /* Yêu cầu tiếp theo chưa ai lấy */
+    unsigned int active;         /* Luồng phụ còn đang làm lô hiện tại */
+    unsigned long generation;    /* Tăng mỗi lô, để luồng phụ biết có việc mới */
+    bool stop;
+};
+
+/* ======================== WORKERS ======================== */
+
+/**
+ * @brief Lấy và thực hiện các nhóm yêu cầu tới khi lô hết
+ */
+static void run_share(stat_pool_t *pool)
+{
+    size_t begin;
+
+    while ((begin = atomic_fetch_add(&pool->next, POOL_STEP)) < pool->count) {
+        size_t end = begin + POOL_STEP < pool->count ? begin + POOL_STEP : pool->count;
+        sync_statx_batch(pool->requests + begin, end - begin);
+    }
+}
+
+static void *pool_thread(void *arg)
+{
+    stat_pool_t *pool = arg;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stop) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stop) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_share(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/* ======================== PUBLIC API ======================== */
+
+stat_pool_t *stat_pool_create(unsigned int threads)
+{
+    stat_pool_t *pool = calloc(1, sizeof(*pool));
+
+    if (pool == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    atomic_init(&pool->next, 0);
+
+    if (threads > 1) {
+        pool->threads = malloc((threads - 1) * sizeof(*pool->threads));
+        if (pool->threads == NULL) {
+            stat_pool_destroy(pool);
+            return NULL;
+        }
+        for (unsigned int i = 0; i < threads - 1; i++) {
+            if (pthread_create(&pool->threads[i], NULL, pool_thread, pool) != 0) {
+                break;
+            }
+            pool->num_threads++;
+        }
+    }
+    return pool;
+}
+
+void stat_pool_run(stat_pool_t *pool, stat_request_t *requests, size_t count)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->requests = requests;
+    pool->count = count;
+    atomic_store(&pool->next, 0);
+    pool->active = pool->num_threads;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    /* Luồng gọi cũng làm phần của mình */
+    run_share(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void stat_pool_destroy(stat_pool_t *pool)
+{
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    free(pool->threads);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool);
+}
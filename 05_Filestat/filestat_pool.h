@@ -0,0 +1,36 @@
+/**
+ * @file filestat_pool.h
+ * @brief Thread pool thực hiện một lô statx() song song (--jobs N)
+ *
+ * Các luồng phụ được tạo một lần và dùng lại cho mọi lô. Mỗi lô được
+ * chia theo từng nhóm nhỏ yêu cầu lấy bằng một bộ đếm atomic; luồng gọi
+ * cũng tham gia xử lý. Kết quả nằm trong mảng yêu cầu, nên thứ tự của
+ * input được giữ nguyên bất kể luồng nào xong trước.
+ */
+
+#ifndef FILESTAT_POOL_H
+#define FILESTAT_POOL_H
+
+#include "filestat_uring.h"
+
+/* Thread pool (opaque) */
+typedef struct stat_pool stat_pool_t;
+
+/**
+ * @brief Tạo pool
+ * @param threads Tổng số luồng xử lý, kể cả luồng gọi (>= 1)
+ * @return Pool mới, hoặc NULL nếu không tạo được
+ */
+stat_pool_t *stat_pool_create(unsigned int threads);
+
+/**
+ * @brief Thực hiện cả lô và chờ tới khi mọi yêu cầu xong
+ */
+void stat_pool_run(stat_pool_t *pool, stat_request_t *requests, size_t count);
+
+/**
+ * @brief Dừng các luồng và giải phóng pool (NULL được chấp nhận)
+ */
+void stat_pool_destroy(stat_pool_t *pool);
+
+#endif /* FILESTAT_POOL_H */
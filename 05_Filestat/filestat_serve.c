@@ -0,0 +1,746 @@
+/**
+ * @file filestat_serve.c
+ * @brief Daemon metadata trên Unix socket và client theo lô
+ */
+
+#include "filestat_serve.h"
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/* ======================== CONSTANTS ======================== */
+#define SERVE_IN_SIZE    (64 * 1024)   /* Buffer đọc mỗi client (> một câu hỏi dài nhất) */
+#define SERVE_BACKLOG    64
+#define SERVE_EVENTS     64
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Một client đang kết nối
+ */
+typedef struct {
+    int fd;
+    bool greeted;            /* Đã nhận serve_hello_t */
+    bool reading;            /* Đang chờ EPOLLIN (false khi bị back-pressure) */
+    bool writing;            /* Đang chờ EPOLLOUT */
+    char in[SERVE_IN_SIZE];
+    size_t in_len;
+    char *out;
+    size_t out_len;
+    size_t out_sent;
+    size_t out_cap;
+} conn_t;
+
+typedef struct {
+    meta_cache_t *cache;
+    int epoll_fd;
+    int listen_fd;
+    int signal_fd;
+    conn_t **conns;          /* Theo fd */
+    size_t conns_cap;
+} server_t;
+
+struct serve_client {
+    int fd;
+    char cwd[PATH_MAX];
+    size_t cwd_len;          /* 0 nếu thư mục hiện tại là "/" */
+    char *send;
+    size_t send_cap;
+    int slots[SERVE_PIPELINE];           /* Yêu cầu ứng với mỗi câu hỏi đã gửi */
+    meta_value_t replies[SERVE_PIPELINE];
+};
+
+/* ======================== I/O HELPERS ======================== */
+
+/**
+ * @brief Ghi đủ len byte (fd blocking)
+ * @return 0 nếu thành công, -1 nếu lỗi
+ */
+static int write_all(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Đọc đủ len byte (fd blocking)
+ * @return 0 nếu thành công, -1 nếu lỗi hoặc kết nối đóng
+ */
+static int read_all(int fd, void *data, size_t len)
+{
+    char *p = data;
+
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (n == 0) {
+            errno = ECONNRESET;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int make_address(const char *socket_path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Error: Socket path too long (max %zu bytes): %s\n",
+                sizeof(addr->sun_path) - 1, socket_path);
+        return -1;
+    }
+    strcpy(addr->sun_path, socket_path);
+    return 0;
+}
+
+/* ======================== SERVER: CONNECTIONS ======================== */
+
+/**
+ * @brief Thêm byte vào output của client
+ * @return 0 nếu thành công, -1 nếu hết bộ nhớ
+ */
+static int conn_append(conn_t *conn, const void *data, size_t len)
+{
+    if (conn->out_len + len > conn->out_cap) {
+        size_t cap = conn->out_cap ? conn->out_cap : 64 * 1024;
+        while (cap < conn->out_len + len) {
+            cap *= 2;
+        }
+        char *out = realloc(conn->out, cap);
+        if (out == NULL) {
+            return -1;
+        }
+        conn->out = out;
+        conn->out_cap = cap;
+    }
+    memcpy(conn->out + conn->out_len, data, len);
+    conn->out_len += len;
+    return 0;
+}
+
+static size_t conn_pending(const conn_t *conn)
+{
+    return conn->out_len - conn->out_sent;
+}
+
+static void conn_close(server_t *server, conn_t *conn)
+{
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    server->conns[conn->fd] = NULL;
+    free(conn->out);
+    free(conn);
+}
+
+/**
+ * @brief Trả lời mọi câu hỏi hoàn chỉnh trong buffer đọc
+ *
+ * Dừng sớm khi output chờ gửi vượt SERVE_OUT_MAX.
+ *
+ * @return Số câu hỏi đã trả lời, hoặc -1 nếu vi phạm protocol hoặc hết bộ nhớ
+ */
+static int conn_answer(server_t *server, conn_t *conn)
+{
+    size_t pos = 0;
+    int result = 0;
+
+    if (!conn->greeted) {
+        serve_hello_t hello;
+        if (conn->in_len < sizeof(hello)) {
+            return 0;
+        }
+        memcpy(&hello, conn->in, sizeof(hello));
+        if (memcmp(hello.magic, SERVE_MAGIC, 4) != 0 || hello.version != SERVE_VERSION) {
+            return -1;
+        }
+        memcpy(hello.magic, SERVE_MAGIC, 4);
+        hello.version = SERVE_VERSION;
+        if (conn_append(conn, &hello, sizeof(hello)) != 0) {
+            return -1;
+        }
+        conn->greeted = true;
+        pos = sizeof(hello);
+    }
+
+    while (conn->in_len - pos >= sizeof(uint32_t) && conn_pending(conn) <= SERVE_OUT_MAX) {
+        meta_value_t value;
+        uint32_t len;
+
+        memcpy(&len, conn->in + pos, sizeof(len));
+        if (len >= PATH_MAX) {
+            result = -1;
+            break;
+        }
+        if (conn->in_len - pos - sizeof(len) < len) {
+            break;
+        }
+        meta_cache_lookup(server->cache, conn->in + pos + sizeof(len), len, &value);
+        if (conn_append(conn, &value, sizeof(value)) != 0) {
+            result = -1;
+            break;
+        }
+        pos += sizeof(len) + len;
+        result++;
+    }
+
+    memmove(conn->in, conn->in + pos, conn->in_len - pos);
+    conn->in_len -= pos;
+    return result;
+}
+
+/**
+ * @brief Gửi output đang chờ cho tới khi socket đầy
+ * @return 0 nếu thành công, -1 nếu client đã đóng
+ */
+static int conn_send(conn_t *conn)
+{
+    while (conn_pending(conn) > 0) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_sent, conn_pending(conn),
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        }
+        conn->out_sent += (size_t)n;
+    }
+    conn->out_len = 0;
+    conn->out_sent = 0;
+    return 0;
+}
+
+/**
+ * @brief Trả lời, gửi, rồi chọn sự kiện epoll cần chờ tiếp
+ * @return 0 nếu thành công, -1 nếu phải đóng client
+ */
+static int conn_pump(server_t *server, conn_t *conn)
+{
+    struct epoll_event ev;
+    bool reading;
+    bool writing;
+    int answered;
+
+    do {
+        if ((answered = conn_answer(server, conn)) < 0 || conn_send(conn) != 0) {
+            return -1;
+        }
+        /* Đã gửi hết sau back-pressure: còn câu hỏi trong buffer thì trả lời tiếp */
+    } while (answered > 0 && conn_pending(conn) == 0 && conn->in_len > 0);
+
+    reading = conn_pending(conn) <= SERVE_OUT_MAX;
+    writing = conn_pending(conn) > 0;
+    if (reading != conn->reading || writing != conn->writing) {
+        ev.events = (reading ? EPOLLIN : 0) | (writing ? EPOLLOUT : 0);
+        ev.data.fd = conn->fd;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev) != 0) {
+            return -1;
+        }
+        conn->reading = reading;
+        conn->writing = writing;
+    }
+    return 0;
+}
+
+/**
+ * @brief Đọc một lần từ client rồi trả lời
+ * @return 0 nếu thành công, -1 nếu phải đóng client
+ */
+static int conn_read(server_t *server, conn_t *conn)
+{
+    ssize_t n;
+
+    if (!conn->reading || conn->in_len == sizeof(conn->in)) {
+        /* Back-pressure: chờ gửi bớt trước khi đọc thêm */
+        return conn_pump(server, conn);
+    }
+    do {
+        n = read(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        return errno == EAGAIN ? 0 : -1;
+    }
+    if (n == 0) {
+        return -1;
+    }
+    conn->in_len += (size_t)n;
+
+    /* Thay đổi đã xong trước câu hỏi này phải được thấy trong câu trả lời */
+    if (meta_cache_process_events(server->cache) != 0) {
+        fprintf(stderr, "Error: Cannot read inotify events: %s\n", strerror(errno));
+    }
+    return conn_pump(server, conn);
+}
+
+/**
+ * @brief Nhận mọi kết nối đang chờ
+ */
+static void accept_clients(server_t *server)
+{
+    for (;;) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        struct epoll_event ev;
+        conn_t *conn;
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fprintf(stderr, "Error: accept: %s\n", strerror(errno));
+            }
+            return;
+        }
+        if ((size_t)fd >= server->conns_cap) {
+            size_t cap = server->conns_cap ? server->conns_cap : 64;
+            while (cap <= (size_t)fd) {
+                cap *= 2;
+            }
+            conn_t **conns = realloc(server->conns, cap * sizeof(*conns));
+            if (conns == NULL) {
+                close(fd);
+                continue;
+            }
+            memset(conns + server->conns_cap, 0, (cap - server->conns_cap) * sizeof(*conns));
+            server->conns = conns;
+            server->conns_cap = cap;
+        }
+        conn = calloc(1, sizeof(*conn));
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->reading = true;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            free(conn);
+            close(fd);
+            continue;
+        }
+        server->conns[fd] = conn;
+    }
+}
+
+/* ======================== SERVER: SETUP ======================== */
+
+/**
+ * @brief Tạo socket nghe; thay socket cũ nếu không còn daemon nào nghe trên đó
+ * @return fd, hoặc -1 nếu lỗi (đã báo trên stderr)
+ */
+static int open_listener(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    mode_t old_umask;
+    int fd;
+
+    if (make_address(socket_path, &addr) != 0) {
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+        return -1;
+    }
+    if (connect(fd, (const struct sockaddr *)&addr, sizeof(addr)) == 0 || errno == EAGAIN) {
+        fprintf(stderr, "Error: Another server is listening on %s\n", socket_path);
+        close(fd);
+        return -1;
+    }
+    if (errno == ECONNREFUSED) {
+        /* Socket của một daemon đã chết */
+        unlink(socket_path);
+    }
+    close(fd);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Error: socket: %s\n", strerror(errno));
+        return -1;
+    }
+    /* Chỉ chủ sở hữu được hỏi: câu trả lời theo quyền của daemon */
+    old_umask = umask(077);
+    if (bind(fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Error: Cannot bind %s: %s\n", socket_path, strerror(errno));
+        umask(old_umask);
+        close(fd);
+        return -1;
+    }
+    umask(old_umask);
+    if (listen(fd, SERVE_BACKLOG) != 0) {
+        fprintf(stderr, "Error: listen: %s\n", strerror(errno));
+        unlink(socket_path);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int epoll_add(int epoll_fd, int fd)
+{
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+/**
+ * @brief Đọc một tín hiệu từ signalfd
+ * @return true nếu phải dừng
+ */
+static bool handle_signal(server_t *server)
+{
+    struct signalfd_siginfo info;
+    meta_cache_stats_t stats;
+
+    if (read(server->signal_fd, &info, sizeof(info)) != (ssize_t)sizeof(info)) {
+        return false;
+    }
+    if (info.ssi_signo == SIGUSR1) {
+        meta_cache_get_stats(server->cache, &stats);
+        print_cache_stats(stderr, &stats);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Đọc fs.inotify.max_user_watches
+ * @return Giới hạn, hoặc 0 nếu không đọc được
+ */
+static unsigned long max_user_watches(void)
+{
+    FILE *file = fopen("/proc/sys/fs/inotify/max_user_watches", "r");
+    unsigned long limit = 0;
+
+    if (file != NULL) {
+        if (fscanf(file, "%lu", &limit) != 1) {
+            limit = 0;
+        }
+        fclose(file);
+    }
+    return limit;
+}
+
+/* ======================== SERVER: PUBLIC API ======================== */
+
+int serve_run(const char *socket_path, size_t cache_size)
+{
+    server_t server = { NULL, -1, -1, -1, NULL, 0 };
+    struct epoll_event events[SERVE_EVENTS];
+    meta_cache_stats_t stats;
+    sigset_t signals;
+    unsigned long watch_limit;
+    int result = -1;
+    bool running = true;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGUSR1);
+
+    server.cache = meta_cache_create(cache_size);
+    if (server.cache == NULL) {
+        fprintf(stderr, "Error: Cannot create the cache: %s\n", strerror(errno));
+        return -1;
+    }
+    if ((server.listen_fd = open_listener(socket_path)) < 0) {
+        goto out;
+    }
+    if (sigprocmask(SIG_BLOCK, &signals, NULL) != 0 ||
+        (server.signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC)) < 0 ||
+        (server.epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0 ||
+        epoll_add(server.epoll_fd, server.listen_fd) != 0 ||
+        epoll_add(server.epoll_fd, server.signal_fd) != 0 ||
+        epoll_add(server.epoll_fd, meta_cache_fd(server.cache)) != 0) {
+        fprintf(stderr, "Error: Cannot set up the event loop: %s\n", strerror(errno));
+        goto out;
+    }
+    /* Không giữ thư mục hiện tại (để umount được); client luôn gửi path tuyệt đối */
+    if (chdir("/") != 0) {
+        fprintf(stderr, "Error: chdir(/): %s\n", strerror(errno));
+        goto out;
+    }
+    fprintf(stderr, "Serving metadata on %s (cache: %zu entries)\n", socket_path, cache_size);
+    /* Mỗi entry cần khoảng một watch; hết watch thì path được trả lời không qua cache */
+    watch_limit = max_user_watches();
+    if (watch_limit != 0 && cache_size > watch_limit) {
+        fprintf(stderr, "Warning: fs.inotify.max_user_watches is %lu: paths beyond about "
+                "that many are answered without the cache\n", watch_limit);
+    }
+
+    while (running) {
+        int n = epoll_wait(server.epoll_fd, events, SERVE_EVENTS, -1);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: epoll_wait: %s\n", strerror(errno));
+            goto out;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == server.signal_fd) {
+                running = !handle_signal(&server);
+            } else if (fd == server.listen_fd) {
+                accept_clients(&server);
+            } else if (fd == meta_cache_fd(server.cache)) {
+                if (meta_cache_process_events(server.cache) != 0) {
+                    fprintf(stderr, "Error: Cannot read inotify events: %s\n", strerror(errno));
+                }
+            } else if ((size_t)fd < server.conns_cap && server.conns[fd] != NULL) {
+                conn_t *conn = server.conns[fd];
+                int status = 0;
+
+                if (events[i].events & EPOLLOUT) {
+                    status = conn_pump(&server, conn);
+                }
+                if (status == 0 && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+                    status = conn_read(&server, conn);
+                }
+                if (status != 0) {
+                    conn_close(&server, conn);
+                }
+            }
+        }
+    }
+    result = 0;
+
+out:
+    for (size_t i = 0; i < server.conns_cap; i++) {
+        if (server.conns[i] != NULL) {
+            conn_close(&server, server.conns[i]);
+        }
+    }
+    free(server.conns);
+    if (server.listen_fd >= 0) {
+        close(server.listen_fd);
+        unlink(socket_path);
+    }
+    if (server.signal_fd >= 0) {
+        close(server.signal_fd);
+    }
+    if (server.epoll_fd >= 0) {
+        close(server.epoll_fd);
+    }
+    meta_cache_get_stats(server.cache, &stats);
+    print_cache_stats(stderr, &stats);
+    meta_cache_destroy(server.cache);
+    return result;
+}
+
+/* ======================== CLIENT ======================== */
+
+serve_client_t *serve_connect(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    serve_hello_t hello;
+    serve_client_t *client;
+
+    if (make_address(socket_path, &addr) != 0) {
+        return NULL;
+    }
+    client = calloc(1, sizeof(*client));
+    if (client == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return NULL;
+    }
+    if (getcwd(client->cwd, sizeof(client->cwd)) == NULL) {
+        fprintf(stderr, "Error: Cannot get the current directory: %s\n", strerror(errno));
+        free(client);
+        return NULL;
+    }
+    client->cwd_len = strcmp(client->cwd, "/") == 0 ? 0 : strlen(client->cwd);
+
+    client->fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (client->fd < 0 || connect(client->fd, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Error: Cannot connect to %s: %s\n", socket_path, strerror(errno));
+        serve_close(client);
+        return NULL;
+    }
+    memcpy(hello.magic, SERVE_MAGIC, 4);
+    hello.version = SERVE_VERSION;
+    if (write_all(client->fd, &hello, sizeof(hello)) != 0 ||
+        read_all(client->fd, &hello, sizeof(hello)) != 0 ||
+        memcmp(hello.magic, SERVE_MAGIC, 4) != 0 || hello.version != SERVE_VERSION) {
+        fprintf(stderr, "Error: %s is not a filestat server (version %d)\n",
+                socket_path, SERVE_VERSION);
+        serve_close(client);
+        return NULL;
+    }
+    return client;
+}
+
+void serve_close(serve_client_t *client)
+{
+    if (client == NULL) {
+        return;
+    }
+    if (client->fd >= 0) {
+        close(client->fd);
+    }
+    free(client->send);
+    free(client);
+}
+
+/**
+ * @brief Path tuyệt đối gửi cho daemon
+ *
+ * Bỏ "/" thừa và thành phần "." (trừ "." cuối cùng, vì "link/." đi theo
+ * symlink), nên "./a//b" từ find trở thành "<cwd>/a/b" và được cache.
+ * ".." được giữ nguyên: gộp nó theo chữ sai khi đi qua symlink.
+ *
+ * @param out Buffer PATH_MAX byte
+ * @return Độ dài, hoặc 0 nếu dài quá PATH_MAX
+ */
+static size_t absolute_path(const serve_client_t *client, const char *path, char *out)
+{
+    size_t len = 0;
+    const char *p = path;
+
+    if (*p != '/') {
+        memcpy(out, client->cwd, client->cwd_len);
+        len = client->cwd_len;
+    }
+    for (;;) {
+        const char *end;
+        const char *next;
+        size_t n;
+
+        while (*p == '/') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        end = strchr(p, '/');
+        if (end == NULL) {
+            end = p + strlen(p);
+        }
+        n = (size_t)(end - p);
+        for (next = end; *next == '/'; next++) {
+        }
+        if (n == 1 && *p == '.' && *next != '\0') {
+            p = end;
+            continue;
+        }
+        if (len + 1 + n >= PATH_MAX) {
+            return 0;
+        }
+        out[len++] = '/';
+        memcpy(out + len, p, n);
+        len += n;
+        p = end;
+    }
+    if (len == 0) {
+        out[len++] = '/';
+    } else if (p > path && p[-1] == '/') {
+        /* "dir/" đòi dir là thư mục (và đi theo symlink): giữ nguyên ý nghĩa */
+        if (len + 1 >= PATH_MAX) {
+            return 0;
+        }
+        out[len++] = '/';
+    }
+    return len;
+}
+
+/**
+ * @brief Gửi tối đa SERVE_PIPELINE yêu cầu rồi đọc trả lời của chúng
+ * @return 0 nếu thành công, -1 nếu mất kết nối
+ */
+static int ask_chunk(serve_client_t *client, stat_request_t *requests, size_t count)
+{
+    size_t need = count * (sizeof(uint32_t) + PATH_MAX);
+    size_t len = 0;
+    size_t asked = 0;
+
+    if (need > client->send_cap) {
+        char *send = realloc(client->send, need);
+        if (send == NULL) {
+            errno = ENOMEM;
+            return -1;
+        }
+        client->send = send;
+        client->send_cap = need;
+    }
+    for (size_t i = 0; i < count; i++) {
+        char *path = client->send + len + sizeof(uint32_t);
+        uint32_t path_len = (uint32_t)absolute_path(client, requests[i].path, path);
+
+        if (path_len == 0) {
+            requests[i].result = -ENAMETOOLONG;
+            continue;
+        }
+        memcpy(client->send + len, &path_len, sizeof(path_len));
+        len += sizeof(path_len) + path_len;
+        client->slots[asked++] = (int)i;
+    }
+
+    if (write_all(client->fd, client->send, len) != 0 ||
+        read_all(client->fd, client->replies, asked * sizeof(meta_value_t)) != 0) {
+        return -1;
+    }
+    for (size_t i = 0; i < asked; i++) {
+        const meta_value_t *value = &client->replies[i];
+        stat_request_t *req = &requests[client->slots[i]];
+
+        if (value->error != 0) {
+            req->result = -value->error;
+        } else {
+            bin_record_to_statx(&value->record, value->attributes_mask, req->stx);
+            req->result = 0;
+        }
+    }
+    return 0;
+}
+
+int serve_statx_batch(serve_client_t *client, stat_request_t *requests, size_t count)
+{
+    for (size_t start = 0; start < count; start += SERVE_PIPELINE) {
+        size_t n = count - start < SERVE_PIPELINE ? count - start : SERVE_PIPELINE;
+
+        if (client->fd < 0 || ask_chunk(client, requests + start, n) != 0) {
+            int error = client->fd < 0 ? ECONNRESET : errno;
+
+            if (client->fd >= 0) {
+                fprintf(stderr, "Error: Lost the connection to the server: %s\n",
+                        strerror(error));
+                close(client->fd);
+                client->fd = -1;
+            }
+            for (size_t i = start; i < count; i++) {
+                requests[i].result = -error;
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * @file filestat_serve.h
+ * @brief Daemon trả lời câu hỏi metadata từ cache (--serve) và client của nó (--server)
+ *
+ * Daemon chạy một luồng với epoll trên Unix domain socket (SOCK_STREAM),
+ * fd inotify của cache (xem filestat_cache.h) và signalfd. Trước mỗi lô
+ * câu hỏi đọc được, mọi sự kiện inotify đang chờ được áp dụng, nên câu
+ * trả lời không cũ hơn các thay đổi đã xong trước khi câu hỏi được gửi,
+ * trừ những thay đổi inotify không báo (xem giới hạn trong filestat_cache.h).
+ *
+ * Protocol (byte order của máy, cả hai phía cùng một máy):
+ *
+ *   client -> server   serve_hello_t, rồi mỗi câu hỏi: uint32_t path_len + path
+ *   server -> client   serve_hello_t, rồi một meta_value_t (144 byte) cho mỗi
+ *                      câu hỏi, theo đúng thứ tự
+ *
+ * Client gửi liền tối đa SERVE_PIPELINE câu hỏi rồi mới đọc trả lời, nên
+ * một lô chỉ tốn vài lần write()/read() thay vì một syscall mỗi path.
+ * Daemon ngừng đọc từ một client khi trả lời chờ gửi vượt SERVE_OUT_MAX.
+ *
+ * SIGINT/SIGTERM: dừng, xóa socket, in thống kê lên stderr.
+ * SIGUSR1: in thống kê lên stderr.
+ */
+
+#ifndef FILESTAT_SERVE_H
+#define FILESTAT_SERVE_H
+
+#include "filestat.h"
+#include "filestat_cache.h"
+#include "filestat_uring.h"
+
+/* ======================== CONSTANTS ======================== */
+#define SERVE_MAGIC      "FSTQ"
+#define SERVE_VERSION    1
+#define SERVE_PIPELINE   1024          /* Câu hỏi tối đa một client gửi trước khi đọc */
+#define SERVE_OUT_MAX    (1 << 20)     /* Trả lời chờ gửi tối đa trước khi ngừng đọc */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Lời chào đầu kết nối, cả hai chiều (8 byte)
+ */
+typedef struct {
+    char magic[4];           /* "FSTQ" */
+    uint32_t version;        /* SERVE_VERSION */
+} serve_hello_t;
+
+/* Kết nối tới daemon (opaque) */
+typedef struct serve_client serve_client_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Chạy daemon cho tới SIGINT/SIGTERM
+ * @param socket_path Path của socket (socket cũ không còn ai nghe được thay thế)
+ * @param cache_size Số entry tối đa của cache
+ * @return 0 nếu dừng bình thường, -1 nếu lỗi (đã báo trên stderr)
+ */
+int serve_run(const char *socket_path, size_t cache_size);
+
+/**
+ * @brief Kết nối tới daemon
+ * @return Kết nối mới, hoặc NULL nếu lỗi (đã báo trên stderr)
+ */
+serve_client_t *serve_connect(const char *socket_path);
+
+/**
+ * @brief Hỏi daemon cả lô, thay cho sync_statx_batch()
+ *
+ * dirfd phải là AT_FDCWD; path tương đối được ghép với thư mục hiện tại
+ * lúc kết nối. flags và mask bị bỏ qua: daemon luôn trả về mọi trường,
+ * với AT_SYMLINK_NOFOLLOW.
+ *
+ * @return 0 nếu thành công, -1 nếu mất kết nối (các yêu cầu chưa xong có result < 0)
+ */
+int serve_statx_batch(serve_client_t *client, stat_request_t *requests, size_t count);
+
+/**
+ * @brief Đóng kết nối (NULL được chấp nhận)
+ */
+void serve_close(serve_client_t *client);
+
+#endif /* FILESTAT_SERVE_H */
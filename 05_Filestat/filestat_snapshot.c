@@ -0,0 +1,690 @@
+/**
+ * @file filestat_snapshot.c
+ * @brief Đọc (mmap), tra cứu và ghi snapshot metadata
+ *
+ * Trong lúc duyệt, mỗi luồng thêm entry vào phần riêng của bộ tạo (không
+ * khóa). Khi ghi, các bản ghi được sắp xếp theo path_hash bằng radix sort,
+ * chỉ số thư mục cha được đổi sang vị trí đã sắp xếp, rồi header, entry,
+ * children và tên được ghi tuần tự, nên file không phụ thuộc số luồng hay
+ * thứ tự duyệt.
+ */
+
+#include "filestat_snapshot.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+
+/* ======================== CONSTANTS ======================== */
+#define FNV_PRIME          0x100000001b3ULL
+#define SNAP_PART_SHIFT    40                  /* Id bản ghi = phần << 40 | vị trí trong phần */
+#define SNAP_PART_INIT     1024                /* Số bản ghi ban đầu mỗi phần */
+#define SNAP_RADIX_BITS    16                  /* Radix sort: 4 lượt 16 bit */
+#define SNAP_WRITE_BUFFER  (1 << 20)
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Một entry trong bộ tạo (thư mục cha là id bản ghi, chưa phải vị trí)
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t parent;         /* Id bản ghi của thư mục cha, SNAP_NO_RECORD với gốc */
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_ns;
+    int64_t ctime_ns;
+    size_t name_off;         /* Trong names của phần */
+    uint16_t mode;
+    uint16_t name_len;
+} snap_record_t;
+
+/**
+ * @brief Phần của một luồng (căn theo cache line, chỉ luồng đó ghi)
+ */
+typedef struct {
+    _Alignas(64) snap_record_t *records;
+    size_t count;
+    size_t cap;
+    char *names;
+    size_t names_len;
+    size_t names_cap;
+} snap_part_t;
+
+struct snap_builder {
+    snap_part_t *parts;
+    unsigned num_parts;
+    atomic_bool failed;      /* Hết bộ nhớ ở một phần: snapshot không đầy đủ */
+};
+
+/**
+ * @brief Khóa sắp xếp: hash và bản ghi
+ */
+typedef struct {
+    uint64_t hash;
+    uint64_t id;             /* Id bản ghi (phần << SNAP_PART_SHIFT | vị trí) */
+} snap_key_t;
+
+/* ======================== HASHING ======================== */
+
+uint64_t snap_hash_child(uint64_t dir_hash, const char *name, size_t name_len)
+{
+    uint64_t h = (dir_hash ^ '/') * FNV_PRIME;
+
+    for (size_t i = 0; i < name_len; i++) {
+        h = (h ^ (unsigned char)name[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+static int64_t time_ns(const struct statx_timestamp *ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000 + ts->tv_nsec;
+}
+
+/* ======================== READING ======================== */
+
+/**
+ * @brief Kiểm tra mọi chỉ số trong snapshot nằm trong giới hạn
+ *
+ * Nhờ đó phần còn lại của chương trình truy cập entry, children và tên
+ * mà không cần kiểm tra lại, kể cả với file hỏng.
+ */
+static bool snapshot_valid(const snapshot_t *snap, uint64_t names_size, uint64_t num_children)
+{
+    uint64_t roots = 0;
+
+    for (uint32_t i = 0; i < snap->count; i++) {
+        const snap_entry_t *e = &snap->entries[i];
+
+        if ((uint64_t)e->name_off + e->name_len > names_size || e->name_len > NAME_MAX ||
+            (e->parent != SNAP_NONE && e->parent >= snap->count) ||
+            (uint64_t)e->child_start + e->child_count > num_children ||
+            e->child_dirs > e->child_count) {
+            return false;
+        }
+        roots += e->parent == SNAP_NONE;
+    }
+    for (uint64_t i = 0; i < num_children; i++) {
+        if (snap->children[i] >= snap->count) {
+            return false;
+        }
+    }
+    return roots == 1;
+}
+
+snapshot_t *snapshot_open(const char *path)
+{
+    snapshot_t *snap;
+    const snap_header_t *h;
+    struct stat st;
+    uint64_t num_children;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open snapshot %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(snap_header_t)) {
+        fprintf(stderr, "Error: %s is not a filestat snapshot\n", path);
+        close(fd);
+        return NULL;
+    }
+    snap = calloc(1, sizeof(*snap));
+    if (snap == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        close(fd);
+        return NULL;
+    }
+    snap->map_size = (size_t)st.st_size;
+    snap->map = mmap(NULL, snap->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (snap->map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map snapshot %s: %s\n", path, strerror(errno));
+        free(snap);
+        return NULL;
+    }
+
+    /* Các vùng phải nối tiếp nhau và vừa khít file */
+    h = snap->map;
+    if (memcmp(h->magic, SNAP_MAGIC, 4) != 0 || h->version != SNAP_VERSION ||
+        h->header_size != sizeof(snap_header_t) || h->entry_size != sizeof(snap_entry_t) ||
+        h->entry_count == 0 || h->entry_count >= SNAP_NONE ||
+        h->entry_count > (snap->map_size - h->header_size) / h->entry_size ||
+        h->children_offset != h->header_size + h->entry_count * h->entry_size ||
+        h->names_offset < h->children_offset ||
+        (h->names_offset - h->children_offset) % sizeof(uint32_t) != 0 ||
+        h->names_offset > snap->map_size || h->names_size != snap->map_size - h->names_offset) {
+        fprintf(stderr, "Error: %s is not a filestat snapshot (or is damaged)\n", path);
+        snapshot_close(snap);
+        return NULL;
+    }
+    num_children = (h->names_offset - h->children_offset) / sizeof(uint32_t);
+    snap->entries = (const snap_entry_t *)((const char *)snap->map + h->header_size);
+    snap->children = (const uint32_t *)((const char *)snap->map + h->children_offset);
+    snap->names = (const char *)snap->map + h->names_offset;
+    snap->count = (uint32_t)h->entry_count;
+
+    if (!snapshot_valid(snap, h->names_size, num_children)) {
+        fprintf(stderr, "Error: Snapshot %s is damaged\n", path);
+        snapshot_close(snap);
+        return NULL;
+    }
+    snap->seen = calloc(snap->count, sizeof(*snap->seen));
+    if (snap->seen == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        snapshot_close(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+void snapshot_close(snapshot_t *snap)
+{
+    if (snap == NULL) {
+        return;
+    }
+    if (snap->map != NULL && snap->map != MAP_FAILED) {
+        munmap(snap->map, snap->map_size);
+    }
+    free(snap->seen);
+    free(snap);
+}
+
+uint32_t snapshot_lookup(const snapshot_t *snap, uint64_t hash, const char *name,
+                         size_t name_len)
+{
+    size_t lo = 0;
+    size_t hi = snap->count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (snap->entries[mid].path_hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    /* Trùng hash (cực hiếm): so thêm tên */
+    for (; lo < snap->count && snap->entries[lo].path_hash == hash; lo++) {
+        const snap_entry_t *e = &snap->entries[lo];
+        if (e->name_len == name_len && memcmp(snap->names + e->name_off, name, name_len) == 0) {
+            return (uint32_t)lo;
+        }
+    }
+    return SNAP_NONE;
+}
+
+bool snapshot_changed(const snap_entry_t *entry, const struct statx *stx)
+{
+    if (entry->ino != stx->stx_ino || entry->mode != (uint16_t)stx->stx_mode) {
+        return true;
+    }
+    if (S_ISDIR(stx->stx_mode)) {
+        return false;
+    }
+    return entry->size != stx->stx_size || entry->mtime_ns != time_ns(&stx->stx_mtime) ||
+           entry->ctime_ns != time_ns(&stx->stx_ctime);
+}
+
+bool snapshot_dir_unchanged(const snap_entry_t *entry, const struct statx *stx)
+{
+    return S_ISDIR(entry->mode) && S_ISDIR(stx->stx_mode) && entry->ino == stx->stx_ino &&
+           entry->mtime_ns == time_ns(&stx->stx_mtime) &&
+           entry->ctime_ns == time_ns(&stx->stx_ctime);
+}
+
+/* ======================== REMOVED ENTRIES ======================== */
+
+uint64_t snapshot_report_removed(const snapshot_t *snap, const char *root, writer_t *out)
+{
+    size_t root_len = strlen(root);
+    bool sep = root_len > 0 && root[root_len - 1] != '/';
+    uint64_t removed = 0;
+    char *buffer = NULL;
+    size_t cap = 0;
+
+    for (uint32_t i = 0; i < snap->count; i++) {
+        size_t len = 0;
+        uint32_t steps = 0;
+        size_t pos;
+
+        if (atomic_load_explicit(&snap->seen[i], memory_order_relaxed)) {
+            continue;
+        }
+        /* Độ dài "/a/b/c" (một vòng cha bị hỏng thì dừng sau count bước) */
+        for (uint32_t j = i; snap->entries[j].parent != SNAP_NONE && steps <= snap->count;
+             j = snap->entries[j].parent, steps++) {
+            len += 1 + snap->entries[j].name_len;
+        }
+        if (steps > snap->count) {
+            continue;
+        }
+        if (len + 1 > cap) {
+            char *grown = realloc(buffer, len + 1);
+            if (grown == NULL) {
+                fprintf(stderr, "Error: Out of memory\n");
+                break;
+            }
+            buffer = grown;
+            cap = len + 1;
+        }
+
+        /* Ghép path từ cuối lên gốc */
+        pos = len;
+        buffer[pos] = '\n';
+        for (uint32_t j = i; snap->entries[j].parent != SNAP_NONE; j = snap->entries[j].parent) {
+            const snap_entry_t *e = &snap->entries[j];
+            pos -= e->name_len;
+            memcpy(buffer + pos, snap->names + e->name_off, e->name_len);
+            buffer[--pos] = '/';
+        }
+        writer_write(out, "D ", 2);
+        writer_write(out, root, root_len);
+        /* Gốc kết thúc bằng '/' (hoặc chính gốc bị xóa): bỏ '/' đầu */
+        writer_write(out, buffer + (sep || len == 0 ? 0 : 1), len + (sep || len == 0 ? 1 : 0));
+        removed++;
+    }
+    free(buffer);
+    return removed;
+}
+
+/* ======================== BUILDING ======================== */
+
+snap_builder_t *snap_builder_create(unsigned parts)
+{
+    snap_builder_t *b = malloc(sizeof(*b));
+
+    if (b == NULL) {
+        return NULL;
+    }
+    b->parts = aligned_alloc(64, parts * sizeof(*b->parts));
+    if (b->parts == NULL) {
+        free(b);
+        return NULL;
+    }
+    memset(b->parts, 0, parts * sizeof(*b->parts));
+    b->num_parts = parts;
+    atomic_init(&b->failed, false);
+    return b;
+}
+
+void snap_builder_destroy(snap_builder_t *b)
+{
+    if (b == NULL) {
+        return;
+    }
+    for (unsigned i = 0; i < b->num_parts; i++) {
+        free(b->parts[i].records);
+        free(b->parts[i].names);
+    }
+    free(b->parts);
+    free(b);
+}
+
+/**
+ * @brief Thêm một bản ghi (chưa điền metadata) và tên của nó vào phần part
+ * @return Bản ghi, hoặc NULL nếu hết bộ nhớ (bộ tạo bị đánh dấu hỏng)
+ */
+static snap_record_t *part_append(snap_builder_t *b, unsigned part, const char *name,
+                                  size_t name_len, uint64_t *id)
+{
+    snap_part_t *p = &b->parts[part];
+    snap_record_t *r;
+
+    if (p->count == p->cap) {
+        size_t cap = p->cap ? p->cap * 2 : SNAP_PART_INIT;
+        snap_record_t *records = realloc(p->records, cap * sizeof(*records));
+        if (records == NULL) {
+            atomic_store(&b->failed, true);
+            return NULL;
+        }
+        p->records = records;
+        p->cap = cap;
+    }
+    if (p->names_len + name_len > p->names_cap) {
+        size_t cap = p->names_cap ? p->names_cap * 2 : SNAP_PART_INIT * 16;
+        while (cap < p->names_len + name_len) {
+            cap *= 2;
+        }
+        char *names = realloc(p->names, cap);
+        if (names == NULL) {
+            atomic_store(&b->failed, true);
+            return NULL;
+        }
+        p->names = names;
+        p->names_cap = cap;
+    }
+
+    r = &p->records[p->count];
+    r->name_off = p->names_len;
+    r->name_len = (uint16_t)name_len;
+    if (name_len > 0) {
+        memcpy(p->names + p->names_len, name, name_len);
+    }
+    p->names_len += name_len;
+    *id = ((uint64_t)part << SNAP_PART_SHIFT) | p->count;
+    p->count++;
+    return r;
+}
+
+uint64_t snap_builder_add(snap_builder_t *b, unsigned part, uint64_t hash, uint64_t parent,
+                          const char *name, size_t name_len, const struct statx *stx)
+{
+    uint64_t id;
+    snap_record_t *r = part_append(b, part, name, name_len, &id);
+
+    if (r == NULL) {
+        return SNAP_NO_RECORD;
+    }
+    r->hash = hash;
+    r->parent = parent;
+    r->ino = stx->stx_ino;
+    r->size = stx->stx_size;
+    r->mtime_ns = time_ns(&stx->stx_mtime);
+    r->ctime_ns = time_ns(&stx->stx_ctime);
+    r->mode = (uint16_t)stx->stx_mode;
+    return id;
+}
+
+uint64_t snap_builder_add_old(snap_builder_t *b, unsigned part, uint64_t parent,
+                              const snapshot_t *old, uint32_t index)
+{
+    const snap_entry_t *e = &old->entries[index];
+    uint64_t id;
+    snap_record_t *r = part_append(b, part, old->names + e->name_off, e->name_len, &id);
+
+    if (r == NULL) {
+        return SNAP_NO_RECORD;
+    }
+    r->hash = e->path_hash;
+    r->parent = parent;
+    r->ino = e->ino;
+    r->size = e->size;
+    r->mtime_ns = e->mtime_ns;
+    r->ctime_ns = e->ctime_ns;
+    r->mode = e->mode;
+    return id;
+}
+
+/**
+ * @brief Radix sort LSD theo hash (4 lượt 16 bit, ổn định)
+ *
+ * O(n) thay vì O(n log n) của qsort(): với 10 triệu entry, sắp xếp
+ * không còn là phần đáng kể của việc ghi snapshot.
+ * @return false nếu hết bộ nhớ
+ */
+static bool sort_keys(snap_key_t *keys, size_t n)
+{
+    size_t *count = malloc(((size_t)1 << SNAP_RADIX_BITS) * sizeof(*count));
+    snap_key_t *tmp = malloc(n * sizeof(*tmp));
+
+    if (count == NULL || tmp == NULL) {
+        free(count);
+        free(tmp);
+        return false;
+    }
+    for (unsigned shift = 0; shift < 64; shift += SNAP_RADIX_BITS) {
+        size_t sum = 0;
+
+        memset(count, 0, ((size_t)1 << SNAP_RADIX_BITS) * sizeof(*count));
+        for (size_t i = 0; i < n; i++) {
+            count[(keys[i].hash >> shift) & ((1u << SNAP_RADIX_BITS) - 1)]++;
+        }
+        for (size_t d = 0; d < ((size_t)1 << SNAP_RADIX_BITS); d++) {
+            size_t c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; i++) {
+            tmp[count[(keys[i].hash >> shift) & ((1u << SNAP_RADIX_BITS) - 1)]++] = keys[i];
+        }
+        memcpy(keys, tmp, n * sizeof(*keys));
+    }
+    free(count);
+    free(tmp);
+    return true;
+}
+
+/**
+ * @brief Các mảng tạm của một lần ghi
+ */
+typedef struct {
+    size_t base[MAX_THREADS];      /* Vị trí của bản ghi đầu tiên mỗi phần */
+    snap_key_t *keys;              /* Theo thứ tự đã sắp xếp */
+    uint32_t *rank;                /* Vị trí đã sắp xếp của mỗi bản ghi */
+    uint32_t *child_count;         /* Theo vị trí đã sắp xếp */
+    uint32_t *child_dirs;
+    uint32_t *child_start;
+    uint32_t *children;
+    size_t num_children;
+} snap_layout_t;
+
+/**
+ * @brief Vị trí của bản ghi id trong thứ tự các phần (chỉ số của rank)
+ */
+static size_t layout_index(const snap_layout_t *l, uint64_t id)
+{
+    return l->base[id >> SNAP_PART_SHIFT] + (id & (((uint64_t)1 << SNAP_PART_SHIFT) - 1));
+}
+
+static const snap_record_t *layout_record(const snap_builder_t *b, uint64_t id)
+{
+    return &b->parts[id >> SNAP_PART_SHIFT].records[id & (((uint64_t)1 << SNAP_PART_SHIFT) - 1)];
+}
+
+/**
+ * @brief Vị trí đã sắp xếp của thư mục cha (id bản ghi -> vị trí)
+ */
+static uint32_t layout_parent(const snap_layout_t *l, uint64_t parent)
+{
+    return parent == SNAP_NO_RECORD ? SNAP_NONE : l->rank[layout_index(l, parent)];
+}
+
+/**
+ * @brief Sắp xếp và tính children cho mọi bản ghi
+ * @return false nếu hết bộ nhớ
+ */
+static bool build_layout(const snap_builder_t *b, snap_layout_t *l, size_t n)
+{
+    uint32_t *next_dir;
+    uint32_t *next_file;
+    size_t k = 0;
+
+    l->keys = malloc(n * sizeof(*l->keys));
+    l->rank = malloc(n * sizeof(*l->rank));
+    l->child_count = calloc(n, sizeof(*l->child_count));
+    l->child_dirs = calloc(n, sizeof(*l->child_dirs));
+    l->child_start = malloc(n * sizeof(*l->child_start));
+    l->children = malloc(n * sizeof(*l->children));
+    if (l->keys == NULL || l->rank == NULL || l->child_count == NULL || l->child_dirs == NULL ||
+        l->child_start == NULL || l->children == NULL) {
+        return false;
+    }
+
+    for (unsigned p = 0; p < b->num_parts; p++) {
+        for (size_t i = 0; i < b->parts[p].count; i++, k++) {
+            l->keys[k].hash = b->parts[p].records[i].hash;
+            l->keys[k].id = ((uint64_t)p << SNAP_PART_SHIFT) | i;
+        }
+    }
+    if (!sort_keys(l->keys, n)) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        l->rank[layout_index(l, l->keys[i].id)] = (uint32_t)i;
+    }
+
+    /* Đếm con của mỗi thư mục, rồi cấp cho nó một đoạn liên tục trong children */
+    for (size_t i = 0; i < n; i++) {
+        const snap_record_t *r = layout_record(b, l->keys[i].id);
+        uint32_t parent = layout_parent(l, r->parent);
+
+        if (parent != SNAP_NONE) {
+            l->child_count[parent]++;
+            l->child_dirs[parent] += S_ISDIR(r->mode) ? 1 : 0;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        l->child_start[i] = (uint32_t)l->num_children;
+        l->num_children += l->child_count[i];
+    }
+
+    /* Thư mục con trước, file sau; mỗi nhóm theo thứ tự hash */
+    next_dir = malloc(n * sizeof(*next_dir));
+    next_file = malloc(n * sizeof(*next_file));
+    if (next_dir == NULL || next_file == NULL) {
+        free(next_dir);
+        free(next_file);
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        next_dir[i] = l->child_start[i];
+        next_file[i] = l->child_start[i] + l->child_dirs[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        const snap_record_t *r = layout_record(b, l->keys[i].id);
+        uint32_t parent = layout_parent(l, r->parent);
+
+        if (parent != SNAP_NONE) {
+            uint32_t slot = S_ISDIR(r->mode) ? next_dir[parent]++ : next_file[parent]++;
+            l->children[slot] = (uint32_t)i;
+        }
+    }
+    free(next_dir);
+    free(next_file);
+    return true;
+}
+
+static void free_layout(snap_layout_t *l)
+{
+    free(l->keys);
+    free(l->rank);
+    free(l->child_count);
+    free(l->child_dirs);
+    free(l->child_start);
+    free(l->children);
+}
+
+/**
+ * @brief Ghi header, entry, children và tên theo thứ tự đã sắp xếp
+ */
+static void write_layout(const snap_builder_t *b, const snap_layout_t *l, size_t n,
+                         uint64_t names_size, writer_t *out)
+{
+    snap_header_t header;
+    uint32_t name_off = 0;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAP_MAGIC, 4);
+    header.version = SNAP_VERSION;
+    header.header_size = sizeof(snap_header_t);
+    header.entry_size = sizeof(snap_entry_t);
+    header.entry_count = n;
+    header.children_offset = sizeof(snap_header_t) + n * sizeof(snap_entry_t);
+    header.names_offset = header.children_offset + l->num_children * sizeof(uint32_t);
+    header.names_size = names_size;
+    writer_write(out, &header, sizeof(header));
+
+    for (size_t i = 0; i < n; i++) {
+        const snap_record_t *r = layout_record(b, l->keys[i].id);
+        snap_entry_t e;
+
+        e.path_hash = r->hash;
+        e.ino = r->ino;
+        e.size = r->size;
+        e.mtime_ns = r->mtime_ns;
+        e.ctime_ns = r->ctime_ns;
+        e.parent = layout_parent(l, r->parent);
+        e.mode = r->mode;
+        e.name_len = r->name_len;
+        e.name_off = name_off;
+        e.child_start = l->child_start[i];
+        e.child_count = l->child_count[i];
+        e.child_dirs = l->child_dirs[i];
+        name_off += r->name_len;
+        writer_write(out, &e, sizeof(e));
+    }
+    writer_write(out, l->children, l->num_children * sizeof(uint32_t));
+    for (size_t i = 0; i < n; i++) {
+        const snap_record_t *r = layout_record(b, l->keys[i].id);
+        if (r->name_len > 0) {
+            writer_write(out, b->parts[l->keys[i].id >> SNAP_PART_SHIFT].names + r->name_off,
+                         r->name_len);
+        }
+    }
+}
+
+int snap_builder_write(snap_builder_t *b, const char *path)
+{
+    snap_layout_t layout;
+    uint64_t names_size = 0;
+    size_t n = 0;
+    size_t tmp_len = strlen(path) + sizeof(".tmp");
+    char *tmp;
+    writer_t out;
+    int fd;
+    int result = 0;
+
+    if (atomic_load(&b->failed)) {
+        fprintf(stderr, "Error: Out of memory, snapshot %s not written\n", path);
+        return -1;
+    }
+    memset(&layout, 0, sizeof(layout));
+    for (unsigned p = 0; p < b->num_parts; p++) {
+        layout.base[p] = n;
+        n += b->parts[p].count;
+        names_size += b->parts[p].names_len;
+    }
+    if (n == 0) {
+        return -1;
+    }
+    if (n >= SNAP_NONE || names_size > UINT32_MAX) {
+        fprintf(stderr, "Error: Too many entries for a snapshot (%zu)\n", n);
+        return -1;
+    }
+    if (!build_layout(b, &layout, n)) {
+        fprintf(stderr, "Error: Out of memory, snapshot %s not written\n", path);
+        free_layout(&layout);
+        return -1;
+    }
+
+    /* Ghi vào file tạm rồi rename(): snapshot cũ còn nguyên nếu bị ngắt */
+    tmp = malloc(tmp_len);
+    if (tmp == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        free_layout(&layout);
+        return -1;
+    }
+    snprintf(tmp, tmp_len, "%s.tmp", path);
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0 || writer_init(&out, fd, SNAP_WRITE_BUFFER) != 0) {
+        fprintf(stderr, "Error: Cannot create %s: %s\n", tmp, fd < 0 ? strerror(errno) : "Out of memory");
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp);
+        }
+        free(tmp);
+        free_layout(&layout);
+        return -1;
+    }
+    write_layout(b, &layout, n, names_size, &out);
+    if (writer_close(&out) != 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", tmp, strerror(out.error));
+        result = -1;
+    }
+    if (close(fd) != 0 && result == 0) {
+        fprintf(stderr, "Error: Cannot write %s: %s\n", tmp, strerror(errno));
+        result = -1;
+    }
+    if (result == 0 && rename(tmp, path) != 0) {
+        fprintf(stderr, "Error: Cannot rename %s to %s: %s\n", tmp, path, strerror(errno));
+        result = -1;
+    }
+    if (result != 0) {
+        unlink(tmp);
+    }
+    free(tmp);
+    free_layout(&layout);
+    return result;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file filestat_snapshot.h
+ * @brief Snapshot metadata của một cây và so sánh với lần quét trước
+ *
+ * Snapshot (--snapshot=FILE) là một file đọc được bằng mmap():
+ *
+ *   snap_header_t                  64 byte, ở offset 0
+ *   snap_entry_t x entry_count     64 byte mỗi entry, sắp xếp theo path_hash
+ *   uint32_t x (entry_count - 1)   children: vị trí các entry con, gom theo
+ *                                  thư mục cha, thư mục con đứng trước
+ *   name blob                      tên (không phải path) của các entry, không có '\0'
+ *
+ * path_hash là FNV-1a 64 bit của path tương đối với thư mục gốc ("" cho
+ * gốc, "a/b/c" cho các entry khác), nên snapshot không phụ thuộc cách
+ * viết đường dẫn gốc. Tra một path là một lần tìm nhị phân; path đầy đủ
+ * dựng lại được từ tên và chỉ số thư mục cha.
+ *
+ * So sánh (--diff=FILE) quét lại cây và in mỗi thay đổi trên một dòng:
+ * "A <path>" (mới), "D <path>" (đã xóa), "M <path>" (inode, kích thước,
+ * quyền, mtime hoặc ctime khác). Thư mục có inode, mtime và ctime như
+ * trong snapshot có cùng danh sách entry: không getdents64() và không
+ * statx() các file của nó, chỉ statx() các thư mục con (lấy từ snapshot)
+ * để đi tiếp. Vì sửa nội dung một file không đổi mtime của thư mục chứa
+ * nó, các file trong thư mục không đổi chỉ được kiểm tra với
+ * --verify-files.
+ */
+
+#ifndef FILESTAT_SNAPSHOT_H
+#define FILESTAT_SNAPSHOT_H
+
+#include "filestat.h"
+#include <stdatomic.h>
+
+/* ======================== CONSTANTS ======================== */
+#define SNAP_MAGIC       "FSTS"
+#define SNAP_VERSION     1
+#define SNAP_NONE        UINT32_MAX          /* Không có entry (thư mục cha của gốc, path mới) */
+#define SNAP_NO_RECORD   UINT64_MAX          /* Không có bản ghi trong snapshot đang tạo */
+#define SNAP_ROOT_HASH   0xcbf29ce484222325ULL   /* FNV-1a của "" */
+
+/* Các trường statx() snapshot cần */
+#define SNAP_STATX_MASK  (STATX_TYPE | STATX_MODE | STATX_INO | STATX_SIZE | \
+                          STATX_MTIME | STATX_CTIME)
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Header của file snapshot (64 byte)
+ */
+typedef struct {
+    char magic[4];           /* "FSTS" */
+    uint32_t version;        /* SNAP_VERSION */
+    uint32_t header_size;    /* sizeof(snap_header_t), entry bắt đầu ở đây */
+    uint32_t entry_size;     /* sizeof(snap_entry_t) */
+    uint64_t entry_count;
+    uint64_t children_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint8_t reserved[16];
+} snap_header_t;
+
+/**
+ * @brief Một entry của snapshot (64 byte)
+ */
+typedef struct {
+    uint64_t path_hash;      /* FNV-1a của path tương đối */
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_ns;        /* Giây * 10^9 + nano giây */
+    int64_t ctime_ns;
+    uint32_t parent;         /* Vị trí của thư mục cha, SNAP_NONE với gốc */
+    uint16_t mode;           /* st_mode: loại và quyền */
+    uint16_t name_len;
+    uint32_t name_off;       /* Vị trí tên trong name blob */
+    uint32_t child_start;    /* Thư mục: con đầu tiên trong children */
+    uint32_t child_count;    /* Thư mục: số entry con */
+    uint32_t child_dirs;     /* Thư mục: số thư mục con (đứng đầu) */
+} snap_entry_t;
+
+/**
+ * @brief Snapshot đã mở bằng mmap()
+ */
+typedef struct {
+    void *map;
+    size_t map_size;
+    const snap_entry_t *entries;
+    const uint32_t *children;
+    const char *names;
+    uint32_t count;
+    atomic_uchar *seen;      /* --diff: entry còn tồn tại (đánh dấu trong lúc quét) */
+} snapshot_t;
+
+/* Bộ tạo snapshot mới (opaque): mỗi luồng thêm vào phần riêng của nó */
+typedef struct snap_builder snap_builder_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Hash của entry name nằm trong thư mục có hash dir_hash
+ *
+ * FNV-1a cho phép tiếp tục từ hash của thư mục cha thay vì băm lại cả
+ * path: hash("a/b") = tiếp tục(hash("a"), "/b").
+ */
+uint64_t snap_hash_child(uint64_t dir_hash, const char *name, size_t name_len);
+
+/**
+ * @brief Mở và kiểm tra một snapshot
+ * @return Snapshot, hoặc NULL nếu lỗi (đã báo trên stderr)
+ */
+snapshot_t *snapshot_open(const char *path);
+
+void snapshot_close(snapshot_t *snap);
+
+/**
+ * @brief Tìm entry theo hash và tên
+ * @return Vị trí, hoặc SNAP_NONE nếu không có
+ */
+uint32_t snapshot_lookup(const snapshot_t *snap, uint64_t hash, const char *name,
+                         size_t name_len);
+
+/**
+ * @brief Đánh dấu entry vẫn còn tồn tại (an toàn đa luồng)
+ */
+static inline void snapshot_mark(snapshot_t *snap, uint32_t index)
+{
+    atomic_store_explicit(&snap->seen[index], 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Metadata hiện tại khác entry trong snapshot không
+ *
+ * Với thư mục chỉ so inode, loại và quyền: mtime/ctime của thư mục đổi
+ * mỗi khi nội dung đổi, và các thay đổi đó đã được báo trên từng entry.
+ */
+bool snapshot_changed(const snap_entry_t *entry, const struct statx *stx);
+
+/**
+ * @brief Thư mục không đổi danh sách entry kể từ snapshot (inode, mtime, ctime như cũ)
+ */
+bool snapshot_dir_unchanged(const snap_entry_t *entry, const struct statx *stx);
+
+/**
+ * @brief In "D <path>" cho mọi entry chưa được đánh dấu
+ * @param snap Snapshot cũ, sau khi đã quét xong
+ * @param root Đường dẫn gốc dùng để in
+ * @param out Writer nhận output
+ * @return Số entry đã xóa
+ */
+uint64_t snapshot_report_removed(const snapshot_t *snap, const char *root, writer_t *out);
+
+/**
+ * @brief Tạo bộ tạo snapshot với parts phần (một phần mỗi luồng)
+ * @return Bộ tạo, hoặc NULL nếu hết bộ nhớ
+ */
+snap_builder_t *snap_builder_create(unsigned parts);
+
+/**
+ * @brief Thêm một entry vừa statx() vào phần part
+ * @param parent Bản ghi của thư mục cha, SNAP_NO_RECORD với gốc
+ * @return Id bản ghi (dùng làm parent của các entry con), SNAP_NO_RECORD nếu hết bộ nhớ
+ */
+uint64_t snap_builder_add(snap_builder_t *b, unsigned part, uint64_t hash, uint64_t parent,
+                          const char *name, size_t name_len, const struct statx *stx);
+
+/**
+ * @brief Chép nguyên entry index của snapshot cũ (file trong thư mục không đổi)
+ * @return Id bản ghi, SNAP_NO_RECORD nếu hết bộ nhớ
+ */
+uint64_t snap_builder_add_old(snap_builder_t *b, unsigned part, uint64_t parent,
+                              const snapshot_t *old, uint32_t index);
+
+/**
+ * @brief Sắp xếp, liên kết và ghi snapshot (qua file tạm rồi rename())
+ * @return 0 nếu thành công, -1 nếu lỗi (đã báo trên stderr)
+ */
+int snap_builder_write(snap_builder_t *b, const char *path);
+
+void snap_builder_destroy(snap_builder_t *b);
+
+#endif /* FILESTAT_SNAPSHOT_H */
@@ -0,0 +1,288 @@
+/**
+ * @file filestat_uring.c
+ * @brief io_uring tối giản cho IORING_OP_STATX (không dùng liburing)
+ *
+ * Ring gồm hai hàng đợi dùng chung với kernel qua mmap():
+ * - Submission queue (SQ): chương trình ghi SQE rồi tăng sq_tail
+ * - Completion queue (CQ): kernel ghi CQE rồi tăng cq_tail, chương trình
+ *   đọc và tăng cq_head
+ * Chỉ một luồng dùng mỗi ring, nên chỉ cần barrier acquire/release trên
+ * các chỉ số dùng chung với kernel.
+ */
+
+#include "filestat_uring.h"
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/* ======================== TYPES ======================== */
+
+struct uring {
+    int fd;
+    unsigned int sq_entries;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring;            /* Vùng mmap của SQ (và CQ nếu SINGLE_MMAP) */
+    size_t sq_ring_size;
+    void *cq_ring;            /* == sq_ring nếu kernel hỗ trợ SINGLE_MMAP */
+    size_t cq_ring_size;
+    size_t sqes_size;
+    bool broken;              /* io_uring_enter() lỗi: dùng statx() đồng bộ */
+};
+
+/* ======================== SYSCALL WRAPPERS ======================== */
+
+static int io_uring_setup(unsigned int entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete,
+                          unsigned int flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+/* ======================== RING SETUP ======================== */
+
+uring_t *uring_open(unsigned int depth)
+{
+    struct io_uring_params params;
+    uring_t *ring = calloc(1, sizeof(*ring));
+
+    if (ring == NULL) {
+        return NULL;
+    }
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CLAMP;
+
+    ring->fd = io_uring_setup(depth, &params);
+    if (ring->fd < 0) {
+        free(ring);
+        return NULL;
+    }
+    ring->sq_entries = params.sq_entries;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        goto fail;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            goto fail;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ring != ring->sq_ring) {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        goto fail;
+    }
+
+    ring->sq_tail = (unsigned int *)((char *)ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned int *)((char *)ring->sq_ring + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned int *)((char *)ring->sq_ring + params.sq_off.array);
+    ring->cq_head = (unsigned int *)((char *)ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned int *)((char *)ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned int *)((char *)ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)((char *)ring->cq_ring + params.cq_off.cqes);
+    return ring;
+
+fail:
+    {
+        int err = errno;
+        close(ring->fd);
+        free(ring);
+        errno = err;
+    }
+    return NULL;
+}
+
+void uring_close(uring_t *ring)
+{
+    if (ring == NULL) {
+        return;
+    }
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+    free(ring);
+}
+
+/* ======================== BATCH STATX ======================== */
+
+static void sync_statx(stat_request_t *req)
+{
+    req->result = statx(req->dirfd, req->path, req->flags, req->mask, req->stx) == 0 ? 0 : -errno;
+}
+
+void sync_statx_batch(stat_request_t *requests, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        sync_statx(&requests[i]);
+    }
+}
+
+/**
+ * @brief Ghi một SQE statx vào slot tiếp theo của SQ (chưa công bố cho kernel)
+ */
+static void queue_statx(uring_t *ring, unsigned int tail, const stat_request_t *req,
+                        size_t index)
+{
+    unsigned int slot = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_STATX;
+    sqe->fd = req->dirfd;
+    sqe->addr = (uint64_t)(uintptr_t)req->path;
+    sqe->len = req->mask;
+    sqe->addr2 = (uint64_t)(uintptr_t)req->stx;
+    sqe->statx_flags = (uint32_t)req->flags;
+    sqe->user_data = index;
+    ring->sq_array[slot] = slot;
+}
+
+/**
+ * @brief Đọc mọi CQE đã có
+ * @return Số yêu cầu vừa hoàn thành
+ */
+static unsigned int reap_completions(uring_t *ring, stat_request_t *requests)
+{
+    unsigned int head = *ring->cq_head;
+    unsigned int tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned int done = 0;
+
+    while (head != tail) {
+        const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+        stat_request_t *req = &requests[cqe->user_data];
+
+        req->result = cqe->res;
+        if (cqe->res == -EINVAL) {
+            /* Kernel cũ (< 5.6) không biết IORING_OP_STATX */
+            sync_statx(req);
+        }
+        head++;
+        done++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return done;
+}
+
+/* result của yêu cầu đã vào SQ nhưng chưa có CQE (kernel chỉ trả về 0 hoặc -errno) */
+#define RESULT_PENDING 1
+
+/**
+ * @brief Chờ mọi yêu cầu kernel đã nhận hoàn thành, sau khi io_uring_enter() lỗi
+ *
+ * Kernel vẫn giữ các yêu cầu này và sẽ ghi vào stx[] của chúng; trả về
+ * trước khi chúng xong thì lô sau (dùng lại cùng buffer) có thể bị ghi
+ * đè. CQE được kernel ghi vào ring dùng chung kể cả khi không gọi
+ * io_uring_enter(), nên nếu không chờ được bằng syscall thì thăm dò ring.
+ */
+static void drain_in_flight(uring_t *ring, stat_request_t *requests, unsigned int in_flight)
+{
+    const struct timespec pause = { 0, 1000000 };   /* 1 ms */
+
+    while (in_flight > 0) {
+        unsigned int reaped = reap_completions(ring, requests);
+
+        in_flight -= reaped;
+        if (in_flight > 0 && reaped == 0 &&
+            io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            nanosleep(&pause, NULL);
+        }
+    }
+}
+
+int uring_statx_batch(uring_t *ring, stat_request_t *requests, size_t count)
+{
+    size_t next = 0;              /* Yêu cầu tiếp theo chưa vào SQ */
+    size_t done = 0;
+    unsigned int in_sq = 0;       /* Đã vào SQ nhưng kernel chưa nhận */
+    unsigned int in_flight = 0;   /* Kernel đã nhận, chưa hoàn thành */
+
+    if (ring->broken) {
+        sync_statx_batch(requests, count);
+        return 0;
+    }
+
+    while (done < count) {
+        unsigned int tail = *ring->sq_tail;
+        int ret;
+
+        /* Giữ ring đầy: thêm yêu cầu mới vào mọi slot còn trống */
+        while (next < count && in_sq + in_flight < ring->sq_entries) {
+            queue_statx(ring, tail++, &requests[next], next);
+            requests[next].result = RESULT_PENDING;
+            next++;
+            in_sq++;
+        }
+        __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+        /* Gửi các SQE mới và chờ ít nhất một yêu cầu hoàn thành */
+        ret = io_uring_enter(ring->fd, in_sq, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                /* Tạm thời: thu các CQE đã có để giải phóng chỗ rồi thử lại */
+                unsigned int reaped = reap_completions(ring, requests);
+                in_flight -= reaped;
+                done += reaped;
+                continue;
+            }
+            /*
+             * Lỗi không phục hồi được: rút các SQE kernel chưa nhận, chờ
+             * các yêu cầu kernel đã nhận xong, rồi mọi yêu cầu chưa có
+             * kết quả báo lỗi
+             */
+            int err = errno;
+            ring->broken = true;
+            __atomic_store_n(ring->sq_tail, tail - in_sq, __ATOMIC_RELEASE);
+            drain_in_flight(ring, requests, in_flight);
+            for (size_t i = 0; i < count; i++) {
+                if (i >= next || requests[i].result == RESULT_PENDING) {
+                    requests[i].result = -err;
+                }
+            }
+            return -1;
+        }
+        in_sq -= (unsigned int)ret;
+        in_flight += (unsigned int)ret;
+
+        unsigned int reaped = reap_completions(ring, requests);
+        in_flight -= reaped;
+        done += reaped;
+    }
+    return 0;
+}
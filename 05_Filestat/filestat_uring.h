@@ -0,0 +1,75 @@
+/**
+ * @file filestat_uring.h
+ * @brief Gọi statx() theo lô qua io_uring (IORING_OP_STATX)
+ *
+ * Một lời gọi statx() đồng bộ chờ trọn độ trễ của filesystem trước khi
+ * gửi lời gọi tiếp theo. Với io_uring, cả lô yêu cầu được đưa vào
+ * submission queue cùng lúc; kernel xử lý chúng song song trên các
+ * worker của nó, nên trên cache lạnh hoặc filesystem mạng có hàng trăm
+ * yêu cầu cùng chờ I/O thay vì một.
+ *
+ * Module dùng syscall io_uring_setup/io_uring_enter trực tiếp, không cần
+ * liburing. Khi kernel không hỗ trợ (hoặc io_uring bị tắt),
+ * uring_open() trả về NULL và nơi gọi quay về statx() đồng bộ.
+ */
+
+#ifndef FILESTAT_URING_H
+#define FILESTAT_URING_H
+
+#include "filestat.h"
+
+/* ======================== CONSTANTS ======================== */
+#define URING_DEPTH 256   /* Số yêu cầu tối đa đang bay trên một ring */
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Một yêu cầu statx() trong lô
+ */
+typedef struct {
+    int dirfd;                /* Thư mục gốc của path (hoặc AT_FDCWD) */
+    const char *path;         /* Phải còn hợp lệ tới khi lô hoàn tất */
+    int flags;                /* AT_SYMLINK_NOFOLLOW, ... */
+    unsigned int mask;        /* Mask STATX_* */
+    struct statx *stx;        /* Nhận kết quả */
+    int result;               /* 0 nếu thành công, -errno nếu lỗi */
+} stat_request_t;
+
+/* Ring io_uring (opaque), mỗi luồng dùng một ring riêng */
+typedef struct uring uring_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo một ring io_uring
+ * @param depth Số yêu cầu đang bay tối đa (làm tròn lên lũy thừa 2 bởi kernel)
+ * @return Ring mới, hoặc NULL nếu io_uring không khả dụng (errno được set)
+ */
+uring_t *uring_open(unsigned int depth);
+
+/**
+ * @brief Giải phóng ring (NULL được chấp nhận)
+ */
+void uring_close(uring_t *ring);
+
+/**
+ * @brief Thực hiện cả lô statx(), giữ ring luôn đầy tới khi xong
+ *
+ * Kết quả của mỗi yêu cầu nằm trong requests[i].result; thứ tự hoàn
+ * thành không ảnh hưởng tới thứ tự trong mảng.
+ *
+ * @param ring Ring của luồng gọi
+ * @param requests Mảng yêu cầu
+ * @param count Số yêu cầu
+ * @return 0 nếu cả lô đã được xử lý, -1 nếu io_uring_enter() lỗi (các
+ *         yêu cầu kernel đã nhận được chờ xong trước khi trả về; yêu cầu
+ *         chưa có kết quả có result = -errno)
+ */
+int uring_statx_batch(uring_t *ring, stat_request_t *requests, size_t count);
+
+/**
+ * @brief Thực hiện cả lô bằng statx() đồng bộ (dự phòng khi không có io_uring)
+ */
+void sync_statx_batch(stat_request_t *requests, size_t count);
+
+#endif /* FILESTAT_URING_H */
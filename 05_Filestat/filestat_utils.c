@@ -3,7 +3,7 @@
  * @brief Module chứa các hàm tiện ích cho filestat
  * 
  * Các hàm trong module này xử lý việc phân tích và định dạng
- * thông tin metadata từ struct stat
+ * thông tin metadata từ struct statx
  */
 
 #include "filestat.h"
@@ -56,6 +56,47 @@ const char* get_file_type(mode_t mode)
     return "Unknown";
 }
 
+/* ======================== FIELD SELECTION ======================== */
+
+/**
+ * @brief Chuyển tập trường cần in thành mask cho statx()
+ * 
+ * Mỗi FIELD_* tương ứng với đúng một bit STATX_*. FIELD_ATTRS không cần
+ * bit nào: stx_attributes luôn được trả về.
+ * 
+ * @param fields Tổ hợp các FIELD_*
+ * @return Mask STATX_* tương ứng
+ */
+unsigned int fields_to_statx_mask(unsigned int fields)
+{
+    static const struct {
+        unsigned int field;
+        unsigned int statx_bit;
+    } map[] = {
+        { FIELD_TYPE,   STATX_TYPE   },
+        { FIELD_SIZE,   STATX_SIZE   },
+        { FIELD_MTIME,  STATX_MTIME  },
+        { FIELD_MODE,   STATX_MODE   },
+        { FIELD_NLINK,  STATX_NLINK  },
+        { FIELD_UID,    STATX_UID    },
+        { FIELD_GID,    STATX_GID    },
+        { FIELD_INO,    STATX_INO    },
+        { FIELD_BLOCKS, STATX_BLOCKS },
+        { FIELD_ATIME,  STATX_ATIME  },
+        { FIELD_CTIME,  STATX_CTIME  },
+        { FIELD_BTIME,  STATX_BTIME  },
+        { FIELD_MNT_ID, STATX_MNT_ID },
+    };
+    unsigned int mask = 0;
+    
+    for (size_t i = 0; i < sizeof(map) / sizeof(map[0]); i++) {
+        if (fields & map[i].field) {
+            mask |= map[i].statx_bit;
+        }
+    }
+    return mask;
+}
+
 /* ======================== TIME FORMATTING ======================== */
 
 /**
@@ -93,46 +134,178 @@ void format_time(time_t mtime, char *buffer, size_t buffer_size)
     strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", time_info);
 }
 
+/**
+ * @brief Định dạng kích thước dạng ngắn giống du -h
+ *
+ * Dưới 1024 byte in nguyên số byte; lớn hơn thì chia 1024 tới đơn vị
+ * phù hợp, một chữ số thập phân khi nhỏ hơn 10 ("4.0K", "1.5G", "512").
+ *
+ * @param bytes Số byte
+ * @param buffer Buffer để lưu chuỗi kết quả
+ * @param buffer_size Kích thước của buffer
+ */
+void format_human(uint64_t bytes, char *buffer, size_t buffer_size)
+{
+    static const char units[] = "KMGTPE";
+    double value = (double)bytes;
+    size_t unit = 0;
+
+    if (bytes < 1024) {
+        snprintf(buffer, buffer_size, "%llu", (unsigned long long)bytes);
+        return;
+    }
+    value /= 1024;
+    while (value >= 1024 && unit + 1 < sizeof(units) - 1) {
+        value /= 1024;
+        unit++;
+    }
+    snprintf(buffer, buffer_size, value < 10 ? "%.1f%c" : "%.0f%c", value, units[unit]);
+}
+
+/* ======================== ATTRIBUTES ======================== */
+
+/* Tên các thuộc tính statx, theo thứ tự in */
+const attribute_name_t attribute_names[NUM_ATTRIBUTE_NAMES] = {
+    { STATX_ATTR_COMPRESSED, "compressed" },
+    { STATX_ATTR_IMMUTABLE,  "immutable"  },
+    { STATX_ATTR_APPEND,     "append"     },
+    { STATX_ATTR_NODUMP,     "nodump"     },
+    { STATX_ATTR_ENCRYPTED,  "encrypted"  },
+    { STATX_ATTR_AUTOMOUNT,  "automount"  },
+    { STATX_ATTR_MOUNT_ROOT, "mount-root" },
+    { STATX_ATTR_VERITY,     "verity"     },
+    { STATX_ATTR_DAX,        "dax"        },
+};
+
+/**
+ * @brief Liệt kê các thuộc tính statx của file
+ * 
+ * Chỉ những thuộc tính có trong supported mới có ý nghĩa: bit 0 của
+ * một thuộc tính filesystem không hỗ trợ không có nghĩa là "không có".
+ * 
+ * @param attributes stx_attributes
+ * @param supported stx_attributes_mask
+ * @param buffer Buffer để lưu chuỗi kết quả, ví dụ "immutable, append"
+ * @param buffer_size Kích thước của buffer
+ */
+void format_attributes(uint64_t attributes, uint64_t supported,
+                       char *buffer, size_t buffer_size)
+{
+    size_t len = 0;
+    
+    buffer[0] = '\0';
+    for (size_t i = 0; i < NUM_ATTRIBUTE_NAMES; i++) {
+        if ((attributes & supported & attribute_names[i].bit) && len < buffer_size) {
+            len += (size_t)snprintf(buffer + len, buffer_size - len, "%s%s",
+                                    len > 0 ? ", " : "", attribute_names[i].name);
+        }
+    }
+    if (len == 0) {
+        snprintf(buffer, buffer_size, supported != 0 ? "none" : "Not supported");
+    }
+}
+
 /* ======================== OUTPUT PRINTING ======================== */
 
+/**
+ * @brief In một dòng thời gian, hoặc ghi chú nếu filesystem không trả về trường đó
+ */
+static void print_time_line(writer_t *out, const char *label, const struct statx *file_stat,
+                            unsigned int statx_bit, const struct statx_timestamp *ts)
+{
+    char time_buffer[TIME_BUFFER_SIZE];
+    
+    if (file_stat->stx_mask & statx_bit) {
+        format_time((time_t)ts->tv_sec, time_buffer, sizeof(time_buffer));
+        writer_printf(out, "%s%s\n", label, time_buffer);
+    } else {
+        writer_printf(out, "%sNot available\n", label);
+    }
+}
+
 /**
  * @brief In thông tin metadata của file ra console
  * 
- * Hiển thị các thông tin:
- * - File Path: Đường dẫn file
+ * Hiển thị các trường được yêu cầu trong fields, theo thứ tự:
+ * - File Path: Đường dẫn file (luôn in)
  * - File Type: Loại file (Regular, Directory, Symbolic Link, etc.)
  * - Size: Kích thước file (bytes)
  * - Last Modified: Thời gian sửa đổi cuối cùng
+ * - Các trường mở rộng (-a): quyền, link, chủ sở hữu, inode, block,
+ *   atime/ctime, birth time, mount ID, thuộc tính
  * 
+ * @param out Writer nhận output (không in thẳng ra stdout)
  * @param filepath Đường dẫn file người dùng nhập
- * @param file_stat Con trỏ đến struct stat chứa metadata
+ * @param file_stat Con trỏ đến struct statx chứa metadata
+ * @param fields Các trường cần in (FIELD_*)
  */
-void print_file_info(const char *filepath, const struct stat *file_stat)
+void print_file_info(writer_t *out, const char *filepath, const struct statx *file_stat,
+                     unsigned int fields)
 {
-    char time_buffer[TIME_BUFFER_SIZE];
+    char attr_buffer[ATTR_BUFFER_SIZE];
     
     /* In đường dẫn file */
-    printf("========================================\n");
-    printf("       FILE METADATA INFORMATION        \n");
-    printf("========================================\n");
+    writer_puts(out, "========================================\n");
+    writer_puts(out, "       FILE METADATA INFORMATION        \n");
+    writer_puts(out, "========================================\n");
     
-    printf("File Path:     %s\n", filepath);
+    writer_printf(out, "File Path:     %s\n", filepath);
     
     /* In loại file - sử dụng hàm get_file_type() */
-    printf("File Type:     %s\n", get_file_type(file_stat->st_mode));
+    if (fields & FIELD_TYPE) {
+        writer_printf(out, "File Type:     %s\n", get_file_type(file_stat->stx_mode));
+    }
     
-    /* 
-     * In kích thước file
-     * st_size có kiểu off_t, dùng %ld để in
-     */
-    printf("Size:          %ld bytes\n", (long)file_stat->st_size);
+    /* In kích thước file (stx_size là __u64) */
+    if (fields & FIELD_SIZE) {
+        writer_printf(out, "Size:          %llu bytes\n", (unsigned long long)file_stat->stx_size);
+    }
     
-    /* 
-     * In thời gian sửa đổi cuối cùng
-     * st_mtime là modification time của file
-     */
-    format_time(file_stat->st_mtime, time_buffer, sizeof(time_buffer));
-    printf("Last Modified: %s\n", time_buffer);
+    /* In thời gian sửa đổi cuối cùng */
+    if (fields & FIELD_MTIME) {
+        print_time_line(out, "Last Modified: ", file_stat, STATX_MTIME, &file_stat->stx_mtime);
+    }
+    
+    /* Các trường mở rộng */
+    if (fields & FIELD_MODE) {
+        writer_printf(out, "Permissions:   %04o\n", file_stat->stx_mode & 07777);
+    }
+    if (fields & FIELD_NLINK) {
+        writer_printf(out, "Links:         %u\n", file_stat->stx_nlink);
+    }
+    if (fields & FIELD_UID) {
+        writer_printf(out, "Owner UID:     %u\n", file_stat->stx_uid);
+    }
+    if (fields & FIELD_GID) {
+        writer_printf(out, "Owner GID:     %u\n", file_stat->stx_gid);
+    }
+    if (fields & FIELD_INO) {
+        writer_printf(out, "Inode:         %llu\n", (unsigned long long)file_stat->stx_ino);
+    }
+    if (fields & FIELD_BLOCKS) {
+        writer_printf(out, "Blocks:        %llu (512 bytes)\n", (unsigned long long)file_stat->stx_blocks);
+    }
+    if (fields & FIELD_ATIME) {
+        print_time_line(out, "Last Access:   ", file_stat, STATX_ATIME, &file_stat->stx_atime);
+    }
+    if (fields & FIELD_CTIME) {
+        print_time_line(out, "Last Change:   ", file_stat, STATX_CTIME, &file_stat->stx_ctime);
+    }
+    if (fields & FIELD_BTIME) {
+        print_time_line(out, "Created:       ", file_stat, STATX_BTIME, &file_stat->stx_btime);
+    }
+    if (fields & FIELD_MNT_ID) {
+        if (file_stat->stx_mask & STATX_MNT_ID) {
+            writer_printf(out, "Mount ID:      %llu\n", (unsigned long long)file_stat->stx_mnt_id);
+        } else {
+            writer_printf(out, "Mount ID:      Not available\n");
+        }
+    }
+    if (fields & FIELD_ATTRS) {
+        format_attributes(file_stat->stx_attributes, file_stat->stx_attributes_mask,
+                          attr_buffer, sizeof(attr_buffer));
+        writer_printf(out, "Attributes:    %s\n", attr_buffer);
+    }
     
-    printf("========================================\n");
+    writer_puts(out, "========================================\n");
 }
@@ -0,0 +1,1200 @@
+/**
+ * @file filestat_walk.c
+ * @brief Thread pool work-stealing duyệt cây thư mục bằng openat/getdents64/statx
+ *
+ * Mỗi thư mục là một walk_dir_t giữ đường dẫn đầy đủ (chỉ dùng để in) và
+ * con trỏ tới thư mục cha. File descriptor của thư mục cha được giữ mở
+ * bằng reference count cho tới khi mọi thư mục con đã openat() xong, nên
+ * số fd mở chỉ tỉ lệ với số thư mục còn thư mục con đang chờ chứ không
+ * phải với kích thước cây.
+ *
+ * Với --snapshot/--diff, mỗi node còn mang hash path tương đối và vị trí
+ * của thư mục trong snapshot cũ/mới (xem filestat_snapshot.h).
+ */
+
+#include "filestat_walk.h"
+#include "filestat_uring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+/* ======================== CONSTANTS ======================== */
+#define WALK_DENTS_SIZE   (64 * 1024)   /* Buffer cho một lần gọi getdents64() */
+#define WALK_OUT_SIZE     (64 * 1024)   /* Buffer output của mỗi luồng */
+#define WALK_DEQUE_INIT   256           /* Dung lượng ban đầu của hàng đợi (lũy thừa 2) */
+#define WALK_DIRENT_MIN   24            /* Bản ghi getdents64() nhỏ nhất */
+#define WALK_BATCH_MAX    (WALK_DENTS_SIZE / WALK_DIRENT_MIN)   /* Entry tối đa mỗi lô */
+
+/* Các trường statx() mà bảng tổng kết (-s) dùng: loại, kích thước, block */
+#define WALK_STATX_MASK   (STATX_TYPE | STATX_SIZE | STATX_BLOCKS)
+/* --du cần thêm số link và inode để nhận ra hard link */
+#define WALK_DU_MASK      (WALK_STATX_MASK | STATX_NLINK | STATX_INO)
+/* --dupes cần inode để bỏ các hard link của cùng một file */
+#define WALK_DUPES_MASK   (WALK_STATX_MASK | STATX_INO)
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Bản ghi trả về bởi getdents64() (glibc không khai báo kiểu này)
+ */
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/**
+ * @brief Một thư mục đang chờ đọc hoặc còn thư mục con chưa mở
+ *
+ * refs = 1 (bản thân, tới khi đọc xong) + số thư mục con chưa openat().
+ * Với --du, node còn sống sau khi đóng fd cho tới khi cả cây con xong:
+ * subtree = 1 (bản thân, tới khi đọc xong) + số thư mục con chưa xong.
+ */
+typedef struct walk_dir {
+    struct walk_dir *parent;   /* NULL với thư mục gốc hoặc sau khi đã openat() */
+    struct walk_dir *up;       /* --du: thư mục cha, tới khi cây con xong */
+    int fd;                    /* -1 tới khi được mở */
+    atomic_uint refs;
+    atomic_uint subtree;
+    bool aggregate;            /* --du: giải phóng trong complete_dir(), không phải dir_release() */
+    atomic_uint_least64_t disk_bytes;   /* --du: tổng của cây con đã xong */
+    atomic_uint_least64_t bytes;
+    atomic_uint_least64_t files;
+    uint64_t hash;             /* Snapshot: hash path tương đối (xem snap_hash_child()) */
+    uint64_t record;           /* --snapshot: id bản ghi, thư mục cha của các entry con */
+    uint32_t old;              /* --diff: vị trí trong snapshot cũ, SNAP_NONE nếu là thư mục mới */
+    bool unchanged;            /* --diff: đọc danh sách entry từ snapshot thay vì getdents64() */
+    size_t path_len;
+    size_t name_off;           /* Vị trí tên thư mục trong path, dùng cho openat() */
+    char path[];
+} walk_dir_t;
+
+struct walker;
+
+/**
+ * @brief Trạng thái riêng của một luồng
+ *
+ * Căn theo cache line để hàng đợi và bộ đếm của các luồng khác nhau
+ * không chia sẻ cache line (false sharing).
+ */
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;   /* Bảo vệ hàng đợi (chủ và kẻ trộm) */
+    walk_dir_t **items;                  /* Hàng đợi vòng, head = đầu (bị trộm) */
+    size_t head;
+    size_t count;
+    size_t cap;
+    walk_stats_t stats;                  /* Chỉ luồng này ghi */
+    char *dents;                         /* Buffer getdents64() */
+    writer_t out;                        /* Output, flush dưới walker->out_lock */
+    uring_t *ring;                       /* NULL: statx() đồng bộ */
+    stat_request_t *batch;               /* Yêu cầu của lô hiện tại (io_uring) */
+    struct statx *batch_stx;
+    du_entry_t acc;                      /* --du: file của thư mục đang đọc */
+    topn_t top_dirs;                     /* --du: heap riêng của luồng */
+    topn_t top_files;
+    uint64_t hardlinks;
+    struct walker *walker;
+    unsigned id;
+    pthread_t thread;
+} walk_worker_t;
+
+/**
+ * @brief Trạng thái chung của một lần duyệt
+ */
+typedef struct walker {
+    walk_worker_t *workers;
+    unsigned num_workers;
+    bool summary_only;
+    output_format_t format;
+    unsigned int fields;
+    bin_sink_t *bin;
+    unsigned int mask;           /* Mask statx() cho mọi entry */
+    du_report_t *du;             /* --du: nhận tổng và top-N */
+    inode_set_t *inodes;         /* --du: inode có nhiều hard link đã gặp */
+    snapshot_t *old;             /* --diff: snapshot để so sánh */
+    snap_builder_t *build;       /* --snapshot: snapshot mới */
+    bool verify_files;           /* --diff: statx() cả file trong thư mục không đổi */
+    dupe_set_t *dupes;           /* --dupes: regular file, mỗi luồng một phần */
+    filter_t *where;             /* --where: entry được in/đếm */
+    filter_t *prune;             /* --prune: thư mục không đi vào */
+    atomic_size_t pending;       /* Thư mục đang chờ hoặc đang đọc */
+    atomic_size_t queued;        /* Thư mục trong (hoặc đang được push vào) các hàng đợi */
+    atomic_uint sleepers;        /* Số luồng đang chờ việc */
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    pthread_mutex_t out_lock;    /* Giữ mỗi lần flush nguyên vẹn trên stdout */
+} walker_t;
+
+/* ======================== DIRECTORY NODES ======================== */
+
+/**
+ * @brief Tạo node cho thư mục name nằm trong parent
+ */
+static walk_dir_t *dir_new(walk_dir_t *parent, const char *name, size_t name_len)
+{
+    size_t sep = 0;
+    size_t base = 0;
+    walk_dir_t *dir;
+
+    if (parent != NULL) {
+        base = parent->path_len;
+        sep = (base > 0 && parent->path[base - 1] == '/') ? 0 : 1;
+    }
+
+    dir = malloc(sizeof(*dir) + base + sep + name_len + 1);
+    if (dir == NULL) {
+        return NULL;
+    }
+    if (parent != NULL) {
+        memcpy(dir->path, parent->path, base);
+        if (sep) {
+            dir->path[base] = '/';
+        }
+        atomic_fetch_add(&parent->refs, 1);
+        if (parent->aggregate) {
+            atomic_fetch_add(&parent->subtree, 1);
+        }
+    }
+    memcpy(dir->path + base + sep, name, name_len);
+    dir->path[base + sep + name_len] = '\0';
+    dir->parent = parent;
+    dir->up = parent;
+    dir->aggregate = parent != NULL && parent->aggregate;
+    dir->fd = -1;
+    dir->hash = SNAP_ROOT_HASH;
+    dir->record = SNAP_NO_RECORD;
+    dir->old = SNAP_NONE;
+    dir->unchanged = false;
+    dir->path_len = base + sep + name_len;
+    dir->name_off = base + sep;
+    atomic_init(&dir->refs, 1);
+    atomic_init(&dir->subtree, 1);
+    atomic_init(&dir->disk_bytes, 0);
+    atomic_init(&dir->bytes, 0);
+    atomic_init(&dir->files, 0);
+    return dir;
+}
+
+/**
+ * @brief Bỏ một tham chiếu; đóng fd và giải phóng node khi hết tham chiếu
+ */
+static void dir_release(walk_dir_t *dir)
+{
+    if (atomic_fetch_sub(&dir->refs, 1) == 1) {
+        if (dir->fd >= 0) {
+            close(dir->fd);
+            dir->fd = -1;
+        }
+        if (!dir->aggregate) {
+            free(dir);
+        }
+    }
+}
+
+/* ======================== AGGREGATION (--du) ======================== */
+
+/**
+ * @brief Một thư mục (--du) đã đọc xong hoặc một thư mục con đã xong
+ *
+ * Khi cả cây con của dir đã xong, tổng của nó được cộng vào thư mục cha
+ * bằng phép cộng atomic (không khóa) và dir được đưa vào heap top-N;
+ * lặp lên trên chừng nào thư mục cha cũng vừa xong. Phép trừ subtree
+ * (seq_cst) bảo đảm luồng kết thúc thư mục cha thấy mọi phép cộng của
+ * các thư mục con.
+ */
+static void complete_dir(walk_worker_t *w, walk_dir_t *dir)
+{
+    while (dir != NULL && atomic_fetch_sub(&dir->subtree, 1) == 1) {
+        walk_dir_t *up = dir->up;
+        du_entry_t entry;
+
+        entry.disk_bytes = atomic_load_explicit(&dir->disk_bytes, memory_order_relaxed);
+        entry.bytes = atomic_load_explicit(&dir->bytes, memory_order_relaxed);
+        entry.files = atomic_load_explicit(&dir->files, memory_order_relaxed);
+        entry.path = NULL;
+
+        if (up != NULL) {
+            record_path_t path = { NULL, 0, dir->path, dir->path_len };
+
+            atomic_fetch_add_explicit(&up->disk_bytes, entry.disk_bytes, memory_order_relaxed);
+            atomic_fetch_add_explicit(&up->bytes, entry.bytes, memory_order_relaxed);
+            atomic_fetch_add_explicit(&up->files, entry.files, memory_order_relaxed);
+            if (topn_offer(&w->top_dirs, &entry, &path) != 0) {
+                fprintf(stderr, "Error: Out of memory at %s\n", dir->path);
+                w->stats.errors++;
+            }
+        } else {
+            /* Thư mục gốc: tổng của cả cây (path vẫn trỏ tới tham số root) */
+            w->walker->du->total.disk_bytes = entry.disk_bytes;
+            w->walker->du->total.bytes = entry.bytes;
+            w->walker->du->total.files = entry.files;
+        }
+        free(dir);
+        dir = up;
+    }
+}
+
+/**
+ * @brief Cộng một entry không phải thư mục vào thư mục đang đọc
+ *
+ * Inode có nhiều hard link chỉ được tính ở lần gặp đầu tiên.
+ */
+static void aggregate_file(walk_worker_t *w, const walk_dir_t *dir, const char *name,
+                           size_t name_len, const struct statx *st)
+{
+    du_entry_t entry = { st->stx_blocks * 512, st->stx_size, 1, NULL };
+
+    if (st->stx_nlink > 1 && !S_ISDIR(st->stx_mode)) {
+        uint64_t dev = ((uint64_t)st->stx_dev_major << 32) | st->stx_dev_minor;
+        if (!inode_set_insert(w->walker->inodes, dev, st->stx_ino)) {
+            w->hardlinks++;
+            return;
+        }
+    }
+    w->acc.disk_bytes += entry.disk_bytes;
+    w->acc.bytes += entry.bytes;
+    w->acc.files++;
+
+    if (topn_wants(&w->top_files, entry.disk_bytes)) {
+        record_path_t path = { NULL, 0, name, name_len };
+        if (dir != NULL) {
+            path.dir = dir->path;
+            path.dir_len = dir->path_len;
+        }
+        if (topn_offer(&w->top_files, &entry, &path) != 0) {
+            fprintf(stderr, "Error: Out of memory at %s\n", dir != NULL ? dir->path : name);
+            w->stats.errors++;
+        }
+    }
+}
+
+/**
+ * @brief Cộng các file vừa đọc (w->acc) vào thư mục rồi đánh dấu nó đã đọc xong
+ */
+static void finish_aggregate(walk_worker_t *w, walk_dir_t *dir)
+{
+    atomic_fetch_add_explicit(&dir->disk_bytes, w->acc.disk_bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&dir->bytes, w->acc.bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&dir->files, w->acc.files, memory_order_relaxed);
+    w->acc.disk_bytes = 0;
+    w->acc.bytes = 0;
+    w->acc.files = 0;
+    complete_dir(w, dir);
+}
+
+/* ======================== WORK-STEALING DEQUE ======================== */
+
+static bool deque_grow(walk_worker_t *w)
+{
+    size_t cap = w->cap ? w->cap * 2 : WALK_DEQUE_INIT;
+    walk_dir_t **items = malloc(cap * sizeof(*items));
+    if (items == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < w->count; i++) {
+        items[i] = w->items[(w->head + i) & (w->cap - 1)];
+    }
+    free(w->items);
+    w->items = items;
+    w->head = 0;
+    w->cap = cap;
+    return true;
+}
+
+/**
+ * @brief Chủ hàng đợi thêm việc vào đuôi
+ */
+static bool deque_push(walk_worker_t *w, walk_dir_t *dir)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->count == w->cap) {
+        ok = deque_grow(w);
+    }
+    if (ok) {
+        w->items[(w->head + w->count) & (w->cap - 1)] = dir;
+        w->count++;
+    }
+    pthread_mutex_unlock(&w->lock);
+    return ok;
+}
+
+/**
+ * @brief Chủ hàng đợi lấy việc mới nhất (duyệt gần như theo chiều sâu)
+ */
+static walk_dir_t *deque_pop(walk_worker_t *w)
+{
+    walk_dir_t *dir = NULL;
+
+    pthread_mutex_lock(&w->lock);
+    if (w->count > 0) {
+        w->count--;
+        dir = w->items[(w->head + w->count) & (w->cap - 1)];
+    }
+    pthread_mutex_unlock(&w->lock);
+    return dir;
+}
+
+/**
+ * @brief Luồng khác lấy trộm việc cũ nhất (thường là cây con lớn nhất)
+ */
+static walk_dir_t *deque_steal(walk_worker_t *w)
+{
+    walk_dir_t *dir = NULL;
+
+    if (pthread_mutex_trylock(&w->lock) != 0) {
+        return NULL;
+    }
+    if (w->count > 0) {
+        dir = w->items[w->head];
+        w->head = (w->head + 1) & (w->cap - 1);
+        w->count--;
+    }
+    pthread_mutex_unlock(&w->lock);
+    return dir;
+}
+
+/* ======================== SCHEDULING ======================== */
+
+/**
+ * @brief Đưa một thư mục vào hàng đợi của luồng w và đánh thức luồng rảnh
+ */
+static void schedule_dir(walk_worker_t *w, walk_dir_t *dir)
+{
+    walker_t *wk = w->walker;
+
+    /*
+     * queued được tăng TRƯỚC khi push: một luồng khác có thể trộm thư mục
+     * ngay sau push và giảm queued, nên tăng sau sẽ làm nó tạm thời tràn
+     * xuống SIZE_MAX.
+     */
+    atomic_fetch_add(&wk->pending, 1);
+    atomic_fetch_add(&wk->queued, 1);
+    if (!deque_push(w, dir)) {
+        atomic_fetch_sub(&wk->queued, 1);
+        fprintf(stderr, "Error: Out of memory, skipping %s\n", dir->path);
+        w->stats.errors++;
+        if (dir->parent != NULL) {
+            dir_release(dir->parent);
+        }
+        if (dir->aggregate) {
+            complete_dir(w, dir);
+        } else {
+            free(dir);
+        }
+        atomic_fetch_sub(&wk->pending, 1);
+        return;
+    }
+
+    if (atomic_load(&wk->sleepers) > 0) {
+        pthread_mutex_lock(&wk->idle_lock);
+        pthread_cond_signal(&wk->idle_cond);
+        pthread_mutex_unlock(&wk->idle_lock);
+    }
+}
+
+/**
+ * @brief Đánh dấu một thư mục đã đọc xong; báo cho mọi luồng khi hết việc
+ */
+static void finish_dir(walker_t *wk)
+{
+    if (atomic_fetch_sub(&wk->pending, 1) == 1) {
+        pthread_mutex_lock(&wk->idle_lock);
+        pthread_cond_broadcast(&wk->idle_cond);
+        pthread_mutex_unlock(&wk->idle_lock);
+    }
+}
+
+/**
+ * @brief Lấy thư mục tiếp theo: của mình trước, rồi trộm, rồi chờ
+ * @return NULL khi toàn bộ cây đã được đọc
+ */
+static walk_dir_t *next_dir(walk_worker_t *w)
+{
+    walker_t *wk = w->walker;
+
+    for (;;) {
+        walk_dir_t *dir = deque_pop(w);
+
+        for (unsigned i = 1; dir == NULL && i < wk->num_workers; i++) {
+            dir = deque_steal(&wk->workers[(w->id + i) % wk->num_workers]);
+        }
+        if (dir != NULL) {
+            atomic_fetch_sub(&wk->queued, 1);
+            return dir;
+        }
+        if (atomic_load(&wk->pending) == 0) {
+            return NULL;
+        }
+
+        /*
+         * sleepers được tăng trước khi kiểm tra queued, còn schedule_dir()
+         * tăng queued (trước cả push) rồi mới kiểm tra sleepers: một trong
+         * hai bên chắc chắn thấy bên kia, nên không có việc nào bị bỏ quên.
+         * queued > 0 trong lúc push chưa xong chỉ làm luồng này thử lấy lại.
+         */
+        pthread_mutex_lock(&wk->idle_lock);
+        atomic_fetch_add(&wk->sleepers, 1);
+        while (atomic_load(&wk->queued) == 0 && atomic_load(&wk->pending) != 0) {
+            pthread_cond_wait(&wk->idle_cond, &wk->idle_lock);
+        }
+        atomic_fetch_sub(&wk->sleepers, 1);
+        pthread_mutex_unlock(&wk->idle_lock);
+    }
+}
+
+/* ======================== OUTPUT ======================== */
+
+/**
+ * @brief Một bản ghi quá lớn cho buffer của luồng: định dạng vào buffer
+ *        riêng vừa đủ rồi ghi một lần dưới out_lock
+ */
+static void emit_large(walk_worker_t *w, writer_t *out, const record_path_t *path,
+                       const struct statx *st, size_t need)
+{
+    walker_t *wk = w->walker;
+    writer_t big;
+
+    if (writer_init(&big, out->fd, need) != 0) {
+        fprintf(stderr, "Error: Out of memory, skipping %.*s\n", (int)path->name_len, path->name);
+        w->stats.errors++;
+        return;
+    }
+    big.lock = &wk->out_lock;
+    writer_flush(out);
+    format_record(&big, wk->format, wk->fields, path, st);
+    writer_close(&big);
+}
+
+/**
+ * @brief In một entry (<dir>/<name>) theo định dạng đã chọn
+ *
+ * Buffer được flush trước nếu không đủ chỗ cho cả bản ghi, nên một bản
+ * ghi không bao giờ bị chia giữa hai lần flush và output của các luồng
+ * không xen vào giữa bản ghi.
+ */
+static void emit_entry(walk_worker_t *w, writer_t *out, const struct statx *st,
+                       const walk_dir_t *dir, const char *name, size_t name_len)
+{
+    walker_t *wk = w->walker;
+    record_path_t path = { NULL, 0, name, name_len };
+    size_t need;
+
+    if (dir != NULL) {
+        path.dir = dir->path;
+        path.dir_len = dir->path_len;
+    }
+    if (wk->format == FORMAT_BIN) {
+        bin_sink_add(wk->bin, out, &path, st);
+        return;
+    }
+
+    need = FORMAT_RECORD_MAX + FORMAT_ESCAPE_MAX * (path.dir_len + name_len + 1);
+    if (need > out->cap) {
+        /* Đường dẫn quá dài cho buffer: vẫn giữ bản ghi nguyên vẹn */
+        emit_large(w, out, &path, st, need);
+        return;
+    }
+    if (out->len + need > out->cap) {
+        writer_flush(out);
+    }
+    format_record(out, wk->format, wk->fields, &path, st);
+}
+
+/* ======================== SNAPSHOT (--snapshot, --diff) ======================== */
+
+/**
+ * @brief Liên kết của một entry với snapshot cũ và mới
+ */
+typedef struct {
+    uint64_t hash;           /* Hash path tương đối */
+    uint64_t record;         /* Id bản ghi trong snapshot mới */
+    uint32_t old;            /* Vị trí trong snapshot cũ, SNAP_NONE nếu mới */
+    bool unchanged;          /* Thư mục không đổi danh sách entry */
+} snap_link_t;
+
+/**
+ * @brief In một dòng thay đổi "<tag> <dir>/<name>" (--diff)
+ *
+ * Như emit_entry(), dòng không bao giờ bị chia giữa hai lần flush.
+ */
+static void emit_change(walk_worker_t *w, char tag, const walk_dir_t *dir, const char *name,
+                        size_t name_len)
+{
+    writer_t *out = &w->out;
+    writer_t big;
+    const char prefix[2] = { tag, ' ' };
+    size_t need = sizeof(prefix) + name_len + 1 + (dir != NULL ? dir->path_len + 1 : 0);
+
+    if (need > out->cap) {
+        /* Đường dẫn dài hơn buffer: ghép cả dòng rồi ghi một lần */
+        if (writer_init(&big, out->fd, need) != 0) {
+            fprintf(stderr, "Error: Out of memory, skipping %.*s\n", (int)name_len, name);
+            w->stats.errors++;
+            return;
+        }
+        big.lock = &w->walker->out_lock;
+        writer_flush(out);
+        out = &big;
+    } else if (out->len + need > out->cap) {
+        writer_flush(out);
+    }
+    writer_write(out, prefix, sizeof(prefix));
+    if (dir != NULL) {
+        writer_write(out, dir->path, dir->path_len);
+        if (dir->path_len > 0 && dir->path[dir->path_len - 1] != '/') {
+            writer_write(out, "/", 1);
+        }
+    }
+    writer_write(out, name, name_len);
+    writer_write(out, "\n", 1);
+    if (out == &big) {
+        writer_close(&big);
+    }
+}
+
+/**
+ * @brief So một entry với snapshot cũ và thêm nó vào snapshot mới
+ * @param dir Thư mục chứa entry, NULL với gốc (tên trong snapshot là "")
+ */
+static snap_link_t track_entry(walk_worker_t *w, const walk_dir_t *dir, const char *name,
+                               size_t name_len, const struct statx *st)
+{
+    walker_t *wk = w->walker;
+    snap_link_t link = { SNAP_ROOT_HASH, SNAP_NO_RECORD, SNAP_NONE, false };
+    const char *key = dir != NULL ? name : "";
+    size_t key_len = dir != NULL ? name_len : 0;
+
+    if (dir != NULL) {
+        link.hash = snap_hash_child(dir->hash, name, name_len);
+    }
+    if (wk->old != NULL) {
+        /* Con của một thư mục mới chắc chắn cũng mới: không cần tra */
+        if (dir == NULL || dir->old != SNAP_NONE) {
+            link.old = snapshot_lookup(wk->old, link.hash, key, key_len);
+        }
+        if (link.old == SNAP_NONE) {
+            emit_change(w, 'A', dir, name, name_len);
+            w->stats.added++;
+        } else {
+            const snap_entry_t *e = &wk->old->entries[link.old];
+
+            snapshot_mark(wk->old, link.old);
+            if (snapshot_changed(e, st)) {
+                emit_change(w, 'M', dir, name, name_len);
+                w->stats.modified++;
+            }
+            link.unchanged = snapshot_dir_unchanged(e, st);
+        }
+    }
+    if (wk->build != NULL) {
+        link.record = snap_builder_add(wk->build, w->id, link.hash,
+                                       dir != NULL ? dir->record : SNAP_NO_RECORD,
+                                       key, key_len, st);
+        if (link.record == SNAP_NO_RECORD) {
+            fprintf(stderr, "Error: Out of memory at %s\n", dir != NULL ? dir->path : name);
+            w->stats.errors++;
+        }
+    }
+    return link;
+}
+
+/**
+ * @brief Gán liên kết snapshot cho node của một thư mục
+ */
+static void link_dir(walk_dir_t *dir, const snap_link_t *link)
+{
+    dir->hash = link->hash;
+    dir->record = link->record;
+    dir->old = link->old;
+    dir->unchanged = link->unchanged;
+}
+
+/**
+ * @brief Thêm một regular file vào tập --dupes (phần của luồng w)
+ */
+static void collect_file(walk_worker_t *w, const walk_dir_t *dir, const char *name,
+                         size_t name_len, const struct statx *st)
+{
+    if (dupe_set_add(w->walker->dupes, w->id, dir != NULL ? dir->path : NULL,
+                     dir != NULL ? dir->path_len : 0, name, name_len, st) != 0) {
+        fprintf(stderr, "Error: Out of memory at %s\n", dir != NULL ? dir->path : name);
+        w->stats.errors++;
+    }
+}
+
+/* ======================== TRAVERSAL ======================== */
+
+static void count_entry(walk_stats_t *stats, const struct statx *st)
+{
+    if (S_ISREG(st->stx_mode)) {
+        stats->files++;
+    } else if (S_ISDIR(st->stx_mode)) {
+        stats->dirs++;
+    } else if (S_ISLNK(st->stx_mode)) {
+        stats->symlinks++;
+    } else {
+        stats->others++;
+    }
+    stats->bytes += st->stx_size;
+    stats->disk_bytes += st->stx_blocks * 512;
+}
+
+static void report_error(walk_worker_t *w, const char *what, const walk_dir_t *dir,
+                         const char *name, int err)
+{
+    fprintf(stderr, "Error: %s %s%s%s: %s\n", what, dir->path,
+            name != NULL ? "/" : "", name != NULL ? name : "", strerror(err));
+    w->stats.errors++;
+}
+
+/**
+ * @brief Xếp hàng một thư mục con chỉ để đi vào (không đếm, không in)
+ */
+static void descend(walk_worker_t *w, walk_dir_t *dir, const char *name, size_t name_len)
+{
+    walk_dir_t *child = dir_new(dir, name, name_len);
+
+    if (child == NULL) {
+        report_error(w, "Out of memory at", dir, name, ENOMEM);
+        return;
+    }
+    schedule_dir(w, child);
+}
+
+/**
+ * @brief Áp dụng --prune và --where cho một entry
+ *
+ * Khi entry->stx == NULL (chỉ có tên và d_type), chỉ quyết định nếu biểu
+ * thức đã đủ: thư mục khớp --prune bị bỏ, entry chắc chắn không khớp
+ * --where bị bỏ (thư mục vẫn được đi vào) mà không cần statx().
+ *
+ * @return true nếu entry được xử lý tiếp, false nếu đã xong với nó
+ */
+static bool filter_entry(walk_worker_t *w, walk_dir_t *dir, const filter_entry_t *entry)
+{
+    walker_t *wk = w->walker;
+    mode_t type = entry->stx != NULL ? (entry->stx->stx_mode & S_IFMT) : entry->type;
+    filter_result_t match;
+
+    if (entry->stx == NULL && type == 0) {
+        return true;    /* DT_UNKNOWN: có thể là thư mục, phải statx() */
+    }
+    if (wk->prune != NULL && S_ISDIR(type) && filter_eval(wk->prune, entry) == FILTER_TRUE) {
+        w->stats.pruned++;
+        return false;
+    }
+    if (wk->where == NULL) {
+        return true;
+    }
+    match = filter_eval(wk->where, entry);
+    if (match == FILTER_TRUE || (match == FILTER_UNKNOWN && entry->stx == NULL)) {
+        return true;
+    }
+    w->stats.filtered++;
+    w->stats.unstated += entry->stx == NULL;
+    if (S_ISDIR(type)) {
+        descend(w, dir, entry->name, entry->name_len);
+    }
+    return false;
+}
+
+/**
+ * @brief Đếm, in một entry đã có metadata; xếp hàng nó nếu là thư mục
+ */
+static void process_entry(walk_worker_t *w, walk_dir_t *dir, const char *name,
+                          const struct statx *st)
+{
+    size_t name_len = strlen(name);
+    snap_link_t link = { SNAP_ROOT_HASH, SNAP_NO_RECORD, SNAP_NONE, false };
+
+    if (w->walker->where != NULL || w->walker->prune != NULL) {
+        filter_entry_t entry = { dir->path, dir->path_len, name, name_len, 0, st };
+        if (!filter_entry(w, dir, &entry)) {
+            return;
+        }
+    }
+    count_entry(&w->stats, st);
+    if (!w->walker->summary_only) {
+        emit_entry(w, &w->out, st, dir, name, name_len);
+    }
+    if (w->walker->old != NULL || w->walker->build != NULL) {
+        link = track_entry(w, dir, name, name_len, st);
+    }
+
+    if (S_ISDIR(st->stx_mode)) {
+        walk_dir_t *child = dir_new(dir, name, name_len);
+        if (child == NULL) {
+            report_error(w, "Out of memory at", dir, name, ENOMEM);
+            return;
+        }
+        if (child->aggregate) {
+            /* Chính inode của thư mục con được tính vào cây con của nó, như du */
+            atomic_init(&child->disk_bytes, st->stx_blocks * 512);
+            atomic_init(&child->bytes, st->stx_size);
+        }
+        link_dir(child, &link);
+        schedule_dir(w, child);
+    } else if (w->walker->du != NULL) {
+        aggregate_file(w, dir, name, name_len, st);
+    } else if (w->walker->dupes != NULL && S_ISREG(st->stx_mode)) {
+        collect_file(w, dir, name, name_len, st);
+    }
+}
+
+/**
+ * @brief Xử lý các entry của một lần getdents64()
+ *
+ * Không có io_uring: statx() từng entry ngay khi gặp. Có io_uring: gom
+ * cả lô (tên trỏ thẳng vào buffer dents, còn hợp lệ tới lần đọc tiếp),
+ * gửi một lần rồi xử lý kết quả theo đúng thứ tự của thư mục.
+ */
+static void visit_entries(walk_worker_t *w, walk_dir_t *dir, long bytes)
+{
+    size_t count = 0;
+
+    for (long off = 0; off < bytes; ) {
+        struct linux_dirent64 *d = (struct linux_dirent64 *)(w->dents + off);
+        const char *name = d->d_name;
+
+        off += d->d_reclen;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        if (w->walker->where != NULL || w->walker->prune != NULL) {
+            filter_entry_t entry = { dir->path, dir->path_len, name, strlen(name),
+                                     DTTOIF(d->d_type), NULL };
+            if (!filter_entry(w, dir, &entry)) {
+                continue;
+            }
+        }
+
+        if (w->ring == NULL) {
+            struct statx st;
+            if (statx(dir->fd, name, AT_SYMLINK_NOFOLLOW, w->walker->mask, &st) != 0) {
+                report_error(w, "Cannot stat", dir, name, errno);
+                continue;
+            }
+            process_entry(w, dir, name, &st);
+        } else {
+            stat_request_t *req = &w->batch[count];
+            req->dirfd = dir->fd;
+            req->path = name;
+            req->flags = AT_SYMLINK_NOFOLLOW;
+            req->mask = w->walker->mask;
+            req->stx = &w->batch_stx[count];
+            count++;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+    uring_statx_batch(w->ring, w->batch, count);
+    for (size_t i = 0; i < count; i++) {
+        if (w->batch[i].result < 0) {
+            report_error(w, "Cannot stat", dir, w->batch[i].path, -w->batch[i].result);
+            continue;
+        }
+        process_entry(w, dir, w->batch[i].path, w->batch[i].stx);
+    }
+}
+
+/**
+ * @brief Đọc một thư mục không đổi (--diff) từ snapshot cũ thay vì getdents64()
+ *
+ * Danh sách entry giống hệt snapshot, nên các file chỉ được đánh dấu còn
+ * tồn tại (và chép sang snapshot mới) mà không statx(). Các thư mục con
+ * vẫn được statx() để so sánh và đi tiếp; với --verify-files, mọi entry.
+ */
+static void replay_dir(walk_worker_t *w, walk_dir_t *dir)
+{
+    walker_t *wk = w->walker;
+    snapshot_t *old = wk->old;
+    const snap_entry_t *e = &old->entries[dir->old];
+    const uint32_t *children = old->children + e->child_start;
+    char name[NAME_MAX + 1];
+
+    w->stats.unchanged_dirs++;
+    for (uint32_t i = 0; i < e->child_count; i++) {
+        const snap_entry_t *child = &old->entries[children[i]];
+        struct statx st;
+
+        if (i >= e->child_dirs && !wk->verify_files) {
+            snapshot_mark(old, children[i]);
+            if (wk->build != NULL &&
+                snap_builder_add_old(wk->build, w->id, dir->record, old, children[i]) ==
+                    SNAP_NO_RECORD) {
+                report_error(w, "Out of memory at", dir, NULL, ENOMEM);
+            }
+            continue;
+        }
+
+        memcpy(name, old->names + child->name_off, child->name_len);
+        name[child->name_len] = '\0';
+        if (child->name_len == 0 || memchr(name, '/', child->name_len) != NULL) {
+            continue;   /* Snapshot hỏng: không đi ra ngoài thư mục */
+        }
+        if (statx(dir->fd, name, AT_SYMLINK_NOFOLLOW, wk->mask, &st) != 0) {
+            /* Không đánh dấu: được báo là đã xóa */
+            if (errno != ENOENT) {
+                report_error(w, "Cannot stat", dir, name, errno);
+            }
+            continue;
+        }
+        process_entry(w, dir, name, &st);
+    }
+}
+
+/**
+ * @brief Mở và đọc một thư mục bằng getdents64()
+ */
+static void scan_dir(walk_worker_t *w, walk_dir_t *dir)
+{
+    int parent_fd = dir->parent != NULL ? dir->parent->fd : AT_FDCWD;
+    int err;
+
+    /* O_NOFOLLOW: thư mục bị thay bằng symlink sau statx() thì không đi theo */
+    dir->fd = openat(parent_fd, dir->path + dir->name_off,
+                     O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    err = errno;
+    if (dir->parent != NULL) {
+        dir_release(dir->parent);
+        dir->parent = NULL;
+    }
+    if (dir->fd < 0) {
+        fprintf(stderr, "Error: Cannot open directory %s: %s\n", dir->path, strerror(err));
+        w->stats.errors++;
+        return;
+    }
+    if (dir->unchanged) {
+        replay_dir(w, dir);
+        return;
+    }
+
+    for (;;) {
+        long n = syscall(SYS_getdents64, dir->fd, w->dents, WALK_DENTS_SIZE);
+        if (n <= 0) {
+            if (n < 0) {
+                report_error(w, "Cannot read directory", dir, NULL, errno);
+            }
+            break;
+        }
+        visit_entries(w, dir, n);
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    walk_worker_t *w = arg;
+    walk_dir_t *dir;
+
+    while ((dir = next_dir(w)) != NULL) {
+        bool aggregate = dir->aggregate;
+
+        scan_dir(w, dir);
+        dir_release(dir);
+        if (aggregate) {
+            finish_aggregate(w, dir);
+        }
+        finish_dir(w->walker);
+    }
+    writer_flush(&w->out);
+    return NULL;
+}
+
+/* ======================== PUBLIC API ======================== */
+
+/**
+ * @brief Số luồng mặc định: số CPU đang online
+ */
+static unsigned default_threads(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (unsigned)cpus : 1;
+}
+
+/**
+ * @brief Nâng giới hạn fd mềm lên giới hạn cứng
+ *
+ * Mỗi thư mục còn thư mục con chờ mở giữ một fd; cây rất sâu và rộng
+ * cần nhiều hơn mức mặc định 1024.
+ */
+static void raise_fd_limit(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
+/**
+ * @brief Chuẩn bị io_uring cho mọi luồng
+ * @return false nếu io_uring không khả dụng (mọi luồng dùng statx() đồng bộ)
+ */
+static bool setup_uring(walker_t *wk)
+{
+    for (unsigned i = 0; i < wk->num_workers; i++) {
+        walk_worker_t *w = &wk->workers[i];
+
+        w->ring = uring_open(URING_DEPTH);
+        w->batch = malloc(WALK_BATCH_MAX * sizeof(*w->batch));
+        w->batch_stx = malloc(WALK_BATCH_MAX * sizeof(*w->batch_stx));
+        if (w->ring == NULL || w->batch == NULL || w->batch_stx == NULL) {
+            fprintf(stderr, "Warning: io_uring unavailable (%s), using synchronous statx()\n",
+                    strerror(w->ring == NULL ? errno : ENOMEM));
+            for (unsigned j = 0; j <= i; j++) {
+                uring_close(wk->workers[j].ring);
+                wk->workers[j].ring = NULL;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+int walk_tree(const char *root, const walk_options_t *options, walk_stats_t *stats)
+{
+    walker_t wk;
+    struct statx st;
+    unsigned threads = options->threads ? options->threads : default_threads();
+    unsigned started = 0;
+    snap_link_t root_link = { SNAP_ROOT_HASH, SNAP_NO_RECORD, SNAP_NONE, false };
+    bool root_match = true;
+    int out_fd = options->out != NULL ? options->out->fd : STDOUT_FILENO;
+
+    memset(stats, 0, sizeof(*stats));
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    memset(&wk, 0, sizeof(wk));
+    wk.num_workers = threads;
+    wk.summary_only = options->summary_only || options->du != NULL ||
+                      options->old != NULL || options->build != NULL ||
+                      options->dupes != NULL;
+    wk.format = options->format;
+    wk.fields = options->fields;
+    wk.bin = options->bin;
+    /* Chỉ yêu cầu statx() các trường sẽ in; loại file luôn cần để đi tiếp */
+    if (options->old != NULL || options->build != NULL) {
+        wk.mask = SNAP_STATX_MASK;
+    } else if (options->du != NULL) {
+        wk.mask = WALK_DU_MASK;
+    } else if (options->dupes != NULL) {
+        wk.mask = WALK_DUPES_MASK;
+    } else if (options->summary_only) {
+        wk.mask = WALK_STATX_MASK;
+    } else {
+        wk.mask = fields_to_statx_mask(options->fields) | STATX_TYPE;
+    }
+    wk.du = options->du;
+    wk.old = options->old;
+    wk.build = options->build;
+    wk.verify_files = options->verify_files;
+    wk.dupes = options->dupes;
+    wk.where = options->where;
+    wk.prune = options->prune;
+    if (wk.where != NULL) {
+        wk.mask |= filter_statx_mask(wk.where);
+    }
+    if (wk.prune != NULL) {
+        wk.mask |= filter_statx_mask(wk.prune);
+    }
+
+    /* Thư mục gốc được statx() như chế độ thường và in như mọi entry khác */
+    if (statx(AT_FDCWD, root, AT_SYMLINK_NOFOLLOW, wk.mask, &st) != 0) {
+        perror("Error");
+        fprintf(stderr, "Cannot get information for: %s\n", root);
+        stats->errors = 1;
+        return -1;
+    }
+    /* --prune và --where cũng áp dụng cho gốc */
+    if (wk.where != NULL || wk.prune != NULL) {
+        filter_entry_t entry = { NULL, 0, root, strlen(root), 0, &st };
+        if (wk.prune != NULL && S_ISDIR(st.stx_mode) &&
+            filter_eval(wk.prune, &entry) == FILTER_TRUE) {
+            stats->pruned = 1;
+            return 0;
+        }
+        root_match = wk.where == NULL || filter_eval(wk.where, &entry) == FILTER_TRUE;
+    }
+    if (root_match) {
+        count_entry(stats, &st);
+    } else {
+        stats->filtered = 1;
+    }
+    if (wk.du != NULL) {
+        wk.du->total.path = (char *)root;
+        wk.inodes = inode_set_create();
+        if (wk.inodes == NULL) {
+            fprintf(stderr, "Error: Out of memory\n");
+            return -1;
+        }
+    }
+
+    atomic_init(&wk.pending, 0);
+    atomic_init(&wk.queued, 0);
+    atomic_init(&wk.sleepers, 0);
+    pthread_mutex_init(&wk.idle_lock, NULL);
+    pthread_cond_init(&wk.idle_cond, NULL);
+    pthread_mutex_init(&wk.out_lock, NULL);
+
+    wk.workers = aligned_alloc(64, threads * sizeof(*wk.workers));
+    if (wk.workers == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        inode_set_destroy(wk.inodes);
+        return -1;
+    }
+    memset(wk.workers, 0, threads * sizeof(*wk.workers));
+
+    raise_fd_limit();
+
+    for (unsigned i = 0; i < threads; i++) {
+        walk_worker_t *w = &wk.workers[i];
+        pthread_mutex_init(&w->lock, NULL);
+        w->walker = &wk;
+        w->id = i;
+        w->dents = malloc(WALK_DENTS_SIZE);
+        if (w->dents == NULL || writer_init(&w->out, out_fd, WALK_OUT_SIZE) != 0) {
+            fprintf(stderr, "Error: Out of memory\n");
+            stats->errors++;
+            goto cleanup;
+        }
+        w->out.lock = &wk.out_lock;
+        if (wk.du != NULL && (topn_init(&w->top_dirs, wk.du->dirs.cap) != 0 ||
+                              topn_init(&w->top_files, wk.du->files.cap) != 0)) {
+            fprintf(stderr, "Error: Out of memory\n");
+            stats->errors++;
+            goto cleanup;
+        }
+    }
+
+    /* Bản ghi của gốc được in (và flush) trước khi các luồng bắt đầu */
+    if (!wk.summary_only && root_match) {
+        emit_entry(&wk.workers[0], options->out, &st, NULL, root, strlen(root));
+        writer_flush(options->out);
+    }
+    if (wk.old != NULL || wk.build != NULL) {
+        root_link = track_entry(&wk.workers[0], NULL, root, strlen(root), &st);
+        writer_flush(&wk.workers[0].out);
+    }
+    if (!S_ISDIR(st.stx_mode)) {
+        if (wk.du != NULL) {
+            aggregate_file(&wk.workers[0], NULL, root, strlen(root), &st);
+            wk.du->total = wk.workers[0].acc;
+            wk.du->total.path = (char *)root;
+        } else if (wk.dupes != NULL && S_ISREG(st.stx_mode) && root_match) {
+            collect_file(&wk.workers[0], NULL, root, strlen(root), &st);
+        }
+        goto cleanup;
+    }
+    if (options->io == IO_URING) {
+        setup_uring(&wk);
+    }
+
+    walk_dir_t *top = dir_new(NULL, root, strlen(root));
+    if (top == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        stats->errors++;
+        goto cleanup;
+    }
+    if (wk.du != NULL) {
+        top->aggregate = true;
+        atomic_init(&top->disk_bytes, st.stx_blocks * 512);
+        atomic_init(&top->bytes, st.stx_size);
+    }
+    link_dir(top, &root_link);
+    schedule_dir(&wk.workers[0], top);
+
+    for (started = 0; started < threads; started++) {
+        if (pthread_create(&wk.workers[started].thread, NULL, worker_main,
+                           &wk.workers[started]) != 0) {
+            break;
+        }
+    }
+    if (started == 0) {
+        /* Không tạo được luồng nào: tự duyệt trên luồng hiện tại */
+        worker_main(&wk.workers[0]);
+    }
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(wk.workers[i].thread, NULL);
+    }
+
+cleanup:
+    /* Gộp bộ đếm sau khi các luồng kết thúc: không cần khóa hay atomic */
+    for (unsigned i = 0; i < threads; i++) {
+        walk_worker_t *w = &wk.workers[i];
+        stats->dirs += w->stats.dirs;
+        stats->files += w->stats.files;
+        stats->symlinks += w->stats.symlinks;
+        stats->others += w->stats.others;
+        stats->bytes += w->stats.bytes;
+        stats->disk_bytes += w->stats.disk_bytes;
+        stats->errors += w->stats.errors;
+        stats->added += w->stats.added;
+        stats->modified += w->stats.modified;
+        stats->unchanged_dirs += w->stats.unchanged_dirs;
+        stats->filtered += w->stats.filtered;
+        stats->unstated += w->stats.unstated;
+        stats->pruned += w->stats.pruned;
+        uring_close(w->ring);
+        free(w->batch);
+        free(w->batch_stx);
+        free(w->items);
+        free(w->dents);
+        writer_close(&w->out);
+        if (wk.du != NULL) {
+            topn_merge(&wk.du->dirs, &w->top_dirs);
+            topn_merge(&wk.du->files, &w->top_files);
+            wk.du->hardlinks += w->hardlinks;
+        }
+        topn_free(&w->top_dirs);
+        topn_free(&w->top_files);
+        pthread_mutex_destroy(&w->lock);
+    }
+    if (wk.du != NULL) {
+        topn_sort(&wk.du->dirs);
+        topn_sort(&wk.du->files);
+    }
+    inode_set_destroy(wk.inodes);
+    free(wk.workers);
+    pthread_mutex_destroy(&wk.idle_lock);
+    pthread_cond_destroy(&wk.idle_cond);
+    pthread_mutex_destroy(&wk.out_lock);
+
+    return stats->errors > 0 ? -1 : 0;
+}
+
+void print_walk_stats(const char *root, const walk_stats_t *stats)
+{
+    printf("========================================\n");
+    printf("         DIRECTORY TREE SUMMARY         \n");
+    printf("========================================\n");
+    printf("Root:          %s\n", root);
+    printf("Directories:   %llu\n", (unsigned long long)stats->dirs);
+    printf("Regular Files: %llu\n", (unsigned long long)stats->files);
+    printf("Symlinks:      %llu\n", (unsigned long long)stats->symlinks);
+    printf("Other:         %llu\n", (unsigned long long)stats->others);
+    printf("Total Size:    %llu bytes\n", (unsigned long long)stats->bytes);
+    printf("Disk Usage:    %llu bytes\n", (unsigned long long)stats->disk_bytes);
+    if (stats->filtered > 0) {
+        printf("Filtered Out:  %llu (%llu without statx)\n",
+               (unsigned long long)stats->filtered, (unsigned long long)stats->unstated);
+    }
+    if (stats->pruned > 0) {
+        printf("Pruned Dirs:   %llu\n", (unsigned long long)stats->pruned);
+    }
+    printf("Errors:        %llu\n", (unsigned long long)stats->errors);
+    printf("========================================\n");
+}
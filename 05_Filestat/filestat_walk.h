@@ -0,0 +1,115 @@
+/**
+ * @file filestat_walk.h
+ * @brief Duyệt đệ quy cây thư mục song song (chế độ -r)
+ *
+ * Mỗi thư mục được mở bằng openat() trên file descriptor của thư mục cha,
+ * đọc bằng getdents64() và từng entry được lấy metadata bằng statx()
+ * tương đối với fd đó, nên kernel không phải phân giải lại đường dẫn
+ * đầy đủ ở mỗi file. statx() chỉ được yêu cầu các trường cần dùng.
+ * Với IO_URING, mỗi lô entry trả về bởi getdents64() được gửi
+ * một lần qua io_uring (xem filestat_uring.h).
+ *
+ * Các thư mục chờ đọc được chia cho một thread pool work-stealing: mỗi
+ * luồng lấy việc từ đuôi hàng đợi của chính nó (LIFO, giữ cache nóng)
+ * và lấy trộm từ đầu hàng đợi của luồng khác (FIFO, lấy các thư mục nông
+ * với nhiều việc nhất) khi hết việc. Thống kê được đếm riêng trong từng
+ * luồng và chỉ cộng lại sau khi các luồng kết thúc, không cần khóa.
+ */
+
+#ifndef FILESTAT_WALK_H
+#define FILESTAT_WALK_H
+
+#include "filestat.h"
+#include "filestat_format.h"
+#include "filestat_du.h"
+#include "filestat_snapshot.h"
+#include "filestat_dupes.h"
+#include "filestat_filter.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* ======================== TYPES ======================== */
+
+/**
+ * @brief Tùy chọn cho một lần duyệt
+ */
+typedef struct {
+    unsigned threads;        /* Số luồng, 0 = số CPU đang online */
+    bool summary_only;       /* true: chỉ tính tổng, không in từng entry */
+    io_mode_t io;            /* Backend lấy metadata */
+    output_format_t format;  /* Định dạng mỗi entry (khi không summary_only) */
+    unsigned int fields;     /* Các trường cần in (FIELD_*) */
+    bin_sink_t *bin;         /* FORMAT_BIN: bộ ghi đã mở trên out */
+    writer_t *out;           /* Nhận dòng của thư mục gốc; các luồng ghi cùng fd
+                                (NULL được khi không in entry: summary_only, du) */
+    du_report_t *du;         /* != NULL: tổng theo thư mục và top-N (--du), không in entry */
+    snapshot_t *old;         /* != NULL: so với snapshot (--diff), in "A/M <path>" lên out */
+    snap_builder_t *build;   /* != NULL: nhận mọi entry cho snapshot mới (--snapshot) */
+    bool verify_files;       /* --diff: statx() cả file trong các thư mục không đổi */
+    dupe_set_t *dupes;       /* != NULL: ghi lại mọi regular file (--dupes), không in entry */
+    filter_t *where;         /* != NULL: chỉ in/đếm entry khớp (--where), vẫn đi vào mọi thư mục */
+    filter_t *prune;         /* != NULL: bỏ hẳn thư mục khớp, không đi vào (--prune) */
+} walk_options_t;
+
+/**
+ * @brief Kết quả tổng hợp của một lần duyệt
+ */
+typedef struct {
+    uint64_t dirs;           /* Số thư mục (kể cả thư mục gốc) */
+    uint64_t files;          /* Số regular file */
+    uint64_t symlinks;       /* Số symbolic link (không đi theo) */
+    uint64_t others;         /* Device, FIFO, socket */
+    uint64_t bytes;          /* Tổng st_size */
+    uint64_t disk_bytes;     /* Tổng st_blocks * 512 (dung lượng thực trên đĩa) */
+    uint64_t errors;         /* Số entry/thư mục không đọc được */
+    uint64_t added;          /* --diff: entry không có trong snapshot */
+    uint64_t modified;       /* --diff: entry có metadata khác snapshot */
+    uint64_t unchanged_dirs; /* --diff: thư mục đọc từ snapshot thay vì getdents64() */
+    uint64_t filtered;       /* --where: entry không khớp (không được đếm ở trên) */
+    uint64_t unstated;       /* --where: trong số đó, loại chỉ từ tên và d_type, không statx() */
+    uint64_t pruned;         /* --prune: thư mục không đi vào */
+} walk_stats_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Duyệt đệ quy một cây thư mục
+ *
+ * Khi không ở chế độ summary_only, mỗi entry là một bản ghi theo
+ * options->format. Với FORMAT_TEXT và các trường mặc định, mỗi dòng là
+ * "<loại> <kích thước> <mtime> <đường dẫn>", với loại là một ký tự giống
+ * %y của find (f, d, l, c, b, p, s). Thứ tự các bản ghi không xác định
+ * khi chạy nhiều luồng. options->out được flush trước khi trả về.
+ *
+ * Với options->du, không entry nào được in: dung lượng được cộng dồn từ
+ * dưới lên và options->du nhận tổng của cây cùng các thư mục con và file
+ * lớn nhất (đã sắp xếp, lớn nhất trước).
+ *
+ * Với options->old hoặc options->build, không entry nào được in theo
+ * format: mỗi entry được so với snapshot cũ (chỉ các dòng "A"/"M" được
+ * in, các entry đã xóa do snapshot_report_removed() in sau đó) và/hoặc
+ * thêm vào snapshot mới. Thư mục không đổi được đọc từ snapshot cũ.
+ *
+ * Với options->dupes, không entry nào được in: mỗi regular file được
+ * thêm vào tập (phần của luồng đã gặp nó) để find_dupes() so sánh sau.
+ *
+ * options->where và options->prune được áp dụng cho mọi entry (kể cả
+ * gốc) trước các việc trên. Entry mà biểu thức đã loại chỉ từ tên và
+ * d_type của getdents64() không được statx(); thư mục không khớp --where
+ * vẫn được đọc.
+ *
+ * @param root Thư mục (hoặc file) gốc
+ * @param options Tùy chọn duyệt
+ * @param stats Nhận kết quả tổng hợp
+ * @return 0 nếu đọc được toàn bộ cây, -1 nếu có lỗi (xem stats->errors)
+ */
+int walk_tree(const char *root, const walk_options_t *options, walk_stats_t *stats);
+
+/**
+ * @brief In kết quả tổng hợp theo khung giống print_file_info()
+ * @param root Thư mục gốc đã duyệt
+ * @param stats Kết quả của walk_tree()
+ */
+void print_walk_stats(const char *root, const walk_stats_t *stats);
+
+#endif /* FILESTAT_WALK_H */
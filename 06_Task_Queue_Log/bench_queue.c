@@ -0,0 +1,215 @@
+/**
+ * @file bench_queue.c
+ * @brief Load generator - đo độ trễ của Task Queue khi quá tải 2x
+ *
+ * Một producer thread đẩy tác vụ với tốc độ gấp đôi khả năng xử lý của
+ * một consumer thread (service time cố định). Mỗi kịch bản chạy cùng tải
+ * nhưng khác chính sách admission control, rồi in thời gian chờ
+ * (p50/p99/max) lấy từ histogram của queue_metrics.
+ *
+ * Không có giới hạn, hàng đợi và độ trễ tăng tuyến tính theo thời gian;
+ * với capacity/CoDel, độ trễ bị chặn đổi lại bằng số tác vụ bị loại.
+ *
+ * Cách sử dụng: ./queue_bench [seconds] [service_us]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "task_queue.h"
+#include "queue_metrics.h"
+
+/* Giá trị mặc định của load generator */
+#define BENCH_DEFAULT_SECONDS     2
+#define BENCH_DEFAULT_SERVICE_US  200
+#define BENCH_OVERLOAD_FACTOR     2
+#define BENCH_CAPACITY            64
+#define BENCH_TICK_NS             1000000ULL   /* Producer thức dậy mỗi 1 ms */
+
+/**
+ * @brief Tham số chung của một lần chạy
+ */
+typedef struct {
+    uint64_t duration_ns;
+    uint64_t service_ns;
+    uint64_t arrival_ns;        /* Khoảng cách giữa hai tác vụ đến */
+    atomic_int stop;
+    uint64_t offered;           /* Số tác vụ producer đã cố gắng thêm */
+    uint64_t accepted;
+} BenchRun_t;
+
+/**
+ * @brief Một kịch bản admission control
+ */
+typedef struct {
+    const char* name;
+    size_t capacity;
+    QueuePolicy_t policy;
+    int codel_enabled;
+} BenchScenario_t;
+
+static const BenchScenario_t scenarios[] = {
+    { "unbounded",        0,              QUEUE_POLICY_REJECT,      0 },
+    { "reject cap=64",    BENCH_CAPACITY, QUEUE_POLICY_REJECT,      0 },
+    { "shed cap=64",      BENCH_CAPACITY, QUEUE_POLICY_SHED_LOWEST, 0 },
+    { "block cap=64",     BENCH_CAPACITY, QUEUE_POLICY_BLOCK,       0 },
+    { "codel 5/100/50ms", 0,              QUEUE_POLICY_REJECT,      1 },
+};
+
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/**
+ * @brief Ngủ tới thời điểm tuyệt đối deadline_ns (CLOCK_MONOTONIC)
+ */
+static void sleep_until(uint64_t deadline_ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+        /* Bị signal đánh thức - ngủ tiếp */
+    }
+}
+
+/**
+ * @brief Producer - mỗi tick thêm đủ số tác vụ lẽ ra đã đến từ đầu lần chạy
+ */
+static void* producer_thread(void* arg)
+{
+    BenchRun_t* run = (BenchRun_t*)arg;
+    uint64_t start = metrics_now_ns();
+    uint64_t now;
+    uint64_t due;
+    char description[TASK_DESC_SIZE];
+
+    while ((now = metrics_now_ns()) - start < run->duration_ns) {
+        due = (now - start) / run->arrival_ns;
+        /* BLOCK có thể giữ producer lâu - dừng đúng hạn dù còn tác vụ đến hạn */
+        while (run->offered < due && metrics_now_ns() - start < run->duration_ns) {
+            snprintf(description, sizeof(description), "task %llu",
+                     (unsigned long long)run->offered);
+            if (queue_add_task_priority(description, (int)(run->offered % 4)) == QUEUE_OK) {
+                run->accepted++;
+            }
+            run->offered++;
+        }
+        sleep_until(now + BENCH_TICK_NS);
+    }
+
+    atomic_store(&run->stop, 1);
+    return NULL;
+}
+
+/**
+ * @brief Consumer - xử lý từng tác vụ trong đúng service_ns
+ *
+ * Lịch xử lý tính theo thời gian tuyệt đối nên sai số của nanosleep
+ * không làm giảm khả năng xử lý.
+ */
+static void* consumer_thread(void* arg)
+{
+    BenchRun_t* run = (BenchRun_t*)arg;
+    uint64_t next_free = metrics_now_ns();
+    uint64_t now;
+    TaskNode_t* task;
+
+    while (!atomic_load(&run->stop)) {
+        task = queue_wait_next_task(10);
+        if (task == NULL) {
+            continue;
+        }
+        now = metrics_now_ns();
+        if (next_free < now) {
+            next_free = now;
+        }
+        next_free += run->service_ns;
+        sleep_until(next_free);
+        queue_task_completed(task);
+        free(task);
+    }
+    return NULL;
+}
+
+static void run_scenario(const BenchScenario_t* scenario, uint64_t duration_ns,
+                         uint64_t service_ns)
+{
+    QueueConfig_t config;
+    QueueMetrics_t snap;
+    BenchRun_t run;
+    pthread_t producer;
+    pthread_t consumer;
+
+    queue_config_default(&config);
+    config.verbose = 0;
+    config.capacity = scenario->capacity;
+    config.policy = scenario->policy;
+    config.block_timeout_ms = 0;
+    config.codel_enabled = scenario->codel_enabled;
+    queue_configure(&config);
+    metrics_reset();
+
+    memset(&run, 0, sizeof(run));
+    run.duration_ns = duration_ns;
+    run.service_ns = service_ns;
+    run.arrival_ns = service_ns / BENCH_OVERLOAD_FACTOR;
+    atomic_init(&run.stop, 0);
+
+    pthread_create(&consumer, NULL, consumer_thread, &run);
+    pthread_create(&producer, NULL, producer_thread, &run);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    metrics_snapshot(&snap);
+    printf("%-16s %8llu %8llu %8llu %8llu %9.2f %9.2f %9.2f %6llu\n",
+           scenario->name,
+           (unsigned long long)run.offered,
+           (unsigned long long)run.accepted,
+           (unsigned long long)snap.completed,
+           (unsigned long long)snap.dropped,
+           (double)hist_percentile(&snap.wait_ns, 50.0) / 1e6,
+           (double)hist_percentile(&snap.wait_ns, 99.0) / 1e6,
+           (double)snap.wait_ns.max / 1e6,
+           (unsigned long long)snap.max_depth);
+
+    /* Tác vụ còn lại sau khi dừng không tính vào kịch bản sau */
+    queue_destroy();
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int seconds = BENCH_DEFAULT_SECONDS;
+    unsigned int service_us = BENCH_DEFAULT_SERVICE_US;
+    size_t i;
+
+    if (argc > 1) {
+        seconds = (unsigned int)atoi(argv[1]);
+    }
+    if (argc > 2) {
+        service_us = (unsigned int)atoi(argv[2]);
+    }
+    if (seconds == 0 || service_us < BENCH_OVERLOAD_FACTOR) {
+        fprintf(stderr, "Usage: %s [seconds] [service_us]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Load generator: %u s per scenario, service %u us (%.0f tasks/s), "
+           "arrivals %ux faster\n\n",
+           seconds, service_us, 1e6 / service_us, BENCH_OVERLOAD_FACTOR);
+    printf("%-16s %8s %8s %8s %8s %9s %9s %9s %6s\n",
+           "scenario", "offered", "accepted", "served", "dropped",
+           "p50(ms)", "p99(ms)", "max(ms)", "depth");
+
+    for (i = 0; i < NUM_SCENARIOS; i++) {
+        run_scenario(&scenarios[i], (uint64_t)seconds * 1000000000ULL,
+                     (uint64_t)service_us * 1000ULL);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file bench_shard.c
+ * @brief Benchmark thông lượng của Sharded Task Queue với 1..N shard
+ *
+ * Mỗi tác vụ mô phỏng một thao tác I/O với thiết bị (ngủ service_us),
+ * tác vụ được rải đều trên NUM_KEYS partition key. Với mỗi số shard:
+ * - Đo thông lượng (tác vụ/giây) và speedup so với 1 shard
+ * - Kiểm tra thứ tự theo key: số thứ tự của từng key phải tăng dần
+ *
+ * Kịch bản cuối đổi số shard (4 -> 8 -> 2) giữa chừng để kiểm tra
+ * rebalance vẫn giữ thứ tự theo key.
+ *
+ * Cách sử dụng: ./shard_bench [tasks] [service_us] [max_shards]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "task_shard.h"
+#include "queue_metrics.h"
+
+#define BENCH_DEFAULT_TASKS       4000
+#define BENCH_DEFAULT_SERVICE_US  200
+#define BENCH_DEFAULT_MAX_SHARDS  16
+#define NUM_KEYS                  256
+
+/**
+ * @brief Trạng thái kiểm tra thứ tự theo key
+ *
+ * Mỗi key chỉ được một worker xử lý tại một thời điểm, nên mảng
+ * last_seq không cần lock; chỉ bộ đếm lỗi dùng chung giữa các worker.
+ */
+typedef struct {
+    long last_seq[NUM_KEYS];
+    atomic_long order_errors;
+    long service_ns;
+} BenchCtx_t;
+
+static void bench_task(int shard, const char* partition_key,
+                       const char* description, void* user_ctx)
+{
+    BenchCtx_t* ctx = (BenchCtx_t*)user_ctx;
+    struct timespec service;
+    int key;
+    long seq;
+
+    (void)shard;
+    (void)partition_key;
+
+    /* description = "<key> <seq>" */
+    if (sscanf(description, "%d %ld", &key, &seq) == 2 && key >= 0 && key < NUM_KEYS) {
+        if (seq <= ctx->last_seq[key]) {
+            atomic_fetch_add(&ctx->order_errors, 1);
+        }
+        ctx->last_seq[key] = seq;
+    }
+
+    service.tv_sec = 0;
+    service.tv_nsec = ctx->service_ns;
+    nanosleep(&service, NULL);
+}
+
+/**
+ * @brief Submit num_tasks tác vụ; resize_plan != NULL thì đổi số shard
+ *        tại các mốc 1/3 và 2/3
+ */
+static void submit_all(ShardedQueue_t* sq, int num_tasks, const int* resize_plan)
+{
+    char key[TASK_KEY_SIZE];
+    char description[TASK_DESC_SIZE];
+    int i;
+
+    for (i = 0; i < num_tasks; i++) {
+        if (resize_plan != NULL && (i == num_tasks / 3 || i == 2 * num_tasks / 3)) {
+            shard_resize(sq, resize_plan[i == num_tasks / 3 ? 0 : 1]);
+        }
+        snprintf(key, sizeof(key), "plant-%d", i % NUM_KEYS);
+        snprintf(description, sizeof(description), "%d %d", i % NUM_KEYS, i / NUM_KEYS);
+        shard_submit(sq, key, description);
+    }
+}
+
+static double run_once(int num_shards, int num_tasks, long service_ns,
+                       const int* resize_plan, long* order_errors)
+{
+    BenchCtx_t ctx;
+    ShardedQueue_t* sq;
+    uint64_t start;
+    uint64_t elapsed;
+    int i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    for (i = 0; i < NUM_KEYS; i++) {
+        ctx.last_seq[i] = -1;
+    }
+    atomic_init(&ctx.order_errors, 0);
+    ctx.service_ns = service_ns;
+
+    sq = shard_create(num_shards, bench_task, &ctx);
+    if (sq == NULL) {
+        return 0.0;
+    }
+
+    start = metrics_now_ns();
+    submit_all(sq, num_tasks, resize_plan);
+    shard_drain(sq);
+    elapsed = metrics_now_ns() - start;
+    shard_destroy(sq);
+
+    *order_errors = atomic_load(&ctx.order_errors);
+    return (double)num_tasks / ((double)elapsed / 1e9);
+}
+
+int main(int argc, char* argv[])
+{
+    static const int resize_plan[] = { 8, 2 };
+    int num_tasks = BENCH_DEFAULT_TASKS;
+    int service_us = BENCH_DEFAULT_SERVICE_US;
+    int max_shards = BENCH_DEFAULT_MAX_SHARDS;
+    double baseline = 0.0;
+    double throughput;
+    long errors;
+    int shards;
+
+    if (argc > 1) {
+        num_tasks = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        service_us = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        max_shards = atoi(argv[3]);
+    }
+    if (num_tasks <= 0 || service_us <= 0 || service_us >= 1000000 ||
+        max_shards < 1 || max_shards > SHARD_MAX_COUNT) {
+        fprintf(stderr, "Usage: %s [tasks] [service_us] [max_shards<=%d]\n",
+                argv[0], SHARD_MAX_COUNT);
+        return EXIT_FAILURE;
+    }
+
+    printf("Sharded queue: %d tasks over %d keys, service %d us per task\n\n",
+           num_tasks, NUM_KEYS, service_us);
+    printf("%-14s %12s %8s %13s\n", "shards", "tasks/s", "speedup", "order errors");
+
+    for (shards = 1; shards <= max_shards; shards *= 2) {
+        throughput = run_once(shards, num_tasks, (long)service_us * 1000L, NULL, &errors);
+        if (shards == 1) {
+            baseline = throughput;
+        }
+        printf("%-14d %12.0f %7.2fx %13ld\n", shards, throughput,
+               baseline > 0.0 ? throughput / baseline : 0.0, errors);
+    }
+
+    throughput = run_once(4, num_tasks, (long)service_us * 1000L, resize_plan, &errors);
+    printf("%-14s %12.0f %7.2fx %13ld\n", "4 -> 8 -> 2", throughput,
+           baseline > 0.0 ? throughput / baseline : 0.0, errors);
+
+    return EXIT_SUCCESS;
+}
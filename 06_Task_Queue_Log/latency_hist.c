@@ -0,0 +1,123 @@
+/**
+ * @file latency_hist.c
+ * @brief Triển khai Latency Histogram log-linear
+ *
+ * Với giá trị v >= SUB_BUCKETS, gọi e là vị trí bit cao nhất của v:
+ * - SUB_BITS bit ngay sau bit cao nhất chọn sub-bucket
+ * - index = SUB_BUCKETS + (e - SUB_BITS) * SUB_BUCKETS + sub
+ * Mỗi bucket ở độ lớn e có độ rộng 2^(e - SUB_BITS).
+ */
+
+#include "latency_hist.h"
+
+#include <string.h>
+
+/**
+ * @brief Vị trí bit cao nhất (0..63) của value > 0
+ */
+static int highest_bit(uint64_t value)
+{
+    int bit = 0;
+
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+static int bucket_index(uint64_t value)
+{
+    int e;
+
+    if (value < LATENCY_HIST_SUB_BUCKETS) {
+        return (int)value;
+    }
+
+    e = highest_bit(value);
+    return LATENCY_HIST_SUB_BUCKETS
+         + (e - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB_BUCKETS
+         + (int)((value >> (e - LATENCY_HIST_SUB_BITS)) & (LATENCY_HIST_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Giá trị đại diện (điểm giữa) của bucket
+ */
+static uint64_t bucket_value(int index)
+{
+    int e;
+    uint64_t sub;
+    uint64_t width;
+
+    if (index < LATENCY_HIST_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+
+    index -= LATENCY_HIST_SUB_BUCKETS;
+    e = index / LATENCY_HIST_SUB_BUCKETS;
+    sub = (uint64_t)(index % LATENCY_HIST_SUB_BUCKETS);
+    width = 1ULL << e;
+    return ((LATENCY_HIST_SUB_BUCKETS + sub) << e) + width / 2;
+}
+
+void hist_reset(LatencyHist_t* hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+void hist_record(LatencyHist_t* hist, uint64_t value)
+{
+    hist->buckets[bucket_index(value)]++;
+    if (hist->count == 0 || value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->count++;
+    hist->sum += value;
+}
+
+uint64_t hist_percentile(const LatencyHist_t* hist, double percentile)
+{
+    uint64_t target;
+    uint64_t seen = 0;
+    uint64_t value;
+    int i;
+
+    if (hist->count == 0) {
+        return 0;
+    }
+    if (percentile <= 0.0) {
+        return hist->min;
+    }
+    if (percentile >= 100.0) {
+        return hist->max;
+    }
+
+    /* Số mẫu cần vượt qua: ceil(percentile% * count) */
+    target = (uint64_t)(percentile / 100.0 * (double)hist->count + 0.999999);
+    if (target == 0) {
+        target = 1;
+    }
+
+    for (i = 0; i < LATENCY_HIST_NUM_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            /* Không báo giá trị nằm ngoài khoảng [min, max] thực tế */
+            value = bucket_value(i);
+            if (value < hist->min) {
+                value = hist->min;
+            }
+            if (value > hist->max) {
+                value = hist->max;
+            }
+            return value;
+        }
+    }
+    return hist->max;
+}
+
+double hist_mean(const LatencyHist_t* hist)
+{
+    return (hist->count == 0) ? 0.0 : (double)hist->sum / (double)hist->count;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file latency_hist.h
+ * @brief Header file cho Latency Histogram - Histogram log-linear kiểu HDR
+ *
+ * Giá trị (nanosecond) được chia vào các bucket theo lũy thừa của 2,
+ * mỗi lũy thừa lại chia thành LATENCY_HIST_SUB_BUCKETS bucket tuyến tính:
+ * - Sai số tương đối tối đa ~3% ở mọi độ lớn (1ns .. 2^63ns)
+ * - Bộ nhớ cố định, record O(1), không cấp phát động
+ * - Percentile tính bằng cách cộng dồn bucket: O(số bucket)
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+/* Số bit độ chính xác trong mỗi lũy thừa của 2 */
+#define LATENCY_HIST_SUB_BITS     4
+#define LATENCY_HIST_SUB_BUCKETS  (1 << LATENCY_HIST_SUB_BITS)
+
+/* Giá trị < SUB_BUCKETS được lưu chính xác, phần còn lại theo log-linear */
+#define LATENCY_HIST_NUM_BUCKETS \
+    (LATENCY_HIST_SUB_BUCKETS + (64 - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB_BUCKETS)
+
+/**
+ * @brief Histogram độ trễ
+ */
+typedef struct {
+    uint64_t buckets[LATENCY_HIST_NUM_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} LatencyHist_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Xóa toàn bộ dữ liệu của histogram
+ */
+void hist_reset(LatencyHist_t* hist);
+
+/**
+ * @brief Ghi nhận một giá trị
+ *
+ * Độ phức tạp: O(1)
+ */
+void hist_record(LatencyHist_t* hist, uint64_t value);
+
+/**
+ * @brief Giá trị tại percentile (0..100)
+ * @return Giá trị đại diện của bucket chứa percentile, 0 nếu histogram rỗng
+ */
+uint64_t hist_percentile(const LatencyHist_t* hist, double percentile);
+
+/**
+ * @brief Giá trị trung bình, 0 nếu histogram rỗng
+ */
+double hist_mean(const LatencyHist_t* hist);
+
+#endif /* LATENCY_HIST_H */
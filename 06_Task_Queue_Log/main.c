@@ -5,6 +5,7 @@
  * Tích hợp:
  * - Task Queue (Singly Linked List) cho hàng đợi FIFO
  * - Activity Log (Doubly Linked List) cho nhật ký với navigation
+ * - Task DAG cho các pipeline nhiều bước có ràng buộc thứ tự
  */
 
 #include <stdio.h>
@@ -14,10 +15,28 @@
 
 #include "task_queue.h"
 #include "activity_log.h"
+#include "task_dag.h"
+#include "queue_metrics.h"
+#include "task_shard.h"
 
 /* Kích thước buffer cho input */
 #define INPUT_BUFFER_SIZE 256
 
+/* Thời gian chờ mặc định của chính sách BLOCK trong CLI (không có consumer song song) */
+#define CLI_BLOCK_TIMEOUT_MS 1000
+
+/* Số worker mặc định khi chạy DAG */
+#define DAG_DEFAULT_WORKERS 4
+
+/* Số shard mặc định của lệnh "shard start" */
+#define SHARD_DEFAULT_COUNT 4
+
+/* DAG tác vụ dùng cho các lệnh "dag ..." (tạo khi cần) */
+static TaskDag_t* task_dag = NULL;
+
+/* Sharded queue dùng cho các lệnh "shard ..." (tạo bởi "shard start") */
+static ShardedQueue_t* sharded_queue = NULL;
+
 /* ======================== HELPER FUNCTIONS ======================== */
 
 /**
@@ -28,10 +47,29 @@ static void print_menu(void)
     printf("\n============ TASK MANAGER MENU ============\n");
     printf("Commands:\n");
     printf("  add <description>  - Add a new task to queue\n");
+    printf("  addp <prio> <desc> - Add a task with a priority (higher = more important)\n");
     printf("  run                - Execute next task (FIFO)\n");
     printf("  list               - Show all pending tasks\n");
     printf("  history            - Navigate activity log\n");
     printf("  log                - Show all log entries\n");
+    printf("  limit <n> [block|reject|shed] [timeout_ms] - Cap queue size\n");
+    printf("  limit off          - Remove the queue size cap\n");
+    printf("  watermark <hi> <lo>- Notify when depth crosses hi / falls to lo\n");
+    printf("  codel <target_ms> <interval_ms> | codel off - Drop stale tasks\n");
+    printf("  stats              - Show queue counters and latency histograms\n");
+    printf("  stats prom         - Print stats in Prometheus text format\n");
+    printf("  stats save <file>  - Write a Prometheus snapshot to <file>\n");
+    printf("  stats every <s> <file> - Write a snapshot every <s> seconds\n");
+    printf("  stats stop|reset   - Stop periodic snapshots / reset stats\n");
+    printf("  dag add <desc>     - Add a task to the dependency graph\n");
+    printf("  dag dep <id> <id2> - Task <id> runs only after task <id2>\n");
+    printf("  dag list           - Show DAG tasks and dependencies\n");
+    printf("  dag run [workers]  - Execute the DAG in parallel\n");
+    printf("  dag clear          - Remove all DAG tasks\n");
+    printf("  shard start [n]    - Start n keyed queues, one worker each\n");
+    printf("  shard add <key> <desc> - Queue a task; same key => same order\n");
+    printf("  shard resize <n>   - Change worker count, rebalancing pending tasks\n");
+    printf("  shard list|stop    - Show shard depths / drain and stop workers\n");
     printf("  help               - Show this menu\n");
     printf("  quit               - Exit program\n");
     printf("=============================================\n\n");
@@ -57,6 +95,144 @@ static void handle_add_command(const char* args)
     queue_add_task(args);
 }
 
+/**
+ * @brief Xử lý lệnh addp - thêm tác vụ với độ ưu tiên
+ * @param args "<priority> <mô tả>"
+ */
+static void handle_addp_command(const char* args)
+{
+    int priority;
+    int consumed = 0;
+
+    if (sscanf(args, "%d %n", &priority, &consumed) != 1 || args[consumed] == '\0') {
+        printf("Usage: addp <priority> <task description>\n");
+        return;
+    }
+
+    queue_add_task_priority(args + consumed, priority);
+}
+
+/**
+ * @brief Callback watermark - producer nên giảm tốc / có thể tăng tốc lại
+ */
+static void on_high_watermark(size_t depth, void* user_ctx)
+{
+    (void)user_ctx;
+    printf("[Backpressure] High watermark reached (depth %zu) - slow down producers\n", depth);
+}
+
+static void on_low_watermark(size_t depth, void* user_ctx)
+{
+    (void)user_ctx;
+    printf("[Backpressure] Back below low watermark (depth %zu) - producers may resume\n", depth);
+}
+
+/**
+ * @brief Xử lý lệnh limit - cấu hình sức chứa và chính sách khi đầy
+ * @param args "<capacity> [block|reject|shed] [timeout_ms]" hoặc "off"
+ */
+static void handle_limit_command(const char* args)
+{
+    QueueConfig_t config;
+    char policy[16] = "block";
+    unsigned long capacity;
+    unsigned int timeout_ms = CLI_BLOCK_TIMEOUT_MS;
+    int fields;
+
+    queue_get_config(&config);
+
+    if (strncmp(args, "off", 3) == 0) {
+        config.capacity = 0;
+        queue_configure(&config);
+        printf("[Queue] Capacity limit removed.\n");
+        return;
+    }
+
+    fields = sscanf(args, "%lu %15s %u", &capacity, policy, &timeout_ms);
+    if (fields < 1 || capacity == 0) {
+        printf("Usage: limit <capacity> [block|reject|shed] [timeout_ms] | limit off\n");
+        return;
+    }
+
+    if (strcmp(policy, "block") == 0) {
+        /* CLI chỉ có một luồng: chờ mãi trên hàng đợi đầy sẽ treo chương trình */
+        if (timeout_ms == 0) {
+            printf("Block timeout must be > 0 ms: nothing runs tasks while 'add' waits.\n");
+            return;
+        }
+        config.policy = QUEUE_POLICY_BLOCK;
+    } else if (strcmp(policy, "reject") == 0) {
+        config.policy = QUEUE_POLICY_REJECT;
+    } else if (strcmp(policy, "shed") == 0) {
+        config.policy = QUEUE_POLICY_SHED_LOWEST;
+    } else {
+        printf("Unknown policy '%s'. Use block, reject or shed.\n", policy);
+        return;
+    }
+
+    config.capacity = (size_t)capacity;
+    config.block_timeout_ms = timeout_ms;
+    queue_configure(&config);
+    printf("[Queue] Capacity %lu, policy %s\n", capacity, policy);
+}
+
+/**
+ * @brief Xử lý lệnh watermark - bật callback high/low watermark
+ * @param args "<high> <low>" hoặc "off"
+ */
+static void handle_watermark_command(const char* args)
+{
+    QueueConfig_t config;
+    unsigned long high;
+    unsigned long low;
+
+    queue_get_config(&config);
+
+    if (strncmp(args, "off", 3) == 0) {
+        config.high_watermark = 0;
+        config.low_watermark = 0;
+    } else if (sscanf(args, "%lu %lu", &high, &low) == 2 && low < high) {
+        config.high_watermark = (size_t)high;
+        config.low_watermark = (size_t)low;
+        config.on_high = on_high_watermark;
+        config.on_low = on_low_watermark;
+    } else {
+        printf("Usage: watermark <high> <low> (low < high) | watermark off\n");
+        return;
+    }
+
+    queue_configure(&config);
+    printf("[Queue] Watermarks %s\n", config.high_watermark ? "enabled" : "disabled");
+}
+
+/**
+ * @brief Xử lý lệnh codel - bật/tắt loại bỏ tác vụ theo sojourn time
+ * @param args "<target_ms> <interval_ms>" hoặc "off"
+ */
+static void handle_codel_command(const char* args)
+{
+    QueueConfig_t config;
+    unsigned int target_ms;
+    unsigned int interval_ms;
+
+    queue_get_config(&config);
+
+    if (strncmp(args, "off", 3) == 0) {
+        config.codel_enabled = 0;
+    } else if (sscanf(args, "%u %u", &target_ms, &interval_ms) == 2 &&
+               target_ms > 0 && interval_ms > 0) {
+        config.codel_enabled = 1;
+        config.codel_target_ns = (uint64_t)target_ms * 1000000ULL;
+        config.codel_interval_ns = (uint64_t)interval_ms * 1000000ULL;
+    } else {
+        printf("Usage: codel <target_ms> <interval_ms> | codel off\n");
+        return;
+    }
+
+    queue_configure(&config);
+    printf("[Queue] CoDel %s\n", config.codel_enabled ? "enabled" : "disabled");
+}
+
 /**
  * @brief Xử lý lệnh run - thực thi tác vụ và ghi log
  */
@@ -83,11 +259,281 @@ static void handle_run_command(void)
     /* Ghi vào nhật ký */
     history_log_activity(log_message);
     
+    /* Ghi nhận thời gian thực thi trước khi giải phóng node */
+    queue_task_completed(task);
+    
     /* Giải phóng bộ nhớ của node tác vụ */
     free(task);
     task = NULL;  /* Tránh dangling pointer */
 }
 
+/**
+ * @brief Xử lý lệnh stats - in, xuất và ghi snapshot metrics của hàng đợi
+ * @param args Phần còn lại của dòng lệnh (sub-command và tham số)
+ */
+static void handle_stats_command(const char* args)
+{
+    char sub[16] = "";
+    char path[INPUT_BUFFER_SIZE];
+    unsigned int interval;
+
+    sscanf(args, "%15s", sub);
+
+    if (sub[0] == '\0') {
+        metrics_print();
+    }
+    else if (strcmp(sub, "prom") == 0) {
+        metrics_export_prometheus(stdout);
+    }
+    else if (strcmp(sub, "save") == 0) {
+        if (sscanf(args, "%*s %255s", path) != 1) {
+            printf("Usage: stats save <file>\n");
+            return;
+        }
+        if (metrics_write_file(path) == 0) {
+            printf("[Stats] Snapshot written to %s\n", path);
+        }
+    }
+    else if (strcmp(sub, "every") == 0) {
+        if (sscanf(args, "%*s %u %255s", &interval, path) != 2 || interval == 0) {
+            printf("Usage: stats every <seconds> <file>\n");
+            return;
+        }
+        if (metrics_start_periodic(path, interval) == 0) {
+            printf("[Stats] Writing snapshot to %s every %u s\n", path, interval);
+        }
+    }
+    else if (strcmp(sub, "stop") == 0) {
+        metrics_stop_periodic();
+        printf("[Stats] Periodic snapshot stopped.\n");
+    }
+    else if (strcmp(sub, "reset") == 0) {
+        metrics_reset();
+        printf("[Stats] Counters and histograms reset.\n");
+    }
+    else {
+        printf("Usage: stats [prom|save <file>|every <s> <file>|stop|reset]\n");
+    }
+}
+
+/**
+ * @brief Hàm thực thi tác vụ DAG - được gọi từ các worker thread
+ * @return 0 (tác vụ mô phỏng luôn thành công)
+ */
+static int execute_dag_task(int task_id, const char* description, void* user_ctx)
+{
+    (void)user_ctx;
+
+    /* Một lần printf là nguyên tử nên các dòng không bị xen lẫn */
+    printf(">>> EXECUTING DAG TASK #%d: \"%s\"\n", task_id + 1, description);
+    return 0;
+}
+
+/**
+ * @brief Xử lý lệnh dag - thêm tác vụ, phụ thuộc và chạy đồ thị
+ * @param args Phần còn lại của dòng lệnh (sub-command và tham số)
+ */
+static void handle_dag_command(const char* args)
+{
+    char sub[16] = "";
+    char log_message[LOG_ENTRY_SIZE];
+    const char* outcome;
+    DagReport_t report;
+    int consumed = 0;
+    int task_id;
+    int dep_id;
+    int workers;
+    int result;
+    int i;
+
+    sscanf(args, "%15s%n", sub, &consumed);
+    args += consumed;
+    while (*args && isspace((unsigned char)*args)) {
+        args++;
+    }
+
+    if (task_dag == NULL && strcmp(sub, "add") == 0) {
+        task_dag = dag_create();
+        if (task_dag == NULL) {
+            return;
+        }
+    }
+
+    if (strcmp(sub, "add") == 0) {
+        if (*args == '\0') {
+            printf("Usage: dag add <task description>\n");
+            return;
+        }
+        task_id = dag_add_task(task_dag, args);
+        if (task_id >= 0) {
+            printf("[DAG] Added task #%d: \"%s\"\n", task_id + 1,
+                   dag_task_description(task_dag, task_id));
+        }
+    }
+    else if (strcmp(sub, "dep") == 0) {
+        if (sscanf(args, "%d %d", &task_id, &dep_id) != 2) {
+            printf("Usage: dag dep <task id> <runs after id>\n");
+            return;
+        }
+        result = dag_add_dependency(task_dag, task_id - 1, dep_id - 1);
+        switch (result) {
+            case DAG_OK:
+                printf("[DAG] Task #%d now runs after #%d\n", task_id, dep_id);
+                break;
+            case DAG_ERR_CYCLE:
+                printf("[DAG] Rejected: #%d -> #%d would create a cycle\n", dep_id, task_id);
+                break;
+            case DAG_ERR_DUPLICATE:
+                printf("[DAG] Dependency already exists\n");
+                break;
+            default:
+                printf("[DAG] Invalid task id. Use 'dag list' to see ids.\n");
+                break;
+        }
+    }
+    else if (strcmp(sub, "list") == 0) {
+        dag_print(task_dag);
+    }
+    else if (strcmp(sub, "run") == 0) {
+        if (dag_task_count(task_dag) == 0) {
+            printf("[DAG] DAG is empty. Nothing to execute.\n");
+            return;
+        }
+        workers = DAG_DEFAULT_WORKERS;
+        if (*args != '\0' && (sscanf(args, "%d", &workers) != 1 ||
+                              workers < 1 || workers > DAG_MAX_WORKERS)) {
+            printf("Usage: dag run [workers 1-%d]\n", DAG_MAX_WORKERS);
+            return;
+        }
+        result = dag_execute(task_dag, workers, execute_dag_task, NULL, &report);
+        if (result < 0) {
+            printf("[DAG] Execution failed (error %d)\n", result);
+            return;
+        }
+
+        /* Ghi log từ main thread theo đúng thứ tự hoàn thành, kèm kết quả thật */
+        for (i = 0; (task_id = dag_completion_order(task_dag, i)) >= 0; i++) {
+            switch (dag_task_state(task_dag, task_id)) {
+                case DAG_TASK_DONE:    outcome = "Executed"; break;
+                case DAG_TASK_FAILED:  outcome = "Failed";   break;
+                case DAG_TASK_SKIPPED: outcome = "Skipped";  break;
+                default:               outcome = "Pending";  break;
+            }
+            snprintf(log_message, LOG_ENTRY_SIZE, "%s: %s", outcome,
+                     dag_task_description(task_dag, task_id));
+            history_log_activity(log_message);
+        }
+        dag_print_report(task_dag, &report);
+    }
+    else if (strcmp(sub, "clear") == 0) {
+        dag_destroy(task_dag);
+        task_dag = NULL;
+        printf("[DAG] All DAG tasks cleared.\n");
+    }
+    else {
+        printf("Usage: dag add|dep|list|run|clear. Type 'help' for details.\n");
+    }
+}
+
+/**
+ * @brief Hàm thực thi tác vụ của shard - được gọi từ worker thread
+ *
+ * Activity log không thread-safe nên worker chỉ in ra màn hình.
+ */
+static void execute_shard_task(int shard, const char* partition_key,
+                               const char* description, void* user_ctx)
+{
+    (void)user_ctx;
+
+    printf(">>> [Shard %d] EXECUTING TASK (key \"%s\"): \"%s\"\n",
+           shard, partition_key, description);
+}
+
+/**
+ * @brief Xử lý lệnh shard - hàng đợi phân theo key với nhiều worker
+ * @param args Phần còn lại của dòng lệnh (sub-command và tham số)
+ */
+static void handle_shard_command(const char* args)
+{
+    char sub[16] = "";
+    char key[TASK_KEY_SIZE];
+    int consumed = 0;
+    int count;
+    int shard;
+
+    sscanf(args, "%15s%n", sub, &consumed);
+    args += consumed;
+    while (*args && isspace((unsigned char)*args)) {
+        args++;
+    }
+
+    if (strcmp(sub, "start") == 0) {
+        count = SHARD_DEFAULT_COUNT;
+        if (*args != '\0' && (sscanf(args, "%d", &count) != 1 ||
+                              count < 1 || count > SHARD_MAX_COUNT)) {
+            printf("Usage: shard start [shards 1-%d]\n", SHARD_MAX_COUNT);
+            return;
+        }
+        if (sharded_queue != NULL) {
+            printf("[Shard] Already running with %d shards. Use 'shard resize'.\n",
+                   shard_count(sharded_queue));
+            return;
+        }
+        sharded_queue = shard_create(count, execute_shard_task, NULL);
+        if (sharded_queue != NULL) {
+            printf("[Shard] Started %d shards\n", count);
+        }
+        return;
+    }
+
+    if (sharded_queue == NULL) {
+        printf("[Shard] Not running. Use 'shard start [n]' first.\n");
+        return;
+    }
+
+    if (strcmp(sub, "add") == 0) {
+        consumed = 0;
+        if (sscanf(args, "%23s%n", key, &consumed) != 1) {
+            printf("Usage: shard add <key> <task description>\n");
+            return;
+        }
+        args += consumed;
+        while (*args && isspace((unsigned char)*args)) {
+            args++;
+        }
+        if (*args == '\0') {
+            printf("Usage: shard add <key> <task description>\n");
+            return;
+        }
+        shard = shard_submit(sharded_queue, key, args);
+        if (shard >= 0) {
+            printf("[Shard] Task with key \"%s\" queued on shard %d\n", key, shard);
+        }
+    }
+    else if (strcmp(sub, "resize") == 0) {
+        if (sscanf(args, "%d", &count) != 1 || count < 1 || count > SHARD_MAX_COUNT) {
+            printf("Usage: shard resize <shards 1-%d>\n", SHARD_MAX_COUNT);
+            return;
+        }
+        if (shard_resize(sharded_queue, count) == SHARD_OK) {
+            printf("[Shard] Rebalanced to %d shards\n", count);
+        } else {
+            printf("[Shard] Resize failed, keeping %d shards\n", shard_count(sharded_queue));
+        }
+    }
+    else if (strcmp(sub, "list") == 0) {
+        shard_print(sharded_queue);
+    }
+    else if (strcmp(sub, "stop") == 0) {
+        shard_destroy(sharded_queue);
+        sharded_queue = NULL;
+        printf("[Shard] All shard workers stopped.\n");
+    }
+    else {
+        printf("Usage: shard start|add|resize|list|stop. Type 'help' for details.\n");
+    }
+}
+
 /**
  * @brief Đọc một dòng input từ stdin
  * @param buffer Buffer để lưu input
@@ -166,6 +612,18 @@ int main(void)
         if (strcmp(command, "add") == 0) {
             handle_add_command(args);
         }
+        else if (strcmp(command, "addp") == 0) {
+            handle_addp_command(args);
+        }
+        else if (strcmp(command, "limit") == 0) {
+            handle_limit_command(args);
+        }
+        else if (strcmp(command, "watermark") == 0) {
+            handle_watermark_command(args);
+        }
+        else if (strcmp(command, "codel") == 0) {
+            handle_codel_command(args);
+        }
         else if (strcmp(command, "run") == 0) {
             handle_run_command();
         }
@@ -178,6 +636,15 @@ int main(void)
         else if (strcmp(command, "log") == 0) {
             history_print_all();
         }
+        else if (strcmp(command, "stats") == 0) {
+            handle_stats_command(args);
+        }
+        else if (strcmp(command, "dag") == 0) {
+            handle_dag_command(args);
+        }
+        else if (strcmp(command, "shard") == 0) {
+            handle_shard_command(args);
+        }
         else if (strcmp(command, "help") == 0) {
             print_menu();
         }
@@ -192,8 +659,11 @@ int main(void)
     
     /* Dọn dẹp bộ nhớ trước khi thoát */
     printf("\nCleaning up...\n");
+    metrics_stop_periodic();
+    shard_destroy(sharded_queue);
     queue_destroy();
     history_destroy();
+    dag_destroy(task_dag);
     
     printf("Goodbye!\n\n");
     
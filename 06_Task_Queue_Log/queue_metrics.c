@@ -0,0 +1,342 @@
+/**
+ * @file queue_metrics.c
+ * @brief Triển khai Queue Metrics
+ *
+ * Toàn bộ metrics nằm trong một struct duy nhất được bảo vệ bởi mutex:
+ * - Hook cập nhật chỉ tăng/giảm bộ đếm hoặc ghi một bucket: O(1)
+ * - Snapshot copy nguyên struct dưới lock nên luôn nhất quán
+ * - Thread ghi định kỳ chỉ giữ lock trong lúc copy, không trong lúc ghi file
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "queue_metrics.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+/* Kích thước tối đa đường dẫn file snapshot */
+#define METRICS_PATH_SIZE 256
+
+/* ======================== GLOBAL VARIABLES ======================== */
+
+static QueueMetrics_t metrics;
+static pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* NULL = CLOCK_MONOTONIC */
+static MetricsClockFn metrics_clock = NULL;
+
+/* Trạng thái của thread ghi snapshot định kỳ */
+static struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wakeup;
+    int running;
+    int stop;
+    unsigned int interval_sec;
+    char path[METRICS_PATH_SIZE];
+} periodic = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wakeup = PTHREAD_COND_INITIALIZER,
+};
+
+/* Các percentile được in và xuất */
+static const double report_percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+#define NUM_REPORT_PERCENTILES \
+    (sizeof(report_percentiles) / sizeof(report_percentiles[0]))
+
+/* ======================== UPDATE HOOKS ======================== */
+
+uint64_t metrics_now_ns(void)
+{
+    struct timespec ts;
+
+    if (metrics_clock != NULL) {
+        return metrics_clock();
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void metrics_set_clock(MetricsClockFn clock)
+{
+    metrics_clock = clock;
+}
+
+void metrics_on_enqueue(void)
+{
+    pthread_mutex_lock(&metrics_lock);
+    metrics.enqueued++;
+    metrics.depth++;
+    if (metrics.depth > metrics.max_depth) {
+        metrics.max_depth = metrics.depth;
+    }
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+void metrics_on_dequeue(uint64_t wait_ns)
+{
+    pthread_mutex_lock(&metrics_lock);
+    metrics.dequeued++;
+    metrics.depth--;
+    hist_record(&metrics.wait_ns, wait_ns);
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+void metrics_on_drop(void)
+{
+    pthread_mutex_lock(&metrics_lock);
+    metrics.dropped++;
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+void metrics_on_complete(uint64_t exec_ns)
+{
+    pthread_mutex_lock(&metrics_lock);
+    metrics.completed++;
+    hist_record(&metrics.exec_ns, exec_ns);
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+void metrics_on_discard(uint64_t count)
+{
+    pthread_mutex_lock(&metrics_lock);
+    metrics.dropped += count;
+    metrics.depth -= count;
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+void metrics_snapshot(QueueMetrics_t* out)
+{
+    pthread_mutex_lock(&metrics_lock);
+    *out = metrics;
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+uint64_t metrics_depth(void)
+{
+    uint64_t depth;
+
+    pthread_mutex_lock(&metrics_lock);
+    depth = metrics.depth;
+    pthread_mutex_unlock(&metrics_lock);
+    return depth;
+}
+
+void metrics_reset(void)
+{
+    uint64_t depth;
+
+    pthread_mutex_lock(&metrics_lock);
+    depth = metrics.depth;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.depth = depth;
+    metrics.max_depth = depth;
+    pthread_mutex_unlock(&metrics_lock);
+}
+
+/* ======================== REPORTING ======================== */
+
+/**
+ * @brief In một dòng thống kê histogram (đơn vị microsecond)
+ */
+static void print_hist_line(const char* name, const LatencyHist_t* hist)
+{
+    size_t i;
+
+    if (hist->count == 0) {
+        printf("  %-6s (no samples)\n", name);
+        return;
+    }
+
+    printf("  %-6s n=%-8llu mean=%.1f min=%.1f",
+           name, (unsigned long long)hist->count,
+           hist_mean(hist) / 1e3, (double)hist->min / 1e3);
+    for (i = 0; i < NUM_REPORT_PERCENTILES; i++) {
+        printf(" p%g=%.1f", report_percentiles[i],
+               (double)hist_percentile(hist, report_percentiles[i]) / 1e3);
+    }
+    printf(" max=%.1f\n", (double)hist->max / 1e3);
+}
+
+void metrics_print(void)
+{
+    QueueMetrics_t snap;
+
+    metrics_snapshot(&snap);
+
+    printf("\n========== QUEUE STATS ==========\n");
+    printf("  Depth:     %llu (max %llu)\n",
+           (unsigned long long)snap.depth, (unsigned long long)snap.max_depth);
+    printf("  Enqueued:  %llu\n", (unsigned long long)snap.enqueued);
+    printf("  Dequeued:  %llu\n", (unsigned long long)snap.dequeued);
+    printf("  Dropped:   %llu\n", (unsigned long long)snap.dropped);
+    printf("  Completed: %llu\n", (unsigned long long)snap.completed);
+    printf("  Latency (us):\n");
+    print_hist_line("wait", &snap.wait_ns);
+    print_hist_line("exec", &snap.exec_ns);
+    printf("=================================\n\n");
+}
+
+/**
+ * @brief Xuất một histogram dưới dạng Prometheus summary (đơn vị giây)
+ */
+static void export_summary(FILE* out, const char* name, const char* help,
+                           const LatencyHist_t* hist)
+{
+    size_t i;
+
+    fprintf(out, "# HELP %s %s\n", name, help);
+    fprintf(out, "# TYPE %s summary\n", name);
+    for (i = 0; i < NUM_REPORT_PERCENTILES; i++) {
+        fprintf(out, "%s{quantile=\"%g\"} %.9f\n", name,
+                report_percentiles[i] / 100.0,
+                (double)hist_percentile(hist, report_percentiles[i]) / 1e9);
+    }
+    fprintf(out, "%s_sum %.9f\n", name, (double)hist->sum / 1e9);
+    fprintf(out, "%s_count %llu\n", name, (unsigned long long)hist->count);
+}
+
+static void export_value(FILE* out, const char* name, const char* type,
+                         const char* help, uint64_t value)
+{
+    fprintf(out, "# HELP %s %s\n", name, help);
+    fprintf(out, "# TYPE %s %s\n", name, type);
+    fprintf(out, "%s %llu\n", name, (unsigned long long)value);
+}
+
+int metrics_export_prometheus(FILE* out)
+{
+    QueueMetrics_t snap;
+
+    metrics_snapshot(&snap);
+
+    export_value(out, "task_queue_depth", "gauge",
+                 "Number of tasks waiting in the queue", snap.depth);
+    export_value(out, "task_queue_max_depth", "gauge",
+                 "Highest queue depth observed", snap.max_depth);
+    export_value(out, "task_queue_enqueued_total", "counter",
+                 "Tasks added to the queue", snap.enqueued);
+    export_value(out, "task_queue_dequeued_total", "counter",
+                 "Tasks taken from the queue", snap.dequeued);
+    export_value(out, "task_queue_dropped_total", "counter",
+                 "Tasks dropped by the queue", snap.dropped);
+    export_value(out, "task_queue_completed_total", "counter",
+                 "Tasks reported as completed", snap.completed);
+    export_summary(out, "task_queue_wait_seconds",
+                   "Time tasks spent waiting in the queue", &snap.wait_ns);
+    export_summary(out, "task_queue_exec_seconds",
+                   "Time from dequeue to task completion", &snap.exec_ns);
+
+    return ferror(out) ? -1 : 0;
+}
+
+int metrics_write_file(const char* path)
+{
+    char tmp_path[METRICS_PATH_SIZE + 8];
+    FILE* file;
+    int result;
+
+    /* Ghi file tạm rồi rename để bên đọc không bao giờ thấy file ghi dở */
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    file = fopen(tmp_path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Error: Cannot open %s: %s\n", tmp_path, strerror(errno));
+        return -1;
+    }
+
+    result = metrics_export_prometheus(file);
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    if (result == 0 && rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Error: Cannot rename %s: %s\n", tmp_path, strerror(errno));
+        result = -1;
+    }
+    if (result != 0) {
+        remove(tmp_path);
+    }
+    return result;
+}
+
+/* ======================== PERIODIC SNAPSHOT ======================== */
+
+/**
+ * @brief Thread nền - ghi snapshot rồi ngủ interval_sec giây
+ *
+ * Dùng pthread_cond_timedwait để metrics_stop_periodic() đánh thức ngay
+ * thay vì phải chờ hết chu kỳ.
+ */
+static void* periodic_worker(void* arg)
+{
+    struct timespec deadline;
+    char path[METRICS_PATH_SIZE];
+
+    (void)arg;
+
+    pthread_mutex_lock(&periodic.lock);
+    while (!periodic.stop) {
+        strncpy(path, periodic.path, sizeof(path));
+        pthread_mutex_unlock(&periodic.lock);
+
+        metrics_write_file(path);
+
+        pthread_mutex_lock(&periodic.lock);
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += periodic.interval_sec;
+        while (!periodic.stop &&
+               pthread_cond_timedwait(&periodic.wakeup, &periodic.lock, &deadline) != ETIMEDOUT) {
+            /* Bỏ qua spurious wakeup */
+        }
+    }
+    pthread_mutex_unlock(&periodic.lock);
+    return NULL;
+}
+
+int metrics_start_periodic(const char* path, unsigned int interval_sec)
+{
+    if (path == NULL || interval_sec == 0 || strlen(path) >= METRICS_PATH_SIZE) {
+        return -1;
+    }
+
+    metrics_stop_periodic();
+
+    pthread_mutex_lock(&periodic.lock);
+    strncpy(periodic.path, path, METRICS_PATH_SIZE - 1);
+    periodic.path[METRICS_PATH_SIZE - 1] = '\0';
+    periodic.interval_sec = interval_sec;
+    periodic.stop = 0;
+    if (pthread_create(&periodic.thread, NULL, periodic_worker, NULL) != 0) {
+        pthread_mutex_unlock(&periodic.lock);
+        fprintf(stderr, "Error: Failed to start metrics snapshot thread\n");
+        return -1;
+    }
+    periodic.running = 1;
+    pthread_mutex_unlock(&periodic.lock);
+    return 0;
+}
+
+void metrics_stop_periodic(void)
+{
+    pthread_t thread;
+
+    /*
+     * running được xóa dưới lock trước khi báo hiệu: chỉ một caller lấy
+     * được thread để join, và metrics_start_periodic() không bao giờ đọc
+     * running trong lúc nó đang bị ghi.
+     */
+    pthread_mutex_lock(&periodic.lock);
+    if (!periodic.running) {
+        pthread_mutex_unlock(&periodic.lock);
+        return;
+    }
+    periodic.running = 0;
+    periodic.stop = 1;
+    thread = periodic.thread;
+    pthread_cond_signal(&periodic.wakeup);
+    pthread_mutex_unlock(&periodic.lock);
+
+    pthread_join(thread, NULL);
+}
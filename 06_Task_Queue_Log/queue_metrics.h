@@ -0,0 +1,109 @@
+/**
+ * @file queue_metrics.h
+ * @brief Header file cho Queue Metrics - Bộ đếm và histogram độ trễ của Task Queue
+ *
+ * Các bộ đếm được cập nhật O(1) ngay trong enqueue/dequeue nên việc đọc
+ * độ sâu hàng đợi không cần duyệt danh sách:
+ * - depth, enqueued, dequeued, dropped
+ * - Histogram thời gian chờ trong hàng đợi (enqueue -> dequeue)
+ * - Histogram thời gian thực thi (dequeue -> hoàn thành)
+ *
+ * Snapshot có thể in ra console, xuất theo định dạng text của Prometheus,
+ * hoặc ghi định kỳ ra file bởi một thread nền.
+ */
+
+#ifndef QUEUE_METRICS_H
+#define QUEUE_METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "latency_hist.h"
+
+/**
+ * @brief Snapshot toàn bộ metrics tại một thời điểm
+ */
+typedef struct {
+    uint64_t depth;          /* Số tác vụ đang chờ */
+    uint64_t max_depth;      /* Độ sâu lớn nhất từng đạt */
+    uint64_t enqueued;       /* Tổng số tác vụ đã vào hàng đợi */
+    uint64_t dequeued;       /* Tổng số tác vụ đã lấy ra */
+    uint64_t dropped;        /* Tổng số tác vụ bị bỏ (không vào được hoặc bị loại) */
+    uint64_t completed;      /* Tổng số tác vụ đã báo hoàn thành */
+    LatencyHist_t wait_ns;   /* Thời gian chờ trong hàng đợi */
+    LatencyHist_t exec_ns;   /* Thời gian thực thi */
+} QueueMetrics_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/* Nguồn thời gian thay thế (nanosecond), cho kiểm tra với đồng hồ giả lập */
+typedef uint64_t (*MetricsClockFn)(void);
+
+/**
+ * @brief Thời gian monotonic hiện tại (nanosecond), dùng cho timestamp tác vụ
+ */
+uint64_t metrics_now_ns(void);
+
+/**
+ * @brief Đổi nguồn thời gian của metrics_now_ns() (NULL = CLOCK_MONOTONIC)
+ *
+ * Chỉ gọi khi chưa có thread nào khác dùng hàng đợi.
+ */
+void metrics_set_clock(MetricsClockFn clock);
+
+/* Các hook được task_queue.c gọi - mỗi hook O(1) */
+void metrics_on_enqueue(void);
+void metrics_on_dequeue(uint64_t wait_ns);
+void metrics_on_drop(void);
+void metrics_on_complete(uint64_t exec_ns);
+
+/**
+ * @brief Bỏ count tác vụ đang nằm trong hàng đợi (depth giảm, dropped tăng)
+ */
+void metrics_on_discard(uint64_t count);
+
+/**
+ * @brief Lấy snapshot nhất quán của metrics hiện tại
+ */
+void metrics_snapshot(QueueMetrics_t* out);
+
+/**
+ * @brief Độ sâu hiện tại của hàng đợi - O(1)
+ */
+uint64_t metrics_depth(void);
+
+/**
+ * @brief Xóa histogram và bộ đếm tích lũy (giữ nguyên depth)
+ */
+void metrics_reset(void);
+
+/**
+ * @brief In metrics dạng bảng ra console
+ */
+void metrics_print(void);
+
+/**
+ * @brief Xuất metrics theo định dạng text của Prometheus
+ * @return 0 nếu thành công, -1 nếu lỗi ghi
+ */
+int metrics_export_prometheus(FILE* out);
+
+/**
+ * @brief Ghi snapshot Prometheus ra file (ghi file tạm rồi rename)
+ * @return 0 nếu thành công, -1 nếu lỗi
+ */
+int metrics_write_file(const char* path);
+
+/**
+ * @brief Bật thread nền ghi snapshot ra file sau mỗi interval_sec giây
+ * @return 0 nếu thành công, -1 nếu lỗi
+ * @note Gọi lại sẽ thay thế cấu hình cũ
+ */
+int metrics_start_periodic(const char* path, unsigned int interval_sec);
+
+/**
+ * @brief Dừng thread ghi snapshot định kỳ (nếu đang chạy)
+ */
+void metrics_stop_periodic(void);
+
+#endif /* QUEUE_METRICS_H */
@@ -0,0 +1,631 @@
+/**
+ * @file task_dag.c
+ * @brief Triển khai Task DAG - Thực thi tác vụ theo đồ thị phụ thuộc
+ *
+ * Mỗi tác vụ lưu danh sách successor (tác vụ đứng sau) và predecessor
+ * (tác vụ đứng trước). Khi chạy:
+ * - pending_deps (atomic) khởi tạo bằng số predecessor
+ * - Tác vụ có pending_deps == 0 nằm sẵn trong ready queue
+ * - Worker lấy tác vụ từ ready queue, chạy, rồi giảm pending_deps
+ *   của từng successor; successor nào về 0 thì được đưa vào ready queue
+ *
+ * Ready queue là ring buffer có sức chứa bằng số tác vụ (mỗi tác vụ
+ * vào queue đúng một lần), được bảo vệ bởi mutex + condition variable.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_dag.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+/* Sức chứa ban đầu của các mảng động */
+#define DAG_INITIAL_CAPACITY 8
+
+/* ======================== INTERNAL STRUCTURES ======================== */
+
+/**
+ * @brief Một tác vụ trong DAG
+ */
+typedef struct {
+    char description[TASK_DESC_SIZE];
+    int* successors;             /* Các tác vụ phụ thuộc vào tác vụ này */
+    int num_successors;
+    int cap_successors;
+    int* predecessors;           /* Các tác vụ mà tác vụ này phụ thuộc vào */
+    int num_predecessors;
+    int cap_predecessors;
+    atomic_int pending_deps;     /* In-degree động trong lúc chạy */
+    atomic_int upstream_failed;  /* 1 nếu có predecessor lỗi hoặc bị bỏ qua */
+    DagTaskState_t state;
+    uint64_t start_ns;
+    uint64_t finish_ns;
+    int on_critical_path;
+} DagNode_t;
+
+/**
+ * @brief Tham số của một worker thread
+ *
+ * released được cấp phát trước trong dag_execute() (đủ chỗ cho số
+ * successor lớn nhất) để lỗi cấp phát được báo cho caller thay vì
+ * làm worker thoát im lặng giữa chừng.
+ */
+typedef struct {
+    struct TaskDag* dag;
+    int* released;               /* Các successor vừa về 0 của tác vụ vừa chạy */
+} DagWorker_t;
+
+struct TaskDag {
+    DagNode_t* nodes;
+    int num_nodes;
+    int cap_nodes;
+
+    /* Trạng thái của lần chạy hiện tại/gần nhất */
+    pthread_mutex_t lock;
+    pthread_cond_t ready_cond;
+    int* ready;                  /* Ring buffer các id sẵn sàng chạy */
+    int ready_head;
+    int ready_count;
+    int remaining;               /* Số tác vụ chưa kết thúc */
+    int* completion;             /* Thứ tự kết thúc của các tác vụ */
+    int completion_count;
+    DagTaskFn fn;
+    void* user_ctx;
+    uint64_t run_start_ns;
+    DagReport_t last_report;
+};
+
+/* ======================== HELPER FUNCTIONS ======================== */
+
+/**
+ * @brief Thời gian monotonic hiện tại (nanosecond)
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Thêm value vào mảng int động, tự tăng sức chứa khi cần
+ * @return DAG_OK hoặc DAG_ERR_NOMEM
+ */
+static int int_array_push(int** array, int* count, int* capacity, int value)
+{
+    int* grown;
+    int new_capacity;
+
+    if (*count == *capacity) {
+        new_capacity = (*capacity == 0) ? DAG_INITIAL_CAPACITY : *capacity * 2;
+        grown = (int*)realloc(*array, (size_t)new_capacity * sizeof(int));
+        if (grown == NULL) {
+            return DAG_ERR_NOMEM;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+
+    (*array)[(*count)++] = value;
+    return DAG_OK;
+}
+
+static int is_valid_id(const TaskDag_t* dag, int task_id)
+{
+    return dag != NULL && task_id >= 0 && task_id < dag->num_nodes;
+}
+
+/**
+ * @brief Kiểm tra target có thể đi tới được từ start theo cạnh successor
+ *
+ * DFS không đệ quy với stack tường minh để tránh tràn stack trên DAG sâu.
+ *
+ * @return 1 nếu tới được, 0 nếu không, DAG_ERR_NOMEM nếu hết bộ nhớ
+ */
+static int is_reachable(const TaskDag_t* dag, int start, int target)
+{
+    unsigned char* visited;
+    int* stack;
+    int top = 0;
+    int found = 0;
+    int node;
+    int i;
+
+    visited = (unsigned char*)calloc((size_t)dag->num_nodes, 1);
+    stack = (int*)malloc((size_t)dag->num_nodes * sizeof(int));
+    if (visited == NULL || stack == NULL) {
+        free(visited);
+        free(stack);
+        return DAG_ERR_NOMEM;
+    }
+
+    stack[top++] = start;
+    visited[start] = 1;
+
+    while (top > 0 && !found) {
+        node = stack[--top];
+        if (node == target) {
+            found = 1;
+            break;
+        }
+        for (i = 0; i < dag->nodes[node].num_successors; i++) {
+            int next = dag->nodes[node].successors[i];
+            if (!visited[next]) {
+                visited[next] = 1;
+                stack[top++] = next;
+            }
+        }
+    }
+
+    free(visited);
+    free(stack);
+    return found;
+}
+
+/**
+ * @brief Tính critical path từ thời gian đo được của lần chạy gần nhất
+ *
+ * Duyệt các tác vụ theo thứ tự hoàn thành (luôn là một thứ tự topo hợp lệ):
+ *   finish[i] = duration[i] + max(finish[p]) với p là predecessor của i
+ * Tác vụ có finish lớn nhất là điểm cuối của critical path; lần ngược
+ * theo predecessor tốt nhất để đánh dấu các tác vụ trên đường đi.
+ */
+static void compute_critical_path(TaskDag_t* dag, DagReport_t* report)
+{
+    uint64_t* path_ns;
+    int* best_pred;
+    uint64_t best_total = 0;
+    int end_node = -1;
+    int i;
+    int j;
+
+    report->critical_path_ns = 0;
+    report->critical_path_len = 0;
+    report->total_work_ns = 0;
+
+    for (i = 0; i < dag->num_nodes; i++) {
+        dag->nodes[i].on_critical_path = 0;
+    }
+
+    path_ns = (uint64_t*)calloc((size_t)dag->num_nodes, sizeof(uint64_t));
+    best_pred = (int*)malloc((size_t)dag->num_nodes * sizeof(int));
+    if (path_ns == NULL || best_pred == NULL) {
+        free(path_ns);
+        free(best_pred);
+        return;
+    }
+
+    for (i = 0; i < dag->completion_count; i++) {
+        int id = dag->completion[i];
+        DagNode_t* node = &dag->nodes[id];
+        uint64_t duration = node->finish_ns - node->start_ns;
+        uint64_t longest_pred = 0;
+
+        best_pred[id] = -1;
+        for (j = 0; j < node->num_predecessors; j++) {
+            int pred = node->predecessors[j];
+            if (best_pred[id] == -1 || path_ns[pred] > longest_pred) {
+                longest_pred = path_ns[pred];
+                best_pred[id] = pred;
+            }
+        }
+
+        path_ns[id] = longest_pred + duration;
+        report->total_work_ns += duration;
+
+        if (end_node == -1 || path_ns[id] > best_total) {
+            best_total = path_ns[id];
+            end_node = id;
+        }
+    }
+
+    report->critical_path_ns = best_total;
+    for (i = end_node; i != -1; i = best_pred[i]) {
+        dag->nodes[i].on_critical_path = 1;
+        report->critical_path_len++;
+    }
+
+    free(path_ns);
+    free(best_pred);
+}
+
+/**
+ * @brief Vòng lặp của mỗi worker thread
+ *
+ * 1. Chờ tới khi ready queue có tác vụ hoặc mọi tác vụ đã kết thúc
+ * 2. Chạy tác vụ (hoặc bỏ qua nếu predecessor bị lỗi)
+ * 3. Giảm atomic pending_deps của các successor, gom những tác vụ về 0
+ * 4. Đưa các tác vụ đó vào ready queue và đánh thức các worker khác
+ */
+static void* dag_worker(void* arg)
+{
+    DagWorker_t* worker = (DagWorker_t*)arg;
+    TaskDag_t* dag = worker->dag;
+    int* released = worker->released;
+    int num_released;
+    int id;
+    int i;
+
+    while (1) {
+        DagNode_t* node;
+        int rc;
+
+        pthread_mutex_lock(&dag->lock);
+        while (dag->ready_count == 0 && dag->remaining > 0) {
+            pthread_cond_wait(&dag->ready_cond, &dag->lock);
+        }
+        if (dag->remaining == 0) {
+            pthread_mutex_unlock(&dag->lock);
+            break;
+        }
+        id = dag->ready[dag->ready_head];
+        dag->ready_head = (dag->ready_head + 1) % dag->num_nodes;
+        dag->ready_count--;
+        pthread_mutex_unlock(&dag->lock);
+
+        node = &dag->nodes[id];
+        node->start_ns = now_ns();
+        if (atomic_load(&node->upstream_failed)) {
+            node->state = DAG_TASK_SKIPPED;
+            node->finish_ns = node->start_ns;
+        } else {
+            rc = dag->fn(id, node->description, dag->user_ctx);
+            node->finish_ns = now_ns();
+            node->state = (rc == 0) ? DAG_TASK_DONE : DAG_TASK_FAILED;
+        }
+
+        /*
+         * Đánh dấu lỗi TRƯỚC khi giảm bộ đếm: thread nào đưa bộ đếm về 0
+         * sẽ thấy cờ upstream_failed nhờ thứ tự seq_cst của atomic.
+         */
+        num_released = 0;
+        for (i = 0; i < node->num_successors; i++) {
+            DagNode_t* succ = &dag->nodes[node->successors[i]];
+            if (node->state != DAG_TASK_DONE) {
+                atomic_store(&succ->upstream_failed, 1);
+            }
+            if (atomic_fetch_sub(&succ->pending_deps, 1) == 1) {
+                released[num_released++] = node->successors[i];
+            }
+        }
+
+        pthread_mutex_lock(&dag->lock);
+        for (i = 0; i < num_released; i++) {
+            int tail = (dag->ready_head + dag->ready_count) % dag->num_nodes;
+            dag->ready[tail] = released[i];
+            dag->ready_count++;
+        }
+        dag->completion[dag->completion_count++] = id;
+        dag->remaining--;
+        if (dag->remaining == 0 || num_released > 1) {
+            pthread_cond_broadcast(&dag->ready_cond);
+        } else if (num_released == 1) {
+            pthread_cond_signal(&dag->ready_cond);
+        }
+        pthread_mutex_unlock(&dag->lock);
+    }
+
+    return NULL;
+}
+
+/* ======================== FUNCTION IMPLEMENTATIONS ======================== */
+
+TaskDag_t* dag_create(void)
+{
+    TaskDag_t* dag;
+
+    dag = (TaskDag_t*)calloc(1, sizeof(TaskDag_t));
+    if (dag == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return NULL;
+    }
+
+    pthread_mutex_init(&dag->lock, NULL);
+    pthread_cond_init(&dag->ready_cond, NULL);
+    return dag;
+}
+
+void dag_destroy(TaskDag_t* dag)
+{
+    int i;
+
+    if (dag == NULL) {
+        return;
+    }
+
+    for (i = 0; i < dag->num_nodes; i++) {
+        free(dag->nodes[i].successors);
+        free(dag->nodes[i].predecessors);
+    }
+    free(dag->nodes);
+    free(dag->ready);
+    free(dag->completion);
+    pthread_mutex_destroy(&dag->lock);
+    pthread_cond_destroy(&dag->ready_cond);
+    free(dag);
+}
+
+int dag_add_task(TaskDag_t* dag, const char* description)
+{
+    DagNode_t* grown;
+    DagNode_t* node;
+    int new_capacity;
+
+    if (dag == NULL || description == NULL) {
+        fprintf(stderr, "Error: Task description cannot be NULL\n");
+        return DAG_ERR_INVALID;
+    }
+
+    if (dag->num_nodes == dag->cap_nodes) {
+        new_capacity = (dag->cap_nodes == 0) ? DAG_INITIAL_CAPACITY : dag->cap_nodes * 2;
+        grown = (DagNode_t*)realloc(dag->nodes, (size_t)new_capacity * sizeof(DagNode_t));
+        if (grown == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            return DAG_ERR_NOMEM;
+        }
+        dag->nodes = grown;
+        dag->cap_nodes = new_capacity;
+    }
+
+    node = &dag->nodes[dag->num_nodes];
+    memset(node, 0, sizeof(*node));
+    strncpy(node->description, description, TASK_DESC_SIZE - 1);
+    node->description[TASK_DESC_SIZE - 1] = '\0';
+    atomic_init(&node->pending_deps, 0);
+    atomic_init(&node->upstream_failed, 0);
+    node->state = DAG_TASK_PENDING;
+
+    return dag->num_nodes++;
+}
+
+int dag_add_dependency(TaskDag_t* dag, int task_id, int depends_on_id)
+{
+    DagNode_t* task;
+    DagNode_t* dep;
+    int reachable;
+    int i;
+
+    if (!is_valid_id(dag, task_id) || !is_valid_id(dag, depends_on_id)) {
+        return DAG_ERR_INVALID;
+    }
+
+    /* Tự phụ thuộc vào chính mình là chu trình độ dài 1 */
+    if (task_id == depends_on_id) {
+        return DAG_ERR_CYCLE;
+    }
+
+    task = &dag->nodes[task_id];
+    for (i = 0; i < task->num_predecessors; i++) {
+        if (task->predecessors[i] == depends_on_id) {
+            return DAG_ERR_DUPLICATE;
+        }
+    }
+
+    /*
+     * Cạnh mới: depends_on_id -> task_id.
+     * Nếu từ task_id đã đi tới được depends_on_id thì cạnh này khép kín chu trình.
+     */
+    reachable = is_reachable(dag, task_id, depends_on_id);
+    if (reachable < 0) {
+        return reachable;
+    }
+    if (reachable) {
+        return DAG_ERR_CYCLE;
+    }
+
+    dep = &dag->nodes[depends_on_id];
+    if (int_array_push(&dep->successors, &dep->num_successors,
+                       &dep->cap_successors, task_id) != DAG_OK) {
+        return DAG_ERR_NOMEM;
+    }
+    if (int_array_push(&task->predecessors, &task->num_predecessors,
+                       &task->cap_predecessors, depends_on_id) != DAG_OK) {
+        dep->num_successors--;
+        return DAG_ERR_NOMEM;
+    }
+
+    return DAG_OK;
+}
+
+int dag_execute(TaskDag_t* dag, int num_workers, DagTaskFn fn, void* user_ctx,
+                DagReport_t* report)
+{
+    pthread_t workers[DAG_MAX_WORKERS];
+    DagWorker_t args[DAG_MAX_WORKERS];
+    int started = 0;
+    int* ready;
+    int* completion;
+    int* released;
+    int max_successors = 1;
+    int i;
+
+    if (dag == NULL || fn == NULL || num_workers < 1 || num_workers > DAG_MAX_WORKERS) {
+        return DAG_ERR_INVALID;
+    }
+
+    memset(&dag->last_report, 0, sizeof(dag->last_report));
+    dag->last_report.num_workers = num_workers;
+    if (dag->num_nodes == 0) {
+        if (report != NULL) {
+            *report = dag->last_report;
+        }
+        return DAG_OK;
+    }
+
+    ready = (int*)realloc(dag->ready, (size_t)dag->num_nodes * sizeof(int));
+    if (ready == NULL) {
+        return DAG_ERR_NOMEM;
+    }
+    dag->ready = ready;
+    completion = (int*)realloc(dag->completion, (size_t)dag->num_nodes * sizeof(int));
+    if (completion == NULL) {
+        return DAG_ERR_NOMEM;
+    }
+    dag->completion = completion;
+
+    for (i = 0; i < dag->num_nodes; i++) {
+        if (dag->nodes[i].num_successors > max_successors) {
+            max_successors = dag->nodes[i].num_successors;
+        }
+    }
+    released = (int*)malloc((size_t)num_workers * (size_t)max_successors * sizeof(int));
+    if (released == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return DAG_ERR_NOMEM;
+    }
+
+    /* Khởi tạo in-degree động và nạp các tác vụ gốc vào ready queue */
+    dag->ready_head = 0;
+    dag->ready_count = 0;
+    dag->completion_count = 0;
+    dag->remaining = dag->num_nodes;
+    dag->fn = fn;
+    dag->user_ctx = user_ctx;
+
+    for (i = 0; i < dag->num_nodes; i++) {
+        DagNode_t* node = &dag->nodes[i];
+        atomic_store(&node->pending_deps, node->num_predecessors);
+        atomic_store(&node->upstream_failed, 0);
+        node->state = DAG_TASK_PENDING;
+        node->start_ns = 0;
+        node->finish_ns = 0;
+        if (node->num_predecessors == 0) {
+            dag->ready[dag->ready_count++] = i;
+        }
+    }
+
+    dag->run_start_ns = now_ns();
+
+    for (i = 0; i < num_workers; i++) {
+        args[i].dag = dag;
+        args[i].released = released + (size_t)i * (size_t)max_successors;
+        if (pthread_create(&workers[i], NULL, dag_worker, &args[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+
+    if (started == 0) {
+        fprintf(stderr, "Error: Failed to start DAG worker threads\n");
+        free(released);
+        return DAG_ERR_THREAD;
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    free(released);
+
+    dag->last_report.makespan_ns = now_ns() - dag->run_start_ns;
+    dag->last_report.num_workers = started;
+    for (i = 0; i < dag->num_nodes; i++) {
+        switch (dag->nodes[i].state) {
+            case DAG_TASK_DONE:    dag->last_report.tasks_done++;    break;
+            case DAG_TASK_FAILED:  dag->last_report.tasks_failed++;  break;
+            case DAG_TASK_SKIPPED: dag->last_report.tasks_skipped++; break;
+            default: break;
+        }
+    }
+    compute_critical_path(dag, &dag->last_report);
+
+    if (report != NULL) {
+        *report = dag->last_report;
+    }
+
+    return (dag->last_report.tasks_done == dag->num_nodes) ? DAG_OK : 1;
+}
+
+int dag_task_count(const TaskDag_t* dag)
+{
+    return (dag == NULL) ? 0 : dag->num_nodes;
+}
+
+const char* dag_task_description(const TaskDag_t* dag, int task_id)
+{
+    return is_valid_id(dag, task_id) ? dag->nodes[task_id].description : NULL;
+}
+
+DagTaskState_t dag_task_state(const TaskDag_t* dag, int task_id)
+{
+    return is_valid_id(dag, task_id) ? dag->nodes[task_id].state : DAG_TASK_PENDING;
+}
+
+int dag_completion_order(const TaskDag_t* dag, int index)
+{
+    if (dag == NULL || index < 0 || index >= dag->completion_count) {
+        return -1;
+    }
+    return dag->completion[index];
+}
+
+/**
+ * @brief In danh sách tác vụ, id hiển thị bắt đầu từ 1
+ *
+ * Độ phức tạp: O(V + E)
+ */
+void dag_print(const TaskDag_t* dag)
+{
+    int i;
+    int j;
+
+    printf("\n========== TASK DAG ==========\n");
+
+    if (dag == NULL || dag->num_nodes == 0) {
+        printf("(DAG is empty)\n");
+    } else {
+        for (i = 0; i < dag->num_nodes; i++) {
+            const DagNode_t* node = &dag->nodes[i];
+            printf("  #%d %s", i + 1, node->description);
+            if (node->num_predecessors > 0) {
+                printf("  <- after");
+                for (j = 0; j < node->num_predecessors; j++) {
+                    printf(" #%d", node->predecessors[j] + 1);
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    printf("==============================\n\n");
+}
+
+void dag_print_report(const TaskDag_t* dag, const DagReport_t* report)
+{
+    static const char* const state_names[] = { "PENDING", "DONE", "FAILED", "SKIPPED" };
+    const DagReport_t* r;
+    int i;
+
+    if (dag == NULL) {
+        return;
+    }
+    r = (report != NULL) ? report : &dag->last_report;
+
+    printf("\n========== DAG EXECUTION REPORT ==========\n");
+    printf("  %-4s %-8s %10s %10s  %s\n", "ID", "STATE", "START(ms)", "TIME(ms)", "TASK");
+    for (i = 0; i < dag->completion_count; i++) {
+        int id = dag->completion[i];
+        const DagNode_t* node = &dag->nodes[id];
+        printf("%c #%-3d %-8s %10.3f %10.3f  %s\n",
+               node->on_critical_path ? '*' : ' ',
+               id + 1,
+               state_names[node->state],
+               (double)(node->start_ns - dag->run_start_ns) / 1e6,
+               (double)(node->finish_ns - node->start_ns) / 1e6,
+               node->description);
+    }
+    printf("------------------------------------------\n");
+    printf("Workers:         %d\n", r->num_workers);
+    printf("Tasks:           %d done, %d failed, %d skipped\n",
+           r->tasks_done, r->tasks_failed, r->tasks_skipped);
+    printf("Makespan:        %.3f ms\n", (double)r->makespan_ns / 1e6);
+    printf("Total work:      %.3f ms\n", (double)r->total_work_ns / 1e6);
+    printf("Critical path:   %.3f ms (%d tasks, marked *)\n",
+           (double)r->critical_path_ns / 1e6, r->critical_path_len);
+    if (r->makespan_ns > 0) {
+        printf("Parallelism:     %.2fx\n", (double)r->total_work_ns / (double)r->makespan_ns);
+    }
+    printf("==========================================\n\n");
+}
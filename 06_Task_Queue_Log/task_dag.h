@@ -0,0 +1,152 @@
+/**
+ * @file task_dag.h
+ * @brief Header file cho Task DAG - Đồ thị phụ thuộc tác vụ (Directed Acyclic Graph)
+ *
+ * Mỗi tác vụ có thể khai báo các tác vụ phải hoàn thành trước nó.
+ * Executor theo dõi in-degree (số phụ thuộc chưa xong) của từng tác vụ
+ * bằng biến atomic và đưa tác vụ vào ready queue ngay khi tất cả
+ * tác vụ đứng trước đã hoàn thành:
+ * - Các nhánh độc lập được chạy song song trên nhiều worker thread
+ * - Chu trình bị phát hiện ngay lúc thêm phụ thuộc (không phải lúc chạy)
+ * - Sau khi chạy, báo cáo critical path (chuỗi phụ thuộc dài nhất)
+ */
+
+#ifndef TASK_DAG_H
+#define TASK_DAG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "task_queue.h"
+
+/* Số worker thread tối đa cho một lần thực thi */
+#define DAG_MAX_WORKERS 16
+
+/* Mã lỗi trả về từ các hàm DAG */
+#define DAG_OK             0
+#define DAG_ERR_INVALID   -1   /* Tham số không hợp lệ (id sai, NULL, ...) */
+#define DAG_ERR_NOMEM     -2   /* Cấp phát bộ nhớ thất bại */
+#define DAG_ERR_CYCLE     -3   /* Phụ thuộc mới sẽ tạo chu trình */
+#define DAG_ERR_DUPLICATE -4   /* Phụ thuộc đã tồn tại */
+#define DAG_ERR_THREAD    -5   /* Không tạo được worker thread */
+
+/**
+ * @brief Trạng thái của một tác vụ sau lần thực thi gần nhất
+ */
+typedef enum {
+    DAG_TASK_PENDING = 0,   /* Chưa chạy */
+    DAG_TASK_DONE,          /* Chạy thành công */
+    DAG_TASK_FAILED,        /* Hàm thực thi trả về lỗi */
+    DAG_TASK_SKIPPED        /* Bỏ qua vì một tác vụ đứng trước bị lỗi */
+} DagTaskState_t;
+
+/**
+ * @brief Hàm thực thi một tác vụ
+ * @param task_id Id của tác vụ (0-based)
+ * @param description Mô tả tác vụ
+ * @param user_ctx Con trỏ ngữ cảnh do caller truyền vào dag_execute()
+ * @return 0 nếu thành công, khác 0 nếu lỗi (các tác vụ phụ thuộc sẽ bị bỏ qua)
+ *
+ * @note Được gọi đồng thời từ nhiều worker thread
+ */
+typedef int (*DagTaskFn)(int task_id, const char* description, void* user_ctx);
+
+/**
+ * @brief Kết quả thời gian của một lần thực thi DAG
+ */
+typedef struct {
+    uint64_t makespan_ns;        /* Thời gian thực (wall-clock) từ lúc bắt đầu tới lúc xong */
+    uint64_t total_work_ns;      /* Tổng thời gian chạy của tất cả tác vụ */
+    uint64_t critical_path_ns;   /* Tổng thời gian chạy dọc theo critical path */
+    int critical_path_len;       /* Số tác vụ trên critical path */
+    int tasks_done;
+    int tasks_failed;
+    int tasks_skipped;
+    int num_workers;
+} DagReport_t;
+
+/* Kiểu opaque - cấu trúc bên trong nằm trong task_dag.c */
+typedef struct TaskDag TaskDag_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo một DAG rỗng
+ * @return Con trỏ tới DAG, hoặc NULL nếu cấp phát thất bại
+ */
+TaskDag_t* dag_create(void);
+
+/**
+ * @brief Giải phóng DAG và toàn bộ tác vụ
+ */
+void dag_destroy(TaskDag_t* dag);
+
+/**
+ * @brief Thêm một tác vụ vào DAG
+ * @param description Mô tả tác vụ (cắt bớt nếu dài hơn TASK_DESC_SIZE - 1)
+ * @return Id của tác vụ (0-based) hoặc mã lỗi DAG_ERR_* (< 0)
+ */
+int dag_add_task(TaskDag_t* dag, const char* description);
+
+/**
+ * @brief Khai báo task_id chỉ được chạy sau khi depends_on_id hoàn thành
+ *
+ * Kiểm tra chu trình ngay tại thời điểm thêm: nếu depends_on_id đã
+ * (trực tiếp hoặc gián tiếp) phụ thuộc vào task_id thì cạnh mới sẽ
+ * tạo chu trình và bị từ chối.
+ *
+ * Độ phức tạp: O(V + E) cho bước DFS kiểm tra chu trình
+ *
+ * @return DAG_OK hoặc mã lỗi DAG_ERR_*
+ */
+int dag_add_dependency(TaskDag_t* dag, int task_id, int depends_on_id);
+
+/**
+ * @brief Thực thi toàn bộ DAG với num_workers thread
+ *
+ * Các tác vụ có in-degree bằng 0 được đưa vào ready queue trước.
+ * Mỗi khi một tác vụ xong, in-degree của các tác vụ đứng sau được
+ * giảm atomic; tác vụ nào về 0 sẽ được đưa vào ready queue.
+ *
+ * @param num_workers Số worker thread (1..DAG_MAX_WORKERS)
+ * @param fn Hàm thực thi từng tác vụ
+ * @param user_ctx Con trỏ ngữ cảnh truyền cho fn
+ * @param report Nơi lưu kết quả thời gian (có thể NULL)
+ * @return DAG_OK nếu mọi tác vụ thành công, 1 nếu có tác vụ lỗi/bị bỏ qua,
+ *         hoặc mã lỗi DAG_ERR_* (< 0)
+ */
+int dag_execute(TaskDag_t* dag, int num_workers, DagTaskFn fn, void* user_ctx,
+                DagReport_t* report);
+
+/**
+ * @brief Số tác vụ trong DAG
+ */
+int dag_task_count(const TaskDag_t* dag);
+
+/**
+ * @brief Mô tả của tác vụ, hoặc NULL nếu id không hợp lệ
+ */
+const char* dag_task_description(const TaskDag_t* dag, int task_id);
+
+/**
+ * @brief Trạng thái của tác vụ sau lần thực thi gần nhất
+ */
+DagTaskState_t dag_task_state(const TaskDag_t* dag, int task_id);
+
+/**
+ * @brief Id của tác vụ thứ index theo thứ tự hoàn thành ở lần chạy gần nhất
+ * @return Id tác vụ, hoặc -1 nếu index vượt quá số tác vụ đã kết thúc
+ */
+int dag_completion_order(const TaskDag_t* dag, int index);
+
+/**
+ * @brief In danh sách tác vụ và các phụ thuộc của chúng
+ */
+void dag_print(const TaskDag_t* dag);
+
+/**
+ * @brief In báo cáo thời gian và critical path của lần chạy gần nhất
+ */
+void dag_print_report(const TaskDag_t* dag, const DagReport_t* report);
+
+#endif /* TASK_DAG_H */
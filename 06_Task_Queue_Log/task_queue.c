@@ -1,15 +1,58 @@
 /**
  * @file task_queue.c
  * @brief Triển khai Task Queue - Hàng đợi FIFO sử dụng Singly Linked List
- * 
+ *
  * Hàng đợi sử dụng hai con trỏ:
  * - head: Trỏ tới đầu hàng đợi (nơi lấy tác vụ ra)
  * - tail: Trỏ tới cuối hàng đợi (nơi thêm tác vụ mới)
- * 
+ *
  * Điều này đảm bảo cả enqueue và dequeue đều O(1)
+ *
+ * Mỗi thao tác cập nhật bộ đếm trong queue_metrics.c (O(1)), nên độ sâu
+ * và thống kê độ trễ luôn có sẵn mà không cần duyệt danh sách.
+ *
+ * Admission control:
+ * - queue_lock bảo vệ danh sách, queue_count và trạng thái CoDel
+ * - not_empty / not_full là condition variable cho consumer / producer chờ
+ * - Callback watermark được gọi SAU khi nhả lock để tránh deadlock
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include "task_queue.h"
+#include "queue_metrics.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+/* Giá trị mặc định cho CoDel (RFC 8289) */
+#define CODEL_DEFAULT_TARGET_NS    (5ULL * 1000000ULL)     /* 5 ms */
+#define CODEL_DEFAULT_INTERVAL_NS  (100ULL * 1000000ULL)   /* 100 ms */
+#define CODEL_MAX_SOJOURN_FACTOR   10                      /* Sojourn tối đa = 10 x target */
+
+/* Sự kiện watermark cần báo sau khi nhả lock */
+typedef enum {
+    WATERMARK_NONE = 0,
+    WATERMARK_HIGH,
+    WATERMARK_LOW
+} WatermarkEvent_t;
+
+/**
+ * @brief Trạng thái của bộ điều khiển CoDel (RFC 8289)
+ *
+ * - first_above_time: thời điểm sojourn của tác vụ đầu hàng đợi đã vượt
+ *   target liên tục đủ một interval (0 = đang dưới target)
+ * - dropping: đang trong trạng thái loại; drop_next là lần loại kế tiếp,
+ *   cách lần trước interval / sqrt(count)
+ */
+typedef struct {
+    uint64_t first_above_time_ns;
+    uint64_t drop_next_ns;
+    uint32_t count;             /* Số tác vụ bị loại trong trạng thái dropping hiện tại */
+    uint32_t last_count;        /* count khi vào trạng thái dropping lần trước */
+    int dropping;
+} CodelState_t;
 
 /* ======================== GLOBAL VARIABLES ======================== */
 
@@ -19,44 +62,454 @@ static TaskNode_t* queue_head = NULL;
 /* Con trỏ tới cuối hàng đợi - nơi thêm tác vụ mới */
 static TaskNode_t* queue_tail = NULL;
 
+/* Số tác vụ đang chờ (dùng cho quyết định admission, dưới queue_lock) */
+static size_t queue_count = 0;
+
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t not_empty = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t not_full = PTHREAD_COND_INITIALIZER;
+
+static QueueConfig_t queue_config = {
+    .capacity = 0,
+    .policy = QUEUE_POLICY_BLOCK,
+    .codel_target_ns = CODEL_DEFAULT_TARGET_NS,
+    .codel_interval_ns = CODEL_DEFAULT_INTERVAL_NS,
+    .verbose = 1,
+};
+
+/* 1 khi độ sâu đã vượt high watermark và chưa về dưới low watermark */
+static int above_high_watermark = 0;
+
+static CodelState_t codel;
+
+/* ======================== HELPER FUNCTIONS ======================== */
+
+/**
+ * @brief Tính deadline tuyệt đối (CLOCK_REALTIME) sau timeout_ms cho pthread_cond_timedwait
+ */
+static void make_deadline(unsigned int timeout_ms, struct timespec* deadline)
+{
+    clock_gettime(CLOCK_REALTIME, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * @brief Tách node đầu khỏi hàng đợi (lock đã được giữ)
+ * @return Node đầu, hoặc NULL nếu rỗng
+ */
+static TaskNode_t* unlink_head(void)
+{
+    TaskNode_t* node = queue_head;
+
+    if (node == NULL) {
+        return NULL;
+    }
+    queue_head = node->next;
+    if (queue_head == NULL) {
+        queue_tail = NULL;
+    }
+    node->next = NULL;
+    queue_count--;
+    return node;
+}
+
+/**
+ * @brief Tách node có priority thấp nhất (cũ nhất nếu bằng nhau) khỏi hàng đợi
+ *
+ * Độ phức tạp: O(n) - chỉ chạy khi hàng đợi đầy với chính sách SHED_LOWEST
+ *
+ * @param incoming_priority Priority của tác vụ mới
+ * @return Node bị loại, hoặc NULL nếu không có node nào thấp hơn tác vụ mới
+ */
+static TaskNode_t* unlink_lowest_priority(int incoming_priority)
+{
+    TaskNode_t* prev = NULL;
+    TaskNode_t* current = queue_head;
+    TaskNode_t* victim = NULL;
+    TaskNode_t* victim_prev = NULL;
+
+    while (current != NULL) {
+        if (current->priority < incoming_priority &&
+            (victim == NULL || current->priority < victim->priority)) {
+            victim = current;
+            victim_prev = prev;
+        }
+        prev = current;
+        current = current->next;
+    }
+
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    if (victim_prev == NULL) {
+        queue_head = victim->next;
+    } else {
+        victim_prev->next = victim->next;
+    }
+    if (queue_tail == victim) {
+        queue_tail = victim_prev;
+    }
+    victim->next = NULL;
+    queue_count--;
+    return victim;
+}
+
+/**
+ * @brief Kiểm tra độ sâu so với watermark (lock đã được giữ)
+ *
+ * Có hysteresis: sau khi báo HIGH, chỉ báo LOW khi độ sâu về <= low_watermark.
+ */
+static WatermarkEvent_t check_watermarks(void)
+{
+    if (queue_config.high_watermark == 0) {
+        return WATERMARK_NONE;
+    }
+    if (!above_high_watermark && queue_count >= queue_config.high_watermark) {
+        above_high_watermark = 1;
+        return WATERMARK_HIGH;
+    }
+    if (above_high_watermark && queue_count <= queue_config.low_watermark) {
+        above_high_watermark = 0;
+        return WATERMARK_LOW;
+    }
+    return WATERMARK_NONE;
+}
+
+/**
+ * @brief Gọi callback watermark (lock KHÔNG được giữ)
+ */
+static void fire_watermark(WatermarkEvent_t event, QueueWatermarkFn on_high,
+                           QueueWatermarkFn on_low, void* ctx, size_t depth)
+{
+    if (event == WATERMARK_HIGH && on_high != NULL) {
+        on_high(depth, ctx);
+    } else if (event == WATERMARK_LOW && on_low != NULL) {
+        on_low(depth, ctx);
+    }
+}
+
+/**
+ * @brief Hủy một tác vụ đã tách khỏi hàng đợi (tính là dropped)
+ */
+static void discard_task(TaskNode_t* node, const char* reason)
+{
+    if (queue_config.verbose) {
+        printf("[Queue] Dropped task: \"%s\" (%s)\n", node->task_description, reason);
+    }
+    metrics_on_discard(1);
+    free(node);
+}
+
+/**
+ * @brief Căn bậc hai nguyên (làm tròn xuống), không cần libm
+ */
+static uint32_t isqrt_u32(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Control law của CoDel: lần loại kế tiếp sau interval / sqrt(count)
+ */
+static uint64_t codel_control_law(uint64_t t, uint32_t count)
+{
+    return t + queue_config.codel_interval_ns / isqrt_u32(count);
+}
+
+/**
+ * @brief Sojourn tối đa đang áp dụng (lock đã được giữ)
+ */
+static uint64_t codel_max_sojourn(void)
+{
+    if (queue_config.codel_max_sojourn_ns != 0) {
+        return queue_config.codel_max_sojourn_ns;
+    }
+    return CODEL_MAX_SOJOURN_FACTOR * queue_config.codel_target_ns;
+}
+
+/**
+ * @brief Tách tác vụ đầu và cho biết đã được phép loại chưa (dodequeue của RFC 8289)
+ *
+ * Được phép loại khi sojourn của tác vụ đầu đã vượt target liên tục ít
+ * nhất một interval và vẫn còn tác vụ khác chờ phía sau.
+ *
+ * Ngoài RFC: tác vụ đã chờ quá sojourn tối đa bị loại luôn, trong hay
+ * ngoài trạng thái dropping, nên không tác vụ nào được trả về sau khi
+ * chờ lâu hơn giới hạn đó.
+ *
+ * @param ok_to_drop Nhận 1 nếu được phép loại node trả về
+ * @return Node đầu, hoặc NULL nếu rỗng
+ */
+static TaskNode_t* codel_dodequeue(uint64_t now, int* ok_to_drop)
+{
+    uint64_t max_sojourn = codel_max_sojourn();
+    TaskNode_t* node;
+    uint64_t sojourn;
+
+    while ((node = unlink_head()) != NULL && now - node->enqueue_ns > max_sojourn) {
+        discard_task(node, "CoDel max sojourn");
+    }
+
+    *ok_to_drop = 0;
+    if (node == NULL) {
+        codel.first_above_time_ns = 0;
+        return NULL;
+    }
+
+    sojourn = now - node->enqueue_ns;
+    if (sojourn < queue_config.codel_target_ns || queue_count == 0) {
+        /* Dưới target, hoặc hàng đợi đã cạn: không còn hàng chờ đứng */
+        codel.first_above_time_ns = 0;
+    } else if (codel.first_above_time_ns == 0) {
+        codel.first_above_time_ns = now + queue_config.codel_interval_ns;
+    } else if (now >= codel.first_above_time_ns) {
+        *ok_to_drop = 1;
+    }
+    return node;
+}
+
+/**
+ * @brief Dequeue có áp dụng CoDel theo RFC 8289 (lock đã được giữ)
+ *
+ * 1. Sojourn của tác vụ đầu vượt target liên tục một interval => vào
+ *    trạng thái dropping, loại một tác vụ
+ * 2. Trong trạng thái dropping, mỗi lần tới drop_next loại thêm một tác
+ *    vụ; khoảng cách giữa hai lần loại giảm dần theo interval / sqrt(count)
+ * 3. Thoát trạng thái dropping ngay khi sojourn về dưới target
+ * 4. Vào lại ngay sau một lần thoát: count tiếp tục từ giá trị cũ
+ *
+ * Control law chỉ chặn được độ trễ khi producer phản ứng với việc bị
+ * loại (giảm tốc, như TCP); với tải mở quá tải nặng, tốc độ loại tăng
+ * chậm hơn tốc độ hàng đợi dài ra. Khi đó sojourn tối đa trong
+ * codel_dodequeue() là thứ chặn độ trễ.
+ */
+static TaskNode_t* codel_dequeue(uint64_t now)
+{
+    TaskNode_t* node;
+    uint32_t delta;
+    int ok_to_drop;
+
+    node = codel_dodequeue(now, &ok_to_drop);
+
+    if (codel.dropping) {
+        if (!ok_to_drop) {
+            codel.dropping = 0;
+        }
+        while (codel.dropping && now >= codel.drop_next_ns) {
+            discard_task(node, "CoDel");
+            codel.count++;
+            node = codel_dodequeue(now, &ok_to_drop);
+            if (!ok_to_drop) {
+                codel.dropping = 0;
+            } else {
+                codel.drop_next_ns = codel_control_law(codel.drop_next_ns, codel.count);
+            }
+        }
+    } else if (ok_to_drop) {
+        discard_task(node, "CoDel");
+        node = codel_dodequeue(now, &ok_to_drop);
+        codel.dropping = 1;
+
+        /* Vừa thoát dropping không lâu: tiếp tục với tốc độ loại gần đây */
+        delta = codel.count - codel.last_count;
+        codel.count = 1;
+        if (delta > 1 && now - codel.drop_next_ns < 16 * queue_config.codel_interval_ns) {
+            codel.count = delta;
+        }
+        codel.drop_next_ns = codel_control_law(now, codel.count);
+        codel.last_count = codel.count;
+    }
+    return node;
+}
+
+/**
+ * @brief Lấy tác vụ tiếp theo (lock đã được giữ), ghi nhận thời gian chờ
+ */
+static TaskNode_t* dequeue_locked(void)
+{
+    uint64_t now = metrics_now_ns();
+    TaskNode_t* node;
+
+    node = queue_config.codel_enabled ? codel_dequeue(now) : unlink_head();
+    if (node != NULL) {
+        node->dequeue_ns = now;
+        metrics_on_dequeue(now - node->enqueue_ns);
+    }
+
+    /* CoDel có thể giải phóng nhiều chỗ cùng lúc */
+    pthread_cond_broadcast(&not_full);
+    return node;
+}
+
 /* ======================== FUNCTION IMPLEMENTATIONS ======================== */
 
+void queue_config_default(QueueConfig_t* config)
+{
+    memset(config, 0, sizeof(*config));
+    config->policy = QUEUE_POLICY_BLOCK;
+    config->codel_target_ns = CODEL_DEFAULT_TARGET_NS;
+    config->codel_interval_ns = CODEL_DEFAULT_INTERVAL_NS;
+    config->verbose = 1;
+}
+
+int queue_configure(const QueueConfig_t* config)
+{
+    if (config == NULL ||
+        (config->high_watermark != 0 && config->low_watermark >= config->high_watermark) ||
+        (config->codel_enabled &&
+         (config->codel_target_ns == 0 || config->codel_interval_ns == 0 ||
+          (config->codel_max_sojourn_ns != 0 &&
+           config->codel_max_sojourn_ns < config->codel_target_ns)))) {
+        return QUEUE_ERR_INVALID;
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    queue_config = *config;
+    above_high_watermark = 0;
+    memset(&codel, 0, sizeof(codel));
+    /* Sức chứa có thể vừa tăng - đánh thức producer đang chờ */
+    pthread_cond_broadcast(&not_full);
+    pthread_mutex_unlock(&queue_lock);
+    return QUEUE_OK;
+}
+
+void queue_get_config(QueueConfig_t* config)
+{
+    pthread_mutex_lock(&queue_lock);
+    *config = queue_config;
+    pthread_mutex_unlock(&queue_lock);
+}
+
+int queue_add_task(const char* description)
+{
+    return queue_add_task_priority(description, 0);
+}
+
 /**
  * @brief Thêm một tác vụ mới vào cuối hàng đợi (enqueue)
- * 
+ *
  * Thuật toán:
  * 1. Cấp phát bộ nhớ cho node mới
  * 2. Copy mô tả vào node
- * 3. Nếu hàng đợi rỗng: head = tail = node mới
- * 4. Nếu không: thêm vào sau tail, cập nhật tail
- * 
- * Độ phức tạp: O(1)
- * 
+ * 3. Nếu hàng đợi đầy: áp dụng chính sách (BLOCK / REJECT / SHED_LOWEST)
+ * 4. Nếu hàng đợi rỗng: head = tail = node mới
+ * 5. Nếu không: thêm vào sau tail, cập nhật tail
+ *
+ * Độ phức tạp: O(1), riêng SHED_LOWEST khi đầy là O(n)
+ *
  * @param description Mô tả của tác vụ cần thêm
+ * @param priority Độ ưu tiên của tác vụ
+ * @return QUEUE_OK hoặc mã lỗi QUEUE_ERR_*
  */
-void queue_add_task(const char* description)
+int queue_add_task_priority(const char* description, int priority)
 {
     TaskNode_t* new_node;
-    
+    TaskNode_t* evicted = NULL;
+    struct timespec deadline;
+    WatermarkEvent_t event;
+    QueueWatermarkFn on_high;
+    QueueWatermarkFn on_low;
+    void* watermark_ctx;
+    size_t depth;
+    int verbose;
+    int result = QUEUE_OK;
+
     /* Kiểm tra tham số đầu vào */
     if (description == NULL) {
         fprintf(stderr, "Error: Task description cannot be NULL\n");
-        return;
+        return QUEUE_ERR_INVALID;
     }
-    
+
     /* Bước 1: Cấp phát bộ nhớ cho node mới */
     new_node = (TaskNode_t*)malloc(sizeof(TaskNode_t));
     if (new_node == NULL) {
         fprintf(stderr, "Error: Memory allocation failed\n");
-        return;
+        metrics_on_drop();
+        return QUEUE_ERR_NOMEM;
     }
-    
+
     /* Bước 2: Khởi tạo dữ liệu cho node */
     strncpy(new_node->task_description, description, TASK_DESC_SIZE - 1);
     new_node->task_description[TASK_DESC_SIZE - 1] = '\0';  /* Đảm bảo null-terminated */
+    new_node->partition_key[0] = '\0';
+    new_node->priority = priority;
+    new_node->dequeue_ns = 0;
     new_node->next = NULL;
-    
-    /* Bước 3 & 4: Thêm node vào hàng đợi */
+
+    pthread_mutex_lock(&queue_lock);
+
+    /* Bước 3: Admission control khi đã đạt capacity */
+    if (queue_config.capacity != 0 && queue_count >= queue_config.capacity) {
+        switch (queue_config.policy) {
+            case QUEUE_POLICY_REJECT:
+                result = QUEUE_ERR_FULL;
+                break;
+
+            case QUEUE_POLICY_SHED_LOWEST:
+                evicted = unlink_lowest_priority(priority);
+                if (evicted == NULL) {
+                    result = QUEUE_ERR_FULL;
+                }
+                break;
+
+            case QUEUE_POLICY_BLOCK:
+            default:
+                if (queue_config.block_timeout_ms != 0) {
+                    make_deadline(queue_config.block_timeout_ms, &deadline);
+                }
+                while (queue_config.capacity != 0 && queue_count >= queue_config.capacity) {
+                    if (queue_config.block_timeout_ms == 0) {
+                        pthread_cond_wait(&not_full, &queue_lock);
+                    } else if (pthread_cond_timedwait(&not_full, &queue_lock,
+                                                      &deadline) == ETIMEDOUT) {
+                        result = QUEUE_ERR_TIMEOUT;
+                        break;
+                    }
+                }
+                break;
+        }
+    }
+
+    verbose = queue_config.verbose;
+    if (result != QUEUE_OK) {
+        pthread_mutex_unlock(&queue_lock);
+        metrics_on_drop();
+        if (verbose) {
+            printf("[Queue] Rejected task: \"%s\" (%s)\n", new_node->task_description,
+                   result == QUEUE_ERR_TIMEOUT ? "timed out waiting for space" : "queue full");
+        }
+        free(new_node);
+        return result;
+    }
+
+    /* Tác vụ bị loại rời hàng đợi trước để depth không vượt capacity */
+    if (evicted != NULL) {
+        discard_task(evicted, "shed for higher priority");
+    }
+
+    /* Bước 4 & 5: Thêm node vào hàng đợi */
+    new_node->enqueue_ns = metrics_now_ns();
     if (queue_head == NULL) {
         /* Hàng đợi rỗng - node mới là cả head và tail */
         queue_head = new_node;
@@ -66,76 +519,177 @@ void queue_add_task(const char* description)
         queue_tail->next = new_node;
         queue_tail = new_node;
     }
-    
-    printf("[Queue] Added task: \"%s\"\n", new_node->task_description);
+    queue_count++;
+    metrics_on_enqueue();
+
+    event = check_watermarks();
+    depth = queue_count;
+    on_high = queue_config.on_high;
+    on_low = queue_config.on_low;
+    watermark_ctx = queue_config.watermark_ctx;
+    pthread_cond_signal(&not_empty);
+    pthread_mutex_unlock(&queue_lock);
+
+    fire_watermark(event, on_high, on_low, watermark_ctx, depth);
+
+    if (verbose) {
+        printf("[Queue] Added task: \"%s\"\n", description);
+    }
+    return QUEUE_OK;
 }
 
 /**
  * @brief Lấy tác vụ tiếp theo từ đầu hàng đợi (dequeue)
- * 
+ *
  * Thuật toán:
  * 1. Nếu hàng đợi rỗng, trả về NULL
  * 2. Lưu con trỏ tới node đầu
  * 3. Di chuyển head tới node tiếp theo
  * 4. Nếu head == NULL, cập nhật tail = NULL
  * 5. Trả về node đã lấy (caller sẽ free)
- * 
- * Độ phức tạp: O(1)
- * 
+ *
+ * Khi bật CoDel, các tác vụ chờ quá lâu ở đầu hàng đợi có thể bị loại
+ * trước khi trả về tác vụ tiếp theo.
+ *
+ * Độ phức tạp: O(1) (cộng số tác vụ bị CoDel loại)
+ *
  * @return Con trỏ tới node tác vụ, hoặc NULL nếu rỗng
  */
 TaskNode_t* queue_get_next_task(void)
 {
     TaskNode_t* task_node;
-    
+    WatermarkEvent_t event;
+    QueueWatermarkFn on_high;
+    QueueWatermarkFn on_low;
+    void* watermark_ctx;
+    size_t depth;
+    int verbose;
+
+    pthread_mutex_lock(&queue_lock);
+    task_node = dequeue_locked();
+    event = check_watermarks();
+    depth = queue_count;
+    on_high = queue_config.on_high;
+    on_low = queue_config.on_low;
+    watermark_ctx = queue_config.watermark_ctx;
+    verbose = queue_config.verbose;
+    pthread_mutex_unlock(&queue_lock);
+
+    fire_watermark(event, on_high, on_low, watermark_ctx, depth);
+
     /* Kiểm tra hàng đợi có rỗng không */
-    if (queue_head == NULL) {
+    if (task_node == NULL && verbose) {
         printf("[Queue] Queue is empty. No task to execute.\n");
-        return NULL;
     }
-    
-    /* Lưu node đầu tiên */
-    task_node = queue_head;
-    
-    /* Di chuyển head tới node tiếp theo */
-    queue_head = queue_head->next;
-    
-    /* Nếu hàng đợi trở nên rỗng, cập nhật tail */
-    if (queue_head == NULL) {
-        queue_tail = NULL;
+
+    return task_node;
+}
+
+/**
+ * @brief Lấy tác vụ tiếp theo, chờ trên not_empty nếu hàng đợi rỗng
+ */
+TaskNode_t* queue_wait_next_task(unsigned int timeout_ms)
+{
+    TaskNode_t* task_node = NULL;
+    struct timespec deadline;
+    WatermarkEvent_t event;
+    QueueWatermarkFn on_high;
+    QueueWatermarkFn on_low;
+    void* watermark_ctx;
+    size_t depth;
+
+    if (timeout_ms != 0) {
+        make_deadline(timeout_ms, &deadline);
+    }
+
+    pthread_mutex_lock(&queue_lock);
+    while (task_node == NULL) {
+        while (queue_count == 0) {
+            if (timeout_ms == 0) {
+                pthread_cond_wait(&not_empty, &queue_lock);
+            } else if (pthread_cond_timedwait(&not_empty, &queue_lock,
+                                              &deadline) == ETIMEDOUT) {
+                break;
+            }
+        }
+        if (queue_count == 0) {
+            break;
+        }
+        /* CoDel có thể loại hết tác vụ còn lại - khi đó chờ tiếp */
+        task_node = dequeue_locked();
     }
-    
-    /* Ngắt kết nối node khỏi hàng đợi */
-    task_node->next = NULL;
-    
+    event = check_watermarks();
+    depth = queue_count;
+    on_high = queue_config.on_high;
+    on_low = queue_config.on_low;
+    watermark_ctx = queue_config.watermark_ctx;
+    pthread_mutex_unlock(&queue_lock);
+
+    fire_watermark(event, on_high, on_low, watermark_ctx, depth);
     return task_node;
 }
 
+/**
+ * @brief Ghi nhận thời gian thực thi (dequeue -> hoàn thành) của tác vụ
+ *
+ * Độ phức tạp: O(1)
+ */
+void queue_task_completed(const TaskNode_t* task)
+{
+    if (task == NULL || task->dequeue_ns == 0) {
+        return;
+    }
+    metrics_on_complete(metrics_now_ns() - task->dequeue_ns);
+}
+
+/**
+ * @brief Số tác vụ đang chờ, lấy từ bộ đếm depth
+ *
+ * Độ phức tạp: O(1)
+ */
+size_t queue_size(void)
+{
+    return (size_t)metrics_depth();
+}
+
 /**
  * @brief In tất cả các tác vụ đang chờ trong hàng đợi
- * 
+ *
  * Duyệt từ head đến tail và in ra từng tác vụ
- * 
+ *
  * Độ phức tạp: O(n)
  */
 void print_task_queue(void)
 {
     TaskNode_t* current;
     int index = 1;
-    
-    printf("\n========== TASK QUEUE ==========\n");
-    
+
+    pthread_mutex_lock(&queue_lock);
+
+    printf("\n========== TASK QUEUE (%zu", queue_count);
+    if (queue_config.capacity != 0) {
+        printf("/%zu", queue_config.capacity);
+    }
+    printf(") ==========\n");
+
     if (queue_head == NULL) {
         printf("(Queue is empty)\n");
     } else {
         current = queue_head;
         while (current != NULL) {
-            printf("  %d. %s\n", index++, current->task_description);
+            if (current->priority != 0) {
+                printf("  %d. [p%d] %s\n", index++, current->priority,
+                       current->task_description);
+            } else {
+                printf("  %d. %s\n", index++, current->task_description);
+            }
             current = current->next;
         }
     }
-    
+
     printf("=================================\n\n");
+
+    pthread_mutex_unlock(&queue_lock);
 }
 
 /**
@@ -144,28 +698,50 @@ void print_task_queue(void)
  */
 int queue_is_empty(void)
 {
-    return (queue_head == NULL);
+    int empty;
+
+    pthread_mutex_lock(&queue_lock);
+    empty = (queue_head == NULL);
+    pthread_mutex_unlock(&queue_lock);
+    return empty;
 }
 
 /**
  * @brief Giải phóng toàn bộ bộ nhớ của hàng đợi
- * 
+ *
  * Duyệt qua từng node và free bộ nhớ
  */
 void queue_destroy(void)
 {
     TaskNode_t* current;
     TaskNode_t* next_node;
-    
+    uint64_t discarded = 0;
+    int verbose;
+
+    pthread_mutex_lock(&queue_lock);
+
     current = queue_head;
     while (current != NULL) {
         next_node = current->next;
         free(current);
         current = next_node;
+        discarded++;
     }
-    
+
+    /* Tác vụ chưa chạy bị hủy được tính là dropped */
+    metrics_on_discard(discarded);
+
     queue_head = NULL;
     queue_tail = NULL;
-    
-    printf("[Queue] All tasks cleared.\n");
+    queue_count = 0;
+    above_high_watermark = 0;
+    memset(&codel, 0, sizeof(codel));
+    verbose = queue_config.verbose;
+    pthread_cond_broadcast(&not_full);
+
+    pthread_mutex_unlock(&queue_lock);
+
+    if (verbose) {
+        printf("[Queue] All tasks cleared.\n");
+    }
 }
@@ -1,11 +1,20 @@
 /**
  * @file task_queue.h
  * @brief Header file cho Task Queue - Hàng đợi FIFO sử dụng Singly Linked List
- * 
+ *
  * Danh sách liên kết đơn là lựa chọn hoàn hảo cho hàng đợi FIFO vì:
  * - Chỉ cần duyệt theo một chiều (head -> tail)
  * - Thêm vào cuối (enqueue) và lấy từ đầu (dequeue) đều O(1)
  * - Tiết kiệm bộ nhớ hơn danh sách liên kết đôi
+ *
+ * Admission control (backpressure) giới hạn độ sâu hàng đợi khi quá tải:
+ * - Giới hạn sức chứa với chính sách BLOCK, REJECT hoặc SHED_LOWEST
+ * - Callback high/low watermark để producer tự giảm tốc
+ * - Chế độ CoDel (RFC 8289): loại tác vụ khi sojourn time vượt target kéo dài,
+ *   cộng một giới hạn cứng cho sojourn để độ trễ bị chặn cả khi producer
+ *   không giảm tốc
+ *
+ * Mọi hàm đều thread-safe (một mutex bảo vệ toàn bộ hàng đợi).
  */
 
 #ifndef TASK_QUEUE_H
@@ -14,29 +23,114 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
 /* Kích thước tối đa cho mô tả tác vụ */
 #define TASK_DESC_SIZE 50
 
+/* Kích thước tối đa cho partition key (dùng bởi task_shard.c) */
+#define TASK_KEY_SIZE 24
+
+/* Mã trả về của queue_add_task() */
+#define QUEUE_OK            0
+#define QUEUE_ERR_INVALID  -1   /* Tham số không hợp lệ */
+#define QUEUE_ERR_NOMEM    -2   /* Cấp phát bộ nhớ thất bại */
+#define QUEUE_ERR_FULL     -3   /* Hàng đợi đầy (REJECT, hoặc SHED khi tác vụ mới có ưu tiên thấp nhất) */
+#define QUEUE_ERR_TIMEOUT  -4   /* Hàng đợi vẫn đầy sau block_timeout_ms (BLOCK) */
+
 /**
  * @brief Cấu trúc Node cho Task Queue (Singly Linked List)
- * 
+ *
  * Mỗi node chứa:
  * - task_description: Mô tả công việc cần thực hiện
+ * - partition_key: Key phân vùng (vd. ID thiết bị), "" nếu không có
+ * - priority: Độ ưu tiên, dùng cho chính sách SHED_LOWEST (lớn hơn = quan trọng hơn)
+ * - enqueue_ns/dequeue_ns: Timestamp để đo thời gian chờ và thời gian thực thi
  * - next: Con trỏ tới node tiếp theo trong hàng đợi
  */
 typedef struct TaskNode {
     char task_description[TASK_DESC_SIZE];  /* Mô tả tác vụ */
+    char partition_key[TASK_KEY_SIZE];       /* Key phân vùng, "" = không có */
+    int priority;                            /* Độ ưu tiên (mặc định 0) */
+    uint64_t enqueue_ns;                     /* Thời điểm vào hàng đợi */
+    uint64_t dequeue_ns;                     /* Thời điểm được lấy ra */
     struct TaskNode* next;                   /* Con trỏ tới node kế tiếp */
 } TaskNode_t;
 
+/**
+ * @brief Chính sách khi hàng đợi đã đầy
+ */
+typedef enum {
+    QUEUE_POLICY_BLOCK = 0,     /* Producer chờ tới khi có chỗ (tối đa block_timeout_ms) */
+    QUEUE_POLICY_REJECT,        /* Từ chối tác vụ mới ngay lập tức */
+    QUEUE_POLICY_SHED_LOWEST    /* Loại tác vụ có ưu tiên thấp nhất để nhường chỗ */
+} QueuePolicy_t;
+
+/**
+ * @brief Callback khi độ sâu vượt high watermark hoặc về dưới low watermark
+ * @param depth Độ sâu hàng đợi tại thời điểm xảy ra sự kiện
+ * @param user_ctx Con trỏ ngữ cảnh trong QueueConfig_t
+ * @note Được gọi ngoài lock nên có thể gọi lại các hàm của hàng đợi
+ */
+typedef void (*QueueWatermarkFn)(size_t depth, void* user_ctx);
+
+/**
+ * @brief Cấu hình admission control
+ */
+typedef struct {
+    size_t capacity;                 /* Số tác vụ tối đa, 0 = không giới hạn */
+    QueuePolicy_t policy;            /* Chính sách khi đầy */
+    unsigned int block_timeout_ms;   /* Thời gian chờ tối đa của BLOCK, 0 = chờ mãi */
+
+    size_t high_watermark;           /* 0 = tắt callback watermark */
+    size_t low_watermark;            /* Phải nhỏ hơn high_watermark */
+    QueueWatermarkFn on_high;
+    QueueWatermarkFn on_low;
+    void* watermark_ctx;
+
+    int codel_enabled;               /* 1 = bật CoDel khi dequeue */
+    uint64_t codel_target_ns;        /* Sojourn time chấp nhận được */
+    uint64_t codel_interval_ns;      /* Sojourn vượt target lâu chừng này thì bắt đầu loại */
+    uint64_t codel_max_sojourn_ns;   /* Chờ lâu hơn thì bị loại ngay, 0 = 10 x target */
+
+    int verbose;                     /* 1 = in thông báo cho từng thao tác */
+} QueueConfig_t;
+
 /* ======================== FUNCTION PROTOTYPES ======================== */
 
 /**
- * @brief Thêm một tác vụ mới vào cuối hàng đợi (enqueue)
+ * @brief Lấy cấu hình mặc định: không giới hạn, không watermark, không CoDel,
+ *        CoDel target 5 ms / interval 100 ms / sojourn tối đa 10 x target khi
+ *        được bật, verbose
+ */
+void queue_config_default(QueueConfig_t* config);
+
+/**
+ * @brief Áp dụng cấu hình admission control cho hàng đợi
+ * @return QUEUE_OK hoặc QUEUE_ERR_INVALID nếu cấu hình không hợp lệ
+ * @note Tác vụ đang có trong hàng đợi được giữ nguyên kể cả khi vượt capacity mới
+ */
+int queue_configure(const QueueConfig_t* config);
+
+/**
+ * @brief Lấy cấu hình hiện tại
+ */
+void queue_get_config(QueueConfig_t* config);
+
+/**
+ * @brief Thêm một tác vụ mới vào cuối hàng đợi (enqueue) với độ ưu tiên 0
+ * @param description Mô tả của tác vụ cần thêm
+ * @return QUEUE_OK hoặc mã lỗi QUEUE_ERR_* (tác vụ bị từ chối được tính là dropped)
+ */
+int queue_add_task(const char* description);
+
+/**
+ * @brief Thêm một tác vụ mới với độ ưu tiên cho trước
  * @param description Mô tả của tác vụ cần thêm
+ * @param priority Độ ưu tiên (lớn hơn = quan trọng hơn)
+ * @return QUEUE_OK hoặc mã lỗi QUEUE_ERR_*
  */
-void queue_add_task(const char* description);
+int queue_add_task_priority(const char* description, int priority);
 
 /**
  * @brief Lấy tác vụ tiếp theo từ đầu hàng đợi (dequeue)
@@ -45,6 +139,25 @@ void queue_add_task(const char* description);
  */
 TaskNode_t* queue_get_next_task(void);
 
+/**
+ * @brief Lấy tác vụ tiếp theo, chờ tối đa timeout_ms nếu hàng đợi rỗng
+ * @param timeout_ms Thời gian chờ tối đa, 0 = chờ mãi
+ * @return Con trỏ tới node tác vụ, hoặc NULL nếu hết thời gian chờ
+ * @note Dành cho worker thread; caller có trách nhiệm free() node
+ */
+TaskNode_t* queue_wait_next_task(unsigned int timeout_ms);
+
+/**
+ * @brief Báo tác vụ đã thực thi xong để ghi nhận thời gian thực thi
+ * @param task Node đã lấy từ queue_get_next_task() (gọi trước khi free)
+ */
+void queue_task_completed(const TaskNode_t* task);
+
+/**
+ * @brief Số tác vụ đang chờ trong hàng đợi - O(1), không duyệt danh sách
+ */
+size_t queue_size(void);
+
 /**
  * @brief In tất cả các tác vụ đang chờ trong hàng đợi
  */
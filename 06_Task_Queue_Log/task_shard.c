@@ -0,0 +1,419 @@
+/**
+ * @file task_shard.c
+ * @brief Triển khai Sharded Task Queue
+ *
+ * Mỗi shard là một Singly Linked List (head/tail như task_queue.c) kèm
+ * mutex + condition variable riêng, nên các shard không tranh chấp lock
+ * với nhau. resize_lock (read-write lock) cho phép nhiều producer submit
+ * song song, nhưng chặn submit trong lúc rebalance.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "task_shard.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* ======================== INTERNAL STRUCTURES ======================== */
+
+typedef struct Shard {
+    TaskNode_t* head;
+    TaskNode_t* tail;
+    size_t depth;                  /* Số tác vụ đang chờ trong shard */
+    uint64_t processed;            /* Số tác vụ shard đã xử lý */
+    int stop;                      /* 1 = worker thoát, để lại tác vụ đang chờ */
+    int index;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_t worker;
+    struct ShardedQueue* owner;
+} Shard_t;
+
+struct ShardedQueue {
+    Shard_t* shards;
+    int num_shards;
+    pthread_rwlock_t resize_lock;
+    ShardTaskFn fn;
+    void* user_ctx;
+    atomic_uint round_robin;       /* Bộ đếm cho tác vụ không có key */
+
+    /* Số tác vụ đã submit nhưng chưa xử lý xong - dùng cho shard_drain() */
+    pthread_mutex_t pending_lock;
+    pthread_cond_t pending_done;
+    uint64_t pending;
+};
+
+/* ======================== HELPER FUNCTIONS ======================== */
+
+/**
+ * @brief Hash FNV-1a 32-bit của partition key
+ */
+static uint32_t hash_key(const char* key)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Chọn shard cho tác vụ: theo hash nếu có key, round-robin nếu không
+ */
+static int pick_shard(ShardedQueue_t* sq, const char* key, int num_shards)
+{
+    if (key[0] == '\0') {
+        return (int)(atomic_fetch_add(&sq->round_robin, 1) % (unsigned int)num_shards);
+    }
+    return (int)(hash_key(key) % (uint32_t)num_shards);
+}
+
+/**
+ * @brief Thêm node vào cuối shard và đánh thức worker - O(1)
+ */
+static void shard_push(Shard_t* shard, TaskNode_t* node)
+{
+    node->next = NULL;
+
+    pthread_mutex_lock(&shard->lock);
+    if (shard->head == NULL) {
+        shard->head = node;
+        shard->tail = node;
+    } else {
+        shard->tail->next = node;
+        shard->tail = node;
+    }
+    shard->depth++;
+    pthread_cond_signal(&shard->not_empty);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief Worker của một shard - xử lý tuần tự các tác vụ theo FIFO
+ */
+static void* shard_worker(void* arg)
+{
+    Shard_t* shard = (Shard_t*)arg;
+    ShardedQueue_t* sq = shard->owner;
+    TaskNode_t* task;
+
+    while (1) {
+        pthread_mutex_lock(&shard->lock);
+        while (shard->head == NULL && !shard->stop) {
+            pthread_cond_wait(&shard->not_empty, &shard->lock);
+        }
+        if (shard->stop) {
+            /* Tác vụ còn lại được giữ nguyên để rebalance */
+            pthread_mutex_unlock(&shard->lock);
+            break;
+        }
+        task = shard->head;
+        shard->head = task->next;
+        if (shard->head == NULL) {
+            shard->tail = NULL;
+        }
+        shard->depth--;
+        pthread_mutex_unlock(&shard->lock);
+
+        task->next = NULL;
+        sq->fn(shard->index, task->partition_key, task->task_description, sq->user_ctx);
+        free(task);
+
+        pthread_mutex_lock(&shard->lock);
+        shard->processed++;
+        pthread_mutex_unlock(&shard->lock);
+
+        pthread_mutex_lock(&sq->pending_lock);
+        if (--sq->pending == 0) {
+            pthread_cond_broadcast(&sq->pending_done);
+        }
+        pthread_mutex_unlock(&sq->pending_lock);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Dừng và join worker của count shard đầu tiên
+ */
+static void stop_workers(Shard_t* shards, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        pthread_mutex_lock(&shards[i].lock);
+        shards[i].stop = 1;
+        pthread_cond_signal(&shards[i].not_empty);
+        pthread_mutex_unlock(&shards[i].lock);
+    }
+    for (i = 0; i < count; i++) {
+        pthread_join(shards[i].worker, NULL);
+    }
+}
+
+/**
+ * @brief Khởi động worker cho mọi shard
+ * @return SHARD_OK, hoặc SHARD_ERR_THREAD (các worker đã tạo được dừng lại)
+ */
+static int start_workers(Shard_t* shards, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        shards[i].stop = 0;
+        if (pthread_create(&shards[i].worker, NULL, shard_worker, &shards[i]) != 0) {
+            stop_workers(shards, i);
+            return SHARD_ERR_THREAD;
+        }
+    }
+    return SHARD_OK;
+}
+
+/**
+ * @brief Cấp phát và khởi tạo mảng shard rỗng (chưa có worker)
+ */
+static Shard_t* alloc_shards(ShardedQueue_t* sq, int count)
+{
+    Shard_t* shards;
+    int i;
+
+    shards = (Shard_t*)calloc((size_t)count, sizeof(Shard_t));
+    if (shards == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < count; i++) {
+        shards[i].index = i;
+        shards[i].owner = sq;
+        pthread_mutex_init(&shards[i].lock, NULL);
+        pthread_cond_init(&shards[i].not_empty, NULL);
+    }
+    return shards;
+}
+
+/**
+ * @brief Giải phóng mảng shard (worker đã dừng, danh sách đã rỗng)
+ */
+static void free_shards(Shard_t* shards, int count)
+{
+    TaskNode_t* current;
+    TaskNode_t* next_node;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        current = shards[i].head;
+        while (current != NULL) {
+            next_node = current->next;
+            free(current);
+            current = next_node;
+        }
+        pthread_mutex_destroy(&shards[i].lock);
+        pthread_cond_destroy(&shards[i].not_empty);
+    }
+    free(shards);
+}
+
+/* ======================== FUNCTION IMPLEMENTATIONS ======================== */
+
+ShardedQueue_t* shard_create(int num_shards, ShardTaskFn fn, void* user_ctx)
+{
+    ShardedQueue_t* sq;
+
+    if (num_shards < 1 || num_shards > SHARD_MAX_COUNT || fn == NULL) {
+        return NULL;
+    }
+
+    sq = (ShardedQueue_t*)calloc(1, sizeof(ShardedQueue_t));
+    if (sq == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return NULL;
+    }
+
+    sq->fn = fn;
+    sq->user_ctx = user_ctx;
+    atomic_init(&sq->round_robin, 0);
+    pthread_rwlock_init(&sq->resize_lock, NULL);
+    pthread_mutex_init(&sq->pending_lock, NULL);
+    pthread_cond_init(&sq->pending_done, NULL);
+
+    sq->shards = alloc_shards(sq, num_shards);
+    if (sq->shards == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        shard_destroy(sq);
+        return NULL;
+    }
+    if (start_workers(sq->shards, num_shards) != SHARD_OK) {
+        fprintf(stderr, "Error: Failed to start shard worker threads\n");
+        free_shards(sq->shards, num_shards);
+        sq->shards = NULL;
+        shard_destroy(sq);
+        return NULL;
+    }
+    sq->num_shards = num_shards;
+    return sq;
+}
+
+void shard_destroy(ShardedQueue_t* sq)
+{
+    if (sq == NULL) {
+        return;
+    }
+
+    if (sq->shards != NULL) {
+        shard_drain(sq);
+        stop_workers(sq->shards, sq->num_shards);
+        free_shards(sq->shards, sq->num_shards);
+    }
+
+    pthread_rwlock_destroy(&sq->resize_lock);
+    pthread_mutex_destroy(&sq->pending_lock);
+    pthread_cond_destroy(&sq->pending_done);
+    free(sq);
+}
+
+int shard_submit(ShardedQueue_t* sq, const char* partition_key, const char* description)
+{
+    TaskNode_t* node;
+    int index;
+
+    if (sq == NULL || description == NULL) {
+        return SHARD_ERR_INVALID;
+    }
+    if (partition_key == NULL) {
+        partition_key = "";
+    }
+
+    node = (TaskNode_t*)malloc(sizeof(TaskNode_t));
+    if (node == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return SHARD_ERR_NOMEM;
+    }
+    memset(node, 0, sizeof(*node));
+    strncpy(node->task_description, description, TASK_DESC_SIZE - 1);
+    strncpy(node->partition_key, partition_key, TASK_KEY_SIZE - 1);
+
+    /* Tăng pending trước khi worker có thể thấy tác vụ */
+    pthread_mutex_lock(&sq->pending_lock);
+    sq->pending++;
+    pthread_mutex_unlock(&sq->pending_lock);
+
+    pthread_rwlock_rdlock(&sq->resize_lock);
+    index = pick_shard(sq, node->partition_key, sq->num_shards);
+    shard_push(&sq->shards[index], node);
+    pthread_rwlock_unlock(&sq->resize_lock);
+
+    return index;
+}
+
+int shard_resize(ShardedQueue_t* sq, int num_shards)
+{
+    Shard_t* old_shards;
+    Shard_t* new_shards;
+    TaskNode_t* node;
+    TaskNode_t* next_node;
+    int old_count;
+    int i;
+
+    if (sq == NULL || num_shards < 1 || num_shards > SHARD_MAX_COUNT) {
+        return SHARD_ERR_INVALID;
+    }
+
+    pthread_rwlock_wrlock(&sq->resize_lock);
+
+    if (num_shards == sq->num_shards) {
+        pthread_rwlock_unlock(&sq->resize_lock);
+        return SHARD_OK;
+    }
+
+    old_shards = sq->shards;
+    old_count = sq->num_shards;
+
+    /*
+     * Bước 1: Chuẩn bị shard mới và khởi động worker của chúng trước khi
+     * dừng worker cũ: nếu lỗi, worker cũ vẫn chạy nên không cần khởi động
+     * lại (việc khởi động lại cũng có thể lỗi và bỏ tác vụ không ai chạy).
+     * Worker mới chỉ chờ trên shard rỗng cho tới bước 3.
+     */
+    new_shards = alloc_shards(sq, num_shards);
+    if (new_shards == NULL || start_workers(new_shards, num_shards) != SHARD_OK) {
+        if (new_shards != NULL) {
+            free_shards(new_shards, num_shards);
+        }
+        pthread_rwlock_unlock(&sq->resize_lock);
+        fprintf(stderr, "Error: Failed to resize shards\n");
+        return (new_shards == NULL) ? SHARD_ERR_NOMEM : SHARD_ERR_THREAD;
+    }
+
+    /* Bước 2: Dừng worker cũ - tác vụ đang chạy hoàn tất trước khi join */
+    stop_workers(old_shards, old_count);
+
+    /* Bước 3: Chuyển tác vụ đang chờ theo đúng thứ tự của từng shard cũ */
+    for (i = 0; i < old_count; i++) {
+        node = old_shards[i].head;
+        while (node != NULL) {
+            next_node = node->next;
+            shard_push(&new_shards[pick_shard(sq, node->partition_key, num_shards)], node);
+            node = next_node;
+        }
+        old_shards[i].head = NULL;
+        old_shards[i].tail = NULL;
+    }
+
+    sq->shards = new_shards;
+    sq->num_shards = num_shards;
+    pthread_rwlock_unlock(&sq->resize_lock);
+
+    free_shards(old_shards, old_count);
+    return SHARD_OK;
+}
+
+void shard_drain(ShardedQueue_t* sq)
+{
+    if (sq == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&sq->pending_lock);
+    while (sq->pending > 0) {
+        pthread_cond_wait(&sq->pending_done, &sq->pending_lock);
+    }
+    pthread_mutex_unlock(&sq->pending_lock);
+}
+
+int shard_count(const ShardedQueue_t* sq)
+{
+    return (sq == NULL) ? 0 : sq->num_shards;
+}
+
+int shard_for_key(const ShardedQueue_t* sq, const char* partition_key)
+{
+    if (sq == NULL || partition_key == NULL || partition_key[0] == '\0') {
+        return -1;
+    }
+    return (int)(hash_key(partition_key) % (uint32_t)sq->num_shards);
+}
+
+void shard_print(ShardedQueue_t* sq)
+{
+    int i;
+
+    printf("\n========== SHARDS ==========\n");
+
+    if (sq == NULL) {
+        printf("(Sharded queue not started)\n");
+    } else {
+        pthread_rwlock_rdlock(&sq->resize_lock);
+        for (i = 0; i < sq->num_shards; i++) {
+            pthread_mutex_lock(&sq->shards[i].lock);
+            printf("  Shard %2d: %zu waiting, %llu processed\n", i,
+                   sq->shards[i].depth,
+                   (unsigned long long)sq->shards[i].processed);
+            pthread_mutex_unlock(&sq->shards[i].lock);
+        }
+        pthread_rwlock_unlock(&sq->resize_lock);
+    }
+
+    printf("============================\n\n");
+}
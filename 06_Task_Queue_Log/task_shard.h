@@ -0,0 +1,105 @@
+/**
+ * @file task_shard.h
+ * @brief Header file cho Sharded Task Queue - Nhiều hàng đợi FIFO phân theo key
+ *
+ * Hàng đợi toàn cục bắt mọi tác vụ đi qua một luồng tuần tự, trong khi
+ * thứ tự chỉ cần đảm bảo giữa các tác vụ cùng thiết bị/cùng plant ID:
+ * - Mỗi tác vụ mang một partition key (tùy chọn)
+ * - Key được hash vào một trong N shard, mỗi shard là một hàng đợi FIFO
+ *   (Singly Linked List) do đúng một worker thread xử lý
+ * - Tác vụ cùng key luôn vào cùng shard => giữ thứ tự theo key,
+ *   các key khác nhau chạy song song N luồng (giống partition của Kafka)
+ * - Tác vụ không có key được phân round-robin (không đảm bảo thứ tự)
+ *
+ * Khi đổi số worker, các tác vụ đang chờ được phân lại theo hash mới
+ * mà vẫn giữ thứ tự của từng key.
+ */
+
+#ifndef TASK_SHARD_H
+#define TASK_SHARD_H
+
+#include "task_queue.h"
+
+/* Số shard tối đa */
+#define SHARD_MAX_COUNT 64
+
+/* Mã lỗi trả về từ các hàm shard */
+#define SHARD_OK           0
+#define SHARD_ERR_INVALID -1
+#define SHARD_ERR_NOMEM   -2
+#define SHARD_ERR_THREAD  -3
+
+/**
+ * @brief Hàm thực thi một tác vụ trên worker của shard
+ * @param shard Chỉ số shard đang xử lý
+ * @param partition_key Key của tác vụ ("" nếu không có)
+ * @param description Mô tả tác vụ
+ * @param user_ctx Con trỏ ngữ cảnh truyền vào shard_create()
+ *
+ * @note Các tác vụ cùng key không bao giờ chạy đồng thời
+ */
+typedef void (*ShardTaskFn)(int shard, const char* partition_key,
+                            const char* description, void* user_ctx);
+
+/* Kiểu opaque - cấu trúc bên trong nằm trong task_shard.c */
+typedef struct ShardedQueue ShardedQueue_t;
+
+/* ======================== FUNCTION PROTOTYPES ======================== */
+
+/**
+ * @brief Tạo sharded queue với num_shards worker thread
+ * @return Con trỏ tới sharded queue, hoặc NULL nếu lỗi
+ */
+ShardedQueue_t* shard_create(int num_shards, ShardTaskFn fn, void* user_ctx);
+
+/**
+ * @brief Chờ mọi tác vụ xong, dừng các worker và giải phóng bộ nhớ
+ */
+void shard_destroy(ShardedQueue_t* sq);
+
+/**
+ * @brief Thêm tác vụ vào shard tương ứng với key
+ * @param partition_key Key phân vùng, NULL hoặc "" = không có key (round-robin)
+ * @param description Mô tả tác vụ
+ * @return Chỉ số shard nhận tác vụ (>= 0) hoặc mã lỗi SHARD_ERR_*
+ *
+ * Độ phức tạp: O(1)
+ */
+int shard_submit(ShardedQueue_t* sq, const char* partition_key, const char* description);
+
+/**
+ * @brief Đổi số worker và phân lại các tác vụ đang chờ (rebalance)
+ *
+ * 1. Chặn submit mới, tạo các shard mới và khởi động worker của chúng
+ * 2. Dừng worker cũ sau khi tác vụ đang chạy xong
+ * 3. Lấy tác vụ đang chờ từ từng shard cũ theo đúng thứ tự và hash lại
+ *    vào các shard mới
+ *
+ * Mỗi key chỉ nằm trong một shard cũ nên thứ tự theo key được giữ nguyên.
+ *
+ * @return SHARD_OK hoặc mã lỗi SHARD_ERR_* (khi lỗi, các shard cũ và worker
+ *         của chúng được giữ nguyên)
+ */
+int shard_resize(ShardedQueue_t* sq, int num_shards);
+
+/**
+ * @brief Chờ tới khi mọi tác vụ đã submit đều được xử lý
+ */
+void shard_drain(ShardedQueue_t* sq);
+
+/**
+ * @brief Số shard (worker) hiện tại
+ */
+int shard_count(const ShardedQueue_t* sq);
+
+/**
+ * @brief Shard sẽ nhận các tác vụ mang key này với số shard hiện tại
+ */
+int shard_for_key(const ShardedQueue_t* sq, const char* partition_key);
+
+/**
+ * @brief In độ sâu và số tác vụ đã xử lý của từng shard
+ */
+void shard_print(ShardedQueue_t* sq);
+
+#endif /* TASK_SHARD_H */
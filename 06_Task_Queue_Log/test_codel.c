@@ -0,0 +1,248 @@
+/**
+ * @file test_codel.c
+ * @brief Kiểm tra CoDel (RFC 8289) của Task Queue với đồng hồ giả lập
+ *
+ * metrics_set_clock() thay CLOCK_MONOTONIC bằng một đồng hồ do test điều
+ * khiển, nên hàng đợi thấy đúng thời điểm của từng sự kiện và kết quả
+ * không phụ thuộc tải của máy. Một vòng lặp sự kiện giả lập một producer
+ * (tác vụ đến đều đặn, có thể có một loạt tác vụ lúc bắt đầu) và một
+ * consumer xử lý mỗi tác vụ trong đúng CODEL_TEST_SERVICE_NS.
+ *
+ * Mỗi kịch bản kiểm tra:
+ * - Không tác vụ nào được trả về sau khi chờ quá sojourn tối đa
+ * - Có / không có tác vụ bị loại, và lần loại đầu tiên không sớm hơn
+ *   một interval (CoDel cho phép một đợt dồn ngắn đi qua)
+ * - Khi quá tải: consumer vẫn xử lý gần hết khả năng
+ * - Sau khi hết quá tải: ngừng loại và thời gian chờ về dưới target
+ *
+ * Cách sử dụng: ./codel_test (make test), exit code 0 nếu đạt
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "task_queue.h"
+#include "queue_metrics.h"
+
+#define CODEL_TEST_TARGET_NS       (5ULL * 1000000ULL)      /* 5 ms */
+#define CODEL_TEST_INTERVAL_NS     (100ULL * 1000000ULL)    /* 100 ms */
+#define CODEL_TEST_MAX_SOJOURN_NS  (10ULL * CODEL_TEST_TARGET_NS)
+#define CODEL_TEST_SERVICE_NS      200000ULL                /* 5000 tác vụ/s */
+#define CODEL_TEST_DURATION_NS     3000000000ULL            /* 3 s giả lập */
+#define CODEL_TEST_QUIET_NS        1000000000ULL            /* 1 s cuối khi đã hết quá tải */
+#define CODEL_TEST_START_NS        1000000000ULL            /* Đồng hồ giả lập bắt đầu từ 1 s */
+
+/**
+ * @brief Một kịch bản tải
+ */
+typedef struct {
+    const char* name;
+    unsigned int burst;         /* Số tác vụ thêm cùng lúc ở thời điểm bắt đầu */
+    uint64_t arrival_ns;        /* Khoảng cách giữa hai tác vụ đến */
+    uint64_t overload_ns;       /* Thời gian đầu tiên tác vụ đến nhanh gấp đôi khả năng xử lý */
+    int expect_drops;
+} CodelScenario_t;
+
+/**
+ * @brief Kết quả của một kịch bản
+ */
+typedef struct {
+    uint64_t offered;
+    uint64_t served;
+    uint64_t dropped;
+    uint64_t served_overload;   /* Số tác vụ xử lý xong trong thời gian quá tải */
+    uint64_t max_wait_ns;
+    uint64_t last_wait_ns;
+    uint64_t first_drop_ns;     /* Tính từ lúc bắt đầu, 0 = không loại */
+    uint64_t last_drop_ns;
+} CodelResult_t;
+
+static const CodelScenario_t scenarios[] = {
+    { "under capacity",      0,   2 * CODEL_TEST_SERVICE_NS, 0,                      0 },
+    { "short burst",         100, 2 * CODEL_TEST_SERVICE_NS, 0,                      0 },
+    { "2x overload",         0,   2 * CODEL_TEST_SERVICE_NS, CODEL_TEST_DURATION_NS, 1 },
+    { "overload, recovery",  0,   2 * CODEL_TEST_SERVICE_NS,
+      CODEL_TEST_DURATION_NS - 2 * CODEL_TEST_QUIET_NS,                              1 },
+};
+
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/* Đồng hồ giả lập - chỉ vòng lặp sự kiện đổi giá trị */
+static uint64_t sim_now_ns;
+
+static uint64_t sim_clock(void)
+{
+    return sim_now_ns;
+}
+
+/**
+ * @brief Thêm một tác vụ, tính vào offered
+ */
+static void offer_task(CodelResult_t* result)
+{
+    char description[TASK_DESC_SIZE];
+
+    snprintf(description, sizeof(description), "task %llu",
+             (unsigned long long)result->offered);
+    queue_add_task(description);
+    result->offered++;
+}
+
+/**
+ * @brief Chạy một kịch bản trên đồng hồ giả lập
+ */
+static void run_scenario(const CodelScenario_t* scenario, CodelResult_t* result)
+{
+    QueueConfig_t config;
+    QueueMetrics_t snap;
+    uint64_t start = CODEL_TEST_START_NS;
+    uint64_t end = start + CODEL_TEST_DURATION_NS;
+    uint64_t next_arrival = start;
+    uint64_t busy_until = start;
+    uint64_t arrival;
+    uint64_t next;
+    uint64_t wait;
+    TaskNode_t* task;
+
+    memset(result, 0, sizeof(*result));
+    sim_now_ns = start;
+
+    queue_config_default(&config);
+    config.verbose = 0;
+    config.codel_enabled = 1;
+    config.codel_target_ns = CODEL_TEST_TARGET_NS;
+    config.codel_interval_ns = CODEL_TEST_INTERVAL_NS;
+    config.codel_max_sojourn_ns = CODEL_TEST_MAX_SOJOURN_NS;
+    queue_configure(&config);
+    metrics_reset();
+
+    while (result->offered < scenario->burst) {
+        offer_task(result);
+    }
+
+    while (sim_now_ns < end) {
+        arrival = (sim_now_ns - start < scenario->overload_ns) ?
+                  CODEL_TEST_SERVICE_NS / 2 : scenario->arrival_ns;
+        while (next_arrival <= sim_now_ns) {
+            offer_task(result);
+            next_arrival += arrival;
+        }
+
+        if (busy_until <= sim_now_ns) {
+            task = queue_get_next_task();
+            metrics_snapshot(&snap);
+            if (snap.dropped > result->dropped) {
+                if (result->dropped == 0) {
+                    result->first_drop_ns = sim_now_ns - start;
+                }
+                result->dropped = snap.dropped;
+                result->last_drop_ns = sim_now_ns - start;
+            }
+            if (task != NULL) {
+                wait = task->dequeue_ns - task->enqueue_ns;
+                if (wait > result->max_wait_ns) {
+                    result->max_wait_ns = wait;
+                }
+                result->last_wait_ns = wait;
+                busy_until = sim_now_ns + CODEL_TEST_SERVICE_NS;
+                result->served++;
+                if (busy_until - start <= scenario->overload_ns) {
+                    result->served_overload++;
+                }
+                free(task);
+            }
+        }
+
+        /* Sự kiện kế tiếp: tác vụ đến, hoặc consumer rảnh */
+        next = next_arrival;
+        if (busy_until > sim_now_ns && busy_until < next) {
+            next = busy_until;
+        }
+        sim_now_ns = next;
+    }
+
+    queue_destroy();
+}
+
+/**
+ * @brief Kiểm tra kết quả của một kịch bản, in lý do nếu sai
+ * @return 1 nếu đạt, 0 nếu không
+ */
+static int check_scenario(const CodelScenario_t* scenario, const CodelResult_t* result)
+{
+    uint64_t capacity = scenario->overload_ns / CODEL_TEST_SERVICE_NS;
+    int passed = 1;
+
+    if (result->max_wait_ns > CODEL_TEST_MAX_SOJOURN_NS) {
+        printf("  FAIL: a task waited %.2f ms, above the %.2f ms max sojourn\n",
+               (double)result->max_wait_ns / 1e6, (double)CODEL_TEST_MAX_SOJOURN_NS / 1e6);
+        passed = 0;
+    }
+    if (!scenario->expect_drops && result->dropped != 0) {
+        printf("  FAIL: %llu tasks dropped without a standing queue\n",
+               (unsigned long long)result->dropped);
+        passed = 0;
+    }
+    if (scenario->expect_drops && result->dropped == 0) {
+        printf("  FAIL: no tasks dropped under overload\n");
+        passed = 0;
+    }
+    if (result->dropped != 0 && result->first_drop_ns < CODEL_TEST_INTERVAL_NS) {
+        printf("  FAIL: first drop after %.2f ms, before one interval\n",
+               (double)result->first_drop_ns / 1e6);
+        passed = 0;
+    }
+    /* Loại ở đầu hàng đợi không được làm consumer rảnh khi vẫn còn việc */
+    if (result->served_overload * 100 < capacity * 95) {
+        printf("  FAIL: served %llu of %llu tasks while overloaded\n",
+               (unsigned long long)result->served_overload, (unsigned long long)capacity);
+        passed = 0;
+    }
+    if (scenario->overload_ns + CODEL_TEST_QUIET_NS <= CODEL_TEST_DURATION_NS &&
+        (result->last_drop_ns > CODEL_TEST_DURATION_NS - CODEL_TEST_QUIET_NS ||
+         result->last_wait_ns >= CODEL_TEST_TARGET_NS)) {
+        printf("  FAIL: still dropping or queueing after the load went away "
+               "(last drop %.2f ms, last wait %.2f ms)\n",
+               (double)result->last_drop_ns / 1e6, (double)result->last_wait_ns / 1e6);
+        passed = 0;
+    }
+    return passed;
+}
+
+int main(void)
+{
+    CodelResult_t result;
+    int failed = 0;
+
+    metrics_set_clock(sim_clock);
+
+    printf("CoDel %llu ms/%llu ms, max sojourn %llu ms, service %llu us, "
+           "%llu s simulated per scenario\n",
+           (unsigned long long)(CODEL_TEST_TARGET_NS / 1000000ULL),
+           (unsigned long long)(CODEL_TEST_INTERVAL_NS / 1000000ULL),
+           (unsigned long long)(CODEL_TEST_MAX_SOJOURN_NS / 1000000ULL),
+           (unsigned long long)(CODEL_TEST_SERVICE_NS / 1000ULL),
+           (unsigned long long)(CODEL_TEST_DURATION_NS / 1000000000ULL));
+    printf("%-20s %8s %8s %8s %9s %13s\n", "scenario", "offered", "served",
+           "dropped", "max(ms)", "1st drop(ms)");
+
+    for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+        run_scenario(&scenarios[i], &result);
+        printf("%-20s %8llu %8llu %8llu %9.2f %13.2f\n", scenarios[i].name,
+               (unsigned long long)result.offered, (unsigned long long)result.served,
+               (unsigned long long)result.dropped, (double)result.max_wait_ns / 1e6,
+               (double)result.first_drop_ns / 1e6);
+        if (!check_scenario(&scenarios[i], &result)) {
+            failed = 1;
+        }
+    }
+
+    if (!failed) {
+        printf("PASS: waits stay below the max sojourn, drops only under sustained overload\n");
+    }
+    metrics_set_clock(NULL);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}